@@ -0,0 +1,113 @@
+//! Deferred boot initialization
+//!
+//! Subsystems the root filesystem does not depend on (compositor, NIC
+//! drivers, secondary block devices) are initialized off the critical path.
+//! `defer()` hands them to an idle AP through the workqueue and boot carries
+//! on; `wait_all()` is called right before PID 1 starts, so userspace still
+//! sees a fully initialized kernel.
+//!
+//! Without online APs the task runs inline: the BSP would otherwise only get
+//! to it from the idle loop, after PID 1 is already running.
+//!
+//! Deferred tasks run with interrupts disabled and must not sleep.
+
+use core::sync::atomic::{AtomicU32, AtomicUsize, Ordering};
+use spin::Mutex;
+
+use super::timeline;
+
+/// Maximum number of deferred tasks
+pub const MAX_DEFERRED: usize = 16;
+
+#[derive(Clone, Copy)]
+struct DeferredTask {
+    name: &'static str,
+    func: fn(),
+}
+
+static TASKS: Mutex<[Option<DeferredTask>; MAX_DEFERRED]> = Mutex::new([None; MAX_DEFERRED]);
+/// Number of task slots handed out
+static QUEUED: AtomicUsize = AtomicUsize::new(0);
+/// Bit n set once task n finished
+static DONE: AtomicU32 = AtomicU32::new(0);
+/// Round-robin cursor over the APs
+static NEXT_CPU: AtomicUsize = AtomicUsize::new(0);
+
+/// Workqueue entry: run task `idx`
+fn run_task(idx: usize) {
+    let Some(task) = TASKS.lock()[idx] else {
+        return;
+    };
+
+    let id = timeline::begin(task.name, true);
+    (task.func)();
+    timeline::end(id);
+
+    DONE.fetch_or(1 << idx, Ordering::AcqRel);
+}
+
+/// Pick the next online AP, if any
+fn next_ap() -> Option<u16> {
+    let total = crate::smp::cpu_count();
+    if total <= 1 {
+        return None;
+    }
+    for _ in 0..total {
+        let cpu = 1 + NEXT_CPU.fetch_add(1, Ordering::Relaxed) % (total - 1);
+        if crate::smp::cpu_is_online(cpu) {
+            return Some(cpu as u16);
+        }
+    }
+    None
+}
+
+/// Initialize `func` asynchronously on an AP.
+pub fn defer(name: &'static str, func: fn()) {
+    let idx = QUEUED.fetch_add(1, Ordering::AcqRel);
+    if idx >= MAX_DEFERRED {
+        QUEUED.fetch_sub(1, Ordering::AcqRel);
+        crate::kwarn!("deferred init: table full, running '{}' inline", name);
+        timeline::stage(name, func);
+        return;
+    }
+    TASKS.lock()[idx] = Some(DeferredTask { name, func });
+
+    match next_ap() {
+        Some(cpu) if crate::smp::workqueue::queue_work_on(cpu, run_task, idx) => {
+            crate::kdebug!("deferred init: '{}' queued on CPU {}", name, cpu);
+        }
+        _ => run_task(idx),
+    }
+}
+
+/// Check whether every deferred task finished
+pub fn all_done() -> bool {
+    let mask = (1u32 << QUEUED.load(Ordering::Acquire)) - 1;
+    DONE.load(Ordering::Acquire) & mask == mask
+}
+
+/// Wait for the deferred task(s) called `name` to finish
+pub fn wait(name: &'static str) {
+    let mut mask = 0u32;
+    for (idx, task) in TASKS.lock().iter().enumerate() {
+        if matches!(task, Some(task) if task.name == name) {
+            mask |= 1 << idx;
+        }
+    }
+    while DONE.load(Ordering::Acquire) & mask != mask {
+        core::hint::spin_loop();
+    }
+}
+
+/// Wait for every deferred task to finish
+pub fn wait_all() {
+    if all_done() {
+        return;
+    }
+
+    let id = timeline::begin("wait deferred init", false);
+    while !all_done() {
+        core::hint::spin_loop();
+    }
+    timeline::end(id);
+}
@@ -2,13 +2,16 @@
 //!
 //! This module contains all boot-related functionality including:
 //! - Boot stage management
+//! - Boot timeline and deferred initialization
 //! - Boot information handling  
 //! - Init process management
 //! - UEFI compatibility layer
 
+pub mod deferred;
 pub mod info;
 pub mod init;
 pub mod stages;
+pub mod timeline;
 pub mod uefi;
 
 // Re-export commonly used items from info
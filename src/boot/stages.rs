@@ -217,18 +217,20 @@ pub fn initramfs_stage() -> Result<(), &'static str> {
     crate::kinfo!("=== Initramfs Stage ===");
     crate::kinfo!("Mounting virtual filesystems...");
 
-    // Mount /proc (process information pseudo-filesystem)
-    mount_proc()?;
+    super::timeline::stage("virtual filesystems", || -> Result<(), &'static str> {
+        // Mount /proc (process information pseudo-filesystem)
+        mount_proc()?;
 
-    // Mount /sys (sysfs for device and kernel information)
-    mount_sys()?;
+        // Mount /sys (sysfs for device and kernel information)
+        mount_sys()?;
 
-    // Mount /dev (device files)
-    mount_dev()?;
+        // Mount /dev (device files)
+        mount_dev()
+    })?;
 
     crate::kinfo!("Virtual filesystems mounted successfully");
 
-    // Load kernel modules from initramfs
+    // Load kernel modules from initramfs (no-op if kernel init already did)
     // This is similar to Linux's initramfs module loading
     crate::kinfo!("Loading kernel modules from initramfs...");
     crate::kmod::load_initramfs_modules();
@@ -368,10 +370,13 @@ pub fn mount_real_root() -> Result<(), &'static str> {
     crate::fs::add_directory("/sysroot");
 
     // Step 1: Scan for block device
-    let disk_image = scan_for_block_device(root_dev)?;
+    let disk_image =
+        super::timeline::stage("root device scan", || scan_for_block_device(root_dev))?;
 
     // Step 2: Mount filesystem based on type using the unified registry
-    mount_filesystem_by_type(root_fstype, disk_image)?;
+    super::timeline::stage("root mount", || {
+        mount_filesystem_by_type(root_fstype, disk_image)
+    })?;
 
     mark_mounted("rootfs");
     crate::kinfo!(
@@ -780,19 +785,21 @@ pub fn start_real_root_init() -> Result<(), &'static str> {
         crate::kinfo!("Remounting root as read-write");
     }
 
+    // Probe all additional block devices (e.g., swap) on an AP while /dev
+    // is rebuilt; only fstab needs them
+    super::deferred::defer("block probe", probe_all_block_devices);
+
     // Recreate /dev with device nodes after pivot_root
     // Since we switched to ext2 root, /dev needs to be repopulated
-    remount_dev_after_pivot()?;
-
-    // Probe all additional block devices (e.g., swap)
-    probe_all_block_devices();
+    super::timeline::stage("remount /dev", remount_dev_after_pivot)?;
 
     // Load and process /etc/fstab
-    process_fstab();
+    super::deferred::wait("block probe");
+    super::timeline::stage("fstab", process_fstab);
 
     // Initialize TTF font system now that /etc/fonts is accessible
     #[cfg(feature = "gfx_ttf")]
-    init_font_system();
+    super::timeline::stage("fonts", init_font_system);
 
     crate::kinfo!("Real root initialization complete");
 
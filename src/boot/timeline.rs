@@ -0,0 +1,169 @@
+//! Boot timeline
+//!
+//! Records when each boot stage started and how long it ran, as TSC
+//! timestamps, so boot time regressions can be tracked per stage. Deferred
+//! init tasks record themselves too, tagged with the CPU that ran them.
+//!
+//! The timeline is exported as /proc/boottime.
+
+use alloc::vec::Vec;
+use core::fmt::{self, Write};
+use core::sync::atomic::{AtomicU64, Ordering};
+use spin::Mutex;
+
+/// Maximum number of recorded events (later events are dropped)
+pub const MAX_BOOT_EVENTS: usize = 64;
+
+/// One timed boot stage
+#[derive(Debug, Clone, Copy)]
+pub struct BootEvent {
+    pub name: &'static str,
+    pub start_tsc: u64,
+    /// 0 while the stage is still running
+    pub end_tsc: u64,
+    pub cpu: u16,
+    /// Ran as a deferred init task, off the critical path
+    pub deferred: bool,
+}
+
+struct Timeline {
+    events: [Option<BootEvent>; MAX_BOOT_EVENTS],
+    len: usize,
+}
+
+static TIMELINE: Mutex<Timeline> = Mutex::new(Timeline {
+    events: [None; MAX_BOOT_EVENTS],
+    len: 0,
+});
+
+/// TSC value when control was handed to PID 1 (0 until then)
+static BOOT_COMPLETE_TSC: AtomicU64 = AtomicU64::new(0);
+
+/// Handle of a running stage, returned by `begin()`
+#[derive(Debug, Clone, Copy)]
+pub struct StageId(Option<usize>);
+
+/// Start timing a stage
+pub fn begin(name: &'static str, deferred: bool) -> StageId {
+    let event = BootEvent {
+        name,
+        start_tsc: crate::safety::rdtsc(),
+        end_tsc: 0,
+        cpu: crate::smp::current_cpu_id(),
+        deferred,
+    };
+
+    let mut timeline = TIMELINE.lock();
+    let idx = timeline.len;
+    if idx >= MAX_BOOT_EVENTS {
+        return StageId(None);
+    }
+    timeline.events[idx] = Some(event);
+    timeline.len += 1;
+    StageId(Some(idx))
+}
+
+/// Stop timing a stage started with `begin()`
+pub fn end(id: StageId) {
+    let Some(idx) = id.0 else {
+        return;
+    };
+    let now = crate::safety::rdtsc();
+    if let Some(event) = TIMELINE.lock().events[idx].as_mut() {
+        event.end_tsc = now;
+    }
+}
+
+/// Run `f` as a timed boot stage
+pub fn stage<T>(name: &'static str, f: impl FnOnce() -> T) -> T {
+    let id = begin(name, false);
+    let result = f();
+    end(id);
+    result
+}
+
+/// Record that boot finished (PID 1 is about to run)
+pub fn mark_boot_complete() {
+    let _ = BOOT_COMPLETE_TSC.compare_exchange(
+        0,
+        crate::safety::rdtsc(),
+        Ordering::AcqRel,
+        Ordering::Relaxed,
+    );
+}
+
+/// Snapshot of all recorded events, in start order
+pub fn events() -> Vec<BootEvent> {
+    let timeline = TIMELINE.lock();
+    let mut events: Vec<BootEvent> = timeline.events[..timeline.len]
+        .iter()
+        .flatten()
+        .copied()
+        .collect();
+    drop(timeline);
+    events.sort_by_key(|event| event.start_tsc);
+    events
+}
+
+/// Convert a TSC timestamp to microseconds since the logger started
+fn tsc_to_boot_us(tsc: u64) -> u64 {
+    let freq = crate::logger::tsc_frequency_hz();
+    if freq == 0 {
+        return 0;
+    }
+    let cycles = tsc.saturating_sub(crate::logger::boot_tsc());
+    ((cycles as u128 * 1_000_000) / freq as u128) as u64
+}
+
+fn cycles_to_us(cycles: u64) -> u64 {
+    let freq = crate::logger::tsc_frequency_hz();
+    if freq == 0 {
+        return 0;
+    }
+    ((cycles as u128 * 1_000_000) / freq as u128) as u64
+}
+
+/// Write the timeline in /proc/boottime format
+pub fn write_report(w: &mut dyn Write) -> fmt::Result {
+    writeln!(
+        w,
+        "# tsc_hz {}{}",
+        crate::logger::tsc_frequency_hz(),
+        if crate::logger::tsc_frequency_is_guessed() {
+            " (guessed)"
+        } else {
+            ""
+        }
+    )?;
+    writeln!(
+        w,
+        "# {:>10} {:>11} {:>14} {:>3}  stage",
+        "start_us", "duration_us", "cycles", "cpu"
+    )?;
+
+    for event in events() {
+        let (cycles, duration) = if event.end_tsc == 0 {
+            (0, 0)
+        } else {
+            let cycles = event.end_tsc.saturating_sub(event.start_tsc);
+            (cycles, cycles_to_us(cycles))
+        };
+        writeln!(
+            w,
+            "  {:>10} {:>11} {:>14} {:>3}  {}{}{}",
+            tsc_to_boot_us(event.start_tsc),
+            duration,
+            cycles,
+            event.cpu,
+            event.name,
+            if event.deferred { " [deferred]" } else { "" },
+            if event.end_tsc == 0 { " [running]" } else { "" }
+        )?;
+    }
+
+    let complete = BOOT_COMPLETE_TSC.load(Ordering::Acquire);
+    if complete != 0 {
+        writeln!(w, "boot_complete_us {}", tsc_to_boot_us(complete))?;
+    }
+    Ok(())
+}
@@ -29,6 +29,8 @@
 //! Block device drivers register their operations through `kmod_blk_register()`.
 //! The kernel then routes all block I/O operations through these callbacks.
 
+use crate::scheduler::cgroup;
+use crate::scheduler::psi::{self, PsiResource};
 use alloc::vec::Vec;
 use spin::Mutex;
 
@@ -551,8 +553,11 @@ pub fn read_sectors(
         return Err(BlockError::Alignment);
     }
 
-    let result = read_fn(device.handle, sector, count, buf.as_mut_ptr());
+    let result = psi::stall(PsiResource::Io, || {
+        read_fn(device.handle, sector, count, buf.as_mut_ptr())
+    });
     if result == 0 {
+        cgroup::account_io(false, required_size as u64);
         Ok(())
     } else {
         Err(BlockError::from_code(result).unwrap_or(BlockError::IoError))
@@ -582,8 +587,11 @@ pub fn write_sectors(index: usize, sector: u64, count: u32, buf: &[u8]) -> Resul
         return Err(BlockError::Alignment);
     }
 
-    let result = write_fn(device.handle, sector, count, buf.as_ptr());
+    let result = psi::stall(PsiResource::Io, || {
+        write_fn(device.handle, sector, count, buf.as_ptr())
+    });
     if result == 0 {
+        cgroup::account_io(true, required_size as u64);
         Ok(())
     } else {
         Err(BlockError::from_code(result).unwrap_or(BlockError::IoError))
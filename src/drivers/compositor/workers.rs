@@ -16,9 +16,10 @@ use super::types::{BlendMode, CompositionLayer, WorkType, COMPOSE_LAYERS, CPU_WO
 // AP Core Entry Point
 // =============================================================================
 
-/// Entry point for AP cores when receiving IPI_CALL_FUNCTION
+/// Entry point for AP cores, queued by `dispatch_to_ap_cores()`
 ///
-/// This function is called from the IPI handler to participate in parallel work.
+/// This function is called from the call-function IPI handler to participate
+/// in parallel work.
 /// AP cores will claim work atomically and process it until all work is done.
 ///
 /// # Safety
@@ -1024,8 +1025,8 @@ pub(crate) fn wait_for_completion() {
 
 /// Dispatch work to AP cores and wait for completion
 ///
-/// This sends IPI_CALL_FUNCTION to all online AP cores and waits
-/// until all work is completed.
+/// This queues `ap_work_entry()` on all online AP cores through the
+/// cross-CPU call queues; the caller waits for completion itself.
 pub(crate) fn dispatch_to_ap_cores() {
     let workers = worker_count();
     if workers <= 1 {
@@ -1039,6 +1040,6 @@ pub(crate) fn dispatch_to_ap_cores() {
     // Memory fence to ensure all work parameters are visible
     core::sync::atomic::fence(Ordering::SeqCst);
 
-    // Send IPI to all AP cores
-    smp::send_ipi_broadcast(smp::IPI_CALL_FUNCTION);
+    // Run the worker on all AP cores
+    smp::smp_call_function(|_| ap_work_entry(), 0, false);
 }
@@ -6,7 +6,8 @@
 //!
 //! # Features
 //! - Hardware RNG via RDRAND/RDSEED instructions
-//! - Software CSPRNG (ChaCha20) with hardware seed
+//! - Software CSPRNG (ChaCha20) with hardware seed, reseeded every minute
+//! - Lock-free per-CPU CRNGs with batched, key-erasing output
 //! - Kernel entropy pool for /dev/random and /dev/urandom
 //! - getrandom() syscall support
 
@@ -29,86 +30,271 @@ static ENTROPY_COUNT: AtomicU64 = AtomicU64::new(0);
 const MAX_ENTROPY_BITS: u64 = 4096;
 
 // ============================================================================
-// ChaCha20 CSPRNG State
+// CRNG State
 // ============================================================================
+//
+// A base CRNG holds the key seeded from hardware entropy. Each CPU keeps its
+// own ChaCha20 CRNG keyed from the base, so requests on different CPUs never
+// share a lock. Per-CPU CRNGs generate output in batches of four blocks with
+// fast key erasure: the first 32 bytes of every batch replace the key, the
+// rest is handed out and wiped as it is consumed. Reseeding the base bumps
+// its generation, and every per-CPU CRNG re-keys on its next use.
 
-/// ChaCha20-based CSPRNG state
-struct ChaChaState {
+/// Bytes produced per per-CPU refill (four ChaCha20 blocks)
+const BATCH_BYTES: usize = 256;
+
+/// Bytes of each batch kept as the next key
+const KEY_BYTES: usize = 32;
+
+/// Requests larger than this are generated with a one-shot stream key
+/// instead of going through the batch buffer
+const MAX_BATCHED_REQUEST: usize = 64;
+
+/// Base CRNG reseed interval
+const CRNG_RESEED_INTERVAL_US: u64 = 60_000_000;
+
+/// Number of per-CPU CRNG slots. CPUs beyond this share slots.
+const CRNG_SLOTS: usize = 64;
+
+/// Base CRNG state
+struct BaseCrng {
     key: [u32; 8],
-    nonce: [u32; 2],
-    counter: u64,
+    /// Boot time of the last reseed
+    birth_us: u64,
+    /// Whether the key was ever seeded from hardware or system state
+    seeded: bool,
 }
 
-impl ChaChaState {
-    const fn new() -> Self {
-        Self {
-            key: [0; 8],
-            nonce: [0; 2],
-            counter: 0,
+static BASE_CRNG: Mutex<BaseCrng> = Mutex::new(BaseCrng {
+    key: [0; 8],
+    birth_us: 0,
+    seeded: false,
+});
+
+/// Generation of a per-CPU CRNG that was never keyed
+const UNKEYED: u64 = 0;
+
+/// Incremented whenever the base CRNG is reseeded. Starts above `UNKEYED`,
+/// so a fresh per-CPU CRNG never looks up to date.
+static BASE_GENERATION: AtomicU64 = AtomicU64::new(UNKEYED + 1);
+
+/// Boot time (us) at which the base CRNG is due for a reseed
+static NEXT_RESEED_US: AtomicU64 = AtomicU64::new(0);
+
+impl BaseCrng {
+    /// Mix `seed` into the key and erase the old key
+    fn mix(&mut self, seed: &[u8]) {
+        for (i, byte) in seed.iter().enumerate() {
+            let idx = i % KEY_BYTES;
+            self.key[idx / 4] ^= (*byte as u32) << ((idx % 4) * 8);
         }
+        let block = chacha20_block(&self.key, 0, &[0, 0]);
+        self.key = words_from_bytes(&block[..KEY_BYTES]);
     }
 
     /// Reseed from hardware entropy
     fn reseed(&mut self) {
-        let mut seed = [0u8; 40]; // 32 bytes key + 8 bytes nonce
+        let mut seed = [0u8; 48];
 
         // Try to get hardware random bytes
         if !fill_from_hardware(&mut seed) {
             // Fallback: use TSC and other system state
             fallback_seed(&mut seed);
         }
+        self.mix(&seed);
+        seed.fill(0);
+
+        self.birth_us = crate::logger::boot_time_us();
+        self.seeded = true;
+        NEXT_RESEED_US.store(
+            self.birth_us.saturating_add(CRNG_RESEED_INTERVAL_US),
+            Ordering::Relaxed,
+        );
+        BASE_GENERATION.fetch_add(1, Ordering::AcqRel);
+        ENTROPY_COUNT.store(MAX_ENTROPY_BITS, Ordering::SeqCst);
+    }
 
-        // Parse into key and nonce
-        for i in 0..8 {
-            self.key[i] = u32::from_le_bytes([
-                seed[i * 4],
-                seed[i * 4 + 1],
-                seed[i * 4 + 2],
-                seed[i * 4 + 3],
-            ]);
+    /// Derive a fresh key for a per-CPU CRNG (fast key erasure)
+    fn derive_key(&mut self) -> [u32; 8] {
+        let block = chacha20_block(&self.key, 0, &[0, 0]);
+        self.key = words_from_bytes(&block[..KEY_BYTES]);
+        words_from_bytes(&block[KEY_BYTES..2 * KEY_BYTES])
+    }
+}
+
+/// Per-CPU CRNG state
+struct CrngState {
+    key: [u32; 8],
+    /// Base generation the key was derived from (`UNKEYED` if none)
+    generation: u64,
+    /// Batched output; bytes before `pos` are consumed and zeroed
+    buf: [u8; BATCH_BYTES],
+    pos: usize,
+}
+
+impl CrngState {
+    const fn new() -> Self {
+        Self {
+            key: [0; 8],
+            generation: UNKEYED,
+            buf: [0; BATCH_BYTES],
+            pos: BATCH_BYTES,
         }
+    }
 
-        self.nonce = [
-            u32::from_le_bytes([seed[32], seed[33], seed[34], seed[35]]),
-            u32::from_le_bytes([seed[36], seed[37], seed[38], seed[39]]),
-        ];
+    /// Re-key from the base CRNG if it was reseeded since our last re-key.
+    ///
+    /// Uses try_lock: if the base is busy (possibly on this CPU, below us),
+    /// a keyed CRNG keeps its current key and retries on the next request.
+    /// Returns false if the CRNG is still unkeyed and must not be used.
+    fn maybe_rekey(&mut self) -> bool {
+        let generation = BASE_GENERATION.load(Ordering::Acquire);
+        if generation == self.generation {
+            return true;
+        }
+        if let Some(mut base) = BASE_CRNG.try_lock() {
+            self.rekey(&mut base);
+            return true;
+        }
+        self.generation != UNKEYED
+    }
 
-        self.counter = 0;
-        ENTROPY_COUNT.store(MAX_ENTROPY_BITS, Ordering::SeqCst);
+    /// Derive a new key from the base, seeding the base first if needed
+    fn rekey(&mut self, base: &mut BaseCrng) {
+        if !base.seeded {
+            base.reseed();
+        }
+        self.key = base.derive_key();
+        // Only changed with the base locked
+        self.generation = BASE_GENERATION.load(Ordering::Acquire);
+        self.buf.fill(0);
+        self.pos = BATCH_BYTES;
     }
 
-    /// Generate a 64-byte block using ChaCha20
-    fn generate_block(&mut self) -> [u8; 64] {
-        let output = chacha20_block(&self.key, self.counter, &self.nonce);
-        self.counter = self.counter.wrapping_add(1);
+    /// Generate a new batch, replacing the key with its first bytes
+    fn refill(&mut self) {
+        let mut batch = [0u8; BATCH_BYTES];
+        chacha20_blocks4(&self.key, 0, &[0, 0], &mut batch);
+        self.key = words_from_bytes(&batch[..KEY_BYTES]);
+        self.buf[KEY_BYTES..].copy_from_slice(&batch[KEY_BYTES..]);
+        self.buf[..KEY_BYTES].fill(0);
+        batch.fill(0);
+        self.pos = KEY_BYTES;
+    }
 
-        // Decrement entropy estimate
-        let _ = ENTROPY_COUNT.fetch_update(Ordering::SeqCst, Ordering::SeqCst, |v| {
-            Some(v.saturating_sub(512))
-        });
+    /// Copy batched output into `dest` (at most one batch)
+    fn take(&mut self, dest: &mut [u8]) {
+        let mut offset = 0;
+        while offset < dest.len() {
+            if self.pos >= BATCH_BYTES {
+                self.refill();
+            }
+            let n = core::cmp::min(BATCH_BYTES - self.pos, dest.len() - offset);
+            dest[offset..offset + n].copy_from_slice(&self.buf[self.pos..self.pos + n]);
+            self.buf[self.pos..self.pos + n].fill(0);
+            self.pos += n;
+            offset += n;
+        }
+    }
+
+    /// Fill `dest`, using a one-shot stream key for large requests
+    fn fill(&mut self, dest: &mut [u8]) {
+        if !self.maybe_rekey() {
+            // Never keyed and the base is busy: serve hardware output, or
+            // wait for the base, rather than generate from the zero key
+            if fill_from_hardware(dest) {
+                return;
+            }
+            self.rekey(&mut BASE_CRNG.lock());
+        }
 
-        output
+        if dest.len() <= MAX_BATCHED_REQUEST {
+            self.take(dest);
+            return;
+        }
+
+        let mut key_bytes = [0u8; KEY_BYTES];
+        self.take(&mut key_bytes);
+        let key = words_from_bytes(&key_bytes);
+        key_bytes.fill(0);
+
+        let mut block = [0u8; BATCH_BYTES];
+        let mut counter = 0u64;
+        for chunk in dest.chunks_mut(BATCH_BYTES) {
+            chacha20_blocks4(&key, counter, &[0, 0], &mut block);
+            chunk.copy_from_slice(&block[..chunk.len()]);
+            counter = counter.wrapping_add(4);
+        }
+        block.fill(0);
     }
+}
+
+/// Per-CPU CRNG slot, alone on its cache lines
+#[repr(C, align(64))]
+struct CrngSlot {
+    /// Held while the slot is in use (also guards against reentry from
+    /// interrupt handlers on the same CPU)
+    busy: AtomicBool,
+    state: core::cell::UnsafeCell<CrngState>,
+}
 
-    /// Fill buffer with random bytes
-    fn fill(&mut self, buf: &mut [u8]) {
-        // Auto-reseed if entropy is low
-        if ENTROPY_COUNT.load(Ordering::SeqCst) < 256 {
-            self.reseed();
+// Access to `state` is serialized by `busy`
+unsafe impl Sync for CrngSlot {}
+
+impl CrngSlot {
+    const fn new() -> Self {
+        Self {
+            busy: AtomicBool::new(false),
+            state: core::cell::UnsafeCell::new(CrngState::new()),
         }
+    }
+}
 
-        let mut offset = 0;
-        while offset < buf.len() {
-            let block = self.generate_block();
-            let to_copy = core::cmp::min(64, buf.len() - offset);
-            buf[offset..offset + to_copy].copy_from_slice(&block[..to_copy]);
-            offset += to_copy;
+static CRNG_SLOTS_PERCPU: [CrngSlot; CRNG_SLOTS] = [const { CrngSlot::new() }; CRNG_SLOTS];
+
+/// Run `f` on a free CRNG slot, preferring the current CPU's.
+///
+/// If our slot is busy (an interrupt arrived while it was in use, or CPUs
+/// share the slot) the next free one is borrowed, so this never spins. A
+/// borrowed slot may never have been keyed; `CrngState::fill()` checks.
+fn with_crng<R>(f: impl FnOnce(&mut CrngState) -> R) -> R {
+    let first = crate::smp::current_cpu_id() as usize % CRNG_SLOTS;
+    let mut idx = first;
+    loop {
+        let slot = &CRNG_SLOTS_PERCPU[idx];
+        if slot
+            .busy
+            .compare_exchange(false, true, Ordering::Acquire, Ordering::Relaxed)
+            .is_ok()
+        {
+            let result = f(unsafe { &mut *slot.state.get() });
+            slot.busy.store(false, Ordering::Release);
+            return result;
         }
+        idx = (idx + 1) % CRNG_SLOTS;
+        if idx == first {
+            core::hint::spin_loop();
+        }
+    }
+}
+
+/// Reseed the base CRNG if its seed is older than the reseed interval
+fn maybe_reseed_base() {
+    if crate::logger::boot_time_us() < NEXT_RESEED_US.load(Ordering::Relaxed) {
+        return;
+    }
+    if let Some(mut base) = BASE_CRNG.try_lock() {
+        base.reseed();
     }
 }
 
-/// Global CSPRNG state
-static CSPRNG: Mutex<ChaChaState> = Mutex::new(ChaChaState::new());
+fn words_from_bytes(bytes: &[u8]) -> [u32; 8] {
+    let mut words = [0u32; 8];
+    for (word, chunk) in words.iter_mut().zip(bytes.chunks_exact(4)) {
+        *word = u32::from_le_bytes([chunk[0], chunk[1], chunk[2], chunk[3]]);
+    }
+    words
+}
 
 // ============================================================================
 // ChaCha20 Core Algorithm
@@ -187,6 +373,85 @@ fn chacha20_block(key: &[u32; 8], counter: u64, nonce: &[u32; 2]) -> [u8; 64] {
     output
 }
 
+/// Four consecutive ChaCha20 blocks (`counter` .. `counter + 3`), computed
+/// in parallel with SSE2: each vector holds one state word of all four
+/// blocks.
+fn chacha20_blocks4(key: &[u32; 8], counter: u64, nonce: &[u32; 2], out: &mut [u8; 256]) {
+    use core::arch::x86_64::*;
+
+    macro_rules! rotl {
+        ($v:expr, $n:literal) => {
+            _mm_or_si128(_mm_slli_epi32($v, $n), _mm_srli_epi32($v, 32 - $n))
+        };
+    }
+
+    #[inline(always)]
+    unsafe fn quarter_round4(x: &mut [__m128i; 16], a: usize, b: usize, c: usize, d: usize) {
+        x[a] = _mm_add_epi32(x[a], x[b]);
+        x[d] = rotl!(_mm_xor_si128(x[d], x[a]), 16);
+        x[c] = _mm_add_epi32(x[c], x[d]);
+        x[b] = rotl!(_mm_xor_si128(x[b], x[c]), 12);
+        x[a] = _mm_add_epi32(x[a], x[b]);
+        x[d] = rotl!(_mm_xor_si128(x[d], x[a]), 8);
+        x[c] = _mm_add_epi32(x[c], x[d]);
+        x[b] = rotl!(_mm_xor_si128(x[b], x[c]), 7);
+    }
+
+    // SSE2 is part of the x86_64 baseline (and enabled in the kernel target)
+    unsafe {
+        const SIGMA: [u32; 4] = [0x61707865, 0x3320646e, 0x79622d32, 0x6b206574];
+        let ctr = [
+            counter,
+            counter.wrapping_add(1),
+            counter.wrapping_add(2),
+            counter.wrapping_add(3),
+        ];
+
+        let mut init = [_mm_setzero_si128(); 16];
+        for i in 0..4 {
+            init[i] = _mm_set1_epi32(SIGMA[i] as i32);
+        }
+        for i in 0..8 {
+            init[4 + i] = _mm_set1_epi32(key[i] as i32);
+        }
+        init[12] = _mm_setr_epi32(ctr[0] as i32, ctr[1] as i32, ctr[2] as i32, ctr[3] as i32);
+        init[13] = _mm_setr_epi32(
+            (ctr[0] >> 32) as i32,
+            (ctr[1] >> 32) as i32,
+            (ctr[2] >> 32) as i32,
+            (ctr[3] >> 32) as i32,
+        );
+        init[14] = _mm_set1_epi32(nonce[0] as i32);
+        init[15] = _mm_set1_epi32(nonce[1] as i32);
+
+        let mut x = init;
+        for _ in 0..10 {
+            // Column rounds
+            quarter_round4(&mut x, 0, 4, 8, 12);
+            quarter_round4(&mut x, 1, 5, 9, 13);
+            quarter_round4(&mut x, 2, 6, 10, 14);
+            quarter_round4(&mut x, 3, 7, 11, 15);
+
+            // Diagonal rounds
+            quarter_round4(&mut x, 0, 5, 10, 15);
+            quarter_round4(&mut x, 1, 6, 11, 12);
+            quarter_round4(&mut x, 2, 7, 8, 13);
+            quarter_round4(&mut x, 3, 4, 9, 14);
+        }
+
+        // Add the input and transpose back to four serialized blocks
+        let mut lanes = [0u32; 4];
+        for i in 0..16 {
+            let word = _mm_add_epi32(x[i], init[i]);
+            _mm_storeu_si128(lanes.as_mut_ptr() as *mut __m128i, word);
+            for (block, lane) in lanes.iter().enumerate() {
+                let at = block * 64 + i * 4;
+                out[at..at + 4].copy_from_slice(&lane.to_le_bytes());
+            }
+        }
+    }
+}
+
 // ============================================================================
 // Hardware Random Instructions
 // ============================================================================
@@ -363,14 +628,14 @@ pub fn init() {
         if rdseed { "yes" } else { "no" }
     );
 
-    // Initial seed of CSPRNG
-    {
-        let mut csprng = CSPRNG.lock();
-        csprng.reseed();
-    }
+    // Initial seed of the base CRNG; per-CPU CRNGs key themselves from it
+    BASE_CRNG.lock().reseed();
 
     RNG_INITIALIZED.store(true, Ordering::SeqCst);
-    crate::kinfo!("Random: CSPRNG initialized with hardware seed");
+    crate::kinfo!(
+        "Random: CSPRNG initialized with hardware seed ({} per-CPU CRNG slots)",
+        CRNG_SLOTS
+    );
 }
 
 /// Check if RNG is initialized
@@ -386,7 +651,7 @@ pub fn entropy_available() -> u64 {
 /// Fill buffer with random bytes (non-blocking)
 /// This is used by /dev/urandom and getrandom() without GRND_RANDOM
 pub fn get_random_bytes(buf: &mut [u8]) {
-    if !RNG_INITIALIZED.load(Ordering::SeqCst) {
+    if !RNG_INITIALIZED.load(Ordering::Acquire) {
         // Not initialized yet, try hardware directly or use fallback
         if !fill_from_hardware(buf) {
             fallback_seed(buf);
@@ -394,8 +659,8 @@ pub fn get_random_bytes(buf: &mut [u8]) {
         return;
     }
 
-    let mut csprng = CSPRNG.lock();
-    csprng.fill(buf);
+    maybe_reseed_base();
+    with_crng(|crng| crng.fill(buf));
 }
 
 /// Fill buffer with random bytes (may block for entropy)
@@ -403,10 +668,13 @@ pub fn get_random_bytes(buf: &mut [u8]) {
 pub fn get_random_bytes_wait(buf: &mut [u8]) -> bool {
     // In kernel mode, we don't actually block, but we ensure
     // we have enough entropy or reseed if needed
-    if ENTROPY_COUNT.load(Ordering::SeqCst) < (buf.len() as u64 * 8) {
-        let mut csprng = CSPRNG.lock();
-        csprng.reseed();
+    let bits = buf.len() as u64 * 8;
+    if ENTROPY_COUNT.load(Ordering::SeqCst) < bits {
+        BASE_CRNG.lock().reseed();
     }
+    let _ = ENTROPY_COUNT.fetch_update(Ordering::SeqCst, Ordering::SeqCst, |v| {
+        Some(v.saturating_sub(bits))
+    });
 
     get_random_bytes(buf);
     true
@@ -414,12 +682,6 @@ pub fn get_random_bytes_wait(buf: &mut [u8]) -> bool {
 
 /// Get a random u64 value directly (fast path)
 pub fn get_random_u64() -> u64 {
-    // Try hardware first for single values
-    if let Some(v) = rdrand64() {
-        return v;
-    }
-
-    // Fall back to CSPRNG
     let mut buf = [0u8; 8];
     get_random_bytes(&mut buf);
     u64::from_le_bytes(buf)
@@ -427,29 +689,25 @@ pub fn get_random_u64() -> u64 {
 
 /// Get a random u32 value
 pub fn get_random_u32() -> u32 {
-    (get_random_u64() >> 32) as u32
+    let mut buf = [0u8; 4];
+    get_random_bytes(&mut buf);
+    u32::from_le_bytes(buf)
 }
 
 /// Add entropy to the pool (from interrupts, disk timing, etc.)
 pub fn add_entropy(data: &[u8], entropy_bits: u32) {
-    // Mix into CSPRNG state
-    // For simplicity, we just trigger a reseed if we get significant entropy
     let current = ENTROPY_COUNT.fetch_add(entropy_bits as u64, Ordering::SeqCst);
 
     if current + entropy_bits as u64 > MAX_ENTROPY_BITS {
         ENTROPY_COUNT.store(MAX_ENTROPY_BITS, Ordering::SeqCst);
     }
 
-    // Mix the new entropy into the CSPRNG key
+    // Mix the new entropy into the base key; per-CPU CRNGs pick it up when
+    // they see the new generation
     if !data.is_empty() {
-        let mut csprng = CSPRNG.lock();
-        for (i, byte) in data.iter().enumerate() {
-            let idx = i % 32;
-            let word_idx = idx / 4;
-            let byte_idx = idx % 4;
-            let shift = byte_idx * 8;
-            csprng.key[word_idx] ^= (*byte as u32) << shift;
-        }
+        let mut base = BASE_CRNG.lock();
+        base.mix(data);
+        BASE_GENERATION.fetch_add(1, Ordering::AcqRel);
     }
 }
 
@@ -929,6 +929,8 @@ pub fn write_at(file: &FileRefHandle, offset: usize, data: &[u8]) -> Result<usiz
     drop(ops);
 
     let ret = write_fn(file, offset, data.as_ptr(), data.len());
+    // Legacy ext2 images are cached under filesystem index 0
+    super::vfs::invalidate_file_image(0, file.inode);
     if ret >= 0 {
         Ok(ret as usize)
     } else {
@@ -8,6 +8,7 @@
 //! - Initial RAM filesystem (initramfs/CPIO)
 //! - procfs pseudo-filesystem (Linux-compatible /proc)
 //! - sysfs pseudo-filesystem (Linux-compatible /sys)
+//! - seq_file streaming generation for procfs/sysfs files
 //! - tmpfs in-memory filesystem
 //! - devfs device filesystem
 //! - fstab mount configuration parser
@@ -18,6 +19,7 @@ pub mod ext2_modular;
 pub mod fstab;
 pub mod initramfs;
 pub mod procfs;
+pub mod seq_file;
 pub mod sysfs;
 pub mod tmpfs;
 pub mod traits;
@@ -80,9 +82,9 @@ pub use traits::{
 pub use traits::{
     find_modular_fs, get_mounted_modular_fs, modular_fs_create_file, modular_fs_enable_write,
     modular_fs_get_stats, modular_fs_is_mounted, modular_fs_is_writable, modular_fs_list_dir,
-    modular_fs_lookup, modular_fs_read_at, modular_fs_type_name, modular_fs_write_at,
-    mount_modular_fs, register_modular_fs, unregister_modular_fs, ModularDirCallback,
-    ModularFileHandle, ModularFsOps,
+    modular_fs_lookup, modular_fs_read_at, modular_fs_type_name, modular_fs_unlink,
+    modular_fs_write_at, mount_modular_fs, register_modular_fs, unregister_modular_fs,
+    ModularDirCallback, ModularFileHandle, ModularFsOps,
 };
 
 // Re-export bridge adapters
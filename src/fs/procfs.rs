@@ -9,57 +9,34 @@
 //! - /proc/[pid]/status - Process status information
 //! - /proc/[pid]/stat - Process statistics
 //! - /proc/[pid]/maps - Memory mappings
+//! - /proc/[pid]/schedstat - Run time, run delay and timeslices
+//! - /proc/[pid]/cgroup - Control group membership
 //! - /proc/[pid]/fd/ - File descriptors (directory)
 //! - /proc/cpuinfo - CPU information
 //! - /proc/meminfo - Memory information
 //! - /proc/version - Kernel version
 //! - /proc/uptime - System uptime
+//! - /proc/boottime - Per-stage boot timeline
 //! - /proc/loadavg - Load averages
 //! - /proc/stat - Kernel/system statistics
 //! - /proc/filesystems - Supported filesystems
 //! - /proc/mounts - Current mounts
 //! - /proc/cmdline - Kernel command line
+//! - /proc/pressure/{cpu,memory,io} - Pressure stall information
+//!
+//! Files are generated through `seq_file`: the `show_*` functions below
+//! write into the reader's own buffer when it reads, and multi-record files
+//! (cpuinfo, stat, maps) emit one record per call.
 
+use super::seq_file::{SeqBuf, SeqSource};
 use crate::mm;
 use crate::posix::{FileType, Metadata};
 use crate::process::{Pid, ProcessState, MAX_PROCESSES};
 use crate::scheduler;
+use crate::scheduler::psi::PsiResource;
 use crate::smp;
 use core::fmt::Write;
 
-/// Buffer size for dynamically generated procfs content
-const PROC_BUF_SIZE: usize = 4096;
-
-/// Static buffer for procfs content generation (protected by lock)
-static PROC_BUFFER: spin::Mutex<[u8; PROC_BUF_SIZE]> = spin::Mutex::new([0u8; PROC_BUF_SIZE]);
-
-/// A simple writer that writes to a fixed-size buffer
-struct BufWriter<'a> {
-    buf: &'a mut [u8],
-    pos: usize,
-}
-
-impl<'a> BufWriter<'a> {
-    fn new(buf: &'a mut [u8]) -> Self {
-        Self { buf, pos: 0 }
-    }
-
-    fn len(&self) -> usize {
-        self.pos
-    }
-}
-
-impl<'a> Write for BufWriter<'a> {
-    fn write_str(&mut self, s: &str) -> core::fmt::Result {
-        let bytes = s.as_bytes();
-        let remaining = self.buf.len() - self.pos;
-        let to_write = bytes.len().min(remaining);
-        self.buf[self.pos..self.pos + to_write].copy_from_slice(&bytes[..to_write]);
-        self.pos += to_write;
-        Ok(())
-    }
-}
-
 // =============================================================================
 // CPUID Helper Functions for Real CPU Information
 // =============================================================================
@@ -208,27 +185,16 @@ fn get_cpu_flags() -> &'static str {
     "fpu"
 }
 
-/// Generate /proc/version content
-pub fn generate_version() -> (&'static [u8], usize) {
-    let mut buf = PROC_BUFFER.lock();
-    let mut writer = BufWriter::new(&mut buf[..]);
-
+/// Show /proc/version content
+pub fn show_version(writer: &mut SeqBuf) {
     let _ = writeln!(
         writer,
         "NexaOS version 0.1.0 (rust@nexaos) (rustc 1.75.0) #1 SMP PREEMPT_DYNAMIC"
     );
-
-    let len = writer.len();
-    // SAFETY: Buffer has static lifetime, content is valid until next call
-    let slice = unsafe { core::slice::from_raw_parts(buf.as_ptr(), len) };
-    (slice, len)
 }
 
-/// Generate /proc/uptime content
-pub fn generate_uptime() -> (&'static [u8], usize) {
-    let mut buf = PROC_BUFFER.lock();
-    let mut writer = BufWriter::new(&mut buf[..]);
-
+/// Show /proc/uptime content
+pub fn show_uptime(writer: &mut SeqBuf) {
     // Get tick count (in ms), convert to seconds
     let tick_ms = scheduler::get_tick();
     let uptime_secs = tick_ms / 1000;
@@ -243,21 +209,19 @@ pub fn generate_uptime() -> (&'static [u8], usize) {
         "{}.{:02} {}.{:02}",
         uptime_secs, uptime_frac, idle_secs, idle_frac
     );
+}
 
-    let len = writer.len();
-    let slice = unsafe { core::slice::from_raw_parts(buf.as_ptr(), len) };
-    (slice, len)
+/// Show /proc/boottime content
+pub fn show_boottime(writer: &mut SeqBuf) {
+    let _ = crate::boot::timeline::write_report(&mut writer);
 }
 
-/// Generate /proc/driver/rtc content (minimal subset used by userspace `date`).
+/// Show /proc/driver/rtc content (minimal subset used by userspace `date`).
 ///
 /// Provides:
 /// - rtc_time : HH:MM:SS
 /// - rtc_date : YYYY-MM-DD
-pub fn generate_rtc() -> (&'static [u8], usize) {
-    let mut buf = PROC_BUFFER.lock();
-    let mut writer = BufWriter::new(&mut buf[..]);
-
+pub fn show_rtc(writer: &mut SeqBuf) {
     if let Some(dt) = crate::drivers::rtc::read_datetime() {
         let _ = writeln!(
             writer,
@@ -270,17 +234,10 @@ pub fn generate_rtc() -> (&'static [u8], usize) {
             dt.year, dt.month, dt.day
         );
     }
-
-    let len = writer.len();
-    let slice = unsafe { core::slice::from_raw_parts(buf.as_ptr(), len) };
-    (slice, len)
 }
 
-/// Generate /proc/loadavg content
-pub fn generate_loadavg() -> (&'static [u8], usize) {
-    let mut buf = PROC_BUFFER.lock();
-    let mut writer = BufWriter::new(&mut buf[..]);
-
+/// Show /proc/loadavg content
+pub fn show_loadavg(writer: &mut SeqBuf) {
     let (load1, load5, load15) = scheduler::get_load_average();
     let (ready, running, _sleeping, _zombie) = scheduler::get_process_counts();
     let total_procs = ready + running;
@@ -307,17 +264,10 @@ pub fn generate_loadavg() -> (&'static [u8], usize) {
         total_procs,
         scheduler::get_current_pid().unwrap_or(0)
     );
-
-    let len = writer.len();
-    let slice = unsafe { core::slice::from_raw_parts(buf.as_ptr(), len) };
-    (slice, len)
 }
 
-/// Generate /proc/meminfo content
-pub fn generate_meminfo() -> (&'static [u8], usize) {
-    let mut buf = PROC_BUFFER.lock();
-    let mut writer = BufWriter::new(&mut buf[..]);
-
+/// Show /proc/meminfo content
+pub fn show_meminfo(writer: &mut SeqBuf) {
     // Get real memory statistics from the kernel heap
     let (heap_stats, buddy_stats, slab_stats) = mm::get_memory_stats();
 
@@ -381,102 +331,94 @@ pub fn generate_meminfo() -> (&'static [u8], usize) {
     let _ = writeln!(writer, "VmallocTotal:   {:8} kB", total_kb);
     let _ = writeln!(writer, "VmallocUsed:    {:8} kB", used_kb);
     let _ = writeln!(writer, "VmallocChunk:   {:8} kB", free_kb);
-
-    let len = writer.len();
-    let slice = unsafe { core::slice::from_raw_parts(buf.as_ptr(), len) };
-    (slice, len)
 }
 
-/// Generate /proc/cpuinfo content
-pub fn generate_cpuinfo() -> (&'static [u8], usize) {
-    let mut buf = PROC_BUFFER.lock();
-    let mut writer = BufWriter::new(&mut buf[..]);
-
+/// Show one /proc/cpuinfo record (one processor block per online CPU)
+pub fn show_cpuinfo(_key: u64, cpu: u64, writer: &mut SeqBuf) -> Option<u64> {
     // Get real CPU count from SMP module
     let cpu_count = smp::cpu_count().max(1);
     let online_cpus = smp::online_cpus().max(1);
+    if cpu as usize >= online_cpus {
+        return None;
+    }
+    let cpu_id = cpu as usize;
 
     // Get CPU info via CPUID instruction
     let (vendor_id, family, model, stepping, model_name, cpu_mhz) = get_cpuid_info();
     let flags = get_cpu_flags();
 
-    for cpu_id in 0..online_cpus {
-        let _ = writeln!(writer, "processor\t: {}", cpu_id);
-        let _ = writeln!(writer, "vendor_id\t: {}", vendor_id);
-        let _ = writeln!(writer, "cpu family\t: {}", family);
-        let _ = writeln!(writer, "model\t\t: {}", model);
-        let _ = writeln!(writer, "model name\t: {}", model_name);
-        let _ = writeln!(writer, "stepping\t: {}", stepping);
-        let _ = writeln!(writer, "cpu MHz\t\t: {}.000", cpu_mhz);
-        let _ = writeln!(writer, "cache size\t: 256 KB");
-        let _ = writeln!(writer, "physical id\t: 0");
-        let _ = writeln!(writer, "siblings\t: {}", cpu_count);
-        let _ = writeln!(writer, "core id\t\t: {}", cpu_id);
-        let _ = writeln!(writer, "cpu cores\t: {}", cpu_count);
-        let _ = writeln!(writer, "fpu\t\t: yes");
-        let _ = writeln!(writer, "fpu_exception\t: yes");
-        let _ = writeln!(writer, "cpuid level\t: 20");
-        let _ = writeln!(writer, "wp\t\t: yes");
-        let _ = writeln!(writer, "flags\t\t: {}", flags);
-        let _ = writeln!(writer, "bogomips\t: {}.00", cpu_mhz * 2);
-        let _ = writeln!(writer, "clflush size\t: 64");
-        let _ = writeln!(writer, "cache_alignment\t: 64");
-        let _ = writeln!(writer, "address sizes\t: 48 bits physical, 48 bits virtual");
-        let _ = writeln!(writer, "");
-    }
-
-    let len = writer.len();
-    let slice = unsafe { core::slice::from_raw_parts(buf.as_ptr(), len) };
-    (slice, len)
+    let _ = writeln!(writer, "processor\t: {}", cpu_id);
+    let _ = writeln!(writer, "vendor_id\t: {}", vendor_id);
+    let _ = writeln!(writer, "cpu family\t: {}", family);
+    let _ = writeln!(writer, "model\t\t: {}", model);
+    let _ = writeln!(writer, "model name\t: {}", model_name);
+    let _ = writeln!(writer, "stepping\t: {}", stepping);
+    let _ = writeln!(writer, "cpu MHz\t\t: {}.000", cpu_mhz);
+    let _ = writeln!(writer, "cache size\t: 256 KB");
+    let _ = writeln!(writer, "physical id\t: 0");
+    let _ = writeln!(writer, "siblings\t: {}", cpu_count);
+    let _ = writeln!(writer, "core id\t\t: {}", cpu_id);
+    let _ = writeln!(writer, "cpu cores\t: {}", cpu_count);
+    let _ = writeln!(writer, "fpu\t\t: yes");
+    let _ = writeln!(writer, "fpu_exception\t: yes");
+    let _ = writeln!(writer, "cpuid level\t: 20");
+    let _ = writeln!(writer, "wp\t\t: yes");
+    let _ = writeln!(writer, "flags\t\t: {}", flags);
+    let _ = writeln!(writer, "bogomips\t: {}.00", cpu_mhz * 2);
+    let _ = writeln!(writer, "clflush size\t: 64");
+    let _ = writeln!(writer, "cache_alignment\t: 64");
+    let _ = writeln!(writer, "address sizes\t: 48 bits physical, 48 bits virtual");
+    let _ = writeln!(writer, "");
+
+    Some(cpu + 1)
 }
 
-/// Generate /proc/stat content
-pub fn generate_stat() -> (&'static [u8], usize) {
-    let mut buf = PROC_BUFFER.lock();
-    let mut writer = BufWriter::new(&mut buf[..]);
+/// Show one /proc/stat record: CPU time lines first, then the counters
+pub fn show_stat(_key: u64, record: u64, writer: &mut SeqBuf) -> Option<u64> {
+    match record {
+        0 => {
+            let tick = scheduler::get_tick();
 
-    let tick = scheduler::get_tick();
-    let stats = scheduler::get_stats();
-    let (ready, running, sleeping, zombie) = scheduler::get_process_counts();
+            // CPU statistics (simplified)
+            // Format: cpu user nice system idle iowait irq softirq steal guest guest_nice
+            let user_time = tick / 2;
+            let system_time = tick / 4;
+            let idle_time = tick / 4;
 
-    // CPU statistics (simplified)
-    // Format: cpu user nice system idle iowait irq softirq steal guest guest_nice
-    let user_time = tick / 2;
-    let system_time = tick / 4;
-    let idle_time = tick / 4;
-
-    let _ = writeln!(
-        writer,
-        "cpu  {} 0 {} {} 0 0 0 0 0 0",
-        user_time, system_time, idle_time
-    );
-    let _ = writeln!(
-        writer,
-        "cpu0 {} 0 {} {} 0 0 0 0 0 0",
-        user_time, system_time, idle_time
-    );
-
-    // Context switches
-    let _ = writeln!(writer, "ctxt {}", stats.total_context_switches);
+            let _ = writeln!(
+                writer,
+                "cpu  {} 0 {} {} 0 0 0 0 0 0",
+                user_time, system_time, idle_time
+            );
+            let _ = writeln!(
+                writer,
+                "cpu0 {} 0 {} {} 0 0 0 0 0 0",
+                user_time, system_time, idle_time
+            );
+            Some(1)
+        }
+        1 => {
+            let stats = scheduler::get_stats();
+            let (ready, running, sleeping, zombie) = scheduler::get_process_counts();
 
-    // Boot time (placeholder)
-    let _ = writeln!(writer, "btime 0");
+            // Context switches
+            let _ = writeln!(writer, "ctxt {}", stats.total_context_switches);
 
-    // Processes
-    let _ = writeln!(writer, "processes {}", ready + running + sleeping + zombie);
-    let _ = writeln!(writer, "procs_running {}", running);
-    let _ = writeln!(writer, "procs_blocked {}", sleeping);
+            // Boot time (placeholder)
+            let _ = writeln!(writer, "btime 0");
 
-    let len = writer.len();
-    let slice = unsafe { core::slice::from_raw_parts(buf.as_ptr(), len) };
-    (slice, len)
+            // Processes
+            let _ = writeln!(writer, "processes {}", ready + running + sleeping + zombie);
+            let _ = writeln!(writer, "procs_running {}", running);
+            let _ = writeln!(writer, "procs_blocked {}", sleeping);
+            Some(2)
+        }
+        _ => None,
+    }
 }
 
-/// Generate /proc/filesystems content
-pub fn generate_filesystems() -> (&'static [u8], usize) {
-    let mut buf = PROC_BUFFER.lock();
-    let mut writer = BufWriter::new(&mut buf[..]);
-
+/// Show /proc/filesystems content
+pub fn show_filesystems(writer: &mut SeqBuf) {
     let _ = writeln!(writer, "nodev\tproc");
     let _ = writeln!(writer, "nodev\tsysfs");
     let _ = writeln!(writer, "nodev\tdevtmpfs");
@@ -484,17 +426,10 @@ pub fn generate_filesystems() -> (&'static [u8], usize) {
     let _ = writeln!(writer, "\text2");
     let _ = writeln!(writer, "\text3");
     let _ = writeln!(writer, "\text4");
-
-    let len = writer.len();
-    let slice = unsafe { core::slice::from_raw_parts(buf.as_ptr(), len) };
-    (slice, len)
 }
 
-/// Generate /proc/mounts content
-pub fn generate_mounts() -> (&'static [u8], usize) {
-    let mut buf = PROC_BUFFER.lock();
-    let mut writer = BufWriter::new(&mut buf[..]);
-
+/// Show /proc/mounts content
+pub fn show_mounts(writer: &mut SeqBuf) {
     // Format: device mountpoint fstype options dump pass
 
     // Base mounts that are always present
@@ -552,44 +487,25 @@ pub fn generate_mounts() -> (&'static [u8], usize) {
             mount.device, mount.mount_point, mount.fs_type, mount.options
         );
     }
-
-    let len = writer.len();
-    let slice = unsafe { core::slice::from_raw_parts(buf.as_ptr(), len) };
-    (slice, len)
 }
 
-/// Generate /proc/cmdline content
-pub fn generate_cmdline() -> (&'static [u8], usize) {
-    let mut buf = PROC_BUFFER.lock();
-    let mut writer = BufWriter::new(&mut buf[..]);
-
+/// Show /proc/cmdline content
+pub fn show_cmdline(writer: &mut SeqBuf) {
     // Kernel command line (placeholder)
     let _ = writeln!(writer, "root=/dev/vda1 console=ttyS0 quiet");
-
-    let len = writer.len();
-    let slice = unsafe { core::slice::from_raw_parts(buf.as_ptr(), len) };
-    (slice, len)
 }
 
-/// Generate /proc/self symlink target (returns current PID as string)
-pub fn generate_self() -> (&'static [u8], usize) {
-    let mut buf = PROC_BUFFER.lock();
-    let mut writer = BufWriter::new(&mut buf[..]);
-
+/// Show /proc/self symlink target (returns current PID as string)
+pub fn show_self(writer: &mut SeqBuf) {
     let pid = scheduler::get_current_pid().unwrap_or(1);
     let _ = write!(writer, "{}", pid);
-
-    let len = writer.len();
-    let slice = unsafe { core::slice::from_raw_parts(buf.as_ptr(), len) };
-    (slice, len)
 }
 
-/// Generate /proc/[pid]/status content
-pub fn generate_pid_status(pid: Pid) -> Option<(&'static [u8], usize)> {
-    let process = scheduler::get_process(pid)?;
-
-    let mut buf = PROC_BUFFER.lock();
-    let mut writer = BufWriter::new(&mut buf[..]);
+/// Show /proc/[pid]/status content
+pub fn show_pid_status(pid: Pid, writer: &mut SeqBuf) -> bool {
+    let Some(process) = scheduler::get_process(pid) else {
+        return false;
+    };
 
     let state_char = match process.state {
         ProcessState::Running => 'R',
@@ -637,17 +553,14 @@ pub fn generate_pid_status(pid: Pid) -> Option<(&'static [u8], usize)> {
     let _ = writeln!(writer, "voluntary_ctxt_switches:\t0");
     let _ = writeln!(writer, "nonvoluntary_ctxt_switches:\t0");
 
-    let len = writer.len();
-    let slice = unsafe { core::slice::from_raw_parts(buf.as_ptr(), len) };
-    Some((slice, len))
+    true
 }
 
-/// Generate /proc/[pid]/stat content (single line format)
-pub fn generate_pid_stat(pid: Pid) -> Option<(&'static [u8], usize)> {
-    let process = scheduler::get_process(pid)?;
-
-    let mut buf = PROC_BUFFER.lock();
-    let mut writer = BufWriter::new(&mut buf[..]);
+/// Show /proc/[pid]/stat content (single line format)
+pub fn show_pid_stat(pid: Pid, writer: &mut SeqBuf) -> bool {
+    let Some(process) = scheduler::get_process(pid) else {
+        return false;
+    };
 
     let state_char = match process.state {
         ProcessState::Running => 'R',
@@ -669,97 +582,166 @@ pub fn generate_pid_stat(pid: Pid) -> Option<(&'static [u8], usize)> {
         process.memory_size
     );
 
-    let len = writer.len();
-    let slice = unsafe { core::slice::from_raw_parts(buf.as_ptr(), len) };
-    Some((slice, len))
+    true
 }
 
-/// Generate /proc/[pid]/cmdline content
-pub fn generate_pid_cmdline(pid: Pid) -> Option<(&'static [u8], usize)> {
-    let process = scheduler::get_process(pid)?;
+/// Show /proc/[pid]/cmdline content
+pub fn show_pid_cmdline(pid: Pid, writer: &mut SeqBuf) -> bool {
+    let Some(process) = scheduler::get_process(pid) else {
+        return false;
+    };
 
-    let mut buf = PROC_BUFFER.lock();
+    let len = process.cmdline_len.min(process.cmdline.len());
+    writer.write_bytes(&process.cmdline[..len]);
+    true
+}
 
-    // Copy the process cmdline to the buffer
-    let len = process.cmdline_len.min(PROC_BUF_SIZE);
-    buf[..len].copy_from_slice(&process.cmdline[..len]);
+/// Show /proc/[pid]/schedstat content
+pub fn show_pid_schedstat(pid: Pid, writer: &mut SeqBuf) -> bool {
+    let Some(info) = scheduler::get_process_schedstat(pid) else {
+        return false;
+    };
 
-    // Return the slice with actual cmdline data
-    let slice = unsafe { core::slice::from_raw_parts(buf.as_ptr(), len) };
-    Some((slice, len))
+    // Format: run_time_ns run_delay_ns timeslices
+    let _ = writeln!(
+        writer,
+        "{} {} {}",
+        info.run_ns, info.run_delay_ns, info.timeslices
+    );
+    true
 }
 
-/// Generate /proc/[pid]/maps content
-///
-/// Format matches Linux /proc/[pid]/maps:
-/// address           perms offset  dev   inode pathname
-/// 00400000-00452000 r-xp 00000000 08:02 173521 /usr/bin/dbus-daemon
-pub fn generate_pid_maps(pid: Pid) -> Option<(&'static [u8], usize)> {
-    let process = scheduler::get_process(pid)?;
+/// Show /proc/[pid]/cgroup content
+pub fn show_pid_cgroup(pid: Pid, writer: &mut SeqBuf) -> bool {
+    let Some(id) = scheduler::cgroup::cgroup_of(pid) else {
+        return false;
+    };
 
-    let mut buf = PROC_BUFFER.lock();
-    let mut writer = BufWriter::new(&mut buf[..]);
+    // Format (cgroup v2): hierarchy-id::path
+    let _ = write!(writer, "0::");
+    if scheduler::cgroup::write_path(id, writer).is_err() {
+        return false;
+    }
+    let _ = writeln!(writer);
+    true
+}
 
-    // Try to get VMA information from the new VMA system
-    // TODO: When VMA is fully integrated, use AddressSpace::iter()
+/// Show /proc/pressure/<resource> content (key is a `PsiResource`)
+pub fn show_pressure(resource: u64, writer: &mut SeqBuf) -> bool {
+    let Some(&res) = PsiResource::ALL.get(resource as usize) else {
+        return false;
+    };
+    let _ = scheduler::psi::system_pressure().write_report(res, writer);
+    true
+}
 
+/// One line of /proc/[pid]/maps
+struct MapsEntry {
+    start: u64,
+    end: u64,
+    perms: [u8; 4],
+    offset: u64,
+    inode: u64,
+    name: &'static str,
+}
+
+/// Fixed regions every process has (text, heap, interpreter, stack)
+fn process_regions(pid: Pid) -> Option<[Option<MapsEntry>; 4]> {
     use crate::process::{INTERP_BASE, STACK_BASE, STACK_SIZE, USER_VIRT_BASE};
 
-    // Code segment (from entry point)
-    let code_end = process.heap_start;
-    if code_end > USER_VIRT_BASE {
-        let _ = writeln!(
-            writer,
-            "{:016x}-{:016x} r-xp 00000000 00:00 0                    [text]",
-            USER_VIRT_BASE, code_end
-        );
-    }
+    let process = scheduler::get_process(pid)?;
+    let region = |start, end, perms: &[u8; 4], name| {
+        (end > start).then(|| MapsEntry {
+            start,
+            end,
+            perms: *perms,
+            offset: 0,
+            inode: 0,
+            name,
+        })
+    };
 
-    // Data/BSS (between code and heap)
-    // This is implicit in the text segment for now
+    Some([
+        // Code segment (from entry point); data/BSS is implicit in it for now
+        region(USER_VIRT_BASE, process.heap_start, b"r-xp", "[text]"),
+        region(process.heap_start, process.heap_end, b"rw-p", "[heap]"),
+        // Interpreter/Dynamic linker region (if used)
+        if process.entry_point >= INTERP_BASE {
+            region(INTERP_BASE, INTERP_BASE + 0x100000, b"r-xp", "[ld-nrlib]")
+        } else {
+            None
+        },
+        region(STACK_BASE, STACK_BASE + STACK_SIZE, b"rw-p", "[stack]"),
+    ])
+}
 
-    // Heap
-    if process.heap_end > process.heap_start {
-        let _ = writeln!(
-            writer,
-            "{:016x}-{:016x} rw-p 00000000 00:00 0                    [heap]",
-            process.heap_start, process.heap_end
-        );
-    }
+/// First mmap'd VMA starting at or above `addr`
+fn next_vma(pid: Pid, addr: u64) -> Option<MapsEntry> {
+    use crate::mm::vma::{VMABacking, MAX_ADDRESS_SPACES};
 
-    // Interpreter/Dynamic linker region (if used)
-    if process.entry_point >= INTERP_BASE {
-        let _ = writeln!(
-            writer,
-            "{:016x}-{:016x} r-xp 00000000 00:00 0                    [ld-nrlib]",
-            INTERP_BASE,
-            INTERP_BASE + 0x100000
-        );
+    if pid as usize >= MAX_ADDRESS_SPACES {
+        return None;
+    }
+    let spaces = crate::syscalls::memory_vma::get_address_spaces();
+    let space = &spaces[pid as usize];
+    if !space.valid {
+        return None;
     }
 
-    // Stack (grows down, so show used portion)
-    let stack_bottom = STACK_BASE;
-    let stack_top = STACK_BASE + STACK_SIZE;
+    let vma = space.vmas.iter().find(|vma| vma.start >= addr)?;
+    let (offset, inode) = match vma.backing {
+        VMABacking::File { inode, offset } => (offset, inode),
+        _ => (0, 0),
+    };
+    Some(MapsEntry {
+        start: vma.start,
+        end: vma.end,
+        perms: [
+            if vma.perm.is_read() { b'r' } else { b'-' },
+            if vma.perm.is_write() { b'w' } else { b'-' },
+            if vma.perm.is_exec() { b'x' } else { b'-' },
+            if vma.flags.is_shared() { b's' } else { b'p' },
+        ],
+        offset,
+        inode,
+        name: "",
+    })
+}
+
+/// Show one /proc/[pid]/maps line.
+///
+/// Format matches Linux /proc/[pid]/maps:
+/// address           perms offset  dev   inode pathname
+/// 00400000-00452000 r-xp 00000000 08:02 173521 /usr/bin/dbus-daemon
+///
+/// The cursor is an address: each call emits the lowest region starting at
+/// or above it, so a read resumes correctly even if mappings changed.
+pub fn show_pid_maps(pid: Pid, addr: u64, writer: &mut SeqBuf) -> Option<u64> {
+    let fixed = process_regions(pid)?;
+    let entry = fixed
+        .into_iter()
+        .flatten()
+        .chain(next_vma(pid, addr))
+        .filter(|entry| entry.start >= addr)
+        .min_by_key(|entry| entry.start)?;
+
     let _ = writeln!(
         writer,
-        "{:016x}-{:016x} rw-p 00000000 00:00 0                    [stack]",
-        stack_bottom, stack_top
+        "{:016x}-{:016x} {} {:08x} 00:00 {:<20} {}",
+        entry.start,
+        entry.end,
+        core::str::from_utf8(&entry.perms).unwrap_or("----"),
+        entry.offset,
+        entry.inode,
+        entry.name
     );
 
-    // vDSO (Virtual Dynamic Shared Object) - not yet implemented
-    // let _ = writeln!(writer, "ffffffffff600000-ffffffffff601000 r-xp 00000000 00:00 0 [vsyscall]");
-
-    let len = writer.len();
-    let slice = unsafe { core::slice::from_raw_parts(buf.as_ptr(), len) };
-    Some((slice, len))
+    Some(entry.end.max(entry.start + 1))
 }
 
-/// Generate /proc/swaps content
+/// Show /proc/swaps content
 /// Format: Filename    Type        Size    Used    Priority
-pub fn generate_swaps() -> (&'static [u8], usize) {
-    let mut buf = PROC_BUFFER.lock();
-    let mut writer = BufWriter::new(&mut buf[..]);
-
+pub fn show_swaps(writer: &mut SeqBuf) {
     // Header line (Linux-compatible)
     let _ = writeln!(writer, "Filename\t\t\t\tType\t\tSize\t\tUsed\t\tPriority");
 
@@ -782,10 +764,42 @@ pub fn generate_swaps() -> (&'static [u8], usize) {
             path, swap_type, info.size_kb, info.used_kb, info.priority
         );
     }
+}
+
+/// seq_file source for a global /proc file (None if unknown)
+pub fn global_source(name: &str) -> Option<SeqSource> {
+    Some(match name {
+        "version" => SeqSource::Single(show_version),
+        "uptime" => SeqSource::Single(show_uptime),
+        "boottime" => SeqSource::Single(show_boottime),
+        "loadavg" => SeqSource::Single(show_loadavg),
+        "meminfo" => SeqSource::Single(show_meminfo),
+        "cpuinfo" => SeqSource::Records(show_cpuinfo, 0),
+        "stat" => SeqSource::Records(show_stat, 0),
+        "filesystems" => SeqSource::Single(show_filesystems),
+        "mounts" => SeqSource::Single(show_mounts),
+        "cmdline" => SeqSource::Single(show_cmdline),
+        "swaps" => SeqSource::Single(show_swaps),
+        "driver/rtc" => SeqSource::Single(show_rtc),
+        "self" => SeqSource::Single(show_self),
+        _ => {
+            let res = PsiResource::from_name(name.strip_prefix("pressure/")?)?;
+            SeqSource::Keyed(show_pressure, res as u64)
+        }
+    })
+}
 
-    let len = writer.len();
-    let slice = unsafe { core::slice::from_raw_parts(buf.as_ptr(), len) };
-    (slice, len)
+/// seq_file source for a /proc/[pid]/ file (None if unknown)
+pub fn pid_source(pid: Pid, name: &str) -> Option<SeqSource> {
+    Some(match name {
+        "status" => SeqSource::Keyed(show_pid_status, pid),
+        "stat" => SeqSource::Keyed(show_pid_stat, pid),
+        "cmdline" => SeqSource::Keyed(show_pid_cmdline, pid),
+        "maps" => SeqSource::Records(show_pid_maps, pid),
+        "schedstat" => SeqSource::Keyed(show_pid_schedstat, pid),
+        "cgroup" => SeqSource::Keyed(show_pid_cgroup, pid),
+        _ => return None,
+    })
 }
 
 /// Check if a PID exists in the process table
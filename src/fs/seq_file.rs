@@ -0,0 +1,234 @@
+//! seq_file - Streaming Pseudo-File Generation
+//!
+//! procfs and sysfs files are produced on demand, one record at a time,
+//! instead of being rendered in full into a shared static buffer at open:
+//!
+//! - **Sources** (`SeqSource`) describe how to produce a file. They are
+//!   plain function pointers plus a key, so they fit in `FileContent`.
+//! - **Per-open state** (`SeqFile`) lives in a slot allocated when the file
+//!   is opened. It holds the record cursor and a private buffer with the
+//!   bytes generated but not yet read.
+//!
+//! A read at the current offset only generates the records it needs. A
+//! read before the buffered window (seek backwards, `pread` at 0) restarts
+//! the source from its first record, like Linux's seq_file. Long tables
+//! like `/proc/<pid>/maps` are never truncated, and nothing is shared
+//! between readers except the slot table, whose entries are locked
+//! individually.
+
+use alloc::vec::Vec;
+use core::fmt;
+use spin::Mutex;
+
+/// Maximum number of simultaneously open seq files
+pub const MAX_SEQ_FILES: usize = 32;
+
+/// Output buffer handed to show functions
+pub struct SeqBuf {
+    data: Vec<u8>,
+}
+
+impl SeqBuf {
+    pub const fn new() -> Self {
+        Self { data: Vec::new() }
+    }
+
+    /// Append raw bytes (for binary content such as cmdline)
+    pub fn write_bytes(&mut self, bytes: &[u8]) {
+        self.data.extend_from_slice(bytes);
+    }
+
+    pub fn len(&self) -> usize {
+        self.data.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.data.is_empty()
+    }
+
+    pub fn as_bytes(&self) -> &[u8] {
+        &self.data
+    }
+}
+
+impl fmt::Write for SeqBuf {
+    fn write_str(&mut self, s: &str) -> fmt::Result {
+        self.data.extend_from_slice(s.as_bytes());
+        Ok(())
+    }
+}
+
+/// Emit the record at `cursor` for object `key`.
+///
+/// Returns the cursor of the next record, or None once past the last
+/// record. A call may emit nothing (e.g. an optional line) and still
+/// return a next cursor.
+pub type RecordFn = fn(key: u64, cursor: u64, out: &mut SeqBuf) -> Option<u64>;
+
+/// How a seq file is produced
+#[derive(Clone, Copy)]
+pub enum SeqSource {
+    /// Whole file from one call
+    Single(fn(&mut SeqBuf)),
+    /// Whole file from one call for object `key` (e.g. a PID). Returns
+    /// false if the object no longer exists.
+    Keyed(fn(u64, &mut SeqBuf) -> bool, u64),
+    /// One record per call, starting at cursor 0
+    Records(RecordFn, u64),
+}
+
+impl SeqSource {
+    /// Produce the next chunk. Returns the next cursor, or None at EOF.
+    fn show(&self, cursor: u64, out: &mut SeqBuf) -> Option<u64> {
+        match *self {
+            SeqSource::Single(show) => {
+                show(out);
+                None
+            }
+            SeqSource::Keyed(show, key) => {
+                show(key, out);
+                None
+            }
+            SeqSource::Records(show, key) => show(key, cursor, out),
+        }
+    }
+
+    /// Render the whole file (for in-kernel readers)
+    pub fn render(&self) -> Vec<u8> {
+        let mut out = SeqBuf::new();
+        let mut cursor = Some(0);
+        while let Some(pos) = cursor {
+            cursor = self.show(pos, &mut out);
+        }
+        out.data
+    }
+}
+
+/// Per-open iteration state
+struct SeqFile {
+    source: SeqSource,
+    /// Cursor of the next record to generate (None once the source is done)
+    cursor: Option<u64>,
+    /// Generated bytes not yet consumed
+    buf: SeqBuf,
+    /// File offset of `buf[0]`
+    buf_offset: usize,
+    /// File handles referring to this slot (dup shares the offset state)
+    refs: u32,
+}
+
+impl SeqFile {
+    fn new(source: SeqSource) -> Self {
+        Self {
+            source,
+            cursor: Some(0),
+            buf: SeqBuf::new(),
+            buf_offset: 0,
+            refs: 1,
+        }
+    }
+
+    fn restart(&mut self) {
+        self.cursor = Some(0);
+        self.buf.data.clear();
+        self.buf_offset = 0;
+    }
+
+    /// Drop buffered bytes before `offset`
+    fn discard_before(&mut self, offset: usize) {
+        let end = self.buf_offset + self.buf.len();
+        if offset >= end {
+            self.buf.data.clear();
+            self.buf_offset = end;
+        } else if offset > self.buf_offset {
+            self.buf.data.drain(..offset - self.buf_offset);
+            self.buf_offset = offset;
+        }
+    }
+
+    fn read_at(&mut self, offset: usize, out: &mut [u8]) -> usize {
+        if offset < self.buf_offset {
+            self.restart();
+        }
+
+        loop {
+            self.discard_before(offset);
+            if self.buf_offset == offset && self.buf.len() >= out.len() {
+                break;
+            }
+            let Some(cursor) = self.cursor else {
+                break;
+            };
+            self.cursor = self.source.show(cursor, &mut self.buf);
+        }
+
+        if self.buf_offset != offset {
+            // Offset is past the end of the file
+            return 0;
+        }
+        let n = self.buf.len().min(out.len());
+        out[..n].copy_from_slice(&self.buf.data[..n]);
+        n
+    }
+}
+
+static SEQ_FILES: [Mutex<Option<SeqFile>>; MAX_SEQ_FILES] =
+    [const { Mutex::new(None) }; MAX_SEQ_FILES];
+
+/// Allocate per-open state for `source`. Returns the slot id.
+pub fn open(source: SeqSource) -> Option<u32> {
+    for (id, slot) in SEQ_FILES.iter().enumerate() {
+        // A locked slot is in use by a reader; skip it
+        let Some(mut slot) = slot.try_lock() else {
+            continue;
+        };
+        if slot.is_none() {
+            *slot = Some(SeqFile::new(source));
+            return Some(id as u32);
+        }
+    }
+    None
+}
+
+/// Read from seq file `id` at `offset`. Returns the number of bytes copied
+/// (0 at end of file or for an invalid id).
+pub fn read_at(id: u32, offset: usize, out: &mut [u8]) -> usize {
+    let Some(slot) = SEQ_FILES.get(id as usize) else {
+        return 0;
+    };
+    match slot.lock().as_mut() {
+        Some(file) => file.read_at(offset, out),
+        None => 0,
+    }
+}
+
+/// Take another reference for a duplicated file handle
+pub fn dup(id: u32) {
+    if let Some(slot) = SEQ_FILES.get(id as usize) {
+        if let Some(file) = slot.lock().as_mut() {
+            file.refs += 1;
+        }
+    }
+}
+
+/// Drop a reference; frees the slot with the last one
+pub fn release(id: u32) {
+    let Some(slot) = SEQ_FILES.get(id as usize) else {
+        return;
+    };
+    let mut slot = slot.lock();
+    if let Some(file) = slot.as_mut() {
+        file.refs -= 1;
+        if file.refs == 0 {
+            *slot = None;
+        }
+    }
+}
+
+/// Number of seq files currently open
+pub fn open_count() -> usize {
+    SEQ_FILES
+        .iter()
+        .filter(|slot| slot.lock().is_some())
+        .count()
+}
@@ -22,45 +22,18 @@
 //! - /sys/block/ - Block device information
 //! - /sys/bus/ - Bus types
 //! - /sys/fs/ - Filesystem information
+//! - /sys/fs/cgroup/[group]/ - Control group knobs and statistics (read-only)
 //! - /sys/power/state - Power management state
 //! - /sys/power/mem_sleep - Memory sleep states
+//!
+//! Attribute files are generated through `seq_file` when read. Per-device
+//! attributes are keyed by the device's index in its class list.
 
+use super::seq_file::{SeqBuf, SeqSource};
 use crate::posix::{FileType, Metadata};
+use crate::scheduler::cgroup;
 use core::fmt::Write;
 
-/// Buffer size for dynamically generated sysfs content
-const SYS_BUF_SIZE: usize = 2048;
-
-/// Static buffer for sysfs content generation (protected by lock)
-static SYS_BUFFER: spin::Mutex<[u8; SYS_BUF_SIZE]> = spin::Mutex::new([0u8; SYS_BUF_SIZE]);
-
-/// A simple writer that writes to a fixed-size buffer
-struct BufWriter<'a> {
-    buf: &'a mut [u8],
-    pos: usize,
-}
-
-impl<'a> BufWriter<'a> {
-    fn new(buf: &'a mut [u8]) -> Self {
-        Self { buf, pos: 0 }
-    }
-
-    fn len(&self) -> usize {
-        self.pos
-    }
-}
-
-impl<'a> Write for BufWriter<'a> {
-    fn write_str(&mut self, s: &str) -> core::fmt::Result {
-        let bytes = s.as_bytes();
-        let remaining = self.buf.len() - self.pos;
-        let to_write = bytes.len().min(remaining);
-        self.buf[self.pos..self.pos + to_write].copy_from_slice(&bytes[..to_write]);
-        self.pos += to_write;
-        Ok(())
-    }
-}
-
 /// NexaOS version string
 const NEXAOS_VERSION: &str = "0.1.0";
 const NEXAOS_OSTYPE: &str = "NexaOS";
@@ -70,126 +43,60 @@ const NEXAOS_HOSTNAME: &str = "nexaos";
 // /sys/kernel/ entries
 // =============================================================================
 
-/// Generate /sys/kernel/version content
-pub fn generate_kernel_version() -> (&'static [u8], usize) {
-    let mut buf = SYS_BUFFER.lock();
-    let mut writer = BufWriter::new(&mut buf[..]);
-
+/// Show /sys/kernel/version content
+pub fn show_kernel_version(writer: &mut SeqBuf) {
     let _ = write!(writer, "{}\n", NEXAOS_VERSION);
-
-    let len = writer.len();
-    let slice = unsafe { core::slice::from_raw_parts(buf.as_ptr(), len) };
-    (slice, len)
 }
 
-/// Generate /sys/kernel/ostype content
-pub fn generate_kernel_ostype() -> (&'static [u8], usize) {
-    let mut buf = SYS_BUFFER.lock();
-    let mut writer = BufWriter::new(&mut buf[..]);
-
+/// Show /sys/kernel/ostype content
+pub fn show_kernel_ostype(writer: &mut SeqBuf) {
     let _ = write!(writer, "{}\n", NEXAOS_OSTYPE);
-
-    let len = writer.len();
-    let slice = unsafe { core::slice::from_raw_parts(buf.as_ptr(), len) };
-    (slice, len)
 }
 
-/// Generate /sys/kernel/osrelease content
-pub fn generate_kernel_osrelease() -> (&'static [u8], usize) {
-    let mut buf = SYS_BUFFER.lock();
-    let mut writer = BufWriter::new(&mut buf[..]);
-
+/// Show /sys/kernel/osrelease content
+pub fn show_kernel_osrelease(writer: &mut SeqBuf) {
     let _ = write!(writer, "{}\n", NEXAOS_VERSION);
-
-    let len = writer.len();
-    let slice = unsafe { core::slice::from_raw_parts(buf.as_ptr(), len) };
-    (slice, len)
 }
 
-/// Generate /sys/kernel/hostname content
-pub fn generate_kernel_hostname() -> (&'static [u8], usize) {
-    let mut buf = SYS_BUFFER.lock();
-    let mut writer = BufWriter::new(&mut buf[..]);
-
+/// Show /sys/kernel/hostname content
+pub fn show_kernel_hostname(writer: &mut SeqBuf) {
     let _ = write!(writer, "{}\n", NEXAOS_HOSTNAME);
-
-    let len = writer.len();
-    let slice = unsafe { core::slice::from_raw_parts(buf.as_ptr(), len) };
-    (slice, len)
 }
 
-/// Generate /sys/kernel/ngroups_max content
-pub fn generate_kernel_ngroups_max() -> (&'static [u8], usize) {
-    let mut buf = SYS_BUFFER.lock();
-    let mut writer = BufWriter::new(&mut buf[..]);
-
+/// Show /sys/kernel/ngroups_max content
+pub fn show_kernel_ngroups_max(writer: &mut SeqBuf) {
     let _ = write!(writer, "65536\n");
-
-    let len = writer.len();
-    let slice = unsafe { core::slice::from_raw_parts(buf.as_ptr(), len) };
-    (slice, len)
 }
 
-/// Generate /sys/kernel/pid_max content
-pub fn generate_kernel_pid_max() -> (&'static [u8], usize) {
-    let mut buf = SYS_BUFFER.lock();
-    let mut writer = BufWriter::new(&mut buf[..]);
-
+/// Show /sys/kernel/pid_max content
+pub fn show_kernel_pid_max(writer: &mut SeqBuf) {
     // Use MAX_PROCESSES from process module
     let _ = write!(writer, "{}\n", crate::process::MAX_PROCESSES);
-
-    let len = writer.len();
-    let slice = unsafe { core::slice::from_raw_parts(buf.as_ptr(), len) };
-    (slice, len)
 }
 
-/// Generate /sys/kernel/threads-max content
-pub fn generate_kernel_threads_max() -> (&'static [u8], usize) {
-    let mut buf = SYS_BUFFER.lock();
-    let mut writer = BufWriter::new(&mut buf[..]);
-
+/// Show /sys/kernel/threads-max content
+pub fn show_kernel_threads_max(writer: &mut SeqBuf) {
     let _ = write!(writer, "{}\n", crate::process::MAX_PROCESSES * 4);
-
-    let len = writer.len();
-    let slice = unsafe { core::slice::from_raw_parts(buf.as_ptr(), len) };
-    (slice, len)
 }
 
 // =============================================================================
 // /sys/kernel/random/ entries
 // =============================================================================
 
-/// Generate /sys/kernel/random/entropy_avail content
-pub fn generate_random_entropy_avail() -> (&'static [u8], usize) {
-    let mut buf = SYS_BUFFER.lock();
-    let mut writer = BufWriter::new(&mut buf[..]);
-
+/// Show /sys/kernel/random/entropy_avail content
+pub fn show_random_entropy_avail(writer: &mut SeqBuf) {
     // Get actual entropy value from random driver
     let entropy = crate::drivers::entropy_available();
     let _ = write!(writer, "{}\n", entropy);
-
-    let len = writer.len();
-    let slice = unsafe { core::slice::from_raw_parts(buf.as_ptr(), len) };
-    (slice, len)
 }
 
-/// Generate /sys/kernel/random/poolsize content
-pub fn generate_random_poolsize() -> (&'static [u8], usize) {
-    let mut buf = SYS_BUFFER.lock();
-    let mut writer = BufWriter::new(&mut buf[..]);
-
+/// Show /sys/kernel/random/poolsize content
+pub fn show_random_poolsize(writer: &mut SeqBuf) {
     let _ = write!(writer, "4096\n");
-
-    let len = writer.len();
-    let slice = unsafe { core::slice::from_raw_parts(buf.as_ptr(), len) };
-    (slice, len)
 }
 
-/// Generate /sys/kernel/random/uuid content
-pub fn generate_random_uuid() -> (&'static [u8], usize) {
-    let mut buf = SYS_BUFFER.lock();
-    let mut writer = BufWriter::new(&mut buf[..]);
-
+/// Show /sys/kernel/random/uuid content
+pub fn show_random_uuid(writer: &mut SeqBuf) {
     // Generate a version 4 (random) UUID using hardware RNG
     let r1 = crate::drivers::get_random_u64();
     let r2 = crate::drivers::get_random_u64();
@@ -205,40 +112,22 @@ pub fn generate_random_uuid() -> (&'static [u8], usize) {
         0x8000 | ((r2 >> 48) & 0x3FFF) as u16, // Variant 1 (RFC 4122)
         r2 & 0xFFFFFFFFFFFF
     );
-
-    let len = writer.len();
-    let slice = unsafe { core::slice::from_raw_parts(buf.as_ptr(), len) };
-    (slice, len)
 }
 
 // =============================================================================
 // /sys/power/ entries
 // =============================================================================
 
-/// Generate /sys/power/state content
-pub fn generate_power_state() -> (&'static [u8], usize) {
-    let mut buf = SYS_BUFFER.lock();
-    let mut writer = BufWriter::new(&mut buf[..]);
-
+/// Show /sys/power/state content
+pub fn show_power_state(writer: &mut SeqBuf) {
     // Available power states
     let _ = write!(writer, "freeze mem disk\n");
-
-    let len = writer.len();
-    let slice = unsafe { core::slice::from_raw_parts(buf.as_ptr(), len) };
-    (slice, len)
 }
 
-/// Generate /sys/power/mem_sleep content
-pub fn generate_power_mem_sleep() -> (&'static [u8], usize) {
-    let mut buf = SYS_BUFFER.lock();
-    let mut writer = BufWriter::new(&mut buf[..]);
-
+/// Show /sys/power/mem_sleep content
+pub fn show_power_mem_sleep(writer: &mut SeqBuf) {
     // Available sleep states, current in brackets
     let _ = write!(writer, "s2idle [deep]\n");
-
-    let len = writer.len();
-    let slice = unsafe { core::slice::from_raw_parts(buf.as_ptr(), len) };
-    (slice, len)
 }
 
 // =============================================================================
@@ -267,84 +156,81 @@ pub fn get_net_devices() -> &'static [&'static str] {
 // /sys/block/[device]/ entries
 // =============================================================================
 
-/// Generate /sys/block/[device]/size content (in 512-byte sectors)
-pub fn generate_block_size(device: &str) -> Option<(&'static [u8], usize)> {
-    let mut buf = SYS_BUFFER.lock();
-    let mut writer = BufWriter::new(&mut buf[..]);
+/// Show /sys/block/[device]/size content (in 512-byte sectors)
+pub fn show_block_size(dev: u64, writer: &mut SeqBuf) -> bool {
+    let Some(&device) = get_block_devices().get(dev as usize) else {
+        return false;
+    };
 
     // Return a reasonable size for virtual disk (256MB in sectors)
     let sectors: u64 = match device {
         "vda" => 256 * 1024 * 2,  // 256 MB
         "vda1" => 255 * 1024 * 2, // Slightly smaller for partition
-        _ => return None,
+        _ => return false,
     };
 
     let _ = write!(writer, "{}\n", sectors);
 
-    let len = writer.len();
-    let slice = unsafe { core::slice::from_raw_parts(buf.as_ptr(), len) };
-    Some((slice, len))
+    true
 }
 
-/// Generate /sys/block/[device]/stat content
-pub fn generate_block_stat(device: &str) -> Option<(&'static [u8], usize)> {
+/// Show /sys/block/[device]/stat content
+pub fn show_block_stat(dev: u64, writer: &mut SeqBuf) -> bool {
+    let Some(&device) = get_block_devices().get(dev as usize) else {
+        return false;
+    };
+
     if !["vda", "vda1"].contains(&device) {
-        return None;
+        return false;
     }
 
-    let mut buf = SYS_BUFFER.lock();
-    let mut writer = BufWriter::new(&mut buf[..]);
-
     // Block device statistics format:
     // read_ios read_merges read_sectors read_ticks write_ios write_merges write_sectors write_ticks
     // in_flight io_ticks time_in_queue discard_ios discard_merges discard_sectors discard_ticks
     let _ = write!(writer, "0 0 0 0 0 0 0 0 0 0 0 0 0 0 0\n");
 
-    let len = writer.len();
-    let slice = unsafe { core::slice::from_raw_parts(buf.as_ptr(), len) };
-    Some((slice, len))
+    true
 }
 
-/// Generate /sys/block/[device]/device/model content
-pub fn generate_block_model(device: &str) -> Option<(&'static [u8], usize)> {
+/// Show /sys/block/[device]/device/model content
+pub fn show_block_model(dev: u64, writer: &mut SeqBuf) -> bool {
+    let Some(&device) = get_block_devices().get(dev as usize) else {
+        return false;
+    };
+
     if !["vda", "vda1"].contains(&device) {
-        return None;
+        return false;
     }
 
-    let mut buf = SYS_BUFFER.lock();
-    let mut writer = BufWriter::new(&mut buf[..]);
-
     let _ = write!(writer, "NexaOS Virtual Disk\n");
 
-    let len = writer.len();
-    let slice = unsafe { core::slice::from_raw_parts(buf.as_ptr(), len) };
-    Some((slice, len))
+    true
 }
 
-/// Generate /sys/block/[device]/device/vendor content
-pub fn generate_block_vendor(device: &str) -> Option<(&'static [u8], usize)> {
+/// Show /sys/block/[device]/device/vendor content
+pub fn show_block_vendor(dev: u64, writer: &mut SeqBuf) -> bool {
+    let Some(&device) = get_block_devices().get(dev as usize) else {
+        return false;
+    };
+
     if !["vda", "vda1"].contains(&device) {
-        return None;
+        return false;
     }
 
-    let mut buf = SYS_BUFFER.lock();
-    let mut writer = BufWriter::new(&mut buf[..]);
-
     let _ = write!(writer, "NexaOS\n");
 
-    let len = writer.len();
-    let slice = unsafe { core::slice::from_raw_parts(buf.as_ptr(), len) };
-    Some((slice, len))
+    true
 }
 
 // =============================================================================
 // /sys/class/net/[device]/ entries
 // =============================================================================
 
-/// Generate /sys/class/net/[device]/address content (MAC address)
-pub fn generate_net_address(device: &str) -> Option<(&'static [u8], usize)> {
-    let mut buf = SYS_BUFFER.lock();
-    let mut writer = BufWriter::new(&mut buf[..]);
+/// Show /sys/class/net/[device]/address content (MAC address)
+pub fn show_net_address(dev: u64, writer: &mut SeqBuf) -> bool {
+    let Some(&device) = get_net_devices().get(dev as usize) else {
+        return false;
+    };
 
     match device {
         "lo" => {
@@ -367,90 +253,323 @@ pub fn generate_net_address(device: &str) -> Option<(&'static [u8], usize)> {
                 let _ = write!(writer, "52:54:00:12:34:56\n");
             }
         }
-        _ => return None,
+        _ => return false,
     };
 
-    let len = writer.len();
-    let slice = unsafe { core::slice::from_raw_parts(buf.as_ptr(), len) };
-    Some((slice, len))
+    true
 }
 
-/// Generate /sys/class/net/[device]/mtu content
-pub fn generate_net_mtu(device: &str) -> Option<(&'static [u8], usize)> {
-    let mut buf = SYS_BUFFER.lock();
-    let mut writer = BufWriter::new(&mut buf[..]);
+/// Show /sys/class/net/[device]/mtu content
+pub fn show_net_mtu(dev: u64, writer: &mut SeqBuf) -> bool {
+    let Some(&device) = get_net_devices().get(dev as usize) else {
+        return false;
+    };
 
     let mtu = match device {
         "lo" => 65536,
         "eth0" => 1500,
-        _ => return None,
+        _ => return false,
     };
 
     let _ = write!(writer, "{}\n", mtu);
 
-    let len = writer.len();
-    let slice = unsafe { core::slice::from_raw_parts(buf.as_ptr(), len) };
-    Some((slice, len))
+    true
 }
 
-/// Generate /sys/class/net/[device]/operstate content
-pub fn generate_net_operstate(device: &str) -> Option<(&'static [u8], usize)> {
-    let mut buf = SYS_BUFFER.lock();
-    let mut writer = BufWriter::new(&mut buf[..]);
+/// Show /sys/class/net/[device]/operstate content
+pub fn show_net_operstate(dev: u64, writer: &mut SeqBuf) -> bool {
+    let Some(&device) = get_net_devices().get(dev as usize) else {
+        return false;
+    };
 
     let state = match device {
         "lo" => "unknown",
         "eth0" => "up",
-        _ => return None,
+        _ => return false,
     };
 
     let _ = write!(writer, "{}\n", state);
 
-    let len = writer.len();
-    let slice = unsafe { core::slice::from_raw_parts(buf.as_ptr(), len) };
-    Some((slice, len))
+    true
 }
 
-/// Generate /sys/class/net/[device]/type content (ARPHRD type)
-pub fn generate_net_type(device: &str) -> Option<(&'static [u8], usize)> {
-    let mut buf = SYS_BUFFER.lock();
-    let mut writer = BufWriter::new(&mut buf[..]);
+/// Show /sys/class/net/[device]/type content (ARPHRD type)
+pub fn show_net_type(dev: u64, writer: &mut SeqBuf) -> bool {
+    let Some(&device) = get_net_devices().get(dev as usize) else {
+        return false;
+    };
 
     let dev_type = match device {
         "lo" => 772, // ARPHRD_LOOPBACK
         "eth0" => 1, // ARPHRD_ETHER
-        _ => return None,
+        _ => return false,
     };
 
     let _ = write!(writer, "{}\n", dev_type);
 
-    let len = writer.len();
-    let slice = unsafe { core::slice::from_raw_parts(buf.as_ptr(), len) };
-    Some((slice, len))
+    true
 }
 
-/// Generate /sys/class/net/[device]/flags content
-pub fn generate_net_flags(device: &str) -> Option<(&'static [u8], usize)> {
-    let mut buf = SYS_BUFFER.lock();
-    let mut writer = BufWriter::new(&mut buf[..]);
+/// Show /sys/class/net/[device]/flags content
+pub fn show_net_flags(dev: u64, writer: &mut SeqBuf) -> bool {
+    let Some(&device) = get_net_devices().get(dev as usize) else {
+        return false;
+    };
 
     let flags = match device {
         "lo" => 0x49,     // IFF_UP | IFF_LOOPBACK | IFF_RUNNING
         "eth0" => 0x1003, // IFF_UP | IFF_BROADCAST | IFF_RUNNING
-        _ => return None,
+        _ => return false,
     };
 
     let _ = write!(writer, "0x{:x}\n", flags);
 
-    let len = writer.len();
-    let slice = unsafe { core::slice::from_raw_parts(buf.as_ptr(), len) };
-    Some((slice, len))
+    true
+}
+
+// =============================================================================
+// /sys/fs/cgroup/[group]/ entries (key is the cgroup id)
+// =============================================================================
+
+/// Files in every /sys/fs/cgroup group directory
+pub const CGROUP_FILES: &[&str] = &[
+    "cgroup.procs",
+    "cgroup.controllers",
+    "cpu.weight",
+    "cpu.max",
+    "cpu.stat",
+    "memory.current",
+    "memory.high",
+    "memory.max",
+    "memory.events",
+    "io.weight",
+    "io.stat",
+];
+
+/// Write a limit, "max" when unlimited
+fn write_limit(writer: &mut SeqBuf, value: u64) {
+    if value == cgroup::CGROUP_UNLIMITED {
+        let _ = write!(writer, "max");
+    } else {
+        let _ = write!(writer, "{}", value);
+    }
+}
+
+/// Show /sys/fs/cgroup/[group]/cgroup.procs content
+pub fn show_cgroup_procs(id: u64, writer: &mut SeqBuf) -> bool {
+    if cgroup_stat(id).is_none() {
+        return false;
+    }
+    cgroup::for_each_proc(id as cgroup::CgroupId, |pid| {
+        let _ = writeln!(writer, "{}", pid);
+    });
+    true
+}
+
+fn cgroup_stat(id: u64) -> Option<cgroup::CgroupStat> {
+    cgroup::stat(id as cgroup::CgroupId)
+}
+
+/// Show /sys/fs/cgroup/[group]/cgroup.controllers content
+pub fn show_cgroup_controllers(id: u64, writer: &mut SeqBuf) -> bool {
+    if cgroup_stat(id).is_none() {
+        return false;
+    }
+    let _ = writeln!(writer, "cpu memory io");
+    true
+}
+
+/// Show /sys/fs/cgroup/[group]/cpu.weight content
+pub fn show_cgroup_cpu_weight(id: u64, writer: &mut SeqBuf) -> bool {
+    let Some(stat) = cgroup_stat(id) else {
+        return false;
+    };
+    let _ = writeln!(writer, "{}", stat.cpu_weight);
+    true
+}
+
+/// Show /sys/fs/cgroup/[group]/cpu.max content ("quota period")
+pub fn show_cgroup_cpu_max(id: u64, writer: &mut SeqBuf) -> bool {
+    let Some(stat) = cgroup_stat(id) else {
+        return false;
+    };
+    write_limit(writer, stat.cpu_quota_us);
+    let _ = writeln!(writer, " {}", stat.cpu_period_us);
+    true
+}
+
+/// Show /sys/fs/cgroup/[group]/cpu.stat content
+pub fn show_cgroup_cpu_stat(id: u64, writer: &mut SeqBuf) -> bool {
+    let Some(stat) = cgroup_stat(id) else {
+        return false;
+    };
+    let _ = writeln!(writer, "usage_usec {}", stat.usage_us);
+    let _ = writeln!(writer, "nr_periods {}", stat.nr_periods);
+    let _ = writeln!(writer, "nr_throttled {}", stat.nr_throttled);
+    let _ = writeln!(writer, "throttled_usec {}", stat.throttled_us);
+    true
+}
+
+/// Show /sys/fs/cgroup/[group]/memory.current content
+pub fn show_cgroup_memory_current(id: u64, writer: &mut SeqBuf) -> bool {
+    let Some(stat) = cgroup_stat(id) else {
+        return false;
+    };
+    let _ = writeln!(writer, "{}", stat.memory_current);
+    true
+}
+
+/// Show /sys/fs/cgroup/[group]/memory.high content
+pub fn show_cgroup_memory_high(id: u64, writer: &mut SeqBuf) -> bool {
+    let Some(stat) = cgroup_stat(id) else {
+        return false;
+    };
+    write_limit(writer, stat.memory_high);
+    let _ = writeln!(writer);
+    true
+}
+
+/// Show /sys/fs/cgroup/[group]/memory.max content
+pub fn show_cgroup_memory_max(id: u64, writer: &mut SeqBuf) -> bool {
+    let Some(stat) = cgroup_stat(id) else {
+        return false;
+    };
+    write_limit(writer, stat.memory_max);
+    let _ = writeln!(writer);
+    true
+}
+
+/// Show /sys/fs/cgroup/[group]/memory.events content
+pub fn show_cgroup_memory_events(id: u64, writer: &mut SeqBuf) -> bool {
+    let Some(stat) = cgroup_stat(id) else {
+        return false;
+    };
+    let _ = writeln!(writer, "high {}", stat.memory_events_high);
+    let _ = writeln!(writer, "max {}", stat.memory_events_max);
+    true
+}
+
+/// Show /sys/fs/cgroup/[group]/io.weight content
+pub fn show_cgroup_io_weight(id: u64, writer: &mut SeqBuf) -> bool {
+    let Some(stat) = cgroup_stat(id) else {
+        return false;
+    };
+    let _ = writeln!(writer, "default {}", stat.io_weight);
+    true
+}
+
+/// Show /sys/fs/cgroup/[group]/io.stat content
+pub fn show_cgroup_io_stat(id: u64, writer: &mut SeqBuf) -> bool {
+    let Some(stat) = cgroup_stat(id) else {
+        return false;
+    };
+    let _ = writeln!(
+        writer,
+        "rbytes={} wbytes={} rios={} wios={}",
+        stat.io_rbytes, stat.io_wbytes, stat.io_rios, stat.io_wios
+    );
+    true
+}
+
+/// Split a path below /sys/fs/cgroup into (group id, attribute)
+fn split_cgroup_path(path: &str) -> Option<(cgroup::CgroupId, &str)> {
+    let (group, attr) = path.rsplit_once('/').unwrap_or(("", path));
+    Some((cgroup::lookup(group).ok()?, attr))
+}
+
+/// Whether `path` (below /sys/fs/cgroup) names a group directory
+pub fn cgroup_dir_exists(path: &str) -> bool {
+    cgroup::lookup(path).is_ok()
+}
+
+/// Call `cb` with the names of the child groups of `path`
+pub fn cgroup_children(path: &str, mut cb: impl FnMut(&str)) {
+    let parent = path.trim_matches('/');
+    cgroup::for_each(|_, group| {
+        let child = if parent.is_empty() {
+            Some(group)
+        } else {
+            group
+                .strip_prefix(parent)
+                .and_then(|rest| rest.strip_prefix('/'))
+        };
+        if let Some(name) = child.filter(|name| !name.is_empty() && !name.contains('/')) {
+            cb(name);
+        }
+    });
+}
+
+/// seq_file source for a /sys/fs/cgroup/[group]/ attribute
+pub fn cgroup_source(path: &str) -> Option<SeqSource> {
+    let (id, attr) = split_cgroup_path(path)?;
+    let show: fn(u64, &mut SeqBuf) -> bool = match attr {
+        "cgroup.procs" => show_cgroup_procs,
+        "cgroup.controllers" => show_cgroup_controllers,
+        "cpu.weight" => show_cgroup_cpu_weight,
+        "cpu.max" => show_cgroup_cpu_max,
+        "cpu.stat" => show_cgroup_cpu_stat,
+        "memory.current" => show_cgroup_memory_current,
+        "memory.high" => show_cgroup_memory_high,
+        "memory.max" => show_cgroup_memory_max,
+        "memory.events" => show_cgroup_memory_events,
+        "io.weight" => show_cgroup_io_weight,
+        "io.stat" => show_cgroup_io_stat,
+        _ => return None,
+    };
+    Some(SeqSource::Keyed(show, id as u64))
 }
 
 // =============================================================================
 // Metadata helpers
 // =============================================================================
 
+/// seq_file source for a global /sys file (path relative to /sys)
+pub fn global_source(path: &str) -> Option<SeqSource> {
+    let show: fn(&mut SeqBuf) = match path {
+        "kernel/version" => show_kernel_version,
+        "kernel/ostype" => show_kernel_ostype,
+        "kernel/osrelease" => show_kernel_osrelease,
+        "kernel/hostname" => show_kernel_hostname,
+        "kernel/ngroups_max" => show_kernel_ngroups_max,
+        "kernel/pid_max" => show_kernel_pid_max,
+        "kernel/threads-max" => show_kernel_threads_max,
+        "kernel/random/entropy_avail" => show_random_entropy_avail,
+        "kernel/random/poolsize" => show_random_poolsize,
+        "kernel/random/uuid" => show_random_uuid,
+        "power/state" => show_power_state,
+        "power/mem_sleep" => show_power_mem_sleep,
+        _ => return None,
+    };
+    Some(SeqSource::Single(show))
+}
+
+/// seq_file source for a /sys/block/[device]/ attribute
+pub fn block_source(device: &str, attr: &str) -> Option<SeqSource> {
+    let dev = get_block_devices().iter().position(|&d| d == device)? as u64;
+    let show: fn(u64, &mut SeqBuf) -> bool = match attr {
+        "size" => show_block_size,
+        "stat" => show_block_stat,
+        "device/model" => show_block_model,
+        "device/vendor" => show_block_vendor,
+        _ => return None,
+    };
+    Some(SeqSource::Keyed(show, dev))
+}
+
+/// seq_file source for a /sys/class/net/[device]/ attribute
+pub fn net_source(device: &str, attr: &str) -> Option<SeqSource> {
+    let dev = get_net_devices().iter().position(|&d| d == device)? as u64;
+    let show: fn(u64, &mut SeqBuf) -> bool = match attr {
+        "address" => show_net_address,
+        "mtu" => show_net_mtu,
+        "operstate" => show_net_operstate,
+        "type" => show_net_type,
+        "flags" => show_net_flags,
+        _ => return None,
+    };
+    Some(SeqSource::Keyed(show, dev))
+}
+
 /// Metadata for sysfs file entries
 pub fn sys_file_metadata(size: u64) -> Metadata {
     let mut meta = Metadata::empty()
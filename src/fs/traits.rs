@@ -810,6 +810,8 @@ pub fn modular_fs_write_at(
 
     let write_fn = entry.ops.write_at.ok_or(FsError::NotSupported)?;
     let ret = write_fn(file, offset, data.as_ptr(), data.len());
+    // Even a failed write may have changed some blocks
+    super::vfs::invalidate_file_image(file.fs_index, file.inode);
 
     if ret >= 0 {
         Ok(ret as usize)
@@ -820,6 +822,36 @@ pub fn modular_fs_write_at(
     }
 }
 
+/// Remove a file from a modular filesystem
+pub fn modular_fs_unlink(index: u8, path: &str) -> FsResult<()> {
+    let inode = modular_fs_lookup(index, path)?.inode;
+
+    let registry = MODULAR_FS_REGISTRY.lock();
+    let entry = registry
+        .get(index as usize)
+        .ok_or(FsError::InvalidArgument)?;
+
+    if !entry.active {
+        return Err(FsError::InvalidArgument);
+    }
+
+    let unlink_fn = entry.ops.unlink.ok_or(FsError::NotSupported)?;
+    let handle = entry.handle.ok_or(FsError::InvalidArgument)?;
+
+    let path_bytes = path.as_bytes();
+    let ret = unlink_fn(handle, path_bytes.as_ptr(), path_bytes.len());
+
+    if ret == 0 {
+        // The inode number may be handed to the next file created
+        super::vfs::invalidate_file_image(index, inode);
+        Ok(())
+    } else if ret == -7 {
+        Err(FsError::ReadOnly)
+    } else {
+        Err(FsError::IoError)
+    }
+}
+
 /// List directory in a modular filesystem
 pub fn modular_fs_list_dir(
     index: u8,
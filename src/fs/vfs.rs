@@ -44,6 +44,86 @@ const MODULAR_READ_CACHE_SIZE: usize = 64 * 1024 * 1024; // 64 MiB max file size
 /// loaded for the system lifetime. The vmalloc region (1GB) is more than enough.
 static EMPTY_MODULAR_FILE: [u8; 0] = [];
 
+/// Read-only image cache for executables on modular filesystems.
+///
+/// execve() and the interpreter loader call `read_file_bytes()` on every
+/// exec; without this each call re-read the whole binary into a fresh (never
+/// freed) vmalloc buffer. Entries are keyed by inode identity plus size and
+/// mtime. mtime only has one-second resolution and inode numbers are reused,
+/// so the write, truncate, create and unlink paths also drop the entry of the
+/// inode they touch. Only files with an execute bit are cached - data files
+/// may be rewritten in place.
+#[derive(Clone, Copy)]
+struct CachedFileImage {
+    fs_index: u8,
+    inode: u32,
+    size: u64,
+    mtime: u64,
+    bytes: &'static [u8],
+}
+
+const MAX_CACHED_FILE_IMAGES: usize = 32;
+static FILE_IMAGE_CACHE: Mutex<[Option<CachedFileImage>; MAX_CACHED_FILE_IMAGES]> =
+    Mutex::new([None; MAX_CACHED_FILE_IMAGES]);
+
+fn is_cacheable_image(handle: &ModularFileHandle) -> bool {
+    handle.mode & 0o111 != 0
+}
+
+pub(crate) fn lookup_file_image(handle: &ModularFileHandle) -> Option<&'static [u8]> {
+    let cache = FILE_IMAGE_CACHE.lock();
+    cache.iter().flatten().find_map(|entry| {
+        (entry.fs_index == handle.fs_index
+            && entry.inode == handle.inode
+            && entry.size == handle.size
+            && entry.mtime == handle.mtime)
+            .then_some(entry.bytes)
+    })
+}
+
+pub(crate) fn insert_file_image(handle: &ModularFileHandle, bytes: &'static [u8]) {
+    let mut cache = FILE_IMAGE_CACHE.lock();
+    // Replace a stale entry for the same inode, else take a free slot.
+    // When full, the buffer simply stays uncached.
+    let slot = cache
+        .iter()
+        .position(|e| {
+            matches!(e, Some(entry)
+                if entry.fs_index == handle.fs_index && entry.inode == handle.inode)
+        })
+        .or_else(|| cache.iter().position(|e| e.is_none()));
+    if let Some(idx) = slot {
+        cache[idx] = Some(CachedFileImage {
+            fs_index: handle.fs_index,
+            inode: handle.inode,
+            size: handle.size,
+            mtime: handle.mtime,
+            bytes,
+        });
+    }
+}
+
+/// Drop the cached image of an inode whose contents changed or went away.
+/// The old buffer stays valid for whoever still holds it.
+pub fn invalidate_file_image(fs_index: u8, inode: u32) {
+    let mut cache = FILE_IMAGE_CACHE.lock();
+    for slot in cache.iter_mut() {
+        if matches!(slot, Some(entry) if entry.fs_index == fs_index && entry.inode == inode) {
+            *slot = None;
+        }
+    }
+}
+
+/// Drop the cached image of whatever modular-filesystem inode `path` names
+fn invalidate_path_image(path: &str) {
+    match open(path).map(|opened| opened.content) {
+        Some(FileContent::Modular(handle)) => invalidate_file_image(handle.fs_index, handle.inode),
+        #[allow(deprecated)]
+        Some(FileContent::Ext2Modular(file_ref)) => invalidate_file_image(0, file_ref.inode),
+        _ => {}
+    }
+}
+
 #[derive(Clone, Copy)]
 pub struct File {
     pub name: &'static str,
@@ -64,6 +144,8 @@ static MOUNTS: Mutex<[Option<MountEntry>; MAX_MOUNTS]> = Mutex::new([None; MAX_M
 pub enum FileContent {
     /// Inline content from initramfs or static memory
     Inline(&'static [u8]),
+    /// Pseudo-file generated on read (procfs, sysfs)
+    Seq(super::seq_file::SeqSource),
     /// Content from a modular filesystem (ext2, ext3, ext4, etc.)
     /// The ModularFileHandle contains the fs_index to identify which filesystem
     Modular(ModularFileHandle),
@@ -347,92 +429,27 @@ pub fn add_file_with_metadata(
     );
 }
 
+/// Open a pseudo-file generated through seq_file
+fn seq_open_file(source: super::seq_file::SeqSource, metadata: Metadata) -> Option<OpenFile> {
+    Some(OpenFile {
+        content: FileContent::Seq(source),
+        metadata,
+    })
+}
+
 /// Handle procfs virtual file reads
 fn handle_procfs_read(path: &str) -> Option<OpenFile> {
     use super::procfs;
 
     let path = path.trim_start_matches('/');
 
-    // Global procfs files
+    // /proc/self is a symlink whose content is the current PID
+    if path == "proc/self" {
+        return seq_open_file(procfs::global_source("self")?, procfs::proc_link_metadata());
+    }
+
+    // /proc/sys/kernel/ entries (core dump configuration)
     match path {
-        "proc/version" => {
-            let (content, len) = procfs::generate_version();
-            return Some(OpenFile {
-                content: FileContent::Inline(content),
-                metadata: procfs::proc_file_metadata(len as u64),
-            });
-        }
-        "proc/uptime" => {
-            let (content, len) = procfs::generate_uptime();
-            return Some(OpenFile {
-                content: FileContent::Inline(content),
-                metadata: procfs::proc_file_metadata(len as u64),
-            });
-        }
-        "proc/loadavg" => {
-            let (content, len) = procfs::generate_loadavg();
-            return Some(OpenFile {
-                content: FileContent::Inline(content),
-                metadata: procfs::proc_file_metadata(len as u64),
-            });
-        }
-        "proc/meminfo" => {
-            let (content, len) = procfs::generate_meminfo();
-            return Some(OpenFile {
-                content: FileContent::Inline(content),
-                metadata: procfs::proc_file_metadata(len as u64),
-            });
-        }
-        "proc/cpuinfo" => {
-            let (content, len) = procfs::generate_cpuinfo();
-            return Some(OpenFile {
-                content: FileContent::Inline(content),
-                metadata: procfs::proc_file_metadata(len as u64),
-            });
-        }
-        "proc/stat" => {
-            let (content, len) = procfs::generate_stat();
-            return Some(OpenFile {
-                content: FileContent::Inline(content),
-                metadata: procfs::proc_file_metadata(len as u64),
-            });
-        }
-        "proc/filesystems" => {
-            let (content, len) = procfs::generate_filesystems();
-            return Some(OpenFile {
-                content: FileContent::Inline(content),
-                metadata: procfs::proc_file_metadata(len as u64),
-            });
-        }
-        "proc/mounts" => {
-            let (content, len) = procfs::generate_mounts();
-            return Some(OpenFile {
-                content: FileContent::Inline(content),
-                metadata: procfs::proc_file_metadata(len as u64),
-            });
-        }
-        "proc/cmdline" => {
-            let (content, len) = procfs::generate_cmdline();
-            return Some(OpenFile {
-                content: FileContent::Inline(content),
-                metadata: procfs::proc_file_metadata(len as u64),
-            });
-        }
-        "proc/driver/rtc" => {
-            let (content, len) = procfs::generate_rtc();
-            return Some(OpenFile {
-                content: FileContent::Inline(content),
-                metadata: procfs::proc_file_metadata(len as u64),
-            });
-        }
-        "proc/self" => {
-            let (content, _len) = procfs::generate_self();
-            return Some(OpenFile {
-                content: FileContent::Inline(content),
-                metadata: procfs::proc_link_metadata(),
-            });
-        }
-        // /proc/sys/kernel/ entries (core dump configuration)
         "proc/sys/kernel/core_pattern" => {
             let (content, len) = crate::process::coredump::generate_core_pattern_content();
             return Some(OpenFile {
@@ -457,294 +474,54 @@ fn handle_procfs_read(path: &str) -> Option<OpenFile> {
         _ => {}
     }
 
-    // Handle /proc/self/... by resolving to current PID
-    if path.starts_with("proc/self/") {
-        let file_path = &path[10..]; // Remove "proc/self/"
-        if let Some(current_pid) = crate::scheduler::get_current_pid() {
-            match file_path {
-                "cmdline" => {
-                    if let Some((content, len)) = procfs::generate_pid_cmdline(current_pid) {
-                        return Some(OpenFile {
-                            content: FileContent::Inline(content),
-                            metadata: procfs::proc_file_metadata(len as u64),
-                        });
-                    }
-                }
-                "status" => {
-                    if let Some((content, len)) = procfs::generate_pid_status(current_pid) {
-                        return Some(OpenFile {
-                            content: FileContent::Inline(content),
-                            metadata: procfs::proc_file_metadata(len as u64),
-                        });
-                    }
-                }
-                "stat" => {
-                    if let Some((content, len)) = procfs::generate_pid_stat(current_pid) {
-                        return Some(OpenFile {
-                            content: FileContent::Inline(content),
-                            metadata: procfs::proc_file_metadata(len as u64),
-                        });
-                    }
-                }
-                "maps" => {
-                    if let Some((content, len)) = procfs::generate_pid_maps(current_pid) {
-                        return Some(OpenFile {
-                            content: FileContent::Inline(content),
-                            metadata: procfs::proc_file_metadata(len as u64),
-                        });
-                    }
-                }
-                _ => {}
-            }
-        }
-    }
-
-    // Per-process files: /proc/[pid]/...
-    if path.starts_with("proc/") {
-        let rest = &path[5..]; // Remove "proc/"
-        if let Some(slash_pos) = rest.find('/') {
-            let pid_str = &rest[..slash_pos];
-            let file_path = &rest[slash_pos + 1..];
+    let rest = path.strip_prefix("proc/")?;
 
-            if let Ok(pid) = pid_str.parse::<u64>() {
-                if procfs::pid_exists(pid) {
-                    match file_path {
-                        "status" => {
-                            if let Some((content, len)) = procfs::generate_pid_status(pid) {
-                                return Some(OpenFile {
-                                    content: FileContent::Inline(content),
-                                    metadata: procfs::proc_file_metadata(len as u64),
-                                });
-                            }
-                        }
-                        "stat" => {
-                            if let Some((content, len)) = procfs::generate_pid_stat(pid) {
-                                return Some(OpenFile {
-                                    content: FileContent::Inline(content),
-                                    metadata: procfs::proc_file_metadata(len as u64),
-                                });
-                            }
-                        }
-                        "cmdline" => {
-                            if let Some((content, len)) = procfs::generate_pid_cmdline(pid) {
-                                return Some(OpenFile {
-                                    content: FileContent::Inline(content),
-                                    metadata: procfs::proc_file_metadata(len as u64),
-                                });
-                            }
-                        }
-                        "maps" => {
-                            if let Some((content, len)) = procfs::generate_pid_maps(pid) {
-                                return Some(OpenFile {
-                                    content: FileContent::Inline(content),
-                                    metadata: procfs::proc_file_metadata(len as u64),
-                                });
-                            }
-                        }
-                        _ => {}
-                    }
-                }
-            }
-        }
+    // Global procfs files (size is unknown until read, as on Linux)
+    if let Some(source) = procfs::global_source(rest) {
+        return seq_open_file(source, procfs::proc_file_metadata(0));
     }
 
-    None
+    // Per-process files: /proc/self/... and /proc/[pid]/...
+    let (pid_str, file_path) = rest.split_once('/')?;
+    let pid = if pid_str == "self" {
+        crate::scheduler::get_current_pid()?
+    } else {
+        let pid = pid_str.parse::<u64>().ok()?;
+        if !procfs::pid_exists(pid) {
+            return None;
+        }
+        pid
+    };
+    seq_open_file(
+        procfs::pid_source(pid, file_path)?,
+        procfs::proc_file_metadata(0),
+    )
 }
 
 /// Handle sysfs virtual file reads
 fn handle_sysfs_read(path: &str) -> Option<OpenFile> {
     use super::sysfs;
 
-    let path = path.trim_start_matches('/');
-
-    // Kernel info files
-    match path {
-        "sys/kernel/version" => {
-            let (content, len) = sysfs::generate_kernel_version();
-            return Some(OpenFile {
-                content: FileContent::Inline(content),
-                metadata: sysfs::sys_file_metadata(len as u64),
-            });
-        }
-        "sys/kernel/ostype" => {
-            let (content, len) = sysfs::generate_kernel_ostype();
-            return Some(OpenFile {
-                content: FileContent::Inline(content),
-                metadata: sysfs::sys_file_metadata(len as u64),
-            });
-        }
-        "sys/kernel/osrelease" => {
-            let (content, len) = sysfs::generate_kernel_osrelease();
-            return Some(OpenFile {
-                content: FileContent::Inline(content),
-                metadata: sysfs::sys_file_metadata(len as u64),
-            });
-        }
-        "sys/kernel/hostname" => {
-            let (content, len) = sysfs::generate_kernel_hostname();
-            return Some(OpenFile {
-                content: FileContent::Inline(content),
-                metadata: sysfs::sys_file_metadata(len as u64),
-            });
-        }
-        "sys/kernel/ngroups_max" => {
-            let (content, len) = sysfs::generate_kernel_ngroups_max();
-            return Some(OpenFile {
-                content: FileContent::Inline(content),
-                metadata: sysfs::sys_file_metadata(len as u64),
-            });
-        }
-        "sys/kernel/pid_max" => {
-            let (content, len) = sysfs::generate_kernel_pid_max();
-            return Some(OpenFile {
-                content: FileContent::Inline(content),
-                metadata: sysfs::sys_file_metadata(len as u64),
-            });
-        }
-        "sys/kernel/threads-max" => {
-            let (content, len) = sysfs::generate_kernel_threads_max();
-            return Some(OpenFile {
-                content: FileContent::Inline(content),
-                metadata: sysfs::sys_file_metadata(len as u64),
-            });
-        }
-        "sys/kernel/random/entropy_avail" => {
-            let (content, len) = sysfs::generate_random_entropy_avail();
-            return Some(OpenFile {
-                content: FileContent::Inline(content),
-                metadata: sysfs::sys_file_metadata(len as u64),
-            });
-        }
-        "sys/kernel/random/poolsize" => {
-            let (content, len) = sysfs::generate_random_poolsize();
-            return Some(OpenFile {
-                content: FileContent::Inline(content),
-                metadata: sysfs::sys_file_metadata(len as u64),
-            });
-        }
-        "sys/kernel/random/uuid" => {
-            let (content, len) = sysfs::generate_random_uuid();
-            return Some(OpenFile {
-                content: FileContent::Inline(content),
-                metadata: sysfs::sys_file_metadata(len as u64),
-            });
-        }
-        "sys/power/state" => {
-            let (content, len) = sysfs::generate_power_state();
-            return Some(OpenFile {
-                content: FileContent::Inline(content),
-                metadata: sysfs::sys_file_metadata(len as u64),
-            });
-        }
-        "sys/power/mem_sleep" => {
-            let (content, len) = sysfs::generate_power_mem_sleep();
-            return Some(OpenFile {
-                content: FileContent::Inline(content),
-                metadata: sysfs::sys_file_metadata(len as u64),
-            });
-        }
-        _ => {}
-    }
-
-    // Block device files: /sys/block/[device]/...
-    if path.starts_with("sys/block/") {
-        let rest = &path[10..]; // Remove "sys/block/"
-        if let Some(slash_pos) = rest.find('/') {
-            let device = &rest[..slash_pos];
-            let file_path = &rest[slash_pos + 1..];
-
-            match file_path {
-                "size" => {
-                    if let Some((content, len)) = sysfs::generate_block_size(device) {
-                        return Some(OpenFile {
-                            content: FileContent::Inline(content),
-                            metadata: sysfs::sys_file_metadata(len as u64),
-                        });
-                    }
-                }
-                "stat" => {
-                    if let Some((content, len)) = sysfs::generate_block_stat(device) {
-                        return Some(OpenFile {
-                            content: FileContent::Inline(content),
-                            metadata: sysfs::sys_file_metadata(len as u64),
-                        });
-                    }
-                }
-                "device/model" => {
-                    if let Some((content, len)) = sysfs::generate_block_model(device) {
-                        return Some(OpenFile {
-                            content: FileContent::Inline(content),
-                            metadata: sysfs::sys_file_metadata(len as u64),
-                        });
-                    }
-                }
-                "device/vendor" => {
-                    if let Some((content, len)) = sysfs::generate_block_vendor(device) {
-                        return Some(OpenFile {
-                            content: FileContent::Inline(content),
-                            metadata: sysfs::sys_file_metadata(len as u64),
-                        });
-                    }
-                }
-                _ => {}
-            }
-        }
-    }
-
-    // Network device files: /sys/class/net/[device]/...
-    if path.starts_with("sys/class/net/") {
-        let rest = &path[14..]; // Remove "sys/class/net/"
-        if let Some(slash_pos) = rest.find('/') {
-            let device = &rest[..slash_pos];
-            let file_path = &rest[slash_pos + 1..];
-
-            match file_path {
-                "address" => {
-                    if let Some((content, len)) = sysfs::generate_net_address(device) {
-                        return Some(OpenFile {
-                            content: FileContent::Inline(content),
-                            metadata: sysfs::sys_file_metadata(len as u64),
-                        });
-                    }
-                }
-                "mtu" => {
-                    if let Some((content, len)) = sysfs::generate_net_mtu(device) {
-                        return Some(OpenFile {
-                            content: FileContent::Inline(content),
-                            metadata: sysfs::sys_file_metadata(len as u64),
-                        });
-                    }
-                }
-                "operstate" => {
-                    if let Some((content, len)) = sysfs::generate_net_operstate(device) {
-                        return Some(OpenFile {
-                            content: FileContent::Inline(content),
-                            metadata: sysfs::sys_file_metadata(len as u64),
-                        });
-                    }
-                }
-                "type" => {
-                    if let Some((content, len)) = sysfs::generate_net_type(device) {
-                        return Some(OpenFile {
-                            content: FileContent::Inline(content),
-                            metadata: sysfs::sys_file_metadata(len as u64),
-                        });
-                    }
-                }
-                "flags" => {
-                    if let Some((content, len)) = sysfs::generate_net_flags(device) {
-                        return Some(OpenFile {
-                            content: FileContent::Inline(content),
-                            metadata: sysfs::sys_file_metadata(len as u64),
-                        });
-                    }
-                }
-                _ => {}
-            }
-        }
-    }
+    let rest = path.trim_start_matches('/').strip_prefix("sys/")?;
+
+    let source = if let Some(source) = sysfs::global_source(rest) {
+        source
+    } else if let Some(dev_path) = rest.strip_prefix("block/") {
+        // Block device files: /sys/block/[device]/...
+        let (device, attr) = dev_path.split_once('/')?;
+        sysfs::block_source(device, attr)?
+    } else if let Some(dev_path) = rest.strip_prefix("class/net/") {
+        // Network device files: /sys/class/net/[device]/...
+        let (device, attr) = dev_path.split_once('/')?;
+        sysfs::net_source(device, attr)?
+    } else if let Some(cgroup_path) = rest.strip_prefix("fs/cgroup/") {
+        // Control group files: /sys/fs/cgroup/[group]/...
+        sysfs::cgroup_source(cgroup_path)?
+    } else {
+        return None;
+    };
 
-    None
+    seq_open_file(source, sysfs::sys_file_metadata(0))
 }
 
 pub fn open(path: &str) -> Option<OpenFile> {
@@ -783,7 +560,9 @@ fn handle_procfs_stat(path: &str) -> Option<Metadata> {
     match path {
         "proc" => return Some(procfs::proc_dir_metadata()),
         "proc/self" => return Some(procfs::proc_link_metadata()),
-        "proc/sys" | "proc/sys/kernel" | "proc/driver" => return Some(procfs::proc_dir_metadata()),
+        "proc/sys" | "proc/sys/kernel" | "proc/driver" | "proc/pressure" => {
+            return Some(procfs::proc_dir_metadata())
+        }
         _ => {}
     }
 
@@ -814,8 +593,12 @@ fn handle_procfs_stat(path: &str) -> Option<Metadata> {
 
     // Global procfs files
     match path {
-        "proc/version" | "proc/uptime" | "proc/loadavg" | "proc/meminfo" | "proc/cpuinfo"
-        | "proc/stat" | "proc/filesystems" | "proc/mounts" | "proc/cmdline" | "proc/driver/rtc" => {
+        "proc/version" | "proc/uptime" | "proc/boottime" | "proc/loadavg" | "proc/meminfo"
+        | "proc/cpuinfo" | "proc/stat" | "proc/filesystems" | "proc/mounts" | "proc/cmdline"
+        | "proc/driver/rtc" | "proc/swaps" => {
+            return Some(procfs::proc_file_metadata(0)); // Size determined at read time
+        }
+        "proc/pressure/cpu" | "proc/pressure/memory" | "proc/pressure/io" => {
             return Some(procfs::proc_file_metadata(0)); // Size determined at read time
         }
         // /proc/sys/kernel/ entries (writable)
@@ -839,7 +622,7 @@ fn handle_procfs_stat(path: &str) -> Option<Metadata> {
             if let Ok(pid) = pid_str.parse::<u64>() {
                 if procfs::pid_exists(pid) {
                     match file_path {
-                        "status" | "stat" | "cmdline" | "maps" => {
+                        "status" | "stat" | "cmdline" | "maps" | "schedstat" | "cgroup" => {
                             return Some(procfs::proc_file_metadata(0));
                         }
                         "fd" => return Some(procfs::proc_dir_metadata()),
@@ -957,6 +740,21 @@ fn handle_sysfs_stat(path: &str) -> Option<Metadata> {
         }
     }
 
+    // Control group directories and files
+    if let Some(rest) = path
+        .strip_prefix("sys/fs/cgroup")
+        .filter(|rest| rest.is_empty() || rest.starts_with('/'))
+    {
+        let rest = rest.trim_matches('/');
+        if sysfs::cgroup_dir_exists(rest) {
+            return Some(sysfs::sys_dir_metadata());
+        }
+        let (group, file) = rest.rsplit_once('/').unwrap_or(("", rest));
+        if sysfs::CGROUP_FILES.contains(&file) && sysfs::cgroup_dir_exists(group) {
+            return Some(sysfs::sys_file_metadata(0));
+        }
+    }
+
     // TTY device directories
     if path.starts_with("sys/class/tty/") {
         let rest = &path[14..];
@@ -1010,6 +808,7 @@ where
             // Root /proc directory - list global files and process directories
             cb("version", procfs::proc_file_metadata(0));
             cb("uptime", procfs::proc_file_metadata(0));
+            cb("boottime", procfs::proc_file_metadata(0));
             cb("loadavg", procfs::proc_file_metadata(0));
             cb("meminfo", procfs::proc_file_metadata(0));
             cb("cpuinfo", procfs::proc_file_metadata(0));
@@ -1020,6 +819,7 @@ where
             cb("self", procfs::proc_link_metadata());
             cb("sys", procfs::proc_dir_metadata()); // /proc/sys directory
             cb("driver", procfs::proc_dir_metadata()); // /proc/driver directory
+            cb("pressure", procfs::proc_dir_metadata()); // /proc/pressure directory
 
             // List all process directories
             // PIDs are managed by radix tree and can be any value up to MAX_PID
@@ -1036,6 +836,12 @@ where
             cb("rtc", procfs::proc_file_metadata(0));
             return true;
         }
+        "proc/pressure" => {
+            for res in crate::scheduler::psi::PsiResource::ALL {
+                cb(res.name(), procfs::proc_file_metadata(0));
+            }
+            return true;
+        }
         "proc/self" => {
             if let Some(pid) = crate::scheduler::get_current_pid() {
                 if procfs::pid_exists(pid) {
@@ -1043,6 +849,8 @@ where
                     cb("stat", procfs::proc_file_metadata(0));
                     cb("cmdline", procfs::proc_file_metadata(0));
                     cb("maps", procfs::proc_file_metadata(0));
+                    cb("schedstat", procfs::proc_file_metadata(0));
+                    cb("cgroup", procfs::proc_file_metadata(0));
                     cb("fd", procfs::proc_dir_metadata());
                     return true;
                 }
@@ -1097,6 +905,8 @@ where
                 cb("stat", procfs::proc_file_metadata(0));
                 cb("cmdline", procfs::proc_file_metadata(0));
                 cb("maps", procfs::proc_file_metadata(0));
+                cb("schedstat", procfs::proc_file_metadata(0));
+                cb("cgroup", procfs::proc_file_metadata(0));
                 cb("fd", procfs::proc_dir_metadata());
                 return true;
             }
@@ -1199,9 +1009,25 @@ where
             cb("mem_sleep", sysfs::sys_file_metadata(0));
             return true;
         }
+        "sys/fs" => {
+            cb("cgroup", sysfs::sys_dir_metadata());
+            return true;
+        }
         _ => {}
     }
 
+    // Control group directories: attribute files plus child groups
+    if let Some(rest) = path.strip_prefix("sys/fs/cgroup") {
+        let group = rest.trim_start_matches('/');
+        if (rest.is_empty() || rest.starts_with('/')) && sysfs::cgroup_dir_exists(group) {
+            for file in sysfs::CGROUP_FILES {
+                cb(file, sysfs::sys_file_metadata(0));
+            }
+            sysfs::cgroup_children(group, |name| cb(name, sysfs::sys_dir_metadata()));
+            return true;
+        }
+    }
+
     // Block device subdirectories
     if path.starts_with("sys/block/") {
         let rest = &path[10..];
@@ -1289,6 +1115,9 @@ pub fn read_file_bytes(name: &str) -> Option<&'static [u8]> {
 
     match opened.content {
         FileContent::Inline(bytes) => Some(bytes),
+        // Generated pseudo-files have no backing bytes; read them through a
+        // file descriptor
+        FileContent::Seq(_) => None,
         // Handle new modular filesystem content (filesystem-agnostic)
         FileContent::Modular(file_handle) => read_modular_file_bytes(name, &file_handle),
         // Legacy ext2 handler - kept for backwards compatibility
@@ -1318,6 +1147,13 @@ fn read_modular_file_bytes(
     name: &str,
     file_handle: &super::traits::ModularFileHandle,
 ) -> Option<&'static [u8]> {
+    let cacheable = is_cacheable_image(file_handle);
+    if cacheable {
+        if let Some(bytes) = lookup_file_image(file_handle) {
+            return Some(bytes);
+        }
+    }
+
     // CRITICAL FIX: Switch to kernel CR3 before accessing kernel memory
     // The cache buffer is allocated in kernel address space (heap at ~0x7cc0000)
     // which may not be mapped in user process page tables.
@@ -1434,7 +1270,11 @@ fn read_modular_file_bytes(
     }
 
     // Create static slice from vmalloc memory (memory persists for kernel lifetime)
-    let result = unsafe { Some(core::slice::from_raw_parts(vmalloc_ptr as *const u8, size)) };
+    let bytes = unsafe { core::slice::from_raw_parts(vmalloc_ptr as *const u8, size) };
+    if cacheable {
+        insert_file_image(file_handle, bytes);
+    }
+    let result = Some(bytes);
 
     // Restore CR3 after all operations complete
     unsafe {
@@ -1497,13 +1337,19 @@ pub fn write_file(path: &str, data: &[u8]) -> Result<usize, &'static str> {
     }
 
     let (fs, relative) = resolve_mount(path).ok_or("path not found")?;
-    fs.write(relative, data)
+    let written = fs.write(relative, data);
+    // Also the O_TRUNC path, which rewrites the file with no data
+    invalidate_path_image(path);
+    written
 }
 
 /// Create a new file
 pub fn create_file(path: &str) -> Result<(), &'static str> {
     let (fs, relative) = resolve_mount(path).ok_or("path not found")?;
-    fs.create(relative)
+    fs.create(relative)?;
+    // The new file may have been given the inode of a deleted one
+    invalidate_path_image(path);
+    Ok(())
 }
 
 /// Enable write support for ext2 filesystem (if available)
@@ -29,8 +29,9 @@ pub static PICS: spin::Mutex<ChainedPics> =
 /// - Called swapgs if from Ring 3
 ///
 /// The assembly wrapper will restore GPRs and call iretq after this returns.
+/// `interrupted_cs` is the CS of the interrupted context.
 #[no_mangle]
-pub extern "C" fn timer_interrupt_handler_inner() {
+pub extern "C" fn timer_interrupt_handler_inner(interrupted_cs: u64) {
     // Mark entering interrupt context (disables preemption)
     crate::smp::enter_interrupt();
 
@@ -53,6 +54,9 @@ pub extern "C" fn timer_interrupt_handler_inner() {
     // Poll network stack to receive packets and wake up waiting processes.
     crate::net::poll();
 
+    // Run deferred work (only when no kernel locks can be held)
+    crate::smp::workqueue::tick(interrupted_cs & 3 == 3);
+
     // Check if current process should be preempted
     let should_resched = crate::scheduler::tick(TIMER_TICK_MS);
 
@@ -245,7 +249,7 @@ pub const LAPIC_TIMER_VECTOR: u8 = 0xEC;
 ///
 /// This provides the timer tick for scheduling on non-BSP cores.
 /// Uses per-CPU state tracking for interrupt context and statistics.
-pub extern "x86-interrupt" fn lapic_timer_handler(_stack_frame: InterruptStackFrame) {
+pub extern "x86-interrupt" fn lapic_timer_handler(stack_frame: InterruptStackFrame) {
     // Mark entering interrupt context (disables preemption)
     crate::smp::enter_interrupt();
 
@@ -273,6 +277,9 @@ pub extern "x86-interrupt" fn lapic_timer_handler(_stack_frame: InterruptStackFr
     // network packets to be processed and wake_process() to be called.
     crate::net::poll();
 
+    // Run deferred work (only when no kernel locks can be held)
+    crate::smp::workqueue::tick(stack_frame.code_segment & 3 == 3);
+
     // Check if current process should be preempted
     let should_resched = crate::scheduler::tick(TIMER_TICK_MS);
 
@@ -84,9 +84,10 @@ pub extern "x86-interrupt" fn ipi_tlb_flush_handler(_stack_frame: InterruptStack
 /// IPI handler for function call requests
 /// Allows one CPU to execute a function on another CPU
 ///
-/// This is the core mechanism for parallel display operations.
-/// When compositor needs multi-core rendering, it sends this IPI
-/// to all AP cores which then call into compositor::ap_work_entry().
+/// Runs everything queued for this CPU by `smp_call_function_single()` /
+/// `smp_call_function_many()` (compositor workers, parallel module
+/// verification, synchronous TLB shootdowns, ...). Also used to wake idle
+/// CPUs for queued work.
 pub extern "x86-interrupt" fn ipi_call_function_handler(_stack_frame: InterruptStackFrame) {
     // Enter interrupt context
     crate::smp::enter_interrupt();
@@ -101,10 +102,7 @@ pub extern "x86-interrupt" fn ipi_call_function_handler(_stack_frame: InterruptS
             .fetch_add(1, core::sync::atomic::Ordering::Relaxed);
     }
 
-    // Execute compositor work if available
-    // This is the primary use case for IPI_CALL_FUNCTION
-    #[cfg(feature = "gfx_compositor")]
-    crate::drivers::compositor::ap_work_entry();
+    crate::smp::flush_call_queue();
 
     // Send EOI to LAPIC
     crate::lapic::send_eoi();
@@ -90,7 +90,8 @@ global_asm!(
         mov gs:[80], rax     // GS_SLOT_SAVED_RAX (10)
     1:
 
-        // Call Rust handler (System V ABI).
+        // Call Rust handler (System V ABI) with the interrupted CS.
+        mov rdi, [rsp + 120 + 8]
         call timer_interrupt_handler_inner
 
         // If we came from Ring 3, swapgs back before iretq.
@@ -122,5 +123,5 @@ global_asm!(
 );
 
 extern "C" {
-    fn timer_interrupt_handler_inner();
+    fn timer_interrupt_handler_inner(interrupted_cs: u64);
 }
@@ -7,6 +7,8 @@
 //! - X.509 certificate parsing and chain validation
 //!
 //! All implementations are `no_std` compatible and designed for kernel use.
+//! The SHA-2 hashes come from `nsha`, which ncryptolib uses as well and
+//! which switches to the SHA extensions when the CPU has them.
 //!
 //! # Supported Algorithms
 //!
@@ -31,505 +33,11 @@
 use alloc::vec::Vec;
 
 // ============================================================================
-// SHA-256 Implementation
+// SHA-2 (the nsha crate, shared with ncryptolib)
 // ============================================================================
 
-/// SHA-256 initial hash values (first 32 bits of fractional parts of
-/// the square roots of the first 8 primes 2..19)
-const SHA256_H: [u32; 8] = [
-    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
-];
-
-/// SHA-256 round constants (first 32 bits of fractional parts of
-/// the cube roots of the first 64 primes 2..311)
-const SHA256_K: [u32; 64] = [
-    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
-    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
-    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
-    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
-    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
-    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
-    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
-    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
-];
-
-/// SHA-256 digest size in bytes
-pub const SHA256_DIGEST_SIZE: usize = 32;
-
-/// SHA-256 block size in bytes
-const SHA256_BLOCK_SIZE: usize = 64;
-
-/// SHA-256 hasher state
-pub struct Sha256 {
-    /// Current hash state
-    state: [u32; 8],
-    /// Pending data buffer
-    buffer: [u8; SHA256_BLOCK_SIZE],
-    /// Number of bytes in buffer
-    buffer_len: usize,
-    /// Total message length in bits
-    total_bits: u64,
-}
-
-impl Sha256 {
-    /// Create a new SHA-256 hasher
-    pub const fn new() -> Self {
-        Self {
-            state: SHA256_H,
-            buffer: [0u8; SHA256_BLOCK_SIZE],
-            buffer_len: 0,
-            total_bits: 0,
-        }
-    }
-
-    /// Reset hasher to initial state
-    pub fn reset(&mut self) {
-        self.state = SHA256_H;
-        self.buffer = [0u8; SHA256_BLOCK_SIZE];
-        self.buffer_len = 0;
-        self.total_bits = 0;
-    }
-
-    /// Update hash with input data
-    pub fn update(&mut self, data: &[u8]) {
-        let mut offset = 0;
-
-        // If we have pending data, fill the buffer first
-        if self.buffer_len > 0 {
-            let to_copy = core::cmp::min(SHA256_BLOCK_SIZE - self.buffer_len, data.len());
-            self.buffer[self.buffer_len..self.buffer_len + to_copy]
-                .copy_from_slice(&data[..to_copy]);
-            self.buffer_len += to_copy;
-            offset = to_copy;
-
-            // Process full buffer
-            if self.buffer_len == SHA256_BLOCK_SIZE {
-                let block = self.buffer;
-                self.process_block(&block);
-                self.buffer_len = 0;
-            }
-        }
-
-        // Process full blocks directly
-        while offset + SHA256_BLOCK_SIZE <= data.len() {
-            let block: [u8; SHA256_BLOCK_SIZE] =
-                data[offset..offset + SHA256_BLOCK_SIZE].try_into().unwrap();
-            self.process_block(&block);
-            offset += SHA256_BLOCK_SIZE;
-        }
-
-        // Buffer remaining data
-        if offset < data.len() {
-            let remaining = data.len() - offset;
-            self.buffer[..remaining].copy_from_slice(&data[offset..]);
-            self.buffer_len = remaining;
-        }
-
-        self.total_bits += (data.len() as u64) * 8;
-    }
-
-    /// Finalize and return the hash digest
-    pub fn finalize(&mut self) -> [u8; SHA256_DIGEST_SIZE] {
-        // Padding
-        let mut padding = [0u8; SHA256_BLOCK_SIZE * 2];
-        padding[0] = 0x80;
-
-        let padding_len = if self.buffer_len < 56 {
-            56 - self.buffer_len
-        } else {
-            120 - self.buffer_len
-        };
-
-        // Append length in bits (big-endian)
-        let len_bytes = self.total_bits.to_be_bytes();
-        padding[padding_len..padding_len + 8].copy_from_slice(&len_bytes);
-
-        self.update(&padding[..padding_len + 8]);
-
-        // Output hash
-        let mut result = [0u8; SHA256_DIGEST_SIZE];
-        for (i, &val) in self.state.iter().enumerate() {
-            result[i * 4..(i + 1) * 4].copy_from_slice(&val.to_be_bytes());
-        }
-        result
-    }
-
-    /// Process a single 64-byte block
-    fn process_block(&mut self, block: &[u8; SHA256_BLOCK_SIZE]) {
-        // Prepare message schedule
-        let mut w = [0u32; 64];
-
-        // First 16 words from block
-        for i in 0..16 {
-            w[i] = u32::from_be_bytes([
-                block[i * 4],
-                block[i * 4 + 1],
-                block[i * 4 + 2],
-                block[i * 4 + 3],
-            ]);
-        }
-
-        // Extend to 64 words
-        for i in 16..64 {
-            let s0 = w[i - 15].rotate_right(7) ^ w[i - 15].rotate_right(18) ^ (w[i - 15] >> 3);
-            let s1 = w[i - 2].rotate_right(17) ^ w[i - 2].rotate_right(19) ^ (w[i - 2] >> 10);
-            w[i] = w[i - 16]
-                .wrapping_add(s0)
-                .wrapping_add(w[i - 7])
-                .wrapping_add(s1);
-        }
-
-        // Working variables
-        let mut a = self.state[0];
-        let mut b = self.state[1];
-        let mut c = self.state[2];
-        let mut d = self.state[3];
-        let mut e = self.state[4];
-        let mut f = self.state[5];
-        let mut g = self.state[6];
-        let mut h = self.state[7];
-
-        // 64 rounds
-        for i in 0..64 {
-            let s1 = e.rotate_right(6) ^ e.rotate_right(11) ^ e.rotate_right(25);
-            let ch = (e & f) ^ ((!e) & g);
-            let temp1 = h
-                .wrapping_add(s1)
-                .wrapping_add(ch)
-                .wrapping_add(SHA256_K[i])
-                .wrapping_add(w[i]);
-            let s0 = a.rotate_right(2) ^ a.rotate_right(13) ^ a.rotate_right(22);
-            let maj = (a & b) ^ (a & c) ^ (b & c);
-            let temp2 = s0.wrapping_add(maj);
-
-            h = g;
-            g = f;
-            f = e;
-            e = d.wrapping_add(temp1);
-            d = c;
-            c = b;
-            b = a;
-            a = temp1.wrapping_add(temp2);
-        }
-
-        // Update state
-        self.state[0] = self.state[0].wrapping_add(a);
-        self.state[1] = self.state[1].wrapping_add(b);
-        self.state[2] = self.state[2].wrapping_add(c);
-        self.state[3] = self.state[3].wrapping_add(d);
-        self.state[4] = self.state[4].wrapping_add(e);
-        self.state[5] = self.state[5].wrapping_add(f);
-        self.state[6] = self.state[6].wrapping_add(g);
-        self.state[7] = self.state[7].wrapping_add(h);
-    }
-}
-
-/// Compute SHA-256 hash of data (convenience function)
-pub fn sha256(data: &[u8]) -> [u8; SHA256_DIGEST_SIZE] {
-    let mut hasher = Sha256::new();
-    hasher.update(data);
-    hasher.finalize()
-}
-
-// ============================================================================
-// SHA-384 / SHA-512 Implementation (SHA-2 family with 64-bit words)
-// ============================================================================
-
-/// SHA-512 initial hash values
-const SHA512_H: [u64; 8] = [
-    0x6a09e667f3bcc908,
-    0xbb67ae8584caa73b,
-    0x3c6ef372fe94f82b,
-    0xa54ff53a5f1d36f1,
-    0x510e527fade682d1,
-    0x9b05688c2b3e6c1f,
-    0x1f83d9abfb41bd6b,
-    0x5be0cd19137e2179,
-];
-
-/// SHA-384 initial hash values
-const SHA384_H: [u64; 8] = [
-    0xcbbb9d5dc1059ed8,
-    0x629a292a367cd507,
-    0x9159015a3070dd17,
-    0x152fecd8f70e5939,
-    0x67332667ffc00b31,
-    0x8eb44a8768581511,
-    0xdb0c2e0d64f98fa7,
-    0x47b5481dbefa4fa4,
-];
-
-/// SHA-512 round constants
-const SHA512_K: [u64; 80] = [
-    0x428a2f98d728ae22,
-    0x7137449123ef65cd,
-    0xb5c0fbcfec4d3b2f,
-    0xe9b5dba58189dbbc,
-    0x3956c25bf348b538,
-    0x59f111f1b605d019,
-    0x923f82a4af194f9b,
-    0xab1c5ed5da6d8118,
-    0xd807aa98a3030242,
-    0x12835b0145706fbe,
-    0x243185be4ee4b28c,
-    0x550c7dc3d5ffb4e2,
-    0x72be5d74f27b896f,
-    0x80deb1fe3b1696b1,
-    0x9bdc06a725c71235,
-    0xc19bf174cf692694,
-    0xe49b69c19ef14ad2,
-    0xefbe4786384f25e3,
-    0x0fc19dc68b8cd5b5,
-    0x240ca1cc77ac9c65,
-    0x2de92c6f592b0275,
-    0x4a7484aa6ea6e483,
-    0x5cb0a9dcbd41fbd4,
-    0x76f988da831153b5,
-    0x983e5152ee66dfab,
-    0xa831c66d2db43210,
-    0xb00327c898fb213f,
-    0xbf597fc7beef0ee4,
-    0xc6e00bf33da88fc2,
-    0xd5a79147930aa725,
-    0x06ca6351e003826f,
-    0x142929670a0e6e70,
-    0x27b70a8546d22ffc,
-    0x2e1b21385c26c926,
-    0x4d2c6dfc5ac42aed,
-    0x53380d139d95b3df,
-    0x650a73548baf63de,
-    0x766a0abb3c77b2a8,
-    0x81c2c92e47edaee6,
-    0x92722c851482353b,
-    0xa2bfe8a14cf10364,
-    0xa81a664bbc423001,
-    0xc24b8b70d0f89791,
-    0xc76c51a30654be30,
-    0xd192e819d6ef5218,
-    0xd69906245565a910,
-    0xf40e35855771202a,
-    0x106aa07032bbd1b8,
-    0x19a4c116b8d2d0c8,
-    0x1e376c085141ab53,
-    0x2748774cdf8eeb99,
-    0x34b0bcb5e19b48a8,
-    0x391c0cb3c5c95a63,
-    0x4ed8aa4ae3418acb,
-    0x5b9cca4f7763e373,
-    0x682e6ff3d6b2b8a3,
-    0x748f82ee5defb2fc,
-    0x78a5636f43172f60,
-    0x84c87814a1f0ab72,
-    0x8cc702081a6439ec,
-    0x90befffa23631e28,
-    0xa4506cebde82bde9,
-    0xbef9a3f7b2c67915,
-    0xc67178f2e372532b,
-    0xca273eceea26619c,
-    0xd186b8c721c0c207,
-    0xeada7dd6cde0eb1e,
-    0xf57d4f7fee6ed178,
-    0x06f067aa72176fba,
-    0x0a637dc5a2c898a6,
-    0x113f9804bef90dae,
-    0x1b710b35131c471b,
-    0x28db77f523047d84,
-    0x32caab7b40c72493,
-    0x3c9ebe0a15c9bebc,
-    0x431d67c49c100d4c,
-    0x4cc5d4becb3e42b6,
-    0x597f299cfc657e2a,
-    0x5fcb6fab3ad6faec,
-    0x6c44198c4a475817,
-];
-
-/// SHA-512 digest size
-pub const SHA512_DIGEST_SIZE: usize = 64;
-
-/// SHA-384 digest size
-pub const SHA384_DIGEST_SIZE: usize = 48;
-
-/// SHA-512 block size
-const SHA512_BLOCK_SIZE: usize = 128;
-
-/// SHA-512/384 hasher state
-pub struct Sha512 {
-    state: [u64; 8],
-    buffer: [u8; SHA512_BLOCK_SIZE],
-    buffer_len: usize,
-    total_bits: u128,
-    is_384: bool,
-}
-
-impl Sha512 {
-    /// Create a new SHA-512 hasher
-    pub const fn new() -> Self {
-        Self {
-            state: SHA512_H,
-            buffer: [0u8; SHA512_BLOCK_SIZE],
-            buffer_len: 0,
-            total_bits: 0,
-            is_384: false,
-        }
-    }
-
-    /// Create a new SHA-384 hasher
-    pub const fn new_384() -> Self {
-        Self {
-            state: SHA384_H,
-            buffer: [0u8; SHA512_BLOCK_SIZE],
-            buffer_len: 0,
-            total_bits: 0,
-            is_384: true,
-        }
-    }
-
-    /// Update hash with input data
-    pub fn update(&mut self, data: &[u8]) {
-        let mut offset = 0;
-
-        if self.buffer_len > 0 {
-            let to_copy = core::cmp::min(SHA512_BLOCK_SIZE - self.buffer_len, data.len());
-            self.buffer[self.buffer_len..self.buffer_len + to_copy]
-                .copy_from_slice(&data[..to_copy]);
-            self.buffer_len += to_copy;
-            offset = to_copy;
-
-            if self.buffer_len == SHA512_BLOCK_SIZE {
-                let block = self.buffer;
-                self.process_block(&block);
-                self.buffer_len = 0;
-            }
-        }
-
-        while offset + SHA512_BLOCK_SIZE <= data.len() {
-            let block: [u8; SHA512_BLOCK_SIZE] =
-                data[offset..offset + SHA512_BLOCK_SIZE].try_into().unwrap();
-            self.process_block(&block);
-            offset += SHA512_BLOCK_SIZE;
-        }
-
-        if offset < data.len() {
-            let remaining = data.len() - offset;
-            self.buffer[..remaining].copy_from_slice(&data[offset..]);
-            self.buffer_len = remaining;
-        }
-
-        self.total_bits += (data.len() as u128) * 8;
-    }
-
-    /// Finalize and return the hash digest
-    pub fn finalize(&mut self) -> Vec<u8> {
-        let mut padding = [0u8; SHA512_BLOCK_SIZE * 2];
-        padding[0] = 0x80;
-
-        let padding_len = if self.buffer_len < 112 {
-            112 - self.buffer_len
-        } else {
-            240 - self.buffer_len
-        };
-
-        // Append length in bits (big-endian, 128-bit)
-        let len_bytes = self.total_bits.to_be_bytes();
-        padding[padding_len..padding_len + 16].copy_from_slice(&len_bytes);
-
-        self.update(&padding[..padding_len + 16]);
-
-        let digest_size = if self.is_384 {
-            SHA384_DIGEST_SIZE
-        } else {
-            SHA512_DIGEST_SIZE
-        };
-        let mut result = Vec::with_capacity(digest_size);
-        let num_words = digest_size / 8;
-
-        for i in 0..num_words {
-            result.extend_from_slice(&self.state[i].to_be_bytes());
-        }
-
-        result
-    }
-
-    fn process_block(&mut self, block: &[u8; SHA512_BLOCK_SIZE]) {
-        let mut w = [0u64; 80];
-
-        for i in 0..16 {
-            w[i] = u64::from_be_bytes([
-                block[i * 8],
-                block[i * 8 + 1],
-                block[i * 8 + 2],
-                block[i * 8 + 3],
-                block[i * 8 + 4],
-                block[i * 8 + 5],
-                block[i * 8 + 6],
-                block[i * 8 + 7],
-            ]);
-        }
-
-        for i in 16..80 {
-            let s0 = w[i - 15].rotate_right(1) ^ w[i - 15].rotate_right(8) ^ (w[i - 15] >> 7);
-            let s1 = w[i - 2].rotate_right(19) ^ w[i - 2].rotate_right(61) ^ (w[i - 2] >> 6);
-            w[i] = w[i - 16]
-                .wrapping_add(s0)
-                .wrapping_add(w[i - 7])
-                .wrapping_add(s1);
-        }
-
-        let mut a = self.state[0];
-        let mut b = self.state[1];
-        let mut c = self.state[2];
-        let mut d = self.state[3];
-        let mut e = self.state[4];
-        let mut f = self.state[5];
-        let mut g = self.state[6];
-        let mut h = self.state[7];
-
-        for i in 0..80 {
-            let s1 = e.rotate_right(14) ^ e.rotate_right(18) ^ e.rotate_right(41);
-            let ch = (e & f) ^ ((!e) & g);
-            let temp1 = h
-                .wrapping_add(s1)
-                .wrapping_add(ch)
-                .wrapping_add(SHA512_K[i])
-                .wrapping_add(w[i]);
-            let s0 = a.rotate_right(28) ^ a.rotate_right(34) ^ a.rotate_right(39);
-            let maj = (a & b) ^ (a & c) ^ (b & c);
-            let temp2 = s0.wrapping_add(maj);
-
-            h = g;
-            g = f;
-            f = e;
-            e = d.wrapping_add(temp1);
-            d = c;
-            c = b;
-            b = a;
-            a = temp1.wrapping_add(temp2);
-        }
-
-        self.state[0] = self.state[0].wrapping_add(a);
-        self.state[1] = self.state[1].wrapping_add(b);
-        self.state[2] = self.state[2].wrapping_add(c);
-        self.state[3] = self.state[3].wrapping_add(d);
-        self.state[4] = self.state[4].wrapping_add(e);
-        self.state[5] = self.state[5].wrapping_add(f);
-        self.state[6] = self.state[6].wrapping_add(g);
-        self.state[7] = self.state[7].wrapping_add(h);
-    }
-}
-
-/// Compute SHA-384 hash
-pub fn sha384(data: &[u8]) -> Vec<u8> {
-    let mut hasher = Sha512::new_384();
-    hasher.update(data);
-    hasher.finalize()
-}
-
-/// Compute SHA-512 hash
-pub fn sha512(data: &[u8]) -> Vec<u8> {
-    let mut hasher = Sha512::new();
-    hasher.update(data);
-    hasher.finalize()
-}
+pub use nsha::{sha256, sha384, sha512, Sha256, Sha512};
+pub use nsha::{SHA256_DIGEST_SIZE, SHA384_DIGEST_SIZE, SHA512_DIGEST_SIZE};
 
 /// Compute hash using specified algorithm
 pub fn hash_with_algorithm(data: &[u8], algo: HashAlgorithm) -> Vec<u8> {
@@ -732,12 +240,46 @@ impl BigInt {
         self.normalize();
     }
 
+    /// Number of significant bits
+    pub fn bit_len(&self) -> usize {
+        if self.len == 0 {
+            0
+        } else {
+            self.len * 64 - self.limbs[self.len - 1].leading_zeros() as usize
+        }
+    }
+
+    /// Test bit `i`
+    fn bit(&self, i: usize) -> bool {
+        let limb = i / 64;
+        limb < self.len && (self.limbs[limb] >> (i % 64)) & 1 != 0
+    }
+
     /// Modular exponentiation: base^exp mod modulus
-    /// Uses binary exponentiation (square-and-multiply)
+    ///
+    /// Odd moduli (every RSA modulus) use Montgomery multiplication with a
+    /// fixed-window exponent scan; even moduli fall back to
+    /// `mod_exp_binary()`.
     pub fn mod_exp(base: &Self, exp: &Self, modulus: &Self) -> Self {
         if modulus.is_zero() {
             return Self::zero();
         }
+        if modulus.len == 1 && modulus.limbs[0] == 1 {
+            return Self::zero();
+        }
+        if modulus.limbs[0] & 1 == 1 {
+            return Montgomery::new(modulus).mod_exp(base, exp);
+        }
+        Self::mod_exp_binary(base, exp, modulus)
+    }
+
+    /// Modular exponentiation by schoolbook square-and-multiply
+    ///
+    /// Reference implementation, used for even moduli.
+    pub fn mod_exp_binary(base: &Self, exp: &Self, modulus: &Self) -> Self {
+        if modulus.is_zero() {
+            return Self::zero();
+        }
 
         let mut result = Self::zero();
         result.limbs[0] = 1;
@@ -1028,6 +570,234 @@ impl BigInt {
     }
 }
 
+// ============================================================================
+// Montgomery Arithmetic
+// ============================================================================
+
+/// `a * b + c + carry` as (low, high) 64-bit halves
+#[inline(always)]
+fn mac(a: u64, b: u64, c: u64, carry: u64) -> (u64, u64) {
+    let t = (a as u128) * (b as u128) + (c as u128) + (carry as u128);
+    (t as u64, (t >> 64) as u64)
+}
+
+/// `a + b + carry` as (sum, carry)
+#[inline(always)]
+fn adc(a: u64, b: u64, carry: u64) -> (u64, u64) {
+    let t = (a as u128) + (b as u128) + (carry as u128);
+    (t as u64, (t >> 64) as u64)
+}
+
+/// Montgomery context for an odd modulus `n` with `R = 2^(64 * len)`
+///
+/// Values in Montgomery form are `x * R mod n`, held in `len` limbs.
+/// Multiplication uses CIOS (coarsely integrated operand scanning), which
+/// interleaves each 64x64->128 multiply row with one reduction step, so
+/// the work is `2 * len^2` limb products with no division.
+pub struct Montgomery {
+    n: [u64; MAX_RSA_LIMBS],
+    len: usize,
+    /// `-n^-1 mod 2^64`
+    n0_inv: u64,
+    /// `R^2 mod n`, converts into Montgomery form
+    r2: [u64; MAX_RSA_LIMBS],
+}
+
+impl Montgomery {
+    /// Create a context for `modulus`, which must be odd and non-zero
+    pub fn new(modulus: &BigInt) -> Self {
+        let len = modulus.len;
+        let mut n = [0u64; MAX_RSA_LIMBS];
+        n[..len].copy_from_slice(&modulus.limbs[..len]);
+
+        // Newton iteration: each step doubles the number of correct bits
+        let n0 = n[0];
+        let mut inv: u64 = 1;
+        for _ in 0..6 {
+            inv = inv.wrapping_mul(2u64.wrapping_sub(n0.wrapping_mul(inv)));
+        }
+
+        let mut ctx = Self {
+            n,
+            len,
+            n0_inv: inv.wrapping_neg(),
+            r2: [0u64; MAX_RSA_LIMBS],
+        };
+        ctx.r2 = ctx.compute_r2(modulus.bit_len());
+        ctx
+    }
+
+    /// Compute `R^2 mod n`
+    ///
+    /// `R mod n` comes from doubling `2^(bits-1)` (at most 64 steps). Write
+    /// `64 * len = t * 2^j` with `t` odd: `t` more doublings give the
+    /// Montgomery form of `2^t`, and `j` Montgomery squarings raise it to
+    /// `2^(64 * len)`, whose Montgomery form is `R^2 mod n`.
+    fn compute_r2(&self, bits: usize) -> [u64; MAX_RSA_LIMBS] {
+        let mut x = [0u64; MAX_RSA_LIMBS];
+        x[(bits - 1) / 64] = 1u64 << ((bits - 1) % 64);
+
+        let r_bits = 64 * self.len;
+        for _ in 0..(r_bits - bits + 1) {
+            self.double_mod(&mut x);
+        }
+
+        let j = r_bits.trailing_zeros() as usize;
+        let t = r_bits >> j;
+        for _ in 0..t {
+            self.double_mod(&mut x);
+        }
+        for _ in 0..j {
+            x = self.mul(&x, &x);
+        }
+        x
+    }
+
+    /// `x = 2x mod n` for `x < n`
+    fn double_mod(&self, x: &mut [u64; MAX_RSA_LIMBS]) {
+        let mut carry = 0u64;
+        for limb in x[..self.len].iter_mut() {
+            let top = *limb >> 63;
+            *limb = (*limb << 1) | carry;
+            carry = top;
+        }
+        if carry != 0 || !Self::less_than(&x[..self.len], &self.n[..self.len]) {
+            Self::sub_in_place(&mut x[..self.len], &self.n[..self.len]);
+        }
+    }
+
+    fn less_than(a: &[u64], b: &[u64]) -> bool {
+        for i in (0..a.len()).rev() {
+            if a[i] != b[i] {
+                return a[i] < b[i];
+            }
+        }
+        false
+    }
+
+    fn sub_in_place(a: &mut [u64], b: &[u64]) {
+        let mut borrow = 0u64;
+        for i in 0..a.len() {
+            let (d1, b1) = a[i].overflowing_sub(b[i]);
+            let (d2, b2) = d1.overflowing_sub(borrow);
+            a[i] = d2;
+            borrow = (b1 | b2) as u64;
+        }
+    }
+
+    /// Montgomery product `a * b * R^-1 mod n` for `a, b < n`
+    pub fn mul(&self, a: &[u64; MAX_RSA_LIMBS], b: &[u64; MAX_RSA_LIMBS]) -> [u64; MAX_RSA_LIMBS] {
+        let s = self.len;
+        let n = &self.n;
+        let mut t = [0u64; MAX_RSA_LIMBS + 2];
+
+        for i in 0..s {
+            // t += a[i] * b
+            let ai = a[i];
+            let mut carry = 0u64;
+            for j in 0..s {
+                let (lo, hi) = mac(ai, b[j], t[j], carry);
+                t[j] = lo;
+                carry = hi;
+            }
+            let (sum, c) = adc(t[s], carry, 0);
+            t[s] = sum;
+            t[s + 1] = c;
+
+            // t = (t + m * n) / 2^64, with m chosen so the low limb vanishes
+            let m = t[0].wrapping_mul(self.n0_inv);
+            let (_, mut carry) = mac(m, n[0], t[0], 0);
+            for j in 1..s {
+                let (lo, hi) = mac(m, n[j], t[j], carry);
+                t[j - 1] = lo;
+                carry = hi;
+            }
+            let (sum, c) = adc(t[s], carry, 0);
+            t[s - 1] = sum;
+            t[s] = t[s + 1] + c;
+        }
+
+        // t < 2n: one conditional subtraction brings it below n
+        let mut out = [0u64; MAX_RSA_LIMBS];
+        out[..s].copy_from_slice(&t[..s]);
+        if t[s] != 0 || !Self::less_than(&out[..s], &n[..s]) {
+            Self::sub_in_place(&mut out[..s], &n[..s]);
+        }
+        out
+    }
+
+    /// Compute `base^exp mod n`
+    pub fn mod_exp(&self, base: &BigInt, exp: &BigInt) -> BigInt {
+        let modulus = self.to_bigint(&self.n);
+
+        // Bring the base below n (signatures already are)
+        let reduced;
+        let base = if base.ge(&modulus) {
+            let mut one = BigInt::zero();
+            one.limbs[0] = 1;
+            one.len = 1;
+            reduced = BigInt::mod_mul(base, &one, &modulus);
+            &reduced
+        } else {
+            base
+        };
+
+        let mut one = [0u64; MAX_RSA_LIMBS];
+        one[0] = 1;
+        // Montgomery form of 1 is R mod n
+        let one_m = self.mul(&self.r2, &one);
+
+        let exp_bits = exp.bit_len();
+        if exp_bits == 0 {
+            return self.to_bigint(&self.mul(&one_m, &one));
+        }
+
+        let mut base_limbs = [0u64; MAX_RSA_LIMBS];
+        base_limbs[..base.len].copy_from_slice(&base.limbs[..base.len]);
+        let base_m = self.mul(&base_limbs, &self.r2);
+
+        // Public exponents (65537) are short and sparse: a window only adds
+        // table setup there. Long exponents use 4-bit windows.
+        let window = if exp_bits <= 32 { 1 } else { 4 };
+        let mut table: Vec<[u64; MAX_RSA_LIMBS]> = Vec::with_capacity(1 << window);
+        table.push(one_m);
+        table.push(base_m);
+        for i in 2..(1usize << window) {
+            let next = self.mul(&table[i - 1], &base_m);
+            table.push(next);
+        }
+
+        // Scan the exponent from the top in fixed windows aligned to bit 0
+        let windows = (exp_bits + window - 1) / window;
+        let mut acc = one_m;
+        for w in (0..windows).rev() {
+            if w != windows - 1 {
+                for _ in 0..window {
+                    acc = self.mul(&acc, &acc);
+                }
+            }
+            let mut digit = 0usize;
+            for b in (0..window).rev() {
+                digit = (digit << 1) | exp.bit(w * window + b) as usize;
+            }
+            if digit != 0 {
+                acc = self.mul(&acc, &table[digit]);
+            }
+        }
+
+        // Leave Montgomery form
+        self.to_bigint(&self.mul(&acc, &one))
+    }
+
+    fn to_bigint(&self, limbs: &[u64; MAX_RSA_LIMBS]) -> BigInt {
+        let mut out = BigInt::zero();
+        out.limbs[..self.len].copy_from_slice(&limbs[..self.len]);
+        out.len = self.len;
+        out.normalize();
+        out
+    }
+}
+
 // ============================================================================
 // RSA Public Key
 // ============================================================================
@@ -1349,6 +1119,10 @@ pub fn clear_trusted_keys() {
     for slot in keys.iter_mut() {
         *slot = TrustedKey::empty();
     }
+    drop(keys);
+
+    // Digests verified against the old keyring are no longer trusted
+    super::pkcs7::clear_verified_cache();
 }
 
 // ============================================================================
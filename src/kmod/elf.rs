@@ -436,6 +436,12 @@ impl<'a> ModuleLoader<'a> {
         let sym_size = core::mem::size_of::<Elf64Sym>();
         let sym_count = symtab_data.len() / sym_size;
 
+        // Resolved symbol values, indexed by symbol table index. A module
+        // typically references each kernel API from many call sites, so the
+        // name lookup (kernel table, then every loaded module) runs once per
+        // symbol rather than once per relocation.
+        let mut resolved: Vec<Option<u64>> = vec![None; sym_count];
+
         // Process each relocation section
         for i in 0..self.ehdr.e_shnum as usize {
             let shdr = self.get_section(i)?;
@@ -468,14 +474,20 @@ impl<'a> ModuleLoader<'a> {
                     return Err(LoaderError::SymbolNotFound);
                 }
 
-                let sym = unsafe {
-                    ptr::read_unaligned(
-                        symtab_data.as_ptr().add(sym_idx * sym_size) as *const Elf64Sym
-                    )
-                };
-
                 // Get symbol value
-                let sym_val = self.get_symbol_value(&sym, strtab_data)?;
+                let sym_val = match resolved[sym_idx] {
+                    Some(val) => val,
+                    None => {
+                        let sym = unsafe {
+                            ptr::read_unaligned(
+                                symtab_data.as_ptr().add(sym_idx * sym_size) as *const Elf64Sym
+                            )
+                        };
+                        let val = self.get_symbol_value(&sym, strtab_data)?;
+                        resolved[sym_idx] = Some(val);
+                        val
+                    }
+                };
 
                 // Calculate relocation address
                 let rel_addr = target_base + rela.r_offset as usize;
@@ -707,6 +719,13 @@ impl<'a> ModuleLoader<'a> {
     }
 }
 
+/// Read the dependencies an ELF module declares without loading it
+pub fn module_dependencies(data: &[u8]) -> Vec<String> {
+    ModuleLoader::new(data)
+        .and_then(|loader| loader.extract_dependencies())
+        .unwrap_or_default()
+}
+
 /// Load an ELF module and return its entry points
 pub fn load_elf_module(data: &[u8]) -> Result<LoadedModule, LoaderError> {
     let mut loader = ModuleLoader::new(data)?;
@@ -77,6 +77,7 @@
 pub mod crypto;
 pub mod elf;
 pub mod embedded_keys;
+pub mod parallel;
 pub mod pkcs7;
 pub mod symbols;
 
@@ -578,6 +579,12 @@ pub struct ModuleInfo {
     pub taint_flags: u32,
     /// Module load timestamp (ticks since boot)
     pub load_time: u64,
+    /// Load time breakdown (TSC cycles): signature verification
+    pub verify_cycles: u64,
+    /// Load time breakdown (TSC cycles): allocation, relocation and linking
+    pub link_cycles: u64,
+    /// Load time breakdown (TSC cycles): module init function
+    pub init_cycles: u64,
     /// CRC of module text section (for vermagic-like checks)
     pub text_crc: u32,
     /// Kernel version this module was built for
@@ -665,6 +672,9 @@ impl ModuleInfo {
             taints_kernel: false,
             taint_flags: 0,
             load_time: 0,
+            verify_cycles: 0,
+            link_cycles: 0,
+            init_cycles: 0,
             text_crc: 0,
             vermagic: alloc::string::String::new(),
             params: alloc::vec::Vec::new(),
@@ -986,7 +996,22 @@ fn load_elf_module_named(data: &[u8], name: Option<&str>) -> Result<(), ModuleEr
     crate::kinfo!("Loading ELF kernel module ({} bytes)", data.len());
 
     // Verify module signature (REQUIRED)
+    let verify_start = crate::safety::rdtsc();
     let sig_status = verify_module_signature(data);
+    let verify_cycles = crate::safety::rdtsc().saturating_sub(verify_start);
+    load_elf_module_verified(data, name, sig_status, verify_cycles)
+}
+
+/// Load an ELF-based kernel module whose signature has already been checked
+///
+/// `verify_cycles` is the time the signature check took, recorded in the
+/// module's load time breakdown.
+fn load_elf_module_verified(
+    data: &[u8],
+    name: Option<&str>,
+    sig_status: SignatureStatus,
+    verify_cycles: u64,
+) -> Result<(), ModuleError> {
     crate::kinfo!("Module signature status: {}", sig_status.as_str());
 
     // Enforce signature requirement
@@ -1016,7 +1041,9 @@ fn load_elf_module_named(data: &[u8], name: Option<&str>) -> Result<(), ModuleEr
     }
 
     // Load the ELF module
+    let link_start = crate::safety::rdtsc();
     let loaded = elf::load_elf_module(data)?;
+    let link_cycles = crate::safety::rdtsc().saturating_sub(link_start);
 
     crate::kinfo!(
         "ELF module loaded at {:#x}, size {} bytes",
@@ -1091,6 +1118,8 @@ fn load_elf_module_named(data: &[u8], name: Option<&str>) -> Result<(), ModuleEr
     info.srcversion = alloc::string::String::from("in-tree");
     info.license = LicenseType::Mit; // Default for NexaOS modules
     info.load_time = crate::safety::rdtsc();
+    info.verify_cycles = verify_cycles;
+    info.link_cycles = link_cycles;
 
     // Check and apply taint flags
     let taint_flags = info.get_taint_flags();
@@ -1116,6 +1145,7 @@ fn load_elf_module_named(data: &[u8], name: Option<&str>) -> Result<(), ModuleEr
     let _idx = MODULE_REGISTRY.lock().register(info)?;
 
     // Call module init function if present
+    let init_start = crate::safety::rdtsc();
     if loaded.init_fn.is_some() {
         crate::kinfo!("Calling module init function...");
         match loaded.init() {
@@ -1132,11 +1162,14 @@ fn load_elf_module_named(data: &[u8], name: Option<&str>) -> Result<(), ModuleEr
         }
     }
 
+    let init_cycles = crate::safety::rdtsc().saturating_sub(init_start);
+
     // Mark as running
     {
         let mut registry = MODULE_REGISTRY.lock();
         if let Some(mod_info) = registry.find_mut(module_name) {
             mod_info.state = ModuleState::Running;
+            mod_info.init_cycles = init_cycles;
         }
     }
 
@@ -1379,38 +1412,110 @@ pub fn load_from_initramfs(name: &str) -> Result<(), ModuleError> {
 }
 
 /// Load all modules from /lib/modules in initramfs
+///
+/// Signatures of all modules are verified up front in parallel on every
+/// online CPU. Modules are then relocated and initialized one dependency
+/// level at a time, so a module's dependencies are always running before it
+/// loads regardless of directory order.
 pub fn load_initramfs_modules() {
+    // Kernel init and the initramfs boot stage both ask for this; scanning
+    // twice would verify every signature again only to find the modules
+    // already loaded
+    static SCANNED: core::sync::atomic::AtomicBool = core::sync::atomic::AtomicBool::new(false);
+    if SCANNED.swap(true, core::sync::atomic::Ordering::AcqRel) {
+        crate::kdebug!("Initramfs modules already loaded");
+        return;
+    }
+
     crate::kinfo!("Scanning initramfs for kernel modules...");
 
-    if let Some(initramfs) = crate::fs::get_initramfs() {
-        // List /lib/modules directory
-        let mut found_count = 0;
-        let mut loaded_count = 0;
-
-        initramfs.for_each("/lib/modules", |name, _metadata| {
-            if name.ends_with(".nkm") {
-                found_count += 1;
-                // Extract module name (without .nkm extension)
-                let mod_name = &name[..name.len() - 4];
-                match load_from_initramfs(mod_name) {
-                    Ok(()) => {
-                        loaded_count += 1;
-                    }
-                    Err(e) => {
-                        crate::kwarn!("Failed to load module '{}': {:?}", mod_name, e);
-                    }
+    let initramfs = match crate::fs::get_initramfs() {
+        Some(initramfs) => initramfs,
+        None => {
+            crate::kwarn!("Initramfs not available, skipping module load");
+            return;
+        }
+    };
+
+    // Collect module images
+    let mut names: alloc::vec::Vec<alloc::string::String> = alloc::vec::Vec::new();
+    let mut images: alloc::vec::Vec<&'static [u8]> = alloc::vec::Vec::new();
+    initramfs.for_each("/lib/modules", |name, _metadata| {
+        if let Some(mod_name) = name.strip_suffix(".nkm") {
+            let path = alloc::format!("/lib/modules/{}", name);
+            match initramfs.lookup(&path) {
+                Some(entry) => {
+                    names.push(alloc::string::String::from(mod_name));
+                    images.push(entry.data());
                 }
+                None => crate::kwarn!("Module file not found: {}", path),
             }
-        });
+        }
+    });
 
-        crate::kinfo!(
-            "Module scan complete: {} found, {} loaded",
-            found_count,
-            loaded_count
-        );
-    } else {
-        crate::kwarn!("Initramfs not available, skipping module load");
+    let found_count = names.len();
+    if found_count == 0 {
+        crate::kinfo!("Module scan complete: 0 found, 0 loaded");
+        return;
+    }
+
+    // Verify all signatures in parallel
+    let verify_start = crate::safety::rdtsc();
+    let verified = parallel::verify_signatures_parallel(&images);
+    let verify_cycles = crate::safety::rdtsc().saturating_sub(verify_start);
+    let (on_bsp, on_aps) = parallel::verify_stats();
+    crate::kinfo!(
+        "Verified {} module signature(s) in {} cycles ({} on BSP, {} on APs so far)",
+        found_count,
+        verify_cycles,
+        on_bsp,
+        on_aps
+    );
+
+    // Relocate and initialize in dependency order
+    let name_refs: alloc::vec::Vec<&str> = names.iter().map(|n| n.as_str()).collect();
+    let levels = dependency_levels(&name_refs, |name| {
+        name_refs
+            .iter()
+            .position(|n| *n == name)
+            .filter(|&idx| is_elf(images[idx]))
+            .map(|idx| elf::module_dependencies(images[idx]))
+            .unwrap_or_default()
+    });
+
+    let mut loaded_count = 0;
+    for (level, members) in levels.iter().enumerate() {
+        crate::kdebug!("Module load level {}: {} module(s)", level, members.len());
+        for &idx in members {
+            let mod_name = names[idx].as_str();
+            crate::kinfo!(
+                "Loading module from initramfs: /lib/modules/{}.nkm",
+                mod_name
+            );
+            let result = if is_elf(images[idx]) {
+                crate::kinfo!("Loading ELF kernel module ({} bytes)", images[idx].len());
+                let (sig_status, verify_cycles) = verified[idx];
+                load_elf_module_verified(images[idx], Some(mod_name), sig_status, verify_cycles)
+            } else {
+                load_module_named(images[idx], Some(mod_name))
+            };
+            match result {
+                Ok(()) => {
+                    loaded_count += 1;
+                }
+                Err(e) => {
+                    crate::kwarn!("Failed to load module '{}': {:?}", mod_name, e);
+                }
+            }
+        }
     }
+
+    crate::kinfo!(
+        "Module scan complete: {} found, {} loaded ({} dependency level(s))",
+        found_count,
+        loaded_count,
+        levels.len()
+    );
 }
 
 /// Generate an NKM file for a built-in module (for packaging)
@@ -1533,9 +1638,10 @@ pub fn print_module_status() {
         stats.by_type.other
     );
     crate::kinfo!(
-        "Symbol table: {} symbols, {} bytes",
+        "Symbol table: {} symbols, {} bytes ({} hash slots)",
         symbol_stats.symbol_count,
-        symbol_stats.total_bytes
+        symbol_stats.total_bytes,
+        symbol_stats.index_slots
     );
 
     // List all loaded modules with extended info
@@ -1579,6 +1685,12 @@ pub fn print_module_details(name: &str) {
             crate::kinfo!("Taint flags: {:#x}", info.taint_flags);
         }
         crate::kinfo!("Load time (TSC): {}", info.load_time);
+        crate::kinfo!(
+            "Load cost (TSC cycles): verify {}, link {}, init {}",
+            info.verify_cycles,
+            info.link_cycles,
+            info.init_cycles
+        );
         crate::kinfo!("Vermagic: {}", info.vermagic);
         if !info.dependencies.is_empty() {
             crate::kinfo!("Dependencies: {:?}", info.dependencies);
@@ -2236,6 +2348,62 @@ pub fn topological_sort_modules(
     Ok(result)
 }
 
+/// Group modules into dependency levels for loading
+///
+/// Returns indices into `modules`. Level 0 holds modules with no dependency
+/// inside `modules`; level N holds modules whose dependencies all sit in
+/// earlier levels, so modules within one level are independent of each other.
+/// Dependencies outside `modules` are ignored (they must already be loaded).
+/// Modules on a dependency cycle are placed in a final level, where loading
+/// them reports the missing dependency.
+pub fn dependency_levels(
+    modules: &[&str],
+    get_deps: impl Fn(&str) -> alloc::vec::Vec<alloc::string::String>,
+) -> alloc::vec::Vec<alloc::vec::Vec<usize>> {
+    let deps: alloc::vec::Vec<alloc::vec::Vec<usize>> = modules
+        .iter()
+        .map(|name| {
+            get_deps(name)
+                .iter()
+                .filter_map(|dep| modules.iter().position(|m| *m == dep.as_str()))
+                .collect()
+        })
+        .collect();
+
+    let mut level_of: alloc::vec::Vec<Option<usize>> = alloc::vec![None; modules.len()];
+    let mut levels: alloc::vec::Vec<alloc::vec::Vec<usize>> = alloc::vec::Vec::new();
+    let mut assigned = 0;
+
+    while assigned < modules.len() {
+        let current = levels.len();
+        let ready: alloc::vec::Vec<usize> = (0..modules.len())
+            .filter(|&i| level_of[i].is_none())
+            .filter(|&i| {
+                deps[i]
+                    .iter()
+                    .all(|&d| matches!(level_of[d], Some(l) if l < current))
+            })
+            .collect();
+
+        if ready.is_empty() {
+            // Remaining modules depend on each other in a cycle
+            let rest: alloc::vec::Vec<usize> = (0..modules.len())
+                .filter(|&i| level_of[i].is_none())
+                .collect();
+            levels.push(rest);
+            break;
+        }
+
+        for &i in &ready {
+            level_of[i] = Some(current);
+        }
+        assigned += ready.len();
+        levels.push(ready);
+    }
+
+    levels
+}
+
 /// Get the dependency graph as a printable string
 pub fn get_dependency_graph() -> alloc::string::String {
     use core::fmt::Write;
@@ -0,0 +1,170 @@
+//! Parallel module signature verification
+//!
+//! Every initramfs module carries a PKCS#7 signature, and the RSA check is by
+//! far the most expensive step of loading it. The checks only read the module
+//! image and the trusted keyring, so at boot they are fanned out to the AP
+//! cores with `smp_call_function()`. The BSP participates as well and keeps
+//! relocation and module init serial, since module init registers filesystems
+//! and drivers and must not run in IPI context.
+//!
+//! Work distribution follows the compositor: jobs are published through
+//! atomics and each CPU claims the next unverified image until none remain.
+
+use alloc::vec::Vec;
+use core::sync::atomic::{AtomicBool, AtomicPtr, AtomicU64, AtomicU8, AtomicUsize, Ordering};
+
+use super::{pkcs7, SignatureStatus};
+use crate::smp;
+
+/// One image to verify
+struct VerifyJob {
+    data: *const u8,
+    len: usize,
+    /// Encoded `SignatureStatus` once done
+    status: AtomicU8,
+    /// TSC cycles the check took
+    cycles: AtomicU64,
+}
+
+/// Published job array (valid while `WORK_AVAILABLE` or `ACTIVE_WORKERS` > 0)
+static JOBS_PTR: AtomicPtr<VerifyJob> = AtomicPtr::new(core::ptr::null_mut());
+static JOBS_LEN: AtomicUsize = AtomicUsize::new(0);
+/// Next job index to claim
+static NEXT_JOB: AtomicUsize = AtomicUsize::new(0);
+/// Number of finished jobs
+static JOBS_DONE: AtomicUsize = AtomicUsize::new(0);
+/// Set while a batch is being verified
+static WORK_AVAILABLE: AtomicBool = AtomicBool::new(false);
+/// CPUs currently inside `ap_work_entry()`
+static ACTIVE_WORKERS: AtomicUsize = AtomicUsize::new(0);
+
+// Statistics
+static VERIFIED_ON_BSP: AtomicU64 = AtomicU64::new(0);
+static VERIFIED_ON_APS: AtomicU64 = AtomicU64::new(0);
+
+fn encode_status(status: SignatureStatus) -> u8 {
+    match status {
+        SignatureStatus::Unsigned => 1,
+        SignatureStatus::Valid => 2,
+        SignatureStatus::Invalid => 3,
+        SignatureStatus::UnknownFormat => 4,
+        SignatureStatus::KeyNotFound => 5,
+    }
+}
+
+fn decode_status(v: u8) -> SignatureStatus {
+    match v {
+        1 => SignatureStatus::Unsigned,
+        2 => SignatureStatus::Valid,
+        4 => SignatureStatus::UnknownFormat,
+        5 => SignatureStatus::KeyNotFound,
+        _ => SignatureStatus::Invalid,
+    }
+}
+
+/// Verify a single module image
+pub fn verify_image(data: &[u8]) -> SignatureStatus {
+    pkcs7::verify_module_signature(data).to_signature_status()
+}
+
+/// Claim and verify jobs until none remain. Returns the number verified.
+fn run_jobs() -> u64 {
+    let jobs = JOBS_PTR.load(Ordering::Acquire);
+    let len = JOBS_LEN.load(Ordering::Acquire);
+    if jobs.is_null() {
+        return 0;
+    }
+
+    let mut done = 0;
+    loop {
+        let idx = NEXT_JOB.fetch_add(1, Ordering::AcqRel);
+        if idx >= len {
+            break;
+        }
+        // Safety: the job array outlives the batch (see verify_signatures_parallel)
+        let job = unsafe { &*jobs.add(idx) };
+        let data = unsafe { core::slice::from_raw_parts(job.data, job.len) };
+        let (status, cycles) = verify_timed(data);
+        job.cycles.store(cycles, Ordering::Relaxed);
+        job.status.store(encode_status(status), Ordering::Release);
+        JOBS_DONE.fetch_add(1, Ordering::AcqRel);
+        done += 1;
+    }
+    done
+}
+
+/// Entry point for AP cores, queued by `verify_signatures_parallel()`
+fn ap_work_entry(_: usize) {
+    ACTIVE_WORKERS.fetch_add(1, Ordering::SeqCst);
+    if WORK_AVAILABLE.load(Ordering::SeqCst) {
+        let done = run_jobs();
+        VERIFIED_ON_APS.fetch_add(done, Ordering::Relaxed);
+    }
+    ACTIVE_WORKERS.fetch_sub(1, Ordering::SeqCst);
+}
+
+/// Verify one image on the calling CPU, returning its status and cost in cycles
+fn verify_timed(data: &[u8]) -> (SignatureStatus, u64) {
+    let start = crate::safety::rdtsc();
+    let status = verify_image(data);
+    (status, crate::safety::rdtsc().saturating_sub(start))
+}
+
+/// Verify the signatures of `images`, spreading the work over all online CPUs.
+///
+/// Returns one (status, TSC cycles) pair per image, in order.
+pub fn verify_signatures_parallel(images: &[&[u8]]) -> Vec<(SignatureStatus, u64)> {
+    if images.len() < 2 || smp::online_cpus() <= 1 {
+        VERIFIED_ON_BSP.fetch_add(images.len() as u64, Ordering::Relaxed);
+        return images.iter().map(|data| verify_timed(data)).collect();
+    }
+
+    let jobs: Vec<VerifyJob> = images
+        .iter()
+        .map(|data| VerifyJob {
+            data: data.as_ptr(),
+            len: data.len(),
+            status: AtomicU8::new(0),
+            cycles: AtomicU64::new(0),
+        })
+        .collect();
+
+    JOBS_LEN.store(jobs.len(), Ordering::Release);
+    NEXT_JOB.store(0, Ordering::Release);
+    JOBS_DONE.store(0, Ordering::Release);
+    JOBS_PTR.store(jobs.as_ptr() as *mut VerifyJob, Ordering::Release);
+    WORK_AVAILABLE.store(true, Ordering::SeqCst);
+
+    smp::smp_call_function(ap_work_entry, 0, false);
+
+    let done = run_jobs();
+    VERIFIED_ON_BSP.fetch_add(done, Ordering::Relaxed);
+
+    // Wait for jobs claimed by APs, then for every AP to leave the job array
+    while JOBS_DONE.load(Ordering::Acquire) < jobs.len() {
+        core::hint::spin_loop();
+    }
+    WORK_AVAILABLE.store(false, Ordering::SeqCst);
+    while ACTIVE_WORKERS.load(Ordering::SeqCst) != 0 {
+        core::hint::spin_loop();
+    }
+    JOBS_PTR.store(core::ptr::null_mut(), Ordering::Release);
+    JOBS_LEN.store(0, Ordering::Release);
+
+    jobs.iter()
+        .map(|job| {
+            (
+                decode_status(job.status.load(Ordering::Acquire)),
+                job.cycles.load(Ordering::Relaxed),
+            )
+        })
+        .collect()
+}
+
+/// Verification statistics: (verified on BSP, verified on APs)
+pub fn verify_stats() -> (u64, u64) {
+    (
+        VERIFIED_ON_BSP.load(Ordering::Relaxed),
+        VERIFIED_ON_APS.load(Ordering::Relaxed),
+    )
+}
@@ -45,13 +45,22 @@
 //! - Context-specific tags (IMPLICIT and EXPLICIT)
 //! - Long-form length encoding
 //! - Nested structures
+//!
+//! # Verified-Digest Cache
+//!
+//! The SHA-256 of every module body that passed verification is remembered.
+//! Loading identical content again (reload after rmmod, the same image from
+//! another path) only costs the content hash, which verification needs
+//! anyway; the PKCS#7 parse and RSA operation are skipped.
 
 use super::crypto::{
-    find_trusted_key, hash_with_algorithm, is_key_trusted, HashAlgorithm, RsaPublicKey,
+    find_trusted_key, hash_with_algorithm, is_key_trusted, sha256, HashAlgorithm, RsaPublicKey,
     OID_CONTENT_TYPE, OID_MESSAGE_DIGEST, OID_PKCS7_DATA, OID_SIGNING_TIME, SHA256_DIGEST_SIZE,
     SHA384_DIGEST_SIZE, SHA512_DIGEST_SIZE,
 };
 use alloc::vec::Vec;
+use core::sync::atomic::{AtomicU64, Ordering};
+use spin::Mutex;
 
 // ============================================================================
 // Module Signature Structures (Linux-compatible)
@@ -760,6 +769,65 @@ pub fn extract_module_signature(data: &[u8]) -> Option<(&[u8], &[u8], ModuleSigI
     Some((module_content, signature_data, sig_info))
 }
 
+// ============================================================================
+// Verified-Digest Cache
+// ============================================================================
+
+/// Number of verified module digests remembered
+const VERIFIED_CACHE_SIZE: usize = 32;
+
+/// Ring of SHA-256 digests of module bodies that verified as valid
+struct VerifiedDigestCache {
+    digests: [[u8; SHA256_DIGEST_SIZE]; VERIFIED_CACHE_SIZE],
+    count: usize,
+    next: usize,
+}
+
+impl VerifiedDigestCache {
+    const fn new() -> Self {
+        Self {
+            digests: [[0u8; SHA256_DIGEST_SIZE]; VERIFIED_CACHE_SIZE],
+            count: 0,
+            next: 0,
+        }
+    }
+
+    fn contains(&self, digest: &[u8; SHA256_DIGEST_SIZE]) -> bool {
+        self.digests[..self.count].iter().any(|d| d == digest)
+    }
+
+    fn insert(&mut self, digest: &[u8; SHA256_DIGEST_SIZE]) {
+        if self.contains(digest) {
+            return;
+        }
+        self.digests[self.next] = *digest;
+        self.next = (self.next + 1) % VERIFIED_CACHE_SIZE;
+        if self.count < VERIFIED_CACHE_SIZE {
+            self.count += 1;
+        }
+    }
+}
+
+static VERIFIED_DIGESTS: Mutex<VerifiedDigestCache> = Mutex::new(VerifiedDigestCache::new());
+static VERIFY_CACHE_HITS: AtomicU64 = AtomicU64::new(0);
+static VERIFY_CACHE_MISSES: AtomicU64 = AtomicU64::new(0);
+
+/// Forget all verified digests (called when the trusted keyring changes)
+pub fn clear_verified_cache() {
+    let mut cache = VERIFIED_DIGESTS.lock();
+    cache.count = 0;
+    cache.next = 0;
+}
+
+/// Verified-digest cache statistics: (hits, misses, entries)
+pub fn verified_cache_stats() -> (u64, u64, usize) {
+    (
+        VERIFY_CACHE_HITS.load(Ordering::Relaxed),
+        VERIFY_CACHE_MISSES.load(Ordering::Relaxed),
+        VERIFIED_DIGESTS.lock().count,
+    )
+}
+
 /// Verify a signed kernel module
 pub fn verify_module_signature(data: &[u8]) -> SignatureVerifyResult {
     // Extract signature components
@@ -768,6 +836,15 @@ pub fn verify_module_signature(data: &[u8]) -> SignatureVerifyResult {
         None => return SignatureVerifyResult::Unsigned,
     };
 
+    // Identical content that already verified needs no RSA operation
+    let content_sha256 = sha256(module_content);
+    if VERIFIED_DIGESTS.lock().contains(&content_sha256) {
+        VERIFY_CACHE_HITS.fetch_add(1, Ordering::Relaxed);
+        crate::kdebug!("Module digest found in verified cache");
+        return SignatureVerifyResult::Valid;
+    }
+    VERIFY_CACHE_MISSES.fetch_add(1, Ordering::Relaxed);
+
     crate::kdebug!(
         "Module signature: {} bytes, hash algo: {:?}",
         sig_info.signature_len(),
@@ -796,8 +873,9 @@ pub fn verify_module_signature(data: &[u8]) -> SignatureVerifyResult {
 
     // Verify each signer
     for signer in &pkcs7.signer_infos {
-        let result = verify_signer(module_content, signer, &pkcs7);
+        let result = verify_signer(module_content, &content_sha256, signer, &pkcs7);
         if result == SignatureVerifyResult::Valid {
+            VERIFIED_DIGESTS.lock().insert(&content_sha256);
             return SignatureVerifyResult::Valid;
         }
         // Continue trying other signers
@@ -810,13 +888,18 @@ pub fn verify_module_signature(data: &[u8]) -> SignatureVerifyResult {
 /// Verify a single signer's signature (full PKCS#7 implementation)
 fn verify_signer(
     module_content: &[u8],
+    content_sha256: &[u8; SHA256_DIGEST_SIZE],
     signer: &SignerInfo<'_>,
     pkcs7: &Pkcs7SignedData<'_>,
 ) -> SignatureVerifyResult {
     let digest_algo = signer.digest_algorithm;
 
     // Compute message digest based on the specified algorithm
-    let content_hash = hash_with_algorithm(module_content, digest_algo);
+    let content_hash = if digest_algo == HashAlgorithm::Sha256 {
+        content_sha256.to_vec()
+    } else {
+        hash_with_algorithm(module_content, digest_algo)
+    };
     crate::kinfo!(
         "Content hash ({:?})[0..4]={:02X}{:02X}{:02X}{:02X}",
         digest_algo,
@@ -8,6 +8,14 @@
 //! The symbol table uses heap allocation for the string table to avoid
 //! bloating the kernel binary with large static buffers. Symbol entries
 //! are stored in a Vec for dynamic growth.
+//!
+//! # Lookup
+//!
+//! Module relocation resolves every undefined symbol through this table, so
+//! lookups go through a GNU-hash (`h = h * 33 + c`) open-addressing index
+//! instead of a linear scan. The index stores positions into `symbols` and is
+//! kept at a load factor of at most 1/2; the cached hash of each entry lets a
+//! probe skip string comparisons for almost every non-matching slot.
 
 use alloc::string::String;
 use alloc::vec::Vec;
@@ -57,10 +65,27 @@ const INITIAL_SYMBOL_CAPACITY: usize = 64;
 /// Maximum symbols (soft limit, can grow)
 const MAX_SYMBOLS_SOFT_LIMIT: usize = 512;
 
+/// Empty slot marker in the hash index
+const EMPTY_SLOT: u32 = u32::MAX;
+
+/// GNU-style symbol name hash (same function as `DT_GNU_HASH`)
+#[inline]
+pub fn symbol_hash(name: &str) -> u32 {
+    let mut h: u32 = 5381;
+    for &b in name.as_bytes() {
+        h = h.wrapping_mul(33).wrapping_add(b as u32);
+    }
+    h
+}
+
 /// Kernel symbol registry (heap-allocated)
 pub struct SymbolTable {
     /// Symbols stored in heap-allocated Vec
     symbols: Vec<KernelSymbol>,
+    /// Cached `symbol_hash()` of each entry in `symbols`
+    hashes: Vec<u32>,
+    /// Open-addressing index into `symbols` (power-of-two size)
+    index: Vec<u32>,
     /// Whether the table has been initialized
     initialized: bool,
 }
@@ -68,9 +93,11 @@ pub struct SymbolTable {
 impl SymbolTable {
     /// Create an uninitialized symbol table
     /// Must call init() before use to allocate heap memory
-    const fn new_uninit() -> Self {
+    pub const fn new_uninit() -> Self {
         Self {
             symbols: Vec::new(),
+            hashes: Vec::new(),
+            index: Vec::new(),
             initialized: false,
         }
     }
@@ -81,9 +108,54 @@ impl SymbolTable {
             return;
         }
         self.symbols = Vec::with_capacity(INITIAL_SYMBOL_CAPACITY);
+        self.hashes = Vec::with_capacity(INITIAL_SYMBOL_CAPACITY);
+        self.index = alloc::vec![EMPTY_SLOT; INITIAL_SYMBOL_CAPACITY * 2];
         self.initialized = true;
     }
 
+    /// Find the position of `name` in `symbols` (any visibility)
+    fn find_index(&self, name: &str) -> Option<usize> {
+        if self.index.is_empty() {
+            return None;
+        }
+        let hash = symbol_hash(name);
+        let mask = self.index.len() - 1;
+        let mut slot = hash as usize & mask;
+        loop {
+            let pos = self.index[slot];
+            if pos == EMPTY_SLOT {
+                return None;
+            }
+            let pos = pos as usize;
+            if self.hashes[pos] == hash && self.symbols[pos].name == name {
+                return Some(pos);
+            }
+            slot = (slot + 1) & mask;
+        }
+    }
+
+    /// Insert symbol position `pos` into the index (no duplicate check)
+    fn index_insert(&mut self, pos: usize) {
+        let mask = self.index.len() - 1;
+        let mut slot = self.hashes[pos] as usize & mask;
+        while self.index[slot] != EMPTY_SLOT {
+            slot = (slot + 1) & mask;
+        }
+        self.index[slot] = pos as u32;
+    }
+
+    /// Rebuild the index with room for at least `count` symbols
+    fn rebuild_index(&mut self, count: usize) {
+        let slots = (count * 2)
+            .next_power_of_two()
+            .max(INITIAL_SYMBOL_CAPACITY * 2);
+        self.index.clear();
+        self.index.resize(slots, EMPTY_SLOT);
+        for pos in 0..self.symbols.len() {
+            self.index_insert(pos);
+        }
+    }
+
     /// Register a new symbol with default global visibility
     pub fn register(&mut self, name: &str, address: u64, sym_type: SymbolType) -> bool {
         self.register_with_visibility(name, address, sym_type, SymbolVisibility::Global)
@@ -110,11 +182,16 @@ impl SymbolTable {
         }
 
         // Check for duplicate
-        if self.symbols.iter().any(|s| s.name == name) {
+        if self.find_index(name).is_some() {
             crate::kwarn!("Duplicate symbol registration: {}", name);
             return false;
         }
 
+        // Keep the index at most half full
+        if (self.symbols.len() + 1) * 2 > self.index.len() {
+            self.rebuild_index(self.symbols.len() + 1);
+        }
+
         // Add symbol entry (heap-allocated)
         self.symbols.push(KernelSymbol {
             name: String::from(name),
@@ -122,23 +199,22 @@ impl SymbolTable {
             sym_type,
             visibility,
         });
+        self.hashes.push(symbol_hash(name));
+        self.index_insert(self.symbols.len() - 1);
 
         true
     }
 
     /// Lookup a symbol by name
     pub fn lookup(&self, name: &str) -> Option<u64> {
-        self.symbols
-            .iter()
-            .find(|sym| sym.name == name && sym.visibility != SymbolVisibility::Hidden)
-            .map(|sym| sym.address)
+        self.lookup_full(name).map(|sym| sym.address)
     }
 
     /// Lookup a symbol and return full info
     pub fn lookup_full(&self, name: &str) -> Option<&KernelSymbol> {
-        self.symbols
-            .iter()
-            .find(|sym| sym.name == name && sym.visibility != SymbolVisibility::Hidden)
+        self.find_index(name)
+            .map(|pos| &self.symbols[pos])
+            .filter(|sym| sym.visibility != SymbolVisibility::Hidden)
     }
 
     /// Get all registered symbols
@@ -161,8 +237,12 @@ impl SymbolTable {
 
     /// Unregister a symbol by name
     pub fn unregister(&mut self, name: &str) -> bool {
-        if let Some(pos) = self.symbols.iter().position(|sym| sym.name == name) {
+        if let Some(pos) = self.find_index(name) {
+            // swap_remove moves the last entry, so positions in the index
+            // change; unregistering is rare enough to simply rebuild.
             self.symbols.swap_remove(pos);
+            self.hashes.swap_remove(pos);
+            self.rebuild_index(self.symbols.len());
             true
         } else {
             false
@@ -173,11 +253,15 @@ impl SymbolTable {
     pub fn memory_usage(&self) -> SymbolTableStats {
         let string_bytes: usize = self.symbols.iter().map(|s| s.name.len()).sum();
         let entry_bytes = self.symbols.len() * core::mem::size_of::<KernelSymbol>();
+        let index_bytes = self.index.len() * core::mem::size_of::<u32>()
+            + self.hashes.len() * core::mem::size_of::<u32>();
         SymbolTableStats {
             symbol_count: self.symbols.len(),
             string_bytes,
             entry_bytes,
-            total_bytes: string_bytes + entry_bytes,
+            index_slots: self.index.len(),
+            index_bytes,
+            total_bytes: string_bytes + entry_bytes + index_bytes,
         }
     }
 }
@@ -188,6 +272,10 @@ pub struct SymbolTableStats {
     pub symbol_count: usize,
     pub string_bytes: usize,
     pub entry_bytes: usize,
+    /// Number of slots in the hash index
+    pub index_slots: usize,
+    /// Bytes used by the hash index and cached hashes
+    pub index_bytes: usize,
     pub total_bytes: usize,
 }
 
@@ -481,20 +481,22 @@ fn proceed_after_initramfs(cmdline_opt: Option<&'static str>) -> ! {
     );
 
     // Initialize subsystems in dependency order
-    auth::init(); // User authentication system
-    ipc::init(); // Inter-process communication
-    signal::init(); // POSIX signal handling
-    pipe::init(); // Pipe system
-    process::coredump::init(); // Core dump subsystem
+    boot::timeline::stage("core subsystems", || {
+        auth::init(); // User authentication system
+        ipc::init(); // Inter-process communication
+        signal::init(); // POSIX signal handling
+        pipe::init(); // Pipe system
+        process::coredump::init(); // Core dump subsystem
+    });
 
     // Initialize SMP after interrupts are enabled but before scheduler
     // This allows AP cores to come online safely
-    crate::smp::init();
+    boot::timeline::stage("smp", crate::smp::init);
 
     // Initialize NUMA topology detection after SMP/ACPI init
     // This must come before scheduler for NUMA-aware load balancing
     #[cfg(feature = "numa")]
-    if let Err(e) = numa::init() {
+    if let Err(e) = boot::timeline::stage("numa", numa::init) {
         kwarn!("NUMA initialization failed: {}", e);
     }
     #[cfg(not(feature = "numa"))]
@@ -505,29 +507,32 @@ fn proceed_after_initramfs(cmdline_opt: Option<&'static str>) -> ! {
     allocator::init_numa_allocator();
 
     // Initialize parallel display compositor after SMP and NUMA
-    // This enables multi-core accelerated display rendering
+    // This enables multi-core accelerated display rendering. Nothing on the
+    // boot path renders through it, so it is initialized asynchronously.
     #[cfg(feature = "gfx_compositor")]
-    {
+    boot::deferred::defer("compositor", || {
         drivers::compositor::init();
         kinfo!(
             "Compositor: {} worker(s) ready for parallel rendering",
             drivers::compositor::worker_count()
         );
-    }
+    });
     #[cfg(not(feature = "gfx_compositor"))]
     kinfo!("Compositor disabled (gfx_compositor feature not enabled)");
 
     // Initialize random number generator (RDRAND/RDSEED + ChaCha20 CSPRNG)
-    drivers::random::init();
+    boot::timeline::stage("random", drivers::random::init);
 
     // Best-effort: initialize CLOCK_REALTIME from CMOS RTC.
-    drivers::rtc::init_system_time_from_rtc_once();
+    boot::timeline::stage("rtc", drivers::rtc::init_system_time_from_rtc_once);
 
-    scheduler::init(); // Process scheduler
-    fs::init(); // Filesystem
+    boot::timeline::stage("scheduler", scheduler::init); // Process scheduler
+    boot::timeline::stage("fs", fs::init); // Filesystem
     kmod::init(); // Kernel module system
-    kmod::load_initramfs_modules(); // Load .nkm modules from /lib/modules
-    udrv::init(); // User-space driver framework (HongMeng-inspired)
+    // Load .nkm modules from /lib/modules
+    boot::timeline::stage("initramfs modules", kmod::load_initramfs_modules);
+    // User-space driver framework (HongMeng-inspired)
+    boot::timeline::stage("udrv", udrv::init);
     init::init(); // Init system (PID 1 management)
 
     let elapsed_us = logger::boot_time_us();
@@ -542,15 +547,15 @@ fn proceed_after_initramfs(cmdline_opt: Option<&'static str>) -> ! {
 
     // Stage 3: Initramfs Stage - Mount virtual filesystems and prepare for real root
     kinfo!("Stage 3: Initramfs Stage - Starting...");
-    if let Err(e) = boot_stages::initramfs_stage() {
+    if let Err(e) = boot::timeline::stage("initramfs stage", boot_stages::initramfs_stage) {
         boot_stages::enter_emergency_mode(e);
     }
     kinfo!("Stage 3: Initramfs Stage - Complete");
 
-    // Initialize network stack (before mounting real root)
-    kinfo!("Initializing network subsystem...");
-    crate::net::init();
-    kinfo!("Network subsystem initialized");
+    // Initialize NIC drivers and the network stack while the root is being
+    // mounted; the root device does not depend on them
+    kinfo!("Initializing network subsystem (deferred)...");
+    boot::deferred::defer("net", crate::net::init);
 
     // Stage 4 & 5: Mount real root (if specified) or use initramfs
     let config = boot_stages::boot_config();
@@ -562,12 +567,12 @@ fn proceed_after_initramfs(cmdline_opt: Option<&'static str>) -> ! {
         kinfo!("Stage 4: Root Mounting - Complete");
 
         kinfo!("Stage 5: Root Switch - Starting...");
-        if let Err(e) = boot_stages::pivot_to_real_root() {
+        if let Err(e) = boot::timeline::stage("root switch", boot_stages::pivot_to_real_root) {
             boot_stages::enter_emergency_mode(e);
         }
         kinfo!("Stage 5: Root Switch - Complete");
 
-        if let Err(e) = boot_stages::start_real_root_init() {
+        if let Err(e) = boot::timeline::stage("real root init", boot_stages::start_real_root_init) {
             boot_stages::enter_emergency_mode(e);
         }
     } else {
@@ -638,6 +643,10 @@ fn proceed_after_initramfs(cmdline_opt: Option<&'static str>) -> ! {
     // If we have init loaded, start the scheduler
     // All processes (including init) run through the scheduler
     if let Some(pid) = init_pid {
+        // Userspace expects every subsystem to be up
+        boot::deferred::wait_all();
+        boot::timeline::mark_boot_complete();
+
         kinfo!("==========================================================");
         kinfo!("Init process loaded (PID {}), starting scheduler", pid);
         kinfo!("==========================================================");
@@ -370,6 +370,11 @@ pub fn boot_time_us() -> u64 {
     ticks.saturating_mul(1_000_000) / freq
 }
 
+/// TSC value captured when the logger was initialized (0 before that)
+pub fn boot_tsc() -> u64 {
+    BOOT_TSC.load(Ordering::Relaxed)
+}
+
 pub fn tsc_frequency_hz() -> u64 {
     TSC_FREQUENCY_HZ.load(Ordering::Relaxed)
 }
@@ -102,6 +102,14 @@ static FREE_USER_REGIONS: spin::Mutex<[(u64, u64); MAX_FREE_REGIONS]> =
 static USER_REGIONS_ALLOCATED: AtomicU64 = AtomicU64::new(0);
 static USER_REGIONS_FREED: AtomicU64 = AtomicU64::new(0);
 
+// Lazily zeroed user regions (see defer_user_region_zeroing)
+// Each entry is (region_base, pending_mask) - bit N set means the Nth 2 MiB page
+// of the region still holds stale contents and must be zeroed before it is mapped.
+static LAZY_ZERO_REGIONS: spin::Mutex<[(u64, u64); MAX_FREE_REGIONS]> =
+    spin::Mutex::new([(0, 0); MAX_FREE_REGIONS]);
+static LAZY_ZERO_PAGES_DEFERRED: AtomicU64 = AtomicU64::new(0);
+static LAZY_ZERO_PAGES_ZEROED: AtomicU64 = AtomicU64::new(0);
+
 fn allocate_extra_table() -> Option<&'static PageTableHolder> {
     let idx = EXTRA_TABLE_INDEX.fetch_add(1, AtomicOrdering::SeqCst);
     if idx >= EXTRA_TABLES.len() {
@@ -975,6 +983,10 @@ pub fn free_user_region(base: u64, size: u64) {
     const ALIGN: u64 = 0x200000; // 2 MiB pages
     let aligned_size = (size + ALIGN - 1) & !(ALIGN - 1);
 
+    // allocate_user_region() zeroes the whole region on reuse, so any pending
+    // lazy-zero state for this base is obsolete
+    forget_lazy_zero_region(base);
+
     let mut free_list = FREE_USER_REGIONS.lock();
 
     // Try to find an empty slot in the free list
@@ -1152,6 +1164,9 @@ pub fn handle_user_demand_fault(
     // to map the virtual page to the corresponding physical page
     let page_phys = memory_base + offset;
 
+    // Pages left behind by the previous image are zeroed on first touch
+    zero_pending_user_page(memory_base, offset);
+
     // Map the page in the process's page table
     unsafe {
         map_user_page_in_cr3(cr3, page_virt, page_phys)?;
@@ -1233,9 +1248,148 @@ unsafe fn map_user_page_in_cr3(
 pub fn print_demand_paging_statistics() {
     let faults = DEMAND_PAGE_FAULTS.load(AtomicOrdering::Relaxed);
     let allocated = DEMAND_PAGES_ALLOCATED.load(AtomicOrdering::Relaxed);
+    let deferred = LAZY_ZERO_PAGES_DEFERRED.load(AtomicOrdering::Relaxed);
+    let zeroed = LAZY_ZERO_PAGES_ZEROED.load(AtomicOrdering::Relaxed);
 
     crate::kinfo!("=== Demand Paging Statistics ===");
     crate::kinfo!("  Total page faults handled: {}", faults);
     crate::kinfo!("  Total pages allocated on-demand: {}", allocated);
+    crate::kinfo!(
+        "  Lazy-zero pages: {} deferred, {} zeroed on fault, {} never touched",
+        deferred,
+        zeroed,
+        deferred.saturating_sub(zeroed)
+    );
     crate::kinfo!("=== End Demand Paging Statistics ===");
 }
+
+// =============================================================================
+// Lazy Zeroing of User Regions
+// =============================================================================
+//
+// execve() reuses the caller's physical region, which used to be cleared in
+// full (USER_REGION_SIZE, ~28 MiB) before loading the new image. Most of that
+// is heap and interpreter space the new program may never touch. Instead the
+// loader zeroes only the pages it populates and marks the rest pending; a
+// pending page is zeroed by the demand fault handler right before it is mapped.
+
+const LAZY_ZERO_PAGE_SIZE: u64 = 0x200000; // 2 MiB, same granularity as demand paging
+
+// The pending mask holds one bit per 2 MiB page of a user region
+const _: () = assert!(
+    crate::process::USER_REGION_SIZE / LAZY_ZERO_PAGE_SIZE <= 64,
+    "user region does not fit in a 64-bit lazy-zero mask"
+);
+
+fn lazy_zero_page_bit(offset: u64) -> u64 {
+    1u64 << (offset / LAZY_ZERO_PAGE_SIZE)
+}
+
+/// Mark every 2 MiB page of a user region as needing zeroing before first use.
+///
+/// The caller must have cleared all user mappings of the region first, so
+/// that every subsequent access goes through `handle_user_demand_fault()`.
+/// Falls back to clearing the region eagerly if the tracking table is full.
+pub fn defer_user_region_zeroing(base: u64, size: u64) {
+    let pages = (size + LAZY_ZERO_PAGE_SIZE - 1) / LAZY_ZERO_PAGE_SIZE;
+    let mask = if pages >= 64 { u64::MAX } else { (1u64 << pages) - 1 };
+
+    let mut regions = LAZY_ZERO_REGIONS.lock();
+    let mut free_slot = None;
+    for (idx, slot) in regions.iter_mut().enumerate() {
+        if slot.0 == base {
+            let newly_pending = mask & !slot.1;
+            slot.1 |= mask;
+            LAZY_ZERO_PAGES_DEFERRED
+                .fetch_add(newly_pending.count_ones() as u64, AtomicOrdering::Relaxed);
+            return;
+        }
+        if slot.0 == 0 && free_slot.is_none() {
+            free_slot = Some(idx);
+        }
+    }
+
+    match free_slot {
+        Some(idx) => {
+            regions[idx] = (base, mask);
+            LAZY_ZERO_PAGES_DEFERRED.fetch_add(pages, AtomicOrdering::Relaxed);
+        }
+        None => {
+            drop(regions);
+            crate::kwarn!(
+                "defer_user_region_zeroing: table full, clearing region {:#x} eagerly",
+                base
+            );
+            unsafe {
+                core::ptr::write_bytes(base as *mut u8, 0, size as usize);
+            }
+        }
+    }
+}
+
+/// Zero (now) any pending pages of a user region overlapping `[offset, offset + len)`.
+///
+/// Used before the kernel writes into a region through its physical address
+/// (ELF segments, initial stack), which bypasses the demand fault path.
+pub fn zero_user_range_now(base: u64, offset: u64, len: u64) {
+    if len == 0 {
+        return;
+    }
+    let first = offset & !(LAZY_ZERO_PAGE_SIZE - 1);
+    let mut page = first;
+    while page < offset + len {
+        zero_pending_user_page(base, page);
+        page += LAZY_ZERO_PAGE_SIZE;
+    }
+}
+
+/// Returns true if the 2 MiB page at `offset` in the region is still pending zeroing.
+///
+/// Pending pages read as zero to the owning process, so fork() does not need
+/// to copy them into the (already zeroed) child region.
+pub fn user_page_zero_pending(base: u64, offset: u64) -> bool {
+    let regions = LAZY_ZERO_REGIONS.lock();
+    regions
+        .iter()
+        .any(|slot| slot.0 == base && slot.1 & lazy_zero_page_bit(offset) != 0)
+}
+
+/// Zero the 2 MiB page at `offset` if it is pending and clear its pending bit.
+///
+/// The page is zeroed while the table lock is held so that a thread faulting
+/// on the same page from another CPU cannot map it before the clear finishes.
+fn zero_pending_user_page(base: u64, offset: u64) {
+    let bit = lazy_zero_page_bit(offset);
+    let mut regions = LAZY_ZERO_REGIONS.lock();
+    for slot in regions.iter_mut() {
+        if slot.0 != base {
+            continue;
+        }
+        if slot.1 & bit != 0 {
+            let page_offset = offset & !(LAZY_ZERO_PAGE_SIZE - 1);
+            unsafe {
+                core::ptr::write_bytes(
+                    (base + page_offset) as *mut u8,
+                    0,
+                    LAZY_ZERO_PAGE_SIZE as usize,
+                );
+            }
+            slot.1 &= !bit;
+            LAZY_ZERO_PAGES_ZEROED.fetch_add(1, AtomicOrdering::Relaxed);
+            if slot.1 == 0 {
+                *slot = (0, 0);
+            }
+        }
+        return;
+    }
+}
+
+/// Drop lazy-zero tracking for a region that is being freed.
+fn forget_lazy_zero_region(base: u64) {
+    let mut regions = LAZY_ZERO_REGIONS.lock();
+    for slot in regions.iter_mut() {
+        if slot.0 == base {
+            *slot = (0, 0);
+        }
+    }
+}
@@ -44,6 +44,7 @@
 //! swapon /dev/sda2
 //! ```
 
+use crate::scheduler::psi::{self, PsiResource};
 use crate::{kerror, kinfo, kwarn};
 use core::sync::atomic::{AtomicBool, AtomicPtr, Ordering};
 use spin::Mutex;
@@ -242,7 +243,9 @@ pub fn swap_out(page_data: *const u8) -> Result<SwapEntry, i32> {
         }
 
         // Write the page to swap
-        let result = ((*ops).write_page)(device, offset, page_data);
+        let result = psi::stall(PsiResource::Memory, || {
+            ((*ops).write_page)(device, offset, page_data)
+        });
         if result != 0 {
             // Free the slot on write failure
             let _ = ((*ops).free_slot)(device, offset);
@@ -282,7 +285,9 @@ pub fn swap_in(entry: SwapEntry, page_data: *mut u8) -> Result<(), i32> {
 
     unsafe {
         // Read the page from swap
-        let result = ((*ops).read_page)(device, offset, page_data);
+        let result = psi::stall(PsiResource::Memory, || {
+            ((*ops).read_page)(device, offset, page_data)
+        });
         if result != 0 {
             return Err(result);
         }
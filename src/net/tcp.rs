@@ -1512,9 +1512,10 @@ impl TcpSocket {
         Ok(())
     }
 
-    /// Generate initial sequence number
+    /// Generate initial sequence number (RFC 6528: a 4 us clock plus a
+    /// random offset, so sequence numbers cannot be predicted)
     fn generate_isn(&self) -> u32 {
-        (logger::boot_time_us() as u32) ^ 0x13579BDF
+        ((logger::boot_time_us() / 4) as u32).wrapping_add(crate::drivers::get_random_u32())
     }
 
     /// Get current time in milliseconds
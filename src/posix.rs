@@ -25,6 +25,7 @@ pub mod errno {
     pub const ENOTDIR: i32 = 20; // Not a directory
     pub const EISDIR: i32 = 21; // Is a directory
     pub const EINVAL: i32 = 22; // Invalid argument
+    pub const ENFILE: i32 = 23; // Too many open files in system
     pub const EMFILE: i32 = 24; // Too many open files
     pub const ENOTTY: i32 = 25; // Inappropriate ioctl for device
     pub const ENOSPC: i32 = 28; // No space left on device
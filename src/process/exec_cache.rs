@@ -0,0 +1,151 @@
+//! Exec-time caches and statistics
+//!
+//! Every dynamically linked execve() used to re-parse the interpreter
+//! (`ld-nrlib`) and copy each of its PT_LOAD segments into the new image.
+//! The interpreter is always loaded at the fixed `INTERP_BASE` and the kernel
+//! does not relocate it, so the laid-out image is byte-for-byte identical for
+//! every process. This module keeps that image (and its adjusted `LoadResult`)
+//! so later execs install it with a single copy.
+//!
+//! It also records execve() latency in TSC cycles for benchmarking.
+
+use alloc::string::String;
+use alloc::vec::Vec;
+use core::sync::atomic::{AtomicU64, Ordering};
+use spin::Mutex;
+
+use crate::elf::LoadResult;
+
+/// Largest interpreter image worth caching (ld-nrlib is well below this)
+const MAX_CACHED_INTERP_SIZE: u64 = 4 * 1024 * 1024;
+
+/// A fully laid-out interpreter image, ready to be copied to `INTERP_BASE`
+struct CachedInterp {
+    /// Interpreter path from PT_INTERP
+    path: String,
+    /// Identity of the file bytes the image was built from. Unchanged files
+    /// are served from the same buffer by `fs::read_file_bytes()`.
+    source_ptr: usize,
+    source_len: usize,
+    /// Segment image from the first PT_LOAD vaddr, bss included
+    image: Vec<u8>,
+    /// Load result already adjusted to `INTERP_BASE`
+    load: LoadResult,
+}
+
+static INTERP_CACHE: Mutex<Option<CachedInterp>> = Mutex::new(None);
+
+// Exec statistics
+static EXEC_COUNT: AtomicU64 = AtomicU64::new(0);
+static EXEC_CYCLES_TOTAL: AtomicU64 = AtomicU64::new(0);
+static EXEC_CYCLES_MIN: AtomicU64 = AtomicU64::new(u64::MAX);
+static EXEC_CYCLES_MAX: AtomicU64 = AtomicU64::new(0);
+static INTERP_CACHE_HITS: AtomicU64 = AtomicU64::new(0);
+static INTERP_CACHE_MISSES: AtomicU64 = AtomicU64::new(0);
+
+/// Copy a cached interpreter image to `region_base + offset` if one matches
+/// `path`/`source`.
+///
+/// Returns the cached load result on a hit. The destination pages are taken
+/// out of lazy zeroing first, so a later fault cannot wipe the copied image.
+pub fn install_cached_interp(
+    path: &str,
+    source: &[u8],
+    region_base: u64,
+    offset: u64,
+) -> Option<LoadResult> {
+    let cache = INTERP_CACHE.lock();
+    let entry = match cache.as_ref() {
+        Some(entry)
+            if entry.path == path
+                && entry.source_ptr == source.as_ptr() as usize
+                && entry.source_len == source.len() =>
+        {
+            entry
+        }
+        _ => {
+            INTERP_CACHE_MISSES.fetch_add(1, Ordering::Relaxed);
+            return None;
+        }
+    };
+
+    crate::mm::zero_user_range_now(region_base, offset, entry.image.len() as u64);
+    unsafe {
+        core::ptr::copy_nonoverlapping(
+            entry.image.as_ptr(),
+            (region_base + offset) as *mut u8,
+            entry.image.len(),
+        );
+    }
+    INTERP_CACHE_HITS.fetch_add(1, Ordering::Relaxed);
+    Some(entry.load)
+}
+
+/// Remember a freshly loaded interpreter image located at `src` (`span` bytes).
+pub fn cache_interp(path: &str, source: &[u8], src: u64, span: u64, load: LoadResult) {
+    if span == 0 || span > MAX_CACHED_INTERP_SIZE {
+        return;
+    }
+
+    let mut image = Vec::new();
+    if image.try_reserve_exact(span as usize).is_err() {
+        crate::kwarn!("exec_cache: cannot allocate {} bytes for '{}'", span, path);
+        return;
+    }
+    unsafe {
+        let bytes = core::slice::from_raw_parts(src as *const u8, span as usize);
+        image.extend_from_slice(bytes);
+    }
+
+    *INTERP_CACHE.lock() = Some(CachedInterp {
+        path: String::from(path),
+        source_ptr: source.as_ptr() as usize,
+        source_len: source.len(),
+        image,
+        load,
+    });
+    crate::kdebug!("exec_cache: cached interpreter '{}' ({} bytes)", path, span);
+}
+
+/// Record the latency of one successful execve() image load.
+pub fn record_exec_latency(cycles: u64) {
+    EXEC_COUNT.fetch_add(1, Ordering::Relaxed);
+    EXEC_CYCLES_TOTAL.fetch_add(cycles, Ordering::Relaxed);
+    EXEC_CYCLES_MIN.fetch_min(cycles, Ordering::Relaxed);
+    EXEC_CYCLES_MAX.fetch_max(cycles, Ordering::Relaxed);
+}
+
+/// Exec statistics snapshot: (count, total_cycles, min_cycles, max_cycles, interp_hits, interp_misses)
+pub fn exec_stats() -> (u64, u64, u64, u64, u64, u64) {
+    let count = EXEC_COUNT.load(Ordering::Relaxed);
+    let min = if count == 0 {
+        0
+    } else {
+        EXEC_CYCLES_MIN.load(Ordering::Relaxed)
+    };
+    (
+        count,
+        EXEC_CYCLES_TOTAL.load(Ordering::Relaxed),
+        min,
+        EXEC_CYCLES_MAX.load(Ordering::Relaxed),
+        INTERP_CACHE_HITS.load(Ordering::Relaxed),
+        INTERP_CACHE_MISSES.load(Ordering::Relaxed),
+    )
+}
+
+/// Print exec latency and cache statistics
+pub fn print_exec_statistics() {
+    let (count, total, min, max, hits, misses) = exec_stats();
+    let avg = if count == 0 { 0 } else { total / count };
+
+    crate::kinfo!("=== Exec Statistics ===");
+    crate::kinfo!("  execve() image loads: {}", count);
+    crate::kinfo!(
+        "  Latency (TSC cycles): avg {}, min {}, max {}",
+        avg,
+        min,
+        max
+    );
+    crate::kinfo!("  Interpreter cache: {} hits, {} misses", hits, misses);
+    crate::kinfo!("=== End Exec Statistics ===");
+}
@@ -9,6 +9,7 @@ use core::ptr;
 use crate::elf::ElfLoader;
 use crate::{kdebug, kerror, ktrace, kwarn};
 
+use super::exec_cache;
 use super::pid_tree::allocate_pid;
 use super::stack::build_initial_stack;
 use super::types::{
@@ -55,23 +56,11 @@ impl Process {
             return Err("Invalid ELF magic");
         }
 
-        // Clear existing memory before loading new ELF (POSIX requirement)
-        ktrace!(
-            "Clearing process memory at base={:#x}, size={:#x}",
-            phys_base,
-            USER_REGION_SIZE
-        );
+        let exec_start = crate::safety::rdtsc();
 
-        // Check current CR3 before clearing memory
-        let current_cr3 = {
-            use x86_64::registers::control::Cr3;
-            let (frame, _) = Cr3::read();
-            frame.start_address().as_u64()
-        };
-        ktrace!(
-            "[from_elf_with_args_at_base] About to clear memory, current_CR3={:#x}, target_CR3={:#x}",
-            current_cr3, existing_cr3
-        );
+        // Parse before touching the old image so a bad binary leaves it intact
+        let loader = ElfLoader::new(elf_data)?;
+        let image_span = loader.image_span()?;
 
         // CRITICAL: Check if we're about to overwrite any active page tables
         // Page tables are allocated starting from 0x08000000
@@ -102,16 +91,25 @@ impl Process {
             crate::mm::clear_user_mappings(existing_cr3);
         }
 
-        unsafe {
-            ptr::write_bytes(phys_base as *mut u8, 0, USER_REGION_SIZE as usize);
-        }
+        // The old image must not leak into the new one (POSIX requirement), but
+        // clearing all USER_REGION_SIZE bytes up front is most of the exec cost.
+        // Pages are instead zeroed on first fault; only the pages the loader is
+        // about to write through physical addresses are cleared here.
+        ktrace!(
+            "Deferring clear of process memory at base={:#x}, size={:#x}",
+            phys_base,
+            USER_REGION_SIZE
+        );
+        crate::mm::defer_user_region_zeroing(phys_base, USER_REGION_SIZE);
+        crate::mm::zero_user_range_now(phys_base, 0, image_span);
+        crate::mm::zero_user_range_now(phys_base, STACK_BASE - USER_VIRT_BASE, STACK_SIZE);
 
         // CRITICAL: Flush TLB after clearing memory to ensure CPU sees the new state
         // This is necessary because the old process may have had pages mapped
-        // at these virtual addresses, and the TLB may cache stale translations
-        crate::safety::flush_tlb_all();
-
-        let loader = ElfLoader::new(elf_data)?;
+        // at these virtual addresses, and the TLB may cache stale translations.
+        // Wait for every CPU: the loader is about to reuse the old frames, and
+        // a CPU still holding an old translation could write into them.
+        crate::safety::flush_tlb_all_sync();
 
         // CRITICAL: ElfLoader writes to physical memory but returns virtual addresses
         // We need to adjust: write to phys_base but calculate addresses from USER_VIRT_BASE
@@ -188,23 +186,47 @@ impl Process {
             kdebug!("Dynamic executable, interpreter: {}", interp_path);
 
             if let Some(interp_data) = crate::fs::read_file_bytes(interp_path) {
-                let interp_loader = ElfLoader::new(interp_data)?;
-
                 // Calculate physical address for interpreter region
                 // INTERP_BASE is virtual, need to map to physical
                 let interp_offset = INTERP_BASE - USER_VIRT_BASE;
                 let interp_phys = phys_base + interp_offset;
 
-                let mut interp_image = interp_loader.load(interp_phys)?;
-
-                // Adjust interpreter addresses to virtual space
-                let interp_adjustment = INTERP_BASE as i64 - interp_phys as i64;
-                interp_image.entry_point =
-                    ((interp_image.entry_point as i64) + interp_adjustment) as u64;
-                interp_image.phdr_vaddr =
-                    ((interp_image.phdr_vaddr as i64) + interp_adjustment) as u64;
-                interp_image.base_addr = INTERP_BASE;
-                interp_image.load_bias = INTERP_BASE as i64 - interp_image.first_load_vaddr as i64;
+                // Reuse the laid-out interpreter from a previous exec when the
+                // file is unchanged; otherwise parse and load it, then cache it
+                let interp_image = if let Some(cached) = exec_cache::install_cached_interp(
+                    interp_path,
+                    interp_data,
+                    phys_base,
+                    interp_offset,
+                ) {
+                    ktrace!("Interpreter '{}' installed from exec cache", interp_path);
+                    cached
+                } else {
+                    let interp_loader = ElfLoader::new(interp_data)?;
+                    let interp_span = interp_loader.image_span()?;
+                    crate::mm::zero_user_range_now(phys_base, interp_offset, interp_span);
+
+                    let mut interp_image = interp_loader.load(interp_phys)?;
+
+                    // Adjust interpreter addresses to virtual space
+                    let interp_adjustment = INTERP_BASE as i64 - interp_phys as i64;
+                    interp_image.entry_point =
+                        ((interp_image.entry_point as i64) + interp_adjustment) as u64;
+                    interp_image.phdr_vaddr =
+                        ((interp_image.phdr_vaddr as i64) + interp_adjustment) as u64;
+                    interp_image.base_addr = INTERP_BASE;
+                    interp_image.load_bias =
+                        INTERP_BASE as i64 - interp_image.first_load_vaddr as i64;
+
+                    exec_cache::cache_interp(
+                        interp_path,
+                        interp_data,
+                        interp_phys,
+                        interp_span,
+                        interp_image,
+                    );
+                    interp_image
+                };
 
                 kdebug!(
                     "Interpreter loaded and adjusted: entry={:#x}, base={:#x}",
@@ -260,6 +282,8 @@ impl Process {
             (program_image.entry_point, stack)
         };
 
+        exec_cache::record_exec_latency(crate::safety::rdtsc().wrapping_sub(exec_start));
+
         let pid = allocate_pid();
         let mut context = Context::zero();
         context.rip = entry_point;
@@ -8,6 +8,7 @@
 //! - `types`: Type definitions (Pid, ProcessState, Context, Process) and constants
 //! - `stack`: User stack building utilities
 //! - `loader`: ELF loading for process creation
+//! - `exec_cache`: Cached interpreter image and execve() latency statistics
 //! - `execution`: Process execution and user-mode transition
 //! - `pid_tree`: Radix tree based PID management with O(log N) operations
 //! - `coredump`: Core dump generation for crashed processes
@@ -15,6 +16,7 @@
 extern crate alloc;
 
 pub mod coredump;
+pub mod exec_cache;
 mod execution;
 mod loader;
 pub mod pid_tree;
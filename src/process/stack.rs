@@ -10,8 +10,8 @@ use crate::kinfo;
 
 use super::types::MAX_PROCESS_ARGS;
 
-/// Random seed placed at the top of the stack for AT_RANDOM
-const STACK_RANDOM_SEED: [u8; 16] = *b"NexaOSGuardSeed!";
+/// Size of the AT_RANDOM block (stack protector / pointer guard seed)
+const AT_RANDOM_BYTES: usize = 16;
 
 // ELF auxiliary vector types
 const AT_NULL: u64 = 0;
@@ -183,7 +183,9 @@ pub fn build_initial_stack(
     }
 
     // Push random bytes for AT_RANDOM
-    let random_ptr = builder.push_bytes(&STACK_RANDOM_SEED)?;
+    let mut random_bytes = [0u8; AT_RANDOM_BYTES];
+    crate::drivers::get_random_bytes(&mut random_bytes);
+    let random_ptr = builder.push_bytes(&random_bytes)?;
 
     // Push exec filename string if provided
     let execfn_ptr = if exec_path.is_empty() {
@@ -60,6 +60,24 @@ pub fn flush_tlb_all() {
     crate::smp::send_tlb_flush_ipi_all();
 }
 
+/// Reload CR3 on the current CPU
+fn reload_cr3(_: usize) {
+    let (frame, flags) = Cr3::read();
+    unsafe {
+        Cr3::write(frame, flags);
+    }
+}
+
+/// Flush the TLB on every CPU and wait until all of them are done.
+///
+/// Unlike `flush_tlb_all()`, which only fires the flush IPI, this returns
+/// once no CPU can still hold a stale translation, so the caller may reuse
+/// the unmapped frames right away.
+pub fn flush_tlb_all_sync() {
+    reload_cr3(0);
+    crate::smp::smp_call_function(reload_cr3, 0, true);
+}
+
 /// Invalidate a single TLB entry.
 #[inline]
 pub fn invlpg(addr: u64) {
@@ -0,0 +1,1031 @@
+//! Control groups (cgroup v2 style)
+//!
+//! Groups form a hierarchy rooted at group 0. Every process belongs to one
+//! group (`ProcessEntry::cgroup`) and children start in their parent's
+//! group. As in cgroup v2, only leaf groups hold processes; the root is the
+//! exception.
+//!
+//! Controllers:
+//! - **cpu.weight**: each group is a scheduling entity in its parent with
+//!   its own vruntime, advanced by `runtime * 100 / weight`. The pick walks
+//!   down from the root taking the runnable entity with the lowest vruntime,
+//!   then runs EEVDF among the tasks of the chosen group. Tasks attached
+//!   directly to a group compete inside it as one entity of default weight.
+//! - **cpu.max**: quota/period bandwidth. A group that used its quota is
+//!   throttled, with its whole subtree, until its period rolls over.
+//! - **memory.max / memory.high**: mmap and brk growth is charged to the
+//!   group and its ancestors, held by the thread-group leader since threads
+//!   share their address space. There is no reclaim to fall back on, so a
+//!   charge beyond max fails with ENOMEM and a charge beyond high succeeds
+//!   but makes the task yield as a memory stall.
+//! - **io.weight**: block I/O is synchronous and unqueued, so the weight is
+//!   recorded and io.stat accounts bytes and operations per group.
+//!
+//! Names and topology changes go through `CGROUP_TREE`. Everything the tick
+//! and pick paths touch is atomics in `GROUPS`, so those paths take no lock
+//! besides the process table they already hold.
+
+use core::fmt::{self, Write};
+use core::sync::atomic::{AtomicBool, AtomicU16, AtomicU32, AtomicU64, AtomicUsize, Ordering};
+use spin::Mutex;
+
+use crate::acpi::MAX_CPUS;
+use crate::posix::errno;
+use crate::process::{Pid, ProcessState, MAX_PROCESSES};
+
+use super::table::PROCESS_TABLE;
+use super::types::{ProcessEntry, SchedPolicy, BASE_SLICE_NS};
+
+/// Group index (`ProcessEntry::cgroup`)
+pub type CgroupId = u16;
+
+/// Maximum number of groups, including the root
+pub const MAX_CGROUPS: usize = 64;
+/// The root group
+pub const ROOT_CGROUP: CgroupId = 0;
+/// Maximum path length, without the leading '/'
+pub const CGROUP_PATH_MAX: usize = 63;
+/// Maximum nesting below the root
+pub const CGROUP_MAX_DEPTH: usize = 8;
+
+/// cpu.weight / io.weight range and default
+pub const CGROUP_WEIGHT_MIN: u32 = 1;
+pub const CGROUP_WEIGHT_DFL: u32 = 100;
+pub const CGROUP_WEIGHT_MAX: u32 = 10_000;
+
+/// cpu.max period range and default (us)
+pub const CPU_PERIOD_MIN_US: u64 = 1_000;
+pub const CPU_PERIOD_DFL_US: u64 = 100_000;
+pub const CPU_PERIOD_MAX_US: u64 = 1_000_000;
+
+/// "max": no quota / no memory limit
+pub const CGROUP_UNLIMITED: u64 = u64::MAX;
+
+/// How far behind its siblings an idle group may fall before it is placed
+/// back at the front; bounds the burst a long-idle group gets on wakeup
+const PLACEMENT_SLACK_NS: u64 = BASE_SLICE_NS;
+
+/// Control operation errors
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum CgroupError {
+    /// No such group or process
+    NotFound,
+    /// A group with that path exists
+    Exists,
+    /// Group has children or processes
+    Busy,
+    /// Bad path or value
+    Invalid,
+    /// Group table or depth limit reached
+    NoSpace,
+    /// Charge would exceed memory.max
+    OverLimit,
+}
+
+impl CgroupError {
+    pub const fn errno(self) -> i32 {
+        match self {
+            CgroupError::NotFound => errno::ENOENT,
+            CgroupError::Exists => errno::EEXIST,
+            CgroupError::Busy => errno::EBUSY,
+            CgroupError::Invalid => errno::EINVAL,
+            CgroupError::NoSpace => errno::ENOSPC,
+            CgroupError::OverLimit => errno::ENOMEM,
+        }
+    }
+}
+
+/// Snapshot of a group's knobs and counters
+#[repr(C)]
+#[derive(Clone, Copy, Debug, Default)]
+pub struct CgroupStat {
+    pub parent: u64,
+    pub nr_procs: u64,
+    pub cpu_weight: u64,
+    pub cpu_quota_us: u64,
+    pub cpu_period_us: u64,
+    pub usage_us: u64,
+    pub nr_periods: u64,
+    pub nr_throttled: u64,
+    pub throttled_us: u64,
+    pub memory_current: u64,
+    pub memory_high: u64,
+    pub memory_max: u64,
+    pub memory_events_high: u64,
+    pub memory_events_max: u64,
+    pub io_weight: u64,
+    pub io_rbytes: u64,
+    pub io_wbytes: u64,
+    pub io_rios: u64,
+    pub io_wios: u64,
+}
+
+/// Per-group hot state
+struct CgroupState {
+    active: AtomicBool,
+    parent: AtomicU16,
+
+    // cpu
+    weight: AtomicU32,
+    /// This group's vruntime as an entity of its parent
+    vruntime: AtomicU64,
+    /// vruntime of the tasks attached directly to this group, as one entity
+    local_vruntime: AtomicU64,
+    /// Front of the entities competing inside this group
+    min_vruntime: AtomicU64,
+    usage_ns: AtomicU64,
+
+    // cpu.max
+    quota_us: AtomicU64,
+    period_us: AtomicU64,
+    period_start_us: AtomicU64,
+    period_runtime_ns: AtomicU64,
+    throttled: AtomicBool,
+    throttled_at_us: AtomicU64,
+    nr_periods: AtomicU64,
+    nr_throttled: AtomicU64,
+    throttled_us: AtomicU64,
+
+    // memory
+    mem_current: AtomicU64,
+    mem_high: AtomicU64,
+    mem_max: AtomicU64,
+    mem_events_high: AtomicU64,
+    mem_events_max: AtomicU64,
+
+    // io
+    io_weight: AtomicU32,
+    io_rbytes: AtomicU64,
+    io_wbytes: AtomicU64,
+    io_rios: AtomicU64,
+    io_wios: AtomicU64,
+}
+
+impl CgroupState {
+    const fn new() -> Self {
+        Self {
+            active: AtomicBool::new(false),
+            parent: AtomicU16::new(ROOT_CGROUP),
+            weight: AtomicU32::new(CGROUP_WEIGHT_DFL),
+            vruntime: AtomicU64::new(0),
+            local_vruntime: AtomicU64::new(0),
+            min_vruntime: AtomicU64::new(0),
+            usage_ns: AtomicU64::new(0),
+            quota_us: AtomicU64::new(CGROUP_UNLIMITED),
+            period_us: AtomicU64::new(CPU_PERIOD_DFL_US),
+            period_start_us: AtomicU64::new(0),
+            period_runtime_ns: AtomicU64::new(0),
+            throttled: AtomicBool::new(false),
+            throttled_at_us: AtomicU64::new(0),
+            nr_periods: AtomicU64::new(0),
+            nr_throttled: AtomicU64::new(0),
+            throttled_us: AtomicU64::new(0),
+            mem_current: AtomicU64::new(0),
+            mem_high: AtomicU64::new(CGROUP_UNLIMITED),
+            mem_max: AtomicU64::new(CGROUP_UNLIMITED),
+            mem_events_high: AtomicU64::new(0),
+            mem_events_max: AtomicU64::new(0),
+            io_weight: AtomicU32::new(CGROUP_WEIGHT_DFL),
+            io_rbytes: AtomicU64::new(0),
+            io_wbytes: AtomicU64::new(0),
+            io_rios: AtomicU64::new(0),
+            io_wios: AtomicU64::new(0),
+        }
+    }
+
+    /// Reset for a new group under `parent`, placed at its siblings' front
+    fn init(&self, parent: CgroupId) {
+        let front = GROUPS[parent as usize].min_vruntime.load(Ordering::Relaxed);
+        for counter in [
+            &self.local_vruntime,
+            &self.min_vruntime,
+            &self.usage_ns,
+            &self.period_start_us,
+            &self.period_runtime_ns,
+            &self.throttled_at_us,
+            &self.nr_periods,
+            &self.nr_throttled,
+            &self.throttled_us,
+            &self.mem_current,
+            &self.mem_events_high,
+            &self.mem_events_max,
+            &self.io_rbytes,
+            &self.io_wbytes,
+            &self.io_rios,
+            &self.io_wios,
+        ] {
+            counter.store(0, Ordering::Relaxed);
+        }
+        self.vruntime.store(front, Ordering::Relaxed);
+        self.weight.store(CGROUP_WEIGHT_DFL, Ordering::Relaxed);
+        self.quota_us.store(CGROUP_UNLIMITED, Ordering::Relaxed);
+        self.period_us.store(CPU_PERIOD_DFL_US, Ordering::Relaxed);
+        self.throttled.store(false, Ordering::Relaxed);
+        self.mem_high.store(CGROUP_UNLIMITED, Ordering::Relaxed);
+        self.mem_max.store(CGROUP_UNLIMITED, Ordering::Relaxed);
+        self.io_weight.store(CGROUP_WEIGHT_DFL, Ordering::Relaxed);
+        self.parent.store(parent, Ordering::Relaxed);
+        self.active.store(true, Ordering::Release);
+    }
+
+    /// Start a new bandwidth period if the current one is over
+    fn refresh_period(&self, now_us: u64) {
+        if self.quota_us.load(Ordering::Relaxed) == CGROUP_UNLIMITED {
+            self.unthrottle(now_us);
+            return;
+        }
+        let period = self.period_us.load(Ordering::Relaxed).max(1);
+        let start = self.period_start_us.load(Ordering::Relaxed);
+        if now_us < start.saturating_add(period) {
+            return;
+        }
+        let elapsed = (now_us - start) / period;
+        self.period_start_us
+            .store(start + elapsed * period, Ordering::Relaxed);
+        self.period_runtime_ns.store(0, Ordering::Relaxed);
+        self.nr_periods.fetch_add(elapsed, Ordering::Relaxed);
+        self.unthrottle(now_us);
+    }
+
+    fn unthrottle(&self, now_us: u64) {
+        if self.throttled.swap(false, Ordering::Relaxed) {
+            let since = self.throttled_at_us.load(Ordering::Relaxed);
+            self.throttled_us
+                .fetch_add(now_us.saturating_sub(since), Ordering::Relaxed);
+        }
+    }
+
+    /// Charge runtime against the quota; true if the group is throttled
+    fn consume_quota(&self, delta_ns: u64, now_us: u64) -> bool {
+        self.refresh_period(now_us);
+        let quota = self.quota_us.load(Ordering::Relaxed);
+        if quota == CGROUP_UNLIMITED {
+            return false;
+        }
+        let used = self
+            .period_runtime_ns
+            .fetch_add(delta_ns, Ordering::Relaxed)
+            .saturating_add(delta_ns);
+        if used < quota.saturating_mul(1000) {
+            return false;
+        }
+        if !self.throttled.swap(true, Ordering::Relaxed) {
+            self.throttled_at_us.store(now_us, Ordering::Relaxed);
+            self.nr_throttled.fetch_add(1, Ordering::Relaxed);
+        }
+        true
+    }
+}
+
+/// Path of each group, without the leading '/' (root is empty)
+#[derive(Clone, Copy)]
+struct CgroupPath {
+    buf: [u8; CGROUP_PATH_MAX],
+    len: usize,
+}
+
+impl CgroupPath {
+    const fn empty() -> Self {
+        Self {
+            buf: [0; CGROUP_PATH_MAX],
+            len: 0,
+        }
+    }
+
+    fn as_str(&self) -> &str {
+        core::str::from_utf8(&self.buf[..self.len]).unwrap_or("")
+    }
+}
+
+static GROUPS: [CgroupState; MAX_CGROUPS] = [const { CgroupState::new() }; MAX_CGROUPS];
+static CGROUP_TREE: Mutex<[CgroupPath; MAX_CGROUPS]> =
+    Mutex::new([CgroupPath::empty(); MAX_CGROUPS]);
+
+/// Number of groups besides the root; 0 keeps the pick path flat
+static NR_CGROUPS: AtomicUsize = AtomicUsize::new(0);
+
+/// Group of the task running on each CPU, for the block layer
+static CPU_CGROUP: [AtomicU16; MAX_CPUS] = [const { AtomicU16::new(ROOT_CGROUP) }; MAX_CPUS];
+
+#[inline]
+fn group(id: CgroupId) -> &'static CgroupState {
+    &GROUPS[id as usize % MAX_CGROUPS]
+}
+
+#[inline]
+fn is_active(id: CgroupId) -> bool {
+    id == ROOT_CGROUP || ((id as usize) < MAX_CGROUPS && group(id).active.load(Ordering::Acquire))
+}
+
+#[inline]
+fn parent_of(id: CgroupId) -> CgroupId {
+    group(id).parent.load(Ordering::Relaxed)
+}
+
+/// Normalize a user path ("/a/b/", "a/b") to "a/b"
+fn normalize(path: &str) -> Result<&str, CgroupError> {
+    let path = path.trim_matches('/');
+    if path.len() > CGROUP_PATH_MAX {
+        return Err(CgroupError::Invalid);
+    }
+    if path.is_empty() {
+        return Ok(path);
+    }
+    for name in path.split('/') {
+        let valid = !name.is_empty()
+            && name != "."
+            && name != ".."
+            && name
+                .bytes()
+                .all(|b| b.is_ascii_alphanumeric() || matches!(b, b'-' | b'_' | b'.' | b'@'));
+        if !valid {
+            return Err(CgroupError::Invalid);
+        }
+    }
+    Ok(path)
+}
+
+fn find_path(tree: &[CgroupPath; MAX_CGROUPS], path: &str) -> Option<CgroupId> {
+    if path.is_empty() {
+        return Some(ROOT_CGROUP);
+    }
+    (1..MAX_CGROUPS)
+        .find(|&id| is_active(id as CgroupId) && tree[id].as_str() == path)
+        .map(|id| id as CgroupId)
+}
+
+fn has_children(id: CgroupId) -> bool {
+    (1..MAX_CGROUPS as CgroupId).any(|child| is_active(child) && parent_of(child) == id)
+}
+
+fn count_procs(table: &[Option<ProcessEntry>; MAX_PROCESSES], id: CgroupId) -> usize {
+    table
+        .iter()
+        .flatten()
+        .filter(|entry| entry.cgroup == id)
+        .count()
+}
+
+// =============================================================================
+// Hierarchy control
+// =============================================================================
+
+/// Look up a group by path ("" or "/" is the root)
+pub fn lookup(path: &str) -> Result<CgroupId, CgroupError> {
+    let path = normalize(path)?;
+    find_path(&CGROUP_TREE.lock(), path).ok_or(CgroupError::NotFound)
+}
+
+/// Create a group; its parent must exist and hold no processes
+pub fn create(path: &str) -> Result<CgroupId, CgroupError> {
+    let path = normalize(path)?;
+    if path.is_empty() {
+        return Err(CgroupError::Exists);
+    }
+    let (parent_path, _) = path.rsplit_once('/').unwrap_or(("", path));
+    if path.split('/').count() > CGROUP_MAX_DEPTH {
+        return Err(CgroupError::NoSpace);
+    }
+
+    let table = PROCESS_TABLE.lock();
+    let mut tree = CGROUP_TREE.lock();
+    if find_path(&tree, path).is_some() {
+        return Err(CgroupError::Exists);
+    }
+    let parent = find_path(&tree, parent_path).ok_or(CgroupError::NotFound)?;
+    // No internal processes: only the root may hold both
+    if parent != ROOT_CGROUP && count_procs(&table, parent) > 0 {
+        return Err(CgroupError::Busy);
+    }
+    let id = (1..MAX_CGROUPS)
+        .find(|&id| !is_active(id as CgroupId))
+        .ok_or(CgroupError::NoSpace)?;
+
+    let slot = &mut tree[id];
+    slot.buf[..path.len()].copy_from_slice(path.as_bytes());
+    slot.len = path.len();
+    GROUPS[id].init(parent);
+    NR_CGROUPS.fetch_add(1, Ordering::Relaxed);
+
+    crate::kinfo!("cgroup: created /{} (id {})", path, id);
+    Ok(id as CgroupId)
+}
+
+/// Remove an empty leaf group
+pub fn destroy(id: CgroupId) -> Result<(), CgroupError> {
+    if id == ROOT_CGROUP {
+        return Err(CgroupError::Busy);
+    }
+    let table = PROCESS_TABLE.lock();
+    let _tree = CGROUP_TREE.lock();
+    if !is_active(id) {
+        return Err(CgroupError::NotFound);
+    }
+    if has_children(id) || count_procs(&table, id) > 0 {
+        return Err(CgroupError::Busy);
+    }
+    group(id).active.store(false, Ordering::Release);
+    NR_CGROUPS.fetch_sub(1, Ordering::Relaxed);
+    Ok(())
+}
+
+/// Move `pid` and the rest of its thread group to `id`, memory charge included
+pub fn attach(pid: Pid, id: CgroupId) -> Result<(), CgroupError> {
+    let mut table = PROCESS_TABLE.lock();
+    let _tree = CGROUP_TREE.lock();
+    if !is_active(id) {
+        return Err(CgroupError::NotFound);
+    }
+    if id != ROOT_CGROUP && has_children(id) {
+        return Err(CgroupError::Busy);
+    }
+    let tgid = table
+        .iter()
+        .flatten()
+        .find(|entry| entry.process.pid == pid)
+        .map(|entry| entry.process.tgid)
+        .ok_or(CgroupError::NotFound)?;
+
+    let current = super::current_pid();
+    for entry in table.iter_mut().flatten() {
+        if entry.process.tgid != tgid || entry.cgroup == id {
+            continue;
+        }
+        uncharge_memory(entry.cgroup, entry.mem_charged);
+        force_charge_memory(id, entry.mem_charged);
+        entry.cgroup = id;
+        if Some(entry.process.pid) == current {
+            set_cpu_cgroup(id);
+        }
+    }
+    Ok(())
+}
+
+/// Group of `pid`
+pub fn cgroup_of(pid: Pid) -> Option<CgroupId> {
+    let table = PROCESS_TABLE.lock();
+    let idx = crate::process::lookup_pid(pid)? as usize;
+    match table.get(idx)? {
+        Some(entry) if entry.process.pid == pid => Some(entry.cgroup),
+        _ => None,
+    }
+}
+
+/// Group a new process starts in: its parent's (its thread group's for threads)
+pub(super) fn inherited(table: &[Option<ProcessEntry>; MAX_PROCESSES], parent: Pid) -> CgroupId {
+    table
+        .iter()
+        .flatten()
+        .find(|entry| entry.process.pid == parent)
+        .map(|entry| entry.cgroup)
+        .filter(|&id| is_active(id))
+        .unwrap_or(ROOT_CGROUP)
+}
+
+/// Write the group's path ("/" for the root)
+pub fn write_path(id: CgroupId, w: &mut dyn Write) -> fmt::Result {
+    let tree = CGROUP_TREE.lock();
+    if !is_active(id) {
+        return Err(fmt::Error);
+    }
+    write!(w, "/{}", tree[id as usize].as_str())
+}
+
+/// Call `f` with each group's id and path
+pub fn for_each(mut f: impl FnMut(CgroupId, &str)) {
+    let tree = *CGROUP_TREE.lock();
+    for (id, path) in tree.iter().enumerate() {
+        if is_active(id as CgroupId) {
+            f(id as CgroupId, path.as_str());
+        }
+    }
+}
+
+/// Pids of the processes in a group
+pub fn for_each_proc(id: CgroupId, mut f: impl FnMut(Pid)) {
+    let table = PROCESS_TABLE.lock();
+    for entry in table.iter().flatten() {
+        if entry.cgroup == id && !entry.process.is_thread {
+            f(entry.process.pid);
+        }
+    }
+}
+
+// =============================================================================
+// Knobs
+// =============================================================================
+
+fn knob_group(id: CgroupId) -> Result<&'static CgroupState, CgroupError> {
+    // The root has no parent to share with, so it has no limits either
+    if id == ROOT_CGROUP {
+        return Err(CgroupError::Invalid);
+    }
+    if !is_active(id) {
+        return Err(CgroupError::NotFound);
+    }
+    Ok(group(id))
+}
+
+fn check_weight(weight: u64) -> Result<u32, CgroupError> {
+    if (CGROUP_WEIGHT_MIN as u64..=CGROUP_WEIGHT_MAX as u64).contains(&weight) {
+        Ok(weight as u32)
+    } else {
+        Err(CgroupError::Invalid)
+    }
+}
+
+/// cpu.weight
+pub fn set_cpu_weight(id: CgroupId, weight: u64) -> Result<(), CgroupError> {
+    let weight = check_weight(weight)?;
+    knob_group(id)?.weight.store(weight, Ordering::Relaxed);
+    Ok(())
+}
+
+/// cpu.max quota (us per period, `CGROUP_UNLIMITED` for max)
+pub fn set_cpu_quota(id: CgroupId, quota_us: u64) -> Result<(), CgroupError> {
+    let state = knob_group(id)?;
+    if quota_us < CPU_PERIOD_MIN_US {
+        return Err(CgroupError::Invalid);
+    }
+    state.quota_us.store(quota_us, Ordering::Relaxed);
+    Ok(())
+}
+
+/// cpu.max period (us)
+pub fn set_cpu_period(id: CgroupId, period_us: u64) -> Result<(), CgroupError> {
+    let state = knob_group(id)?;
+    if !(CPU_PERIOD_MIN_US..=CPU_PERIOD_MAX_US).contains(&period_us) {
+        return Err(CgroupError::Invalid);
+    }
+    state.period_us.store(period_us, Ordering::Relaxed);
+    Ok(())
+}
+
+/// memory.max (bytes, `CGROUP_UNLIMITED` for max)
+pub fn set_memory_max(id: CgroupId, bytes: u64) -> Result<(), CgroupError> {
+    knob_group(id)?.mem_max.store(bytes, Ordering::Relaxed);
+    Ok(())
+}
+
+/// memory.high (bytes, `CGROUP_UNLIMITED` for max)
+pub fn set_memory_high(id: CgroupId, bytes: u64) -> Result<(), CgroupError> {
+    knob_group(id)?.mem_high.store(bytes, Ordering::Relaxed);
+    Ok(())
+}
+
+/// io.weight
+pub fn set_io_weight(id: CgroupId, weight: u64) -> Result<(), CgroupError> {
+    let weight = check_weight(weight)?;
+    knob_group(id)?.io_weight.store(weight, Ordering::Relaxed);
+    Ok(())
+}
+
+/// Knobs and counters of a group
+pub fn stat(id: CgroupId) -> Option<CgroupStat> {
+    if !is_active(id) {
+        return None;
+    }
+    let state = group(id);
+    let mut nr_procs = 0;
+    for_each_proc(id, |_| nr_procs += 1);
+    let load = |counter: &AtomicU64| counter.load(Ordering::Relaxed);
+    Some(CgroupStat {
+        parent: parent_of(id) as u64,
+        nr_procs,
+        cpu_weight: state.weight.load(Ordering::Relaxed) as u64,
+        cpu_quota_us: load(&state.quota_us),
+        cpu_period_us: load(&state.period_us),
+        usage_us: load(&state.usage_ns) / 1000,
+        nr_periods: load(&state.nr_periods),
+        nr_throttled: load(&state.nr_throttled),
+        throttled_us: load(&state.throttled_us),
+        memory_current: load(&state.mem_current),
+        memory_high: load(&state.mem_high),
+        memory_max: load(&state.mem_max),
+        memory_events_high: load(&state.mem_events_high),
+        memory_events_max: load(&state.mem_events_max),
+        io_weight: state.io_weight.load(Ordering::Relaxed) as u64,
+        io_rbytes: load(&state.io_rbytes),
+        io_wbytes: load(&state.io_wbytes),
+        io_rios: load(&state.io_rios),
+        io_wios: load(&state.io_wios),
+    })
+}
+
+// =============================================================================
+// CPU: group entities
+// =============================================================================
+
+/// Charge `delta_ns` of runtime by a task of `id` to the group entities
+/// up to the root. Returns true if a group on the way is now throttled.
+/// Called with the process table locked.
+pub fn charge_runtime(id: CgroupId, delta_ns: u64, now_us: u64) -> bool {
+    let id = if is_active(id) { id } else { ROOT_CGROUP };
+    group(id)
+        .local_vruntime
+        .fetch_add(delta_ns, Ordering::Relaxed);
+
+    let mut throttled = false;
+    let mut g = id;
+    for _ in 0..=CGROUP_MAX_DEPTH {
+        let state = group(g);
+        state.usage_ns.fetch_add(delta_ns, Ordering::Relaxed);
+        if g == ROOT_CGROUP {
+            break;
+        }
+        throttled |= state.consume_quota(delta_ns, now_us);
+        let weight = state.weight.load(Ordering::Relaxed).max(1) as u64;
+        state.vruntime.fetch_add(
+            delta_ns * CGROUP_WEIGHT_DFL as u64 / weight,
+            Ordering::Relaxed,
+        );
+        g = parent_of(g);
+    }
+    throttled
+}
+
+/// Bitmask of `id` and its ancestors, or None if any of them is throttled
+fn runnable_path(id: CgroupId, now_us: u64) -> Option<u64> {
+    let mut mask = 0u64;
+    let mut g = id;
+    for _ in 0..=CGROUP_MAX_DEPTH {
+        if !is_active(g) {
+            return None;
+        }
+        mask |= 1u64 << g;
+        if g == ROOT_CGROUP {
+            return Some(mask);
+        }
+        let state = group(g);
+        state.refresh_period(now_us);
+        if state.throttled.load(Ordering::Relaxed) {
+            return None;
+        }
+        g = parent_of(g);
+    }
+    None
+}
+
+/// Load an entity's vruntime, first pulling it up to `floor` if it lagged
+/// (a group that sat idle does not get to run for the whole time it missed)
+fn placed_vruntime(vruntime: &AtomicU64, floor: u64) -> u64 {
+    let v = vruntime.load(Ordering::Relaxed);
+    if v >= floor {
+        return v;
+    }
+    vruntime.store(floor, Ordering::Relaxed);
+    floor
+}
+
+/// Choose the group whose tasks run next on `cpu`: walk down from the root
+/// taking the lowest-vruntime runnable entity at each level. Returns None
+/// when every group with queued tasks is throttled. Realtime tasks are
+/// not grouped. Called with the process table locked.
+pub fn pick_group(
+    table: &[Option<ProcessEntry>; MAX_PROCESSES],
+    cpu: usize,
+    now_us: u64,
+) -> Option<CgroupId> {
+    let mut queued = 0u64;
+    for entry in table.iter().flatten() {
+        if entry.process.state == ProcessState::Ready
+            && entry.policy != SchedPolicy::Realtime
+            && entry.cpu_affinity.is_set(cpu)
+        {
+            queued |= 1u64 << (entry.cgroup as usize % MAX_CGROUPS);
+        }
+    }
+    if NR_CGROUPS.load(Ordering::Relaxed) == 0 {
+        return (queued != 0).then_some(ROOT_CGROUP);
+    }
+
+    let mut direct = 0u64;
+    let mut runnable = 0u64;
+    let mut bits = queued;
+    while bits != 0 {
+        let id = bits.trailing_zeros() as CgroupId;
+        bits &= bits - 1;
+        if let Some(path) = runnable_path(id, now_us) {
+            direct |= 1u64 << id;
+            runnable |= path;
+        }
+    }
+    if direct == 0 {
+        return None;
+    }
+
+    let mut g = ROOT_CGROUP;
+    for _ in 0..=CGROUP_MAX_DEPTH {
+        let state = group(g);
+        let floor = state
+            .min_vruntime
+            .load(Ordering::Relaxed)
+            .saturating_sub(PLACEMENT_SLACK_NS);
+
+        let mut best: Option<(u64, CgroupId)> = None;
+        if direct & (1u64 << g) != 0 {
+            best = Some((placed_vruntime(&state.local_vruntime, floor), g));
+        }
+        let mut children = runnable & !(1u64 << g);
+        while children != 0 {
+            let child = children.trailing_zeros() as CgroupId;
+            children &= children - 1;
+            if parent_of(child) != g {
+                continue;
+            }
+            let v = placed_vruntime(&group(child).vruntime, floor);
+            if best.map_or(true, |(best_v, _)| v < best_v) {
+                best = Some((v, child));
+            }
+        }
+
+        let (v, next) = best?;
+        state.min_vruntime.fetch_max(v, Ordering::Relaxed);
+        if next == g {
+            return Some(g);
+        }
+        g = next;
+    }
+    None
+}
+
+/// Whether `id` or an ancestor is out of quota
+pub fn is_throttled(id: CgroupId, now_us: u64) -> bool {
+    runnable_path(id, now_us).is_none()
+}
+
+/// Record the group of the task now running on this CPU
+#[inline]
+pub(super) fn set_cpu_cgroup(id: CgroupId) {
+    let cpu = crate::smp::current_cpu_id() as usize % MAX_CPUS;
+    CPU_CGROUP[cpu].store(id, Ordering::Relaxed);
+}
+
+/// Group of the task running on this CPU (lock-free)
+#[inline]
+pub fn current() -> CgroupId {
+    let cpu = crate::smp::current_cpu_id() as usize % MAX_CPUS;
+    CPU_CGROUP[cpu].load(Ordering::Relaxed)
+}
+
+// =============================================================================
+// Memory
+// =============================================================================
+
+/// Charge `bytes` to `id` and its ancestors. Fails without charging if a
+/// level would exceed memory.max; Ok(true) if a level is above memory.high.
+pub fn try_charge_memory(id: CgroupId, bytes: u64) -> Result<bool, CgroupError> {
+    let id = if is_active(id) { id } else { ROOT_CGROUP };
+    let mut g = id;
+    for _ in 0..=CGROUP_MAX_DEPTH {
+        let state = group(g);
+        let max = state.mem_max.load(Ordering::Relaxed);
+        let charged = state
+            .mem_current
+            .fetch_update(Ordering::Relaxed, Ordering::Relaxed, |cur| {
+                cur.checked_add(bytes).filter(|&new| new <= max)
+            });
+        if charged.is_err() {
+            state.mem_events_max.fetch_add(1, Ordering::Relaxed);
+            // Undo the levels below
+            let mut undo = id;
+            while undo != g {
+                group(undo).mem_current.fetch_sub(bytes, Ordering::Relaxed);
+                undo = parent_of(undo);
+            }
+            return Err(CgroupError::OverLimit);
+        }
+        if g == ROOT_CGROUP {
+            break;
+        }
+        g = parent_of(g);
+    }
+
+    let mut over_high = false;
+    let mut g = id;
+    for _ in 0..=CGROUP_MAX_DEPTH {
+        let state = group(g);
+        if state.mem_current.load(Ordering::Relaxed) > state.mem_high.load(Ordering::Relaxed) {
+            state.mem_events_high.fetch_add(1, Ordering::Relaxed);
+            over_high = true;
+        }
+        if g == ROOT_CGROUP {
+            break;
+        }
+        g = parent_of(g);
+    }
+    Ok(over_high)
+}
+
+/// Charge ignoring limits (moving an existing charge)
+fn force_charge_memory(id: CgroupId, bytes: u64) {
+    let mut g = id;
+    for _ in 0..=CGROUP_MAX_DEPTH {
+        group(g).mem_current.fetch_add(bytes, Ordering::Relaxed);
+        if g == ROOT_CGROUP {
+            break;
+        }
+        g = parent_of(g);
+    }
+}
+
+/// Return a charge made with `try_charge_memory()`
+pub fn uncharge_memory(id: CgroupId, bytes: u64) {
+    if bytes == 0 {
+        return;
+    }
+    let mut g = if is_active(id) { id } else { ROOT_CGROUP };
+    for _ in 0..=CGROUP_MAX_DEPTH {
+        let _ = group(g)
+            .mem_current
+            .fetch_update(Ordering::Relaxed, Ordering::Relaxed, |cur| {
+                Some(cur.saturating_sub(bytes))
+            });
+        if g == ROOT_CGROUP {
+            break;
+        }
+        g = parent_of(g);
+    }
+}
+
+/// Slot holding the memory charge of thread group `tgid`: the leader, or
+/// any surviving thread once the leader is gone. Threads share one address
+/// space, so memory is charged to the group rather than to whichever thread
+/// mapped or unmapped it.
+fn memory_owner(table: &[Option<ProcessEntry>; MAX_PROCESSES], tgid: Pid) -> Option<usize> {
+    let mut survivor = None;
+    for (idx, slot) in table.iter().enumerate() {
+        match slot {
+            Some(entry) if entry.process.tgid == tgid => {
+                if entry.process.pid == tgid {
+                    return Some(idx);
+                }
+                survivor.get_or_insert(idx);
+            }
+            _ => {}
+        }
+    }
+    survivor
+}
+
+/// Charge `bytes` to thread group `tgid`. Returns true if the charge went
+/// over memory.high somewhere.
+pub fn charge_thread_group(
+    table: &mut [Option<ProcessEntry>; MAX_PROCESSES],
+    tgid: Pid,
+    bytes: u64,
+) -> Result<bool, CgroupError> {
+    let Some(entry) = memory_owner(table, tgid).and_then(|idx| table[idx].as_mut()) else {
+        return Ok(false);
+    };
+    let over_high = try_charge_memory(entry.cgroup, bytes)?;
+    entry.mem_charged += bytes;
+    Ok(over_high)
+}
+
+/// Return up to `bytes` charged with `charge_thread_group()`
+pub fn uncharge_thread_group(
+    table: &mut [Option<ProcessEntry>; MAX_PROCESSES],
+    tgid: Pid,
+    bytes: u64,
+) {
+    if let Some(entry) = memory_owner(table, tgid).and_then(|idx| table[idx].as_mut()) {
+        let bytes = bytes.min(entry.mem_charged);
+        entry.mem_charged -= bytes;
+        uncharge_memory(entry.cgroup, bytes);
+    }
+}
+
+/// Thread group of the current process
+fn current_tgid(table: &[Option<ProcessEntry>; MAX_PROCESSES]) -> Option<Pid> {
+    let pid = super::current_pid()?;
+    table
+        .iter()
+        .flatten()
+        .find(|entry| entry.process.pid == pid)
+        .map(|entry| entry.process.tgid)
+}
+
+/// Charge a memory allocation of the current process to its thread group
+///
+/// Above memory.high the caller yields once, accounted as a memory stall,
+/// so a group that keeps growing loses CPU instead of starving others.
+pub fn charge_current_memory(bytes: u64) -> Result<(), CgroupError> {
+    let over_high = {
+        let mut table = PROCESS_TABLE.lock();
+        let Some(tgid) = current_tgid(&table) else {
+            return Ok(());
+        };
+        charge_thread_group(&mut table, tgid, bytes)?
+    };
+    if over_high {
+        throttle_memory_high();
+    }
+    Ok(())
+}
+
+/// Yield once as a memory stall. Other tasks run on this CPU meanwhile and
+/// we may resume on another one, so the stall is flagged on the task
+/// instead of with the per-CPU `psi::stall()` markers.
+fn throttle_memory_high() {
+    set_memstall(true);
+    super::do_schedule();
+    set_memstall(false);
+}
+
+fn set_memstall(stalled: bool) {
+    let Some(pid) = super::current_pid() else {
+        return;
+    };
+    let mut table = PROCESS_TABLE.lock();
+    if let Some(entry) = table
+        .iter_mut()
+        .flatten()
+        .find(|entry| entry.process.pid == pid)
+    {
+        entry.sched_info.memstall = stalled;
+    }
+}
+
+/// Release memory charged with `charge_current_memory()`
+pub fn uncharge_current_memory(bytes: u64) {
+    let mut table = PROCESS_TABLE.lock();
+    if let Some(tgid) = current_tgid(&table) {
+        uncharge_thread_group(&mut table, tgid, bytes);
+    }
+}
+
+/// Release memory charged to thread group `tgid`, e.g. by a mapping made by
+/// another thread of the group
+pub fn uncharge_group_memory(tgid: Pid, bytes: u64) {
+    uncharge_thread_group(&mut PROCESS_TABLE.lock(), tgid, bytes);
+}
+
+/// Drop everything charged on behalf of `entry`
+pub fn release_memory(entry: &mut ProcessEntry) {
+    uncharge_memory(entry.cgroup, entry.mem_charged);
+    entry.mem_charged = 0;
+}
+
+/// Drop everything charged to thread group `tgid`, for when its address
+/// space goes away (exec replacing the image)
+pub fn release_group_memory(table: &mut [Option<ProcessEntry>; MAX_PROCESSES], tgid: Pid) {
+    for entry in table.iter_mut().flatten() {
+        if entry.process.tgid == tgid {
+            release_memory(entry);
+        }
+    }
+}
+
+/// Account for the thread in slot `idx` going away. The group's mappings
+/// outlive it, so its charge passes to another thread of the group; only
+/// the last thread releases it. Returns true if it was the last thread.
+pub fn release_thread_memory(
+    table: &mut [Option<ProcessEntry>; MAX_PROCESSES],
+    idx: usize,
+) -> bool {
+    let Some(mut entry) = table[idx].take() else {
+        return false;
+    };
+    let (tgid, from, bytes) = (entry.process.tgid, entry.cgroup, entry.mem_charged);
+    entry.mem_charged = 0;
+    let heir = memory_owner(table, tgid);
+    table[idx] = Some(entry);
+
+    let Some(heir) = heir.and_then(|heir| table[heir].as_mut()) else {
+        uncharge_memory(from, bytes);
+        return true;
+    };
+    if heir.cgroup != from {
+        uncharge_memory(from, bytes);
+        force_charge_memory(heir.cgroup, bytes);
+    }
+    heir.mem_charged += bytes;
+    false
+}
+
+// =============================================================================
+// I/O
+// =============================================================================
+
+/// Account a completed block request to the running task's group
+pub fn account_io(write: bool, bytes: u64) {
+    let mut g = current();
+    for _ in 0..=CGROUP_MAX_DEPTH {
+        if !is_active(g) {
+            break;
+        }
+        let state = group(g);
+        if write {
+            state.io_wbytes.fetch_add(bytes, Ordering::Relaxed);
+            state.io_wios.fetch_add(1, Ordering::Relaxed);
+        } else {
+            state.io_rbytes.fetch_add(bytes, Ordering::Relaxed);
+            state.io_rios.fetch_add(1, Ordering::Relaxed);
+        }
+        if g == ROOT_CGROUP {
+            break;
+        }
+        g = parent_of(g);
+    }
+}
@@ -15,6 +15,7 @@ use core::sync::atomic::Ordering;
 use crate::process::{Pid, ProcessState, MAX_PROCESSES};
 use crate::{kdebug, ktrace};
 
+use super::cgroup;
 use super::context::context_switch;
 use super::priority::{
     calc_vdeadline, is_eligible, ms_to_ns, replenish_slice, update_curr, update_min_vruntime,
@@ -30,6 +31,7 @@ pub fn init() {
         BASE_SLICE_NS / 1_000_000
     );
     crate::kinfo!("Scheduling: Earliest Eligible Virtual Deadline First with lag-based fairness");
+    super::percpu::start_periodic_balance();
 }
 
 /// EEVDF candidate info: (index, vdeadline, policy, is_eligible, priority)
@@ -146,6 +148,7 @@ fn find_start_index(
 /// Find the best ready process using EEVDF algorithm
 /// Selects the eligible process with the earliest virtual deadline
 /// Only considers processes that can run on the current CPU (affinity check)
+/// Non-realtime processes are restricted to the cgroup picked for this CPU
 ///
 /// Performance optimizations:
 /// - Early exit for realtime processes (highest priority)
@@ -160,6 +163,7 @@ fn find_best_candidate(
 
     // Get current CPU ID for affinity check (supports up to 1024 CPUs)
     let current_cpu = crate::smp::current_cpu_id() as usize;
+    let group = cgroup::pick_group(table, current_cpu, crate::logger::boot_time_us());
 
     for (idx, slot) in table.iter().enumerate() {
         let Some(entry) = slot else { continue };
@@ -174,6 +178,11 @@ fn find_best_candidate(
             continue;
         }
 
+        // Realtime processes are not grouped
+        if entry.policy != SchedPolicy::Realtime && group != Some(entry.cgroup) {
+            continue;
+        }
+
         // Fast path for realtime: if we found one, only compare with other realtime
         if found_realtime && entry.policy != SchedPolicy::Realtime {
             continue;
@@ -241,7 +250,7 @@ pub fn schedule() -> Option<Pid> {
             replenish_slice(entry);
         }
 
-        entry.process.state = ProcessState::Running;
+        entry.set_state(ProcessState::Running);
         entry.last_scheduled = current_tick;
         entry.wait_time = 0;
         entry.cpu_burst_count += 1;
@@ -273,7 +282,7 @@ fn update_previous_process_state(
         if entry.process.pid != curr_pid || entry.process.state != ProcessState::Running {
             continue;
         }
-        entry.process.state = ProcessState::Ready;
+        entry.set_state(ProcessState::Ready);
         entry.last_scheduled = current_tick;
         break;
     }
@@ -421,6 +430,7 @@ pub fn tick(elapsed_ms: u64) -> bool {
         Some(t) => t,
         None => return false, // Lock held, skip this tick
     };
+    super::psi::tick(&table);
     let current = current_pid();
 
     let Some(curr_pid) = current else {
@@ -578,12 +588,14 @@ fn find_zombie_parent_index(
 
 /// Find next ready process index using round-robin
 /// Only considers processes that can run on the current CPU (affinity check)
+/// and, unless realtime, belong to the cgroup picked for this CPU
 fn find_next_ready_index(
     table: &[Option<super::types::ProcessEntry>; MAX_PROCESSES],
     start_idx: usize,
 ) -> Option<usize> {
     // Get current CPU ID for affinity check (supports up to 1024 CPUs)
     let current_cpu = crate::smp::current_cpu_id() as usize;
+    let group = cgroup::pick_group(table, current_cpu, crate::logger::boot_time_us());
 
     for offset in 0..MAX_PROCESSES {
         let idx = (start_idx + offset) % MAX_PROCESSES;
@@ -595,6 +607,9 @@ fn find_next_ready_index(
         if !entry.cpu_affinity.is_set(current_cpu) {
             continue;
         }
+        if entry.policy != SchedPolicy::Realtime && group != Some(entry.cgroup) {
+            continue;
+        }
         return Some(idx);
     }
     None
@@ -665,7 +680,7 @@ fn transition_current_to_ready(
 
         // Only change state to Ready if it was Running (not already Sleeping)
         if entry.process.state == ProcessState::Running {
-            entry.process.state = ProcessState::Ready;
+            entry.set_state(ProcessState::Ready);
         }
         break;
     }
@@ -709,7 +724,7 @@ fn extract_next_process_info(
     // Legacy: Update time_slice for compatibility
     entry.time_slice = super::priority::ns_to_ms(entry.slice_remaining_ns);
 
-    entry.process.state = ProcessState::Running;
+    entry.set_state(ProcessState::Running);
 
     // Update last_cpu to record which CPU is running this process
     entry.last_cpu = crate::smp::current_cpu_id() as u16;
@@ -1422,6 +1437,11 @@ fn do_schedule_internal(from_interrupt: bool) {
                     }
                 }
 
+                // Run deferred work before going to sleep
+                if crate::smp::workqueue::run_pending() > 0 {
+                    continue;
+                }
+
                 // No ready process, wait for interrupt
                 x86_64::instructions::interrupts::enable_and_hlt();
             }
@@ -29,14 +29,18 @@
 //! - `context`: Low-level context switch implementation
 //! - `smp`: SMP and CPU affinity functions
 //! - `stats`: Statistics and debugging functions
+//! - `psi`: Pressure stall information (/proc/pressure)
+//! - `cgroup`: Control groups (CPU weight/bandwidth, memory and I/O accounting)
 
 extern crate alloc;
 
+pub mod cgroup;
 mod context;
 mod core;
 pub mod percpu;
 mod priority;
 mod process;
+pub mod psi;
 mod smp;
 mod stats;
 pub mod table;
@@ -44,7 +48,7 @@ mod types;
 
 // Re-export types for external use
 pub use types::{nice_to_weight, BASE_SLICE_NS, MAX_SLICE_NS, NICE_0_WEIGHT, SCHED_GRANULARITY_NS};
-pub use types::{CpuMask, ProcessEntry, SchedPolicy, SchedulerStats};
+pub use types::{CpuMask, ProcessEntry, SchedInfo, SchedPolicy, SchedulerStats};
 pub use types::{BASE_TIME_SLICE_MS, DEFAULT_TIME_SLICE, NUM_PRIORITY_LEVELS};
 
 // Re-export table functions
@@ -128,7 +132,7 @@ pub use smp::{
 pub use percpu::{
     balance_runqueues, check_need_resched, current_percpu_sched, find_best_cpu_numa,
     find_least_loaded_cpu, get_cpu_load, get_cpu_queue_len, get_percpu_sched, init_percpu_sched,
-    set_need_resched, update_all_load_averages,
+    set_need_resched, start_periodic_balance, update_all_load_averages,
 };
 
 // Re-export statistics functions
@@ -138,6 +142,7 @@ pub use stats::{
     get_load_average,
     get_percpu_stats,
     get_process_counts,
+    get_process_schedstat,
     get_stats,
     list_percpu_stats,
     list_processes,
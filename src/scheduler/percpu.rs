@@ -796,3 +796,26 @@ pub fn update_all_load_averages() {
         }
     }
 }
+
+/// Interval between periodic load average updates and balance checks
+const BALANCE_INTERVAL_MS: u64 = 100;
+
+/// Periodic balance work; re-arms itself on the unbound workqueue
+fn balance_work(_: usize) {
+    update_all_load_averages();
+    balance_runqueues();
+    start_periodic_balance();
+}
+
+/// Start updating load averages and balancing run queues every
+/// `BALANCE_INTERVAL_MS`
+pub fn start_periodic_balance() {
+    if !crate::smp::workqueue::queue_delayed_work(
+        crate::smp::workqueue::WorkTarget::Unbound,
+        balance_work,
+        0,
+        BALANCE_INTERVAL_MS,
+    ) {
+        crate::kwarn!("sched: workqueue full, periodic balancing stopped");
+    }
+}
@@ -213,6 +213,9 @@ pub fn place_entity(entry: &mut super::types::ProcessEntry, is_new: bool) {
 
     // Calculate initial deadline
     entry.vdeadline = calc_vdeadline(entry.vruntime, entry.slice_ns, entry.weight);
+
+    // Run delay is measured from here until the process is picked
+    entry.sched_info.queued(crate::logger::boot_time_us());
 }
 
 /// Update process state after running for delta_exec nanoseconds
@@ -231,6 +234,16 @@ pub fn update_curr(entry: &mut super::types::ProcessEntry, delta_exec_ns: u64) {
     // lag represents: (ideal_share - actual_received) in virtual time units
     entry.lag = entry.lag.saturating_sub(delta_vrt as i64);
 
+    entry.sched_info.run_ns = entry.sched_info.run_ns.saturating_add(delta_exec_ns);
+
+    // Charge the cgroup entities; a group out of quota gives up the CPU
+    let now_us = crate::logger::boot_time_us();
+    if super::cgroup::charge_runtime(entry.cgroup, delta_exec_ns, now_us)
+        && entry.policy != SchedPolicy::Realtime
+    {
+        entry.slice_remaining_ns = 0;
+    }
+
     // Update legacy fields
     entry.total_time = entry.total_time.saturating_add(ns_to_ms(delta_exec_ns));
     entry.time_slice = ns_to_ms(entry.slice_remaining_ns);
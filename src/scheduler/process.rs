@@ -29,6 +29,14 @@ pub fn add_process_with_policy(
     let current_tick = GLOBAL_TICK.load(Ordering::Relaxed);
     let min_vrt = get_min_vruntime();
 
+    // Children start in their parent's cgroup, threads in their leader's
+    let parent_pid = if process.is_thread {
+        process.tgid
+    } else {
+        process.ppid
+    };
+    let cgroup = super::cgroup::inherited(&table, parent_pid);
+
     for (idx, slot) in table.iter_mut().enumerate() {
         if slot.is_none() {
             // Register PID in the radix tree for O(log N) lookup
@@ -81,6 +89,13 @@ pub fn add_process_with_policy(
                 // NUMA fields
                 numa_preferred_node: crate::numa::NUMA_NO_NODE,
                 numa_policy: crate::numa::NumaPolicy::Local,
+                // New processes start out runnable
+                sched_info: SchedInfo {
+                    queued_at_us: crate::logger::boot_time_us().max(1),
+                    ..SchedInfo::new()
+                },
+                cgroup,
+                mem_charged: 0,
             });
 
             drop(table);
@@ -144,8 +159,18 @@ pub fn remove_process(pid: Pid) -> Result<(), &'static str> {
         let open_fds = entry.process.open_fds;
         let memory_base = entry.process.memory_base;
         let memory_size = entry.process.memory_size;
+        let tgid = entry.process.tgid;
+        let last_thread = super::cgroup::release_thread_memory(&mut table, idx);
         table[idx] = None;
-        (cr3, kernel_stack, open_fds, memory_base, memory_size)
+        (
+            cr3,
+            kernel_stack,
+            open_fds,
+            memory_base,
+            memory_size,
+            tgid,
+            last_thread,
+        )
     };
 
     let (
@@ -154,8 +179,15 @@ pub fn remove_process(pid: Pid) -> Result<(), &'static str> {
         removed_open_fds,
         removed_memory_base,
         removed_memory_size,
+        removed_tgid,
+        last_thread,
     ) = removal_result;
 
+    // The thread group's mappings go away with its last thread
+    if last_thread {
+        crate::syscalls::memory::release_mmap_regions(removed_tgid);
+    }
+
     if current_pid() == Some(pid) {
         set_current_pid(None);
     }
@@ -264,7 +296,7 @@ pub fn set_process_state(pid: Pid, state: ProcessState) -> Result<(), &'static s
                             state
                         );
                     }
-                    entry.process.state = state;
+                    entry.set_state(state);
                     return Ok(());
                 }
             }
@@ -313,7 +345,7 @@ pub fn set_process_state(pid: Pid, state: ProcessState) -> Result<(), &'static s
                 state
             );
         }
-        entry.process.state = state;
+        entry.set_state(state);
         return Ok(());
     }
 
@@ -492,7 +524,7 @@ pub fn mark_process_as_forked_child(pid: Pid) {
         if idx < table.len() {
             if let Some(entry) = &mut table[idx] {
                 if entry.process.pid == pid {
-                    entry.process.state = ProcessState::Ready;
+                    entry.set_state(ProcessState::Ready);
                     crate::kdebug!("Marked PID {} as forked child", pid);
                     return;
                 }
@@ -507,7 +539,7 @@ pub fn mark_process_as_forked_child(pid: Pid) {
             continue;
         }
 
-        entry.process.state = ProcessState::Ready;
+        entry.set_state(ProcessState::Ready);
         crate::kdebug!("Marked PID {} as forked child", pid);
         return;
     }
@@ -598,7 +630,7 @@ pub fn set_current_process_state(state: ProcessState) {
                         return; // Stay in current state (Ready/Running)
                     }
 
-                    entry.process.state = state;
+                    entry.set_state(state);
                     return;
                 }
             }
@@ -624,7 +656,7 @@ pub fn set_current_process_state(state: ProcessState) {
                 return;
             }
 
-            entry.process.state = state;
+            entry.set_state(state);
             break;
         }
     }
@@ -670,7 +702,7 @@ fn wake_process_internal(pid: Pid, try_lock: bool) -> bool {
                 if entry.process.pid == pid {
                     match entry.process.state {
                         ProcessState::Sleeping => {
-                            entry.process.state = ProcessState::Ready;
+                            entry.set_state(ProcessState::Ready);
                             entry.process.wake_pending = false; // Clear any pending wake
                             entry.wait_time = 0;
 
@@ -718,7 +750,7 @@ fn wake_process_internal(pid: Pid, try_lock: bool) -> bool {
 
             match entry.process.state {
                 ProcessState::Sleeping => {
-                    entry.process.state = ProcessState::Ready;
+                    entry.set_state(ProcessState::Ready);
                     entry.process.wake_pending = false;
                     entry.wait_time = 0;
 
@@ -0,0 +1,339 @@
+//! Pressure Stall Information (PSI)
+//!
+//! Tracks how much wall time runnable work lost to resource contention, per
+//! resource, like Linux's /proc/pressure/{cpu,memory,io}:
+//! - **some**: at least one task was stalled on the resource
+//! - **full**: every non-idle task was stalled at the same time, so no
+//!   useful work was done
+//!
+//! Each state has a cumulative total (us) and running averages over 10s,
+//! 60s and 300s windows, updated every 2s with the load-average decay.
+//!
+//! Sources of stall time:
+//! - **cpu**: processes Ready but waiting for a CPU
+//! - **io**: block I/O, which is synchronous here, so the stalled task is
+//!   the one running on the CPU inside `stall(PsiResource::Io, ..)`
+//! - **memory**: swap-in/swap-out, accounted the same way, and tasks
+//!   throttled above a cgroup's memory.high. A throttled task gives up its
+//!   CPU, so it is flagged in `SchedInfo::memstall` rather than marking the
+//!   CPU it happened to run on
+//!
+//! The scheduler tick samples the process table and the per-CPU stall
+//! markers every `SAMPLE_US` and charges the elapsed time to the states
+//! that held at the sample. `PsiGroup` holds the accounting for one set of
+//! tasks; the system-wide group backs /proc/pressure.
+
+use core::fmt::{self, Write};
+use core::sync::atomic::{AtomicU32, AtomicU64, Ordering};
+use spin::Mutex;
+
+use crate::acpi::MAX_CPUS;
+use crate::process::{ProcessState, MAX_PROCESSES};
+
+use super::types::ProcessEntry;
+
+/// Resource a task can stall on
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum PsiResource {
+    Cpu = 0,
+    Memory = 1,
+    Io = 2,
+}
+
+impl PsiResource {
+    pub const ALL: [PsiResource; 3] = [PsiResource::Cpu, PsiResource::Memory, PsiResource::Io];
+
+    /// Name used under /proc/pressure
+    pub const fn name(self) -> &'static str {
+        match self {
+            PsiResource::Cpu => "cpu",
+            PsiResource::Memory => "memory",
+            PsiResource::Io => "io",
+        }
+    }
+
+    pub fn from_name(name: &str) -> Option<Self> {
+        Self::ALL.into_iter().find(|res| res.name() == name)
+    }
+
+    const fn some_state(self) -> usize {
+        self as usize * 2
+    }
+
+    const fn full_state(self) -> usize {
+        self as usize * 2 + 1
+    }
+}
+
+/// some/full for each resource
+const NR_PSI_STATES: usize = 6;
+
+/// Minimum time between two samples
+const SAMPLE_US: u64 = 10_000;
+
+/// Averaging period
+const AVG_PERIOD_US: u64 = 2_000_000;
+
+/// Fixed-point averages (same format as the load average)
+const FSHIFT: u32 = 11;
+const FIXED_1: u64 = 1 << FSHIFT;
+
+/// Decay per 2s period for the 10s, 60s and 300s windows: FIXED_1 / exp(2/window)
+const EXP: [u64; 3] = [1677, 1981, 2034];
+
+/// Missed periods decayed before the averages settle at zero anyway
+const MAX_MISSED_PERIODS: u64 = 1024;
+
+/// Exponentially decaying average step, rounding towards `active`
+fn calc_load(load: u64, exp: u64, active: u64) -> u64 {
+    let mut newload = load * exp + active * (FIXED_1 - exp);
+    if active >= load {
+        newload += FIXED_1 - 1;
+    }
+    newload / FIXED_1
+}
+
+/// Stall accounting for a set of tasks
+#[derive(Clone, Copy)]
+pub struct PsiGroup {
+    /// Cumulative stall time per state (us)
+    total_us: [u64; NR_PSI_STATES],
+    /// 10s/60s/300s averages per state (percent, FIXED_1 fixed point)
+    avg: [[u64; 3]; NR_PSI_STATES],
+    /// `total_us` at the last average update
+    avg_total_us: [u64; NR_PSI_STATES],
+    /// Time of the last average update (0 = not started)
+    avg_last_us: u64,
+}
+
+impl PsiGroup {
+    pub const fn new() -> Self {
+        Self {
+            total_us: [0; NR_PSI_STATES],
+            avg: [[0; 3]; NR_PSI_STATES],
+            avg_total_us: [0; NR_PSI_STATES],
+            avg_last_us: 0,
+        }
+    }
+
+    /// Charge `delta_us` to every state set in `states` (bit per state)
+    pub fn account(&mut self, states: u32, delta_us: u64, now_us: u64) {
+        for (state, total) in self.total_us.iter_mut().enumerate() {
+            if states & (1 << state) != 0 {
+                *total += delta_us;
+            }
+        }
+        self.update_averages(now_us);
+    }
+
+    /// Fold the stall time since the last update into the averages
+    fn update_averages(&mut self, now_us: u64) {
+        if self.avg_last_us == 0 {
+            self.avg_last_us = now_us.max(1);
+            self.avg_total_us = self.total_us;
+            return;
+        }
+        let elapsed = now_us.saturating_sub(self.avg_last_us);
+        if elapsed < AVG_PERIOD_US {
+            return;
+        }
+
+        // Stall time is spread over the whole window; periods beyond the
+        // first only decay the averages
+        let missed = (elapsed / AVG_PERIOD_US - 1).min(MAX_MISSED_PERIODS);
+        for state in 0..NR_PSI_STATES {
+            let stall = self.total_us[state] - self.avg_total_us[state];
+            let pct = (stall * 100 * FIXED_1 / elapsed).min(100 * FIXED_1);
+            for (avg, &exp) in self.avg[state].iter_mut().zip(EXP.iter()) {
+                for _ in 0..missed {
+                    *avg = calc_load(*avg, exp, 0);
+                }
+                *avg = calc_load(*avg, exp, pct);
+            }
+        }
+        self.avg_total_us = self.total_us;
+        self.avg_last_us = now_us;
+    }
+
+    /// Cumulative some/full stall time for `res` (us)
+    pub fn total_us(&self, res: PsiResource) -> (u64, u64) {
+        (
+            self.total_us[res.some_state()],
+            self.total_us[res.full_state()],
+        )
+    }
+
+    /// 10s/60s/300s some averages for `res`, in hundredths of a percent
+    pub fn some_avg(&self, res: PsiResource) -> [u64; 3] {
+        self.avg[res.some_state()].map(|avg| avg * 100 / FIXED_1)
+    }
+
+    /// Write `res` in /proc/pressure format
+    pub fn write_report(&self, res: PsiResource, w: &mut dyn Write) -> fmt::Result {
+        for (label, state) in [("some", res.some_state()), ("full", res.full_state())] {
+            let [avg10, avg60, avg300] = self.avg[state];
+            writeln!(
+                w,
+                "{} avg10={}.{:02} avg60={}.{:02} avg300={}.{:02} total={}",
+                label,
+                avg10 >> FSHIFT,
+                ((avg10 & (FIXED_1 - 1)) * 100) >> FSHIFT,
+                avg60 >> FSHIFT,
+                ((avg60 & (FIXED_1 - 1)) * 100) >> FSHIFT,
+                avg300 >> FSHIFT,
+                ((avg300 & (FIXED_1 - 1)) * 100) >> FSHIFT,
+                self.total_us[state]
+            )?;
+        }
+        Ok(())
+    }
+}
+
+/// Task counts at one sample
+#[derive(Clone, Copy, Debug, Default)]
+pub struct PsiSample {
+    /// Runnable, waiting for a CPU
+    pub ready: usize,
+    /// On a CPU (including ones stalled in I/O or swap)
+    pub running: usize,
+    /// Running tasks stalled on I/O
+    pub iowait: usize,
+    /// Running tasks stalled on memory
+    pub memstall: usize,
+    /// Tasks yielding after going over memory.high (neither ready nor
+    /// running for this sample)
+    pub memthrottled: usize,
+}
+
+impl PsiSample {
+    /// Bitmask of the stall states that hold for this sample
+    pub fn states(&self) -> u32 {
+        let productive = self
+            .running
+            .saturating_sub(self.iowait)
+            .saturating_sub(self.memstall);
+        let mut states = 0;
+
+        if self.ready > 0 {
+            states |= 1 << PsiResource::Cpu.some_state();
+            if self.running == 0 {
+                states |= 1 << PsiResource::Cpu.full_state();
+            }
+        }
+        for (res, stalled) in [
+            (PsiResource::Memory, self.memstall + self.memthrottled),
+            (PsiResource::Io, self.iowait),
+        ] {
+            if stalled == 0 {
+                continue;
+            }
+            states |= 1 << res.some_state();
+            if productive == 0 && self.ready == 0 {
+                states |= 1 << res.full_state();
+            }
+        }
+        states
+    }
+}
+
+/// Per-CPU stall markers (nesting depth of the running task's stall)
+struct PsiCpu {
+    io: AtomicU32,
+    mem: AtomicU32,
+}
+
+static PSI_CPUS: [PsiCpu; MAX_CPUS] = [const {
+    PsiCpu {
+        io: AtomicU32::new(0),
+        mem: AtomicU32::new(0),
+    }
+}; MAX_CPUS];
+
+static PSI_SYSTEM: Mutex<PsiGroup> = Mutex::new(PsiGroup::new());
+static LAST_SAMPLE_US: AtomicU64 = AtomicU64::new(0);
+
+fn stall_counter(res: PsiResource) -> Option<&'static AtomicU32> {
+    let cpu = &PSI_CPUS[crate::smp::current_cpu_id() as usize % MAX_CPUS];
+    match res {
+        PsiResource::Cpu => None,
+        PsiResource::Memory => Some(&cpu.mem),
+        PsiResource::Io => Some(&cpu.io),
+    }
+}
+
+/// Mark the running task as stalled on `res` (Memory or Io)
+pub fn stall_begin(res: PsiResource) {
+    if let Some(counter) = stall_counter(res) {
+        counter.fetch_add(1, Ordering::Relaxed);
+    }
+}
+
+/// End a stall started with `stall_begin()` on this CPU
+pub fn stall_end(res: PsiResource) {
+    if let Some(counter) = stall_counter(res) {
+        let _ = counter.fetch_update(Ordering::Relaxed, Ordering::Relaxed, |n| n.checked_sub(1));
+    }
+}
+
+/// Run `f` as a stall on `res`
+#[inline]
+pub fn stall<T>(res: PsiResource, f: impl FnOnce() -> T) -> T {
+    stall_begin(res);
+    let result = f();
+    stall_end(res);
+    result
+}
+
+/// Count tasks by stall state
+pub fn collect_sample(table: &[Option<ProcessEntry>; MAX_PROCESSES]) -> PsiSample {
+    let mut sample = PsiSample::default();
+    for entry in table.iter().flatten() {
+        if entry.sched_info.memstall {
+            sample.memthrottled += 1;
+            continue;
+        }
+        match entry.process.state {
+            ProcessState::Ready => sample.ready += 1,
+            ProcessState::Running => sample.running += 1,
+            _ => {}
+        }
+    }
+    for cpu in 0..crate::smp::cpu_count().min(MAX_CPUS) {
+        if PSI_CPUS[cpu].io.load(Ordering::Relaxed) > 0 {
+            sample.iowait += 1;
+        }
+        if PSI_CPUS[cpu].mem.load(Ordering::Relaxed) > 0 {
+            sample.memstall += 1;
+        }
+    }
+    sample
+}
+
+/// Scheduler tick hook (called with the process table locked)
+pub(super) fn tick(table: &[Option<ProcessEntry>; MAX_PROCESSES]) {
+    let now = crate::logger::boot_time_us();
+    let last = LAST_SAMPLE_US.load(Ordering::Relaxed);
+    if now < last.saturating_add(SAMPLE_US) {
+        return;
+    }
+    // One CPU samples each interval
+    if LAST_SAMPLE_US
+        .compare_exchange(last, now, Ordering::AcqRel, Ordering::Relaxed)
+        .is_err()
+    {
+        return;
+    }
+    if last == 0 {
+        return;
+    }
+
+    let states = collect_sample(table).states();
+    if let Some(mut group) = PSI_SYSTEM.try_lock() {
+        group.account(states, now - last, now);
+    }
+}
+
+/// Snapshot of the system-wide pressure accounting
+pub fn system_pressure() -> PsiGroup {
+    *PSI_SYSTEM.lock()
+}
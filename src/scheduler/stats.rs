@@ -8,13 +8,23 @@ use core::sync::atomic::Ordering;
 use crate::process::{Pid, ProcessState, MAX_PROCESSES};
 
 use super::table::{GLOBAL_TICK, PROCESS_TABLE, SCHED_STATS};
-use super::types::{SchedPolicy, SchedulerStats};
+use super::types::{SchedInfo, SchedPolicy, SchedulerStats};
 
 /// Get scheduler statistics
 pub fn get_stats() -> SchedulerStats {
     *SCHED_STATS.lock()
 }
 
+/// Get a process's run time / run delay accounting
+pub fn get_process_schedstat(pid: Pid) -> Option<SchedInfo> {
+    let table = PROCESS_TABLE.lock();
+    let idx = crate::process::lookup_pid(pid)? as usize;
+    match table.get(idx)? {
+        Some(entry) if entry.process.pid == pid => Some(entry.sched_info),
+        _ => None,
+    }
+}
+
 /// Convert SchedPolicy to display string
 fn policy_str(policy: SchedPolicy) -> &'static str {
     match policy {
@@ -219,6 +219,53 @@ pub enum SchedPolicy {
     Idle,     // SCHED_IDLE: Only runs when nothing else is ready
 }
 
+/// Per-process scheduling statistics (/proc/[pid]/schedstat)
+#[derive(Clone, Copy, Debug, Default)]
+pub struct SchedInfo {
+    /// Time spent running on a CPU (ns)
+    pub run_ns: u64,
+    /// Time spent runnable but waiting for a CPU (ns)
+    pub run_delay_ns: u64,
+    /// Number of timeslices (times the process was given a CPU)
+    pub timeslices: u64,
+    /// When the process last became runnable (us since boot, 0 if not queued)
+    pub queued_at_us: u64,
+    /// Yielding after going over memory.high (a memory stall for PSI)
+    pub memstall: bool,
+}
+
+impl SchedInfo {
+    pub const fn new() -> Self {
+        Self {
+            run_ns: 0,
+            run_delay_ns: 0,
+            timeslices: 0,
+            queued_at_us: 0,
+            memstall: false,
+        }
+    }
+
+    /// The process became runnable
+    #[inline]
+    pub fn queued(&mut self, now_us: u64) {
+        if self.queued_at_us == 0 {
+            // 0 means "not queued", so never store it as a timestamp
+            self.queued_at_us = now_us.max(1);
+        }
+    }
+
+    /// The process was picked to run
+    #[inline]
+    pub fn arrive(&mut self, now_us: u64) {
+        if self.queued_at_us != 0 {
+            let delay_us = now_us.saturating_sub(self.queued_at_us);
+            self.run_delay_ns = self.run_delay_ns.saturating_add(delay_us * 1000);
+            self.queued_at_us = 0;
+        }
+        self.timeslices += 1;
+    }
+}
+
 /// Process control block with EEVDF scheduling info
 #[derive(Clone, Copy)]
 pub struct ProcessEntry {
@@ -261,6 +308,15 @@ pub struct ProcessEntry {
     pub numa_preferred_node: u32,
     /// NUMA policy for memory allocation
     pub numa_policy: crate::numa::NumaPolicy,
+
+    /// Run time / run delay accounting
+    pub sched_info: SchedInfo,
+
+    // === Control group ===
+    /// Control group the process belongs to
+    pub cgroup: super::cgroup::CgroupId,
+    /// Memory charged to the group on behalf of this process (bytes)
+    pub mem_charged: u64,
 }
 
 impl ProcessEntry {
@@ -333,7 +389,27 @@ impl ProcessEntry {
             // NUMA fields
             numa_preferred_node: crate::numa::NUMA_NO_NODE,
             numa_policy: crate::numa::NumaPolicy::Local,
+            sched_info: SchedInfo::new(),
+            cgroup: super::cgroup::ROOT_CGROUP,
+            mem_charged: 0,
+        }
+    }
+
+    /// Change the process state, keeping run-delay accounting and the
+    /// CPU's current cgroup in step
+    #[inline]
+    pub fn set_state(&mut self, state: ProcessState) {
+        match state {
+            ProcessState::Ready => self.sched_info.queued(crate::logger::boot_time_us()),
+            ProcessState::Running => {
+                if self.process.state != ProcessState::Running {
+                    self.sched_info.arrive(crate::logger::boot_time_us());
+                }
+                super::cgroup::set_cpu_cgroup(self.cgroup);
+            }
+            ProcessState::Sleeping | ProcessState::Zombie => self.sched_info.queued_at_us = 0,
         }
+        self.process.state = state;
     }
 }
 
@@ -385,6 +385,39 @@ impl ElfLoader {
         None
     }
 
+    /// Size in bytes of the memory image spanned by the PT_LOAD segments,
+    /// measured from the first segment's p_vaddr to the end of the last
+    /// segment's p_memsz. This is the range `load()` writes to.
+    pub fn image_span(&self) -> Result<u64, &'static str> {
+        let reader = self.reader;
+
+        let e_phoff = reader.u64(32).map_err(|_| "Malformed program header table")? as usize;
+        let e_phnum = reader.u16(56).map_err(|_| "Malformed program header table")? as usize;
+        let e_phentsize = reader.u16(54).map_err(|_| "Malformed program header table")? as usize;
+
+        let mut first_vaddr: Option<u64> = None;
+        let mut end_vaddr = 0u64;
+        for i in 0..e_phnum {
+            let offset = i
+                .checked_mul(e_phentsize)
+                .and_then(|delta| e_phoff.checked_add(delta))
+                .ok_or("Program header overflow")?;
+            let p_type = reader.u32(offset).map_err(|_| "Invalid program header")?;
+            if p_type != PhType::Load as u32 {
+                continue;
+            }
+            let p_vaddr = reader.u64(offset + 16).map_err(|_| "Invalid program header")?;
+            let p_memsz = reader.u64(offset + 40).map_err(|_| "Invalid program header")?;
+            if first_vaddr.is_none() {
+                first_vaddr = Some(p_vaddr);
+            }
+            end_vaddr = end_vaddr.max(p_vaddr.saturating_add(p_memsz));
+        }
+
+        let first_vaddr = first_vaddr.ok_or("ELF has no loadable segments")?;
+        Ok(end_vaddr.saturating_sub(first_vaddr))
+    }
+
     /// Load the ELF into memory at the specified base address
     /// For position-independent executables, base_addr is used as offset
     /// For static executables (with absolute addresses), segments are loaded at their p_vaddr
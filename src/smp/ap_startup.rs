@@ -294,11 +294,41 @@ fn busy_wait(mut iterations: u64) {
     }
 }
 
+/// Delay for `us` microseconds using the TSC. Falls back to
+/// `fallback_loops` spin iterations while the TSC frequency is a guess.
+fn udelay(us: u64, fallback_loops: u64) {
+    if crate::logger::tsc_frequency_is_guessed() {
+        busy_wait(fallback_loops);
+        return;
+    }
+    let cycles = us.saturating_mul(crate::logger::tsc_frequency_hz()) / 1_000_000;
+    let start = crate::safety::rdtsc();
+    while crate::safety::rdtsc().wrapping_sub(start) < cycles {
+        core::hint::spin_loop();
+    }
+}
+
+/// Check whether an AP reported itself online, and mirror that into its
+/// `CpuInfo` so IPI senders see it.
+///
+/// APs only write the trampoline status array (see `ap_entry_inner`).
+unsafe fn sync_online_status(index: usize) -> bool {
+    if super::trampoline::get_cpu_status_from_trampoline(index)
+        != super::trampoline::CPU_STATUS_ONLINE
+    {
+        return false;
+    }
+    cpu_info(index)
+        .status
+        .store(CpuStatus::Online as u8, Ordering::Release);
+    true
+}
+
 /// Wait for an AP to come online
 unsafe fn wait_for_online(index: usize, mut loops: u64) -> bool {
     while loops > 0 {
         let status = CpuStatus::from_atomic(cpu_info(index).status.load(Ordering::SeqCst));
-        if status == CpuStatus::Online {
+        if status == CpuStatus::Online || sync_online_status(index) {
             return true;
         }
         core::hint::spin_loop();
@@ -531,9 +561,15 @@ extern "C" fn ap_entry_inner(arg: *const ApBootArgs) -> ! {
             idx
         );
 
-        // Enter idle loop - LAPIC timer interrupts will trigger scheduler
+        // Enter idle loop - LAPIC timer interrupts will trigger scheduler.
+        // Until then, run work queued for this core (deferred boot init, ...).
         loop {
-            cpu_hlt();
+            x86_64::instructions::interrupts::disable();
+            if crate::smp::workqueue::run_pending() == 0 {
+                x86_64::instructions::interrupts::enable_and_hlt();
+            } else {
+                x86_64::instructions::interrupts::enable();
+            }
         }
     }
 }
@@ -690,7 +726,7 @@ pub unsafe fn send_init_to_all_aps(count: usize) {
 
         // Only send to cores that are in Booting state (prepared)
         if status == CpuStatus::Booting {
-            crate::kinfo!(
+            crate::kdebug!(
                 "SMP: [Parallel] INIT IPI -> AP {} (APIC {:#x})",
                 index,
                 info.apic_id
@@ -699,8 +735,8 @@ pub unsafe fn send_init_to_all_aps(count: usize) {
         }
     }
 
-    // Wait 10ms after INIT (per Intel spec)
-    busy_wait(100_000);
+    // Wait 10ms after INIT (per Intel spec), once for all APs
+    udelay(10_000, 100_000);
 }
 
 /// Send STARTUP IPI to all AP cores simultaneously
@@ -717,7 +753,7 @@ pub unsafe fn send_startup_to_all_aps(count: usize) {
     }
 
     // Wait 200us between SIPIs
-    busy_wait(20_000);
+    udelay(200, 20_000);
 
     crate::kinfo!("SMP: [Parallel] Sending STARTUP IPI #2 to all APs...");
 
@@ -731,6 +767,9 @@ pub unsafe fn send_startup_to_all_aps(count: usize) {
     }
 }
 
+/// How long to wait for APs to report online after the second SIPI
+const AP_ONLINE_TIMEOUT_US: u64 = 200_000;
+
 /// Start all AP cores in parallel
 /// This is the main entry point for parallel AP initialization
 pub unsafe fn start_all_aps_parallel(count: usize) -> Result<usize, &'static str> {
@@ -759,34 +798,55 @@ pub unsafe fn start_all_aps_parallel(count: usize) -> Result<usize, &'static str
     // Phase 3: Send STARTUP IPIs to all APs
     send_startup_to_all_aps(count);
 
-    // Extra delay to let APs boot
-    busy_wait(50_000);
-
-    // Phase 4: Wait for all APs to come online
+    // Phase 4: Wait for all APs to come online. Poll continuously and stop
+    // as soon as the last one arrived instead of sleeping in fixed steps.
     crate::kinfo!("SMP: [Parallel] Waiting for APs to come online...");
 
-    let mut online = 0;
-    let max_wait_iterations = 10;
-
-    for _ in 0..max_wait_iterations {
-        online = 0;
+    let timeout_cycles =
+        AP_ONLINE_TIMEOUT_US.saturating_mul(crate::logger::tsc_frequency_hz()) / 1_000_000;
+    let use_tsc = !crate::logger::tsc_frequency_is_guessed();
+    let start = crate::safety::rdtsc();
+    let mut loops = 0u64;
+    let mut online;
 
+    loop {
         // Check trampoline status array instead of dynamically allocated CpuInfo
+        online = 0;
         for index in 1..count {
-            let status = super::trampoline::get_cpu_status_from_trampoline(index);
-            if status == super::trampoline::CPU_STATUS_ONLINE {
+            if sync_online_status(index) {
                 online += 1;
             }
         }
-
         if online == prepared {
             break;
         }
 
-        // Wait and try again
-        busy_wait(STARTUP_WAIT_LOOPS / 10);
+        loops += 1;
+        let timed_out = if use_tsc {
+            crate::safety::rdtsc().wrapping_sub(start) >= timeout_cycles
+        } else {
+            loops >= STARTUP_WAIT_LOOPS / 100
+        };
+        if timed_out {
+            break;
+        }
+        core::hint::spin_loop();
     }
 
+    let wait_us = crate::safety::rdtsc()
+        .wrapping_sub(start)
+        .saturating_mul(1_000_000)
+        / crate::logger::tsc_frequency_hz().max(1);
+    crate::kinfo!(
+        "SMP: [Parallel] AP wait took ~{} us{}",
+        wait_us,
+        if use_tsc {
+            ""
+        } else {
+            " (TSC frequency guessed)"
+        }
+    );
+
     // NOTE: ONLINE_CPUS is now updated by each AP core itself in ap_entry_inner
     // No need to update it here to avoid double-counting
 
@@ -0,0 +1,267 @@
+//! Cross-CPU Function Calls
+//!
+//! `smp_call_function_single()` and `smp_call_function_many()` run a function
+//! on other CPUs from their `IPI_CALL_FUNCTION` handler.
+//!
+//! Each CPU owns a lock-free call queue, an intrusive list in the style of
+//! Linux's llist. A sender pushes a `CallData` and raises the IPI only when
+//! the queue was empty, so a burst of calls to one CPU costs one interrupt.
+//! The handler detaches the whole list with a single swap and runs it in
+//! submission order.
+//!
+//! Synchronous callers keep the `CallData` on their stack and spin until the
+//! target marks it done. Asynchronous calls take a `CallData` from a fixed
+//! pool, which the target returns: the handler runs in interrupt context and
+//! must not touch the heap. With the pool exhausted, an asynchronous call
+//! degrades to a synchronous one. While waiting, a CPU keeps draining its own queue, so two CPUs
+//! calling each other cannot deadlock.
+//!
+//! Called functions run in interrupt context with interrupts disabled. They
+//! must not sleep, and must not take locks that are held with interrupts
+//! enabled.
+
+use alloc::vec::Vec;
+use core::ptr;
+use core::sync::atomic::{AtomicBool, AtomicPtr, AtomicU64, Ordering};
+
+use crate::scheduler::CpuMask;
+
+use super::cpu::{cpu_count, current_cpu_id};
+use super::ipi::{cpu_is_online, send_call_function_ipi};
+use super::pool::SlotPool;
+use super::types::MAX_CPUS;
+
+/// Maximum number of asynchronous calls in flight
+const MAX_ASYNC_CALLS: usize = 256;
+
+/// Function run on a remote CPU
+pub type CallFn = fn(usize);
+
+/// One queued function call
+pub struct CallData {
+    next: *mut CallData,
+    func: CallFn,
+    arg: usize,
+    /// Set by the target once `func` returned (synchronous calls only)
+    done: AtomicBool,
+    /// Taken from `CALL_POOL` by the sender, returned by the target
+    owned: bool,
+}
+
+// Entries are owned by exactly one queue at a time
+unsafe impl Send for CallData {}
+
+impl CallData {
+    const fn new(func: CallFn, arg: usize, owned: bool) -> Self {
+        Self {
+            next: ptr::null_mut(),
+            func,
+            arg,
+            done: AtomicBool::new(false),
+            owned,
+        }
+    }
+}
+
+/// Per-CPU call queue head, alone on its cache line
+#[repr(C, align(64))]
+struct CallQueue {
+    head: AtomicPtr<CallData>,
+}
+
+impl CallQueue {
+    const fn new() -> Self {
+        Self {
+            head: AtomicPtr::new(ptr::null_mut()),
+        }
+    }
+}
+
+static CALL_QUEUES: [CallQueue; MAX_CPUS] = [const { CallQueue::new() }; MAX_CPUS];
+static CALL_POOL: SlotPool<CallData, { MAX_ASYNC_CALLS / 64 }> = SlotPool::new();
+
+// Statistics
+static CALLS_QUEUED: AtomicU64 = AtomicU64::new(0);
+static CALL_IPIS_SENT: AtomicU64 = AtomicU64::new(0);
+static CALLS_RUN: AtomicU64 = AtomicU64::new(0);
+
+/// Push `data` onto `cpu`'s queue. Returns true if the queue was empty.
+fn enqueue(cpu: usize, data: *mut CallData) -> bool {
+    let head = &CALL_QUEUES[cpu].head;
+    let mut old = head.load(Ordering::Relaxed);
+    loop {
+        unsafe {
+            (*data).next = old;
+        }
+        match head.compare_exchange_weak(old, data, Ordering::Release, Ordering::Relaxed) {
+            Ok(_) => break,
+            Err(current) => old = current,
+        }
+    }
+    CALLS_QUEUED.fetch_add(1, Ordering::Relaxed);
+    old.is_null()
+}
+
+/// Queue a call and raise the IPI if the target was not already notified
+fn queue_and_kick(cpu: usize, data: *mut CallData) {
+    if enqueue(cpu, data) && send_call_function_ipi(cpu as u16) {
+        CALL_IPIS_SENT.fetch_add(1, Ordering::Relaxed);
+    }
+}
+
+/// Run every call queued for the current CPU.
+///
+/// Called from the `IPI_CALL_FUNCTION` handler and by CPUs waiting for
+/// their own calls to complete.
+pub fn flush_call_queue() {
+    let cpu = current_cpu_id() as usize;
+    let mut list = CALL_QUEUES[cpu]
+        .head
+        .swap(ptr::null_mut(), Ordering::Acquire);
+    if list.is_null() {
+        return;
+    }
+
+    // The queue is LIFO; reverse it to run calls in submission order
+    let mut ordered: *mut CallData = ptr::null_mut();
+    while !list.is_null() {
+        unsafe {
+            let next = (*list).next;
+            (*list).next = ordered;
+            ordered = list;
+            list = next;
+        }
+    }
+
+    let mut ran = 0;
+    while !ordered.is_null() {
+        unsafe {
+            let entry = ordered;
+            let next = (*entry).next;
+            let (func, arg) = ((*entry).func, (*entry).arg);
+            func(arg);
+            if (*entry).owned {
+                CALL_POOL.free(entry);
+            } else {
+                // The sender may free the entry as soon as it sees `done`
+                (*entry).done.store(true, Ordering::Release);
+            }
+            ordered = next;
+        }
+        ran += 1;
+    }
+    CALLS_RUN.fetch_add(ran, Ordering::Relaxed);
+}
+
+/// Spin until a synchronous call completed, serving our own queue meanwhile.
+///
+/// The drain runs with interrupts disabled, as it would from the IPI
+/// handler: called functions rely on that, and an IPI landing mid-drain
+/// would otherwise run a second drain on top of it.
+fn wait_for(data: *const CallData) {
+    while !unsafe { (*data).done.load(Ordering::Acquire) } {
+        x86_64::instructions::interrupts::without_interrupts(flush_call_queue);
+        core::hint::spin_loop();
+    }
+}
+
+/// Queue an asynchronous call on `cpu`. Waits for it instead if the call
+/// pool is exhausted.
+fn queue_async(cpu: usize, func: CallFn, arg: usize) {
+    match CALL_POOL.alloc(CallData::new(func, arg, true)) {
+        Some(data) => queue_and_kick(cpu, data),
+        None => {
+            let mut data = CallData::new(func, arg, false);
+            let data_ptr: *mut CallData = &mut data;
+            queue_and_kick(cpu, data_ptr);
+            wait_for(data_ptr);
+        }
+    }
+}
+
+/// Run `func(arg)` on the current CPU with interrupts disabled
+fn run_local(func: CallFn, arg: usize) {
+    x86_64::instructions::interrupts::without_interrupts(|| func(arg));
+}
+
+/// Run `func(arg)` on `cpu`.
+///
+/// With `wait`, returns once the function has completed on the target.
+/// Calls targeting the current CPU run immediately.
+pub fn smp_call_function_single(
+    cpu: u16,
+    func: CallFn,
+    arg: usize,
+    wait: bool,
+) -> Result<(), &'static str> {
+    if cpu == current_cpu_id() {
+        run_local(func, arg);
+        return Ok(());
+    }
+    if !cpu_is_online(cpu as usize) {
+        return Err("Target CPU is not online");
+    }
+
+    if wait {
+        let mut data = CallData::new(func, arg, false);
+        let data_ptr: *mut CallData = &mut data;
+        queue_and_kick(cpu as usize, data_ptr);
+        wait_for(data_ptr);
+    } else {
+        queue_async(cpu as usize, func, arg);
+    }
+    Ok(())
+}
+
+/// Run `func(arg)` on every online CPU in `mask` except the current one.
+///
+/// All calls are queued before any is waited for, so the targets run in
+/// parallel. With `wait`, returns once every target has finished. Returns
+/// the number of CPUs the call was sent to.
+pub fn smp_call_function_many(mask: &CpuMask, func: CallFn, arg: usize, wait: bool) -> usize {
+    let this = current_cpu_id() as usize;
+    let total = cpu_count().min(MAX_CPUS);
+    let targets = (0..total).filter(|&cpu| cpu != this && mask.is_set(cpu) && cpu_is_online(cpu));
+
+    if !wait {
+        let mut sent = 0;
+        for cpu in targets {
+            queue_async(cpu, func, arg);
+            sent += 1;
+        }
+        return sent;
+    }
+
+    // Sized up front: the entries must not move once queued
+    let count = targets.clone().count();
+    let mut calls: Vec<CallData> = Vec::with_capacity(count);
+    for cpu in targets.take(count) {
+        calls.push(CallData::new(func, arg, false));
+        let data_ptr: *mut CallData = calls.last_mut().unwrap();
+        queue_and_kick(cpu, data_ptr);
+    }
+    for data in calls.iter() {
+        wait_for(data);
+    }
+    calls.len()
+}
+
+/// Run `func(arg)` on every other online CPU
+pub fn smp_call_function(func: CallFn, arg: usize, wait: bool) -> usize {
+    smp_call_function_many(&CpuMask::all(), func, arg, wait)
+}
+
+/// Run `func(arg)` on every online CPU, including the current one
+pub fn on_each_cpu(func: CallFn, arg: usize, wait: bool) {
+    smp_call_function(func, arg, wait);
+    run_local(func, arg);
+}
+
+/// Call statistics: (calls queued, IPIs sent, calls run)
+pub fn call_stats() -> (u64, u64, u64) {
+    (
+        CALLS_QUEUED.load(Ordering::Relaxed),
+        CALL_IPIS_SENT.load(Ordering::Relaxed),
+        CALLS_RUN.load(Ordering::Relaxed),
+    )
+}
@@ -84,3 +84,31 @@ pub fn send_ipi_broadcast(vector: u8) {
         }
     }
 }
+
+/// Check whether a CPU is online and can receive IPIs
+pub fn cpu_is_online(cpu_id: usize) -> bool {
+    if cpu_id == 0 {
+        return true;
+    }
+    if !SMP_READY.load(Ordering::Acquire) || cpu_id >= CPU_TOTAL.load(Ordering::Relaxed) {
+        return false;
+    }
+    unsafe {
+        let info = cpu_info(cpu_id);
+        CpuStatus::from_atomic(info.status.load(Ordering::Acquire)) == CpuStatus::Online
+    }
+}
+
+/// Send a function call IPI to a specific CPU.
+///
+/// Returns false if the CPU is not online (the IPI was not sent).
+pub fn send_call_function_ipi(cpu_id: u16) -> bool {
+    if !SMP_READY.load(Ordering::Acquire) || !cpu_is_online(cpu_id as usize) {
+        return false;
+    }
+    unsafe {
+        let info = cpu_info(cpu_id as usize);
+        lapic::send_ipi(info.apic_id, IPI_CALL_FUNCTION);
+    }
+    true
+}
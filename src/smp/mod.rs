@@ -22,6 +22,9 @@
 //! - `state`: Global atomic state variables
 //! - `cpu`: CPU management functions (current_cpu_id, cpu_count, etc.)
 //! - `ipi`: IPI vector constants and send functions
+//! - `call`: Cross-CPU function calls over per-CPU lock-free queues
+//! - `workqueue`: Per-CPU, unbound and delayed deferred work
+//! - `pool`: Fixed-capacity node pools usable from interrupt context
 //! - `trampoline`: AP trampoline installation and configuration
 //! - `ap_startup`: AP core startup logic
 //! - `init`: SMP subsystem initialization
@@ -29,12 +32,15 @@
 
 pub mod alloc;
 mod ap_startup;
+mod call;
 mod cpu;
 mod init;
 mod ipi;
+pub mod pool;
 mod state;
 mod trampoline;
 pub mod types;
+pub mod workqueue;
 
 // Re-export types
 pub use types::{
@@ -47,7 +53,16 @@ pub use types::{
 pub use ipi::{IPI_CALL_FUNCTION, IPI_HALT, IPI_RESCHEDULE, IPI_TLB_FLUSH};
 
 // Re-export IPI functions
-pub use ipi::{send_ipi_broadcast, send_reschedule_ipi, send_tlb_flush_ipi_all};
+pub use ipi::{
+    cpu_is_online, send_call_function_ipi, send_ipi_broadcast, send_reschedule_ipi,
+    send_tlb_flush_ipi_all,
+};
+
+// Re-export cross-CPU function calls
+pub use call::{
+    call_stats, flush_call_queue, on_each_cpu, smp_call_function, smp_call_function_many,
+    smp_call_function_single, CallFn,
+};
 
 // Re-export CPU functions
 pub use cpu::{
@@ -0,0 +1,77 @@
+//! Fixed-Capacity Node Pools
+//!
+//! Backing storage for the nodes of the lock-free call and work queues.
+//! The kernel heap lock does not disable interrupts, so IPI handlers and
+//! the timer tick must neither allocate nor free: an interrupt landing
+//! while the same CPU is inside the allocator would deadlock it.
+//!
+//! A pool is a static array of slots and an occupancy bitmap. Taking a
+//! slot sets its bit with `fetch_or`, returning it clears the bit, so both
+//! work from any context, and there is no free list to suffer from ABA.
+
+use core::cell::UnsafeCell;
+use core::mem::{size_of, MaybeUninit};
+use core::sync::atomic::{AtomicU64, Ordering};
+
+/// Pool of `64 * WORDS` values of `T` (not zero-sized: slots are told
+/// apart by address)
+pub struct SlotPool<T, const WORDS: usize> {
+    used: [AtomicU64; WORDS],
+    slots: [[UnsafeCell<MaybeUninit<T>>; 64]; WORDS],
+}
+
+// Each slot has exactly one owner at a time
+unsafe impl<T: Send, const WORDS: usize> Sync for SlotPool<T, WORDS> {}
+
+impl<T, const WORDS: usize> SlotPool<T, WORDS> {
+    pub const fn new() -> Self {
+        assert!(size_of::<T>() != 0, "SlotPool needs a sized element type");
+        Self {
+            used: [const { AtomicU64::new(0) }; WORDS],
+            slots: [const { [const { UnsafeCell::new(MaybeUninit::uninit()) }; 64] }; WORDS],
+        }
+    }
+
+    /// Move `value` into a free slot. Returns None when every slot is taken.
+    pub fn alloc(&self, value: T) -> Option<*mut T> {
+        for (w, word) in self.used.iter().enumerate() {
+            let mut current = word.load(Ordering::Relaxed);
+            while current != u64::MAX {
+                let bit = 1u64 << (!current).trailing_zeros();
+                let prev = word.fetch_or(bit, Ordering::Acquire);
+                if prev & bit == 0 {
+                    let slot = self.slots[w][bit.trailing_zeros() as usize].get() as *mut T;
+                    unsafe { slot.write(value) };
+                    return Some(slot);
+                }
+                // Another CPU took it first
+                current = prev | bit;
+            }
+        }
+        None
+    }
+
+    /// Drop the value in a slot and make the slot available again.
+    ///
+    /// # Safety
+    /// `ptr` must have come from `alloc()` on this pool, and must not be
+    /// used afterwards.
+    pub unsafe fn free(&self, ptr: *mut T) {
+        let base = self.slots.as_ptr() as usize;
+        let index = (ptr as usize - base) / size_of::<T>();
+        ptr.drop_in_place();
+        self.used[index / 64].fetch_and(!(1u64 << (index % 64)), Ordering::Release);
+    }
+
+    /// Number of slots currently taken
+    pub fn in_use(&self) -> usize {
+        self.used
+            .iter()
+            .map(|word| word.load(Ordering::Relaxed).count_ones() as usize)
+            .sum()
+    }
+
+    pub const fn capacity(&self) -> usize {
+        64 * WORDS
+    }
+}
@@ -0,0 +1,404 @@
+//! Kernel Workqueues
+//!
+//! Deferred work for code that cannot (or should not) do it inline:
+//! - **Per-CPU queues**: `queue_work_on()` runs work on a specific CPU
+//! - **Unbound pool**: `queue_work_unbound()` runs work on whichever CPU
+//!   gets to it first
+//! - **Delayed work**: `queue_delayed_work()` queues work once a delay expired
+//!
+//! There are no kernel threads, so the workers are the points where a CPU
+//! holds no locks:
+//! - The scheduler idle loop drains the queues before halting. Queuing work
+//!   on an idle remote CPU wakes it with a call-function IPI.
+//! - The timer tick runs pending work when it interrupted user mode, so
+//!   busy CPUs make progress too.
+//!
+//! Work runs with interrupts disabled and must not sleep. Work nodes come
+//! from a fixed pool rather than the heap, so queuing is allowed from any
+//! context, including interrupt handlers; it fails once `MAX_QUEUED_WORK`
+//! items are outstanding. Promotion of delayed work only relinks nodes.
+
+use core::ptr;
+use core::sync::atomic::{AtomicPtr, AtomicU64, Ordering};
+use spin::Mutex;
+
+use super::cpu::current_cpu_id;
+use super::ipi::{cpu_is_online, send_call_function_ipi};
+use super::pool::SlotPool;
+use super::types::MAX_CPUS;
+
+/// Maximum number of queued (including delayed) work items
+pub const MAX_QUEUED_WORK: usize = 256;
+
+/// Work function
+pub type WorkFn = fn(usize);
+
+/// One unit of deferred work
+#[derive(Clone, Copy)]
+pub struct Work {
+    pub func: WorkFn,
+    pub arg: usize,
+}
+
+/// Where a work item runs
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum WorkTarget {
+    /// On a specific CPU
+    Cpu(u16),
+    /// On any CPU
+    Unbound,
+}
+
+/// Queued work item
+struct WorkNode {
+    next: *mut WorkNode,
+    /// Deadline for delayed work (boot time in us)
+    due_us: u64,
+    target: WorkTarget,
+    work: Work,
+}
+
+// Nodes are owned by exactly one list at a time
+unsafe impl Send for WorkNode {}
+
+/// Lock-free work list (intrusive, LIFO) that can be pushed from any
+/// context, interrupt handlers included, without risking a self-deadlock.
+#[repr(C, align(64))]
+struct WorkList {
+    head: AtomicPtr<WorkNode>,
+}
+
+impl WorkList {
+    const fn new() -> Self {
+        Self {
+            head: AtomicPtr::new(ptr::null_mut()),
+        }
+    }
+
+    /// Push a node. Returns true if the list was empty.
+    fn push(&self, node: *mut WorkNode) -> bool {
+        let mut old = self.head.load(Ordering::Relaxed);
+        loop {
+            unsafe {
+                (*node).next = old;
+            }
+            match self
+                .head
+                .compare_exchange_weak(old, node, Ordering::Release, Ordering::Relaxed)
+            {
+                Ok(_) => return old.is_null(),
+                Err(current) => old = current,
+            }
+        }
+    }
+
+    fn is_empty(&self) -> bool {
+        self.head.load(Ordering::Acquire).is_null()
+    }
+
+    /// Detach every node as a chain, oldest first
+    fn take_all(&self) -> *mut WorkNode {
+        let mut list = self.head.swap(ptr::null_mut(), Ordering::Acquire);
+        let mut ordered = ptr::null_mut();
+        while !list.is_null() {
+            unsafe {
+                let next = (*list).next;
+                (*list).next = ordered;
+                ordered = list;
+                list = next;
+            }
+        }
+        ordered
+    }
+}
+
+/// Delayed work waiting for its deadline, as an intrusive unordered list
+struct DelayedList {
+    head: *mut WorkNode,
+}
+
+// Only reachable through `DELAYED_WORK`
+unsafe impl Send for DelayedList {}
+
+impl DelayedList {
+    /// Move a chain from `WorkList::take_all()` onto this list
+    fn splice(&mut self, mut chain: *mut WorkNode) {
+        while !chain.is_null() {
+            unsafe {
+                let next = (*chain).next;
+                (*chain).next = self.head;
+                self.head = chain;
+                chain = next;
+            }
+        }
+    }
+
+    /// Unlink every node matching `pred`, returning them as a chain
+    fn unlink(&mut self, mut pred: impl FnMut(&WorkNode) -> bool) -> *mut WorkNode {
+        let mut removed = ptr::null_mut();
+        let mut link: *mut *mut WorkNode = &mut self.head;
+        unsafe {
+            while !(*link).is_null() {
+                let node = *link;
+                if pred(&*node) {
+                    *link = (*node).next;
+                    (*node).next = removed;
+                    removed = node;
+                } else {
+                    link = &mut (*node).next;
+                }
+            }
+        }
+        removed
+    }
+}
+
+static WORK_POOL: SlotPool<WorkNode, { MAX_QUEUED_WORK / 64 }> = SlotPool::new();
+static PERCPU_WORK: [WorkList; MAX_CPUS] = [const { WorkList::new() }; MAX_CPUS];
+static UNBOUND_WORK: WorkList = WorkList::new();
+/// Newly queued delayed work, moved into `DELAYED_WORK` by the next promotion
+static DELAYED_INCOMING: WorkList = WorkList::new();
+/// Delayed work waiting for its deadline (only locked outside interrupt handlers
+/// or with try_lock)
+static DELAYED_WORK: Mutex<DelayedList> = Mutex::new(DelayedList {
+    head: ptr::null_mut(),
+});
+/// Earliest delayed-work deadline (u64::MAX if none), checked without locking
+static NEXT_DUE_US: AtomicU64 = AtomicU64::new(u64::MAX);
+
+// Statistics
+static WORK_QUEUED: AtomicU64 = AtomicU64::new(0);
+static WORK_RUN: AtomicU64 = AtomicU64::new(0);
+static DELAYED_FIRED: AtomicU64 = AtomicU64::new(0);
+static WORK_DROPPED: AtomicU64 = AtomicU64::new(0);
+
+fn work_node(target: WorkTarget, func: WorkFn, arg: usize, due_us: u64) -> Option<*mut WorkNode> {
+    let node = WORK_POOL.alloc(WorkNode {
+        next: ptr::null_mut(),
+        due_us,
+        target,
+        work: Work { func, arg },
+    });
+    if node.is_none() {
+        WORK_DROPPED.fetch_add(1, Ordering::Relaxed);
+    }
+    node
+}
+
+/// Push a node onto the queue of its target, waking the target CPU if
+/// needed. Returns false, leaving the node with the caller, if the target
+/// CPU is not online.
+fn enqueue(node: *mut WorkNode) -> bool {
+    match unsafe { (*node).target } {
+        WorkTarget::Cpu(cpu) => {
+            let cpu_idx = cpu as usize;
+            if cpu_idx >= MAX_CPUS || !cpu_is_online(cpu_idx) {
+                return false;
+            }
+            let was_empty = PERCPU_WORK[cpu_idx].push(node);
+            WORK_QUEUED.fetch_add(1, Ordering::Relaxed);
+
+            // Wake the target if it is halted in the idle loop
+            if was_empty && cpu != current_cpu_id() {
+                send_call_function_ipi(cpu);
+            }
+        }
+        WorkTarget::Unbound => {
+            UNBOUND_WORK.push(node);
+            WORK_QUEUED.fetch_add(1, Ordering::Relaxed);
+        }
+    }
+    true
+}
+
+/// Queue work on a specific CPU.
+///
+/// Returns false if the CPU is not online or the work pool is exhausted.
+pub fn queue_work_on(cpu: u16, func: WorkFn, arg: usize) -> bool {
+    let cpu_idx = cpu as usize;
+    if cpu_idx >= MAX_CPUS || !cpu_is_online(cpu_idx) {
+        return false;
+    }
+    let Some(node) = work_node(WorkTarget::Cpu(cpu), func, arg, 0) else {
+        return false;
+    };
+    if !enqueue(node) {
+        // Went offline in the meantime
+        unsafe { WORK_POOL.free(node) };
+        return false;
+    }
+    true
+}
+
+/// Queue work on the current CPU
+pub fn queue_work(func: WorkFn, arg: usize) -> bool {
+    queue_work_on(current_cpu_id(), func, arg)
+}
+
+/// Queue work on the unbound pool.
+///
+/// Returns false if the work pool is exhausted.
+pub fn queue_work_unbound(func: WorkFn, arg: usize) -> bool {
+    match work_node(WorkTarget::Unbound, func, arg, 0) {
+        Some(node) => enqueue(node),
+        None => false,
+    }
+}
+
+/// Queue work once `delay_ms` milliseconds have passed.
+///
+/// Returns false if the work pool is exhausted.
+pub fn queue_delayed_work(target: WorkTarget, func: WorkFn, arg: usize, delay_ms: u64) -> bool {
+    let due_us = crate::logger::boot_time_us().saturating_add(delay_ms.saturating_mul(1000));
+    let Some(node) = work_node(target, func, arg, due_us) else {
+        return false;
+    };
+    DELAYED_INCOMING.push(node);
+    NEXT_DUE_US.fetch_min(due_us, Ordering::AcqRel);
+    true
+}
+
+/// Cancel pending delayed work matching `func`/`arg`.
+///
+/// Must not be called from interrupt context. Returns the number of items
+/// cancelled.
+pub fn cancel_delayed_work(func: WorkFn, arg: usize) -> usize {
+    let mut delayed = DELAYED_WORK.lock();
+    delayed.splice(DELAYED_INCOMING.take_all());
+    let mut cancelled =
+        delayed.unlink(|d| d.work.func as usize == func as usize && d.work.arg == arg);
+    drop(delayed);
+
+    let mut count = 0;
+    while !cancelled.is_null() {
+        unsafe {
+            let next = (*cancelled).next;
+            WORK_POOL.free(cancelled);
+            cancelled = next;
+        }
+        count += 1;
+    }
+    count
+}
+
+/// Move expired delayed work onto its queue.
+///
+/// Runs from the timer tick, so it only relinks nodes: nothing is allocated
+/// or freed.
+fn promote_delayed_work(now_us: u64) {
+    if NEXT_DUE_US.load(Ordering::Acquire) > now_us {
+        return;
+    }
+    // Another CPU is already promoting; it will catch up
+    let Some(mut delayed) = DELAYED_WORK.try_lock() else {
+        return;
+    };
+
+    // Clear the hint first: work queued from now on lowers it again
+    NEXT_DUE_US.store(u64::MAX, Ordering::Release);
+    delayed.splice(DELAYED_INCOMING.take_all());
+
+    let mut expired = delayed.unlink(|d| d.due_us <= now_us);
+    let mut next_due = u64::MAX;
+    let mut node = delayed.head;
+    while !node.is_null() {
+        unsafe {
+            next_due = next_due.min((*node).due_us);
+            node = (*node).next;
+        }
+    }
+    NEXT_DUE_US.fetch_min(next_due, Ordering::AcqRel);
+    drop(delayed);
+
+    // Insertion-sort by deadline; ties keep their unlink order
+    let mut sorted: *mut WorkNode = ptr::null_mut();
+    while !expired.is_null() {
+        unsafe {
+            let node = expired;
+            expired = (*node).next;
+            let mut link: *mut *mut WorkNode = &mut sorted;
+            while !(*link).is_null() && (**link).due_us <= (*node).due_us {
+                link = &mut (**link).next;
+            }
+            (*node).next = *link;
+            *link = node;
+        }
+    }
+
+    while !sorted.is_null() {
+        let node = sorted;
+        unsafe {
+            sorted = (*node).next;
+            if !enqueue(node) {
+                // Offline targets fall back to the unbound pool
+                (*node).target = WorkTarget::Unbound;
+                enqueue(node);
+            }
+        }
+        DELAYED_FIRED.fetch_add(1, Ordering::Relaxed);
+    }
+}
+
+/// Run the work pending for the current CPU.
+///
+/// Per-CPU work goes first, then whatever is in the unbound pool. Work
+/// queued while running is left for the next call. Returns the number of
+/// items run.
+pub fn run_pending() -> usize {
+    promote_delayed_work(crate::logger::boot_time_us());
+
+    let cpu = current_cpu_id() as usize;
+    let mut ran = 0;
+    for list in [&PERCPU_WORK[cpu], &UNBOUND_WORK] {
+        if list.is_empty() {
+            continue;
+        }
+        let mut node = list.take_all();
+        while !node.is_null() {
+            // Free the node first so the work can queue more work
+            let work = unsafe {
+                let work = (*node).work;
+                let next = (*node).next;
+                WORK_POOL.free(node);
+                node = next;
+                work
+            };
+            (work.func)(work.arg);
+            ran += 1;
+        }
+    }
+    if ran > 0 {
+        WORK_RUN.fetch_add(ran as u64, Ordering::Relaxed);
+    }
+    ran
+}
+
+/// Check whether the current CPU has work it could run
+pub fn has_pending() -> bool {
+    let cpu = current_cpu_id() as usize;
+    !PERCPU_WORK[cpu].is_empty()
+        || !UNBOUND_WORK.is_empty()
+        || NEXT_DUE_US.load(Ordering::Acquire) <= crate::logger::boot_time_us()
+}
+
+/// Timer tick hook. Only runs work when the tick interrupted user mode,
+/// where no kernel locks can be held; otherwise it just promotes expired
+/// delayed work so the idle loop or the next user-mode tick picks it up.
+pub fn tick(from_user: bool) {
+    if from_user {
+        run_pending();
+    } else {
+        promote_delayed_work(crate::logger::boot_time_us());
+    }
+}
+
+/// Workqueue statistics: (queued, run, delayed fired, dropped with the pool
+/// exhausted)
+pub fn workqueue_stats() -> (u64, u64, u64, u64) {
+    (
+        WORK_QUEUED.load(Ordering::Relaxed),
+        WORK_RUN.load(Ordering::Relaxed),
+        DELAYED_FIRED.load(Ordering::Relaxed),
+        WORK_DROPPED.load(Ordering::Relaxed),
+    )
+}
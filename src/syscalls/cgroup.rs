@@ -0,0 +1,149 @@
+//! Control group syscall
+//!
+//! NexaOS has no cgroup filesystem to write to, so groups are managed with
+//! SYS_CGROUP_CTL and exposed read-only under /sys/fs/cgroup.
+
+use super::types::user_buffer_in_range;
+use crate::posix;
+use crate::scheduler::cgroup::{self, CgroupError, CgroupId, CgroupStat, CGROUP_PATH_MAX};
+use core::mem::size_of;
+
+/// Copy a NUL-terminated group path from userspace
+fn copy_user_path(ptr: u64, buf: &mut [u8; CGROUP_PATH_MAX + 2]) -> Result<&str, CgroupError> {
+    if ptr == 0 {
+        return Err(CgroupError::Invalid);
+    }
+    for len in 0..buf.len() {
+        if !user_buffer_in_range(ptr + len as u64, 1) {
+            return Err(CgroupError::Invalid);
+        }
+        let byte = unsafe { ((ptr + len as u64) as *const u8).read() };
+        if byte == 0 {
+            return core::str::from_utf8(&buf[..len]).map_err(|_| CgroupError::Invalid);
+        }
+        buf[len] = byte;
+    }
+    Err(CgroupError::Invalid)
+}
+
+fn to_id(arg: u64) -> Result<CgroupId, CgroupError> {
+    CgroupId::try_from(arg).map_err(|_| CgroupError::NotFound)
+}
+
+/// SYS_CGROUP_CTL - Control group management
+///
+/// # Arguments
+/// * `cmd` - Command
+/// * `arg1` - Group id, or a path pointer for CREATE/LOOKUP, or a pid for GET
+/// * `arg2` - Command-specific value
+///
+/// # Commands
+/// - 0: CREATE - Create group `arg1` (path), returns its id (requires root)
+/// - 1: LOOKUP - Id of group `arg1` (path)
+/// - 2: DESTROY - Remove empty group `arg1` (requires root)
+/// - 3: ATTACH - Move process `arg2` (0 = caller) into group `arg1`
+/// - 4: SET_CPU_WEIGHT - cpu.weight (1-10000)
+/// - 5: SET_CPU_QUOTA - cpu.max quota in us per period (u64::MAX = max)
+/// - 6: SET_CPU_PERIOD - cpu.max period in us
+/// - 7: SET_MEMORY_MAX - memory.max in bytes (u64::MAX = max)
+/// - 8: SET_MEMORY_HIGH - memory.high in bytes (u64::MAX = max)
+/// - 9: SET_IO_WEIGHT - io.weight (1-10000)
+/// - 10: GET_STAT - Copy a `CgroupStat` to `arg2`
+/// - 11: GET - Group of process `arg1` (0 = caller)
+///
+/// Every command that changes a group or moves another process requires root.
+///
+/// # Returns
+/// Command-dependent value, or u64::MAX on error
+pub fn cgroup_ctl(cmd: u64, arg1: u64, arg2: u64) -> u64 {
+    const CMD_CREATE: u64 = 0;
+    const CMD_LOOKUP: u64 = 1;
+    const CMD_DESTROY: u64 = 2;
+    const CMD_ATTACH: u64 = 3;
+    const CMD_SET_CPU_WEIGHT: u64 = 4;
+    const CMD_SET_CPU_QUOTA: u64 = 5;
+    const CMD_SET_CPU_PERIOD: u64 = 6;
+    const CMD_SET_MEMORY_MAX: u64 = 7;
+    const CMD_SET_MEMORY_HIGH: u64 = 8;
+    const CMD_SET_IO_WEIGHT: u64 = 9;
+    const CMD_GET_STAT: u64 = 10;
+    const CMD_GET: u64 = 11;
+
+    let caller = crate::scheduler::current_pid().unwrap_or(0);
+    let privileged = match cmd {
+        CMD_LOOKUP | CMD_GET_STAT | CMD_GET => false,
+        // Joining a group yourself is allowed; it cannot raise any limit
+        CMD_ATTACH => arg2 != 0 && arg2 != caller,
+        _ => true,
+    };
+    if privileged && !crate::auth::is_superuser() {
+        crate::kwarn!("[cgroup] cmd {}: permission denied", cmd);
+        posix::set_errno(posix::errno::EPERM);
+        return u64::MAX;
+    }
+
+    let mut path_buf = [0u8; CGROUP_PATH_MAX + 2];
+    let result = match cmd {
+        CMD_CREATE => copy_user_path(arg1, &mut path_buf)
+            .and_then(cgroup::create)
+            .map(u64::from),
+        CMD_LOOKUP => copy_user_path(arg1, &mut path_buf)
+            .and_then(cgroup::lookup)
+            .map(u64::from),
+        CMD_DESTROY => to_id(arg1).and_then(cgroup::destroy).map(|()| 0),
+        CMD_ATTACH => {
+            let pid = if arg2 == 0 { caller } else { arg2 };
+            to_id(arg1)
+                .and_then(|id| cgroup::attach(pid, id))
+                .map(|()| 0)
+        }
+        CMD_SET_CPU_WEIGHT => to_id(arg1)
+            .and_then(|id| cgroup::set_cpu_weight(id, arg2))
+            .map(|()| 0),
+        CMD_SET_CPU_QUOTA => to_id(arg1)
+            .and_then(|id| cgroup::set_cpu_quota(id, arg2))
+            .map(|()| 0),
+        CMD_SET_CPU_PERIOD => to_id(arg1)
+            .and_then(|id| cgroup::set_cpu_period(id, arg2))
+            .map(|()| 0),
+        CMD_SET_MEMORY_MAX => to_id(arg1)
+            .and_then(|id| cgroup::set_memory_max(id, arg2))
+            .map(|()| 0),
+        CMD_SET_MEMORY_HIGH => to_id(arg1)
+            .and_then(|id| cgroup::set_memory_high(id, arg2))
+            .map(|()| 0),
+        CMD_SET_IO_WEIGHT => to_id(arg1)
+            .and_then(|id| cgroup::set_io_weight(id, arg2))
+            .map(|()| 0),
+        CMD_GET_STAT => {
+            if arg2 == 0 || !user_buffer_in_range(arg2, size_of::<CgroupStat>() as u64) {
+                posix::set_errno(posix::errno::EFAULT);
+                return u64::MAX;
+            }
+            to_id(arg1)
+                .and_then(|id| cgroup::stat(id).ok_or(CgroupError::NotFound))
+                .map(|stat| {
+                    unsafe { core::ptr::write(arg2 as *mut CgroupStat, stat) };
+                    0
+                })
+        }
+        CMD_GET => {
+            let pid = if arg1 == 0 { caller } else { arg1 };
+            cgroup::cgroup_of(pid)
+                .map(u64::from)
+                .ok_or(CgroupError::NotFound)
+        }
+        _ => Err(CgroupError::Invalid),
+    };
+
+    match result {
+        Ok(value) => {
+            posix::set_errno(0);
+            value
+        }
+        Err(e) => {
+            posix::set_errno(e.errno());
+            u64::MAX
+        }
+    }
+}
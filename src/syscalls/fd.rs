@@ -18,6 +18,9 @@ pub fn dup(oldfd: u64) -> u64 {
     match allocate_duplicate_slot(FD_BASE, handle) {
         Ok(fd) => {
             super::file::mark_fd_open(fd); // Track the new FD as open
+            if let FileBacking::Seq(id) = handle.backing {
+                crate::fs::seq_file::dup(id);
+            }
             posix::set_errno(0);
             fd
         }
@@ -56,9 +59,15 @@ pub fn dup2(oldfd: u64, newfd: u64) -> u64 {
 
     unsafe {
         // If newfd was open, it should be implicitly closed
-        if FILE_HANDLES[idx].is_some() {
+        if let Some(old) = FILE_HANDLES[idx].as_ref() {
+            if let FileBacking::Seq(id) = old.backing {
+                crate::fs::seq_file::release(id);
+            }
             super::file::mark_fd_closed(newfd);
         }
+        if let FileBacking::Seq(id) = handle.backing {
+            crate::fs::seq_file::dup(id);
+        }
         FILE_HANDLES[idx] = Some(handle);
         super::file::mark_fd_open(newfd); // Track newfd as open
     }
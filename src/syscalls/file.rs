@@ -423,8 +423,8 @@ pub fn write(fd: u64, buf: u64, count: u64) -> u64 {
                         }
                     }
                 }
-                FileBacking::Inline(_) => {
-                    // Inline files (from initramfs) are read-only
+                FileBacking::Inline(_) | FileBacking::Seq(_) => {
+                    // Inline files (from initramfs) and generated files are read-only
                     ktrace!("[SYS_WRITE] ERROR: Inline file is read-only");
                     posix::set_errno(posix::errno::EROFS);
                     return u64::MAX;
@@ -638,8 +638,8 @@ pub fn pwrite64(fd: u64, buf: u64, count: u64, offset: i64) -> u64 {
                         }
                     }
                 }
-                FileBacking::Inline(_) => {
-                    // Inline files (from initramfs) are read-only
+                FileBacking::Inline(_) | FileBacking::Seq(_) => {
+                    // Inline files (from initramfs) and generated files are read-only
                     posix::set_errno(posix::errno::EROFS);
                     return u64::MAX;
                 }
@@ -791,6 +791,12 @@ pub fn pread64(fd: u64, buf: *mut u8, count: usize, offset: i64) -> u64 {
                     posix::set_errno(0);
                     return to_read as u64;
                 }
+                FileBacking::Seq(id) => {
+                    let buffer = core::slice::from_raw_parts_mut(buf, count);
+                    let bytes_read = crate::fs::seq_file::read_at(id, offset as usize, buffer);
+                    posix::set_errno(0);
+                    return bytes_read as u64;
+                }
                 FileBacking::DevRandom | FileBacking::DevUrandom => {
                     let buffer = core::slice::from_raw_parts_mut(buf, count);
                     crate::drivers::dev_random_read(buffer);
@@ -1220,6 +1226,13 @@ pub fn read(fd: u64, buf: *mut u8, count: usize) -> u64 {
                     posix::set_errno(0);
                     return to_copy as u64;
                 }
+                FileBacking::Seq(id) => {
+                    let buffer = slice::from_raw_parts_mut(buf, count);
+                    let bytes_read = crate::fs::seq_file::read_at(id, handle.position, buffer);
+                    update_file_handle_position(idx, handle.position + bytes_read);
+                    posix::set_errno(0);
+                    return bytes_read as u64;
+                }
                 FileBacking::Modular(file_handle) => {
                     let total = handle.metadata.size as usize;
                     if handle.position >= total {
@@ -1783,6 +1796,13 @@ pub fn open(path_ptr: *const u8, flags: u64, mode: u64) -> u64 {
                     FileBacking::Inline(data)
                 }
             }
+            crate::fs::FileContent::Seq(source) => match crate::fs::seq_file::open(source) {
+                Some(id) => FileBacking::Seq(id),
+                None => {
+                    posix::set_errno(posix::errno::ENFILE);
+                    return u64::MAX;
+                }
+            },
             crate::fs::FileContent::Modular(handle) => FileBacking::Modular(handle),
             #[allow(deprecated)]
             crate::fs::FileContent::Ext2Modular(file_ref) => {
@@ -1827,6 +1847,9 @@ pub fn open(path_ptr: *const u8, flags: u64, mode: u64) -> u64 {
                 return fd;
             }
         }
+        if let FileBacking::Seq(id) = backing {
+            crate::fs::seq_file::release(id);
+        }
         posix::set_errno(posix::errno::EMFILE);
         kwarn!("No free file handles available");
         return u64::MAX;
@@ -1854,6 +1877,13 @@ pub fn open(path_ptr: *const u8, flags: u64, mode: u64) -> u64 {
             let backing = match content {
                 crate::fs::FileContent::Inline(data) => FileBacking::Inline(data),
                 crate::fs::FileContent::Modular(handle) => FileBacking::Modular(handle),
+                crate::fs::FileContent::Seq(source) => match crate::fs::seq_file::open(source) {
+                    Some(id) => FileBacking::Seq(id),
+                    None => {
+                        posix::set_errno(posix::errno::ENFILE);
+                        return u64::MAX;
+                    }
+                },
                 #[allow(deprecated)]
                 crate::fs::FileContent::Ext2Modular(file_ref) => {
                     // Convert legacy ext2 handle to modular handle
@@ -1889,6 +1919,9 @@ pub fn open(path_ptr: *const u8, flags: u64, mode: u64) -> u64 {
                     return fd;
                 }
             }
+            if let FileBacking::Seq(id) = backing {
+                crate::fs::seq_file::release(id);
+            }
             posix::set_errno(posix::errno::EMFILE);
             kwarn!("No free file handles available");
             return u64::MAX;
@@ -1985,6 +2018,8 @@ pub fn close(fd: u64) -> u64 {
                 crate::tty::pty::close_master(id as usize);
             } else if let FileBacking::PtySlave(id) = handle.backing {
                 crate::tty::pty::close_slave(id as usize);
+            } else if let FileBacking::Seq(id) = handle.backing {
+                crate::fs::seq_file::release(id);
             }
 
             clear_file_handle(idx);
@@ -2179,6 +2214,7 @@ fn build_fd_link_target(fd: u64) -> Option<String> {
             alloc::format!("socketpair:[{}]:{}", pair.pair_id, pair.end)
         }
         FileBacking::Inline(_) => String::from("initramfs"),
+        FileBacking::Seq(id) => alloc::format!("seq_file:[{}]", id),
         FileBacking::Modular(m) => alloc::format!("modfs:{}:inode:{}", m.fs_index, m.inode),
         #[allow(deprecated)]
         FileBacking::Ext2(_) => String::from("ext2"),
@@ -2497,6 +2533,10 @@ pub fn close_all_fds_for_process(open_fds: u16) {
                             fd
                         );
                     }
+                    // Free the seq_file slot of a /proc or /sys file
+                    else if let FileBacking::Seq(id) = handle.backing {
+                        crate::fs::seq_file::release(id);
+                    }
 
                     clear_file_handle(bit);
                     kinfo!("Auto-closed fd {} during process cleanup", fd);
@@ -2560,6 +2600,7 @@ pub fn get_file_path(fd: u64) -> Option<alloc::string::String> {
             FileBacking::Socket(sock) => format!("socket:[{}]", sock.socket_index),
             FileBacking::Socketpair(pair) => format!("socketpair:[{}]:{}", pair.pair_id, pair.end),
             FileBacking::Inline(_) => String::from("initramfs"),
+            FileBacking::Seq(id) => alloc::format!("seq_file:[{}]", id),
             FileBacking::Modular(m) => format!("modfs:{}:inode:{}", m.fs_index, m.inode),
             #[allow(deprecated)]
             FileBacking::Ext2(_) => String::from("ext2"),
@@ -2620,6 +2661,7 @@ pub fn pread_internal(fd: u64, buf: &mut [u8], offset: i64) -> Result<usize, i32
                         .copy_from_slice(&data[offset as usize..offset as usize + to_read]);
                     Ok(to_read)
                 }
+                FileBacking::Seq(id) => Ok(crate::fs::seq_file::read_at(id, offset as usize, buf)),
                 FileBacking::DevRandom | FileBacking::DevUrandom => {
                     crate::drivers::dev_random_read(buf);
                     Ok(buf.len())
@@ -2691,7 +2733,7 @@ pub fn pwrite_internal(fd: u64, buf: &[u8], offset: i64) -> Result<usize, i32> {
                         Err(_) => Err(posix::errno::EIO),
                     }
                 }
-                FileBacking::Inline(_) => Err(posix::errno::EROFS),
+                FileBacking::Inline(_) | FileBacking::Seq(_) => Err(posix::errno::EROFS),
                 FileBacking::DevRandom | FileBacking::DevUrandom => {
                     crate::drivers::dev_random_write(buf);
                     Ok(buf.len())
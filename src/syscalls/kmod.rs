@@ -45,6 +45,17 @@ pub struct ModuleListEntry {
     pub signed: u8,
     /// Taints kernel (0=no, 1=yes)
     pub taints: u8,
+    /// Total load time in microseconds (verify + link + init)
+    pub load_us: u32,
+    /// Reserved
+    pub _reserved: u32,
+}
+
+/// Convert TSC cycles to microseconds, saturating at u32::MAX
+fn cycles_to_us(cycles: u64) -> u32 {
+    let freq = crate::logger::tsc_frequency_hz().max(1);
+    let us = (cycles as u128 * 1_000_000 / freq as u128) as u64;
+    us.min(u32::MAX as u64) as u32
 }
 
 impl ModuleListEntry {
@@ -74,6 +85,8 @@ impl ModuleListEntry {
                 crate::kmod::SignatureStatus::UnknownFormat => 2,
             },
             taints: if info.taints_kernel { 1 } else { 0 },
+            load_us: cycles_to_us(info.verify_cycles + info.link_cycles + info.init_cycles),
+            _reserved: 0,
         };
         let name_bytes = info.name.as_bytes();
         let copy_len = name_bytes.len().min(31);
@@ -116,6 +129,12 @@ pub struct ModuleDetailedInfo {
     pub signed: u8,
     /// Taints kernel
     pub taints: u8,
+    /// Load time breakdown (microseconds): signature verification
+    pub verify_us: u32,
+    /// Load time breakdown (microseconds): allocation, relocation and linking
+    pub link_us: u32,
+    /// Load time breakdown (microseconds): module init function
+    pub init_us: u32,
 }
 
 impl ModuleDetailedInfo {
@@ -153,6 +172,9 @@ impl ModuleDetailedInfo {
                 crate::kmod::SignatureStatus::UnknownFormat => 2,
             },
             taints: if info.taints_kernel { 1 } else { 0 },
+            verify_us: cycles_to_us(info.verify_cycles),
+            link_us: cycles_to_us(info.link_cycles),
+            init_us: cycles_to_us(info.init_cycles),
         };
 
         // Copy strings
@@ -198,6 +220,10 @@ pub struct ModuleStatistics {
     pub _reserved: [u8; 3],
     /// Taint string (null-terminated)
     pub taint_string: [u8; 32],
+    /// Module signature checks answered from the verified-digest cache
+    pub sig_cache_hits: u32,
+    /// Module signature checks that needed a full verification
+    pub sig_cache_misses: u32,
 }
 
 /// Module dependency entry
@@ -547,6 +573,7 @@ fn query_module_stats(buf_ptr: *mut u8, buf_size: usize) -> u64 {
     let kstats = crate::kmod::get_module_stats();
     let taint_str = crate::kmod::get_taint_string();
     let symbol_stats = crate::kmod::symbols::get_symbol_stats();
+    let (cache_hits, cache_misses, _) = crate::kmod::pkcs7::verified_cache_stats();
 
     let out = unsafe { &mut *(buf_ptr as *mut ModuleStatistics) };
     *out = ModuleStatistics {
@@ -561,6 +588,8 @@ fn query_module_stats(buf_ptr: *mut u8, buf_size: usize) -> u64 {
         is_tainted: if crate::kmod::get_taint() != 0 { 1 } else { 0 },
         _reserved: [0; 3],
         taint_string: [0; 32],
+        sig_cache_hits: cache_hits as u32,
+        sig_cache_misses: cache_misses as u32,
     };
 
     // Copy taint string
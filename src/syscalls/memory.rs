@@ -3,6 +3,8 @@
 //! Implements: mmap, munmap, mprotect, brk
 
 use crate::posix::{self, errno};
+use crate::process::Pid;
+use crate::scheduler::cgroup;
 use crate::{kdebug, kerror, kinfo, ktrace, kwarn};
 
 /// MMAP protection flags (POSIX)
@@ -34,6 +36,8 @@ struct MmapRegion {
     size: u64,
     prot: u64,
     flags: u64,
+    /// Thread group the mapping belongs to and is charged to
+    owner: Pid,
     in_use: bool,
 }
 
@@ -44,6 +48,7 @@ impl MmapRegion {
             size: 0,
             prot: 0,
             flags: 0,
+            owner: 0,
             in_use: false,
         }
     }
@@ -145,11 +150,28 @@ pub fn mmap(addr: u64, length: u64, prot: u64, flags: u64, fd: i64, offset: u64)
         return MAP_FAILED;
     }
 
-    // Record the mapping
-    if !record_mmap_region(map_addr, aligned_length, prot, flags) {
-        kerror!("[mmap] Failed to record mapping region");
-        posix::set_errno(errno::ENOMEM);
-        return MAP_FAILED;
+    let owner = current_tgid();
+    let replaces_existing =
+        (flags & MAP_FIXED) != 0 && within_mmap_region(owner, map_addr, aligned_length);
+
+    if !replaces_existing {
+        // Charge the mapping to the caller's cgroup before populating it
+        if let Err(e) = cgroup::charge_current_memory(aligned_length) {
+            kwarn!(
+                "[mmap] cgroup memory.max reached, refusing {:#x} bytes",
+                aligned_length
+            );
+            posix::set_errno(e.errno());
+            return MAP_FAILED;
+        }
+
+        // Record the mapping
+        if !record_mmap_region(map_addr, aligned_length, prot, flags, owner) {
+            kerror!("[mmap] Failed to record mapping region");
+            cgroup::uncharge_current_memory(aligned_length);
+            posix::set_errno(errno::ENOMEM);
+            return MAP_FAILED;
+        }
     }
 
     // Handle the mapping based on whether it's anonymous or file-backed
@@ -166,11 +188,21 @@ pub fn mmap(addr: u64, length: u64, prot: u64, flags: u64, fd: i64, offset: u64)
             offset
         );
 
-        // Read file contents into the mapped region
+        // Read file contents into the mapped region. Nothing is paged in
+        // lazily, so a mapping that could not be filled must not succeed:
+        // callers such as the dynamic linker would run zeroed code.
         if let Err(e) = read_file_into_mapping(fd as u64, offset, map_addr, aligned_length) {
-            kerror!("[mmap] Failed to read file into mapping: {}", e);
-            // Still return success - the mapping exists, just empty
-            // In a real implementation, we'd handle page faults lazily
+            kerror!(
+                "[mmap] Failed to read fd {} into mapping at {:#x}: errno {}",
+                fd,
+                map_addr,
+                e
+            );
+            if !replaces_existing {
+                munmap(map_addr, aligned_length);
+            }
+            posix::set_errno(e);
+            return MAP_FAILED;
         }
     } else {
         // Anonymous mapping with invalid fd - just zero the memory
@@ -198,29 +230,28 @@ pub fn mmap(addr: u64, length: u64, prot: u64, flags: u64, fd: i64, offset: u64)
 /// * `offset` - Offset in file to start reading
 /// * `dest_addr` - Destination address in memory
 /// * `length` - Number of bytes to read
-fn read_file_into_mapping(
-    fd: u64,
-    offset: u64,
-    dest_addr: u64,
-    length: u64,
-) -> Result<usize, &'static str> {
+///
+/// Bytes past the end of the file are zeroed. Fails with an errno if the
+/// descriptor cannot be mapped or the file yields fewer bytes than its
+/// size promises.
+fn read_file_into_mapping(fd: u64, offset: u64, dest_addr: u64, length: u64) -> Result<usize, i32> {
     use super::types::{get_file_handle, FileBacking, FD_BASE, MAX_OPEN_FILES};
 
     // Validate file descriptor
     if fd < FD_BASE {
-        return Err("Invalid file descriptor");
+        return Err(errno::EBADF);
     }
 
     let idx = (fd - FD_BASE) as usize;
     if idx >= MAX_OPEN_FILES {
-        return Err("Invalid file descriptor");
+        return Err(errno::EBADF);
     }
 
     // Get file handle and read content
     unsafe {
         let handle = match get_file_handle(idx) {
             Some(h) => h,
-            None => return Err("File not open"),
+            None => return Err(errno::EBADF),
         };
 
         // Determine file size
@@ -244,6 +275,9 @@ fn read_file_into_mapping(
                 let end = (read_start as usize + to_read).min(data.len());
                 if start < data.len() {
                     let copy_len = end - start;
+                    if copy_len < to_read {
+                        return Err(errno::EIO);
+                    }
                     core::ptr::copy_nonoverlapping(
                         data[start..].as_ptr(),
                         dest_addr as *mut u8,
@@ -264,6 +298,9 @@ fn read_file_into_mapping(
                 // Read from ext2 file
                 let dest_slice = core::slice::from_raw_parts_mut(dest_addr as *mut u8, to_read);
                 let bytes_read = file_ref.read_at(read_start as usize, dest_slice);
+                if bytes_read < to_read {
+                    return Err(errno::EIO);
+                }
 
                 // Zero remaining
                 if bytes_read < length as usize {
@@ -275,19 +312,55 @@ fn read_file_into_mapping(
                 }
                 return Ok(bytes_read);
             }
+            FileBacking::Modular(file_handle) => {
+                let bytes_read =
+                    read_modular_into(file_handle, read_start as usize, dest_addr, to_read);
+                if bytes_read < to_read {
+                    return Err(errno::EIO);
+                }
+                if bytes_read < length as usize {
+                    core::ptr::write_bytes(
+                        (dest_addr + bytes_read as u64) as *mut u8,
+                        0,
+                        length as usize - bytes_read,
+                    );
+                }
+                return Ok(bytes_read);
+            }
             _ => {
                 // Other backing types (sockets, etc.) - just zero the memory
                 core::ptr::write_bytes(dest_addr as *mut u8, 0, length as usize);
-                return Err("Unsupported file backing type for mmap");
+                return Err(errno::ENODEV);
             }
         }
     }
 
-    // Zero the memory if we couldn't read
-    unsafe {
-        core::ptr::write_bytes(dest_addr as *mut u8, 0, length as usize);
+    // Inline data shorter than the size the handle reports
+    Err(errno::EIO)
+}
+
+/// Copy `len` bytes at `offset` of a modular-filesystem file to `dest_addr`
+///
+/// Reads straight into the destination, the same way read(2) does.
+/// Returns the number of bytes copied; a short count means EOF or an I/O
+/// error.
+pub(super) fn read_modular_into(
+    file: &crate::fs::ModularFileHandle,
+    offset: usize,
+    dest_addr: u64,
+    len: usize,
+) -> usize {
+    let mut done = 0usize;
+    while done < len {
+        let dest = unsafe {
+            core::slice::from_raw_parts_mut((dest_addr + done as u64) as *mut u8, len - done)
+        };
+        match crate::fs::modular_fs_read_at(file, offset + done, dest) {
+            Ok(0) | Err(_) => break,
+            Ok(n) => done += n,
+        }
     }
-    Ok(0)
+    done
 }
 
 /// Allocate a new mmap address using bump allocator
@@ -339,8 +412,32 @@ fn can_map_at(addr: u64, _size: u64) -> bool {
     addr >= USER_VIRT_BASE && addr < user_end
 }
 
+/// Whether `[start, start + size)` lies inside one mapping of `owner`
+///
+/// MAP_FIXED over part of an existing mapping (how loaders place segments
+/// inside a reserved span) only replaces its contents; it must not be
+/// recorded or charged a second time. The table is shared by all processes,
+/// so only the caller's own mappings count.
+fn within_mmap_region(owner: Pid, start: u64, size: u64) -> bool {
+    unsafe {
+        MMAP_REGIONS.iter().any(|region| {
+            region.in_use
+                && region.owner == owner
+                && region.start <= start
+                && start + size <= region.start + region.size
+        })
+    }
+}
+
+/// Thread group of the calling process (0 if none)
+fn current_tgid() -> Pid {
+    crate::scheduler::current_pid()
+        .and_then(crate::scheduler::get_tgid)
+        .unwrap_or(0)
+}
+
 /// Record an mmap region in the tracking table
-fn record_mmap_region(start: u64, size: u64, prot: u64, flags: u64) -> bool {
+fn record_mmap_region(start: u64, size: u64, prot: u64, flags: u64, owner: Pid) -> bool {
     unsafe {
         for region in MMAP_REGIONS.iter_mut() {
             if !region.in_use {
@@ -349,6 +446,7 @@ fn record_mmap_region(start: u64, size: u64, prot: u64, flags: u64) -> bool {
                     size,
                     prot,
                     flags,
+                    owner,
                     in_use: true,
                 };
                 return true;
@@ -386,12 +484,15 @@ pub fn munmap(addr: u64, length: u64) -> u64 {
 
     let aligned_length = (length + PAGE_SIZE - 1) & !(PAGE_SIZE - 1);
 
-    // Find and remove the mapping
+    // Find and remove the caller's mapping; any thread of the group may
+    // unmap it, the charge goes back to the group
+    let owner = current_tgid();
     unsafe {
         for region in MMAP_REGIONS.iter_mut() {
-            if region.in_use && region.start == addr {
+            if region.in_use && region.owner == owner && region.start == addr {
                 // Found the region
                 region.in_use = false;
+                cgroup::uncharge_group_memory(region.owner, region.size);
                 kdebug!("[munmap] Unmapped region at {:#x}", addr);
                 posix::set_errno(0);
                 return 0;
@@ -409,6 +510,18 @@ pub fn munmap(addr: u64, length: u64) -> u64 {
     0
 }
 
+/// Forget every mapping of thread group `owner` once its address space is
+/// gone. Their charges were released along with the group's.
+pub fn release_mmap_regions(owner: Pid) {
+    unsafe {
+        for region in MMAP_REGIONS.iter_mut() {
+            if region.in_use && region.owner == owner {
+                region.in_use = false;
+            }
+        }
+    }
+}
+
 /// SYS_MPROTECT - Change memory protection
 ///
 /// # Arguments
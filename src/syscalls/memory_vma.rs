@@ -12,7 +12,7 @@
 use crate::mm::vma::{AddressSpace, VMABacking, VMAFlags, VMAPermissions, MAX_ADDRESS_SPACES, VMA};
 use crate::posix::{self, errno};
 use crate::process::{HEAP_BASE, USER_REGION_SIZE, USER_VIRT_BASE};
-use crate::scheduler::current_pid;
+use crate::scheduler::{cgroup, current_pid};
 use crate::{kdebug, kerror, kinfo, ktrace, kwarn};
 use spin::Mutex;
 
@@ -470,6 +470,22 @@ fn read_file_into_mapping(
                 }
                 return Ok(bytes_read);
             }
+            FileBacking::Modular(file_handle) => {
+                let bytes_read = super::memory::read_modular_into(
+                    file_handle,
+                    read_start as usize,
+                    dest_addr,
+                    to_read,
+                );
+                if bytes_read < length as usize {
+                    core::ptr::write_bytes(
+                        (dest_addr + bytes_read as u64) as *mut u8,
+                        0,
+                        length as usize - bytes_read,
+                    );
+                }
+                return Ok(bytes_read);
+            }
             _ => {
                 core::ptr::write_bytes(dest_addr as *mut u8, 0, length as usize);
                 return Err("Unsupported file backing type for mmap");
@@ -612,6 +628,22 @@ pub fn mprotect_vma(addr: u64, length: u64, prot: u64) -> u64 {
 /// * Current or new end of data segment
 /// * Current break on error (brk traditionally doesn't return -1)
 pub fn brk_vma(addr: u64) -> u64 {
+    // Growth is charged to the cgroup up front; whatever the break did not
+    // grow by (or shrank by) is given back afterwards
+    let old_brk = if addr == 0 {
+        None
+    } else {
+        with_current_address_space(|space| space.heap_end).ok()
+    };
+    let charge = old_brk.map_or(0, |old| addr.saturating_sub(old));
+    if charge > 0 {
+        if let Err(e) = cgroup::charge_current_memory(charge) {
+            kwarn!("[brk_vma] cgroup memory.max reached at {:#x}", addr);
+            posix::set_errno(e.errno());
+            return old_brk.unwrap_or(HEAP_BASE);
+        }
+    }
+
     let result = with_current_address_space(|space| -> Result<u64, &'static str> {
         if addr == 0 {
             // Query current break
@@ -641,6 +673,15 @@ pub fn brk_vma(addr: u64) -> u64 {
         }
     });
 
+    if let Some(old) = old_brk {
+        let new = match result {
+            Ok(Ok(brk)) => brk,
+            _ => old,
+        };
+        let unused = charge - new.saturating_sub(old).min(charge);
+        cgroup::uncharge_current_memory(unused + old.saturating_sub(new));
+    }
+
     match result {
         Ok(Ok(brk)) => {
             posix::set_errno(0);
@@ -17,9 +17,11 @@
 //! - `system`: System management syscalls (reboot, shutdown, runlevel, mount)
 //! - `uefi`: UEFI compatibility syscalls
 //! - `swap`: Swap management syscalls (swapon, swapoff)
+//! - `cgroup`: Control group management (cgroup_ctl)
 
 use crate::kinfo;
 
+mod cgroup;
 mod epoll;
 pub mod exec;
 mod fd;
@@ -72,6 +74,7 @@ use nexa_boot_info::FramebufferInfo;
 use types::*;
 
 // Import all syscall implementations
+use cgroup::cgroup_ctl;
 use epoll::{epoll_create1, epoll_ctl, epoll_pwait, epoll_wait, eventfd2};
 use fd::{dup, dup2, pipe};
 use file::{
@@ -622,6 +625,8 @@ pub extern "C" fn syscall_dispatch(
         SYS_PORT_OUT => port_out(arg1, arg2, arg3),
         // Watchdog timer syscall
         SYS_WATCHDOG_CTL => watchdog_ctl(arg1, arg2),
+        // Control group syscall
+        SYS_CGROUP_CTL => cgroup_ctl(arg1, arg2, arg3),
         _ => {
             crate::kwarn!("Unknown syscall: {}", nr);
             posix::set_errno(posix::errno::ENOSYS);
@@ -157,6 +157,9 @@ pub const SYS_PORT_OUT: u64 = 271; // Write to I/O port
 // Watchdog timer syscall (NexaOS extension)
 pub const SYS_WATCHDOG_CTL: u64 = 280; // Watchdog control
 
+// Control group syscall (NexaOS extension)
+pub const SYS_CGROUP_CTL: u64 = 282; // Control group management
+
 // Socket extended syscalls (Linux-compatible)
 pub const SYS_GETSOCKOPT: u64 = 55; // Get socket options
 pub const SYS_ACCEPT4: u64 = 288; // Accept with flags (Linux x86_64)
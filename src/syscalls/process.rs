@@ -307,8 +307,22 @@ pub fn fork(syscall_return_addr: u64) -> u64 {
             return u64::MAX;
         }
 
-        // Perform the memory copy
-        core::ptr::copy_nonoverlapping(src_ptr, dst_ptr, memory_size as usize);
+        // Perform the memory copy, one 2 MiB page at a time. Pages the parent
+        // has not touched since its last execve() are still pending lazy
+        // zeroing; they read as zero and the child region is already zeroed.
+        const COPY_CHUNK: u64 = 0x200000;
+        let mut offset = 0u64;
+        while offset < memory_size {
+            let chunk = COPY_CHUNK.min(memory_size - offset);
+            if !crate::mm::user_page_zero_pending(parent_phys_base, offset) {
+                core::ptr::copy_nonoverlapping(
+                    src_ptr.add(offset as usize),
+                    dst_ptr.add(offset as usize),
+                    chunk as usize,
+                );
+            }
+            offset += chunk;
+        }
 
         // Memory barrier to ensure copy is visible
         core::sync::atomic::fence(core::sync::atomic::Ordering::SeqCst);
@@ -589,11 +603,13 @@ pub fn execve(path: *const u8, _argv: *const *const u8, _envp: *const *const u8)
     {
         let mut table = crate::scheduler::process_table_lock();
         let mut found = false;
+        let mut tgid = 0;
 
         for slot in table.iter_mut() {
             if let Some(entry) = slot {
                 if entry.process.pid == current_pid {
                     found = true;
+                    tgid = entry.process.tgid;
 
                     ktrace!(
                         "[syscall_execve] Updating PID {} in table: old_cr3={:#x}, new_cr3={:#x}",
@@ -657,7 +673,11 @@ pub fn execve(path: *const u8, _argv: *const *const u8, _envp: *const *const u8)
             posix::set_errno(posix::errno::EINVAL);
             return u64::MAX;
         }
+
+        // The old image's mappings are gone with its address space
+        crate::scheduler::cgroup::release_group_memory(&mut table, tgid);
     }
+    crate::syscalls::memory::release_mmap_regions(tgid);
 
     let user_data_sel = unsafe {
         let selectors = crate::gdt::get_selectors();
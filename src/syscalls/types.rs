@@ -214,6 +214,8 @@ pub struct SocketpairHandle {
 #[derive(Clone, Copy)]
 pub enum FileBacking {
     Inline(&'static [u8]),
+    /// Generated procfs/sysfs file (per-open seq_file slot)
+    Seq(u32),
     /// Modular filesystem file (ext2, ext3, ext4, etc.) - filesystem agnostic
     Modular(crate::fs::ModularFileHandle),
     /// Legacy ext2 file - kept for backwards compatibility
@@ -48,6 +48,15 @@
 //!         ▼
 //! Service Handler (IC1/IC2)
 //! ```
+//!
+//! ## Fast Path
+//! - Channel IDs encode their table slot, so lookups are a single index
+//! - The service endpoint is cached in the channel at creation
+//! - A pool stack stays bound to a channel after its first call
+//!
+//! Bulk block/packet data does not belong in `RPC_SHMEM_SIZE` messages; it
+//! goes through the descriptor rings in `udrv::ring`, leaving RPC for
+//! control operations.
 
 use alloc::vec::Vec;
 use core::sync::atomic::{AtomicU32, AtomicU64, Ordering};
@@ -74,6 +83,10 @@ pub const RESERVED_STACKS: usize = 4;
 /// Stack size for RPC handlers
 pub const RPC_STACK_SIZE: usize = 16384; // 16KB
 
+/// Channel ID bits holding the table slot
+const CHANNEL_SLOT_BITS: u32 = 8;
+const _: () = assert!(MAX_RPC_CHANNELS == 1 << CHANNEL_SLOT_BITS);
+
 /// RPC channel for service invocation
 #[derive(Debug)]
 pub struct RpcChannel {
@@ -81,11 +94,18 @@ pub struct RpcChannel {
     pub id: u32,
     /// Service ID this channel connects to
     pub service_id: u32,
+    /// Cached service entry point
+    pub entry_point: u64,
+    /// Cached service domain ID
+    pub domain_id: u8,
+    /// Cached service isolation class
+    pub isolation_class: super::IsolationClass,
     /// Caller process ID
     pub caller_pid: u32,
     /// Channel state
     pub state: RpcChannelState,
-    /// Pre-bound stack for this channel (if any)
+    /// Pre-bound stack for this channel (if any). A pool stack is bound
+    /// automatically on the first call and returned on `destroy_channel()`.
     pub bound_stack: Option<u64>,
     /// Invocation context stack
     pub invocation_stack: InvocationStack,
@@ -391,23 +411,28 @@ pub fn register_service(
 
 /// Create an RPC channel to a service
 pub fn create_channel(service_id: u32, caller_pid: u32) -> RpcResult<u32> {
-    // Verify service exists
+    // Verify service exists and cache its endpoint
     let services = SERVICES.lock();
-    if !services.iter().any(|s| s.id == service_id) {
-        return Err(RpcError::ServiceNotFound);
-    }
+    let service = service_by_id(&services, service_id).ok_or(RpcError::ServiceNotFound)?;
+    let entry_point = service.entry_point;
+    let domain_id = service.domain_id;
+    let isolation_class = service.isolation_class;
     drop(services);
 
     let mut channels = CHANNELS.lock();
 
     // Find empty slot
-    for slot in channels.iter_mut() {
+    for (index, slot) in channels.iter_mut().enumerate() {
         if slot.is_none() {
-            let id = NEXT_CHANNEL_ID.fetch_add(1, Ordering::SeqCst);
+            let generation = NEXT_CHANNEL_ID.fetch_add(1, Ordering::SeqCst);
+            let id = (generation << CHANNEL_SLOT_BITS) | index as u32;
 
             *slot = Some(RpcChannel {
                 id,
                 service_id,
+                entry_point,
+                domain_id,
+                isolation_class,
                 caller_pid,
                 state: RpcChannelState::Idle,
                 bound_stack: None,
@@ -426,26 +451,15 @@ pub fn create_channel(service_id: u32, caller_pid: u32) -> RpcResult<u32> {
 pub fn call(channel_id: u32, msg: &RpcMessage) -> RpcResult<RpcMessage> {
     let mut channels = CHANNELS.lock();
 
-    let channel = channels
-        .iter_mut()
-        .find_map(|slot| slot.as_mut().filter(|c| c.id == channel_id))
-        .ok_or(RpcError::ChannelNotFound)?;
+    let channel = channel_mut(&mut channels, channel_id).ok_or(RpcError::ChannelNotFound)?;
 
     if channel.state != RpcChannelState::Idle {
         return Err(RpcError::InvalidState);
     }
 
-    // Get service endpoint
-    let services = SERVICES.lock();
-    let service = services
-        .iter()
-        .find(|s| s.id == channel.service_id)
-        .ok_or(RpcError::ServiceNotFound)?;
-
-    let entry_point = service.entry_point;
-    let domain_id = service.domain_id;
-    let isolation_class = service.isolation_class;
-    drop(services);
+    let entry_point = channel.entry_point;
+    let domain_id = channel.domain_id;
+    let isolation_class = channel.isolation_class;
 
     // Save caller context
     let ctx = InvocationContext {
@@ -464,18 +478,29 @@ pub fn call(channel_id: u32, msg: &RpcMessage) -> RpcResult<RpcMessage> {
     channel.accounting.ipc_count += 1;
     channel.state = RpcChannelState::Calling;
 
-    // Get stack for handler
-    let stack = channel
-        .bound_stack
-        .or_else(|| {
+    // Get stack for handler. Channels keep the first pool stack they get
+    // while the pool has plenty left, so steady-state calls skip the pool.
+    let stack = match channel.bound_stack {
+        Some(stack) => stack,
+        None => {
             let mut services = SERVICES.lock();
-            services
-                .iter_mut()
-                .find(|s| s.id == channel.service_id)?
-                .stack_pool
-                .allocate(false)
-        })
-        .ok_or(RpcError::NoStacks)?;
+            let service = service_by_id_mut(&mut services, channel.service_id);
+            let Some(pool) = service.map(|s| &mut s.stack_pool) else {
+                channel.invocation_stack.pop().ok();
+                channel.state = RpcChannelState::Idle;
+                return Err(RpcError::ServiceNotFound);
+            };
+            let Some(stack) = pool.allocate(false) else {
+                channel.invocation_stack.pop().ok();
+                channel.state = RpcChannelState::Idle;
+                return Err(RpcError::NoStacks);
+            };
+            if !pool.needs_more() {
+                channel.bound_stack = Some(stack);
+            }
+            stack
+        }
+    };
 
     drop(channels);
 
@@ -497,17 +522,14 @@ pub fn call(channel_id: u32, msg: &RpcMessage) -> RpcResult<RpcMessage> {
 
     // Update accounting
     let mut channels = CHANNELS.lock();
-    if let Some(channel) = channels
-        .iter_mut()
-        .find_map(|slot| slot.as_mut().filter(|c| c.id == channel_id))
-    {
+    if let Some(channel) = channel_mut(&mut channels, channel_id) {
         let end_time = crate::safety::rdtsc();
         channel.accounting.cpu_cycles += end_time - channel.accounting.call_start;
 
         // Return stack if not bound
-        if channel.bound_stack.is_none() {
+        if channel.bound_stack != Some(stack) {
             let mut services = SERVICES.lock();
-            if let Some(service) = services.iter_mut().find(|s| s.id == channel.service_id) {
+            if let Some(service) = service_by_id_mut(&mut services, channel.service_id) {
                 service.stack_pool.return_stack(stack);
             }
         }
@@ -520,6 +542,32 @@ pub fn call(channel_id: u32, msg: &RpcMessage) -> RpcResult<RpcMessage> {
     result
 }
 
+/// Look up a channel by ID (the low bits of the ID are its slot)
+#[inline]
+fn channel_mut(
+    channels: &mut [Option<RpcChannel>; MAX_RPC_CHANNELS],
+    channel_id: u32,
+) -> Option<&mut RpcChannel> {
+    let slot = channel_id as usize & (MAX_RPC_CHANNELS - 1);
+    channels[slot].as_mut().filter(|c| c.id == channel_id)
+}
+
+/// Look up a service by ID (services are never removed, ID = index + 1)
+#[inline]
+fn service_by_id(services: &[ServiceEndpoint], service_id: u32) -> Option<&ServiceEndpoint> {
+    let index = (service_id as usize).checked_sub(1)?;
+    services.get(index).filter(|s| s.id == service_id)
+}
+
+#[inline]
+fn service_by_id_mut(
+    services: &mut [ServiceEndpoint],
+    service_id: u32,
+) -> Option<&mut ServiceEndpoint> {
+    let index = (service_id as usize).checked_sub(1)?;
+    services.get_mut(index).filter(|s| s.id == service_id)
+}
+
 /// IC0 call - direct function call (kernel internal)
 fn call_ic0(entry_point: u64, msg: &RpcMessage, _stack: u64) -> RpcResult<RpcMessage> {
     // In IC0, we just call the function directly
@@ -593,10 +641,7 @@ unsafe fn call_with_stack(entry_point: u64, msg: &RpcMessage, stack: u64) -> Rpc
 /// Bind a stack to a channel for frequent calls
 pub fn bind_stack(channel_id: u32, stack: u64) -> RpcResult<()> {
     let mut channels = CHANNELS.lock();
-    let channel = channels
-        .iter_mut()
-        .find_map(|slot| slot.as_mut().filter(|c| c.id == channel_id))
-        .ok_or(RpcError::ChannelNotFound)?;
+    let channel = channel_mut(&mut channels, channel_id).ok_or(RpcError::ChannelNotFound)?;
 
     channel.bound_stack = Some(stack);
     Ok(())
@@ -604,11 +649,8 @@ pub fn bind_stack(channel_id: u32, stack: u64) -> RpcResult<()> {
 
 /// Get accounting info for a channel
 pub fn get_accounting(channel_id: u32) -> RpcResult<RpcAccounting> {
-    let channels = CHANNELS.lock();
-    let channel = channels
-        .iter()
-        .find_map(|slot| slot.as_ref().filter(|c| c.id == channel_id))
-        .ok_or(RpcError::ChannelNotFound)?;
+    let mut channels = CHANNELS.lock();
+    let channel = channel_mut(&mut channels, channel_id).ok_or(RpcError::ChannelNotFound)?;
 
     Ok(channel.accounting)
 }
@@ -616,25 +658,17 @@ pub fn get_accounting(channel_id: u32) -> RpcResult<RpcAccounting> {
 /// Destroy an RPC channel
 pub fn destroy_channel(channel_id: u32) -> RpcResult<()> {
     let mut channels = CHANNELS.lock();
+    let channel = channel_mut(&mut channels, channel_id).ok_or(RpcError::ChannelNotFound)?;
 
-    for slot in channels.iter_mut() {
-        if let Some(channel) = slot {
-            if channel.id == channel_id {
-                // Return bound stack if any
-                if let Some(stack) = channel.bound_stack {
-                    let mut services = SERVICES.lock();
-                    if let Some(service) = services.iter_mut().find(|s| s.id == channel.service_id)
-                    {
-                        service.stack_pool.return_stack(stack);
-                    }
-                }
-                *slot = None;
-                return Ok(());
-            }
+    // Return bound stack if any
+    if let Some(stack) = channel.bound_stack {
+        let mut services = SERVICES.lock();
+        if let Some(service) = service_by_id_mut(&mut services, channel.service_id) {
+            service.stack_pool.return_stack(stack);
         }
     }
-
-    Err(RpcError::ChannelNotFound)
+    channels[channel_id as usize & (MAX_RPC_CHANNELS - 1)] = None;
+    Ok(())
 }
 
 /// Handle OOM during RPC
@@ -34,6 +34,12 @@
 //! - Read-only or read-write grants
 //! - Lock-free ring buffers for async messaging
 //!
+//! ## Descriptor Rings
+//! Batched block/packet I/O to isolated drivers:
+//! - Submission/completion rings in shared regions mapped on both sides
+//! - Doorbells rung once per batch, wakeups only for sleeping drivers
+//! - Completions reaped by polling, no IPC per request
+//!
 //! # Architecture Overview
 //!
 //! ```text
@@ -74,6 +80,7 @@ pub mod container;
 pub mod ipc_rpc;
 pub mod isolation;
 pub mod registry;
+pub mod ring;
 pub mod shared_mem;
 pub mod twin_driver;
 
@@ -83,6 +90,7 @@ pub use container::{ContainerState, DriverContainer, DriverContainerId};
 pub use ipc_rpc::{RpcChannel, RpcError, RpcMessage, RpcResult};
 pub use isolation::{IsolationClass, IsolationError};
 pub use registry::{DriverClass, DriverId, DriverInfo, DriverRegistry};
+pub use ring::{IoCompletion, IoDesc, RingError, RingServicer, RingSubmitter};
 pub use shared_mem::{SharedMemError, SharedRegion, SharedRegionId};
 pub use twin_driver::{ControlPlane, DataPlane, TwinDriver, TwinDriverId};
 
@@ -0,0 +1,544 @@
+//! Descriptor Rings for the Twin Driver Data Plane
+//!
+//! Block and network I/O to an isolated (IC1/IC2) driver cannot afford one
+//! `ipc_rpc::call()` per request: every call crosses the isolation boundary
+//! and squeezes its payload through the 4 KiB RPC message buffer. A
+//! descriptor ring instead lives in a `shared_mem` region that is mapped into
+//! both the kernel and the driver container. The kernel writes submission
+//! descriptors, the driver consumes them and posts completions, and neither
+//! side switches domains per request.
+//!
+//! # Protocol
+//!
+//! - Each ring is single-producer/single-consumer in both directions, so the
+//!   indices are plain free-running `u32`s (masked by the power-of-two size)
+//!   and no CAS is needed.
+//! - Submissions are published in batches. The doorbell (tail store plus an
+//!   optional wakeup) is rung once per `batch` descriptors or on `flush()`.
+//! - The driver sets `NEED_WAKEUP` only when it is about to sleep, so a busy
+//!   driver is never notified at all.
+//! - Completions are reaped by polling the completion queue. The kernel keeps
+//!   at most `entries` requests in flight, so the completion queue can never
+//!   overflow.
+//!
+//! # Layout
+//!
+//! All offsets are relative to the region base, so each side may map the
+//! region at a different virtual address.
+//!
+//! ```text
+//! +0     RingHeader   magic and geometry
+//! +64    sq tail      written by the kernel
+//! +128   sq head      written by the driver (+ NEED_WAKEUP)
+//! +192   cq tail      written by the driver
+//! +256   cq head      written by the kernel
+//! +320   [IoDesc; entries]        submission queue
+//!        [IoCompletion; entries]  completion queue
+//!        data area (page aligned) bulk buffers referenced by descriptors
+//! ```
+
+use core::sync::atomic::{fence, AtomicU32, Ordering};
+
+/// Region magic ("DRNG")
+pub const RING_MAGIC: u32 = 0x4452_4E47;
+
+/// Maximum descriptors per ring
+pub const MAX_RING_ENTRIES: u32 = 4096;
+
+/// Default number of submissions per doorbell
+pub const DEFAULT_DOORBELL_BATCH: u32 = 16;
+
+/// Descriptor opcodes
+pub mod ring_op {
+    /// Read blocks into the data area
+    pub const READ: u16 = 1;
+    /// Write blocks from the data area
+    pub const WRITE: u16 = 2;
+    /// Flush device caches
+    pub const FLUSH: u16 = 3;
+    /// Transmit a packet from the data area
+    pub const NET_TX: u16 = 4;
+    /// Post a receive buffer in the data area
+    pub const NET_RX: u16 = 5;
+}
+
+/// Shared ring flags
+pub mod ring_flags {
+    /// Driver is going to sleep and must be notified on the next doorbell
+    pub const NEED_WAKEUP: u32 = 1 << 0;
+}
+
+/// Submission descriptor (kernel -> driver)
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+#[repr(C)]
+pub struct IoDesc {
+    /// Operation (see `ring_op`)
+    pub opcode: u16,
+    /// Operation flags
+    pub flags: u16,
+    /// Buffer length in bytes
+    pub len: u32,
+    /// Buffer offset inside the data area
+    pub data_offset: u64,
+    /// Starting sector (block devices)
+    pub sector: u64,
+    /// Opaque request identifier, echoed in the completion
+    pub cookie: u64,
+}
+
+/// Completion entry (driver -> kernel)
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+#[repr(C)]
+pub struct IoCompletion {
+    /// Cookie of the completed descriptor
+    pub cookie: u64,
+    /// 0 on success, negative errno on failure
+    pub status: i32,
+    /// Bytes transferred
+    pub len: u32,
+}
+
+/// One producer or consumer index, alone on its cache line
+#[repr(C, align(64))]
+struct RingIndex {
+    value: AtomicU32,
+    flags: AtomicU32,
+}
+
+/// Ring header at the start of the shared region
+#[repr(C)]
+pub struct RingHeader {
+    magic: u32,
+    entries: u32,
+    sq_offset: u32,
+    cq_offset: u32,
+    data_offset: u32,
+    data_size: u32,
+    sq_tail: RingIndex,
+    sq_head: RingIndex,
+    cq_tail: RingIndex,
+    cq_head: RingIndex,
+}
+
+/// Ring error types
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum RingError {
+    /// Entry count is zero, too large or not a power of two
+    InvalidGeometry,
+    /// Region does not hold an initialized ring
+    BadMagic,
+    /// Region is smaller than the ring layout
+    RegionTooSmall,
+    /// Ring is full
+    Full,
+    /// Descriptor buffer lies outside the data area
+    OutOfRange,
+    /// The peer published an index that is impossible for the ring state
+    Protocol,
+}
+
+/// Per-endpoint ring statistics
+#[derive(Debug, Clone, Copy, Default)]
+pub struct RingStats {
+    /// Descriptors submitted (or fetched, on the driver side)
+    pub submitted: u64,
+    /// Completions reaped (or posted, on the driver side)
+    pub completed: u64,
+    /// Tail publications
+    pub doorbells: u64,
+    /// Doorbells that had to wake the peer
+    pub wakeups: u64,
+    /// Polls that found nothing
+    pub empty_polls: u64,
+}
+
+/// Region offsets for a ring geometry: (sq, cq, data, total size)
+fn layout(entries: u32, data_size: u32) -> (u64, u64, u64, u64) {
+    let sq = core::mem::size_of::<RingHeader>() as u64;
+    let cq = sq + entries as u64 * core::mem::size_of::<IoDesc>() as u64;
+    let data = (cq + entries as u64 * core::mem::size_of::<IoCompletion>() as u64 + 0xFFF) & !0xFFF;
+    (sq, cq, data, data + data_size as u64)
+}
+
+fn valid_entries(entries: u32) -> bool {
+    entries != 0 && entries <= MAX_RING_ENTRIES && entries.is_power_of_two()
+}
+
+/// Size of the shared region needed for a ring
+pub fn region_size(entries: u32, data_size: u32) -> Option<u64> {
+    if !valid_entries(entries) {
+        return None;
+    }
+    Some(layout(entries, data_size).3)
+}
+
+/// Initialize a ring at `base`.
+///
+/// # Safety
+/// `base` must be 64-byte aligned and valid for `region_size(entries, data_size)` bytes.
+pub unsafe fn init_region(base: *mut u8, entries: u32, data_size: u32) -> Result<(), RingError> {
+    if !valid_entries(entries) {
+        return Err(RingError::InvalidGeometry);
+    }
+    let (sq, cq, data, _) = layout(entries, data_size);
+
+    core::ptr::write_bytes(base, 0, data as usize);
+    let header = &mut *(base as *mut RingHeader);
+    header.entries = entries;
+    header.sq_offset = sq as u32;
+    header.cq_offset = cq as u32;
+    header.data_offset = data as u32;
+    header.data_size = data_size;
+    // Geometry must be visible before the magic
+    fence(Ordering::Release);
+    core::ptr::write_volatile(&mut header.magic, RING_MAGIC);
+    Ok(())
+}
+
+/// Pointers into one mapping of a ring
+struct RingView {
+    header: *const RingHeader,
+    sq: *mut IoDesc,
+    cq: *mut IoCompletion,
+    data: *mut u8,
+    data_size: u32,
+    entries: u32,
+    mask: u32,
+}
+
+impl RingView {
+    unsafe fn attach(base: *mut u8, size: u64) -> Result<Self, RingError> {
+        if (size as usize) < core::mem::size_of::<RingHeader>() {
+            return Err(RingError::RegionTooSmall);
+        }
+        let header = &*(base as *const RingHeader);
+        if core::ptr::read_volatile(&header.magic) != RING_MAGIC {
+            return Err(RingError::BadMagic);
+        }
+        fence(Ordering::Acquire);
+
+        let entries = header.entries;
+        if !valid_entries(entries) {
+            return Err(RingError::InvalidGeometry);
+        }
+        // Never trust offsets written by the other side
+        let (sq, cq, data, total) = layout(entries, header.data_size);
+        if header.sq_offset as u64 != sq
+            || header.cq_offset as u64 != cq
+            || header.data_offset as u64 != data
+        {
+            return Err(RingError::InvalidGeometry);
+        }
+        if total > size {
+            return Err(RingError::RegionTooSmall);
+        }
+
+        Ok(Self {
+            header,
+            sq: base.add(sq as usize) as *mut IoDesc,
+            cq: base.add(cq as usize) as *mut IoCompletion,
+            data: base.add(data as usize),
+            data_size: header.data_size,
+            entries,
+            mask: entries - 1,
+        })
+    }
+
+    #[inline]
+    fn header(&self) -> &RingHeader {
+        unsafe { &*self.header }
+    }
+
+    fn data_range(&self, offset: u64, len: u32) -> Result<*mut u8, RingError> {
+        match offset.checked_add(len as u64) {
+            Some(end) if end <= self.data_size as u64 => {
+                Ok(unsafe { self.data.add(offset as usize) })
+            }
+            _ => Err(RingError::OutOfRange),
+        }
+    }
+}
+
+/// Kernel end of a ring: submits descriptors and reaps completions
+pub struct RingSubmitter {
+    view: RingView,
+    /// Next submission slot (private until the doorbell)
+    sq_tail: u32,
+    /// Last tail published to the driver
+    published: u32,
+    /// Next completion to reap
+    cq_head: u32,
+    /// Submissions per doorbell
+    batch: u32,
+    /// Wakeup hook, called with `ring_id` when the driver sleeps
+    notify: Option<fn(u32)>,
+    ring_id: u32,
+    stats: RingStats,
+}
+
+// The endpoint owns its side of the ring exclusively.
+unsafe impl Send for RingSubmitter {}
+
+impl RingSubmitter {
+    /// Attach to an initialized ring mapped at `base`.
+    ///
+    /// # Safety
+    /// `base` must stay mapped for `size` bytes while the submitter lives,
+    /// and there must be only one submitter per ring.
+    pub unsafe fn attach(base: *mut u8, size: u64, ring_id: u32) -> Result<Self, RingError> {
+        let view = RingView::attach(base, size)?;
+        let header = view.header();
+        let sq_tail = header.sq_tail.value.load(Ordering::Acquire);
+        let cq_head = header.cq_head.value.load(Ordering::Acquire);
+        Ok(Self {
+            view,
+            sq_tail,
+            published: sq_tail,
+            cq_head,
+            batch: DEFAULT_DOORBELL_BATCH,
+            notify: None,
+            ring_id,
+            stats: RingStats::default(),
+        })
+    }
+
+    /// Set the number of submissions per doorbell (1 = ring on every submit)
+    pub fn set_batch(&mut self, batch: u32) {
+        self.batch = batch.clamp(1, self.view.entries);
+    }
+
+    /// Set the hook used to wake a sleeping driver
+    pub fn set_notify(&mut self, notify: fn(u32)) {
+        self.notify = Some(notify);
+    }
+
+    /// Number of descriptors in the ring
+    pub fn entries(&self) -> u32 {
+        self.view.entries
+    }
+
+    /// Requests submitted but not yet reaped
+    #[inline]
+    pub fn in_flight(&self) -> u32 {
+        self.sq_tail.wrapping_sub(self.cq_head)
+    }
+
+    /// Data area buffer, for filling writes/transmits or reading results
+    pub fn data(&mut self, offset: u64, len: u32) -> Result<&mut [u8], RingError> {
+        let ptr = self.view.data_range(offset, len)?;
+        Ok(unsafe { core::slice::from_raw_parts_mut(ptr, len as usize) })
+    }
+
+    /// Queue a descriptor. The doorbell is rung once a full batch is pending.
+    #[inline]
+    pub fn submit(&mut self, desc: &IoDesc) -> Result<(), RingError> {
+        if self.in_flight() >= self.view.entries {
+            // Let the driver see what is queued before the caller backs off
+            self.flush();
+            return Err(RingError::Full);
+        }
+        if desc.len != 0 {
+            self.view.data_range(desc.data_offset, desc.len)?;
+        }
+
+        let slot = (self.sq_tail & self.view.mask) as usize;
+        unsafe {
+            core::ptr::write_volatile(self.view.sq.add(slot), *desc);
+        }
+        self.sq_tail = self.sq_tail.wrapping_add(1);
+        self.stats.submitted += 1;
+
+        if self.sq_tail.wrapping_sub(self.published) >= self.batch {
+            self.flush();
+        }
+        Ok(())
+    }
+
+    /// Publish all queued descriptors and wake the driver if it asked for it.
+    ///
+    /// Returns true if anything was published.
+    pub fn flush(&mut self) -> bool {
+        if self.sq_tail == self.published {
+            return false;
+        }
+        let header = self.view.header();
+        header.sq_tail.value.store(self.sq_tail, Ordering::Release);
+        self.published = self.sq_tail;
+        self.stats.doorbells += 1;
+
+        // Pairs with the fence in `RingServicer::prepare_sleep()`: either the
+        // driver sees the new tail, or we see its NEED_WAKEUP.
+        fence(Ordering::SeqCst);
+        if header.sq_head.flags.load(Ordering::Relaxed) & ring_flags::NEED_WAKEUP != 0 {
+            self.stats.wakeups += 1;
+            if let Some(notify) = self.notify {
+                notify(self.ring_id);
+            }
+        }
+        true
+    }
+
+    /// Reap up to `out.len()` completions without blocking.
+    ///
+    /// Fails with `RingError::Protocol`, reaping nothing, if the driver
+    /// published more completions than there are requests in flight.
+    pub fn poll(&mut self, out: &mut [IoCompletion]) -> Result<usize, RingError> {
+        let header = self.view.header();
+        let tail = header.cq_tail.value.load(Ordering::Acquire);
+        let ready = tail.wrapping_sub(self.cq_head);
+        // Never trust offsets written by the other side: only published
+        // descriptors can have completed
+        if ready > self.published.wrapping_sub(self.cq_head) {
+            return Err(RingError::Protocol);
+        }
+        let count = (ready as usize).min(out.len());
+        if count == 0 {
+            self.stats.empty_polls += 1;
+            return Ok(0);
+        }
+
+        for entry in out.iter_mut().take(count) {
+            let slot = (self.cq_head & self.view.mask) as usize;
+            *entry = unsafe { core::ptr::read_volatile(self.view.cq.add(slot)) };
+            self.cq_head = self.cq_head.wrapping_add(1);
+        }
+        header.cq_head.value.store(self.cq_head, Ordering::Release);
+        self.stats.completed += count as u64;
+        Ok(count)
+    }
+
+    /// Reap a single completion
+    pub fn poll_one(&mut self) -> Result<Option<IoCompletion>, RingError> {
+        let mut entry = [IoCompletion::default()];
+        Ok((self.poll(&mut entry)? == 1).then(|| entry[0]))
+    }
+
+    /// Endpoint statistics
+    pub fn stats(&self) -> RingStats {
+        self.stats
+    }
+}
+
+/// Driver end of a ring: fetches descriptors and posts completions
+pub struct RingServicer {
+    view: RingView,
+    /// Next descriptor to fetch
+    sq_head: u32,
+    /// Next completion slot (private until `publish()`)
+    cq_tail: u32,
+    /// Last completion tail published to the kernel
+    published: u32,
+    stats: RingStats,
+}
+
+unsafe impl Send for RingServicer {}
+
+impl RingServicer {
+    /// Attach to an initialized ring mapped at `base`.
+    ///
+    /// # Safety
+    /// Same requirements as `RingSubmitter::attach()`.
+    pub unsafe fn attach(base: *mut u8, size: u64) -> Result<Self, RingError> {
+        let view = RingView::attach(base, size)?;
+        let header = view.header();
+        let sq_head = header.sq_head.value.load(Ordering::Acquire);
+        let cq_tail = header.cq_tail.value.load(Ordering::Acquire);
+        Ok(Self {
+            view,
+            sq_head,
+            cq_tail,
+            published: cq_tail,
+            stats: RingStats::default(),
+        })
+    }
+
+    /// Data area buffer referenced by a descriptor
+    pub fn data(&mut self, desc: &IoDesc) -> Result<&mut [u8], RingError> {
+        let ptr = self.view.data_range(desc.data_offset, desc.len)?;
+        Ok(unsafe { core::slice::from_raw_parts_mut(ptr, desc.len as usize) })
+    }
+
+    /// Fetch up to `out.len()` submitted descriptors.
+    pub fn fetch(&mut self, out: &mut [IoDesc]) -> usize {
+        let header = self.view.header();
+        let tail = header.sq_tail.value.load(Ordering::Acquire);
+        let count = (tail.wrapping_sub(self.sq_head) as usize).min(out.len());
+        if count == 0 {
+            self.stats.empty_polls += 1;
+            return 0;
+        }
+
+        for entry in out.iter_mut().take(count) {
+            let slot = (self.sq_head & self.view.mask) as usize;
+            *entry = unsafe { core::ptr::read_volatile(self.view.sq.add(slot)) };
+            self.sq_head = self.sq_head.wrapping_add(1);
+        }
+        header.sq_head.value.store(self.sq_head, Ordering::Release);
+        self.stats.submitted += count as u64;
+        count
+    }
+
+    /// Queue a completion. Call `publish()` to make queued completions visible.
+    pub fn complete(&mut self, completion: &IoCompletion) -> Result<(), RingError> {
+        let header = self.view.header();
+        let head = header.cq_head.value.load(Ordering::Acquire);
+        if self.cq_tail.wrapping_sub(head) >= self.view.entries {
+            return Err(RingError::Full);
+        }
+
+        let slot = (self.cq_tail & self.view.mask) as usize;
+        unsafe {
+            core::ptr::write_volatile(self.view.cq.add(slot), *completion);
+        }
+        self.cq_tail = self.cq_tail.wrapping_add(1);
+        self.stats.completed += 1;
+        Ok(())
+    }
+
+    /// Publish queued completions to the kernel.
+    pub fn publish(&mut self) -> bool {
+        if self.cq_tail == self.published {
+            return false;
+        }
+        self.view
+            .header()
+            .cq_tail
+            .value
+            .store(self.cq_tail, Ordering::Release);
+        self.published = self.cq_tail;
+        self.stats.doorbells += 1;
+        true
+    }
+
+    /// Ask for a wakeup before sleeping.
+    ///
+    /// Returns false (and withdraws the request) if descriptors arrived in
+    /// the meantime, in which case the driver must keep polling.
+    pub fn prepare_sleep(&mut self) -> bool {
+        let header = self.view.header();
+        header
+            .sq_head
+            .flags
+            .fetch_or(ring_flags::NEED_WAKEUP, Ordering::SeqCst);
+        fence(Ordering::SeqCst);
+        if header.sq_tail.value.load(Ordering::Acquire) != self.sq_head {
+            self.clear_wakeup();
+            return false;
+        }
+        true
+    }
+
+    /// Withdraw a wakeup request after being woken
+    pub fn clear_wakeup(&mut self) {
+        self.view
+            .header()
+            .sq_head
+            .flags
+            .fetch_and(!ring_flags::NEED_WAKEUP, Ordering::SeqCst);
+    }
+
+    /// Endpoint statistics
+    pub fn stats(&self) -> RingStats {
+        self.stats
+    }
+}
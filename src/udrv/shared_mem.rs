@@ -21,6 +21,9 @@ pub type SharedRegionId = u32;
 /// Maximum shared regions
 pub const MAX_SHARED_REGIONS: usize = 256;
 
+/// Kernel direct map offset used to address region memory
+const DIRECT_MAP_OFFSET: u64 = 0xFFFF_8000_0000_0000;
+
 /// Shared memory region
 #[derive(Debug, Clone)]
 pub struct SharedRegion {
@@ -369,7 +372,7 @@ fn map_to_address_space(
     // 3. Map physical pages with appropriate permissions
 
     // For now, use direct mapping
-    Ok(phys_addr + 0xFFFF_8000_0000_0000) // Direct map offset
+    Ok(phys_addr + DIRECT_MAP_OFFSET)
 }
 
 /// Unmap from client's address space
@@ -465,7 +468,7 @@ pub fn create_ring_buffer(
         .iter()
         .find_map(|slot| slot.as_ref().filter(|r| r.id == id))
     {
-        let header_ptr = (region.phys_addr + 0xFFFF_8000_0000_0000) as *mut RingBufferHeader;
+        let header_ptr = (region.phys_addr + DIRECT_MAP_OFFSET) as *mut RingBufferHeader;
         unsafe {
             (*header_ptr).init(entries, entry_size);
         }
@@ -473,3 +476,38 @@ pub fn create_ring_buffer(
 
     Ok(id)
 }
+
+/// Kernel virtual address of a region
+pub fn kernel_address(id: SharedRegionId) -> Result<u64, SharedMemError> {
+    get_info(id)
+        .map(|info| info.phys_addr + DIRECT_MAP_OFFSET)
+        .ok_or(SharedMemError::NotFound)
+}
+
+/// Create a descriptor ring region (see `udrv::ring`)
+///
+/// The region holds `entries` submission and completion slots followed by a
+/// `data_size` byte data area, and is initialized before it is returned.
+pub fn create_descriptor_ring(
+    entries: u32,
+    data_size: u32,
+    owner: u32,
+) -> Result<SharedRegionId, SharedMemError> {
+    let size = super::ring::region_size(entries, data_size).ok_or(SharedMemError::InvalidSize)?;
+
+    let id = create(
+        size,
+        SharedRegionType::RingBuffer,
+        SharedAccess::ReadWrite,
+        owner,
+        shared_flags::LOCKED | shared_flags::DMA_COHERENT | shared_flags::CONTIGUOUS,
+    )?;
+
+    let base = kernel_address(id)?;
+    if unsafe { super::ring::init_region(base as *mut u8, entries, data_size) }.is_err() {
+        let _ = destroy(id);
+        return Err(SharedMemError::InvalidSize);
+    }
+
+    Ok(id)
+}
@@ -47,11 +47,21 @@
 //! - Control plane changes are infrequent
 //! - Interrupts handled in kernel for low latency
 //! - DMA completes without userspace involvement
+//!
+//! # Descriptor Rings
+//!
+//! Drivers that must stay isolated (IC1/IC2) for their data plane as well
+//! get descriptor rings instead of per-request IPC (see `udrv::ring`). A
+//! ring is a shared region mapped into both the kernel and the driver
+//! container; `attach_ring()` hands the kernel end to the block/net stub.
 
 use alloc::vec::Vec;
 use core::sync::atomic::{AtomicU32, Ordering};
 use spin::Mutex;
 
+use super::ring::RingSubmitter;
+use super::shared_mem;
+
 /// Twin driver ID type
 pub type TwinDriverId = u32;
 
@@ -253,23 +263,29 @@ pub struct IrqHandler {
     pub shared: bool,
 }
 
-/// Ring buffer for packet/block I/O
+/// Descriptor ring for packet/block I/O
+///
+/// The ring indices live in the shared region itself (see `udrv::ring`).
 #[derive(Debug, Clone)]
 pub struct RingBuffer {
     /// Buffer type
     pub buf_type: RingBufferType,
+    /// Shared region backing the ring
+    pub region_id: super::SharedRegionId,
     /// Physical address
     pub phys_addr: u64,
-    /// Virtual address
+    /// Virtual address (in kernel)
     pub virt_addr: u64,
+    /// Virtual address in the driver container
+    pub driver_addr: u64,
+    /// Region size in bytes
+    pub size: u64,
     /// Number of entries
     pub entries: u32,
     /// Entry size
     pub entry_size: u32,
-    /// Head index (consumer)
-    pub head: u32,
-    /// Tail index (producer)
-    pub tail: u32,
+    /// Size of the data area in bytes
+    pub data_size: u32,
 }
 
 /// Ring buffer types
@@ -534,6 +550,124 @@ pub fn stop(id: TwinDriverId) -> Result<(), TwinDriverError> {
     Ok(())
 }
 
+/// Attach a descriptor ring to a twin driver
+///
+/// Creates a shared ring region, maps it into the control plane's container
+/// and returns the ring description together with the kernel's submitting
+/// end. The driver finds its mapping through `ring_buffers()`.
+pub fn attach_ring(
+    id: TwinDriverId,
+    buf_type: RingBufferType,
+    entries: u32,
+    data_size: u32,
+) -> Result<(RingBuffer, RingSubmitter), TwinDriverError> {
+    let container_id = {
+        let drivers = TWIN_DRIVERS.lock();
+        let driver = drivers
+            .iter()
+            .find_map(|slot| slot.as_ref().filter(|d| d.id == id))
+            .ok_or(TwinDriverError::NotFound)?;
+        match driver.state {
+            TwinDriverState::ControlLoaded | TwinDriverState::Linked | TwinDriverState::Running => {
+                driver.control.container_id
+            }
+            _ => return Err(TwinDriverError::InvalidState),
+        }
+    };
+
+    let region_id = shared_mem::create_descriptor_ring(entries, data_size, container_id)
+        .map_err(|_| TwinDriverError::RingSetup)?;
+    let setup = || -> Result<(RingBuffer, RingSubmitter), TwinDriverError> {
+        let info = shared_mem::get_info(region_id).ok_or(TwinDriverError::RingSetup)?;
+        let virt_addr =
+            shared_mem::kernel_address(region_id).map_err(|_| TwinDriverError::RingSetup)?;
+        let driver_addr =
+            shared_mem::map_to_client(region_id, container_id, shared_mem::SharedAccess::ReadWrite)
+                .map_err(|_| TwinDriverError::RingSetup)?;
+        let submitter =
+            unsafe { RingSubmitter::attach(virt_addr as *mut u8, info.size, region_id) }
+                .map_err(|_| TwinDriverError::RingSetup)?;
+
+        let ring = RingBuffer {
+            buf_type,
+            region_id,
+            phys_addr: info.phys_addr,
+            virt_addr,
+            driver_addr,
+            size: info.size,
+            entries,
+            entry_size: core::mem::size_of::<super::ring::IoDesc>() as u32,
+            data_size,
+        };
+        Ok((ring, submitter))
+    };
+    let (ring, submitter) = match setup() {
+        Ok(result) => result,
+        Err(e) => {
+            let _ = shared_mem::destroy(region_id);
+            return Err(e);
+        }
+    };
+
+    let mut drivers = TWIN_DRIVERS.lock();
+    let Some(driver) = drivers
+        .iter_mut()
+        .find_map(|slot| slot.as_mut().filter(|d| d.id == id))
+    else {
+        drop(drivers);
+        let _ = shared_mem::destroy(region_id);
+        return Err(TwinDriverError::NotFound);
+    };
+    driver.data.ring_buffers.push(ring.clone());
+
+    crate::kinfo!(
+        "UDRV/Twin: Attached {:?} ring ({} entries, {} data bytes) to driver {} at {:#x}",
+        buf_type,
+        entries,
+        data_size,
+        id,
+        ring.driver_addr
+    );
+
+    Ok((ring, submitter))
+}
+
+/// Detach a descriptor ring and free its shared region
+///
+/// The caller must have dropped the ring's `RingSubmitter`.
+pub fn detach_ring(
+    id: TwinDriverId,
+    region_id: super::SharedRegionId,
+) -> Result<(), TwinDriverError> {
+    let mut drivers = TWIN_DRIVERS.lock();
+    let driver = drivers
+        .iter_mut()
+        .find_map(|slot| slot.as_mut().filter(|d| d.id == id))
+        .ok_or(TwinDriverError::NotFound)?;
+
+    let idx = driver
+        .data
+        .ring_buffers
+        .iter()
+        .position(|r| r.region_id == region_id)
+        .ok_or(TwinDriverError::NotFound)?;
+    driver.data.ring_buffers.remove(idx);
+    drop(drivers);
+
+    let _ = shared_mem::destroy(region_id);
+    Ok(())
+}
+
+/// Rings attached to a twin driver
+pub fn ring_buffers(id: TwinDriverId) -> Result<Vec<RingBuffer>, TwinDriverError> {
+    let drivers = TWIN_DRIVERS.lock();
+    let driver = drivers
+        .iter()
+        .find_map(|slot| slot.as_ref().filter(|d| d.id == id))
+        .ok_or(TwinDriverError::NotFound)?;
+    Ok(driver.data.ring_buffers.clone())
+}
+
 /// Transmit data via data plane (fast path)
 #[inline]
 pub fn xmit(id: TwinDriverId, data: &[u8]) -> Result<i32, TwinDriverError> {
@@ -642,6 +776,8 @@ pub enum TwinDriverError {
     NotSupported,
     NotInitialized,
     IpcError,
+    /// Descriptor ring could not be created or mapped
+    RingSetup,
 }
 
 /// Get twin driver info
@@ -660,6 +796,7 @@ pub fn get_info(id: TwinDriverId) -> Option<TwinDriverInfo> {
         mmio_count: driver.data.mmio_regions.len(),
         dma_count: driver.data.dma_descriptors.len(),
         irq_count: driver.data.irq_handlers.len(),
+        ring_count: driver.data.ring_buffers.len(),
     })
 }
 
@@ -674,6 +811,7 @@ pub struct TwinDriverInfo {
     pub mmio_count: usize,
     pub dma_count: usize,
     pub irq_count: usize,
+    pub ring_count: usize,
 }
 
 /// List all twin drivers
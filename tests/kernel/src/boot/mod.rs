@@ -8,10 +8,12 @@
 //! - BootConfig parsing and defaults
 //! - Filesystem mount state tracking
 //! - Init system runlevels and service management
+//! - Boot timeline recording
 
 mod config;
 mod init;
 mod stages;
+mod timeline;
 
 pub use config::*;
 pub use stages::*;
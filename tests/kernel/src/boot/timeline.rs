@@ -0,0 +1,56 @@
+//! Boot Timeline Tests
+
+#[cfg(test)]
+mod tests {
+    use crate::boot::timeline::{begin, end, events, stage, write_report};
+    use std::string::String;
+
+    #[test]
+    fn test_stage_records_event() {
+        let value = stage("test: timed stage", || 42);
+        assert_eq!(value, 42);
+
+        let event = events()
+            .into_iter()
+            .find(|e| e.name == "test: timed stage")
+            .expect("stage should be recorded");
+        assert!(event.end_tsc >= event.start_tsc);
+        assert!(!event.deferred);
+        assert_eq!(event.cpu, 0);
+    }
+
+    #[test]
+    fn test_begin_end_deferred() {
+        let id = begin("test: deferred task", true);
+        let running = events()
+            .into_iter()
+            .find(|e| e.name == "test: deferred task")
+            .unwrap();
+        assert_eq!(running.end_tsc, 0, "stage still running");
+
+        end(id);
+        let done = events()
+            .into_iter()
+            .find(|e| e.name == "test: deferred task")
+            .unwrap();
+        assert!(done.deferred);
+        assert_ne!(done.end_tsc, 0);
+    }
+
+    #[test]
+    fn test_events_sorted_by_start() {
+        stage("test: first", || {});
+        stage("test: second", || {});
+        let events = events();
+        assert!(events.windows(2).all(|w| w[0].start_tsc <= w[1].start_tsc));
+    }
+
+    #[test]
+    fn test_report_lists_stages() {
+        stage("test: reported stage", || {});
+        let mut report = String::new();
+        write_report(&mut report).unwrap();
+        assert!(report.starts_with("# tsc_hz "));
+        assert!(report.contains("test: reported stage"));
+    }
+}
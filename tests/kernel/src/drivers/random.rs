@@ -129,6 +129,45 @@ mod tests {
         assert_ne!(h1, h2);
     }
 
+    // =========================================================================
+    // Per-CPU CRNG Tests (real kernel code)
+    // =========================================================================
+
+    #[test]
+    fn test_crng_u64_unique() {
+        crate::drivers::init_random();
+        let mut seen = std::collections::HashSet::new();
+        for _ in 0..4096 {
+            assert!(seen.insert(crate::drivers::get_random_u64()));
+        }
+    }
+
+    #[test]
+    fn test_crng_request_sizes() {
+        crate::drivers::init_random();
+        // Sizes around the batch and one-shot stream boundaries
+        for size in [1usize, 7, 31, 32, 64, 65, 224, 256, 257, 4096] {
+            let mut a = vec![0u8; size];
+            let mut b = vec![0u8; size];
+            crate::drivers::get_random_bytes(&mut a);
+            crate::drivers::get_random_bytes(&mut b);
+            if size >= 8 {
+                assert_ne!(a, b, "size {}", size);
+                assert!(a.iter().any(|&x| x != 0), "size {}", size);
+            }
+        }
+    }
+
+    #[test]
+    fn test_crng_after_add_entropy() {
+        crate::drivers::init_random();
+        let before = crate::drivers::get_random_u64();
+        crate::drivers::add_entropy(b"interrupt timing", 8);
+        let after = crate::drivers::get_random_u64();
+        assert_ne!(before, after);
+        assert!(crate::drivers::entropy_available() > 0);
+    }
+
     // =========================================================================
     // Getrandom Syscall Flags Tests
     // =========================================================================
@@ -0,0 +1,135 @@
+//! Executable Image Cache Tests
+//!
+//! Tests that rewriting or unlinking a cached executable drops its image,
+//! even when size and mtime are unchanged. Uses a stub modular filesystem
+//! holding a single file, "/bin/tool".
+//!
+//! Tests register into the global modular filesystem registry and are
+//! #[serial].
+
+#[cfg(test)]
+mod tests {
+    use crate::fs::traits::FsError;
+    use crate::fs::vfs::{insert_file_image, invalidate_file_image, lookup_file_image};
+    use crate::fs::{
+        modular_fs_lookup, modular_fs_unlink, modular_fs_write_at, mount_modular_fs,
+        register_modular_fs, unregister_modular_fs, ModularFileHandle, ModularFsOps,
+    };
+    use serial_test::serial;
+
+    const TOOL_INODE: u32 = 12;
+    const TOOL_PATH: &str = "/bin/tool";
+
+    static OLD_IMAGE: [u8; 4] = *b"old!";
+    static mut FS_STATE: u8 = 0;
+
+    extern "C" fn stub_new(_image: *const u8, _size: usize) -> *mut u8 {
+        unsafe { core::ptr::addr_of_mut!(FS_STATE) }
+    }
+
+    extern "C" fn stub_lookup(
+        _handle: *mut u8,
+        path: *const u8,
+        path_len: usize,
+        out: *mut ModularFileHandle,
+    ) -> i32 {
+        let path = unsafe { core::slice::from_raw_parts(path, path_len) };
+        if path != TOOL_PATH.as_bytes() {
+            return -2;
+        }
+        unsafe {
+            (*out).inode = TOOL_INODE;
+            (*out).size = OLD_IMAGE.len() as u64;
+            (*out).mode = 0o100755;
+            (*out).mtime = 100;
+        }
+        0
+    }
+
+    extern "C" fn stub_write(
+        _file: *const ModularFileHandle,
+        _offset: usize,
+        _data: *const u8,
+        len: usize,
+    ) -> i32 {
+        len as i32
+    }
+
+    extern "C" fn stub_unlink(_handle: *mut u8, _path: *const u8, _path_len: usize) -> i32 {
+        0
+    }
+
+    /// Register and mount the stub filesystem, returning its index
+    fn mount_stub() -> u8 {
+        let index = register_modular_fs(ModularFsOps {
+            fs_type: "imgcache-test",
+            new_from_image: Some(stub_new),
+            lookup: Some(stub_lookup),
+            write_at: Some(stub_write),
+            unlink: Some(stub_unlink),
+            ..ModularFsOps::default()
+        })
+        .expect("registry full");
+        mount_modular_fs(index, &[0]).unwrap();
+        index
+    }
+
+    /// Look up the tool and cache its current image
+    fn cache_tool(index: u8) -> ModularFileHandle {
+        let handle = modular_fs_lookup(index, TOOL_PATH).unwrap();
+        insert_file_image(&handle, &OLD_IMAGE);
+        assert_eq!(lookup_file_image(&handle), Some(&OLD_IMAGE[..]));
+        handle
+    }
+
+    #[test]
+    #[serial]
+    fn test_same_second_rewrite_drops_cached_image() {
+        let index = mount_stub();
+        let handle = cache_tool(index);
+
+        // Same size, and the stub reports the same mtime afterwards
+        assert_eq!(modular_fs_write_at(&handle, 0, b"new!"), Ok(4));
+        let rewritten = modular_fs_lookup(index, TOOL_PATH).unwrap();
+        assert_eq!(
+            (rewritten.size, rewritten.mtime),
+            (handle.size, handle.mtime)
+        );
+        assert_eq!(lookup_file_image(&rewritten), None);
+
+        unregister_modular_fs(index);
+    }
+
+    #[test]
+    #[serial]
+    fn test_unlink_drops_cached_image_of_reused_inode() {
+        let index = mount_stub();
+        let handle = cache_tool(index);
+
+        assert_eq!(modular_fs_unlink(index, TOOL_PATH), Ok(()));
+        // A file recreated with the same inode, size and mtime misses
+        assert_eq!(lookup_file_image(&handle), None);
+        assert_eq!(
+            modular_fs_unlink(index, "/bin/other"),
+            Err(FsError::NotFound)
+        );
+
+        unregister_modular_fs(index);
+    }
+
+    #[test]
+    #[serial]
+    fn test_invalidate_keeps_other_inodes() {
+        let index = mount_stub();
+        let handle = cache_tool(index);
+
+        invalidate_file_image(index, TOOL_INODE + 1);
+        invalidate_file_image(index.wrapping_add(1), TOOL_INODE);
+        assert_eq!(lookup_file_image(&handle), Some(&OLD_IMAGE[..]));
+
+        invalidate_file_image(index, TOOL_INODE);
+        assert_eq!(lookup_file_image(&handle), None);
+
+        unregister_modular_fs(index);
+    }
+}
@@ -8,6 +8,8 @@
 //! - CPIO (initramfs) parsing and edge cases
 //! - devfs device filesystem
 //! - tmpfs temporary filesystem
+//! - seq_file streaming pseudo-file generation
+//! - executable image cache invalidation
 
 mod comprehensive;
 mod cpio;
@@ -16,6 +18,8 @@ mod devfs;
 mod fd;
 mod fd_edge_cases;
 mod fd_limits;
+mod file_image_cache;
 mod fstab;
+mod seq_file;
 mod tmpfs;
 mod vfs_edge_cases;
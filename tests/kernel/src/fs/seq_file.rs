@@ -0,0 +1,156 @@
+//! seq_file Tests
+//!
+//! Tests for streaming pseudo-file generation: partial reads across records,
+//! offset resume, restart on backward seeks and slot reference counting.
+//!
+//! Tests that open slots are #[serial] so `open_count()` checks see no
+//! concurrent opens.
+
+#[cfg(test)]
+mod tests {
+    use crate::fs::seq_file::{self, SeqBuf, SeqSource};
+    use crate::posix::Metadata;
+    use crate::syscalls::close_all_fds_for_process;
+    use crate::syscalls::types::{get_file_handle, set_file_handle, FileBacking, FileHandle};
+    use core::fmt::Write;
+    use serial_test::serial;
+
+    /// `count` records of the form "line N\n"
+    fn show_lines(count: u64, cursor: u64, out: &mut SeqBuf) -> Option<u64> {
+        if cursor >= count {
+            return None;
+        }
+        let _ = writeln!(out, "line {}", cursor);
+        Some(cursor + 1)
+    }
+
+    fn show_hello(out: &mut SeqBuf) {
+        let _ = out.write_str("hello\n");
+    }
+
+    fn show_pid(pid: u64, out: &mut SeqBuf) -> bool {
+        let _ = writeln!(out, "pid {}", pid);
+        true
+    }
+
+    fn expected_lines(count: u64) -> Vec<u8> {
+        let mut text = String::new();
+        for i in 0..count {
+            text.push_str(&format!("line {}\n", i));
+        }
+        text.into_bytes()
+    }
+
+    fn read_all(id: u32, chunk: usize) -> Vec<u8> {
+        let mut out = Vec::new();
+        let mut buf = vec![0u8; chunk];
+        loop {
+            let n = seq_file::read_at(id, out.len(), &mut buf);
+            if n == 0 {
+                break;
+            }
+            out.extend_from_slice(&buf[..n]);
+        }
+        out
+    }
+
+    #[test]
+    fn test_render_records() {
+        let source = SeqSource::Records(show_lines, 3);
+        assert_eq!(source.render(), b"line 0\nline 1\nline 2\n");
+        assert_eq!(SeqSource::Single(show_hello).render(), b"hello\n");
+        assert_eq!(SeqSource::Keyed(show_pid, 42).render(), b"pid 42\n");
+    }
+
+    #[test]
+    #[serial]
+    fn test_small_reads_span_records() {
+        let id = seq_file::open(SeqSource::Records(show_lines, 500)).unwrap();
+        assert_eq!(read_all(id, 7), expected_lines(500));
+        seq_file::release(id);
+    }
+
+    #[test]
+    #[serial]
+    fn test_large_read_is_not_truncated() {
+        let id = seq_file::open(SeqSource::Records(show_lines, 2000)).unwrap();
+        let expected = expected_lines(2000);
+        assert!(expected.len() > 4096);
+        assert_eq!(read_all(id, 64 * 1024), expected);
+        seq_file::release(id);
+    }
+
+    #[test]
+    #[serial]
+    fn test_backward_offset_restarts() {
+        let id = seq_file::open(SeqSource::Records(show_lines, 100)).unwrap();
+        let expected = expected_lines(100);
+
+        let mut buf = [0u8; 16];
+        let n = seq_file::read_at(id, 300, &mut buf);
+        assert_eq!(&buf[..n], &expected[300..300 + n]);
+
+        let n = seq_file::read_at(id, 0, &mut buf);
+        assert_eq!(&buf[..n], &expected[..n]);
+        seq_file::release(id);
+    }
+
+    #[test]
+    #[serial]
+    fn test_read_past_end() {
+        let id = seq_file::open(SeqSource::Single(show_hello)).unwrap();
+        let mut buf = [0u8; 16];
+        assert_eq!(seq_file::read_at(id, 6, &mut buf), 0);
+        assert_eq!(seq_file::read_at(id, 100, &mut buf), 0);
+        // Still readable from the start
+        assert_eq!(seq_file::read_at(id, 0, &mut buf), 6);
+        seq_file::release(id);
+    }
+
+    #[test]
+    #[serial]
+    fn test_dup_keeps_slot_until_last_release() {
+        let id = seq_file::open(SeqSource::Single(show_hello)).unwrap();
+        seq_file::dup(id);
+
+        let mut buf = [0u8; 16];
+        seq_file::release(id);
+        assert_eq!(seq_file::read_at(id, 0, &mut buf), 6);
+        seq_file::release(id);
+    }
+
+    #[test]
+    fn test_invalid_id() {
+        let mut buf = [0u8; 8];
+        assert_eq!(
+            seq_file::read_at(seq_file::MAX_SEQ_FILES as u32, 0, &mut buf),
+            0
+        );
+        seq_file::release(u32::MAX);
+        seq_file::dup(u32::MAX);
+    }
+
+    #[test]
+    #[serial]
+    fn test_exit_releases_open_seq_fd() {
+        let before = seq_file::open_count();
+        let id = seq_file::open(SeqSource::Single(show_hello)).unwrap();
+        let bit = 5;
+        unsafe {
+            set_file_handle(
+                bit,
+                Some(FileHandle {
+                    backing: FileBacking::Seq(id),
+                    position: 0,
+                    metadata: Metadata::empty(),
+                }),
+            );
+        }
+        assert_eq!(seq_file::open_count(), before + 1);
+
+        // The process exits with the fd still open
+        close_all_fds_for_process(1 << bit);
+        assert_eq!(seq_file::open_count(), before);
+        assert!(unsafe { get_file_handle(bit) }.is_none());
+    }
+}
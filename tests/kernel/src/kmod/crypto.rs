@@ -1,6 +1,6 @@
 //! Crypto tests (from src/kmod/crypto.rs)
 
-use crate::kmod::crypto::{sha256, Sha256};
+use crate::kmod::crypto::{sha256, BigInt, Sha256};
 
 #[test]
 fn test_sha256_empty() {
@@ -49,3 +49,63 @@ fn test_sha256_reset() {
     let expected = sha256(b"");
     assert_eq!(digest, expected);
 }
+
+fn big(bytes: &[u8]) -> BigInt {
+    BigInt::from_bytes_be(bytes).expect("value too large")
+}
+
+/// Deterministic pseudo-random bytes (xorshift64)
+fn pseudo_random_bytes(seed: &mut u64, len: usize) -> Vec<u8> {
+    (0..len)
+        .map(|_| {
+            *seed ^= *seed << 13;
+            *seed ^= *seed >> 7;
+            *seed ^= *seed << 17;
+            *seed as u8
+        })
+        .collect()
+}
+
+#[test]
+fn test_mod_exp_textbook_rsa() {
+    // n = 61 * 53 = 3233, e = 17: 65^17 mod 3233 = 2790
+    let c = BigInt::mod_exp(&big(&[65]), &big(&[17]), &big(&[0x0c, 0xa1]));
+    assert_eq!(c.to_bytes_be(), vec![0x0a, 0xe6]);
+}
+
+#[test]
+fn test_mod_exp_zero_exponent() {
+    let r = BigInt::mod_exp(&big(&[0x12, 0x34]), &big(&[]), &big(&[0x0c, 0xa1]));
+    assert_eq!(r.to_bytes_be(), vec![1]);
+}
+
+#[test]
+fn test_mod_exp_base_larger_than_modulus() {
+    // 5000 mod 3233 = 1767; 1767^3 mod 3233 = 5000^3 mod 3233
+    let a = BigInt::mod_exp(&big(&[0x13, 0x88]), &big(&[3]), &big(&[0x0c, 0xa1]));
+    let b = BigInt::mod_exp(&big(&[0x06, 0xe7]), &big(&[3]), &big(&[0x0c, 0xa1]));
+    assert_eq!(a.to_bytes_be(), b.to_bytes_be());
+}
+
+#[test]
+fn test_montgomery_matches_binary_mod_exp() {
+    let mut seed = 0x1234_5678_9abc_def1u64;
+    for &bytes in &[8usize, 33, 128, 256] {
+        for round in 0..2 {
+            let mut n = pseudo_random_bytes(&mut seed, bytes);
+            n[0] |= 0x80;
+            *n.last_mut().unwrap() |= 1; // odd: Montgomery path
+            let base = pseudo_random_bytes(&mut seed, bytes);
+            let exp = if round == 0 {
+                vec![0x01, 0x00, 0x01]
+            } else {
+                pseudo_random_bytes(&mut seed, 16)
+            };
+
+            let (n, base, exp) = (big(&n), big(&base), big(&exp));
+            let fast = BigInt::mod_exp(&base, &exp, &n);
+            let reference = BigInt::mod_exp_binary(&base, &exp, &n);
+            assert_eq!(fast.to_bytes_be(), reference.to_bytes_be());
+        }
+    }
+}
@@ -2,5 +2,6 @@
 
 mod crypto;
 mod pkcs7;
+mod symbols;
 mod nkm;
 mod taint;
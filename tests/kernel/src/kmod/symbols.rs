@@ -0,0 +1,131 @@
+//! Kernel symbol table and module load ordering tests
+//! (from src/kmod/symbols.rs and src/kmod/mod.rs)
+
+use crate::kmod::dependency_levels;
+use crate::kmod::symbols::{symbol_hash, SymbolTable, SymbolType, SymbolVisibility};
+
+fn new_table() -> SymbolTable {
+    let mut table = SymbolTable::new_uninit();
+    table.init();
+    table
+}
+
+#[test]
+fn test_symbol_hash_matches_gnu_hash() {
+    // Reference values of the DT_GNU_HASH function
+    assert_eq!(symbol_hash(""), 0x0000_1505);
+    assert_eq!(symbol_hash("printf"), 0x156b_2bb8);
+    assert_eq!(symbol_hash("exit"), 0x7c96_7e3f);
+}
+
+#[test]
+fn test_symbol_table_lookup() {
+    let mut table = new_table();
+    assert!(table.register("kmod_alloc", 0x1000, SymbolType::Function));
+    assert!(table.register("kmod_dealloc", 0x2000, SymbolType::Function));
+
+    assert_eq!(table.lookup("kmod_alloc"), Some(0x1000));
+    assert_eq!(table.lookup("kmod_dealloc"), Some(0x2000));
+    assert_eq!(table.lookup("kmod_realloc"), None);
+    assert_eq!(table.count(), 2);
+}
+
+#[test]
+fn test_symbol_table_rejects_duplicates() {
+    let mut table = new_table();
+    assert!(table.register("kmod_memcpy", 0x1000, SymbolType::Function));
+    assert!(!table.register("kmod_memcpy", 0x2000, SymbolType::Function));
+    assert_eq!(table.lookup("kmod_memcpy"), Some(0x1000));
+}
+
+#[test]
+fn test_symbol_table_hidden_not_found() {
+    let mut table = new_table();
+    assert!(table.register_with_visibility(
+        "internal",
+        0x1000,
+        SymbolType::Data,
+        SymbolVisibility::Hidden
+    ));
+    assert_eq!(table.lookup("internal"), None);
+    assert!(table.lookup_full("internal").is_none());
+}
+
+#[test]
+fn test_symbol_table_grows_index() {
+    let mut table = new_table();
+    let names: Vec<String> = (0..1000).map(|i| format!("sym_{}", i)).collect();
+    for (i, name) in names.iter().enumerate() {
+        assert!(table.register(name, i as u64, SymbolType::Function));
+    }
+    for (i, name) in names.iter().enumerate() {
+        assert_eq!(table.lookup(name), Some(i as u64));
+    }
+
+    let stats = table.memory_usage();
+    assert_eq!(stats.symbol_count, 1000);
+    assert!(stats.index_slots >= 2000);
+    assert!(stats.index_slots.is_power_of_two());
+}
+
+#[test]
+fn test_symbol_table_unregister_keeps_others() {
+    let mut table = new_table();
+    for i in 0..10u64 {
+        assert!(table.register(&format!("sym_{}", i), i, SymbolType::Function));
+    }
+    // Removing an early entry moves the last one into its place
+    assert!(table.unregister("sym_2"));
+    assert!(!table.unregister("sym_2"));
+    assert_eq!(table.lookup("sym_2"), None);
+    for i in (0..10u64).filter(|&i| i != 2) {
+        assert_eq!(table.lookup(&format!("sym_{}", i)), Some(i));
+    }
+}
+
+fn deps_of<'a>(graph: &'a [(&'a str, &'a [&'a str])]) -> impl Fn(&str) -> Vec<String> + 'a {
+    move |name| {
+        graph
+            .iter()
+            .find(|(n, _)| *n == name)
+            .map(|(_, deps)| deps.iter().map(|d| String::from(*d)).collect())
+            .unwrap_or_default()
+    }
+}
+
+#[test]
+fn test_dependency_levels_independent() {
+    let graph: [(&str, &[&str]); 3] = [("ext2", &[]), ("e1000", &[]), ("nvme", &[])];
+    let modules = ["ext2", "e1000", "nvme"];
+    let levels = dependency_levels(&modules, deps_of(&graph));
+    assert_eq!(levels, vec![vec![0, 1, 2]]);
+}
+
+#[test]
+fn test_dependency_levels_chain() {
+    let graph: [(&str, &[&str]); 4] = [
+        ("ext4", &["ext3"]),
+        ("ext3", &["ext2"]),
+        ("ext2", &[]),
+        ("virtio_blk", &[]),
+    ];
+    let modules = ["ext4", "ext3", "ext2", "virtio_blk"];
+    let levels = dependency_levels(&modules, deps_of(&graph));
+    assert_eq!(levels, vec![vec![2, 3], vec![1], vec![0]]);
+}
+
+#[test]
+fn test_dependency_levels_ignores_external_deps() {
+    let graph: [(&str, &[&str]); 2] = [("swap", &["already_loaded"]), ("ext2", &[])];
+    let modules = ["swap", "ext2"];
+    let levels = dependency_levels(&modules, deps_of(&graph));
+    assert_eq!(levels, vec![vec![0, 1]]);
+}
+
+#[test]
+fn test_dependency_levels_cycle_goes_last() {
+    let graph: [(&str, &[&str]); 3] = [("a", &["b"]), ("b", &["a"]), ("c", &[])];
+    let modules = ["a", "b", "c"];
+    let levels = dependency_levels(&modules, deps_of(&graph));
+    assert_eq!(levels, vec![vec![2], vec![0, 1]]);
+}
@@ -0,0 +1,112 @@
+//! Lazy Zeroing Tests
+//!
+//! Tests for execve()'s deferred clearing of reused user regions
+//! (src/mm/paging.rs) and the ELF image span used to pick the pages that
+//! must be cleared eagerly.
+
+#[cfg(test)]
+mod tests {
+    use crate::mm::paging::{
+        defer_user_region_zeroing, user_page_zero_pending, zero_user_range_now,
+    };
+    use crate::security::elf::ElfLoader;
+
+    const PAGE_2M: usize = 0x200000;
+
+    /// Allocate a 2 MiB aligned fake "physical" region filled with garbage
+    fn garbage_region(pages: usize) -> (Vec<u8>, u64) {
+        let mut buf = vec![0xAAu8; (pages + 1) * PAGE_2M];
+        let addr = buf.as_mut_ptr() as usize;
+        let base = (addr + PAGE_2M - 1) & !(PAGE_2M - 1);
+        (buf, base as u64)
+    }
+
+    fn page_is(base: u64, page: usize, value: u8) -> bool {
+        let slice = unsafe {
+            core::slice::from_raw_parts((base as usize + page * PAGE_2M) as *const u8, PAGE_2M)
+        };
+        slice.iter().all(|&b| b == value)
+    }
+
+    #[test]
+    fn test_deferred_pages_keep_contents_until_touched() {
+        let (_buf, base) = garbage_region(3);
+        defer_user_region_zeroing(base, 3 * PAGE_2M as u64);
+
+        for page in 0..3 {
+            assert!(user_page_zero_pending(base, (page * PAGE_2M) as u64));
+            assert!(page_is(base, page, 0xAA));
+        }
+    }
+
+    #[test]
+    fn test_zero_range_clears_only_overlapping_pages() {
+        let (_buf, base) = garbage_region(3);
+        defer_user_region_zeroing(base, 3 * PAGE_2M as u64);
+
+        // A one-byte range straddling nothing but page 1
+        zero_user_range_now(base, PAGE_2M as u64 + 17, 1);
+
+        assert!(user_page_zero_pending(base, 0));
+        assert!(!user_page_zero_pending(base, PAGE_2M as u64));
+        assert!(user_page_zero_pending(base, 2 * PAGE_2M as u64));
+        assert!(page_is(base, 0, 0xAA));
+        assert!(page_is(base, 1, 0));
+        assert!(page_is(base, 2, 0xAA));
+    }
+
+    #[test]
+    fn test_zero_range_is_idempotent() {
+        let (_buf, base) = garbage_region(2);
+        defer_user_region_zeroing(base, 2 * PAGE_2M as u64);
+
+        zero_user_range_now(base, 0, PAGE_2M as u64 + 1);
+        // Data written after the page was cleared must survive a second call
+        unsafe { *(base as *mut u8) = 0x5A };
+        zero_user_range_now(base, 0, 2 * PAGE_2M as u64);
+
+        assert_eq!(unsafe { *(base as *const u8) }, 0x5A);
+        assert!(!user_page_zero_pending(base, 0));
+        assert!(!user_page_zero_pending(base, PAGE_2M as u64));
+    }
+
+    #[test]
+    fn test_untracked_region_is_not_pending() {
+        let (_buf, base) = garbage_region(1);
+        assert!(!user_page_zero_pending(base, 0));
+        zero_user_range_now(base, 0, PAGE_2M as u64);
+        assert!(page_is(base, 0, 0xAA));
+    }
+
+    /// Minimal ELF64 with two PT_LOAD segments: text at 0x400000 (0x800 bytes)
+    /// and data+bss at 0x401000 (filesz 0x10, memsz 0x3000)
+    fn two_segment_elf() -> &'static [u8] {
+        let mut elf = vec![0u8; 64 + 2 * 56];
+        elf[0..4].copy_from_slice(b"\x7fELF");
+        elf[4] = 2; // ELFCLASS64
+        elf[5] = 1; // little endian
+        elf[6] = 1; // EV_CURRENT
+        elf[16..18].copy_from_slice(&2u16.to_le_bytes()); // ET_EXEC
+        elf[18..20].copy_from_slice(&0x3Eu16.to_le_bytes()); // x86-64
+        elf[24..32].copy_from_slice(&0x400000u64.to_le_bytes()); // e_entry
+        elf[32..40].copy_from_slice(&64u64.to_le_bytes()); // e_phoff
+        elf[54..56].copy_from_slice(&56u16.to_le_bytes()); // e_phentsize
+        elf[56..58].copy_from_slice(&2u16.to_le_bytes()); // e_phnum
+
+        let segments = [(0x400000u64, 0x800u64, 0x800u64), (0x401000, 0x10, 0x3000)];
+        for (i, (vaddr, filesz, memsz)) in segments.iter().enumerate() {
+            let ph = 64 + i * 56;
+            elf[ph..ph + 4].copy_from_slice(&1u32.to_le_bytes()); // PT_LOAD
+            elf[ph + 16..ph + 24].copy_from_slice(&vaddr.to_le_bytes());
+            elf[ph + 32..ph + 40].copy_from_slice(&filesz.to_le_bytes());
+            elf[ph + 40..ph + 48].copy_from_slice(&memsz.to_le_bytes());
+        }
+        Box::leak(elf.into_boxed_slice())
+    }
+
+    #[test]
+    fn test_image_span_covers_bss() {
+        let loader = ElfLoader::new(two_segment_elf()).expect("valid ELF");
+        assert_eq!(loader.image_span().unwrap(), 0x4000);
+    }
+}
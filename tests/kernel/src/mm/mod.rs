@@ -11,12 +11,14 @@
 //! - VMA (Virtual Memory Area) management
 //! - NUMA topology support
 //! - Paging structures
+//! - Lazy zeroing of reused user regions
 
 mod allocator;
 mod brk_edge_cases;
 mod buddy;
 mod buddy_edge_cases;
 mod comprehensive;
+mod lazy_zero;
 mod numa;
 mod paging;
 mod paging_edge_cases;
@@ -0,0 +1,386 @@
+//! Control group Tests
+//!
+//! Tests for the cgroup hierarchy, weighted group picking, cpu.max
+//! throttling, memory charging and io.stat accounting.
+//!
+//! Groups are global, so every test works under its own top-level name.
+
+use crate::process::{ProcessState, MAX_PROCESSES};
+use crate::scheduler::cgroup::{self, CgroupError, CgroupId, CGROUP_UNLIMITED, ROOT_CGROUP};
+use crate::scheduler::{ProcessEntry, SchedPolicy};
+
+const PERIOD_US: u64 = 100_000;
+const SLICE_NS: u64 = 1_000_000;
+
+type Table = [Option<ProcessEntry>; MAX_PROCESSES];
+
+fn empty_table() -> Box<Table> {
+    Box::new(core::array::from_fn(|_| None))
+}
+
+fn add_ready(table: &mut Table, pid: u64, group: CgroupId) {
+    let mut entry = ProcessEntry::empty();
+    entry.process.pid = pid;
+    entry.process.tgid = pid;
+    entry.process.state = ProcessState::Ready;
+    entry.cgroup = group;
+    let slot = table.iter_mut().find(|slot| slot.is_none()).unwrap();
+    *slot = Some(entry);
+}
+
+fn add_thread(table: &mut Table, pid: u64, tgid: u64, group: CgroupId) {
+    add_ready(table, pid, group);
+    let entry = table
+        .iter_mut()
+        .flatten()
+        .find(|e| e.process.pid == pid)
+        .unwrap();
+    entry.process.tgid = tgid;
+}
+
+fn charged(table: &Table, pid: u64) -> u64 {
+    table
+        .iter()
+        .flatten()
+        .find(|e| e.process.pid == pid)
+        .unwrap()
+        .mem_charged
+}
+
+/// Table slot of `pid`
+fn slot_of(table: &Table, pid: u64) -> usize {
+    table
+        .iter()
+        .position(|slot| matches!(slot, Some(e) if e.process.pid == pid))
+        .unwrap()
+}
+
+/// Pick and charge `rounds` times, returning how often each group ran
+fn run_rounds(table: &Table, groups: &[CgroupId], rounds: usize, now_us: u64) -> Vec<usize> {
+    let mut runs = vec![0; groups.len()];
+    for _ in 0..rounds {
+        let picked = cgroup::pick_group(table, 0, now_us).expect("runnable group");
+        let idx = groups.iter().position(|&g| g == picked).unwrap();
+        runs[idx] += 1;
+        cgroup::charge_runtime(picked, SLICE_NS, now_us);
+    }
+    runs
+}
+
+#[test]
+fn test_create_lookup_destroy() {
+    let id = cgroup::create("t_basic").unwrap();
+    assert_ne!(id, ROOT_CGROUP);
+    assert_eq!(cgroup::lookup("/t_basic/"), Ok(id));
+    assert_eq!(cgroup::lookup("/"), Ok(ROOT_CGROUP));
+
+    let child = cgroup::create("t_basic/leaf").unwrap();
+    assert_eq!(cgroup::stat(child).unwrap().parent, id as u64);
+
+    // Parent with children cannot go
+    assert_eq!(cgroup::destroy(id), Err(CgroupError::Busy));
+    assert_eq!(cgroup::destroy(child), Ok(()));
+    assert_eq!(cgroup::destroy(id), Ok(()));
+    assert_eq!(cgroup::lookup("t_basic"), Err(CgroupError::NotFound));
+    assert!(cgroup::stat(id).is_none());
+}
+
+#[test]
+fn test_create_errors() {
+    let id = cgroup::create("t_errors").unwrap();
+    assert_eq!(cgroup::create("t_errors"), Err(CgroupError::Exists));
+    assert_eq!(cgroup::create("t_missing/x"), Err(CgroupError::NotFound));
+    assert_eq!(cgroup::create("t_errors/../x"), Err(CgroupError::Invalid));
+    assert_eq!(cgroup::create("t_errors//x"), Err(CgroupError::Invalid));
+    assert_eq!(cgroup::create("t errors"), Err(CgroupError::Invalid));
+    assert_eq!(cgroup::create("/"), Err(CgroupError::Exists));
+    assert_eq!(cgroup::destroy(ROOT_CGROUP), Err(CgroupError::Busy));
+    cgroup::destroy(id).unwrap();
+}
+
+#[test]
+fn test_knob_validation() {
+    let id = cgroup::create("t_knobs").unwrap();
+    assert_eq!(cgroup::set_cpu_weight(id, 0), Err(CgroupError::Invalid));
+    assert_eq!(
+        cgroup::set_cpu_weight(id, 10_001),
+        Err(CgroupError::Invalid)
+    );
+    assert_eq!(cgroup::set_cpu_weight(id, 250), Ok(()));
+    assert_eq!(cgroup::set_cpu_period(id, 10), Err(CgroupError::Invalid));
+    assert_eq!(cgroup::set_cpu_quota(id, 50_000), Ok(()));
+    assert_eq!(cgroup::set_io_weight(id, 500), Ok(()));
+    assert_eq!(cgroup::set_memory_max(id, 1 << 20), Ok(()));
+
+    // The root has no limits
+    assert_eq!(
+        cgroup::set_cpu_weight(ROOT_CGROUP, 200),
+        Err(CgroupError::Invalid)
+    );
+
+    let stat = cgroup::stat(id).unwrap();
+    assert_eq!(stat.cpu_weight, 250);
+    assert_eq!(stat.cpu_quota_us, 50_000);
+    assert_eq!(stat.cpu_period_us, PERIOD_US);
+    assert_eq!(stat.io_weight, 500);
+    assert_eq!(stat.memory_max, 1 << 20);
+    assert_eq!(stat.memory_high, CGROUP_UNLIMITED);
+    cgroup::destroy(id).unwrap();
+}
+
+#[test]
+fn test_pick_follows_cpu_weight() {
+    let parent = cgroup::create("t_weight").unwrap();
+    let light = cgroup::create("t_weight/light").unwrap();
+    let heavy = cgroup::create("t_weight/heavy").unwrap();
+    cgroup::set_cpu_weight(heavy, 300).unwrap();
+
+    let mut table = empty_table();
+    add_ready(&mut table, 1, light);
+    add_ready(&mut table, 2, heavy);
+
+    // Only the subtree is runnable, so the root always descends into it
+    let runs = run_rounds(&table, &[light, heavy], 400, 0);
+    assert!(
+        runs[1] > runs[0] * 5 / 2 && runs[1] < runs[0] * 7 / 2,
+        "expected ~3:1, got {:?}",
+        runs
+    );
+
+    for id in [light, heavy, parent] {
+        cgroup::destroy(id).unwrap();
+    }
+}
+
+#[test]
+fn test_equal_weights_share_evenly() {
+    let parent = cgroup::create("t_even").unwrap();
+    let a = cgroup::create("t_even/a").unwrap();
+    let b = cgroup::create("t_even/b").unwrap();
+
+    // Many tasks in one group do not buy it more CPU
+    let mut table = empty_table();
+    for pid in 10..18 {
+        add_ready(&mut table, pid, a);
+    }
+    add_ready(&mut table, 20, b);
+
+    let runs = run_rounds(&table, &[a, b], 200, 0);
+    assert!(runs[0].abs_diff(runs[1]) <= 2, "got {:?}", runs);
+
+    for id in [a, b, parent] {
+        cgroup::destroy(id).unwrap();
+    }
+}
+
+#[test]
+fn test_idle_group_does_not_bank_runtime() {
+    let parent = cgroup::create("t_idle").unwrap();
+    let busy = cgroup::create("t_idle/busy").unwrap();
+    let idle = cgroup::create("t_idle/idle").unwrap();
+
+    let mut table = empty_table();
+    add_ready(&mut table, 1, busy);
+    run_rounds(&table, &[busy], 1000, 0);
+
+    // The idle group wakes up; it may lead briefly but not for 1000 slices
+    add_ready(&mut table, 2, idle);
+    let runs = run_rounds(&table, &[busy, idle], 40, 0);
+    assert!(runs[0] >= 15, "busy group starved: {:?}", runs);
+
+    for id in [busy, idle, parent] {
+        cgroup::destroy(id).unwrap();
+    }
+}
+
+#[test]
+fn test_quota_throttles_until_next_period() {
+    let id = cgroup::create("t_quota").unwrap();
+    cgroup::set_cpu_quota(id, 2_000).unwrap();
+    cgroup::set_cpu_period(id, PERIOD_US).unwrap();
+
+    let mut table = empty_table();
+    add_ready(&mut table, 1, id);
+
+    let now = 10 * PERIOD_US;
+    assert_eq!(cgroup::pick_group(&table, 0, now), Some(id));
+    assert!(!cgroup::charge_runtime(id, 1_000_000, now));
+    assert!(cgroup::charge_runtime(id, 1_000_000, now + 10));
+    assert!(cgroup::is_throttled(id, now + 20));
+
+    // Throttled and nothing else queued: nothing to run
+    assert_eq!(cgroup::pick_group(&table, 0, now + 20), None);
+
+    // Next period
+    let later = now + PERIOD_US + 10;
+    assert_eq!(cgroup::pick_group(&table, 0, later), Some(id));
+    let stat = cgroup::stat(id).unwrap();
+    assert_eq!(stat.nr_throttled, 1);
+    assert!(stat.nr_periods >= 1);
+    assert_eq!(stat.throttled_us, later - (now + 10));
+    assert_eq!(stat.usage_us, 2_000);
+
+    cgroup::destroy(id).unwrap();
+}
+
+#[test]
+fn test_throttled_parent_blocks_subtree() {
+    let parent = cgroup::create("t_thrparent").unwrap();
+    let child = cgroup::create("t_thrparent/child").unwrap();
+    cgroup::set_cpu_quota(parent, 1_000).unwrap();
+
+    let mut table = empty_table();
+    add_ready(&mut table, 1, child);
+    add_ready(&mut table, 2, ROOT_CGROUP);
+
+    let now = 5 * PERIOD_US;
+    assert!(cgroup::charge_runtime(child, 2_000_000, now));
+    assert!(cgroup::is_throttled(child, now));
+    // Root tasks still run
+    assert_eq!(cgroup::pick_group(&table, 0, now), Some(ROOT_CGROUP));
+
+    cgroup::destroy(child).unwrap();
+    cgroup::destroy(parent).unwrap();
+}
+
+#[test]
+fn test_pick_skips_realtime_and_affinity() {
+    let id = cgroup::create("t_rt").unwrap();
+    let mut table = empty_table();
+    add_ready(&mut table, 1, id);
+    {
+        let entry = table[0].as_mut().unwrap();
+        entry.policy = SchedPolicy::Realtime;
+    }
+    assert_eq!(cgroup::pick_group(&table, 0, 0), None);
+
+    add_ready(&mut table, 2, id);
+    table[1].as_mut().unwrap().cpu_affinity.clear(0);
+    assert_eq!(cgroup::pick_group(&table, 0, 0), None);
+    assert_eq!(cgroup::pick_group(&table, 1, 0), Some(id));
+
+    cgroup::destroy(id).unwrap();
+}
+
+#[test]
+fn test_memory_max_and_high() {
+    let parent = cgroup::create("t_mem").unwrap();
+    let child = cgroup::create("t_mem/child").unwrap();
+    cgroup::set_memory_max(parent, 64 * 1024).unwrap();
+    cgroup::set_memory_high(child, 16 * 1024).unwrap();
+
+    assert_eq!(cgroup::try_charge_memory(child, 8 * 1024), Ok(false));
+    assert_eq!(cgroup::try_charge_memory(child, 16 * 1024), Ok(true));
+    // Over the parent's max: refused, nothing charged anywhere
+    assert_eq!(
+        cgroup::try_charge_memory(child, 48 * 1024),
+        Err(CgroupError::OverLimit)
+    );
+    assert_eq!(cgroup::stat(child).unwrap().memory_current, 24 * 1024);
+    assert_eq!(cgroup::stat(parent).unwrap().memory_current, 24 * 1024);
+
+    let stat = cgroup::stat(child).unwrap();
+    assert_eq!(stat.memory_events_high, 1);
+    assert_eq!(cgroup::stat(parent).unwrap().memory_events_max, 1);
+
+    cgroup::uncharge_memory(child, 24 * 1024);
+    assert_eq!(cgroup::stat(child).unwrap().memory_current, 0);
+    assert_eq!(cgroup::stat(parent).unwrap().memory_current, 0);
+
+    cgroup::destroy(child).unwrap();
+    cgroup::destroy(parent).unwrap();
+}
+
+#[test]
+fn test_release_memory_drops_entry_charge() {
+    let id = cgroup::create("t_release").unwrap();
+    let mut entry = ProcessEntry::empty();
+    entry.cgroup = id;
+
+    assert_eq!(cgroup::try_charge_memory(id, 12 * 1024), Ok(false));
+    entry.mem_charged = 12 * 1024;
+
+    // What execve does when it replaces the image
+    cgroup::release_memory(&mut entry);
+    assert_eq!(entry.mem_charged, 0);
+    assert_eq!(cgroup::stat(id).unwrap().memory_current, 0);
+
+    cgroup::release_memory(&mut entry);
+    assert_eq!(cgroup::stat(id).unwrap().memory_current, 0);
+
+    cgroup::destroy(id).unwrap();
+}
+
+#[test]
+fn test_thread_group_shares_memory_charge() {
+    let id = cgroup::create("t_tgmem").unwrap();
+    let mut table = empty_table();
+    add_ready(&mut table, 40, id);
+    add_thread(&mut table, 41, 40, id);
+
+    // Thread 41 maps, the leader holds the charge; the leader unmaps part
+    assert_eq!(
+        cgroup::charge_thread_group(&mut table, 40, 8 * 1024),
+        Ok(false)
+    );
+    assert_eq!((charged(&table, 40), charged(&table, 41)), (8 * 1024, 0));
+    cgroup::uncharge_thread_group(&mut table, 40, 4 * 1024);
+    assert_eq!(cgroup::stat(id).unwrap().memory_current, 4 * 1024);
+
+    // A thread exiting leaves the group's mappings charged
+    let thread = slot_of(&table, 41);
+    assert!(!cgroup::release_thread_memory(&mut table, thread));
+    table[thread] = None;
+    assert_eq!(cgroup::stat(id).unwrap().memory_current, 4 * 1024);
+
+    // The last thread takes the charge with it
+    let leader = slot_of(&table, 40);
+    assert!(cgroup::release_thread_memory(&mut table, leader));
+    assert_eq!(cgroup::stat(id).unwrap().memory_current, 0);
+
+    cgroup::destroy(id).unwrap();
+}
+
+#[test]
+fn test_leader_exit_hands_charge_to_thread() {
+    let id = cgroup::create("t_tgheir").unwrap();
+    let mut table = empty_table();
+    add_ready(&mut table, 50, id);
+    add_thread(&mut table, 51, 50, id);
+
+    cgroup::charge_thread_group(&mut table, 50, 12 * 1024).unwrap();
+    let leader = slot_of(&table, 50);
+    assert!(!cgroup::release_thread_memory(&mut table, leader));
+    table[leader] = None;
+    assert_eq!(charged(&table, 51), 12 * 1024);
+
+    // Unmapping through the survivor still finds the charge
+    cgroup::uncharge_thread_group(&mut table, 50, 12 * 1024);
+    assert_eq!(charged(&table, 51), 0);
+    assert_eq!(cgroup::stat(id).unwrap().memory_current, 0);
+
+    cgroup::destroy(id).unwrap();
+}
+
+#[test]
+fn test_release_group_memory_on_exec() {
+    let id = cgroup::create("t_tgexec").unwrap();
+    let mut table = empty_table();
+    add_ready(&mut table, 60, id);
+    add_thread(&mut table, 61, 60, id);
+
+    cgroup::charge_thread_group(&mut table, 60, 16 * 1024).unwrap();
+    cgroup::release_group_memory(&mut table, 60);
+    assert_eq!(charged(&table, 60), 0);
+    assert_eq!(cgroup::stat(id).unwrap().memory_current, 0);
+
+    cgroup::destroy(id).unwrap();
+}
+
+#[test]
+fn test_error_errno() {
+    use crate::posix::errno;
+    assert_eq!(CgroupError::OverLimit.errno(), errno::ENOMEM);
+    assert_eq!(CgroupError::Busy.errno(), errno::EBUSY);
+    assert_eq!(CgroupError::NotFound.errno(), errno::ENOENT);
+}
@@ -109,6 +109,9 @@ fn make_process_entry(proc: Process) -> ProcessEntry {
         last_cpu: 0,
         numa_preferred_node: 0,
         numa_policy: crate::numa::NumaPolicy::Local,
+        sched_info: crate::scheduler::SchedInfo::new(),
+        cgroup: crate::scheduler::cgroup::ROOT_CGROUP,
+        mem_charged: 0,
     }
 }
 
@@ -15,6 +15,7 @@
 //! - TTY foreground process bug detection
 //! - Waiter mechanism bug detection
 //! - Process state machine bug detection
+//! - Pressure stall information and schedstat
 
 // Test isolation utilities - must be first
 pub mod test_isolation;
@@ -34,6 +35,8 @@ mod keyboard_handler_source_test;
 mod keyboard_interrupt_bug;
 mod percpu;
 mod priority_tests;
+mod psi;
+mod cgroup;
 mod smp;
 mod smp_comprehensive;
 mod stress;
@@ -0,0 +1,218 @@
+//! Pressure Stall Information and schedstat Tests
+//!
+//! Tests for PSI state classification, stall time totals, the 10s/60s/300s
+//! averages and per-process run delay accounting.
+
+use crate::process::{ProcessState, MAX_PROCESSES};
+use crate::scheduler::psi::{self, PsiGroup, PsiResource, PsiSample};
+use crate::scheduler::{update_curr, ProcessEntry, SchedInfo};
+
+const SECOND_US: u64 = 1_000_000;
+
+fn state_bit(res: PsiResource, full: bool) -> u32 {
+    1 << (res as u32 * 2 + full as u32)
+}
+
+fn report(group: &PsiGroup, res: PsiResource) -> String {
+    let mut out = String::new();
+    group.write_report(res, &mut out).unwrap();
+    out
+}
+
+#[test]
+fn test_sample_idle_has_no_pressure() {
+    let sample = PsiSample {
+        running: 2,
+        ..PsiSample::default()
+    };
+    assert_eq!(sample.states(), 0);
+}
+
+#[test]
+fn test_sample_cpu_some() {
+    let sample = PsiSample {
+        ready: 3,
+        running: 1,
+        ..PsiSample::default()
+    };
+    assert_eq!(sample.states(), state_bit(PsiResource::Cpu, false));
+}
+
+#[test]
+fn test_sample_io_full_when_nothing_productive() {
+    let sample = PsiSample {
+        running: 1,
+        iowait: 1,
+        ..PsiSample::default()
+    };
+    let states = sample.states();
+    assert_ne!(states & state_bit(PsiResource::Io, false), 0);
+    assert_ne!(states & state_bit(PsiResource::Io, true), 0);
+    assert_eq!(states & state_bit(PsiResource::Memory, false), 0);
+}
+
+#[test]
+fn test_sample_io_some_with_productive_task() {
+    let sample = PsiSample {
+        running: 2,
+        iowait: 1,
+        ..PsiSample::default()
+    };
+    let states = sample.states();
+    assert_ne!(states & state_bit(PsiResource::Io, false), 0);
+    assert_eq!(states & state_bit(PsiResource::Io, true), 0);
+}
+
+#[test]
+fn test_sample_memstall_with_waiting_tasks_is_not_full() {
+    let sample = PsiSample {
+        ready: 1,
+        running: 1,
+        memstall: 1,
+        ..PsiSample::default()
+    };
+    let states = sample.states();
+    assert_ne!(states & state_bit(PsiResource::Memory, false), 0);
+    assert_eq!(states & state_bit(PsiResource::Memory, true), 0);
+    assert_ne!(states & state_bit(PsiResource::Cpu, false), 0);
+}
+
+#[test]
+fn test_memory_high_throttle_counted_per_task() {
+    let mut table: Box<[Option<ProcessEntry>; MAX_PROCESSES]> =
+        Box::new(core::array::from_fn(|_| None));
+    for (slot, (state, throttled)) in table
+        .iter_mut()
+        .zip([(ProcessState::Running, false), (ProcessState::Ready, true)])
+    {
+        let mut entry = ProcessEntry::empty();
+        entry.process.state = state;
+        entry.sched_info.memstall = throttled;
+        *slot = Some(entry);
+    }
+
+    let sample = psi::collect_sample(&table);
+    assert_eq!(sample.memthrottled, 1);
+    // The yielding task is not waiting for a CPU
+    assert_eq!((sample.ready, sample.running), (0, 1));
+    let states = sample.states();
+    assert_ne!(states & state_bit(PsiResource::Memory, false), 0);
+    assert_eq!(states & state_bit(PsiResource::Memory, true), 0);
+    assert_eq!(states & state_bit(PsiResource::Cpu, false), 0);
+
+    // Once it resumes, nothing is left behind on any CPU
+    table[1].as_mut().unwrap().sched_info.memstall = false;
+    assert_eq!(
+        psi::collect_sample(&table).states(),
+        state_bit(PsiResource::Cpu, false)
+    );
+}
+
+#[test]
+fn test_group_totals() {
+    let mut group = PsiGroup::new();
+    let io = state_bit(PsiResource::Io, false) | state_bit(PsiResource::Io, true);
+    group.account(io, 500, 1000);
+    group.account(state_bit(PsiResource::Io, false), 250, 1250);
+
+    assert_eq!(group.total_us(PsiResource::Io), (750, 500));
+    assert_eq!(group.total_us(PsiResource::Cpu), (0, 0));
+}
+
+#[test]
+fn test_group_averages_converge() {
+    let mut group = PsiGroup::new();
+    let cpu = state_bit(PsiResource::Cpu, false);
+    let mut now = SECOND_US;
+    group.account(0, 0, now);
+
+    // Half of every 2s period stalled
+    for _ in 0..100 {
+        group.account(cpu, SECOND_US, now + SECOND_US);
+        group.account(0, SECOND_US, now + 2 * SECOND_US);
+        now += 2 * SECOND_US;
+    }
+
+    let [avg10, avg60, avg300] = group.some_avg(PsiResource::Cpu);
+    assert!((4900..=5100).contains(&avg10), "avg10 = {}", avg10);
+    assert!(avg60 > 4500 && avg60 <= 5100, "avg60 = {}", avg60);
+    assert!(avg300 > 0 && avg300 < avg60, "avg300 = {}", avg300);
+}
+
+#[test]
+fn test_group_averages_decay_after_idle_gap() {
+    let mut group = PsiGroup::new();
+    let io = state_bit(PsiResource::Io, false);
+    group.account(0, 0, SECOND_US);
+    for i in 1..=10 {
+        group.account(io, 2 * SECOND_US, SECOND_US + i * 2 * SECOND_US);
+    }
+    let before = group.some_avg(PsiResource::Io)[0];
+    assert!(before > 8000, "avg10 = {}", before);
+
+    // A minute without samples decays avg10 to nothing
+    group.account(0, 0, 81 * SECOND_US);
+    assert!(group.some_avg(PsiResource::Io)[0] < 100);
+}
+
+#[test]
+fn test_report_format() {
+    let group = PsiGroup::new();
+    let text = report(&group, PsiResource::Memory);
+    assert_eq!(
+        text,
+        "some avg10=0.00 avg60=0.00 avg300=0.00 total=0\n\
+         full avg10=0.00 avg60=0.00 avg300=0.00 total=0\n"
+    );
+}
+
+#[test]
+fn test_resource_names() {
+    for res in PsiResource::ALL {
+        assert_eq!(PsiResource::from_name(res.name()), Some(res));
+    }
+    assert_eq!(PsiResource::from_name("gpu"), None);
+}
+
+#[test]
+fn test_schedinfo_run_delay() {
+    let mut info = SchedInfo::new();
+    info.queued(1_000);
+    // Queuing again while queued keeps the first timestamp
+    info.queued(1_500);
+    info.arrive(3_000);
+
+    assert_eq!(info.run_delay_ns, 2_000_000);
+    assert_eq!(info.timeslices, 1);
+    assert_eq!(info.queued_at_us, 0);
+
+    // Arriving without having been queued only counts the timeslice
+    info.arrive(4_000);
+    assert_eq!(info.run_delay_ns, 2_000_000);
+    assert_eq!(info.timeslices, 2);
+}
+
+#[test]
+fn test_set_state_tracks_timeslices() {
+    let mut entry = ProcessEntry::empty();
+    entry.process.state = ProcessState::Sleeping;
+
+    entry.set_state(ProcessState::Ready);
+    assert_ne!(entry.sched_info.queued_at_us, 0);
+    entry.set_state(ProcessState::Running);
+    entry.set_state(ProcessState::Running);
+    assert_eq!(entry.sched_info.timeslices, 1);
+    assert_eq!(entry.sched_info.queued_at_us, 0);
+
+    entry.set_state(ProcessState::Ready);
+    entry.set_state(ProcessState::Sleeping);
+    assert_eq!(entry.sched_info.queued_at_us, 0);
+}
+
+#[test]
+fn test_update_curr_accumulates_run_time() {
+    let mut entry = ProcessEntry::empty();
+    update_curr(&mut entry, 1_500_000);
+    update_curr(&mut entry, 500_000);
+    assert_eq!(entry.sched_info.run_ns, 2_000_000);
+}
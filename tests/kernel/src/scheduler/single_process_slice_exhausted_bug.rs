@@ -105,6 +105,9 @@ mod tests {
             last_cpu: 0,
             numa_preferred_node: numa::NUMA_NO_NODE,
             numa_policy: numa::NumaPolicy::Local,
+            sched_info: crate::scheduler::SchedInfo::new(),
+            cgroup: crate::scheduler::cgroup::ROOT_CGROUP,
+            mem_charged: 0,
         }
     }
 
@@ -104,6 +104,9 @@ fn make_process_entry(proc: Process, vruntime: u64) -> ProcessEntry {
         last_cpu: 0,
         numa_preferred_node: crate::numa::NUMA_NO_NODE,
         numa_policy: crate::numa::NumaPolicy::Local,
+        sched_info: crate::scheduler::SchedInfo::new(),
+        cgroup: crate::scheduler::cgroup::ROOT_CGROUP,
+        mem_charged: 0,
     }
 }
 
@@ -9,11 +9,14 @@
 //! - CpuInfo structure
 //! - Preemption control
 //! - Per-CPU configuration constants
+//! - Kernel workqueues and their node pools
 
 mod types;
 mod cpu_data;
 mod cpu_status;
 mod constants;
+mod workqueue;
+mod pool;
 
 pub use types::*;
 pub use cpu_data::*;
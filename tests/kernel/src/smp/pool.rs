@@ -0,0 +1,56 @@
+//! Tests for smp/pool.rs - Fixed-Capacity Node Pools
+
+#[cfg(test)]
+mod tests {
+    use crate::smp::pool::SlotPool;
+    use std::collections::HashSet;
+    use std::sync::atomic::{AtomicUsize, Ordering};
+    use std::vec::Vec;
+
+    #[test]
+    fn test_alloc_until_exhausted() {
+        let pool: SlotPool<u64, 2> = SlotPool::new();
+        assert_eq!(pool.capacity(), 128);
+
+        let slots: Vec<*mut u64> = (0..128).map(|i| pool.alloc(i).unwrap()).collect();
+        assert_eq!(pool.in_use(), 128);
+        assert!(pool.alloc(999).is_none(), "full pool must refuse");
+
+        let distinct: HashSet<usize> = slots.iter().map(|&p| p as usize).collect();
+        assert_eq!(distinct.len(), 128);
+        for (i, &slot) in slots.iter().enumerate() {
+            assert_eq!(unsafe { *slot }, i as u64);
+        }
+    }
+
+    #[test]
+    fn test_free_makes_slot_reusable() {
+        let pool: SlotPool<u64, 1> = SlotPool::new();
+        let slots: Vec<*mut u64> = (0..64).map(|i| pool.alloc(i).unwrap()).collect();
+
+        unsafe { pool.free(slots[37]) };
+        assert_eq!(pool.in_use(), 63);
+        assert_eq!(pool.alloc(7), Some(slots[37]));
+        assert!(pool.alloc(8).is_none());
+    }
+
+    static DROPS: AtomicUsize = AtomicUsize::new(0);
+
+    struct Tracked(#[allow(dead_code)] u64);
+
+    impl Drop for Tracked {
+        fn drop(&mut self) {
+            DROPS.fetch_add(1, Ordering::SeqCst);
+        }
+    }
+
+    #[test]
+    fn test_free_drops_value() {
+        let pool: SlotPool<Tracked, 1> = SlotPool::new();
+        let slot = pool.alloc(Tracked(1)).unwrap();
+        assert_eq!(DROPS.load(Ordering::SeqCst), 0);
+        unsafe { pool.free(slot) };
+        assert_eq!(DROPS.load(Ordering::SeqCst), 1);
+        assert_eq!(pool.in_use(), 0);
+    }
+}
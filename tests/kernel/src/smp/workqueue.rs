@@ -0,0 +1,123 @@
+//! Tests for smp/workqueue.rs - Kernel Workqueues
+//!
+//! Runs on the (simulated) boot CPU: queued work is executed by
+//! `run_pending()`, as the idle loop would.
+
+#[cfg(test)]
+mod tests {
+    use crate::smp::workqueue::{
+        cancel_delayed_work, has_pending, queue_delayed_work, queue_work, queue_work_on,
+        queue_work_unbound, run_pending, WorkTarget, MAX_QUEUED_WORK,
+    };
+    use crate::smp::MAX_CPUS;
+    use std::sync::atomic::{AtomicUsize, Ordering};
+    use std::sync::Mutex;
+    use std::vec::Vec;
+
+    /// The queues are global; keep tests from draining each other's work
+    static SERIAL: Mutex<()> = Mutex::new(());
+
+    static COUNTER: AtomicUsize = AtomicUsize::new(0);
+    static ORDER: Mutex<Vec<usize>> = Mutex::new(Vec::new());
+
+    fn count(arg: usize) {
+        COUNTER.fetch_add(arg, Ordering::SeqCst);
+    }
+
+    fn record(arg: usize) {
+        ORDER.lock().unwrap().push(arg);
+    }
+
+    fn drain() {
+        while run_pending() > 0 {}
+    }
+
+    #[test]
+    fn test_queue_work_runs_on_current_cpu() {
+        let _guard = SERIAL.lock().unwrap();
+        drain();
+        COUNTER.store(0, Ordering::SeqCst);
+
+        assert!(queue_work(count, 3));
+        assert!(queue_work_on(0, count, 4));
+        assert!(has_pending());
+        assert_eq!(COUNTER.load(Ordering::SeqCst), 0, "work must be deferred");
+
+        assert_eq!(run_pending(), 2);
+        assert_eq!(COUNTER.load(Ordering::SeqCst), 7);
+        assert_eq!(run_pending(), 0);
+    }
+
+    #[test]
+    fn test_queue_work_rejects_offline_cpu() {
+        let _guard = SERIAL.lock().unwrap();
+        assert!(!queue_work_on(MAX_CPUS as u16, count, 1));
+        assert!(!queue_work_on(1, count, 1), "APs are offline in tests");
+    }
+
+    #[test]
+    fn test_work_runs_in_submission_order() {
+        let _guard = SERIAL.lock().unwrap();
+        drain();
+        ORDER.lock().unwrap().clear();
+
+        for i in 0..5 {
+            queue_work(record, i);
+        }
+        queue_work_unbound(record, 100);
+        run_pending();
+
+        assert_eq!(*ORDER.lock().unwrap(), [0, 1, 2, 3, 4, 100]);
+    }
+
+    #[test]
+    fn test_expired_delayed_work_is_promoted() {
+        let _guard = SERIAL.lock().unwrap();
+        drain();
+        COUNTER.store(0, Ordering::SeqCst);
+
+        queue_delayed_work(WorkTarget::Cpu(0), count, 10, 0);
+        // Offline targets fall back to the unbound pool
+        queue_delayed_work(WorkTarget::Cpu(1), count, 20, 0);
+        assert!(has_pending());
+
+        drain();
+        assert_eq!(COUNTER.load(Ordering::SeqCst), 30);
+    }
+
+    #[test]
+    fn test_cancel_delayed_work() {
+        let _guard = SERIAL.lock().unwrap();
+        drain();
+        COUNTER.store(0, Ordering::SeqCst);
+
+        queue_delayed_work(WorkTarget::Unbound, count, 1, 60_000);
+        queue_delayed_work(WorkTarget::Unbound, count, 2, 60_000);
+        assert_eq!(cancel_delayed_work(count, 1), 1);
+        assert_eq!(cancel_delayed_work(count, 1), 0);
+        assert_eq!(cancel_delayed_work(count, 2), 1);
+
+        drain();
+        assert_eq!(COUNTER.load(Ordering::SeqCst), 0);
+    }
+
+    #[test]
+    fn test_queue_fails_when_pool_exhausted() {
+        let _guard = SERIAL.lock().unwrap();
+        drain();
+        COUNTER.store(0, Ordering::SeqCst);
+
+        for _ in 0..MAX_QUEUED_WORK {
+            assert!(queue_work(count, 1));
+        }
+        assert!(!queue_work(count, 1));
+        assert!(!queue_work_unbound(count, 1));
+        assert!(!queue_delayed_work(WorkTarget::Unbound, count, 1, 0));
+
+        // Running work returns its nodes to the pool
+        assert_eq!(run_pending(), MAX_QUEUED_WORK);
+        assert_eq!(COUNTER.load(Ordering::SeqCst), MAX_QUEUED_WORK);
+        assert!(queue_work_unbound(count, 1));
+        drain();
+    }
+}
@@ -5,8 +5,10 @@
 //! - Address tokens
 //! - Container management
 //! - Twin driver model
+//! - Descriptor rings
 
 pub mod isolation;
 pub mod address_token;
 pub mod container;
 pub mod registry;
+pub mod ring;
@@ -0,0 +1,277 @@
+//! Tests for udrv/ring.rs - Shared-memory Descriptor Rings
+//!
+//! Tests the submission/completion protocol between the kernel end
+//! (RingSubmitter) and the driver end (RingServicer).
+
+#[cfg(test)]
+mod tests {
+    use crate::udrv::ring::{
+        init_region, region_size, ring_op, IoCompletion, IoDesc, RingError,
+        RingHeader, RingServicer, RingSubmitter,
+    };
+    use core::sync::atomic::{AtomicU32, Ordering};
+
+    /// 64-byte aligned backing store standing in for a shared region
+    #[repr(C, align(4096))]
+    struct Page([u8; 4096]);
+
+    fn alloc_region(entries: u32, data_size: u32) -> (Vec<Page>, u64) {
+        let size = region_size(entries, data_size).unwrap();
+        let pages = (size as usize + 4095) / 4096;
+        let mut region: Vec<Page> = (0..pages).map(|_| Page([0xAA; 4096])).collect();
+        unsafe {
+            init_region(region.as_mut_ptr() as *mut u8, entries, data_size).unwrap();
+        }
+        (region, size)
+    }
+
+    fn endpoints(region: &mut Vec<Page>, size: u64) -> (RingSubmitter, RingServicer) {
+        let base = region.as_mut_ptr() as *mut u8;
+        unsafe {
+            (
+                RingSubmitter::attach(base, size, 7).unwrap(),
+                RingServicer::attach(base, size).unwrap(),
+            )
+        }
+    }
+
+    fn desc(cookie: u64) -> IoDesc {
+        IoDesc {
+            opcode: ring_op::READ,
+            flags: 0,
+            len: 512,
+            data_offset: 0,
+            sector: cookie * 8,
+            cookie,
+        }
+    }
+
+    // =========================================================================
+    // Layout Tests
+    // =========================================================================
+
+    #[test]
+    fn test_entry_sizes() {
+        assert_eq!(core::mem::size_of::<IoDesc>(), 32);
+        assert_eq!(core::mem::size_of::<IoCompletion>(), 16);
+        // Magic/geometry line plus four index lines
+        assert_eq!(core::mem::size_of::<RingHeader>(), 5 * 64);
+    }
+
+    #[test]
+    fn test_region_size() {
+        // 320 + 64*32 + 64*16 = 3392 -> data at 4096
+        assert_eq!(region_size(64, 8192), Some(4096 + 8192));
+        assert_eq!(region_size(0, 4096), None);
+        assert_eq!(region_size(48, 4096), None);
+        assert_eq!(region_size(8192, 4096), None);
+    }
+
+    #[test]
+    fn test_attach_rejects_uninitialized() {
+        let mut region: Vec<Page> = (0..2).map(|_| Page([0; 4096])).collect();
+        let base = region.as_mut_ptr() as *mut u8;
+        let result = unsafe { RingServicer::attach(base, 8192) };
+        assert_eq!(result.err(), Some(RingError::BadMagic));
+    }
+
+    #[test]
+    fn test_attach_rejects_short_region() {
+        let (mut region, size) = alloc_region(64, 8192);
+        let base = region.as_mut_ptr() as *mut u8;
+        let result = unsafe { RingSubmitter::attach(base, size - 1, 0) };
+        assert_eq!(result.err(), Some(RingError::RegionTooSmall));
+    }
+
+    // =========================================================================
+    // Protocol Tests
+    // =========================================================================
+
+    #[test]
+    fn test_round_trip() {
+        let (mut region, size) = alloc_region(16, 4096);
+        let (mut sub, mut svc) = endpoints(&mut region, size);
+        sub.set_batch(1);
+
+        sub.data(0, 4).unwrap().copy_from_slice(b"ping");
+        sub.submit(&desc(42)).unwrap();
+
+        let mut fetched = [IoDesc::default(); 4];
+        assert_eq!(svc.fetch(&mut fetched), 1);
+        assert_eq!(fetched[0], desc(42));
+        assert_eq!(&svc.data(&fetched[0]).unwrap()[..4], b"ping");
+
+        svc.complete(&IoCompletion { cookie: 42, status: 0, len: 512 }).unwrap();
+        // Nothing visible before publish
+        assert!(sub.poll_one().unwrap().is_none());
+        assert!(svc.publish());
+
+        let done = sub.poll_one().unwrap().unwrap();
+        assert_eq!(done.cookie, 42);
+        assert_eq!(done.len, 512);
+        assert_eq!(sub.in_flight(), 0);
+    }
+
+    #[test]
+    fn test_doorbell_batching() {
+        let (mut region, size) = alloc_region(64, 4096);
+        let (mut sub, mut svc) = endpoints(&mut region, size);
+        sub.set_batch(8);
+
+        let mut fetched = [IoDesc::default(); 64];
+        for i in 0..7 {
+            sub.submit(&desc(i)).unwrap();
+        }
+        // Below the batch size nothing is published yet
+        assert_eq!(svc.fetch(&mut fetched), 0);
+        assert_eq!(sub.stats().doorbells, 0);
+
+        sub.submit(&desc(7)).unwrap();
+        assert_eq!(sub.stats().doorbells, 1);
+        assert_eq!(svc.fetch(&mut fetched), 8);
+
+        sub.submit(&desc(8)).unwrap();
+        assert!(sub.flush());
+        assert!(!sub.flush());
+        assert_eq!(svc.fetch(&mut fetched), 1);
+        assert_eq!(fetched[0].cookie, 8);
+        assert_eq!(sub.stats().doorbells, 2);
+    }
+
+    #[test]
+    fn test_full_ring() {
+        let (mut region, size) = alloc_region(4, 4096);
+        let (mut sub, mut svc) = endpoints(&mut region, size);
+
+        for i in 0..4 {
+            sub.submit(&desc(i)).unwrap();
+        }
+        // In-flight limit reached; the pending batch is flushed on the way out
+        assert_eq!(sub.submit(&desc(4)), Err(RingError::Full));
+
+        let mut fetched = [IoDesc::default(); 4];
+        assert_eq!(svc.fetch(&mut fetched), 4);
+        // Fetching alone does not free slots, completions do
+        assert_eq!(sub.submit(&desc(4)), Err(RingError::Full));
+
+        svc.complete(&IoCompletion { cookie: 0, status: 0, len: 0 }).unwrap();
+        svc.publish();
+        assert!(sub.poll_one().unwrap().is_some());
+        assert!(sub.submit(&desc(4)).is_ok());
+    }
+
+    #[test]
+    fn test_corrupt_completion_tail_is_rejected() {
+        let (mut region, size) = alloc_region(8, 4096);
+        let (mut sub, mut svc) = endpoints(&mut region, size);
+        sub.set_batch(1);
+        sub.submit(&desc(1)).unwrap();
+        sub.submit(&desc(2)).unwrap();
+
+        // cq tail index, written by the driver (see the layout in ring.rs)
+        let cq_tail = unsafe { &*((region.as_ptr() as *const u8).add(3 * 64) as *const AtomicU32) };
+        let mut reaped = [IoCompletion::default(); 8];
+
+        // Far ahead, and one past what was published
+        for bogus in [1000, 3] {
+            cq_tail.store(bogus, Ordering::Release);
+            assert_eq!(sub.poll(&mut reaped), Err(RingError::Protocol));
+            assert_eq!(sub.in_flight(), 2);
+            assert_eq!(sub.stats().completed, 0);
+        }
+
+        // A correct tail from the driver is reaped as usual
+        let mut fetched = [IoDesc::default(); 4];
+        assert_eq!(svc.fetch(&mut fetched), 2);
+        svc.complete(&IoCompletion { cookie: 1, status: 0, len: 512 }).unwrap();
+        svc.publish();
+        assert_eq!(sub.poll(&mut reaped), Ok(1));
+        assert_eq!(reaped[0].cookie, 1);
+        assert!(sub.submit(&desc(3)).is_ok());
+    }
+
+    #[test]
+    fn test_out_of_range_buffer() {
+        let (mut region, size) = alloc_region(8, 4096);
+        let (mut sub, _svc) = endpoints(&mut region, size);
+
+        let mut d = desc(1);
+        d.data_offset = 4000;
+        d.len = 200;
+        assert_eq!(sub.submit(&d), Err(RingError::OutOfRange));
+        d.data_offset = u64::MAX - 8;
+        assert_eq!(sub.submit(&d), Err(RingError::OutOfRange));
+        assert!(sub.data(4096, 1).is_err());
+        assert_eq!(sub.in_flight(), 0);
+    }
+
+    #[test]
+    fn test_wraparound() {
+        let (mut region, size) = alloc_region(8, 4096);
+        let (mut sub, mut svc) = endpoints(&mut region, size);
+        sub.set_batch(3);
+
+        let mut fetched = [IoDesc::default(); 8];
+        let mut reaped = [IoCompletion::default(); 8];
+        let mut next_cookie = 0u64;
+        let mut expected = 0u64;
+
+        for _ in 0..1000 {
+            while sub.submit(&desc(next_cookie)).is_ok() {
+                next_cookie += 1;
+            }
+            let n = svc.fetch(&mut fetched);
+            for d in &fetched[..n] {
+                svc.complete(&IoCompletion { cookie: d.cookie, status: 0, len: d.len })
+                    .unwrap();
+            }
+            svc.publish();
+            let n = sub.poll(&mut reaped).unwrap();
+            for c in &reaped[..n] {
+                assert_eq!(c.cookie, expected);
+                expected += 1;
+            }
+        }
+        assert!(expected > 1000);
+        assert_eq!(sub.stats().completed, expected);
+    }
+
+    // =========================================================================
+    // Wakeup Tests
+    // =========================================================================
+
+    static WAKEUPS: AtomicU32 = AtomicU32::new(0);
+
+    fn count_wakeup(ring_id: u32) {
+        assert_eq!(ring_id, 7);
+        WAKEUPS.fetch_add(1, Ordering::SeqCst);
+    }
+
+    #[test]
+    fn test_wakeup_only_when_sleeping() {
+        let (mut region, size) = alloc_region(16, 4096);
+        let (mut sub, mut svc) = endpoints(&mut region, size);
+        sub.set_batch(1);
+        sub.set_notify(count_wakeup);
+        let before = WAKEUPS.load(Ordering::SeqCst);
+
+        // Busy driver: no wakeups
+        sub.submit(&desc(1)).unwrap();
+        assert_eq!(WAKEUPS.load(Ordering::SeqCst), before);
+
+        // Pending work: the driver may not sleep
+        assert!(!svc.prepare_sleep());
+
+        let mut fetched = [IoDesc::default(); 4];
+        svc.fetch(&mut fetched);
+        assert!(svc.prepare_sleep());
+
+        sub.submit(&desc(2)).unwrap();
+        assert_eq!(WAKEUPS.load(Ordering::SeqCst), before + 1);
+        assert_eq!(sub.stats().wakeups, 1);
+
+        svc.clear_wakeup();
+        sub.submit(&desc(3)).unwrap();
+        assert_eq!(sub.stats().wakeups, 1);
+    }
+}
@@ -42,6 +42,14 @@ pub const PT_SHLIB: u32 = 5;
 pub const PT_PHDR: u32 = 6;
 pub const PT_TLS: u32 = 7;
 
+// ============================================================================
+// ELF Program Header Flags
+// ============================================================================
+
+pub const PF_X: u32 = 0x1;
+pub const PF_W: u32 = 0x2;
+pub const PF_R: u32 = 0x4;
+
 // ============================================================================
 // ELF Dynamic Section Tags
 // ============================================================================
@@ -95,9 +103,7 @@ pub const DT_VERNEEDNUM: i64 = 0x6fffffff;
 pub const DF_ORIGIN: u64 = 0x0001;
 #[allow(dead_code)]
 pub const DF_SYMBOLIC: u64 = 0x0002;
-#[allow(dead_code)]
 pub const DF_TEXTREL: u64 = 0x0004;
-#[allow(dead_code)]
 pub const DF_BIND_NOW: u64 = 0x0008;
 #[allow(dead_code)]
 pub const DF_STATIC_TLS: u64 = 0x0010;
@@ -106,7 +112,6 @@ pub const DF_STATIC_TLS: u64 = 0x0010;
 // DT_FLAGS_1 Values
 // ============================================================================
 
-#[allow(dead_code)]
 pub const DF_1_NOW: u64 = 0x00000001;
 #[allow(dead_code)]
 pub const DF_1_PIE: u64 = 0x08000000;
@@ -142,6 +147,13 @@ pub const R_X86_64_GOTTPOFF: u32 = 22;
 pub const R_X86_64_TPOFF32: u32 = 23;
 pub const R_X86_64_IRELATIVE: u32 = 37;
 
+// ============================================================================
+// Symbol Types
+// ============================================================================
+
+/// Symbol value is a resolver returning the implementation's address
+pub const STT_GNU_IFUNC: u8 = 10;
+
 // ============================================================================
 // System Call Numbers
 // ============================================================================
@@ -149,15 +161,23 @@ pub const R_X86_64_IRELATIVE: u32 = 37;
 pub const SYS_WRITE: u64 = 1;
 pub const SYS_EXIT: u64 = 60;
 pub const SYS_MMAP: u64 = 9;
+pub const SYS_MPROTECT: u64 = 10;
 pub const SYS_OPEN: u64 = 2;
 pub const SYS_CLOSE: u64 = 3;
 pub const SYS_READ: u64 = 0;
 #[allow(dead_code)]
 pub const SYS_FSTAT: u64 = 5;
 pub const SYS_LSEEK: u64 = 8;
-#[allow(dead_code)]
 pub const SYS_MUNMAP: u64 = 11;
 
+// ============================================================================
+// Open Flags
+// ============================================================================
+
+pub const O_WRONLY: u64 = 1;
+pub const O_CREAT: u64 = 0o100;
+pub const O_TRUNC: u64 = 0o1000;
+
 // ============================================================================
 // mmap Constants
 // ============================================================================
@@ -166,7 +186,6 @@ pub const PROT_READ: u64 = 0x1;
 pub const PROT_WRITE: u64 = 0x2;
 pub const PROT_EXEC: u64 = 0x4;
 pub const MAP_PRIVATE: u64 = 0x02;
-#[allow(dead_code)]
 pub const MAP_FIXED: u64 = 0x10;
 pub const MAP_ANONYMOUS: u64 = 0x20;
 
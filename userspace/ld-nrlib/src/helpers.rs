@@ -226,6 +226,23 @@ pub unsafe fn starts_with(name: *const u8, prefix: &[u8]) -> bool {
     true
 }
 
+/// Look `name` up in a NULL-terminated envp array
+/// Returns a pointer to the value, or null if the variable is unset
+pub unsafe fn getenv(envp: *const *const u8, name: &[u8]) -> *const u8 {
+    if envp.is_null() {
+        return core::ptr::null();
+    }
+    let mut ptr = envp;
+    while !(*ptr).is_null() {
+        let entry = *ptr;
+        if starts_with(entry, name) && *entry.add(name.len()) == b'=' {
+            return entry.add(name.len() + 1);
+        }
+        ptr = ptr.add(1);
+    }
+    core::ptr::null()
+}
+
 // ============================================================================
 // Library Name Mapping
 // ============================================================================
@@ -5,7 +5,7 @@ use crate::elf::{Elf64Dyn, Elf64Ehdr, Elf64Phdr};
 use crate::helpers::{cstr_len, map_library_name, memset_internal, page_align_down, page_align_up};
 use crate::reloc::process_rela;
 use crate::state::{DynInfo, GLOBAL_SYMTAB};
-use crate::syscall::{close_file, lseek, mmap, open_file, read_bytes};
+use crate::syscall::{close_file, lseek, mmap, mprotect, munmap, open_file, read_bytes};
 use crate::tls::register_tls_module;
 
 // ============================================================================
@@ -33,6 +33,7 @@ pub unsafe fn parse_dynamic_section(dyn_addr: u64, load_bias: i64, dyn_info: &mu
             DT_JMPREL => dyn_info.jmprel = (entry.d_val as i64 + load_bias) as u64,
             DT_PLTRELSZ => dyn_info.pltrelsz = entry.d_val,
             DT_PLTREL => dyn_info.pltrel = entry.d_val,
+            DT_PLTGOT => dyn_info.pltgot = (entry.d_val as i64 + load_bias) as u64,
             DT_INIT => dyn_info.init = (entry.d_val as i64 + load_bias) as u64,
             DT_FINI => dyn_info.fini = (entry.d_val as i64 + load_bias) as u64,
             DT_INIT_ARRAY => dyn_info.init_array = (entry.d_val as i64 + load_bias) as u64,
@@ -43,7 +44,8 @@ pub unsafe fn parse_dynamic_section(dyn_addr: u64, load_bias: i64, dyn_info: &mu
             DT_PREINIT_ARRAYSZ => dyn_info.preinit_arraysz = entry.d_val,
             DT_HASH => dyn_info.hash = (entry.d_val as i64 + load_bias) as u64,
             DT_GNU_HASH => dyn_info.gnu_hash = (entry.d_val as i64 + load_bias) as u64,
-            DT_FLAGS => dyn_info.flags = entry.d_val,
+            DT_FLAGS => dyn_info.flags |= entry.d_val,
+            DT_TEXTREL => dyn_info.flags |= DF_TEXTREL,
             DT_FLAGS_1 => dyn_info.flags_1 = entry.d_val,
             DT_VERSYM => dyn_info.versym = (entry.d_val as i64 + load_bias) as u64,
             DT_VERNEED => dyn_info.verneed = (entry.d_val as i64 + load_bias) as u64,
@@ -65,16 +67,11 @@ pub unsafe fn parse_dynamic_section(dyn_addr: u64, load_bias: i64, dyn_info: &mu
 // ============================================================================
 
 /// Search for a library in standard paths
-pub unsafe fn search_library(name: &[u8]) -> Option<[u8; 256]> {
-    use crate::helpers::{print_str, print_hex, print};
-    
-    // Early debug before ANY slice/reference use
-    print_str("[SX1]\n");
-    
-    // Use 256-byte buffer - should work if kernel demand paging is correct
+///
+/// Returns the path together with the descriptor the probe opened, so the
+/// loader maps from it instead of opening the file a second time.
+pub unsafe fn search_library(name: &[u8]) -> Option<([u8; 256], i32)> {
     let mut path_buf = [0u8; 256];
-    
-    print_str("[SX2]\n");
 
     // Use stack-local inline literals to completely avoid any pointer dereference
     // that might require relocation
@@ -82,8 +79,6 @@ pub unsafe fn search_library(name: &[u8]) -> Option<[u8; 256]> {
     let lib: [u8; 6] = *b"/lib\0\0";
     let usr_lib64: [u8; 12] = *b"/usr/lib64\0\0";
     let usr_lib: [u8; 10] = *b"/usr/lib\0\0";
-    
-    print_str("[SX3]\n");
 
     // Directly iterate over paths
     let search_paths: [[u8; 16]; 4] = [
@@ -114,8 +109,6 @@ pub unsafe fn search_library(name: &[u8]) -> Option<[u8; 256]> {
         },
     ];
 
-    print_str("[SX4]\n");
-    
     let mut path_idx = 0usize;
     while path_idx < 4 {
         let search_path = &search_paths[path_idx];
@@ -152,25 +145,14 @@ pub unsafe fn search_library(name: &[u8]) -> Option<[u8; 256]> {
         // Null terminate
         path_buf[pos] = 0;
 
-        print_str("[search] trying: ");
-        print(&path_buf[..pos]);
-        print_str("\n");
-
-        // Try to open to check if it exists
         let fd = open_file(path_buf.as_ptr());
-        print_str("[search] fd=");
-        print_hex(fd as u64);
-        print_str("\n");
-        
         if fd >= 0 {
-            close_file(fd as i32);
-            return Some(path_buf);
+            return Some((path_buf, fd as i32));
         }
 
         path_idx += 1;
     }
 
-    print_str("[search] not found\n");
     None
 }
 
@@ -178,25 +160,34 @@ pub unsafe fn search_library(name: &[u8]) -> Option<[u8; 256]> {
 // Shared Library Loading
 // ============================================================================
 
-/// Load a shared library from path
+/// mmap protection for a segment's p_flags
+fn segment_prot(p_flags: u32) -> u64 {
+    let mut prot = 0;
+    if p_flags & PF_R != 0 {
+        prot |= PROT_READ;
+    }
+    if p_flags & PF_W != 0 {
+        prot |= PROT_WRITE;
+    }
+    if p_flags & PF_X != 0 {
+        prot |= PROT_EXEC;
+    }
+    prot
+}
+
+/// Load a shared library from an open file descriptor, which is closed
 /// Returns (base_addr, load_bias, dyn_info) or (0, 0, DynInfo::new()) on failure
-pub unsafe fn load_shared_library(path: *const u8) -> (u64, i64, DynInfo) {
+pub unsafe fn load_shared_library(fd: i32) -> (u64, i64, DynInfo) {
     use crate::helpers::{print_str, print_hex};
-    
-    let fd = open_file(path);
-    if fd < 0 {
-        print_str("[ld-nrlib] ERROR: Failed to open library\n");
-        return (0, 0, DynInfo::new());
-    }
 
     // Read ELF header
     let mut ehdr_buf = [0u8; 64];
 
-    let bytes_read = read_bytes(fd as i32, ehdr_buf.as_mut_ptr(), 64);
+    let bytes_read = read_bytes(fd, ehdr_buf.as_mut_ptr(), 64);
 
     if bytes_read < 64 {
         print_str("[ld-nrlib] ERROR: Failed to read ELF header\n");
-        close_file(fd as i32);
+        close_file(fd);
         return (0, 0, DynInfo::new());
     }
 
@@ -209,7 +200,7 @@ pub unsafe fn load_shared_library(path: *const u8) -> (u64, i64, DynInfo) {
         || ehdr.e_ident[3] != b'F'
     {
         print_str("[ld-nrlib] ERROR: Invalid ELF magic\n");
-        close_file(fd as i32);
+        close_file(fd);
         return (0, 0, DynInfo::new());
     }
 
@@ -218,22 +209,22 @@ pub unsafe fn load_shared_library(path: *const u8) -> (u64, i64, DynInfo) {
         print_str("[ld-nrlib] ERROR: Not a shared object, e_type=");
         print_hex(ehdr.e_type as u64);
         print_str("\n");
-        close_file(fd as i32);
+        close_file(fd);
         return (0, 0, DynInfo::new());
     }
 
     // Read program headers
     let phdr_size = (ehdr.e_phentsize as usize) * (ehdr.e_phnum as usize);
     if phdr_size > 2048 {
-        close_file(fd as i32);
+        close_file(fd);
         return (0, 0, DynInfo::new());
     }
 
-    lseek(fd as i32, ehdr.e_phoff as i64, 0); // SEEK_SET
+    lseek(fd, ehdr.e_phoff as i64, 0); // SEEK_SET
     let mut phdr_buf = [0u8; 2048];
-    let bytes_read = read_bytes(fd as i32, phdr_buf.as_mut_ptr(), phdr_size);
+    let bytes_read = read_bytes(fd, phdr_buf.as_mut_ptr(), phdr_size);
     if bytes_read < phdr_size as isize {
-        close_file(fd as i32);
+        close_file(fd);
         return (0, 0, DynInfo::new());
     }
 
@@ -266,13 +257,13 @@ pub unsafe fn load_shared_library(path: *const u8) -> (u64, i64, DynInfo) {
     }
 
     if load_addr_min == u64::MAX {
-        close_file(fd as i32);
+        close_file(fd);
         return (0, 0, DynInfo::new());
     }
 
     let total_size = load_addr_max - load_addr_min;
 
-    // Allocate memory for the library
+    // Reserve the whole span so the segments keep their relative layout
     let base_addr = mmap(
         0,                                  // addr
         total_size,                         // length
@@ -284,44 +275,65 @@ pub unsafe fn load_shared_library(path: *const u8) -> (u64, i64, DynInfo) {
 
     // Check for mmap failure
     if base_addr >= 0xFFFF_FFFF_FFFF_F000 || base_addr == 0 {
-        close_file(fd as i32);
+        close_file(fd);
         return (0, 0, DynInfo::new());
     }
 
     let load_bias = base_addr as i64 - load_addr_min as i64;
 
-    // Load each PT_LOAD segment
+    // Map each PT_LOAD segment from the file over the reservation.
+    // MAP_PRIVATE pages are only copied when written, so text and rodata
+    // stay clean and relocation writes are confined to data/GOT pages.
+    // BSS pages past the file data are already zero in the reservation.
     for phdr in phdrs {
-        if phdr.p_type != PT_LOAD {
+        if phdr.p_type != PT_LOAD || phdr.p_filesz == 0 {
             continue;
         }
 
-        if phdr.p_filesz > 0 {
-            // Seek to segment in file
-            lseek(fd as i32, phdr.p_offset as i64, 0);
-
-            // Read segment data
-            let dest_addr = (phdr.p_vaddr as i64 + load_bias) as *mut u8;
-            let mut total_read: u64 = 0;
-            while total_read < phdr.p_filesz {
-                let to_read = core::cmp::min(phdr.p_filesz - total_read, 4096) as usize;
-                let read = read_bytes(fd as i32, dest_addr.add(total_read as usize), to_read);
-                if read <= 0 {
-                    break;
-                }
-                total_read += read as u64;
-            }
+        let seg_start = page_align_down(phdr.p_vaddr);
+        let file_end = page_align_up(phdr.p_vaddr + phdr.p_filesz);
+        let has_bss = phdr.p_memsz > phdr.p_filesz;
+
+        let mut prot = segment_prot(phdr.p_flags);
+        if has_bss {
+            // The BSS head shares the last file page and is zeroed below
+            prot |= PROT_WRITE;
         }
 
-        // Zero BSS (memsz > filesz)
-        if phdr.p_memsz > phdr.p_filesz {
-            let bss_start = ((phdr.p_vaddr + phdr.p_filesz) as i64 + load_bias) as *mut u8;
-            let bss_size = (phdr.p_memsz - phdr.p_filesz) as usize;
-            memset_internal(bss_start, 0, bss_size);
+        if (phdr.p_offset & (PAGE_SIZE - 1)) != (phdr.p_vaddr & (PAGE_SIZE - 1)) {
+            print_str("[ld-nrlib] ERROR: Misaligned PT_LOAD segment\n");
+            munmap(base_addr, total_size);
+            close_file(fd);
+            return (0, 0, DynInfo::new());
+        }
+
+        let seg_addr = mmap(
+            (seg_start as i64 + load_bias) as u64,
+            file_end - seg_start,
+            prot,
+            MAP_PRIVATE | MAP_FIXED,
+            fd as i64,
+            page_align_down(phdr.p_offset),
+        );
+        if seg_addr >= 0xFFFF_FFFF_FFFF_F000 {
+            print_str("[ld-nrlib] ERROR: Failed to map segment\n");
+            munmap(base_addr, total_size);
+            close_file(fd);
+            return (0, 0, DynInfo::new());
+        }
+
+        if has_bss {
+            let bss_start = phdr.p_vaddr + phdr.p_filesz;
+            let zero_end = core::cmp::min(file_end, phdr.p_vaddr + phdr.p_memsz);
+            memset_internal(
+                (bss_start as i64 + load_bias) as *mut u8,
+                0,
+                (zero_end - bss_start) as usize,
+            );
         }
     }
 
-    close_file(fd as i32);
+    close_file(fd);
 
     // Parse dynamic section
     let mut dyn_info = DynInfo::new();
@@ -330,6 +342,11 @@ pub unsafe fn load_shared_library(path: *const u8) -> (u64, i64, DynInfo) {
         parse_dynamic_section(dyn_addr, load_bias, &mut dyn_info);
     }
 
+    // Text relocations write into read-only segments
+    if dyn_info.flags & DF_TEXTREL != 0 {
+        mprotect(base_addr, total_size, PROT_READ | PROT_WRITE | PROT_EXEC);
+    }
+
     // Register TLS module if PT_TLS segment exists
     if let Some(tls) = tls_phdr {
         let tls_image = (tls.p_vaddr as i64 + load_bias) as u64;
@@ -344,13 +361,31 @@ pub unsafe fn load_shared_library(path: *const u8) -> (u64, i64, DynInfo) {
 // Recursive Library Loading
 // ============================================================================
 
-/// Check if a library is already loaded by comparing base addresses
-/// We track loaded libraries in GLOBAL_SYMTAB
+/// Whether an already loaded library was found under this DT_NEEDED name,
+/// i.e. its path ends in "/<name>"; saves searching the directories again
+unsafe fn is_name_already_loaded(name: &[u8]) -> bool {
+    for i in 1..GLOBAL_SYMTAB.lib_count {
+        let path = &GLOBAL_SYMTAB.libs[i].path;
+        let len = cstr_len(path.as_ptr());
+        if len > name.len()
+            && path[len - name.len() - 1] == b'/'
+            && &path[len - name.len()..len] == name
+        {
+            return true;
+        }
+    }
+    false
+}
+
+/// Whether the object at `path` is already loaded
 unsafe fn is_library_already_loaded(path: &[u8; 256]) -> bool {
-    // Simple check: try to open and see if we already have it
-    // A proper implementation would store loaded library paths
-    // For now, just return false and let duplicate loads be caught elsewhere
-    let _ = path;
+    let len = cstr_len(path.as_ptr());
+    for i in 1..GLOBAL_SYMTAB.lib_count {
+        let loaded = &GLOBAL_SYMTAB.libs[i].path;
+        if cstr_len(loaded.as_ptr()) == len && loaded[..len] == path[..len] {
+            return true;
+        }
+    }
     false
 }
 
@@ -368,19 +403,24 @@ pub unsafe fn load_library_recursive(name: &[u8]) -> bool {
         return false;
     }
 
+    // Shared dependencies (and dependency cycles) are loaded only once
+    if is_name_already_loaded(name) {
+        return true;
+    }
+
     // Search for the library in standard paths
     // The filesystem handles symlinks (libc.so -> libnrlib.so) automatically
     print_str("[ld] searching...\n");
-    let path = if let Some(p) = search_library(name) {
+    let (path, fd) = if let Some(found) = search_library(name) {
         print_str("[ld] found in search\n");
-        p
+        found
     } else {
         // Try mapped name as fallback
         print_str("[ld] trying mapped name\n");
         let mapped_name = map_library_name(name);
-        if let Some(p) = search_library(&mapped_name) {
+        if let Some(found) = search_library(&mapped_name) {
             print_str("[ld] found with mapped name\n");
-            p
+            found
         } else {
             print_str("[ld-nrlib] ERROR: Library not found: ");
             for &c in name {
@@ -392,10 +432,15 @@ pub unsafe fn load_library_recursive(name: &[u8]) -> bool {
         }
     };
 
+    if is_library_already_loaded(&path) {
+        close_file(fd);
+        return true;
+    }
+
     print_str("[ld] loading...\n");
 
     // Load the library
-    let (lib_base, lib_bias, lib_dyn_info) = load_shared_library(path.as_ptr());
+    let (lib_base, lib_bias, lib_dyn_info) = load_shared_library(fd);
     if lib_base == 0 {
         print_str("[ld-nrlib] ERROR: Failed to load library\n");
         return false;
@@ -412,6 +457,7 @@ pub unsafe fn load_library_recursive(name: &[u8]) -> bool {
     lib.load_bias = lib_bias;
     lib.dyn_info = lib_dyn_info;
     lib.valid = true;
+    lib.path = path;
     GLOBAL_SYMTAB.lib_count = lib_idx + 1;
 
     // Process library's RELATIVE relocations first
@@ -27,6 +27,7 @@ mod constants;
 mod elf;
 mod helpers;
 mod loader;
+mod prelink;
 mod reloc;
 mod state;
 mod symbol;
@@ -36,9 +37,9 @@ mod tls;
 use auxv::{store_auxv, AuxInfo};
 use constants::*;
 use elf::{AuxEntry, Elf64Dyn, Elf64Phdr, Elf64Sym};
-use helpers::{cstr_len, print_str, print_hex, print};
+use helpers::{cstr_len, getenv, print_str, print_hex, print};
 use loader::{load_library_recursive, parse_dynamic_section};
-use reloc::process_rela_with_symtab;
+use reloc::{relocate_all, SymbolSource};
 use state::{DynInfo, GLOBAL_SYMTAB};
 use symbol::global_symbol_lookup;
 use syscall::exit;
@@ -303,7 +304,8 @@ unsafe extern "C" fn ld_main(stack_ptr: *const u64) -> ! {
     print_str("LD_ARGV\n");
 
     // Skip past argv (argc+1 entries including NULL terminator)
-    let mut ptr = argv.add(argc + 1) as *const *const u8;
+    let envp = argv.add(argc + 1) as *const *const u8;
+    let mut ptr = envp;
 
     // Skip past envp (until NULL)
     while !(*ptr).is_null() {
@@ -421,11 +423,13 @@ unsafe extern "C" fn ld_main(stack_ptr: *const u64) -> ! {
 
     print_str("LD9\n");
 
-    // Register TLS for main executable
+    // Register TLS for main executable (module 1, nearest the thread pointer)
+    let mut exe_tls_modid = 0;
     for phdr in phdrs {
         if phdr.p_type == PT_TLS {
             let tls_image = (phdr.p_vaddr as i64 + load_bias) as u64;
-            tls::register_tls_module(tls_image, phdr.p_filesz, phdr.p_memsz, phdr.p_align);
+            exe_tls_modid =
+                tls::register_tls_module(tls_image, phdr.p_filesz, phdr.p_memsz, phdr.p_align);
             break;
         }
     }
@@ -465,6 +469,7 @@ unsafe extern "C" fn ld_main(stack_ptr: *const u64) -> ! {
         print_str("\n");
 
         parse_dynamic_section(dyn_addr, load_bias, main_dyn_info);
+        main_dyn_info.tls_modid = exe_tls_modid;
 
         print_str("LDB\n");
 
@@ -496,56 +501,26 @@ unsafe extern "C" fn ld_main(stack_ptr: *const u64) -> ! {
             }
         }
 
-        // Step 3: Process main executable's relocations
-        print_str("LDE RELA\n");
-        if main_dyn_info.rela != 0 && main_dyn_info.relasz > 0 {
-            process_rela_with_symtab(
-                main_dyn_info.rela,
-                main_dyn_info.relasz,
-                main_dyn_info.relaent,
-                load_bias,
-                &main_dyn_info,
-            );
-        }
+        // Every startup module is loaded: fix their static TLS offsets,
+        // which TPOFF relocations need
+        tls::layout_static_tls();
 
-        if main_dyn_info.jmprel != 0 && main_dyn_info.pltrelsz > 0 {
-            process_rela_with_symtab(
-                main_dyn_info.jmprel,
-                main_dyn_info.pltrelsz,
-                24,
-                load_bias,
-                &main_dyn_info,
-            );
+        // Step 3/4: Relocate the main executable, then libraries in load
+        // order. PLT slots bind on first call unless LD_BIND_NOW is set;
+        // LD_PRELINK_CACHE=<dir> replays addresses saved by an earlier run.
+        print_str("LDE RELA\n");
+        let bind_now = getenv(envp, b"LD_BIND_NOW");
+        let bind_now = !bind_now.is_null() && *bind_now != 0;
+        let prelink_dir = getenv(envp, b"LD_PRELINK_CACHE");
+        if aux_info.at_secure == 0 && !prelink_dir.is_null() && *prelink_dir != 0 {
+            prelink::relocate_cached(prelink_dir);
+        } else {
+            relocate_all(bind_now, &mut SymbolSource::Lookup);
         }
 
-        print_str("LDF LIB_RELOCS\n");
-        // Step 4: Process library relocations
-        for i in 1..GLOBAL_SYMTAB.lib_count {
-            let lib = &GLOBAL_SYMTAB.libs[i];
-            if !lib.valid {
-                continue;
-            }
-
-            if lib.dyn_info.rela != 0 && lib.dyn_info.relasz > 0 {
-                process_rela_with_symtab(
-                    lib.dyn_info.rela,
-                    lib.dyn_info.relasz,
-                    lib.dyn_info.relaent,
-                    lib.load_bias,
-                    &lib.dyn_info,
-                );
-            }
-
-            if lib.dyn_info.jmprel != 0 && lib.dyn_info.pltrelsz > 0 {
-                process_rela_with_symtab(
-                    lib.dyn_info.jmprel,
-                    lib.dyn_info.pltrelsz,
-                    24,
-                    lib.load_bias,
-                    &lib.dyn_info,
-                );
-            }
-        }
+        // Initializers may touch thread-locals, so the main thread's static
+        // TLS block goes in first; nrlib adopts it as the main thread's TCB
+        tls::setup_main_thread_tls();
 
         print_str("LDG PREINIT\n");
         // Step 5: Call preinit_array
@@ -655,9 +630,9 @@ unsafe extern "C" fn ld_main(stack_ptr: *const u64) -> ! {
         exit(127);
     }
 
-    // NOTE: TLS setup is done by nrlib's __nrlib_init_main_thread_tls()
-    // We don't set up TLS here because nrlib's ThreadControlBlock has the
-    // correct layout with tls_data array at offset 0x80 that Rust std expects.
+    // NOTE: the main thread's static TLS block was set up above; nrlib's
+    // __nrlib_init_main_thread_tls() fills in the rest of its
+    // ThreadControlBlock (tsd array at offset 0x80 that Rust std expects).
 
     jump_to_entry(entry, stack_ptr);
 }
@@ -0,0 +1,320 @@
+//! Prelink cache for the NexaOS dynamic linker
+//!
+//! With `LD_PRELINK_CACHE=<dir>` set, the address every symbol relocation
+//! resolved to is saved to `<dir>/<key>.prelink` on the first launch and
+//! replayed on later launches, so relocation runs without a single symbol
+//! lookup. The key hashes everything those addresses depend on: each
+//! object's load address, symbol, string and relocation tables, the
+//! linker's own builtin symbols and the CPU feature words that IFUNC
+//! resolvers look at. Changing any of them changes the key, so a stale
+//! image is never applied; an unreadable or corrupt image is just a miss.
+//!
+//! The cache is never consulted for AT_SECURE processes.
+
+use core::arch::x86_64::{__cpuid, __cpuid_count};
+
+use crate::constants::*;
+use crate::reloc::{relocate_all, SymbolSource};
+use crate::state::GLOBAL_SYMTAB;
+use crate::symbol::{get_symbol_count, global_symbol_lookup};
+use crate::syscall::{close_file, mmap, munmap, open_file, open_file_mode, read_bytes, write};
+
+/// File magic: "NXPRELNK"
+const PRELINK_MAGIC: u64 = u64::from_le_bytes(*b"NXPRELNK");
+
+/// Header: magic, key, value count, checksum of the values
+const HEADER_WORDS: usize = 4;
+
+// ============================================================================
+// Resolved-Address Image
+// ============================================================================
+
+/// Symbol addresses in the order relocation asks for them
+pub struct PrelinkImage {
+    values: *mut u64,
+    len: usize,
+    cap: usize,
+    pos: usize,
+}
+
+impl PrelinkImage {
+    /// Anonymous mapping with room for `cap` addresses
+    unsafe fn with_capacity(cap: usize) -> Option<Self> {
+        let bytes = (cap.max(1) * 8) as u64;
+        let addr = mmap(
+            0,
+            bytes,
+            PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS,
+            -1,
+            0,
+        );
+        if addr == 0 || addr >= 0xFFFF_FFFF_FFFF_F000 {
+            return None;
+        }
+        Some(Self {
+            values: addr as *mut u64,
+            len: 0,
+            cap: cap.max(1),
+            pos: 0,
+        })
+    }
+
+    /// Append a resolved address; silently drops past capacity, which
+    /// `store` then refuses to write out
+    pub fn push(&mut self, addr: u64) {
+        if self.len < self.cap {
+            unsafe { *self.values.add(self.len) = addr };
+        }
+        self.len += 1;
+    }
+
+    /// Next recorded address, or None once the image is exhausted
+    pub fn next(&mut self) -> Option<u64> {
+        if self.pos >= self.len {
+            return None;
+        }
+        let addr = unsafe { *self.values.add(self.pos) };
+        self.pos += 1;
+        Some(addr)
+    }
+
+    unsafe fn release(self) {
+        munmap(self.values as u64, (self.cap * 8) as u64);
+    }
+}
+
+// ============================================================================
+// Cache Key
+// ============================================================================
+
+struct KeyHasher(u64);
+
+impl KeyHasher {
+    fn word(&mut self, w: u64) {
+        self.0 = (self.0 ^ w)
+            .wrapping_mul(0x9E37_79B9_7F4A_7C15)
+            .rotate_left(29);
+    }
+
+    unsafe fn bytes(&mut self, addr: u64, len: u64) {
+        if addr == 0 {
+            self.word(0);
+            return;
+        }
+        let words = len / 8;
+        for i in 0..words {
+            self.word(core::ptr::read_unaligned((addr + i * 8) as *const u64));
+        }
+        let mut tail = 0u64;
+        for i in words * 8..len {
+            tail = (tail << 8) | *((addr + i) as *const u8) as u64;
+        }
+        self.word(tail);
+        self.word(len);
+    }
+}
+
+/// Hash of everything the resolved addresses depend on
+unsafe fn cache_key() -> u64 {
+    let mut h = KeyHasher(PRELINK_MAGIC);
+
+    let leaf1 = __cpuid(1);
+    let leaf7 = __cpuid_count(7, 0);
+    h.word(((leaf1.ecx as u64) << 32) | leaf1.edx as u64);
+    h.word(((leaf7.ebx as u64) << 32) | leaf7.ecx as u64);
+    h.word(leaf7.edx as u64);
+
+    // Builtins resolve into the linker itself, which may have moved
+    h.word(global_symbol_lookup(b"__tls_get_addr"));
+    h.word(global_symbol_lookup(b"__cxa_thread_atexit_impl"));
+    h.word(global_symbol_lookup(b"__nrlib_static_tls"));
+
+    h.word(GLOBAL_SYMTAB.lib_count as u64);
+    for i in 0..GLOBAL_SYMTAB.lib_count {
+        let lib = &GLOBAL_SYMTAB.libs[i];
+        let dyn_info = &lib.dyn_info;
+        h.word(lib.valid as u64);
+        h.word(lib.base_addr);
+        h.word(lib.load_bias as u64);
+        h.word(dyn_info.flags);
+        h.word(dyn_info.flags_1);
+        let syment = if dyn_info.syment == 0 {
+            24
+        } else {
+            dyn_info.syment
+        };
+        h.bytes(dyn_info.symtab, get_symbol_count(dyn_info) as u64 * syment);
+        h.bytes(dyn_info.strtab, dyn_info.strsz);
+        h.bytes(dyn_info.rela, dyn_info.relasz);
+        h.bytes(dyn_info.jmprel, dyn_info.pltrelsz);
+    }
+    h.0
+}
+
+/// Upper bound on symbol relocations across all loaded objects
+unsafe fn symbol_reloc_capacity() -> usize {
+    let mut total = 0u64;
+    for i in 0..GLOBAL_SYMTAB.lib_count {
+        let dyn_info = &GLOBAL_SYMTAB.libs[i].dyn_info;
+        let relaent = if dyn_info.relaent == 0 {
+            24
+        } else {
+            dyn_info.relaent
+        };
+        total += dyn_info.relasz / relaent + dyn_info.pltrelsz / 24;
+    }
+    total as usize
+}
+
+fn checksum(values: &[u64]) -> u64 {
+    let mut h = KeyHasher(!PRELINK_MAGIC);
+    for &v in values {
+        h.word(v);
+    }
+    h.0
+}
+
+// ============================================================================
+// Cache Files
+// ============================================================================
+
+/// Build "<dir>/<key as hex>.prelink"; None if it does not fit
+unsafe fn image_path(dir: *const u8, key: u64) -> Option<[u8; 256]> {
+    let mut path = [0u8; 256];
+    let mut pos = 0;
+    while *dir.add(pos) != 0 {
+        if pos >= 200 {
+            return None;
+        }
+        path[pos] = *dir.add(pos);
+        pos += 1;
+    }
+    path[pos] = b'/';
+    pos += 1;
+    let hex = b"0123456789abcdef";
+    for i in 0..16 {
+        path[pos] = hex[((key >> (60 - i * 4)) & 0xf) as usize];
+        pos += 1;
+    }
+    for &c in b".prelink" {
+        path[pos] = c;
+        pos += 1;
+    }
+    Some(path)
+}
+
+/// Read exactly `len` bytes
+unsafe fn read_full(fd: i32, buf: *mut u8, len: usize) -> bool {
+    let mut done = 0;
+    while done < len {
+        let n = read_bytes(fd, buf.add(done), len - done);
+        if n <= 0 {
+            return false;
+        }
+        done += n as usize;
+    }
+    true
+}
+
+/// Write exactly `len` bytes
+unsafe fn write_full(fd: i32, buf: *const u8, len: usize) -> bool {
+    let mut done = 0;
+    while done < len {
+        let n = write(fd, buf.add(done), len - done);
+        if n <= 0 {
+            return false;
+        }
+        done += n as usize;
+    }
+    true
+}
+
+unsafe fn load(path: &[u8; 256], key: u64, capacity: usize) -> Option<PrelinkImage> {
+    let fd = open_file(path.as_ptr());
+    if fd < 0 {
+        return None;
+    }
+    let fd = fd as i32;
+
+    let mut header = [0u64; HEADER_WORDS];
+    if !read_full(fd, header.as_mut_ptr() as *mut u8, HEADER_WORDS * 8)
+        || header[0] != PRELINK_MAGIC
+        || header[1] != key
+        || header[2] as usize > capacity
+    {
+        close_file(fd);
+        return None;
+    }
+
+    let count = header[2] as usize;
+    let mut image = match PrelinkImage::with_capacity(count) {
+        Some(image) => image,
+        None => {
+            close_file(fd);
+            return None;
+        }
+    };
+    let ok = read_full(fd, image.values as *mut u8, count * 8);
+    close_file(fd);
+    image.len = count;
+    if !ok || checksum(core::slice::from_raw_parts(image.values, count)) != header[3] {
+        image.release();
+        return None;
+    }
+    Some(image)
+}
+
+unsafe fn store(path: &[u8; 256], key: u64, image: &PrelinkImage) {
+    if image.len > image.cap {
+        return;
+    }
+    let values = core::slice::from_raw_parts(image.values, image.len);
+    let header = [PRELINK_MAGIC, key, image.len as u64, checksum(values)];
+
+    let fd = open_file_mode(path.as_ptr(), O_WRONLY | O_CREAT | O_TRUNC, 0o644);
+    if fd < 0 {
+        return;
+    }
+    let fd = fd as i32;
+    // A concurrent reader of a half-written file fails the checksum
+    if write_full(fd, header.as_ptr() as *const u8, HEADER_WORDS * 8) {
+        write_full(fd, image.values as *const u8, image.len * 8);
+    }
+    close_file(fd);
+}
+
+// ============================================================================
+// Entry Point
+// ============================================================================
+
+/// Relocate every loaded object through the prelink cache in `dir`
+///
+/// A hit replays the saved addresses; a miss binds everything now, recording
+/// as it goes, and saves the image for the next launch.
+pub unsafe fn relocate_cached(dir: *const u8) {
+    let key = cache_key();
+    let capacity = symbol_reloc_capacity();
+    let path = match image_path(dir, key) {
+        Some(path) => path,
+        None => {
+            relocate_all(false, &mut SymbolSource::Lookup);
+            return;
+        }
+    };
+
+    if let Some(mut image) = load(&path, key, capacity) {
+        relocate_all(true, &mut SymbolSource::Replay(&mut image));
+        image.release();
+        return;
+    }
+
+    match PrelinkImage::with_capacity(capacity) {
+        Some(mut image) => {
+            relocate_all(true, &mut SymbolSource::Record(&mut image));
+            store(&path, key, &image);
+            image.release();
+        }
+        None => relocate_all(false, &mut SymbolSource::Lookup),
+    }
+}
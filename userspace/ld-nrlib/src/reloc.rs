@@ -1,10 +1,55 @@
 //! Relocation processing for the NexaOS dynamic linker
 
+use core::arch::naked_asm;
+
 use crate::constants::*;
 use crate::elf::{Elf64Rela, Elf64Sym};
-use crate::helpers::memcpy_internal;
-use crate::state::DynInfo;
-use crate::symbol::{get_symbol_name, global_symbol_lookup_cstr};
+use crate::helpers::{cstr_len, memcpy_internal, print, print_str};
+use crate::prelink::PrelinkImage;
+use crate::state::{DynInfo, GLOBAL_SYMTAB};
+use crate::symbol::{cached_symbol_lookup, get_symbol_name};
+use crate::syscall::exit;
+use crate::tls::{module_tp_offset, resolve_tls_symbol};
+
+// ============================================================================
+// Symbol Sources
+// ============================================================================
+
+/// Where symbol relocations get their target addresses from
+pub enum SymbolSource<'a> {
+    /// Resolve through the global scope (and the resolution cache)
+    Lookup,
+    /// Resolve, and append each result to a prelink image
+    Record(&'a mut PrelinkImage),
+    /// Take results from a prelink image in relocation order
+    Replay(&'a mut PrelinkImage),
+}
+
+impl SymbolSource<'_> {
+    /// Address of symbol `sym_idx` of `dyn_info`, or 0 if nothing defines it
+    unsafe fn resolve(&mut self, dyn_info: &DynInfo, sym_idx: u32) -> u64 {
+        match self {
+            SymbolSource::Lookup => lookup_symbol(dyn_info, sym_idx),
+            SymbolSource::Record(image) => {
+                let addr = lookup_symbol(dyn_info, sym_idx);
+                image.push(addr);
+                addr
+            }
+            SymbolSource::Replay(image) => match image.next() {
+                Some(addr) => addr,
+                None => lookup_symbol(dyn_info, sym_idx),
+            },
+        }
+    }
+}
+
+unsafe fn lookup_symbol(dyn_info: &DynInfo, sym_idx: u32) -> u64 {
+    let sym_name = get_symbol_name(dyn_info, sym_idx);
+    if sym_name.is_null() {
+        return 0;
+    }
+    cached_symbol_lookup(sym_name)
+}
 
 // ============================================================================
 // Relocation Processing with Symbol Table
@@ -17,178 +62,309 @@ pub unsafe fn process_rela_with_symtab(
     relaent: u64,
     load_bias: i64,
     dyn_info: &DynInfo,
+    source: &mut SymbolSource,
 ) {
     let entry_size = if relaent == 0 { 24 } else { relaent };
     let count = relasz / entry_size;
 
     for i in 0..count {
         let rela = &*((rela_addr + i * entry_size) as *const Elf64Rela);
-        let rel_type = (rela.r_info & 0xffffffff) as u32;
-        let sym_idx = (rela.r_info >> 32) as u32;
+        apply_rela(rela, load_bias, dyn_info, source);
+    }
+}
 
-        let target = (rela.r_offset as i64 + load_bias) as *mut u64;
+/// Apply a single RELA relocation
+unsafe fn apply_rela(
+    rela: &Elf64Rela,
+    load_bias: i64,
+    dyn_info: &DynInfo,
+    source: &mut SymbolSource,
+) {
+    let rel_type = (rela.r_info & 0xffffffff) as u32;
+    let sym_idx = (rela.r_info >> 32) as u32;
 
-        match rel_type {
-            R_X86_64_RELATIVE => {
-                // R_X86_64_RELATIVE: *target = load_bias + addend
-                *target = (load_bias + rela.r_addend) as u64;
-            }
-            R_X86_64_64 => {
-                // R_X86_64_64: *target = symbol + addend
-                if sym_idx != 0 {
-                    let sym_name = get_symbol_name(dyn_info, sym_idx);
-                    if !sym_name.is_null() {
-                        let sym_addr = global_symbol_lookup_cstr(sym_name);
-                        if sym_addr != 0 {
-                            *target = (sym_addr as i64 + rela.r_addend) as u64;
-                        }
-                    }
-                } else {
-                    *target = (load_bias + rela.r_addend) as u64;
+    let target = (rela.r_offset as i64 + load_bias) as *mut u64;
+
+    match rel_type {
+        R_X86_64_RELATIVE => {
+            // R_X86_64_RELATIVE: *target = load_bias + addend
+            *target = (load_bias + rela.r_addend) as u64;
+        }
+        R_X86_64_64 => {
+            // R_X86_64_64: *target = symbol + addend
+            if sym_idx != 0 {
+                let sym_addr = source.resolve(dyn_info, sym_idx);
+                if sym_addr != 0 {
+                    *target = (sym_addr as i64 + rela.r_addend) as u64;
                 }
+            } else {
+                *target = (load_bias + rela.r_addend) as u64;
             }
-            R_X86_64_32 | R_X86_64_32S => {
-                // R_X86_64_32/32S: 32-bit relocations
-                if sym_idx != 0 {
-                    let sym_name = get_symbol_name(dyn_info, sym_idx);
-                    if !sym_name.is_null() {
-                        let sym_addr = global_symbol_lookup_cstr(sym_name);
-                        if sym_addr != 0 {
-                            let val = (sym_addr as i64 + rela.r_addend) as u32;
-                            *(target as *mut u32) = val;
-                        }
-                    }
-                } else {
-                    let val = (load_bias + rela.r_addend) as u32;
+        }
+        R_X86_64_32 | R_X86_64_32S => {
+            // R_X86_64_32/32S: 32-bit relocations
+            if sym_idx != 0 {
+                let sym_addr = source.resolve(dyn_info, sym_idx);
+                if sym_addr != 0 {
+                    let val = (sym_addr as i64 + rela.r_addend) as u32;
                     *(target as *mut u32) = val;
                 }
+            } else {
+                let val = (load_bias + rela.r_addend) as u32;
+                *(target as *mut u32) = val;
             }
-            R_X86_64_GLOB_DAT | R_X86_64_JUMP_SLOT => {
-                // R_X86_64_GLOB_DAT/JUMP_SLOT: *target = symbol address
-                if sym_idx != 0 {
-                    let sym_name = get_symbol_name(dyn_info, sym_idx);
-                    if !sym_name.is_null() {
-                        let sym_addr = global_symbol_lookup_cstr(sym_name);
-                        if sym_addr != 0 {
-                            *target = sym_addr;
-                        }
-                    }
-                }
-            }
-            R_X86_64_COPY => {
-                // R_X86_64_COPY: copy data from shared library
-                if sym_idx != 0 {
-                    let sym_name = get_symbol_name(dyn_info, sym_idx);
-                    if !sym_name.is_null() {
-                        let sym_addr = global_symbol_lookup_cstr(sym_name);
-                        if sym_addr != 0 {
-                            // Get symbol size from symtab
-                            let syment = if dyn_info.syment == 0 {
-                                24
-                            } else {
-                                dyn_info.syment
-                            };
-                            let sym = &*((dyn_info.symtab + (sym_idx as u64) * syment)
-                                as *const Elf64Sym);
-                            let size = sym.st_size as usize;
-                            if size > 0 {
-                                memcpy_internal(target as *mut u8, sym_addr as *const u8, size);
-                            }
-                        }
-                    }
-                }
-            }
-            R_X86_64_IRELATIVE => {
-                // R_X86_64_IRELATIVE: call resolver function to get symbol address
-                let resolver_addr = (load_bias + rela.r_addend) as u64;
-                if resolver_addr != 0 {
-                    let resolver: extern "C" fn() -> u64 = core::mem::transmute(resolver_addr);
-                    *target = resolver();
-                }
-            }
-            R_X86_64_DTPMOD64 => {
-                // R_X86_64_DTPMOD64: TLS module ID
-                if sym_idx != 0 {
-                    *target = dyn_info.tls_modid;
-                } else {
-                    *target = dyn_info.tls_modid;
-                }
-                if *target == 0 {
-                    *target = 1; // Default TLS module ID for main executable
+        }
+        R_X86_64_GLOB_DAT | R_X86_64_JUMP_SLOT => {
+            // R_X86_64_GLOB_DAT/JUMP_SLOT: *target = symbol address
+            if sym_idx != 0 {
+                let sym_addr = source.resolve(dyn_info, sym_idx);
+                if sym_addr != 0 {
+                    *target = sym_addr;
                 }
             }
-            R_X86_64_DTPOFF64 => {
-                // R_X86_64_DTPOFF64: TLS offset within module
-                if sym_idx != 0 {
+        }
+        R_X86_64_COPY => {
+            // R_X86_64_COPY: copy data from shared library
+            if sym_idx != 0 {
+                let sym_addr = source.resolve(dyn_info, sym_idx);
+                if sym_addr != 0 {
+                    // Get symbol size from symtab
                     let syment = if dyn_info.syment == 0 {
                         24
                     } else {
                         dyn_info.syment
                     };
                     let sym = &*((dyn_info.symtab + (sym_idx as u64) * syment) as *const Elf64Sym);
-                    *target = (sym.st_value as i64 + rela.r_addend) as u64;
-                } else {
-                    *target = rela.r_addend as u64;
+                    let size = sym.st_size as usize;
+                    if size > 0 {
+                        memcpy_internal(target as *mut u8, sym_addr as *const u8, size);
+                    }
                 }
             }
-            R_X86_64_TPOFF64 => {
-                // R_X86_64_TPOFF64: TLS offset from thread pointer
-                if sym_idx != 0 {
-                    let syment = if dyn_info.syment == 0 {
-                        24
-                    } else {
-                        dyn_info.syment
-                    };
-                    let sym = &*((dyn_info.symtab + (sym_idx as u64) * syment) as *const Elf64Sym);
-                    *target = (sym.st_value as i64 + rela.r_addend) as u64;
-                } else {
-                    *target = rela.r_addend as u64;
-                }
+        }
+        R_X86_64_IRELATIVE => {
+            // R_X86_64_IRELATIVE: call resolver function to get symbol address
+            let resolver_addr = (load_bias + rela.r_addend) as u64;
+            if resolver_addr != 0 {
+                let resolver: extern "C" fn() -> u64 = core::mem::transmute(resolver_addr);
+                *target = resolver();
             }
-            R_X86_64_TPOFF32 => {
-                // R_X86_64_TPOFF32: 32-bit TLS offset from thread pointer
-                if sym_idx != 0 {
-                    let syment = if dyn_info.syment == 0 {
-                        24
-                    } else {
-                        dyn_info.syment
-                    };
-                    let sym = &*((dyn_info.symtab + (sym_idx as u64) * syment) as *const Elf64Sym);
-                    let val = (sym.st_value as i64 + rela.r_addend) as i32;
+        }
+        R_X86_64_DTPMOD64 => {
+            // R_X86_64_DTPMOD64: TLS module ID of the defining object
+            let (modid, _) = resolve_tls_symbol(dyn_info, sym_idx);
+            *target = if modid == 0 {
+                1 // Default TLS module ID for main executable
+            } else {
+                modid
+            };
+        }
+        R_X86_64_DTPOFF64 => {
+            // R_X86_64_DTPOFF64: TLS offset within module
+            let (_, value) = resolve_tls_symbol(dyn_info, sym_idx);
+            *target = (value as i64 + rela.r_addend) as u64;
+        }
+        R_X86_64_TPOFF64 => {
+            // R_X86_64_TPOFF64: TLS offset from thread pointer
+            let (modid, value) = resolve_tls_symbol(dyn_info, sym_idx);
+            *target = (module_tp_offset(modid) + value as i64 + rela.r_addend) as u64;
+        }
+        R_X86_64_TPOFF32 => {
+            // R_X86_64_TPOFF32: 32-bit TLS offset from thread pointer
+            let (modid, value) = resolve_tls_symbol(dyn_info, sym_idx);
+            *(target as *mut i32) = (module_tp_offset(modid) + value as i64 + rela.r_addend) as i32;
+        }
+        R_X86_64_PC32 | R_X86_64_PLT32 => {
+            // PC-relative 32-bit relocations
+            if sym_idx != 0 {
+                let sym_addr = source.resolve(dyn_info, sym_idx);
+                if sym_addr != 0 {
+                    let pc = target as u64;
+                    let val = ((sym_addr as i64 + rela.r_addend) - pc as i64) as i32;
                     *(target as *mut i32) = val;
-                } else {
-                    *(target as *mut i32) = rela.r_addend as i32;
-                }
-            }
-            R_X86_64_PC32 | R_X86_64_PLT32 => {
-                // PC-relative 32-bit relocations
-                if sym_idx != 0 {
-                    let sym_name = get_symbol_name(dyn_info, sym_idx);
-                    if !sym_name.is_null() {
-                        let sym_addr = global_symbol_lookup_cstr(sym_name);
-                        if sym_addr != 0 {
-                            let pc = target as u64;
-                            let val = ((sym_addr as i64 + rela.r_addend) - pc as i64) as i32;
-                            *(target as *mut i32) = val;
-                        }
-                    }
                 }
             }
-            R_X86_64_GOTPCREL => {
-                // GOT-relative PC-relative relocation
-                if sym_idx != 0 {
-                    let sym_name = get_symbol_name(dyn_info, sym_idx);
-                    if !sym_name.is_null() {
-                        let sym_addr = global_symbol_lookup_cstr(sym_name);
-                        if sym_addr != 0 {
-                            *target = sym_addr;
-                        }
-                    }
+        }
+        R_X86_64_GOTPCREL => {
+            // GOT-relative PC-relative relocation
+            if sym_idx != 0 {
+                let sym_addr = source.resolve(dyn_info, sym_idx);
+                if sym_addr != 0 {
+                    *target = sym_addr;
                 }
             }
-            R_X86_64_NONE => {}
-            _ => {
-                // Unknown relocation type - ignore
+        }
+        R_X86_64_NONE => {}
+        _ => {
+            // Unknown relocation type - ignore
+        }
+    }
+}
+
+// ============================================================================
+// Lazy PLT Binding
+// ============================================================================
+
+/// Prepare an object's PLT for lazy binding
+///
+/// Each JUMP_SLOT GOT entry still holds the link-time address of its PLT
+/// stub, which pushes the relocation index and jumps to PLT0; PLT0 pushes
+/// GOT[1] and jumps through GOT[2]. Rebasing the entries and pointing
+/// GOT[1]/GOT[2] at this object and `dl_runtime_resolve` defers every
+/// lookup to the first call. Other PLT relocations (IRELATIVE) are applied
+/// now. Returns false, changing nothing, if the object has no lazy stubs.
+unsafe fn setup_lazy_plt(lib_idx: usize, dyn_info: &DynInfo, load_bias: i64) -> bool {
+    if dyn_info.pltgot == 0 || dyn_info.pltrel != DT_RELA as u64 {
+        return false;
+    }
+
+    let count = dyn_info.pltrelsz / 24;
+    for i in 0..count {
+        let rela = &*((dyn_info.jmprel + i * 24) as *const Elf64Rela);
+        let target = (rela.r_offset as i64 + load_bias) as *const u64;
+        if (rela.r_info & 0xffffffff) as u32 == R_X86_64_JUMP_SLOT && *target == 0 {
+            return false;
+        }
+    }
+
+    for i in 0..count {
+        let rela = &*((dyn_info.jmprel + i * 24) as *const Elf64Rela);
+        if (rela.r_info & 0xffffffff) as u32 == R_X86_64_JUMP_SLOT {
+            let target = (rela.r_offset as i64 + load_bias) as *mut u64;
+            *target = (*target as i64 + load_bias) as u64;
+        } else {
+            apply_rela(rela, load_bias, dyn_info, &mut SymbolSource::Lookup);
+        }
+    }
+
+    let got = dyn_info.pltgot as *mut u64;
+    *got.add(1) = lib_idx as u64;
+    *got.add(2) = dl_runtime_resolve as u64;
+    true
+}
+
+/// Bind one PLT slot on its first call; returns the function to jump to
+unsafe extern "C" fn dl_fixup(lib_idx: u64, reloc_index: u64) -> u64 {
+    let lib = &GLOBAL_SYMTAB.libs[lib_idx as usize];
+    let dyn_info = &lib.dyn_info;
+    let rela = &*((dyn_info.jmprel + reloc_index * 24) as *const Elf64Rela);
+    let sym_idx = (rela.r_info >> 32) as u32;
+
+    let addr = lookup_symbol(dyn_info, sym_idx);
+    if addr == 0 {
+        print_str("[ld-nrlib] symbol lookup error: ");
+        let name = get_symbol_name(dyn_info, sym_idx);
+        if !name.is_null() {
+            print(core::slice::from_raw_parts(name, cstr_len(name)));
+        }
+        print_str("\n");
+        exit(127);
+    }
+
+    // Racing threads store the same value; one aligned store is atomic
+    let target = (rela.r_offset as i64 + lib.load_bias) as *mut u64;
+    core::ptr::write_volatile(target, addr);
+    addr
+}
+
+/// PLT0 target: resolve the slot, then tail-jump to the real function
+///
+/// On entry `[rsp]` is GOT[1] (object index) and `[rsp + 8]` the
+/// relocation index. Argument registers, `rax` (vararg SSE count), `r10`
+/// (static chain) and xmm0-7 are preserved across the lookup.
+#[unsafe(naked)]
+unsafe extern "C" fn dl_runtime_resolve() {
+    naked_asm!(
+        // rsp is 8 mod 16 here; 8 pushes + 136 bytes realigns it
+        "push rax",
+        "push rcx",
+        "push rdx",
+        "push rsi",
+        "push rdi",
+        "push r8",
+        "push r9",
+        "push r10",
+        "sub rsp, 136",
+        "movdqa xmmword ptr [rsp], xmm0",
+        "movdqa xmmword ptr [rsp + 16], xmm1",
+        "movdqa xmmword ptr [rsp + 32], xmm2",
+        "movdqa xmmword ptr [rsp + 48], xmm3",
+        "movdqa xmmword ptr [rsp + 64], xmm4",
+        "movdqa xmmword ptr [rsp + 80], xmm5",
+        "movdqa xmmword ptr [rsp + 96], xmm6",
+        "movdqa xmmword ptr [rsp + 112], xmm7",
+        "mov rdi, [rsp + 200]",
+        "mov rsi, [rsp + 208]",
+        "call {fixup}",
+        "mov r11, rax",
+        "movdqa xmm0, xmmword ptr [rsp]",
+        "movdqa xmm1, xmmword ptr [rsp + 16]",
+        "movdqa xmm2, xmmword ptr [rsp + 32]",
+        "movdqa xmm3, xmmword ptr [rsp + 48]",
+        "movdqa xmm4, xmmword ptr [rsp + 64]",
+        "movdqa xmm5, xmmword ptr [rsp + 80]",
+        "movdqa xmm6, xmmword ptr [rsp + 96]",
+        "movdqa xmm7, xmmword ptr [rsp + 112]",
+        "add rsp, 136",
+        "pop r10",
+        "pop r9",
+        "pop r8",
+        "pop rdi",
+        "pop rsi",
+        "pop rdx",
+        "pop rcx",
+        "pop rax",
+        // Drop the object and relocation index
+        "add rsp, 16",
+        "jmp r11",
+        fixup = sym dl_fixup,
+    );
+}
+
+// ============================================================================
+// Whole-Process Relocation
+// ============================================================================
+
+/// Relocate the main executable and every loaded library, in load order
+///
+/// PLT slots are bound lazily unless `bind_now` is set, the object asks for
+/// DF_BIND_NOW / DF_1_NOW, or `source` is recording or replaying a prelink
+/// image (which must see every symbol relocation).
+pub unsafe fn relocate_all(bind_now: bool, source: &mut SymbolSource) {
+    let eager_source = !matches!(source, SymbolSource::Lookup);
+
+    for i in 0..GLOBAL_SYMTAB.lib_count {
+        let lib = GLOBAL_SYMTAB.libs[i];
+        if !lib.valid {
+            continue;
+        }
+        let dyn_info = &lib.dyn_info;
+
+        if dyn_info.rela != 0 && dyn_info.relasz > 0 {
+            process_rela_with_symtab(
+                dyn_info.rela,
+                dyn_info.relasz,
+                dyn_info.relaent,
+                lib.load_bias,
+                dyn_info,
+                source,
+            );
+        }
+
+        if dyn_info.jmprel != 0 && dyn_info.pltrelsz > 0 {
+            let eager = bind_now
+                || eager_source
+                || dyn_info.flags & DF_BIND_NOW != 0
+                || dyn_info.flags_1 & DF_1_NOW != 0;
+            if eager || !setup_lazy_plt(i, dyn_info, lib.load_bias) {
+                process_rela_with_symtab(
+                    dyn_info.jmprel,
+                    dyn_info.pltrelsz,
+                    24,
+                    lib.load_bias,
+                    dyn_info,
+                    source,
+                );
             }
         }
     }
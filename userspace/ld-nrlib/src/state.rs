@@ -19,6 +19,7 @@ pub struct DynInfo {
     pub jmprel: u64,
     pub pltrelsz: u64,
     pub pltrel: u64, // DT_PLTREL - type of PLT relocations
+    pub pltgot: u64, // DT_PLTGOT - .got.plt, GOT[1]/GOT[2] feed the lazy resolver
     pub init: u64,
     pub fini: u64,
     pub init_array: u64,
@@ -55,6 +56,7 @@ impl DynInfo {
             jmprel: 0,
             pltrelsz: 0,
             pltrel: 0,
+            pltgot: 0,
             init: 0,
             fini: 0,
             init_array: 0,
@@ -91,6 +93,9 @@ pub struct LoadedLib {
     pub dyn_info: DynInfo,
     /// Is this entry valid
     pub valid: bool,
+    /// NUL-terminated path the object was loaded from (empty for the
+    /// main executable)
+    pub path: [u8; 256],
 }
 
 impl LoadedLib {
@@ -100,6 +105,7 @@ impl LoadedLib {
             load_bias: 0,
             dyn_info: DynInfo::new(),
             valid: false,
+            path: [0; 256],
         }
     }
 }
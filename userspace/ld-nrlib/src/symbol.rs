@@ -1,5 +1,8 @@
 //! Symbol lookup functions for the NexaOS dynamic linker
 
+use core::sync::atomic::{AtomicBool, Ordering};
+
+use crate::constants::STT_GNU_IFUNC;
 use crate::elf::Elf64Sym;
 use crate::state::{DynInfo, LoadedLib, GLOBAL_SYMTAB};
 
@@ -36,6 +39,33 @@ pub fn elf_hash(name: &[u8]) -> u32 {
     h
 }
 
+/// Both hashes of one symbol name, computed once per global lookup instead
+/// of once per library searched. The SYSV hash is only needed for objects
+/// without DT_GNU_HASH, so it is filled in on first use.
+pub struct SymbolHash {
+    pub gnu: u32,
+    elf: u32,
+    elf_valid: bool,
+}
+
+impl SymbolHash {
+    pub fn new(name: &[u8]) -> Self {
+        Self {
+            gnu: gnu_hash(name),
+            elf: 0,
+            elf_valid: false,
+        }
+    }
+
+    pub fn elf(&mut self, name: &[u8]) -> u32 {
+        if !self.elf_valid {
+            self.elf = elf_hash(name);
+            self.elf_valid = true;
+        }
+        self.elf
+    }
+}
+
 // ============================================================================
 // Symbol Count
 // ============================================================================
@@ -47,17 +77,56 @@ pub unsafe fn get_symbol_count(dyn_info: &DynInfo) -> usize {
         let nchain = *((dyn_info.hash + 4) as *const u32);
         return nchain as usize;
     }
+    if dyn_info.gnu_hash != 0 {
+        // GNU hash has no count: find the highest bucket start and walk its
+        // chain to the terminating entry
+        let gnu_hash_addr = dyn_info.gnu_hash;
+        let nbuckets = *(gnu_hash_addr as *const u32);
+        let symoffset = *((gnu_hash_addr + 4) as *const u32);
+        let bloom_size = *((gnu_hash_addr + 8) as *const u32);
+        let buckets = (gnu_hash_addr + 16 + (bloom_size as u64 * 8)) as *const u32;
+        let chains = buckets.add(nbuckets as usize);
+
+        let mut last = 0u32;
+        for i in 0..nbuckets as usize {
+            last = last.max(*buckets.add(i));
+        }
+        if last < symoffset {
+            return symoffset as usize;
+        }
+        while *chains.add((last - symoffset) as usize) & 1 == 0 {
+            last += 1;
+        }
+        return last as usize + 1;
+    }
     // Fallback
     256
 }
 
+/// Address a defined symbol binds to. STT_GNU_IFUNC symbols point at a
+/// resolver that picks the implementation for this CPU, so call it.
+unsafe fn symbol_address(lib: &LoadedLib, sym: &Elf64Sym) -> u64 {
+    let addr = (sym.st_value as i64 + lib.load_bias) as u64;
+    if sym.st_info & 0xf == STT_GNU_IFUNC {
+        let resolver: extern "C" fn() -> u64 = core::mem::transmute(addr);
+        return resolver();
+    }
+    addr
+}
+
 // ============================================================================
 // GNU Hash Table Lookup
 // ============================================================================
 
 /// Lookup symbol using GNU hash table (much faster than linear search)
 /// Returns symbol value (with load_bias applied) or 0 if not found
+#[allow(dead_code)]
 pub unsafe fn lookup_symbol_gnu_hash(lib: &LoadedLib, name: &[u8]) -> u64 {
+    lookup_symbol_gnu_hash_with(lib, name, gnu_hash(name))
+}
+
+/// GNU hash lookup with the name's hash already computed
+unsafe fn lookup_symbol_gnu_hash_with(lib: &LoadedLib, name: &[u8], h1: u32) -> u64 {
     let dyn_info = &lib.dyn_info;
 
     if dyn_info.gnu_hash == 0 || dyn_info.symtab == 0 || dyn_info.strtab == 0 {
@@ -91,7 +160,6 @@ pub unsafe fn lookup_symbol_gnu_hash(lib: &LoadedLib, name: &[u8]) -> u64 {
         return 0;
     }
 
-    let h1 = gnu_hash(name);
     let h2 = h1 >> bloom_shift;
 
     // Check bloom filter first (64-bit)
@@ -141,7 +209,7 @@ pub unsafe fn lookup_symbol_gnu_hash(lib: &LoadedLib, name: &[u8]) -> u64 {
             if match_found && *sym_name_ptr.add(j) == 0 {
                 // Found it!
                 if sym.st_value != 0 || sym.st_shndx != 0 {
-                    return (sym.st_value as i64 + lib.load_bias) as u64;
+                    return symbol_address(lib, sym);
                 }
             }
         }
@@ -162,7 +230,13 @@ pub unsafe fn lookup_symbol_gnu_hash(lib: &LoadedLib, name: &[u8]) -> u64 {
 // ============================================================================
 
 /// Lookup symbol using ELF SYSV hash table
+#[allow(dead_code)]
 pub unsafe fn lookup_symbol_elf_hash(lib: &LoadedLib, name: &[u8]) -> u64 {
+    lookup_symbol_elf_hash_with(lib, name, elf_hash(name))
+}
+
+/// SYSV hash lookup with the name's hash already computed
+unsafe fn lookup_symbol_elf_hash_with(lib: &LoadedLib, name: &[u8], h: u32) -> u64 {
     let dyn_info = &lib.dyn_info;
 
     if dyn_info.hash == 0 || dyn_info.symtab == 0 || dyn_info.strtab == 0 {
@@ -191,7 +265,6 @@ pub unsafe fn lookup_symbol_elf_hash(lib: &LoadedLib, name: &[u8]) -> u64 {
         return 0;
     }
 
-    let h = elf_hash(name);
     let bucket = (hash_addr + 8) as *const u32;
     let chain = bucket.add(nbucket as usize);
 
@@ -215,7 +288,7 @@ pub unsafe fn lookup_symbol_elf_hash(lib: &LoadedLib, name: &[u8]) -> u64 {
 
         if match_found && *sym_name_ptr.add(j) == 0 {
             if sym.st_value != 0 || sym.st_shndx != 0 {
-                return (sym.st_value as i64 + lib.load_bias) as u64;
+                return symbol_address(lib, sym);
             }
         }
 
@@ -233,6 +306,11 @@ pub unsafe fn lookup_symbol_elf_hash(lib: &LoadedLib, name: &[u8]) -> u64 {
 /// Uses GNU hash if available, falls back to ELF hash or linear search
 /// Returns symbol value (with load_bias applied) or 0 if not found
 pub unsafe fn lookup_symbol_in_lib(lib: &LoadedLib, name: &[u8]) -> u64 {
+    lookup_symbol_in_lib_with(lib, name, &mut SymbolHash::new(name))
+}
+
+/// Single-library lookup with the name's hashes shared across libraries
+unsafe fn lookup_symbol_in_lib_with(lib: &LoadedLib, name: &[u8], hash: &mut SymbolHash) -> u64 {
     if !lib.valid {
         return 0;
     }
@@ -244,7 +322,7 @@ pub unsafe fn lookup_symbol_in_lib(lib: &LoadedLib, name: &[u8]) -> u64 {
 
     // Try GNU hash first (fastest)
     if dyn_info.gnu_hash != 0 {
-        let result = lookup_symbol_gnu_hash(lib, name);
+        let result = lookup_symbol_gnu_hash_with(lib, name, hash.gnu);
         if result != 0 {
             return result;
         }
@@ -252,7 +330,7 @@ pub unsafe fn lookup_symbol_in_lib(lib: &LoadedLib, name: &[u8]) -> u64 {
 
     // Try ELF SYSV hash
     if dyn_info.hash != 0 {
-        let result = lookup_symbol_elf_hash(lib, name);
+        let result = lookup_symbol_elf_hash_with(lib, name, hash.elf(name));
         if result != 0 {
             return result;
         }
@@ -302,7 +380,7 @@ pub unsafe fn lookup_symbol_in_lib(lib: &LoadedLib, name: &[u8]) -> u64 {
 
         if match_found && sym.st_value != 0 {
             // Found it!
-            return (sym.st_value as i64 + lib.load_bias) as u64;
+            return symbol_address(lib, sym);
         }
     }
 
@@ -327,6 +405,7 @@ unsafe fn lookup_builtin_symbol(name: &[u8]) -> u64 {
         b"__tls_get_addr" => crate::tls::__tls_get_addr as u64,
         b"__cxa_thread_atexit_impl" => crate::compat::__cxa_thread_atexit_impl as u64,
         b"__dso_handle" => &crate::compat::__dso_handle as *const _ as u64,
+        b"__nrlib_static_tls" => core::ptr::addr_of!(crate::tls::__nrlib_static_tls) as u64,
         _ => 0,
     }
 }
@@ -338,6 +417,10 @@ unsafe fn lookup_builtin_symbol(name: &[u8]) -> u64 {
 /// Global symbol lookup - search all loaded libraries
 /// Search order: builtin symbols first, main executable, then libraries in load order
 pub unsafe fn global_symbol_lookup(name: &[u8]) -> u64 {
+    global_symbol_lookup_with(name, &mut SymbolHash::new(name))
+}
+
+unsafe fn global_symbol_lookup_with(name: &[u8], hash: &mut SymbolHash) -> u64 {
     // First check builtin symbols provided by the dynamic linker
     let builtin = lookup_builtin_symbol(name);
     if builtin != 0 {
@@ -345,7 +428,7 @@ pub unsafe fn global_symbol_lookup(name: &[u8]) -> u64 {
     }
 
     for i in 0..GLOBAL_SYMTAB.lib_count {
-        let addr = lookup_symbol_in_lib(&GLOBAL_SYMTAB.libs[i], name);
+        let addr = lookup_symbol_in_lib_with(&GLOBAL_SYMTAB.libs[i], name, hash);
         if addr != 0 {
             return addr;
         }
@@ -368,6 +451,150 @@ pub unsafe fn global_symbol_lookup_cstr(name: *const u8) -> u64 {
     global_symbol_lookup(name_slice)
 }
 
+// ============================================================================
+// Symbol Resolution Cache
+// ============================================================================
+
+/// Slots in the resolution cache (power of two)
+const SYMBOL_CACHE_SIZE: usize = 4096;
+
+/// Stop inserting past this many entries so probe chains stay short
+const SYMBOL_CACHE_LIMIT: usize = SYMBOL_CACHE_SIZE * 3 / 4;
+
+#[derive(Clone, Copy)]
+struct CacheEntry {
+    /// Name inside a loaded object's string table; null marks a free slot
+    name: *const u8,
+    len: u32,
+    hash: u32,
+    /// Resolved address, 0 for a symbol nobody defines
+    addr: u64,
+}
+
+/// Per-process map from symbol name to resolved address
+///
+/// Every library imports the same few hundred libc and Rust runtime symbols,
+/// so after the first object is relocated most lookups hit here instead of
+/// walking every loaded object's hash table. Keys point into the string
+/// tables of loaded objects, which stay mapped for the life of the process.
+struct SymbolCache {
+    entries: [CacheEntry; SYMBOL_CACHE_SIZE],
+    used: usize,
+    /// Number of loaded objects the entries were resolved against
+    lib_count: usize,
+}
+
+static mut SYMBOL_CACHE: SymbolCache = SymbolCache {
+    entries: [CacheEntry {
+        name: core::ptr::null(),
+        len: 0,
+        hash: 0,
+        addr: 0,
+    }; SYMBOL_CACHE_SIZE],
+    used: 0,
+    lib_count: 0,
+};
+
+/// Serializes cache access once lazy binding runs on several threads
+static SYMBOL_CACHE_LOCK: AtomicBool = AtomicBool::new(false);
+
+unsafe fn names_equal(a: *const u8, b: *const u8, len: usize) -> bool {
+    if a == b {
+        return true;
+    }
+    for i in 0..len {
+        if *a.add(i) != *b.add(i) {
+            return false;
+        }
+    }
+    true
+}
+
+fn lock_cache() {
+    while SYMBOL_CACHE_LOCK
+        .compare_exchange_weak(false, true, Ordering::Acquire, Ordering::Relaxed)
+        .is_err()
+    {
+        core::hint::spin_loop();
+    }
+}
+
+fn unlock_cache() {
+    SYMBOL_CACHE_LOCK.store(false, Ordering::Release);
+}
+
+/// Find `name` in the cache; `Err(slot)` is the free slot to insert into
+unsafe fn probe_cache(
+    cache: &SymbolCache,
+    name: *const u8,
+    len: usize,
+    hash: u32,
+) -> Result<u64, usize> {
+    let mask = SYMBOL_CACHE_SIZE - 1;
+    let mut slot = hash as usize & mask;
+    loop {
+        let entry = &cache.entries[slot];
+        if entry.name.is_null() {
+            return Err(slot);
+        }
+        if entry.hash == hash && entry.len as usize == len && names_equal(entry.name, name, len) {
+            return Ok(entry.addr);
+        }
+        slot = (slot + 1) & mask;
+    }
+}
+
+/// Global lookup through the resolution cache
+///
+/// `name` must live in the string table of a loaded object (relocation and
+/// PLT paths); transient names such as dlsym arguments go through
+/// `global_symbol_lookup_cstr` instead.
+pub unsafe fn cached_symbol_lookup(name: *const u8) -> u64 {
+    // Mangled Rust names routinely pass cstr_len's 256-byte cap
+    let mut len = 0;
+    while core::ptr::read_volatile(name.add(len)) != 0 {
+        len += 1;
+    }
+    let name_slice = core::slice::from_raw_parts(name, len);
+    let mut hash = SymbolHash::new(name_slice);
+    let cache = &mut *core::ptr::addr_of_mut!(SYMBOL_CACHE);
+
+    lock_cache();
+    if cache.lib_count != GLOBAL_SYMTAB.lib_count {
+        // Scope changed since the entries were filled: start over
+        for entry in cache.entries.iter_mut() {
+            entry.name = core::ptr::null();
+        }
+        cache.used = 0;
+        cache.lib_count = GLOBAL_SYMTAB.lib_count;
+    }
+    let hit = probe_cache(cache, name, len, hash.gnu);
+    unlock_cache();
+    if let Ok(addr) = hit {
+        return addr;
+    }
+
+    // Resolve unlocked: an IFUNC resolver may itself go through a lazy PLT
+    // slot and land back here
+    let addr = global_symbol_lookup_with(name_slice, &mut hash);
+
+    lock_cache();
+    if cache.used < SYMBOL_CACHE_LIMIT {
+        // Another thread may have filled it meanwhile; probe again
+        if let Err(slot) = probe_cache(cache, name, len, hash.gnu) {
+            cache.entries[slot] = CacheEntry {
+                name,
+                len: len as u32,
+                hash: hash.gnu,
+                addr,
+            };
+            cache.used += 1;
+        }
+    }
+    unlock_cache();
+    addr
+}
+
 /// Get symbol name from symbol table by index
 pub unsafe fn get_symbol_name(dyn_info: &DynInfo, sym_idx: u32) -> *const u8 {
     if dyn_info.symtab == 0 || dyn_info.strtab == 0 {
@@ -98,6 +98,11 @@ pub unsafe fn open_file(path: *const u8) -> i64 {
     syscall3(SYS_OPEN, path as u64, 0, 0) as i64
 }
 
+/// Open a file with explicit flags and creation mode
+pub unsafe fn open_file_mode(path: *const u8, flags: u64, mode: u64) -> i64 {
+    syscall3(SYS_OPEN, path as u64, flags, mode) as i64
+}
+
 /// Close a file descriptor
 pub unsafe fn close_file(fd: i32) {
     syscall1(SYS_CLOSE, fd as u64);
@@ -117,3 +122,13 @@ pub unsafe fn lseek(fd: i32, offset: i64, whence: i32) -> i64 {
 pub unsafe fn mmap(addr: u64, length: u64, prot: u64, flags: u64, fd: i64, offset: u64) -> u64 {
     syscall6(SYS_MMAP, addr, length, prot, flags, fd as u64, offset)
 }
+
+/// munmap wrapper
+pub unsafe fn munmap(addr: u64, length: u64) {
+    syscall2(SYS_MUNMAP, addr, length);
+}
+
+/// mprotect wrapper
+pub unsafe fn mprotect(addr: u64, length: u64, prot: u64) {
+    syscall3(SYS_MPROTECT, addr, length, prot);
+}
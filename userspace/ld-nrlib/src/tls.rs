@@ -4,17 +4,33 @@
 //! - TCB (Thread Control Block) is at FS base
 //! - TLS data is located before the TCB
 //! - DTV (Dynamic Thread Vector) provides access to each module's TLS block
+//!
+//! Every module loaded at startup gets a fixed offset from the thread
+//! pointer (static TLS), so initial-exec and local-exec accesses are plain
+//! `%fs`-relative loads and `__tls_get_addr` is one table lookup. The
+//! layout is published to nrlib as `__nrlib_static_tls`, which builds the
+//! same block for every thread it creates.
 
 use core::arch::asm;
 use core::ptr;
 
-use crate::constants::MAX_TLS_MODULES;
-use crate::syscall::syscall2;
+use crate::constants::{MAP_ANONYMOUS, MAP_PRIVATE, MAX_TLS_MODULES, PROT_READ, PROT_WRITE};
+use crate::elf::Elf64Sym;
+use crate::state::{DynInfo, GLOBAL_SYMTAB};
+use crate::symbol::{get_symbol_name, lookup_symbol_in_lib};
+use crate::syscall::{mmap, syscall2};
 
 // Constants
 const ARCH_SET_FS: u64 = 0x1002;
 const SYS_ARCH_PRCTL: u64 = 158;
 
+/// Bytes reserved above the thread pointer for the thread control block.
+/// nrlib's ThreadControlBlock must fit here; it checks at startup.
+const TCB_RESERVED: usize = 2048;
+
+/// Minimum thread pointer alignment (one cache line)
+const TP_ALIGN: usize = 64;
+
 // ============================================================================
 // TLS Module Information
 // ============================================================================
@@ -52,18 +68,65 @@ impl TlsModule {
 // Thread Control Block (TCB) for main thread
 // ============================================================================
 
-/// TCB structure compatible with nrlib
-/// Must match the layout in nrlib/src/libc_compat/pthread.rs
+/// Leading fields of nrlib's ThreadControlBlock
+/// (nrlib/src/libc_compat/pthread.rs), which owns the rest of the
+/// TCB_RESERVED bytes
 #[repr(C)]
 pub struct TcbHeader {
     /// Self pointer (for TLS access via %fs:0)
     pub self_ptr: *mut TcbHeader,
     /// DTV pointer (Dynamic Thread Vector)
     pub dtv: *mut usize,
-    /// Padding to match nrlib's ThreadControlBlock layout
-    _padding: [u8; 1024 + 128 - 16],
 }
 
+// ============================================================================
+// Published Layout
+// ============================================================================
+
+/// One module's initialization image, as nrlib sees it
+#[repr(C)]
+#[derive(Clone, Copy)]
+pub struct StaticTlsImage {
+    pub image: u64,
+    pub filesz: u64,
+    pub memsz: u64,
+    /// Offset of the module's block from the thread pointer
+    pub offset: i64,
+}
+
+/// Static TLS layout shared with nrlib (`__nrlib_static_tls`)
+///
+/// Must match `StaticTlsLayout` in nrlib/src/libc_compat/tls.rs.
+#[repr(C)]
+pub struct StaticTlsLayout {
+    /// Bytes of TLS data below the thread pointer
+    pub size: u64,
+    /// Alignment the thread pointer needs
+    pub align: u64,
+    /// Bytes above the main thread's pointer available for the TCB
+    pub tcb_size: u64,
+    /// Main thread's thread pointer (already in FS), 0 before setup
+    pub main_tp: u64,
+    /// Number of valid entries in `modules`
+    pub count: u64,
+    pub modules: [StaticTlsImage; MAX_TLS_MODULES],
+}
+
+#[no_mangle]
+pub static mut __nrlib_static_tls: StaticTlsLayout = StaticTlsLayout {
+    size: 0,
+    align: TP_ALIGN as u64,
+    tcb_size: 0,
+    main_tp: 0,
+    count: 0,
+    modules: [StaticTlsImage {
+        image: 0,
+        filesz: 0,
+        memsz: 0,
+        offset: 0,
+    }; MAX_TLS_MODULES],
+};
+
 // ============================================================================
 // Global TLS State
 // ============================================================================
@@ -75,6 +138,8 @@ pub struct TlsState {
     pub count: usize,
     /// Total static TLS size (sum of all module memsz with alignment)
     pub total_size: usize,
+    /// Largest module alignment (and at least TP_ALIGN)
+    pub max_align: usize,
     /// TLS module ID counter
     pub next_id: u64,
     /// TLS block base address (where all TLS data is stored)
@@ -83,6 +148,8 @@ pub struct TlsState {
     pub tcb_addr: u64,
     /// DTV address
     pub dtv_addr: u64,
+    /// Offsets assigned
+    pub laid_out: bool,
     /// Initialization done flag
     pub initialized: bool,
 }
@@ -93,10 +160,12 @@ impl TlsState {
             modules: [TlsModule::new(); MAX_TLS_MODULES],
             count: 0,
             total_size: 0,
+            max_align: TP_ALIGN,
             next_id: 1,
             tls_block: 0,
             tcb_addr: 0,
             dtv_addr: 0,
+            laid_out: false,
             initialized: false,
         }
     }
@@ -104,10 +173,13 @@ impl TlsState {
 
 pub static mut TLS_STATE: TlsState = TlsState::new();
 
-// Static storage for main thread TCB and TLS
-// 16KB should be enough for most programs
+// Static storage for main thread TCB and TLS; bigger layouts are mmapped
 const TLS_STATIC_SIZE: usize = 16 * 1024;
-static mut TLS_STATIC_BLOCK: [u8; TLS_STATIC_SIZE] = [0u8; TLS_STATIC_SIZE];
+
+#[repr(C, align(64))]
+struct TlsStaticBlock([u8; TLS_STATIC_SIZE]);
+
+static mut TLS_STATIC_BLOCK: TlsStaticBlock = TlsStaticBlock([0u8; TLS_STATIC_SIZE]);
 
 // DTV storage (module count + 1 entry per module)
 const MAX_DTV_ENTRIES: usize = MAX_TLS_MODULES + 2;
@@ -119,7 +191,7 @@ static mut DTV_STORAGE: [usize; MAX_DTV_ENTRIES] = [0; MAX_DTV_ENTRIES];
 
 /// Register a TLS module (called during library loading)
 pub unsafe fn register_tls_module(image: u64, filesz: u64, memsz: u64, align: u64) -> u64 {
-    if TLS_STATE.count >= MAX_TLS_MODULES {
+    if TLS_STATE.count >= MAX_TLS_MODULES || TLS_STATE.laid_out {
         return 0;
     }
 
@@ -133,7 +205,7 @@ pub unsafe fn register_tls_module(image: u64, filesz: u64, memsz: u64, align: u6
         filesz,
         memsz,
         align: if align == 0 { 1 } else { align },
-        offset: 0, // Will be calculated in setup_main_thread_tls
+        offset: 0, // Assigned by layout_static_tls
     };
     TLS_STATE.count += 1;
 
@@ -148,67 +220,156 @@ fn align_up(value: usize, align: usize) -> usize {
     (value + align - 1) & !(align - 1)
 }
 
-/// Setup TLS for the main thread
-/// Must be called after all libraries are loaded but before calling _start
-pub unsafe fn setup_main_thread_tls() {
-    if TLS_STATE.initialized {
+/// Assign every registered module its offset from the thread pointer
+///
+/// Must run after all startup libraries are loaded and before relocation,
+/// since TPOFF relocations bake these offsets into the code's GOT.
+/// Module 1 is the executable, whose local-exec offsets the static linker
+/// already fixed at -align_up(memsz, align); the rest follow below it.
+pub unsafe fn layout_static_tls() {
+    if TLS_STATE.laid_out {
         return;
     }
 
-    // Calculate total TLS size needed
-    // Layout (variant II, x86_64):
-    //   [module N TLS] ... [module 1 TLS] [TCB]
-    //                                     ^
-    //                                     FS base points here
-    
-    let tcb_size = core::mem::size_of::<TcbHeader>();
     let mut current_offset: usize = 0;
-    
-    // Calculate offsets for each module (going backwards from TCB)
+    let mut max_align = TP_ALIGN;
     for i in 0..TLS_STATE.count {
         let module = &mut TLS_STATE.modules[i];
-        let aligned_size = align_up(module.memsz as usize, module.align as usize);
-        current_offset += aligned_size;
-        // Offset is negative from TP for variant II
+        let align = module.align as usize;
+        current_offset = align_up(current_offset + module.memsz as usize, align);
         module.offset = -(current_offset as i64);
+        if align > max_align {
+            max_align = align;
+        }
     }
-    
-    TLS_STATE.total_size = current_offset;
-    
-    // Total allocation = TLS data + TCB + DTV
-    let total_alloc = current_offset + tcb_size;
-    
-    if total_alloc > TLS_STATIC_SIZE {
-        // TLS block too large - this is a limitation of the current implementation
+
+    TLS_STATE.total_size = align_up(current_offset, max_align);
+    TLS_STATE.max_align = max_align;
+    TLS_STATE.laid_out = true;
+
+    let layout = &mut *ptr::addr_of_mut!(__nrlib_static_tls);
+    layout.size = TLS_STATE.total_size as u64;
+    layout.align = max_align as u64;
+    layout.tcb_size = TCB_RESERVED as u64;
+    layout.count = TLS_STATE.count as u64;
+    for i in 0..TLS_STATE.count {
+        let module = &TLS_STATE.modules[i];
+        layout.modules[i] = StaticTlsImage {
+            image: module.image,
+            filesz: module.filesz,
+            memsz: module.memsz,
+            offset: module.offset,
+        };
+    }
+}
+
+/// Offset of module `module_id`'s block from the thread pointer
+#[inline]
+pub unsafe fn module_tp_offset(module_id: u64) -> i64 {
+    // IDs are handed out sequentially from 1, so the table index is id - 1
+    let idx = module_id.wrapping_sub(1) as usize;
+    if idx < TLS_STATE.count {
+        TLS_STATE.modules[idx].offset
+    } else {
+        0
+    }
+}
+
+/// Module ID and in-module offset of TLS symbol `sym_idx` of `dyn_info`
+///
+/// Locally defined symbols live in the object's own block; undefined ones
+/// are looked up in the global scope and attributed to the defining object.
+pub unsafe fn resolve_tls_symbol(dyn_info: &DynInfo, sym_idx: u32) -> (u64, u64) {
+    if sym_idx == 0 {
+        return (dyn_info.tls_modid, 0);
+    }
+
+    let syment = if dyn_info.syment == 0 {
+        24
+    } else {
+        dyn_info.syment
+    };
+    let sym = &*((dyn_info.symtab + (sym_idx as u64) * syment) as *const Elf64Sym);
+    if sym.st_shndx != 0 {
+        return (dyn_info.tls_modid, sym.st_value);
+    }
+
+    let name = get_symbol_name(dyn_info, sym_idx);
+    if name.is_null() {
+        return (dyn_info.tls_modid, sym.st_value);
+    }
+    let mut len = 0;
+    while *name.add(len) != 0 {
+        len += 1;
+    }
+    let name = core::slice::from_raw_parts(name, len);
+
+    for i in 0..GLOBAL_SYMTAB.lib_count {
+        let lib = &GLOBAL_SYMTAB.libs[i];
+        let addr = lookup_symbol_in_lib(lib, name);
+        if addr != 0 && lib.dyn_info.tls_modid != 0 {
+            return (lib.dyn_info.tls_modid, (addr as i64 - lib.load_bias) as u64);
+        }
+    }
+
+    (dyn_info.tls_modid, sym.st_value)
+}
+
+/// Setup TLS for the main thread
+/// Must be called after relocation but before any initializer runs
+pub unsafe fn setup_main_thread_tls() {
+    if TLS_STATE.initialized {
         return;
     }
-    
-    // Setup pointers in static block
-    // [TLS data (total_size bytes)] [TCB (tcb_size bytes)]
-    let block_base = TLS_STATIC_BLOCK.as_mut_ptr() as u64;
-    let tcb_addr = block_base + current_offset as u64;
-    
-    TLS_STATE.tls_block = block_base;
+    layout_static_tls();
+
+    // Layout (variant II, x86_64):
+    //   [module N TLS] ... [module 1 TLS] [TCB]
+    //                                     ^
+    //                                     FS base points here
+    let align = TLS_STATE.max_align;
+    let total_size = TLS_STATE.total_size;
+    let needed = total_size + TCB_RESERVED;
+
+    let block_base = if needed + align <= TLS_STATIC_SIZE {
+        ptr::addr_of_mut!(TLS_STATIC_BLOCK) as u64
+    } else {
+        let addr = mmap(
+            0,
+            (needed + align) as u64,
+            PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS,
+            -1,
+            0,
+        );
+        if addr == 0 || addr >= 0xFFFF_FFFF_FFFF_F000 {
+            return;
+        }
+        addr
+    };
+    let tcb_addr = align_up(block_base as usize + total_size, align) as u64;
+
+    TLS_STATE.tls_block = tcb_addr - total_size as u64;
     TLS_STATE.tcb_addr = tcb_addr;
-    
+
     // Initialize TCB
     let tcb = tcb_addr as *mut TcbHeader;
     (*tcb).self_ptr = tcb;
-    (*tcb).dtv = DTV_STORAGE.as_mut_ptr();
-    
+    (*tcb).dtv = ptr::addr_of_mut!(DTV_STORAGE) as *mut usize;
+
     // Setup DTV
     // DTV[0] = generation count (0 for now)
     // DTV[1] = address of module 1's TLS block
     // DTV[2] = address of module 2's TLS block
     // etc.
     DTV_STORAGE[0] = TLS_STATE.count; // Generation/count
-    
+
     for i in 0..TLS_STATE.count {
         let module = &TLS_STATE.modules[i];
         // Calculate absolute address of this module's TLS block
         let tls_addr = (tcb_addr as i64 + module.offset) as u64;
         DTV_STORAGE[module.id as usize] = tls_addr as usize;
-        
+
         // Initialize TLS data: copy .tdata, zero .tbss
         if module.filesz > 0 {
             ptr::copy_nonoverlapping(
@@ -226,12 +387,13 @@ pub unsafe fn setup_main_thread_tls() {
             );
         }
     }
-    
-    TLS_STATE.dtv_addr = DTV_STORAGE.as_ptr() as u64;
-    
+
+    TLS_STATE.dtv_addr = ptr::addr_of!(DTV_STORAGE) as u64;
+
     // Set FS base to point to TCB
     syscall2(SYS_ARCH_PRCTL, ARCH_SET_FS, tcb_addr);
-    
+
+    __nrlib_static_tls.main_tp = tcb_addr;
     TLS_STATE.initialized = true;
 }
 
@@ -248,26 +410,25 @@ pub struct TlsIndex {
 
 /// __tls_get_addr - TLS access function (musl/glibc compatible)
 /// Used for accessing thread-local variables in dynamically loaded libraries
+///
+/// Every module is in static TLS, so this is the thread pointer plus the
+/// module's fixed offset: no DTV walk, and it works unchanged in threads
+/// nrlib creates.
 #[no_mangle]
 pub unsafe extern "C" fn __tls_get_addr(ti: *const TlsIndex) -> *mut u8 {
     if ti.is_null() {
         return core::ptr::null_mut();
     }
 
-    let module_id = (*ti).ti_module;
-    let offset = (*ti).ti_offset;
-
     // Get thread pointer (FS base on x86_64)
     let tp: u64;
     asm!("mov {}, fs:0", out(reg) tp, options(nostack, preserves_flags, readonly));
 
-    // For static TLS (variant II, x86_64), TLS data is below TP
-    // Find the module and calculate address
-    for i in 0..TLS_STATE.count {
-        if TLS_STATE.modules[i].id == module_id {
-            let tls_offset = TLS_STATE.modules[i].offset;
-            return (tp as i64 + tls_offset + offset as i64) as *mut u8;
-        }
+    let module_id = (*ti).ti_module;
+    let offset = (*ti).ti_offset;
+    let idx = module_id.wrapping_sub(1) as usize;
+    if idx < TLS_STATE.count {
+        return (tp as i64 + TLS_STATE.modules[idx].offset + offset as i64) as *mut u8;
     }
 
     // Module not found - return TP + offset as fallback for module 0
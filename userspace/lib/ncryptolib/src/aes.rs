@@ -2,6 +2,24 @@
 //!
 //! FIPS 197 compliant AES implementation with GCM, CTR, and CBC modes.
 //! SP 800-38D compliant AES-GCM implementation.
+//!
+//! The implementation is chosen once per key, by CPUID:
+//! - AES-NI rounds with eight blocks in flight and PCLMULQDQ GHASH
+//!   ([`aes_ni`](crate::aes_ni)), when the CPU has them and the library is
+//!   built with `hw-accel`.
+//! - Otherwise constant-time bitsliced AES ([`aes_ct`](crate::aes_ct)) and a
+//!   constant-time GHASH multiply ([`ghash`](crate::ghash)). Neither uses
+//!   key- or data-dependent table lookups.
+//!
+//! CTR, GCM and CBC decryption hand the core batches of independent blocks
+//! so either implementation can work on several at once.
+
+use crate::aes_ct::{self, BitslicedAes};
+#[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+use crate::aes_ni::AesNi;
+#[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+use crate::cpu;
+use crate::ghash::GhashKey;
 
 // ============================================================================
 // AES Constants
@@ -20,376 +38,161 @@ pub const GCM_TAG_SIZE: usize = 16;
 /// GCM nonce size (recommended)
 pub const GCM_NONCE_SIZE: usize = 12;
 
-// AES S-box
-const SBOX: [u8; 256] = [
-    0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
-    0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
-    0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
-    0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
-    0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
-    0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
-    0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
-    0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
-    0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
-    0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
-    0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
-    0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
-    0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
-    0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
-    0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
-    0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16,
-];
-
-// Inverse S-box for decryption
-const INV_SBOX: [u8; 256] = [
-    0x52, 0x09, 0x6a, 0xd5, 0x30, 0x36, 0xa5, 0x38, 0xbf, 0x40, 0xa3, 0x9e, 0x81, 0xf3, 0xd7, 0xfb,
-    0x7c, 0xe3, 0x39, 0x82, 0x9b, 0x2f, 0xff, 0x87, 0x34, 0x8e, 0x43, 0x44, 0xc4, 0xde, 0xe9, 0xcb,
-    0x54, 0x7b, 0x94, 0x32, 0xa6, 0xc2, 0x23, 0x3d, 0xee, 0x4c, 0x95, 0x0b, 0x42, 0xfa, 0xc3, 0x4e,
-    0x08, 0x2e, 0xa1, 0x66, 0x28, 0xd9, 0x24, 0xb2, 0x76, 0x5b, 0xa2, 0x49, 0x6d, 0x8b, 0xd1, 0x25,
-    0x72, 0xf8, 0xf6, 0x64, 0x86, 0x68, 0x98, 0x16, 0xd4, 0xa4, 0x5c, 0xcc, 0x5d, 0x65, 0xb6, 0x92,
-    0x6c, 0x70, 0x48, 0x50, 0xfd, 0xed, 0xb9, 0xda, 0x5e, 0x15, 0x46, 0x57, 0xa7, 0x8d, 0x9d, 0x84,
-    0x90, 0xd8, 0xab, 0x00, 0x8c, 0xbc, 0xd3, 0x0a, 0xf7, 0xe4, 0x58, 0x05, 0xb8, 0xb3, 0x45, 0x06,
-    0xd0, 0x2c, 0x1e, 0x8f, 0xca, 0x3f, 0x0f, 0x02, 0xc1, 0xaf, 0xbd, 0x03, 0x01, 0x13, 0x8a, 0x6b,
-    0x3a, 0x91, 0x11, 0x41, 0x4f, 0x67, 0xdc, 0xea, 0x97, 0xf2, 0xcf, 0xce, 0xf0, 0xb4, 0xe6, 0x73,
-    0x96, 0xac, 0x74, 0x22, 0xe7, 0xad, 0x35, 0x85, 0xe2, 0xf9, 0x37, 0xe8, 0x1c, 0x75, 0xdf, 0x6e,
-    0x47, 0xf1, 0x1a, 0x71, 0x1d, 0x29, 0xc5, 0x89, 0x6f, 0xb7, 0x62, 0x0e, 0xaa, 0x18, 0xbe, 0x1b,
-    0xfc, 0x56, 0x3e, 0x4b, 0xc6, 0xd2, 0x79, 0x20, 0x9a, 0xdb, 0xc0, 0xfe, 0x78, 0xcd, 0x5a, 0xf4,
-    0x1f, 0xdd, 0xa8, 0x33, 0x88, 0x07, 0xc7, 0x31, 0xb1, 0x12, 0x10, 0x59, 0x27, 0x80, 0xec, 0x5f,
-    0x60, 0x51, 0x7f, 0xa9, 0x19, 0xb5, 0x4a, 0x0d, 0x2d, 0xe5, 0x7a, 0x9f, 0x93, 0xc9, 0x9c, 0xef,
-    0xa0, 0xe0, 0x3b, 0x4d, 0xae, 0x2a, 0xf5, 0xb0, 0xc8, 0xeb, 0xbb, 0x3c, 0x83, 0x53, 0x99, 0x61,
-    0x17, 0x2b, 0x04, 0x7e, 0xba, 0x77, 0xd6, 0x26, 0xe1, 0x69, 0x14, 0x63, 0x55, 0x21, 0x0c, 0x7d,
-];
-
-// Round constants
-const RCON: [u8; 11] = [
-    0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36,
-];
-
 // ============================================================================
 // AES Core Implementation
 // ============================================================================
 
-/// AES-128 cipher
-#[derive(Clone)]
-pub struct Aes128 {
-    round_keys: [[u8; 16]; 11],
-}
+/// Blocks encrypted per batch by the CTR-based modes
+const CTR_BATCH: usize = 8;
 
-impl Aes128 {
-    /// Create a new AES-128 cipher with the given key
-    pub fn new(key: &[u8; AES_128_KEY_SIZE]) -> Self {
-        let round_keys = Self::key_expansion(key);
-        Self { round_keys }
+/// Key schedule for the implementation chosen when the key was set up
+#[derive(Clone)]
+enum AesCore {
+    /// AES-NI, eight blocks in flight
+    #[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+    Ni(AesNi),
+    /// Constant-time bitsliced software, four blocks per pass
+    Soft(BitslicedAes),
+}
+
+impl AesCore {
+    fn new(key: &[u8]) -> Self {
+        #[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+        if cpu::has_aes_ni() {
+            // SAFETY: AES-NI was detected
+            return AesCore::Ni(unsafe { AesNi::new(key) });
+        }
+        AesCore::Soft(BitslicedAes::new(key))
+    }
+
+    /// Encrypt independent blocks in place
+    fn encrypt_blocks(&self, blocks: &mut [[u8; 16]]) {
+        match self {
+            #[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+            // SAFETY: only constructed when the CPU supports AES-NI
+            AesCore::Ni(keys) => unsafe { keys.encrypt(blocks) },
+            AesCore::Soft(keys) => {
+                for chunk in blocks.chunks_mut(aes_ct::PARALLEL_BLOCKS) {
+                    keys.encrypt(chunk);
+                }
+            }
+        }
     }
 
-    fn key_expansion(key: &[u8; 16]) -> [[u8; 16]; 11] {
-        let mut round_keys = [[0u8; 16]; 11];
-        round_keys[0].copy_from_slice(key);
+    /// Decrypt independent blocks in place
+    fn decrypt_blocks(&self, blocks: &mut [[u8; 16]]) {
+        match self {
+            #[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+            // SAFETY: only constructed when the CPU supports AES-NI
+            AesCore::Ni(keys) => unsafe { keys.decrypt(blocks) },
+            AesCore::Soft(keys) => {
+                for chunk in blocks.chunks_mut(aes_ct::PARALLEL_BLOCKS) {
+                    keys.decrypt(chunk);
+                }
+            }
+        }
+    }
 
-        for i in 1..11 {
-            let mut temp = [0u8; 4];
-            temp.copy_from_slice(&round_keys[i - 1][12..16]);
+    fn encrypt_block(&self, block: &[u8; 16]) -> [u8; 16] {
+        let mut blocks = [*block];
+        self.encrypt_blocks(&mut blocks);
+        blocks[0]
+    }
 
-            // RotWord
-            temp.rotate_left(1);
+    fn decrypt_block(&self, block: &[u8; 16]) -> [u8; 16] {
+        let mut blocks = [*block];
+        self.decrypt_blocks(&mut blocks);
+        blocks[0]
+    }
 
-            // SubWord
-            for b in temp.iter_mut() {
-                *b = SBOX[*b as usize];
+    /// XOR `data` with the keystream E(counter), E(counter + 1), ...;
+    /// `counter` is left at the next unused value
+    fn apply_keystream(
+        &self,
+        counter: &mut [u8; 16],
+        data: &mut [u8],
+        increment: fn(&mut [u8; 16]),
+    ) {
+        let mut keystream = [[0u8; 16]; CTR_BATCH];
+        for chunk in data.chunks_mut(16 * CTR_BATCH) {
+            let blocks = chunk.len().div_ceil(16);
+            for block in keystream[..blocks].iter_mut() {
+                *block = *counter;
+                increment(counter);
             }
-
-            // XOR with Rcon
-            temp[0] ^= RCON[i];
-
-            // Generate round key
-            for j in 0..4 {
-                for k in 0..4 {
-                    round_keys[i][j * 4 + k] = round_keys[i - 1][j * 4 + k] ^ temp[k];
-                }
-                if j < 3 {
-                    temp.copy_from_slice(&round_keys[i][j * 4..(j + 1) * 4]);
+            self.encrypt_blocks(&mut keystream[..blocks]);
+            for (dst, ks) in chunk.chunks_mut(16).zip(keystream.iter()) {
+                if let Ok(dst) = <&mut [u8; 16]>::try_from(&mut *dst) {
+                    let x = u128::from_ne_bytes(*dst) ^ u128::from_ne_bytes(*ks);
+                    *dst = x.to_ne_bytes();
+                } else {
+                    for (d, k) in dst.iter_mut().zip(ks) {
+                        *d ^= k;
+                    }
                 }
             }
         }
-
-        round_keys
     }
+}
 
-    /// Encrypt a single block
-    pub fn encrypt_block(&self, plaintext: &[u8; 16]) -> [u8; 16] {
-        let mut state = *plaintext;
+/// Increment the low 32 bits of a counter block (GCM)
+fn increment32(counter: &mut [u8; 16]) {
+    let ctr = u32::from_be_bytes([counter[12], counter[13], counter[14], counter[15]]);
+    counter[12..].copy_from_slice(&ctr.wrapping_add(1).to_be_bytes());
+}
 
-        // Initial round key addition
-        xor_block(&mut state, &self.round_keys[0]);
+/// Increment the whole counter block as a 128-bit big-endian integer (CTR)
+fn increment128(counter: &mut [u8; 16]) {
+    *counter = u128::from_be_bytes(*counter).wrapping_add(1).to_be_bytes();
+}
 
-        // Main rounds
-        for round in 1..10 {
-            sub_bytes(&mut state);
-            shift_rows(&mut state);
-            mix_columns(&mut state);
-            xor_block(&mut state, &self.round_keys[round]);
-        }
+/// AES-128 cipher
+#[derive(Clone)]
+pub struct Aes128 {
+    core: AesCore,
+}
 
-        // Final round (no MixColumns)
-        sub_bytes(&mut state);
-        shift_rows(&mut state);
-        xor_block(&mut state, &self.round_keys[10]);
+impl Aes128 {
+    /// Create a new AES-128 cipher with the given key
+    pub fn new(key: &[u8; AES_128_KEY_SIZE]) -> Self {
+        Self {
+            core: AesCore::new(key),
+        }
+    }
 
-        state
+    /// Encrypt a single block
+    pub fn encrypt_block(&self, plaintext: &[u8; 16]) -> [u8; 16] {
+        self.core.encrypt_block(plaintext)
     }
 
     /// Decrypt a single block
     pub fn decrypt_block(&self, ciphertext: &[u8; 16]) -> [u8; 16] {
-        let mut state = *ciphertext;
-
-        // Initial round key addition
-        xor_block(&mut state, &self.round_keys[10]);
-
-        // Main rounds (in reverse)
-        for round in (1..10).rev() {
-            inv_shift_rows(&mut state);
-            inv_sub_bytes(&mut state);
-            xor_block(&mut state, &self.round_keys[round]);
-            inv_mix_columns(&mut state);
-        }
-
-        // Final round
-        inv_shift_rows(&mut state);
-        inv_sub_bytes(&mut state);
-        xor_block(&mut state, &self.round_keys[0]);
-
-        state
+        self.core.decrypt_block(ciphertext)
     }
 }
 
 /// AES-256 cipher
 #[derive(Clone)]
 pub struct Aes256 {
-    round_keys: [[u8; 16]; 15],
+    core: AesCore,
 }
 
 impl Aes256 {
     /// Create a new AES-256 cipher with the given key
     pub fn new(key: &[u8; AES_256_KEY_SIZE]) -> Self {
-        let round_keys = Self::key_expansion(key);
-        Self { round_keys }
-    }
-
-    fn key_expansion(key: &[u8; 32]) -> [[u8; 16]; 15] {
-        let mut expanded = [0u8; 240]; // 15 * 16 bytes
-        expanded[..32].copy_from_slice(key);
-
-        let mut i = 8; // Start after initial 8 words (32 bytes)
-        while i < 60 {
-            let mut temp = [0u8; 4];
-            temp.copy_from_slice(&expanded[(i - 1) * 4..i * 4]);
-
-            if i % 8 == 0 {
-                temp.rotate_left(1);
-                for b in temp.iter_mut() {
-                    *b = SBOX[*b as usize];
-                }
-                temp[0] ^= RCON[i / 8];
-            } else if i % 8 == 4 {
-                for b in temp.iter_mut() {
-                    *b = SBOX[*b as usize];
-                }
-            }
-
-            for j in 0..4 {
-                expanded[i * 4 + j] = expanded[(i - 8) * 4 + j] ^ temp[j];
-            }
-            i += 1;
-        }
-
-        let mut round_keys = [[0u8; 16]; 15];
-        for (i, rk) in round_keys.iter_mut().enumerate() {
-            rk.copy_from_slice(&expanded[i * 16..(i + 1) * 16]);
+        Self {
+            core: AesCore::new(key),
         }
-
-        round_keys
     }
 
     /// Encrypt a single block
     pub fn encrypt_block(&self, plaintext: &[u8; 16]) -> [u8; 16] {
-        let mut state = *plaintext;
-
-        xor_block(&mut state, &self.round_keys[0]);
-
-        for round in 1..14 {
-            sub_bytes(&mut state);
-            shift_rows(&mut state);
-            mix_columns(&mut state);
-            xor_block(&mut state, &self.round_keys[round]);
-        }
-
-        sub_bytes(&mut state);
-        shift_rows(&mut state);
-        xor_block(&mut state, &self.round_keys[14]);
-
-        state
+        self.core.encrypt_block(plaintext)
     }
 
     /// Decrypt a single block
     pub fn decrypt_block(&self, ciphertext: &[u8; 16]) -> [u8; 16] {
-        let mut state = *ciphertext;
-
-        xor_block(&mut state, &self.round_keys[14]);
-
-        for round in (1..14).rev() {
-            inv_shift_rows(&mut state);
-            inv_sub_bytes(&mut state);
-            xor_block(&mut state, &self.round_keys[round]);
-            inv_mix_columns(&mut state);
-        }
-
-        inv_shift_rows(&mut state);
-        inv_sub_bytes(&mut state);
-        xor_block(&mut state, &self.round_keys[0]);
-
-        state
-    }
-}
-
-// ============================================================================
-// AES Helper Functions
-// ============================================================================
-
-#[inline]
-fn xor_block(state: &mut [u8; 16], key: &[u8; 16]) {
-    for i in 0..16 {
-        state[i] ^= key[i];
-    }
-}
-
-#[inline]
-fn sub_bytes(state: &mut [u8; 16]) {
-    for b in state.iter_mut() {
-        *b = SBOX[*b as usize];
-    }
-}
-
-#[inline]
-fn inv_sub_bytes(state: &mut [u8; 16]) {
-    for b in state.iter_mut() {
-        *b = INV_SBOX[*b as usize];
-    }
-}
-
-#[inline]
-fn shift_rows(state: &mut [u8; 16]) {
-    // AES state is column-major:
-    // s[0] s[4] s[8]  s[12]
-    // s[1] s[5] s[9]  s[13]
-    // s[2] s[6] s[10] s[14]
-    // s[3] s[7] s[11] s[15]
-
-    // Row 1: shift left by 1
-    // new[1,5,9,13] = old[5,9,13,1]
-    let tmp = state[1];
-    state[1] = state[5];
-    state[5] = state[9];
-    state[9] = state[13];
-    state[13] = tmp;
-
-    // Row 2: shift left by 2
-    // new[2,6,10,14] = old[10,14,2,6]
-    state.swap(2, 10);
-    state.swap(6, 14);
-
-    // Row 3: shift left by 3
-    // new[3,7,11,15] = old[15,3,7,11]
-    let tmp = state[3];
-    state[3] = state[15];
-    state[15] = state[11];
-    state[11] = state[7];
-    state[7] = tmp;
-}
-
-#[inline]
-fn inv_shift_rows(state: &mut [u8; 16]) {
-    // Inverse of shift_rows
-
-    // Row 1: shift right by 1
-    // new[1,5,9,13] = old[13,1,5,9]
-    let tmp = state[13];
-    state[13] = state[9];
-    state[9] = state[5];
-    state[5] = state[1];
-    state[1] = tmp;
-
-    // Row 2: shift right by 2 (same as left by 2)
-    // new[2,6,10,14] = old[10,14,2,6]
-    state.swap(2, 10);
-    state.swap(6, 14);
-
-    // Row 3: shift right by 3
-    // new[3,7,11,15] = old[7,11,15,3]
-    let tmp = state[3];
-    state[3] = state[7];
-    state[7] = state[11];
-    state[11] = state[15];
-    state[15] = tmp;
-}
-
-#[inline]
-fn xtime(x: u8) -> u8 {
-    (x << 1) ^ (((x >> 7) & 1) * 0x1b)
-}
-
-#[inline]
-fn mix_columns(state: &mut [u8; 16]) {
-    for i in 0..4 {
-        let col = i * 4;
-        let a = state[col];
-        let b = state[col + 1];
-        let c = state[col + 2];
-        let d = state[col + 3];
-        let e = a ^ b ^ c ^ d;
-
-        state[col] ^= e ^ xtime(a ^ b);
-        state[col + 1] ^= e ^ xtime(b ^ c);
-        state[col + 2] ^= e ^ xtime(c ^ d);
-        state[col + 3] ^= e ^ xtime(d ^ a);
-    }
-}
-
-#[inline]
-fn multiply(x: u8, y: u8) -> u8 {
-    let mut result = 0u8;
-    let mut a = x;
-    let mut b = y;
-
-    for _ in 0..8 {
-        if (b & 1) != 0 {
-            result ^= a;
-        }
-        let hi_bit = a & 0x80;
-        a <<= 1;
-        if hi_bit != 0 {
-            a ^= 0x1b;
-        }
-        b >>= 1;
-    }
-    result
-}
-
-#[inline]
-fn inv_mix_columns(state: &mut [u8; 16]) {
-    for i in 0..4 {
-        let col = i * 4;
-        let a = state[col];
-        let b = state[col + 1];
-        let c = state[col + 2];
-        let d = state[col + 3];
-
-        state[col] = multiply(a, 0x0e) ^ multiply(b, 0x0b) ^ multiply(c, 0x0d) ^ multiply(d, 0x09);
-        state[col + 1] =
-            multiply(a, 0x09) ^ multiply(b, 0x0e) ^ multiply(c, 0x0b) ^ multiply(d, 0x0d);
-        state[col + 2] =
-            multiply(a, 0x0d) ^ multiply(b, 0x09) ^ multiply(c, 0x0e) ^ multiply(d, 0x0b);
-        state[col + 3] =
-            multiply(a, 0x0b) ^ multiply(b, 0x0d) ^ multiply(c, 0x09) ^ multiply(d, 0x0e);
+        self.core.decrypt_block(ciphertext)
     }
 }
 
@@ -400,7 +203,7 @@ fn inv_mix_columns(state: &mut [u8; 16]) {
 /// AES-GCM cipher for authenticated encryption
 pub struct AesGcm<T> {
     cipher: T,
-    h: [u8; 16], // Hash subkey
+    ghash: GhashKey, // Hash subkey H, prepared for the GHASH implementation
 }
 
 impl AesGcm<Aes128> {
@@ -408,7 +211,10 @@ impl AesGcm<Aes128> {
     pub fn new_128(key: &[u8; AES_128_KEY_SIZE]) -> Self {
         let cipher = Aes128::new(key);
         let h = cipher.encrypt_block(&[0u8; 16]);
-        Self { cipher, h }
+        Self {
+            cipher,
+            ghash: GhashKey::new(&h),
+        }
     }
 }
 
@@ -417,72 +223,21 @@ impl AesGcm<Aes256> {
     pub fn new_256(key: &[u8; AES_256_KEY_SIZE]) -> Self {
         let cipher = Aes256::new(key);
         let h = cipher.encrypt_block(&[0u8; 16]);
-        Self { cipher, h }
+        Self {
+            cipher,
+            ghash: GhashKey::new(&h),
+        }
     }
 }
 
 impl<T> AesGcm<T> {
-    /// GCM multiplication in GF(2^128)
-    /// Uses the NIST GCM specification: polynomial x^128 + x^7 + x^2 + x + 1
-    /// with bit reflection (LSB first within bytes, big-endian byte order)
-    fn ghash_multiply(&self, x: &[u8; 16], y: &[u8; 16]) -> [u8; 16] {
-        let mut z = [0u8; 16];
-        let mut v = *y;
-
-        for i in 0..128 {
-            let byte_idx = i / 8;
-            let bit_idx = 7 - (i % 8);
-
-            // Check bit i of X (MSB first within each byte)
-            if (x[byte_idx] >> bit_idx) & 1 == 1 {
-                for j in 0..16 {
-                    z[j] ^= v[j];
-                }
-            }
-
-            // Check if LSB of V (rightmost bit of the 128-bit value) is 1
-            let lsb = v[15] & 1;
-
-            // Right shift V by 1 bit (treating as 128-bit big-endian integer)
-            for j in (1..16).rev() {
-                v[j] = (v[j] >> 1) | ((v[j - 1] & 1) << 7);
-            }
-            v[0] >>= 1;
-
-            // If LSB was 1, XOR with R = 0xe1 || 0^120 (big-endian)
-            // This is the reduction polynomial x^128 + x^7 + x^2 + x + 1
-            // In big-endian, R = 0xe1000000000000000000000000000000
-            if lsb == 1 {
-                v[0] ^= 0xe1;
-            }
-        }
-
-        z
-    }
-
     /// GHASH function
     fn ghash(&self, aad: &[u8], ciphertext: &[u8]) -> [u8; 16] {
         let mut y = [0u8; 16];
 
-        // Process AAD
-        for chunk in aad.chunks(16) {
-            let mut block = [0u8; 16];
-            block[..chunk.len()].copy_from_slice(chunk);
-            for i in 0..16 {
-                y[i] ^= block[i];
-            }
-            y = self.ghash_multiply(&y, &self.h);
-        }
-
-        // Process ciphertext
-        for chunk in ciphertext.chunks(16) {
-            let mut block = [0u8; 16];
-            block[..chunk.len()].copy_from_slice(chunk);
-            for i in 0..16 {
-                y[i] ^= block[i];
-            }
-            y = self.ghash_multiply(&y, &self.h);
-        }
+        // AAD and ciphertext are each zero-padded to whole blocks
+        self.ghash.update(&mut y, aad);
+        self.ghash.update(&mut y, ciphertext);
 
         // Process length block
         let mut len_block = [0u8; 16];
@@ -490,11 +245,7 @@ impl<T> AesGcm<T> {
         let ct_bits = (ciphertext.len() as u64) * 8;
         len_block[..8].copy_from_slice(&aad_bits.to_be_bytes());
         len_block[8..].copy_from_slice(&ct_bits.to_be_bytes());
-
-        for i in 0..16 {
-            y[i] ^= len_block[i];
-        }
-        y = self.ghash_multiply(&y, &self.h);
+        self.ghash.update(&mut y, &len_block);
 
         y
     }
@@ -508,9 +259,7 @@ impl AesGcm<Aes128> {
         plaintext: &[u8],
         aad: &[u8],
     ) -> (Vec<u8>, [u8; GCM_TAG_SIZE]) {
-        self.encrypt_internal(nonce, plaintext, aad, |block| {
-            self.cipher.encrypt_block(block)
-        })
+        self.encrypt_internal(&self.cipher.core, nonce, plaintext, aad)
     }
 
     /// Decrypt with AES-128-GCM
@@ -521,9 +270,7 @@ impl AesGcm<Aes128> {
         aad: &[u8],
         tag: &[u8; GCM_TAG_SIZE],
     ) -> Option<Vec<u8>> {
-        self.decrypt_internal(nonce, ciphertext, aad, tag, |block| {
-            self.cipher.encrypt_block(block)
-        })
+        self.decrypt_internal(&self.cipher.core, nonce, ciphertext, aad, tag)
     }
 }
 
@@ -535,9 +282,7 @@ impl AesGcm<Aes256> {
         plaintext: &[u8],
         aad: &[u8],
     ) -> (Vec<u8>, [u8; GCM_TAG_SIZE]) {
-        self.encrypt_internal(nonce, plaintext, aad, |block| {
-            self.cipher.encrypt_block(block)
-        })
+        self.encrypt_internal(&self.cipher.core, nonce, plaintext, aad)
     }
 
     /// Decrypt with AES-256-GCM
@@ -548,50 +293,41 @@ impl AesGcm<Aes256> {
         aad: &[u8],
         tag: &[u8; GCM_TAG_SIZE],
     ) -> Option<Vec<u8>> {
-        self.decrypt_internal(nonce, ciphertext, aad, tag, |block| {
-            self.cipher.encrypt_block(block)
-        })
+        self.decrypt_internal(&self.cipher.core, nonce, ciphertext, aad, tag)
     }
 }
 
 impl<T> AesGcm<T> {
-    fn encrypt_internal<F>(
-        &self,
-        nonce: &[u8],
-        plaintext: &[u8],
-        aad: &[u8],
-        encrypt_block: F,
-    ) -> (Vec<u8>, [u8; GCM_TAG_SIZE])
-    where
-        F: Fn(&[u8; 16]) -> [u8; 16],
-    {
-        // Initialize counter J0
-        let mut j0 = [0u8; 16];
+    /// Pre-counter block J0
+    fn j0(&self, nonce: &[u8]) -> [u8; 16] {
         if nonce.len() == 12 {
+            let mut j0 = [0u8; 16];
             j0[..12].copy_from_slice(nonce);
             j0[15] = 1;
+            j0
         } else {
-            j0 = self.ghash(&[], nonce);
+            self.ghash(&[], nonce)
         }
+    }
+
+    fn encrypt_internal(
+        &self,
+        core: &AesCore,
+        nonce: &[u8],
+        plaintext: &[u8],
+        aad: &[u8],
+    ) -> (Vec<u8>, [u8; GCM_TAG_SIZE]) {
+        let j0 = self.j0(nonce);
 
         // Encrypt using counters starting from J0+1
-        let mut ciphertext = Vec::with_capacity(plaintext.len());
+        let mut ciphertext = plaintext.to_vec();
         let mut counter = j0;
-
-        for chunk in plaintext.chunks(16) {
-            // Increment counter first (J0+1, J0+2, ...)
-            let ctr = u32::from_be_bytes([counter[12], counter[13], counter[14], counter[15]]);
-            counter[12..16].copy_from_slice(&(ctr.wrapping_add(1)).to_be_bytes());
-
-            let keystream = encrypt_block(&counter);
-            for (i, &p) in chunk.iter().enumerate() {
-                ciphertext.push(p ^ keystream[i]);
-            }
-        }
+        increment32(&mut counter);
+        core.apply_keystream(&mut counter, &mut ciphertext, increment32);
 
         // Compute tag: GHASH(AAD, Ciphertext) XOR E_K(J0)
         let s = self.ghash(aad, &ciphertext);
-        let e_j0 = encrypt_block(&j0); // E_K(J0), NOT E_K(J0+1)
+        let e_j0 = core.encrypt_block(&j0); // E_K(J0), NOT E_K(J0+1)
 
         let mut tag = [0u8; GCM_TAG_SIZE];
         for i in 0..16 {
@@ -601,30 +337,20 @@ impl<T> AesGcm<T> {
         (ciphertext, tag)
     }
 
-    fn decrypt_internal<F>(
+    fn decrypt_internal(
         &self,
+        core: &AesCore,
         nonce: &[u8],
         ciphertext: &[u8],
         aad: &[u8],
         tag: &[u8; GCM_TAG_SIZE],
-        encrypt_block: F,
-    ) -> Option<Vec<u8>>
-    where
-        F: Fn(&[u8; 16]) -> [u8; 16],
-    {
-        // Initialize counter J0
-        let mut j0 = [0u8; 16];
-        if nonce.len() == 12 {
-            j0[..12].copy_from_slice(nonce);
-            j0[15] = 1;
-        } else {
-            j0 = self.ghash(&[], nonce);
-        }
+    ) -> Option<Vec<u8>> {
+        let j0 = self.j0(nonce);
 
         // Verify tag first
         // GCM Tag = GHASH(AAD, Ciphertext) XOR E_K(J0)
         let s = self.ghash(aad, ciphertext);
-        let e_j0 = encrypt_block(&j0); // E_K(J0), NOT E_K(J0+1)
+        let e_j0 = core.encrypt_block(&j0); // E_K(J0), NOT E_K(J0+1)
 
         let mut computed_tag = [0u8; GCM_TAG_SIZE];
         for i in 0..16 {
@@ -641,19 +367,10 @@ impl<T> AesGcm<T> {
         }
 
         // Decrypt using counters starting from J0+1
+        let mut plaintext = ciphertext.to_vec();
         let mut counter = j0;
-        let mut plaintext = Vec::with_capacity(ciphertext.len());
-
-        for chunk in ciphertext.chunks(16) {
-            // Increment counter first (J0+1, J0+2, ...)
-            let ctr = u32::from_be_bytes([counter[12], counter[13], counter[14], counter[15]]);
-            counter[12..16].copy_from_slice(&(ctr.wrapping_add(1)).to_be_bytes());
-
-            let keystream = encrypt_block(&counter);
-            for (i, &c) in chunk.iter().enumerate() {
-                plaintext.push(c ^ keystream[i]);
-            }
-        }
+        increment32(&mut counter);
+        core.apply_keystream(&mut counter, &mut plaintext, increment32);
 
         Some(plaintext)
     }
@@ -678,7 +395,7 @@ impl AesCtr<Aes128> {
 
     /// Encrypt/decrypt (CTR mode is symmetric)
     pub fn process(&self, nonce: &[u8; 16], data: &[u8]) -> Vec<u8> {
-        self.process_internal(nonce, data, |block| self.cipher.encrypt_block(block))
+        process_ctr(&self.cipher.core, nonce, data)
     }
 }
 
@@ -692,35 +409,15 @@ impl AesCtr<Aes256> {
 
     /// Encrypt/decrypt (CTR mode is symmetric)
     pub fn process(&self, nonce: &[u8; 16], data: &[u8]) -> Vec<u8> {
-        self.process_internal(nonce, data, |block| self.cipher.encrypt_block(block))
+        process_ctr(&self.cipher.core, nonce, data)
     }
 }
 
-impl<T> AesCtr<T> {
-    fn process_internal<F>(&self, nonce: &[u8; 16], data: &[u8], encrypt_block: F) -> Vec<u8>
-    where
-        F: Fn(&[u8; 16]) -> [u8; 16],
-    {
-        let mut result = Vec::with_capacity(data.len());
-        let mut counter = *nonce;
-
-        for chunk in data.chunks(16) {
-            let keystream = encrypt_block(&counter);
-            for (i, &byte) in chunk.iter().enumerate() {
-                result.push(byte ^ keystream[i]);
-            }
-
-            // Increment counter
-            for i in (0..16).rev() {
-                counter[i] = counter[i].wrapping_add(1);
-                if counter[i] != 0 {
-                    break;
-                }
-            }
-        }
-
-        result
-    }
+fn process_ctr(core: &AesCore, nonce: &[u8; 16], data: &[u8]) -> Vec<u8> {
+    let mut result = data.to_vec();
+    let mut counter = *nonce;
+    core.apply_keystream(&mut counter, &mut result, increment128);
+    result
 }
 
 // ============================================================================
@@ -742,12 +439,12 @@ impl AesCbc<Aes128> {
 
     /// Encrypt with PKCS7 padding
     pub fn encrypt(&self, iv: &[u8; 16], plaintext: &[u8]) -> Vec<u8> {
-        self.encrypt_internal(iv, plaintext, |block| self.cipher.encrypt_block(block))
+        cbc_encrypt(&self.cipher.core, iv, plaintext)
     }
 
     /// Decrypt and remove PKCS7 padding
     pub fn decrypt(&self, iv: &[u8; 16], ciphertext: &[u8]) -> Option<Vec<u8>> {
-        self.decrypt_internal(iv, ciphertext, |block| self.cipher.decrypt_block(block))
+        cbc_decrypt(&self.cipher.core, iv, ciphertext)
     }
 }
 
@@ -761,90 +458,83 @@ impl AesCbc<Aes256> {
 
     /// Encrypt with PKCS7 padding
     pub fn encrypt(&self, iv: &[u8; 16], plaintext: &[u8]) -> Vec<u8> {
-        self.encrypt_internal(iv, plaintext, |block| self.cipher.encrypt_block(block))
+        cbc_encrypt(&self.cipher.core, iv, plaintext)
     }
 
     /// Decrypt and remove PKCS7 padding
     pub fn decrypt(&self, iv: &[u8; 16], ciphertext: &[u8]) -> Option<Vec<u8>> {
-        self.decrypt_internal(iv, ciphertext, |block| self.cipher.decrypt_block(block))
+        cbc_decrypt(&self.cipher.core, iv, ciphertext)
     }
 }
 
-impl<T> AesCbc<T> {
-    fn encrypt_internal<F>(&self, iv: &[u8; 16], plaintext: &[u8], encrypt_block: F) -> Vec<u8>
-    where
-        F: Fn(&[u8; 16]) -> [u8; 16],
-    {
-        // PKCS7 padding
-        let padding_len = 16 - (plaintext.len() % 16);
-        let mut padded = Vec::with_capacity(plaintext.len() + padding_len);
-        padded.extend_from_slice(plaintext);
-        padded.resize(plaintext.len() + padding_len, padding_len as u8);
+fn cbc_encrypt(core: &AesCore, iv: &[u8; 16], plaintext: &[u8]) -> Vec<u8> {
+    // PKCS7 padding
+    let padding_len = 16 - (plaintext.len() % 16);
+    let mut padded = Vec::with_capacity(plaintext.len() + padding_len);
+    padded.extend_from_slice(plaintext);
+    padded.resize(plaintext.len() + padding_len, padding_len as u8);
 
-        let mut result = Vec::with_capacity(padded.len());
-        let mut prev_block = *iv;
+    let mut result = Vec::with_capacity(padded.len());
+    let mut prev_block = *iv;
 
-        for chunk in padded.chunks(16) {
-            let mut block = [0u8; 16];
-            block.copy_from_slice(chunk);
+    // Each block depends on the previous one, so encryption is serial
+    for chunk in padded.chunks(16) {
+        let mut block = [0u8; 16];
+        block.copy_from_slice(chunk);
 
-            for i in 0..16 {
-                block[i] ^= prev_block[i];
-            }
-
-            let encrypted = encrypt_block(&block);
-            result.extend_from_slice(&encrypted);
-            prev_block = encrypted;
+        for i in 0..16 {
+            block[i] ^= prev_block[i];
         }
 
-        result
+        let encrypted = core.encrypt_block(&block);
+        result.extend_from_slice(&encrypted);
+        prev_block = encrypted;
     }
 
-    fn decrypt_internal<F>(
-        &self,
-        iv: &[u8; 16],
-        ciphertext: &[u8],
-        decrypt_block: F,
-    ) -> Option<Vec<u8>>
-    where
-        F: Fn(&[u8; 16]) -> [u8; 16],
-    {
-        if ciphertext.is_empty() || ciphertext.len() % 16 != 0 {
-            return None;
-        }
+    result
+}
 
-        let mut result = Vec::with_capacity(ciphertext.len());
-        let mut prev_block = *iv;
+fn cbc_decrypt(core: &AesCore, iv: &[u8; 16], ciphertext: &[u8]) -> Option<Vec<u8>> {
+    if ciphertext.is_empty() || ciphertext.len() % 16 != 0 {
+        return None;
+    }
 
-        for chunk in ciphertext.chunks(16) {
-            let mut block = [0u8; 16];
-            block.copy_from_slice(chunk);
+    // Decryption of each block is independent: decrypt a batch, then XOR
+    // each result with the ciphertext block before it
+    let mut result = Vec::with_capacity(ciphertext.len());
+    let mut prev_block = *iv;
+    let mut batch = [[0u8; 16]; CTR_BATCH];
 
-            let decrypted = decrypt_block(&block);
+    for chunk in ciphertext.chunks(16 * CTR_BATCH) {
+        let blocks = chunk.len() / 16;
+        for (block, src) in batch.iter_mut().zip(chunk.chunks_exact(16)) {
+            block.copy_from_slice(src);
+        }
+        core.decrypt_blocks(&mut batch[..blocks]);
 
+        for (decrypted, src) in batch[..blocks].iter().zip(chunk.chunks_exact(16)) {
             for i in 0..16 {
                 result.push(decrypted[i] ^ prev_block[i]);
             }
-
-            prev_block = block;
+            prev_block.copy_from_slice(src);
         }
+    }
 
-        // Remove PKCS7 padding
-        let padding_len = *result.last()? as usize;
-        if padding_len == 0 || padding_len > 16 {
-            return None;
-        }
+    // Remove PKCS7 padding
+    let padding_len = *result.last()? as usize;
+    if padding_len == 0 || padding_len > 16 {
+        return None;
+    }
 
-        // Verify padding
-        for &b in &result[result.len() - padding_len..] {
-            if b as usize != padding_len {
-                return None;
-            }
+    // Verify padding
+    for &b in &result[result.len() - padding_len..] {
+        if b as usize != padding_len {
+            return None;
         }
-
-        result.truncate(result.len() - padding_len);
-        Some(result)
     }
+
+    result.truncate(result.len() - padding_len);
+    Some(result)
 }
 
 // ============================================================================
@@ -926,4 +616,164 @@ mod tests {
 
         assert_eq!(plaintext, decrypted);
     }
+
+    fn hex(s: &str) -> Vec<u8> {
+        crate::encoding::hex_decode(s).unwrap()
+    }
+
+    /// Both implementations for a key: the portable one, and AES-NI when
+    /// this machine has it
+    fn cores(key: &[u8]) -> Vec<AesCore> {
+        let mut cores = vec![AesCore::Soft(BitslicedAes::new(key))];
+        #[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+        if cpu::has_aes_ni() {
+            cores.push(AesCore::Ni(unsafe { AesNi::new(key) }));
+        }
+        cores
+    }
+
+    #[test]
+    fn test_fips197_vectors() {
+        let plaintext: [u8; 16] = hex("00112233445566778899aabbccddeeff").try_into().unwrap();
+        let cases = [
+            (
+                "000102030405060708090a0b0c0d0e0f",
+                "69c4e0d86a7b0430d8cdb78070b4c55a",
+            ),
+            (
+                "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f",
+                "8ea2b7ca516745bfeafc49904b496089",
+            ),
+        ];
+        for (key, expected) in cases {
+            for core in cores(&hex(key)) {
+                let ciphertext = core.encrypt_block(&plaintext);
+                assert_eq!(ciphertext.to_vec(), hex(expected));
+                assert_eq!(core.decrypt_block(&ciphertext), plaintext);
+            }
+        }
+    }
+
+    #[test]
+    fn test_gcm_vectors() {
+        // McGrew & Viega, "The Galois/Counter Mode of Operation", test
+        // cases 2, 4, 6 and 16
+        let p = "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a72\
+                 1c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39";
+        let a = "feedfacedeadbeeffeedfacedeadbeefabaddad2";
+        let k = "feffe9928665731c6d6a8f9467308308";
+
+        let gcm = AesGcm::new_128(&[0u8; 16]);
+        let (c, t) = gcm.encrypt(&[0u8; 12], &[0u8; 16], &[]);
+        assert_eq!(c, hex("0388dace60b6a392f328c2b971b2fe78"));
+        assert_eq!(t.to_vec(), hex("ab6e47d42cec13bdf53a67b21257bddf"));
+
+        let gcm = AesGcm::new_128(&hex(k).try_into().unwrap());
+        let (c, t) = gcm.encrypt(&hex("cafebabefacedbaddecaf888"), &hex(p), &hex(a));
+        assert_eq!(
+            c,
+            hex(
+                "42831ec2217774244b7221b784d0d49ce3aa212f2c02a4e035c17e2329aca12e\
+                 21d514b25466931c7d8f6a5aac84aa051ba30b396a0aac973d58e091"
+            )
+        );
+        assert_eq!(t.to_vec(), hex("5bc94fbc3221a5db94fae95ae7121a47"));
+        assert_eq!(
+            gcm.decrypt(&hex("cafebabefacedbaddecaf888"), &c, &hex(a), &t),
+            Some(hex(p))
+        );
+
+        let iv = hex(
+            "9313225df88406e555909c5aff5269aa6a7a9538534f7da1e4c303d2a318a728\
+             c3c0c95156809539fcf0e2429a6b525416aedbf5a0de6a57a637b39b",
+        );
+        let (c, t) = gcm.encrypt(&iv, &hex(p), &hex(a));
+        assert_eq!(
+            c,
+            hex(
+                "8ce24998625615b603a033aca13fb894be9112a5c3a211a8ba262a3cca7e2ca7\
+                 01e4a9a4fba43c90ccdcb281d48c7c6fd62875d2aca417034c34aee5"
+            )
+        );
+        assert_eq!(t.to_vec(), hex("619cc5aefffe0bfa462af43c1699d050"));
+
+        let gcm = AesGcm::new_256(&hex(&format!("{}{}", k, k)).try_into().unwrap());
+        let (c, t) = gcm.encrypt(&hex("cafebabefacedbaddecaf888"), &hex(p), &hex(a));
+        assert_eq!(
+            c,
+            hex(
+                "522dc1f099567d07f47f37a32a84427d643a8cdcbfe5c0c97598a2bd2555d1aa\
+                 8cb08e48590dbb3da7b08b1056828838c5f61e6393ba7a0abcc9f662"
+            )
+        );
+        assert_eq!(t.to_vec(), hex("76fc6ece0f4e1768cddf8853bb2d551b"));
+
+        let mut bad = t;
+        bad[0] ^= 1;
+        assert_eq!(
+            gcm.decrypt(&hex("cafebabefacedbaddecaf888"), &c, &hex(a), &bad),
+            None
+        );
+    }
+
+    #[test]
+    fn test_ctr_vector() {
+        // SP 800-38A F.5.1 (CTR-AES128.Encrypt)
+        let ctr = AesCtr::new_128(&hex("2b7e151628aed2a6abf7158809cf4f3c").try_into().unwrap());
+        let counter: [u8; 16] = hex("f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff").try_into().unwrap();
+        let plaintext = hex(
+            "6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51\
+             30c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710",
+        );
+        assert_eq!(
+            ctr.process(&counter, &plaintext),
+            hex(
+                "874d6191b620e3261bef6864990db6ce9806f66b7970fdff8617187bb9fffdff\
+                 5ae4df3edbd5d35e5b4f09020db03eab1e031dda2fbe03d1792170a0f3009cee"
+            )
+        );
+    }
+
+    #[test]
+    fn test_implementations_agree() {
+        // Lengths around the 4- and 8-block batch boundaries, with partial
+        // trailing blocks
+        let key: Vec<u8> = (0..32).map(|i| (i * 37 + 11) as u8).collect();
+        let data: Vec<u8> = (0..16 * 21 + 7).map(|i| (i * 131 + 7) as u8).collect();
+        let h = AesCore::Soft(BitslicedAes::new(&key)).encrypt_block(&[0u8; 16]);
+        let soft = GhashKey::Soft(
+            u64::from_be_bytes(h[..8].try_into().unwrap()),
+            u64::from_be_bytes(h[8..].try_into().unwrap()),
+        );
+        let fast = GhashKey::new(&h);
+
+        for len in 0..data.len() {
+            let mut outputs = Vec::new();
+            for core in cores(&key) {
+                let mut buf = data[..len].to_vec();
+                let mut counter = [0xffu8; 16];
+                core.apply_keystream(&mut counter, &mut buf, increment32);
+                outputs.push(buf);
+            }
+            assert!(outputs.windows(2).all(|w| w[0] == w[1]), "ctr len {}", len);
+
+            let mut y_soft = [0x5au8; 16];
+            let mut y_fast = [0x5au8; 16];
+            soft.update(&mut y_soft, &data[..len]);
+            fast.update(&mut y_fast, &data[..len]);
+            assert_eq!(y_soft, y_fast, "ghash len {}", len);
+        }
+    }
+
+    #[test]
+    fn test_cbc_roundtrip() {
+        let cbc = AesCbc::new_256(&[7u8; 32]);
+        let iv = [9u8; 16];
+        for len in [0, 1, 15, 16, 17, 100, 16 * 9] {
+            let plaintext: Vec<u8> = (0..len).map(|i| i as u8).collect();
+            let ciphertext = cbc.encrypt(&iv, &plaintext);
+            assert_eq!(ciphertext.len(), (len / 16 + 1) * 16);
+            assert_eq!(cbc.decrypt(&iv, &ciphertext), Some(plaintext));
+        }
+    }
 }
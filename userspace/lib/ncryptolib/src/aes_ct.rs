@@ -0,0 +1,510 @@
+//! Constant-time bitsliced AES
+//!
+//! Portable AES used when the CPU has no AES instructions. Four blocks are
+//! processed at once, spread bit by bit across eight 64-bit words, and the
+//! S-box is evaluated as a Boolean circuit (Boyar-Peralta) instead of a
+//! table lookup. No memory access or branch depends on key or data, so the
+//! cipher does not leak through cache timing the way a table-based one does.
+//!
+//! The layout follows the well-known "ct64" construction: `interleave_in`
+//! and `ortho` transpose four blocks into bitsliced form, rounds operate on
+//! the transposed words, and the inverse transforms bring the blocks back.
+
+/// Blocks processed per bitsliced pass
+pub const PARALLEL_BLOCKS: usize = 4;
+
+const RCON: [u32; 10] = [0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36];
+
+/// Expanded bitsliced key schedule (AES-128 or AES-256)
+#[derive(Clone)]
+pub struct BitslicedAes {
+    rounds: usize,
+    /// Eight words per round key, `rounds + 1` round keys
+    sk: [u64; 120],
+}
+
+impl BitslicedAes {
+    /// Expand a 16- or 32-byte key
+    pub fn new(key: &[u8]) -> Self {
+        debug_assert!(key.len() == 16 || key.len() == 32);
+        let rounds = if key.len() == 16 { 10 } else { 14 };
+        let nk = key.len() / 4;
+        let nkf = (rounds + 1) * 4;
+
+        let mut words = [0u32; 60];
+        for (w, chunk) in words.iter_mut().zip(key.chunks_exact(4)) {
+            *w = u32::from_le_bytes([chunk[0], chunk[1], chunk[2], chunk[3]]);
+        }
+
+        let mut tmp = words[nk - 1];
+        let mut j = 0;
+        let mut k = 0;
+        for i in nk..nkf {
+            if j == 0 {
+                tmp = tmp.rotate_right(8);
+                tmp = sub_word(tmp) ^ RCON[k];
+            } else if nk > 6 && j == 4 {
+                tmp = sub_word(tmp);
+            }
+            tmp ^= words[i - nk];
+            words[i] = tmp;
+            j += 1;
+            if j == nk {
+                j = 0;
+                k += 1;
+            }
+        }
+
+        // Each round key occupies eight words: the same key bitsliced for
+        // every one of the four block slots
+        let mut sk = [0u64; 120];
+        for (round, w) in words[..nkf].chunks_exact(4).enumerate() {
+            let mut q = [0u64; 8];
+            let (q0, q4) = interleave_in(&[w[0], w[1], w[2], w[3]]);
+            q[0] = q0;
+            q[1] = q0;
+            q[2] = q0;
+            q[3] = q0;
+            q[4] = q4;
+            q[5] = q4;
+            q[6] = q4;
+            q[7] = q4;
+            ortho(&mut q);
+            let lo = (q[0] & 0x1111111111111111)
+                | (q[1] & 0x2222222222222222)
+                | (q[2] & 0x4444444444444444)
+                | (q[3] & 0x8888888888888888);
+            let hi = (q[4] & 0x1111111111111111)
+                | (q[5] & 0x2222222222222222)
+                | (q[6] & 0x4444444444444444)
+                | (q[7] & 0x8888888888888888);
+            for (half, comp) in [lo, hi].into_iter().enumerate() {
+                let x0 = comp & 0x1111111111111111;
+                let x1 = (comp & 0x2222222222222222) >> 1;
+                let x2 = (comp & 0x4444444444444444) >> 2;
+                let x3 = (comp & 0x8888888888888888) >> 3;
+                let base = round * 8 + half * 4;
+                sk[base] = (x0 << 4).wrapping_sub(x0);
+                sk[base + 1] = (x1 << 4).wrapping_sub(x1);
+                sk[base + 2] = (x2 << 4).wrapping_sub(x2);
+                sk[base + 3] = (x3 << 4).wrapping_sub(x3);
+            }
+        }
+
+        Self { rounds, sk }
+    }
+
+    /// Encrypt up to four blocks in place
+    pub fn encrypt(&self, blocks: &mut [[u8; 16]]) {
+        debug_assert!(blocks.len() <= PARALLEL_BLOCKS);
+        let mut q = load(blocks);
+        self.encrypt_sliced(&mut q);
+        store(&q, blocks);
+    }
+
+    /// Decrypt up to four blocks in place
+    pub fn decrypt(&self, blocks: &mut [[u8; 16]]) {
+        debug_assert!(blocks.len() <= PARALLEL_BLOCKS);
+        let mut q = load(blocks);
+        self.decrypt_sliced(&mut q);
+        store(&q, blocks);
+    }
+
+    #[inline]
+    fn round_key(&self, round: usize) -> &[u64] {
+        &self.sk[round * 8..round * 8 + 8]
+    }
+
+    fn encrypt_sliced(&self, q: &mut [u64; 8]) {
+        add_round_key(q, self.round_key(0));
+        for round in 1..self.rounds {
+            sbox(q);
+            shift_rows(q);
+            mix_columns(q);
+            add_round_key(q, self.round_key(round));
+        }
+        sbox(q);
+        shift_rows(q);
+        add_round_key(q, self.round_key(self.rounds));
+    }
+
+    fn decrypt_sliced(&self, q: &mut [u64; 8]) {
+        add_round_key(q, self.round_key(self.rounds));
+        for round in (1..self.rounds).rev() {
+            inv_shift_rows(q);
+            inv_sbox(q);
+            add_round_key(q, self.round_key(round));
+            inv_mix_columns(q);
+        }
+        inv_shift_rows(q);
+        inv_sbox(q);
+        add_round_key(q, self.round_key(0));
+    }
+}
+
+/// S-box of each byte of `x`, used by the key schedule
+fn sub_word(x: u32) -> u32 {
+    let mut q = [0u64; 8];
+    q[0] = x as u64;
+    ortho(&mut q);
+    sbox(&mut q);
+    ortho(&mut q);
+    q[0] as u32
+}
+
+/// Transpose up to four blocks into bitsliced form (missing blocks are zero)
+fn load(blocks: &[[u8; 16]]) -> [u64; 8] {
+    let mut q = [0u64; 8];
+    for (i, block) in blocks.iter().enumerate() {
+        let mut w = [0u32; 4];
+        for (word, chunk) in w.iter_mut().zip(block.chunks_exact(4)) {
+            *word = u32::from_le_bytes([chunk[0], chunk[1], chunk[2], chunk[3]]);
+        }
+        let (lo, hi) = interleave_in(&w);
+        q[i] = lo;
+        q[i + 4] = hi;
+    }
+    ortho(&mut q);
+    q
+}
+
+fn store(q: &[u64; 8], blocks: &mut [[u8; 16]]) {
+    let mut q = *q;
+    ortho(&mut q);
+    for (i, block) in blocks.iter_mut().enumerate() {
+        let w = interleave_out(q[i], q[i + 4]);
+        for (chunk, word) in block.chunks_exact_mut(4).zip(w) {
+            chunk.copy_from_slice(&word.to_le_bytes());
+        }
+    }
+}
+
+fn interleave_in(w: &[u32; 4]) -> (u64, u64) {
+    let mut x = [w[0] as u64, w[1] as u64, w[2] as u64, w[3] as u64];
+    for v in x.iter_mut() {
+        *v |= *v << 16;
+        *v &= 0x0000ffff0000ffff;
+        *v |= *v << 8;
+        *v &= 0x00ff00ff00ff00ff;
+    }
+    (x[0] | (x[2] << 8), x[1] | (x[3] << 8))
+}
+
+fn interleave_out(q0: u64, q1: u64) -> [u32; 4] {
+    let mut x = [
+        q0 & 0x00ff00ff00ff00ff,
+        q1 & 0x00ff00ff00ff00ff,
+        (q0 >> 8) & 0x00ff00ff00ff00ff,
+        (q1 >> 8) & 0x00ff00ff00ff00ff,
+    ];
+    let mut w = [0u32; 4];
+    for (v, out) in x.iter_mut().zip(w.iter_mut()) {
+        *v |= *v >> 8;
+        *v &= 0x0000ffff0000ffff;
+        *out = (*v as u32) | ((*v >> 16) as u32);
+    }
+    w
+}
+
+#[inline(always)]
+fn swap_n(cl: u64, ch: u64, s: u32, x: &mut u64, y: &mut u64) {
+    let a = *x;
+    let b = *y;
+    *x = (a & cl) | ((b & cl) << s);
+    *y = ((a & ch) >> s) | (b & ch);
+}
+
+/// Bit transpose between byte-interleaved and bitsliced layouts (an
+/// involution)
+fn ortho(q: &mut [u64; 8]) {
+    const C2: (u64, u64) = (0x5555555555555555, 0xaaaaaaaaaaaaaaaa);
+    const C4: (u64, u64) = (0x3333333333333333, 0xcccccccccccccccc);
+    const C8: (u64, u64) = (0x0f0f0f0f0f0f0f0f, 0xf0f0f0f0f0f0f0f0);
+
+    for (i, j) in [(0, 1), (2, 3), (4, 5), (6, 7)] {
+        let (a, b) = q.split_at_mut(j);
+        swap_n(C2.0, C2.1, 1, &mut a[i], &mut b[0]);
+    }
+    for (i, j) in [(0, 2), (1, 3), (4, 6), (5, 7)] {
+        let (a, b) = q.split_at_mut(j);
+        swap_n(C4.0, C4.1, 2, &mut a[i], &mut b[0]);
+    }
+    for (i, j) in [(0, 4), (1, 5), (2, 6), (3, 7)] {
+        let (a, b) = q.split_at_mut(j);
+        swap_n(C8.0, C8.1, 4, &mut a[i], &mut b[0]);
+    }
+}
+
+#[inline(always)]
+fn add_round_key(q: &mut [u64; 8], sk: &[u64]) {
+    for (w, k) in q.iter_mut().zip(sk) {
+        *w ^= *k;
+    }
+}
+
+/// AES S-box on all 32 bytes, as the Boyar-Peralta circuit
+/// (113 XOR/XNOR/AND gates, no lookups)
+#[rustfmt::skip]
+fn sbox(q: &mut [u64; 8]) {
+    let x0 = q[7];
+    let x1 = q[6];
+    let x2 = q[5];
+    let x3 = q[4];
+    let x4 = q[3];
+    let x5 = q[2];
+    let x6 = q[1];
+    let x7 = q[0];
+
+    // Top linear transformation
+    let y14 = x3 ^ x5;
+    let y13 = x0 ^ x6;
+    let y9 = x0 ^ x3;
+    let y8 = x0 ^ x5;
+    let t0 = x1 ^ x2;
+    let y1 = t0 ^ x7;
+    let y4 = y1 ^ x3;
+    let y12 = y13 ^ y14;
+    let y2 = y1 ^ x0;
+    let y5 = y1 ^ x6;
+    let y3 = y5 ^ y8;
+    let t1 = x4 ^ y12;
+    let y15 = t1 ^ x5;
+    let y20 = t1 ^ x1;
+    let y6 = y15 ^ x7;
+    let y10 = y15 ^ t0;
+    let y11 = y20 ^ y9;
+    let y7 = x7 ^ y11;
+    let y17 = y10 ^ y11;
+    let y19 = y10 ^ y8;
+    let y16 = t0 ^ y11;
+    let y21 = y13 ^ y16;
+    let y18 = x0 ^ y16;
+
+    // Non-linear section
+    let t2 = y12 & y15;
+    let t3 = y3 & y6;
+    let t4 = t3 ^ t2;
+    let t5 = y4 & x7;
+    let t6 = t5 ^ t2;
+    let t7 = y13 & y16;
+    let t8 = y5 & y1;
+    let t9 = t8 ^ t7;
+    let t10 = y2 & y7;
+    let t11 = t10 ^ t7;
+    let t12 = y9 & y11;
+    let t13 = y14 & y17;
+    let t14 = t13 ^ t12;
+    let t15 = y8 & y10;
+    let t16 = t15 ^ t12;
+    let t17 = t4 ^ t14;
+    let t18 = t6 ^ t16;
+    let t19 = t9 ^ t14;
+    let t20 = t11 ^ t16;
+    let t21 = t17 ^ y20;
+    let t22 = t18 ^ y19;
+    let t23 = t19 ^ y21;
+    let t24 = t20 ^ y18;
+
+    let t25 = t21 ^ t22;
+    let t26 = t21 & t23;
+    let t27 = t24 ^ t26;
+    let t28 = t25 & t27;
+    let t29 = t28 ^ t22;
+    let t30 = t23 ^ t24;
+    let t31 = t22 ^ t26;
+    let t32 = t31 & t30;
+    let t33 = t32 ^ t24;
+    let t34 = t23 ^ t33;
+    let t35 = t27 ^ t33;
+    let t36 = t24 & t35;
+    let t37 = t36 ^ t34;
+    let t38 = t27 ^ t36;
+    let t39 = t29 & t38;
+    let t40 = t25 ^ t39;
+
+    let t41 = t40 ^ t37;
+    let t42 = t29 ^ t33;
+    let t43 = t29 ^ t40;
+    let t44 = t33 ^ t37;
+    let t45 = t42 ^ t41;
+    let z0 = t44 & y15;
+    let z1 = t37 & y6;
+    let z2 = t33 & x7;
+    let z3 = t43 & y16;
+    let z4 = t40 & y1;
+    let z5 = t29 & y7;
+    let z6 = t42 & y11;
+    let z7 = t45 & y17;
+    let z8 = t41 & y10;
+    let z9 = t44 & y12;
+    let z10 = t37 & y3;
+    let z11 = t33 & y4;
+    let z12 = t43 & y13;
+    let z13 = t40 & y5;
+    let z14 = t29 & y2;
+    let z15 = t42 & y9;
+    let z16 = t45 & y14;
+    let z17 = t41 & y8;
+
+    // Bottom linear transformation
+    let t46 = z15 ^ z16;
+    let t47 = z10 ^ z11;
+    let t48 = z5 ^ z13;
+    let t49 = z9 ^ z10;
+    let t50 = z2 ^ z12;
+    let t51 = z2 ^ z5;
+    let t52 = z7 ^ z8;
+    let t53 = z0 ^ z3;
+    let t54 = z6 ^ z7;
+    let t55 = z16 ^ z17;
+    let t56 = z12 ^ t48;
+    let t57 = t50 ^ t53;
+    let t58 = z4 ^ t46;
+    let t59 = z3 ^ t54;
+    let t60 = t46 ^ t57;
+    let t61 = z14 ^ t57;
+    let t62 = t52 ^ t58;
+    let t63 = t49 ^ t58;
+    let t64 = z4 ^ t59;
+    let t65 = t61 ^ t62;
+    let t66 = z1 ^ t63;
+    let s0 = t59 ^ t63;
+    let s6 = t56 ^ !t62;
+    let s7 = t48 ^ !t60;
+    let t67 = t64 ^ t65;
+    let s3 = t53 ^ t66;
+    let s4 = t51 ^ t66;
+    let s5 = t47 ^ t65;
+    let s1 = t64 ^ !s3;
+    let s2 = t55 ^ !t67;
+
+    q[7] = s0;
+    q[6] = s1;
+    q[5] = s2;
+    q[4] = s3;
+    q[3] = s4;
+    q[2] = s5;
+    q[1] = s6;
+    q[0] = s7;
+}
+
+/// Inverse of the affine transform around the S-box inversion; applying it
+/// on both sides of [`sbox`] yields the inverse S-box
+#[inline(always)]
+fn inv_affine(q: &mut [u64; 8]) {
+    let q0 = !q[0];
+    let q1 = !q[1];
+    let q2 = q[2];
+    let q3 = q[3];
+    let q4 = q[4];
+    let q5 = !q[5];
+    let q6 = !q[6];
+    let q7 = q[7];
+    q[7] = q1 ^ q4 ^ q6;
+    q[6] = q0 ^ q3 ^ q5;
+    q[5] = q7 ^ q2 ^ q4;
+    q[4] = q6 ^ q1 ^ q3;
+    q[3] = q5 ^ q0 ^ q2;
+    q[2] = q4 ^ q7 ^ q1;
+    q[1] = q3 ^ q6 ^ q0;
+    q[0] = q2 ^ q5 ^ q7;
+}
+
+fn inv_sbox(q: &mut [u64; 8]) {
+    inv_affine(q);
+    sbox(q);
+    inv_affine(q);
+}
+
+fn shift_rows(q: &mut [u64; 8]) {
+    for w in q.iter_mut() {
+        let x = *w;
+        *w = (x & 0x000000000000ffff)
+            | ((x & 0x00000000fff00000) >> 4)
+            | ((x & 0x00000000000f0000) << 12)
+            | ((x & 0x0000ff0000000000) >> 8)
+            | ((x & 0x000000ff00000000) << 8)
+            | ((x & 0xf000000000000000) >> 12)
+            | ((x & 0x0fff000000000000) << 4);
+    }
+}
+
+fn inv_shift_rows(q: &mut [u64; 8]) {
+    for w in q.iter_mut() {
+        let x = *w;
+        *w = (x & 0x000000000000ffff)
+            | ((x & 0x000000000fff0000) << 4)
+            | ((x & 0x00000000f0000000) >> 12)
+            | ((x & 0x000000ff00000000) << 8)
+            | ((x & 0x0000ff0000000000) >> 8)
+            | ((x & 0x000f000000000000) << 12)
+            | ((x & 0xfff0000000000000) >> 4);
+    }
+}
+
+#[inline(always)]
+fn rotr32(x: u64) -> u64 {
+    x.rotate_left(32)
+}
+
+fn mix_columns(q: &mut [u64; 8]) {
+    let [q0, q1, q2, q3, q4, q5, q6, q7] = *q;
+    let r0 = q0.rotate_right(16);
+    let r1 = q1.rotate_right(16);
+    let r2 = q2.rotate_right(16);
+    let r3 = q3.rotate_right(16);
+    let r4 = q4.rotate_right(16);
+    let r5 = q5.rotate_right(16);
+    let r6 = q6.rotate_right(16);
+    let r7 = q7.rotate_right(16);
+
+    q[0] = q7 ^ r7 ^ r0 ^ rotr32(q0 ^ r0);
+    q[1] = q0 ^ r0 ^ q7 ^ r7 ^ r1 ^ rotr32(q1 ^ r1);
+    q[2] = q1 ^ r1 ^ r2 ^ rotr32(q2 ^ r2);
+    q[3] = q2 ^ r2 ^ q7 ^ r7 ^ r3 ^ rotr32(q3 ^ r3);
+    q[4] = q3 ^ r3 ^ q7 ^ r7 ^ r4 ^ rotr32(q4 ^ r4);
+    q[5] = q4 ^ r4 ^ r5 ^ rotr32(q5 ^ r5);
+    q[6] = q5 ^ r5 ^ r6 ^ rotr32(q6 ^ r6);
+    q[7] = q6 ^ r6 ^ r7 ^ rotr32(q7 ^ r7);
+}
+
+fn inv_mix_columns(q: &mut [u64; 8]) {
+    let [q0, q1, q2, q3, q4, q5, q6, q7] = *q;
+    let r0 = q0.rotate_right(16);
+    let r1 = q1.rotate_right(16);
+    let r2 = q2.rotate_right(16);
+    let r3 = q3.rotate_right(16);
+    let r4 = q4.rotate_right(16);
+    let r5 = q5.rotate_right(16);
+    let r6 = q6.rotate_right(16);
+    let r7 = q7.rotate_right(16);
+
+    q[0] = q5 ^ q6 ^ q7 ^ r0 ^ r5 ^ r7 ^ rotr32(q0 ^ q5 ^ q6 ^ r0 ^ r5);
+    q[1] = q0 ^ q5 ^ r0 ^ r1 ^ r5 ^ r6 ^ r7 ^ rotr32(q1 ^ q5 ^ q7 ^ r1 ^ r5 ^ r6);
+    q[2] = q0 ^ q1 ^ q6 ^ r1 ^ r2 ^ r6 ^ r7 ^ rotr32(q0 ^ q2 ^ q6 ^ r2 ^ r6 ^ r7);
+    q[3] = q0
+        ^ q1
+        ^ q2
+        ^ q5
+        ^ q6
+        ^ r0
+        ^ r2
+        ^ r3
+        ^ r5
+        ^ rotr32(q0 ^ q1 ^ q3 ^ q5 ^ q6 ^ q7 ^ r0 ^ r3 ^ r5 ^ r7);
+    q[4] = q1
+        ^ q2
+        ^ q3
+        ^ q5
+        ^ r1
+        ^ r3
+        ^ r4
+        ^ r5
+        ^ r6
+        ^ r7
+        ^ rotr32(q1 ^ q2 ^ q4 ^ q5 ^ q7 ^ r1 ^ r4 ^ r5 ^ r6);
+    q[5] =
+        q2 ^ q3 ^ q4 ^ q6 ^ r2 ^ r4 ^ r5 ^ r6 ^ r7 ^ rotr32(q2 ^ q3 ^ q5 ^ q6 ^ r2 ^ r5 ^ r6 ^ r7);
+    q[6] = q3 ^ q4 ^ q5 ^ q7 ^ r3 ^ r5 ^ r6 ^ r7 ^ rotr32(q3 ^ q4 ^ q6 ^ q7 ^ r3 ^ r6 ^ r7);
+    q[7] = q4 ^ q5 ^ q6 ^ r4 ^ r6 ^ r7 ^ rotr32(q4 ^ q5 ^ q7 ^ r4 ^ r7);
+}
@@ -0,0 +1,293 @@
+//! AES-NI and PCLMULQDQ kernels (x86_64)
+//!
+//! - Key expansion with `AESKEYGENASSIST`, so no table lookup touches the
+//!   key.
+//! - Block encryption and decryption interleave eight independent blocks.
+//!   `AESENC` has a latency of several cycles but can start every cycle, so
+//!   eight blocks in flight keep the unit busy for CTR, GCM and CBC
+//!   decryption.
+//! - GHASH multiplies with `PCLMULQDQ`. Eight blocks are multiplied by
+//!   H^8..H^1 and summed before a single reduction (aggregated reduction),
+//!   which takes the reduction off the per-block critical path.
+//!
+//! Everything here is `unsafe` and must only be called after
+//! [`cpu::has_aes_ni`](crate::cpu::has_aes_ni) returned true.
+
+use core::arch::x86_64::*;
+
+/// Blocks processed per interleaved pass
+pub const PARALLEL_BLOCKS: usize = 8;
+
+/// Expanded AES key schedule (AES-128 or AES-256)
+#[derive(Clone, Copy)]
+pub struct AesNi {
+    rounds: usize,
+    enc: [__m128i; 15],
+    /// Equivalent inverse cipher keys, in decryption order
+    dec: [__m128i; 15],
+}
+
+macro_rules! expand128 {
+    ($k:expr, $rcon:literal) => {{
+        let k = $k;
+        let assist = _mm_shuffle_epi32(_mm_aeskeygenassist_si128(k, $rcon), 0xff);
+        let mut t = _mm_xor_si128(k, _mm_slli_si128(k, 4));
+        t = _mm_xor_si128(t, _mm_slli_si128(t, 4));
+        t = _mm_xor_si128(t, _mm_slli_si128(t, 4));
+        _mm_xor_si128(t, assist)
+    }};
+}
+
+macro_rules! expand256 {
+    // Even round key: RotWord + SubWord + Rcon of the previous odd key
+    ($even:expr, $odd:expr, $rcon:literal) => {{
+        let k = $even;
+        let assist = _mm_shuffle_epi32(_mm_aeskeygenassist_si128($odd, $rcon), 0xff);
+        let mut t = _mm_xor_si128(k, _mm_slli_si128(k, 4));
+        t = _mm_xor_si128(t, _mm_slli_si128(t, 4));
+        t = _mm_xor_si128(t, _mm_slli_si128(t, 4));
+        _mm_xor_si128(t, assist)
+    }};
+    // Odd round key: SubWord only of the new even key
+    ($odd:expr, $even:expr) => {{
+        let k = $odd;
+        let assist = _mm_shuffle_epi32(_mm_aeskeygenassist_si128($even, 0), 0xaa);
+        let mut t = _mm_xor_si128(k, _mm_slli_si128(k, 4));
+        t = _mm_xor_si128(t, _mm_slli_si128(t, 4));
+        t = _mm_xor_si128(t, _mm_slli_si128(t, 4));
+        _mm_xor_si128(t, assist)
+    }};
+}
+
+#[inline(always)]
+unsafe fn load(block: &[u8; 16]) -> __m128i {
+    _mm_loadu_si128(block.as_ptr() as *const __m128i)
+}
+
+#[inline(always)]
+unsafe fn store(block: &mut [u8; 16], v: __m128i) {
+    _mm_storeu_si128(block.as_mut_ptr() as *mut __m128i, v)
+}
+
+impl AesNi {
+    /// Expand a 16- or 32-byte key
+    #[target_feature(enable = "aes")]
+    pub unsafe fn new(key: &[u8]) -> Self {
+        let mut enc = [_mm_setzero_si128(); 15];
+        let rounds = if key.len() == 16 {
+            enc[0] = _mm_loadu_si128(key.as_ptr() as *const __m128i);
+            enc[1] = expand128!(enc[0], 0x01);
+            enc[2] = expand128!(enc[1], 0x02);
+            enc[3] = expand128!(enc[2], 0x04);
+            enc[4] = expand128!(enc[3], 0x08);
+            enc[5] = expand128!(enc[4], 0x10);
+            enc[6] = expand128!(enc[5], 0x20);
+            enc[7] = expand128!(enc[6], 0x40);
+            enc[8] = expand128!(enc[7], 0x80);
+            enc[9] = expand128!(enc[8], 0x1b);
+            enc[10] = expand128!(enc[9], 0x36);
+            10
+        } else {
+            enc[0] = _mm_loadu_si128(key.as_ptr() as *const __m128i);
+            enc[1] = _mm_loadu_si128(key.as_ptr().add(16) as *const __m128i);
+            enc[2] = expand256!(enc[0], enc[1], 0x01);
+            enc[3] = expand256!(enc[1], enc[2]);
+            enc[4] = expand256!(enc[2], enc[3], 0x02);
+            enc[5] = expand256!(enc[3], enc[4]);
+            enc[6] = expand256!(enc[4], enc[5], 0x04);
+            enc[7] = expand256!(enc[5], enc[6]);
+            enc[8] = expand256!(enc[6], enc[7], 0x08);
+            enc[9] = expand256!(enc[7], enc[8]);
+            enc[10] = expand256!(enc[8], enc[9], 0x10);
+            enc[11] = expand256!(enc[9], enc[10]);
+            enc[12] = expand256!(enc[10], enc[11], 0x20);
+            enc[13] = expand256!(enc[11], enc[12]);
+            enc[14] = expand256!(enc[12], enc[13], 0x40);
+            14
+        };
+
+        let mut dec = [_mm_setzero_si128(); 15];
+        dec[0] = enc[rounds];
+        for i in 1..rounds {
+            dec[i] = _mm_aesimc_si128(enc[rounds - i]);
+        }
+        dec[rounds] = enc[0];
+
+        Self { rounds, enc, dec }
+    }
+
+    /// Encrypt blocks in place, eight at a time
+    #[target_feature(enable = "aes")]
+    pub unsafe fn encrypt(&self, blocks: &mut [[u8; 16]]) {
+        let keys = &self.enc[..=self.rounds];
+        let mut chunks = blocks.chunks_exact_mut(PARALLEL_BLOCKS);
+        for chunk in &mut chunks {
+            let mut s = [_mm_setzero_si128(); PARALLEL_BLOCKS];
+            for (v, block) in s.iter_mut().zip(chunk.iter()) {
+                *v = _mm_xor_si128(load(block), keys[0]);
+            }
+            for &k in &keys[1..self.rounds] {
+                for v in s.iter_mut() {
+                    *v = _mm_aesenc_si128(*v, k);
+                }
+            }
+            for (v, block) in s.iter().zip(chunk.iter_mut()) {
+                store(block, _mm_aesenclast_si128(*v, keys[self.rounds]));
+            }
+        }
+        for block in chunks.into_remainder() {
+            let mut v = _mm_xor_si128(load(block), keys[0]);
+            for &k in &keys[1..self.rounds] {
+                v = _mm_aesenc_si128(v, k);
+            }
+            store(block, _mm_aesenclast_si128(v, keys[self.rounds]));
+        }
+    }
+
+    /// Decrypt blocks in place, eight at a time
+    #[target_feature(enable = "aes")]
+    pub unsafe fn decrypt(&self, blocks: &mut [[u8; 16]]) {
+        let keys = &self.dec[..=self.rounds];
+        let mut chunks = blocks.chunks_exact_mut(PARALLEL_BLOCKS);
+        for chunk in &mut chunks {
+            let mut s = [_mm_setzero_si128(); PARALLEL_BLOCKS];
+            for (v, block) in s.iter_mut().zip(chunk.iter()) {
+                *v = _mm_xor_si128(load(block), keys[0]);
+            }
+            for &k in &keys[1..self.rounds] {
+                for v in s.iter_mut() {
+                    *v = _mm_aesdec_si128(*v, k);
+                }
+            }
+            for (v, block) in s.iter().zip(chunk.iter_mut()) {
+                store(block, _mm_aesdeclast_si128(*v, keys[self.rounds]));
+            }
+        }
+        for block in chunks.into_remainder() {
+            let mut v = _mm_xor_si128(load(block), keys[0]);
+            for &k in &keys[1..self.rounds] {
+                v = _mm_aesdec_si128(v, k);
+            }
+            store(block, _mm_aesdeclast_si128(v, keys[self.rounds]));
+        }
+    }
+}
+
+// ============================================================================
+// GHASH
+// ============================================================================
+
+/// GHASH key: H^1..H^8, byte-reversed as PCLMULQDQ wants them
+#[derive(Clone, Copy)]
+pub struct ClmulGhash {
+    powers: [__m128i; PARALLEL_BLOCKS],
+}
+
+#[inline(always)]
+unsafe fn bswap(v: __m128i) -> __m128i {
+    _mm_shuffle_epi8(
+        v,
+        _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+    )
+}
+
+/// Unreduced 256-bit carry-less product, accumulated into `lo`/`mid`/`hi`
+#[inline(always)]
+unsafe fn clmul_acc(a: __m128i, b: __m128i, lo: &mut __m128i, mid: &mut __m128i, hi: &mut __m128i) {
+    *lo = _mm_xor_si128(*lo, _mm_clmulepi64_si128(a, b, 0x00));
+    *mid = _mm_xor_si128(*mid, _mm_clmulepi64_si128(a, b, 0x10));
+    *mid = _mm_xor_si128(*mid, _mm_clmulepi64_si128(a, b, 0x01));
+    *hi = _mm_xor_si128(*hi, _mm_clmulepi64_si128(a, b, 0x11));
+}
+
+/// Reduce a 256-bit product of bit-reflected operands modulo the GCM
+/// polynomial (shift left by one, then fold the low half twice)
+#[inline(always)]
+unsafe fn reduce(lo: __m128i, mid: __m128i, hi: __m128i) -> __m128i {
+    let mut lo = _mm_xor_si128(lo, _mm_slli_si128(mid, 8));
+    let mut hi = _mm_xor_si128(hi, _mm_srli_si128(mid, 8));
+
+    // The reflected product is one bit short: shift the 256 bits left by 1
+    let lo_carry = _mm_srli_epi32(lo, 31);
+    let hi_carry = _mm_srli_epi32(hi, 31);
+    lo = _mm_slli_epi32(lo, 1);
+    hi = _mm_slli_epi32(hi, 1);
+    let cross = _mm_srli_si128(lo_carry, 12);
+    hi = _mm_or_si128(hi, _mm_slli_si128(hi_carry, 4));
+    hi = _mm_or_si128(hi, cross);
+    lo = _mm_or_si128(lo, _mm_slli_si128(lo_carry, 4));
+
+    // First phase
+    let a = _mm_slli_epi32(lo, 31);
+    let b = _mm_slli_epi32(lo, 30);
+    let c = _mm_slli_epi32(lo, 25);
+    let t = _mm_xor_si128(_mm_xor_si128(a, b), c);
+    let carry = _mm_srli_si128(t, 4);
+    lo = _mm_xor_si128(lo, _mm_slli_si128(t, 12));
+
+    // Second phase
+    let mut r = _mm_srli_epi32(lo, 1);
+    r = _mm_xor_si128(r, _mm_srli_epi32(lo, 2));
+    r = _mm_xor_si128(r, _mm_srli_epi32(lo, 7));
+    r = _mm_xor_si128(r, carry);
+    lo = _mm_xor_si128(lo, r);
+    _mm_xor_si128(hi, lo)
+}
+
+#[inline(always)]
+unsafe fn gfmul(a: __m128i, b: __m128i) -> __m128i {
+    let zero = _mm_setzero_si128();
+    let (mut lo, mut mid, mut hi) = (zero, zero, zero);
+    clmul_acc(a, b, &mut lo, &mut mid, &mut hi);
+    reduce(lo, mid, hi)
+}
+
+impl ClmulGhash {
+    /// Precompute H^1..H^8 from the hash subkey H = E_K(0^128)
+    #[target_feature(enable = "pclmulqdq,ssse3")]
+    pub unsafe fn new(h: &[u8; 16]) -> Self {
+        let h = bswap(load(h));
+        let mut powers = [h; PARALLEL_BLOCKS];
+        for i in 1..PARALLEL_BLOCKS {
+            powers[i] = gfmul(powers[i - 1], h);
+        }
+        Self { powers }
+    }
+
+    /// Absorb `data` into the running hash `y`; a trailing partial block is
+    /// zero-padded
+    #[target_feature(enable = "pclmulqdq,ssse3")]
+    pub unsafe fn update(&self, y: &mut [u8; 16], data: &[u8]) {
+        let mut acc = bswap(load(y));
+        let zero = _mm_setzero_si128();
+
+        let mut chunks = data.chunks_exact(16 * PARALLEL_BLOCKS);
+        for chunk in &mut chunks {
+            let (mut lo, mut mid, mut hi) = (zero, zero, zero);
+            for i in 0..PARALLEL_BLOCKS {
+                let mut x = bswap(_mm_loadu_si128(chunk.as_ptr().add(16 * i) as *const __m128i));
+                if i == 0 {
+                    x = _mm_xor_si128(x, acc);
+                }
+                let power = self.powers[PARALLEL_BLOCKS - 1 - i];
+                clmul_acc(x, power, &mut lo, &mut mid, &mut hi);
+            }
+            acc = reduce(lo, mid, hi);
+        }
+
+        let rest = chunks.remainder();
+        let mut blocks = rest.chunks_exact(16);
+        for block in &mut blocks {
+            let x = bswap(_mm_loadu_si128(block.as_ptr() as *const __m128i));
+            acc = gfmul(_mm_xor_si128(acc, x), self.powers[0]);
+        }
+        let tail = blocks.remainder();
+        if !tail.is_empty() {
+            let mut block = [0u8; 16];
+            block[..tail.len()].copy_from_slice(tail);
+            acc = gfmul(_mm_xor_si128(acc, bswap(load(&block))), self.powers[0]);
+        }
+
+        store(y, bswap(acc));
+    }
+}
@@ -3,9 +3,16 @@
 //! RFC 8439 compliant ChaCha20 and ChaCha20-Poly1305 AEAD implementation.
 //! ChaCha20 is a modern stream cipher designed by Daniel J. Bernstein.
 //! ChaCha20-Poly1305 is an AEAD construction combining ChaCha20 with Poly1305 MAC.
+//!
+//! The keystream is generated up to eight blocks at a time with SIMD
+//! kernels on x86_64 ([`chacha20_simd`](crate::chacha20_simd)); Poly1305
+//! uses 64-bit limbs and absorbs four blocks per reduction.
 
 use std::vec::Vec;
 
+#[cfg(target_arch = "x86_64")]
+use crate::chacha20_simd;
+
 // ============================================================================
 // Constants
 // ============================================================================
@@ -22,6 +29,14 @@ pub const POLY1305_TAG_SIZE: usize = 16;
 // ChaCha20 constants "expand 32-byte k"
 const SIGMA: [u32; 4] = [0x61707865, 0x3320646e, 0x79622d32, 0x6b206574];
 
+/// Keystream generated per batch: eight blocks, one AVX2 pass
+const KEYSTREAM_BATCH: usize = 8 * CHACHA20_BLOCK_SIZE;
+
+/// Below this many blocks the scalar block function is faster than a
+/// vector pass that computes lanes nobody uses
+#[cfg(target_arch = "x86_64")]
+const SIMD_MIN_BLOCKS: usize = 3;
+
 // ============================================================================
 // ChaCha20 Quarter Round
 // ============================================================================
@@ -49,14 +64,12 @@ fn quarter_round(state: &mut [u32; 16], a: usize, b: usize, c: usize, d: usize)
 // ChaCha20 Block Function
 // ============================================================================
 
-fn chacha20_block(key: &[u8; 32], counter: u32, nonce: &[u8; 12]) -> [u8; 64] {
+/// Initial state for `key` and `nonce`, block counter zero
+fn init_state(key: &[u8; 32], nonce: &[u8; 12]) -> [u32; 16] {
     let mut state = [0u32; 16];
 
     // Set constants
-    state[0] = SIGMA[0];
-    state[1] = SIGMA[1];
-    state[2] = SIGMA[2];
-    state[3] = SIGMA[3];
+    state[..4].copy_from_slice(&SIGMA);
 
     // Set key
     for i in 0..8 {
@@ -64,14 +77,17 @@ fn chacha20_block(key: &[u8; 32], counter: u32, nonce: &[u8; 12]) -> [u8; 64] {
             u32::from_le_bytes([key[i * 4], key[i * 4 + 1], key[i * 4 + 2], key[i * 4 + 3]]);
     }
 
-    // Set counter
-    state[12] = counter;
-
     // Set nonce
     state[13] = u32::from_le_bytes([nonce[0], nonce[1], nonce[2], nonce[3]]);
     state[14] = u32::from_le_bytes([nonce[4], nonce[5], nonce[6], nonce[7]]);
     state[15] = u32::from_le_bytes([nonce[8], nonce[9], nonce[10], nonce[11]]);
 
+    state
+}
+
+fn chacha20_block(input: &[u32; 16], counter: u32) -> [u8; 64] {
+    let mut state = *input;
+    state[12] = counter;
     let initial_state = state;
 
     // 20 rounds (10 double rounds)
@@ -103,27 +119,76 @@ fn chacha20_block(key: &[u8; 32], counter: u32, nonce: &[u8; 12]) -> [u8; 64] {
     output
 }
 
+/// Fill `out` (at most [`KEYSTREAM_BATCH`] bytes, whole blocks) with the
+/// keystream starting at block `counter`, using the widest kernel that
+/// pays off for the length
+fn keystream(input: &[u32; 16], counter: u32, out: &mut [u8; KEYSTREAM_BATCH], len: usize) {
+    let blocks = len.div_ceil(CHACHA20_BLOCK_SIZE);
+
+    #[cfg(target_arch = "x86_64")]
+    {
+        let mut state = *input;
+        state[12] = counter;
+
+        // One AVX2 pass costs about the same as one SSE2 pass
+        #[cfg(feature = "hw-accel")]
+        if blocks >= SIMD_MIN_BLOCKS && crate::cpu::has_avx2() {
+            // SAFETY: AVX2 was detected
+            unsafe { chacha20_simd::avx2::blocks(&state, out) };
+            return;
+        }
+        if blocks >= SIMD_MIN_BLOCKS {
+            let calls = blocks.div_ceil(chacha20_simd::sse2::BLOCKS);
+            for part in out
+                .chunks_exact_mut(64 * chacha20_simd::sse2::BLOCKS)
+                .take(calls)
+            {
+                // SAFETY: SSE2 is part of the x86_64 baseline
+                unsafe { chacha20_simd::sse2::blocks(&state, part.try_into().unwrap()) };
+                state[12] = state[12].wrapping_add(chacha20_simd::sse2::BLOCKS as u32);
+            }
+            return;
+        }
+    }
+
+    for (i, block) in out
+        .chunks_exact_mut(CHACHA20_BLOCK_SIZE)
+        .take(blocks)
+        .enumerate()
+    {
+        block.copy_from_slice(&chacha20_block(input, counter.wrapping_add(i as u32)));
+    }
+}
+
+/// `data ^= ks`, eight bytes at a time
+fn xor_in_place(data: &mut [u8], ks: &[u8]) {
+    let done = data.len() & !7;
+    let mut words = data.chunks_exact_mut(8);
+    for (dst, src) in (&mut words).zip(ks.chunks_exact(8)) {
+        let x = u64::from_ne_bytes((&*dst).try_into().unwrap())
+            ^ u64::from_ne_bytes(src.try_into().unwrap());
+        dst.copy_from_slice(&x.to_ne_bytes());
+    }
+    for (d, k) in words.into_remainder().iter_mut().zip(&ks[done..]) {
+        *d ^= k;
+    }
+}
+
 // ============================================================================
 // ChaCha20 Cipher
 // ============================================================================
 
 /// ChaCha20 stream cipher
 pub struct ChaCha20 {
-    key: [u8; 32],
-    nonce: [u8; 12],
+    state: [u32; 16],
     counter: u32,
 }
 
 impl ChaCha20 {
     /// Create a new ChaCha20 cipher
     pub fn new(key: &[u8; CHACHA20_KEY_SIZE], nonce: &[u8; CHACHA20_NONCE_SIZE]) -> Self {
-        let mut k = [0u8; 32];
-        let mut n = [0u8; 12];
-        k.copy_from_slice(key);
-        n.copy_from_slice(nonce);
         Self {
-            key: k,
-            nonce: n,
+            state: init_state(key, nonce),
             counter: 0,
         }
     }
@@ -134,19 +199,16 @@ impl ChaCha20 {
     }
 
     /// Encrypt or decrypt data in place (XOR operation)
+    ///
+    /// Every call starts on a fresh block: the unused end of a partial
+    /// final block is discarded.
     pub fn apply_keystream(&mut self, data: &mut [u8]) {
-        let mut offset = 0;
-        while offset < data.len() {
-            let block = chacha20_block(&self.key, self.counter, &self.nonce);
-            let remaining = data.len() - offset;
-            let to_xor = remaining.min(64);
-
-            for i in 0..to_xor {
-                data[offset + i] ^= block[i];
-            }
-
-            self.counter = self.counter.wrapping_add(1);
-            offset += to_xor;
+        let mut ks = [0u8; KEYSTREAM_BATCH];
+        for chunk in data.chunks_mut(KEYSTREAM_BATCH) {
+            keystream(&self.state, self.counter, &mut ks, chunk.len());
+            xor_in_place(chunk, &ks);
+            let blocks = chunk.len().div_ceil(CHACHA20_BLOCK_SIZE);
+            self.counter = self.counter.wrapping_add(blocks as u32);
         }
     }
 
@@ -168,139 +230,249 @@ impl ChaCha20 {
 // ============================================================================
 // Poly1305 MAC
 // ============================================================================
+//
+// The accumulator and r are three limbs of 44, 44 and 42 bits, so each
+// limb product fits a u128 with plenty of headroom. Long inputs are
+// absorbed four blocks at a time as
+//
+//     h = (h + m1)·r^4 + m2·r^3 + m3·r^2 + m4·r
+//
+// The four products are summed before a single carry chain, so the
+// multiplications are independent and the carries leave the critical path.
+
+const MASK44: u64 = (1 << 44) - 1;
+const MASK42: u64 = (1 << 42) - 1;
+/// 2^128 in the top limb: the pad bit of every full block
+const HIBIT: u64 = 1 << 40;
+
+/// A multiplier in limb form, with its top limbs pre-multiplied by 20
+/// (2^132 = 4 * 2^130 ≡ 4 * 5 mod p) for the wrap-around terms
+#[derive(Clone, Copy)]
+struct PolyKey {
+    r: [u64; 3],
+    s: [u64; 2],
+}
+
+impl PolyKey {
+    fn new(r: [u64; 3]) -> Self {
+        Self {
+            r,
+            s: [r[1] * 20, r[2] * 20],
+        }
+    }
+}
+
+/// Unreduced `h * key`, added into `d`
+#[inline(always)]
+fn poly_mul_acc(h: &[u64; 3], key: &PolyKey, d: &mut [u128; 3]) {
+    let m = |a: u64, b: u64| a as u128 * b as u128;
+    let [r0, r1, r2] = key.r;
+    let [s1, s2] = key.s;
+    d[0] += m(h[0], r0) + m(h[1], s2) + m(h[2], s1);
+    d[1] += m(h[0], r1) + m(h[1], r0) + m(h[2], s2);
+    d[2] += m(h[0], r2) + m(h[1], r1) + m(h[2], r0);
+}
+
+/// Carry a product back into limb form (partially reduced)
+#[inline(always)]
+fn poly_carry(d: [u128; 3]) -> [u64; 3] {
+    let [mut d0, mut d1, mut d2] = d;
+    d1 += d0 >> 44;
+    let h0 = d0 as u64 & MASK44;
+    d2 += d1 >> 44;
+    let h1 = d1 as u64 & MASK44;
+    let c = (d2 >> 42) as u64;
+    let h2 = d2 as u64 & MASK42;
+    d0 = h0 as u128 + c as u128 * 5;
+    let h0 = d0 as u64 & MASK44;
+    let h1 = h1 + (d0 >> 44) as u64;
+    [h0, h1, h2]
+}
+
+fn poly_mul(a: &[u64; 3], key: &PolyKey) -> [u64; 3] {
+    let mut d = [0u128; 3];
+    poly_mul_acc(a, key, &mut d);
+    poly_carry(d)
+}
+
+/// A 16-byte block in limb form, plus `hibit` in the top limb
+#[inline(always)]
+fn poly_limbs(block: &[u8], hibit: u64) -> [u64; 3] {
+    let t0 = u64::from_le_bytes(block[..8].try_into().unwrap());
+    let t1 = u64::from_le_bytes(block[8..16].try_into().unwrap());
+    [
+        t0 & MASK44,
+        ((t0 >> 44) | (t1 << 20)) & MASK44,
+        ((t1 >> 24) & MASK42) | hibit,
+    ]
+}
 
 /// Poly1305 message authentication code
 pub struct Poly1305 {
-    r: [u64; 3],
+    /// r^1 .. r^4; the higher powers are computed on the first 64-byte
+    /// step, so short messages do not pay for them
+    powers: [PolyKey; 4],
+    have_powers: bool,
     s: [u64; 2],
     h: [u64; 3],
+    /// Bytes of an incomplete block carried between updates
+    buffer: [u8; 16],
+    buffered: usize,
 }
 
 impl Poly1305 {
     /// Create a new Poly1305 MAC with the given 32-byte key
     pub fn new(key: &[u8; 32]) -> Self {
         // r = key[0..16] with clamping
-        let mut r = [0u64; 3];
-        r[0] = u64::from_le_bytes([
-            key[0],
-            key[1],
-            key[2],
-            key[3] & 0x0f,
-            key[4] & 0xfc,
-            key[5],
-            key[6],
-            key[7] & 0x0f,
-        ]) & 0x0ffffffc0fffffff;
-        r[1] = u64::from_le_bytes([
-            key[8] & 0xfc,
-            key[9],
-            key[10],
-            key[11] & 0x0f,
-            key[12] & 0xfc,
-            key[13],
-            key[14],
-            key[15] & 0x0f,
-        ]) & 0x0ffffffc0ffffffc;
-
-        // s = key[16..32]
-        let mut s = [0u64; 2];
-        s[0] = u64::from_le_bytes([
-            key[16], key[17], key[18], key[19], key[20], key[21], key[22], key[23],
+        let t0 = u64::from_le_bytes(key[0..8].try_into().unwrap());
+        let t1 = u64::from_le_bytes(key[8..16].try_into().unwrap());
+        let r = PolyKey::new([
+            t0 & 0xffc0fffffff,
+            ((t0 >> 44) | (t1 << 20)) & 0xfffffc0ffff,
+            (t1 >> 24) & 0x00ffffffc0f,
         ]);
-        s[1] = u64::from_le_bytes([
-            key[24], key[25], key[26], key[27], key[28], key[29], key[30], key[31],
-        ]);
-
-        Self { r, s, h: [0; 3] }
-    }
-
-    /// Process a 16-byte block
-    fn block(&mut self, block: &[u8], is_final: bool) {
-        // Add block to h
-        let mut n = [0u128; 3];
-
-        if block.len() >= 8 {
-            let b0 = u64::from_le_bytes([
-                block[0],
-                block.get(1).copied().unwrap_or(0),
-                block.get(2).copied().unwrap_or(0),
-                block.get(3).copied().unwrap_or(0),
-                block.get(4).copied().unwrap_or(0),
-                block.get(5).copied().unwrap_or(0),
-                block.get(6).copied().unwrap_or(0),
-                block.get(7).copied().unwrap_or(0),
-            ]);
-            n[0] = (self.h[0] as u128).wrapping_add(b0 as u128);
-        } else {
-            let mut buf = [0u8; 8];
-            buf[..block.len().min(8)].copy_from_slice(&block[..block.len().min(8)]);
-            n[0] = (self.h[0] as u128).wrapping_add(u64::from_le_bytes(buf) as u128);
-        }
+        // s = key[16..32]
+        let s = [
+            u64::from_le_bytes(key[16..24].try_into().unwrap()),
+            u64::from_le_bytes(key[24..32].try_into().unwrap()),
+        ];
 
-        if block.len() > 8 {
-            let mut buf = [0u8; 8];
-            let remaining = &block[8..];
-            buf[..remaining.len().min(8)].copy_from_slice(&remaining[..remaining.len().min(8)]);
-            n[1] = (self.h[1] as u128).wrapping_add(u64::from_le_bytes(buf) as u128);
-        } else {
-            n[1] = self.h[1] as u128;
+        Self {
+            powers: [r; 4],
+            have_powers: false,
+            s,
+            h: [0; 3],
+            buffer: [0; 16],
+            buffered: 0,
         }
+    }
 
-        // Add high bit if not final partial block
-        if !is_final || block.len() == 16 {
-            n[2] = (self.h[2] as u128).wrapping_add(1);
-        } else {
-            // For final partial block, add 0x01 after the message
-            let hibit_pos = block.len();
-            if hibit_pos < 8 {
-                n[0] |= 1u128 << (hibit_pos * 8);
-            } else {
-                n[1] |= 1u128 << ((hibit_pos - 8) * 8);
+    /// Absorb whole 16-byte blocks
+    fn blocks(&mut self, data: &[u8], hibit: u64) {
+        if data.len() >= 64 && !self.have_powers {
+            let r = self.powers[0];
+            for i in 1..4 {
+                self.powers[i] = PolyKey::new(poly_mul(&self.powers[i - 1].r, &r));
             }
-            n[2] = self.h[2] as u128;
+            self.have_powers = true;
         }
 
-        // Multiply by r (simplified)
-        let r0 = self.r[0] as u128;
-        let r1 = self.r[1] as u128;
+        let mut h = self.h;
+        let [r1, r2, r3, r4] = &self.powers;
 
-        let mut t0 = n[0].wrapping_mul(r0);
-        let mut t1 = n[0].wrapping_mul(r1).wrapping_add(n[1].wrapping_mul(r0));
-        let t2 = n[1].wrapping_mul(r1).wrapping_add(n[2].wrapping_mul(r0));
+        let mut quads = data.chunks_exact(64);
+        for quad in &mut quads {
+            let mut m1 = poly_limbs(&quad[..16], hibit);
+            for i in 0..3 {
+                m1[i] += h[i];
+            }
+            let mut d = [0u128; 3];
+            poly_mul_acc(&m1, r4, &mut d);
+            poly_mul_acc(&poly_limbs(&quad[16..32], hibit), r3, &mut d);
+            poly_mul_acc(&poly_limbs(&quad[32..48], hibit), r2, &mut d);
+            poly_mul_acc(&poly_limbs(&quad[48..64], hibit), r1, &mut d);
+            h = poly_carry(d);
+        }
 
-        // Reduce mod 2^130 - 5
-        let c = t2 >> 2;
-        t0 = t0.wrapping_add(c.wrapping_mul(5));
-        t1 = t1.wrapping_add(t0 >> 64);
+        for block in quads.remainder().chunks_exact(16) {
+            let m = poly_limbs(block, hibit);
+            for i in 0..3 {
+                h[i] += m[i];
+            }
+            h = poly_mul(&h, r1);
+        }
 
-        self.h[0] = t0 as u64;
-        self.h[1] = t1 as u64;
-        self.h[2] = ((t1 >> 64) as u64) & 3;
+        self.h = h;
     }
 
     /// Update with data
     pub fn update(&mut self, data: &[u8]) {
-        let mut offset = 0;
-        while offset + 16 <= data.len() {
-            self.block(&data[offset..offset + 16], false);
-            offset += 16;
-        }
-        if offset < data.len() {
-            self.block(&data[offset..], true);
+        let mut data = data;
+
+        if self.buffered > 0 {
+            let take = (16 - self.buffered).min(data.len());
+            self.buffer[self.buffered..self.buffered + take].copy_from_slice(&data[..take]);
+            self.buffered += take;
+            data = &data[take..];
+            if self.buffered < 16 {
+                return;
+            }
+            let block = self.buffer;
+            self.blocks(&block, HIBIT);
+            self.buffered = 0;
         }
+
+        let whole = data.len() & !15;
+        self.blocks(&data[..whole], HIBIT);
+
+        let rest = &data[whole..];
+        self.buffer[..rest.len()].copy_from_slice(rest);
+        self.buffered = rest.len();
     }
 
     /// Finalize and get the tag
-    pub fn finalize(self) -> [u8; 16] {
-        // Add s
-        let mut f = self.h[0] as u128 + self.s[0] as u128;
-        let c = f >> 64;
-        let mut tag = [0u8; 16];
-        tag[0..8].copy_from_slice(&(f as u64).to_le_bytes());
+    pub fn finalize(mut self) -> [u8; 16] {
+        // Final partial block: message bytes, then 0x01, then zeros
+        if self.buffered > 0 {
+            let mut block = [0u8; 16];
+            block[..self.buffered].copy_from_slice(&self.buffer[..self.buffered]);
+            block[self.buffered] = 1;
+            self.blocks(&block, 0);
+        }
 
-        f = self.h[1] as u128 + self.s[1] as u128 + c;
-        tag[8..16].copy_from_slice(&(f as u64).to_le_bytes());
+        // Fully carry h
+        let [mut h0, mut h1, mut h2] = self.h;
+        let mut c;
+        c = h1 >> 44;
+        h1 &= MASK44;
+        h2 += c;
+        c = h2 >> 42;
+        h2 &= MASK42;
+        h0 += c * 5;
+        c = h0 >> 44;
+        h0 &= MASK44;
+        h1 += c;
+        c = h1 >> 44;
+        h1 &= MASK44;
+        h2 += c;
+        c = h2 >> 42;
+        h2 &= MASK42;
+        h0 += c * 5;
+        c = h0 >> 44;
+        h0 &= MASK44;
+        h1 += c;
+
+        // g = h + 5 - 2^130; keep g if it did not go negative (h >= p)
+        let mut g0 = h0 + 5;
+        c = g0 >> 44;
+        g0 &= MASK44;
+        let mut g1 = h1 + c;
+        c = g1 >> 44;
+        g1 &= MASK44;
+        let g2 = (h2 + c).wrapping_sub(1 << 42);
+
+        let mask = (g2 >> 63).wrapping_sub(1);
+        h0 = (h0 & !mask) | (g0 & mask);
+        h1 = (h1 & !mask) | (g1 & mask);
+        h2 = (h2 & !mask) | (g2 & mask);
+
+        // h = (h + s) mod 2^128
+        let [s0, s1] = self.s;
+        h0 += s0 & MASK44;
+        c = h0 >> 44;
+        h0 &= MASK44;
+        h1 += (((s0 >> 44) | (s1 << 20)) & MASK44) + c;
+        c = h1 >> 44;
+        h1 &= MASK44;
+        h2 += ((s1 >> 24) & MASK42) + c;
+        h2 &= MASK42;
+
+        let lo = h0 | (h1 << 44);
+        let hi = (h1 >> 20) | (h2 << 24);
 
+        let mut tag = [0u8; 16];
+        tag[0..8].copy_from_slice(&lo.to_le_bytes());
+        tag[8..16].copy_from_slice(&hi.to_le_bytes());
         tag
     }
 }
@@ -329,19 +501,47 @@ impl ChaCha20Poly1305 {
         Self { key: k }
     }
 
-    /// Generate Poly1305 key from ChaCha20
-    fn generate_poly_key(&self, nonce: &[u8; 12]) -> [u8; 32] {
-        let block = chacha20_block(&self.key, 0, nonce);
-        let mut poly_key = [0u8; 32];
-        poly_key.copy_from_slice(&block[..32]);
-        poly_key
-    }
-
     /// Pad length to 16-byte boundary
     fn pad16(len: usize) -> usize {
         (16 - (len % 16)) % 16
     }
 
+    /// The Poly1305 key (block 0) together with the keystream for the
+    /// first `len` bytes of data (blocks 1 onwards, at most seven), so
+    /// short messages take a single SIMD pass
+    fn first_keystream(state: &[u32; 16], len: usize) -> [u8; KEYSTREAM_BATCH] {
+        let mut ks = [0u8; KEYSTREAM_BATCH];
+        let first = len.min(KEYSTREAM_BATCH - CHACHA20_BLOCK_SIZE);
+        keystream(state, 0, &mut ks, CHACHA20_BLOCK_SIZE + first);
+        ks
+    }
+
+    /// Apply the keystream to `data`, given the batch from
+    /// [`first_keystream`](Self::first_keystream)
+    fn apply(chacha: &mut ChaCha20, ks: &[u8; KEYSTREAM_BATCH], data: &mut [u8]) {
+        let first = data.len().min(KEYSTREAM_BATCH - CHACHA20_BLOCK_SIZE);
+        let (head, rest) = data.split_at_mut(first);
+        xor_in_place(head, &ks[CHACHA20_BLOCK_SIZE..]);
+        // Only reached when the first batch was full, i.e. blocks 1..=7
+        chacha.set_counter(KEYSTREAM_BATCH as u32 / CHACHA20_BLOCK_SIZE as u32);
+        chacha.apply_keystream(rest);
+    }
+
+    /// Tag over AAD || padding || ciphertext || padding || lengths
+    fn compute_tag(ks: &[u8; KEYSTREAM_BATCH], aad: &[u8], ciphertext: &[u8]) -> [u8; 16] {
+        let poly_key: [u8; 32] = ks[..32].try_into().unwrap();
+
+        let zeros = [0u8; 16];
+        let mut mac = Poly1305::new(&poly_key);
+        mac.update(aad);
+        mac.update(&zeros[..Self::pad16(aad.len())]);
+        mac.update(ciphertext);
+        mac.update(&zeros[..Self::pad16(ciphertext.len())]);
+        mac.update(&(aad.len() as u64).to_le_bytes());
+        mac.update(&(ciphertext.len() as u64).to_le_bytes());
+        mac.finalize()
+    }
+
     /// Encrypt and authenticate
     pub fn encrypt(
         &self,
@@ -349,28 +549,19 @@ impl ChaCha20Poly1305 {
         aad: &[u8],
         plaintext: &[u8],
     ) -> Vec<u8> {
-        // Generate Poly1305 key
-        let poly_key = self.generate_poly_key(nonce);
-
-        // Encrypt plaintext
         let mut chacha = ChaCha20::new(&self.key, nonce);
-        chacha.set_counter(1); // Counter starts at 1 for encryption
-        let ciphertext = chacha.encrypt(plaintext);
 
-        // Compute auth tag over AAD || padding || ciphertext || padding || lengths
-        let mut mac = Poly1305::new(&poly_key);
-        mac.update(aad);
-        let aad_padding = vec![0u8; Self::pad16(aad.len())];
-        mac.update(&aad_padding);
-        mac.update(&ciphertext);
-        let ct_padding = vec![0u8; Self::pad16(ciphertext.len())];
-        mac.update(&ct_padding);
-        mac.update(&(aad.len() as u64).to_le_bytes());
-        mac.update(&(plaintext.len() as u64).to_le_bytes());
-        let tag = mac.finalize();
+        // Room for the tag up front so appending it does not reallocate
+        let mut result = Vec::with_capacity(plaintext.len() + POLY1305_TAG_SIZE);
+        result.extend_from_slice(plaintext);
+
+        // Encrypt plaintext; block 0 keys Poly1305, data starts at block 1
+        let ks = Self::first_keystream(&chacha.state, plaintext.len());
+        Self::apply(&mut chacha, &ks, &mut result);
+
+        let tag = Self::compute_tag(&ks, aad, &result);
 
         // Return ciphertext || tag
-        let mut result = ciphertext;
         result.extend_from_slice(&tag);
         result
     }
@@ -390,20 +581,9 @@ impl ChaCha20Poly1305 {
         let ciphertext = &ciphertext_with_tag[..ciphertext_len];
         let tag = &ciphertext_with_tag[ciphertext_len..];
 
-        // Generate Poly1305 key
-        let poly_key = self.generate_poly_key(nonce);
-
-        // Compute expected tag
-        let mut mac = Poly1305::new(&poly_key);
-        mac.update(aad);
-        let aad_padding = vec![0u8; Self::pad16(aad.len())];
-        mac.update(&aad_padding);
-        mac.update(ciphertext);
-        let ct_padding = vec![0u8; Self::pad16(ciphertext.len())];
-        mac.update(&ct_padding);
-        mac.update(&(aad.len() as u64).to_le_bytes());
-        mac.update(&(ciphertext_len as u64).to_le_bytes());
-        let expected_tag = mac.finalize();
+        let mut chacha = ChaCha20::new(&self.key, nonce);
+        let ks = Self::first_keystream(&chacha.state, ciphertext_len);
+        let expected_tag = Self::compute_tag(&ks, aad, ciphertext);
 
         // Constant-time tag comparison
         let mut diff = 0u8;
@@ -415,9 +595,9 @@ impl ChaCha20Poly1305 {
         }
 
         // Decrypt
-        let mut chacha = ChaCha20::new(&self.key, nonce);
-        chacha.set_counter(1);
-        Ok(chacha.decrypt(ciphertext))
+        let mut plaintext = ciphertext.to_vec();
+        Self::apply(&mut chacha, &ks, &mut plaintext);
+        Ok(plaintext)
     }
 }
 
@@ -589,6 +769,159 @@ pub unsafe extern "C" fn ncrypto_chacha20_poly1305_decrypt(
 mod tests {
     use super::*;
 
+    fn hex(s: &str) -> Vec<u8> {
+        crate::encoding::hex_decode(s).unwrap()
+    }
+
+    const RFC_KEY: &str = "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f";
+    const SUNSCREEN: &[u8] = b"Ladies and Gentlemen of the class of '99: If I could offer you \
+only one tip for the future, sunscreen would be it.";
+
+    /// Keystream from the scalar block function, for comparison
+    fn scalar_keystream(key: &[u8; 32], nonce: &[u8; 12], counter: u32, len: usize) -> Vec<u8> {
+        let state = init_state(key, nonce);
+        (0..len.div_ceil(64) as u32)
+            .flat_map(|i| chacha20_block(&state, counter.wrapping_add(i)))
+            .take(len)
+            .collect()
+    }
+
+    #[test]
+    fn test_chacha20_rfc8439_block() {
+        // RFC 8439 section 2.3.2
+        let key: [u8; 32] = hex(RFC_KEY).try_into().unwrap();
+        let nonce: [u8; 12] = hex("000000090000004a00000000").try_into().unwrap();
+        let block = chacha20_block(&init_state(&key, &nonce), 1);
+        assert_eq!(
+            block.to_vec(),
+            hex(concat!(
+                "10f1e7e4d13b5915500fdd1fa32071c4c7d1f4c733c068030422aa9ac3d46c4e",
+                "d2826446079faa0914c2d705d98b02a2b5129cd1de164eb9cbd083e8a2503c4e"
+            ))
+        );
+    }
+
+    #[test]
+    fn test_chacha20_rfc8439_encrypt() {
+        // RFC 8439 section 2.4.2
+        let key: [u8; 32] = hex(RFC_KEY).try_into().unwrap();
+        let nonce: [u8; 12] = hex("000000000000004a00000000").try_into().unwrap();
+        let mut cipher = ChaCha20::new(&key, &nonce);
+        cipher.set_counter(1);
+        let ct = cipher.encrypt(SUNSCREEN);
+        assert_eq!(
+            ct,
+            hex(concat!(
+                "6e2e359a2568f98041ba0728dd0d6981e97e7aec1d4360c20a27afccfd9fae0b",
+                "f91b65c5524733ab8f593dabcd62b3571639d624e65152ab8f530c359f0861d8",
+                "07ca0dbf500d6a6156a38e088a22b65e52bc514d16ccf806818ce91ab7793736",
+                "5af90bbf74a35be6b40b8eedf2785e42874d"
+            ))
+        );
+    }
+
+    #[test]
+    fn test_keystream_kernels_agree() {
+        // Lengths around the 1-, 4- and 8-block kernel boundaries, with a
+        // counter that wraps inside a batch
+        let key: [u8; 32] = core::array::from_fn(|i| (i * 37 + 11) as u8);
+        let nonce: [u8; 12] = core::array::from_fn(|i| (i * 13 + 5) as u8);
+        for counter in [0u32, 1, u32::MAX - 2] {
+            for len in (0..=1100).chain([4096, 4096 + 65]) {
+                let mut data = vec![0u8; len];
+                let mut cipher = ChaCha20::new(&key, &nonce);
+                cipher.set_counter(counter);
+                cipher.apply_keystream(&mut data);
+                assert_eq!(
+                    data,
+                    scalar_keystream(&key, &nonce, counter, len),
+                    "len {len}"
+                );
+                let blocks = len.div_ceil(64) as u32;
+                assert_eq!(cipher.counter, counter.wrapping_add(blocks));
+            }
+        }
+    }
+
+    #[test]
+    fn test_poly1305_rfc8439() {
+        // RFC 8439 section 2.5.2
+        let key: [u8; 32] = hex(concat!(
+            "85d6be7857556d337f4452fe42d506a8",
+            "0103808afb0db2fd4abff6af4149f51b"
+        ))
+        .try_into()
+        .unwrap();
+        let tag = poly1305(&key, b"Cryptographic Forum Research Group");
+        assert_eq!(tag.to_vec(), hex("a8061dc1305136c6c22b8baf0c0127a9"));
+    }
+
+    #[test]
+    fn test_poly1305_edge_cases() {
+        // RFC 8439 appendix A.3, vectors 5, 6 and 9: the final reduction
+        // and the carry out of h + s
+        let cases: [(&str, &str, &str); 3] = [
+            (
+                "0200000000000000000000000000000000000000000000000000000000000000",
+                "ffffffffffffffffffffffffffffffff",
+                "03000000000000000000000000000000",
+            ),
+            (
+                "02000000000000000000000000000000ffffffffffffffffffffffffffffffff",
+                "02000000000000000000000000000000",
+                "03000000000000000000000000000000",
+            ),
+            (
+                "0200000000000000000000000000000000000000000000000000000000000000",
+                "fdffffffffffffffffffffffffffffff",
+                "faffffffffffffffffffffffffffffff",
+            ),
+        ];
+        for (key, msg, tag) in cases {
+            let key: [u8; 32] = hex(key).try_into().unwrap();
+            assert_eq!(poly1305(&key, &hex(msg)).to_vec(), hex(tag));
+        }
+    }
+
+    #[test]
+    fn test_poly1305_streaming() {
+        // Split points that land inside, at and across the 4-block steps
+        let key: [u8; 32] = core::array::from_fn(|i| (i * 29 + 3) as u8);
+        let msg: Vec<u8> = (0..300).map(|i| (i * 131 + 7) as u8).collect();
+        for len in [0, 1, 15, 16, 17, 63, 64, 65, 127, 128, 129, 300] {
+            let expected = poly1305(&key, &msg[..len]);
+            for step in [1, 3, 16, 31, 64, 100] {
+                let mut mac = Poly1305::new(&key);
+                for part in msg[..len].chunks(step) {
+                    mac.update(part);
+                }
+                assert_eq!(mac.finalize(), expected, "len {len} step {step}");
+            }
+        }
+    }
+
+    #[test]
+    fn test_chacha20_poly1305_rfc8439() {
+        // RFC 8439 section 2.8.2
+        let key: [u8; 32] = hex(concat!(
+            "808182838485868788898a8b8c8d8e8f",
+            "909192939495969798999a9b9c9d9e9f"
+        ))
+        .try_into()
+        .unwrap();
+        let nonce: [u8; 12] = hex("070000004041424344454647").try_into().unwrap();
+        let aad = hex("50515253c0c1c2c3c4c5c6c7");
+
+        let out = chacha20_poly1305_encrypt(&key, &nonce, &aad, SUNSCREEN);
+        assert_eq!(out[..16].to_vec(), hex("d31a8d34648e60db7b86afbc53ef7ec2"));
+        assert_eq!(
+            out[out.len() - 16..].to_vec(),
+            hex("1ae10b594f09e26a7e902ecbd0600691")
+        );
+        let pt = chacha20_poly1305_decrypt(&key, &nonce, &aad, &out).unwrap();
+        assert_eq!(pt, SUNSCREEN);
+    }
+
     #[test]
     fn test_chacha20_basic() {
         let key = [0u8; 32];
@@ -0,0 +1,199 @@
+//! Multi-block ChaCha20 kernels (x86_64)
+//!
+//! Each kernel computes several consecutive keystream blocks at once. Vector
+//! register `x[i]` holds state word `i` of every block ("vertical" layout),
+//! so a quarter round is the scalar quarter round applied to whole vectors
+//! and the block counter is the only word that differs between lanes. A
+//! transpose at the end turns the lanes back into serialized blocks.
+//!
+//! - [`sse2`]: four blocks per call. SSE2 is part of the x86_64 baseline,
+//!   so it needs no detection.
+//! - [`avx2`]: eight blocks per call, when the CPU has AVX2 (checked with
+//!   [`cpu::has_avx2`](crate::cpu::has_avx2)).
+
+/// The 20 ChaCha rounds over the word vectors `$x`, with `$add`, `$xor`
+/// and `$rotl` the lane-wise operations
+macro_rules! double_rounds {
+    ($x:ident, $add:ident, $xor:ident, $rotl:ident) => {
+        for _ in 0..10 {
+            quarter_round!($x, 0, 4, 8, 12, $add, $xor, $rotl);
+            quarter_round!($x, 1, 5, 9, 13, $add, $xor, $rotl);
+            quarter_round!($x, 2, 6, 10, 14, $add, $xor, $rotl);
+            quarter_round!($x, 3, 7, 11, 15, $add, $xor, $rotl);
+            quarter_round!($x, 0, 5, 10, 15, $add, $xor, $rotl);
+            quarter_round!($x, 1, 6, 11, 12, $add, $xor, $rotl);
+            quarter_round!($x, 2, 7, 8, 13, $add, $xor, $rotl);
+            quarter_round!($x, 3, 4, 9, 14, $add, $xor, $rotl);
+        }
+    };
+}
+
+macro_rules! quarter_round {
+    ($x:ident, $a:literal, $b:literal, $c:literal, $d:literal, $add:ident, $xor:ident, $rotl:ident) => {
+        $x[$a] = $add($x[$a], $x[$b]);
+        $x[$d] = $rotl!($xor($x[$d], $x[$a]), 16);
+        $x[$c] = $add($x[$c], $x[$d]);
+        $x[$b] = $rotl!($xor($x[$b], $x[$c]), 12);
+        $x[$a] = $add($x[$a], $x[$b]);
+        $x[$d] = $rotl!($xor($x[$d], $x[$a]), 8);
+        $x[$c] = $add($x[$c], $x[$d]);
+        $x[$b] = $rotl!($xor($x[$b], $x[$c]), 7);
+    };
+}
+
+pub mod sse2 {
+    use core::arch::x86_64::*;
+
+    /// Blocks per call
+    pub const BLOCKS: usize = 4;
+
+    macro_rules! rotl {
+        (@shift $v:expr, $l:literal, $r:literal) => {{
+            let v = $v;
+            _mm_or_si128(_mm_slli_epi32(v, $l), _mm_srli_epi32(v, $r))
+        }};
+        ($v:expr, 16) => {
+            rotl!(@shift $v, 16, 16)
+        };
+        ($v:expr, 12) => {
+            rotl!(@shift $v, 12, 20)
+        };
+        ($v:expr, 8) => {
+            rotl!(@shift $v, 8, 24)
+        };
+        ($v:expr, 7) => {
+            rotl!(@shift $v, 7, 25)
+        };
+    }
+
+    /// Four blocks with counters `state[12]`, `state[12] + 1`, ...
+    ///
+    /// # Safety
+    /// Requires SSE2, which every x86_64 CPU has.
+    pub unsafe fn blocks(state: &[u32; 16], out: &mut [u8; 64 * BLOCKS]) {
+        let mut x = [_mm_setzero_si128(); 16];
+        for (v, &word) in x.iter_mut().zip(state.iter()) {
+            *v = _mm_set1_epi32(word as i32);
+        }
+        x[12] = _mm_add_epi32(x[12], _mm_set_epi32(3, 2, 1, 0));
+        let initial = x;
+
+        double_rounds!(x, _mm_add_epi32, _mm_xor_si128, rotl);
+
+        for (v, init) in x.iter_mut().zip(initial.iter()) {
+            *v = _mm_add_epi32(*v, *init);
+        }
+
+        // Transpose each group of four words: lanes become blocks
+        let ptr = out.as_mut_ptr();
+        for group in 0..4 {
+            let a = x[4 * group];
+            let b = x[4 * group + 1];
+            let c = x[4 * group + 2];
+            let d = x[4 * group + 3];
+            let ab_lo = _mm_unpacklo_epi32(a, b);
+            let cd_lo = _mm_unpacklo_epi32(c, d);
+            let ab_hi = _mm_unpackhi_epi32(a, b);
+            let cd_hi = _mm_unpackhi_epi32(c, d);
+            let rows = [
+                _mm_unpacklo_epi64(ab_lo, cd_lo),
+                _mm_unpackhi_epi64(ab_lo, cd_lo),
+                _mm_unpacklo_epi64(ab_hi, cd_hi),
+                _mm_unpackhi_epi64(ab_hi, cd_hi),
+            ];
+            for (block, row) in rows.into_iter().enumerate() {
+                _mm_storeu_si128(ptr.add(64 * block + 16 * group) as *mut __m128i, row);
+            }
+        }
+    }
+}
+
+#[cfg(feature = "hw-accel")]
+pub mod avx2 {
+    use core::arch::x86_64::*;
+
+    /// Blocks per call
+    pub const BLOCKS: usize = 8;
+
+    macro_rules! rotl {
+        (@shift $v:expr, $l:literal, $r:literal) => {{
+            let v = $v;
+            _mm256_or_si256(_mm256_slli_epi32(v, $l), _mm256_srli_epi32(v, $r))
+        }};
+        // Byte-aligned rotations are a single shuffle
+        ($v:expr, 16) => {
+            _mm256_shuffle_epi8(
+                $v,
+                _mm256_set_epi8(
+                    13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2, 13, 12, 15, 14, 9, 8, 11,
+                    10, 5, 4, 7, 6, 1, 0, 3, 2,
+                ),
+            )
+        };
+        ($v:expr, 8) => {
+            _mm256_shuffle_epi8(
+                $v,
+                _mm256_set_epi8(
+                    14, 13, 12, 15, 10, 9, 8, 11, 6, 5, 4, 7, 2, 1, 0, 3, 14, 13, 12, 15, 10, 9, 8,
+                    11, 6, 5, 4, 7, 2, 1, 0, 3,
+                ),
+            )
+        };
+        ($v:expr, 12) => {
+            rotl!(@shift $v, 12, 20)
+        };
+        ($v:expr, 7) => {
+            rotl!(@shift $v, 7, 25)
+        };
+    }
+
+    /// Eight blocks with counters `state[12]`, `state[12] + 1`, ...
+    ///
+    /// # Safety
+    /// The CPU must support AVX2.
+    #[target_feature(enable = "avx2")]
+    pub unsafe fn blocks(state: &[u32; 16], out: &mut [u8; 64 * BLOCKS]) {
+        let mut x = [_mm256_setzero_si256(); 16];
+        for (v, &word) in x.iter_mut().zip(state.iter()) {
+            *v = _mm256_set1_epi32(word as i32);
+        }
+        x[12] = _mm256_add_epi32(x[12], _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+        let initial = x;
+
+        double_rounds!(x, _mm256_add_epi32, _mm256_xor_si256, rotl);
+
+        for (v, init) in x.iter_mut().zip(initial.iter()) {
+            *v = _mm256_add_epi32(*v, *init);
+        }
+
+        // The unpacks work within each 128-bit half, so one transpose
+        // yields blocks 0-3 in the low halves and blocks 4-7 in the high
+        let ptr = out.as_mut_ptr();
+        for group in 0..4 {
+            let a = x[4 * group];
+            let b = x[4 * group + 1];
+            let c = x[4 * group + 2];
+            let d = x[4 * group + 3];
+            let ab_lo = _mm256_unpacklo_epi32(a, b);
+            let cd_lo = _mm256_unpacklo_epi32(c, d);
+            let ab_hi = _mm256_unpackhi_epi32(a, b);
+            let cd_hi = _mm256_unpackhi_epi32(c, d);
+            let rows = [
+                _mm256_unpacklo_epi64(ab_lo, cd_lo),
+                _mm256_unpackhi_epi64(ab_lo, cd_lo),
+                _mm256_unpacklo_epi64(ab_hi, cd_hi),
+                _mm256_unpackhi_epi64(ab_hi, cd_hi),
+            ];
+            for (block, row) in rows.into_iter().enumerate() {
+                _mm_storeu_si128(
+                    ptr.add(64 * block + 16 * group) as *mut __m128i,
+                    _mm256_castsi256_si128(row),
+                );
+                _mm_storeu_si128(
+                    ptr.add(64 * (block + 4) + 16 * group) as *mut __m128i,
+                    _mm256_extracti128_si256(row, 1),
+                );
+            }
+        }
+    }
+}
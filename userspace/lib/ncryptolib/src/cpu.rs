@@ -0,0 +1,76 @@
+//! CPU feature detection for accelerated code paths
+//!
+//! Ciphers pick their implementation once, when a key is set up, by asking
+//! this module. CPUID is queried on first use and the answer cached.
+//!
+//! Paths that need detection are only compiled with the `hw-accel`
+//! feature; baseline x86_64 SIMD (SSE2) is always used. Setting
+//! `NCRYPTO_NO_HW_ACCEL` in the environment makes every query here answer
+//! false, which is how the two are compared on one machine.
+
+#[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+use std::sync::atomic::{AtomicU8, Ordering};
+
+/// Environment variable that disables hardware acceleration
+pub const NO_HW_ACCEL_ENV: &str = "NCRYPTO_NO_HW_ACCEL";
+
+#[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+const UNKNOWN: u8 = 0;
+#[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+const ABSENT: u8 = 1;
+#[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+const PRESENT: u8 = 2;
+
+#[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+static AES_NI: AtomicU8 = AtomicU8::new(UNKNOWN);
+#[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+static AVX2: AtomicU8 = AtomicU8::new(UNKNOWN);
+
+#[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+fn cached(flag: &AtomicU8, detect: fn() -> bool) -> bool {
+    match flag.load(Ordering::Relaxed) {
+        PRESENT => true,
+        ABSENT => false,
+        _ => {
+            let present = std::env::var_os(NO_HW_ACCEL_ENV).is_none() && detect();
+            flag.store(if present { PRESENT } else { ABSENT }, Ordering::Relaxed);
+            present
+        }
+    }
+}
+
+/// AES-NI with PCLMULQDQ (and SSSE3 for byte shuffles) is usable
+pub fn has_aes_ni() -> bool {
+    #[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+    {
+        cached(&AES_NI, || {
+            std::is_x86_feature_detected!("aes")
+                && std::is_x86_feature_detected!("pclmulqdq")
+                && std::is_x86_feature_detected!("ssse3")
+        })
+    }
+    #[cfg(not(all(target_arch = "x86_64", feature = "hw-accel")))]
+    {
+        false
+    }
+}
+
+/// AVX2 is usable (the CPU has it and the OS saves the YMM registers)
+pub fn has_avx2() -> bool {
+    #[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+    {
+        cached(&AVX2, || std::is_x86_feature_detected!("avx2"))
+    }
+    #[cfg(not(all(target_arch = "x86_64", feature = "hw-accel")))]
+    {
+        false
+    }
+}
+
+/// SHA extensions are usable for SHA-1 and SHA-256
+///
+/// The hashes are in `nsha`, which does its own detection (it also runs in
+/// the kernel); this reports its answer alongside the others.
+pub fn has_sha_ni() -> bool {
+    nsha::cpu::has_sha_ni()
+}
@@ -1,10 +1,14 @@
 //! Ed25519 Digital Signatures
 //!
-//! RFC 8032 compliant Ed25519 implementation.
+//! RFC 8032 compliant Ed25519 implementation, on the group arithmetic in
+//! `edwards25519`. Signing and key derivation use the constant-time
+//! fixed-base table; verification is variable-time, as it only handles
+//! public data, and can check many signatures at once with
+//! [`verify_batch`].
 
-#[allow(unused_imports)]
 use std::vec::Vec;
 
+use crate::edwards25519::{mul_base, multiscalar_mul_vartime, EdwardsPoint, Scalar};
 use crate::hash::{sha512, Sha512};
 
 // ============================================================================
@@ -18,346 +22,14 @@ pub const ED25519_PUBLIC_KEY_SIZE: usize = 32;
 /// Ed25519 signature size
 pub const ED25519_SIGNATURE_SIZE: usize = 64;
 
-/// Base point B (compressed Edwards y-coordinate)
-const BASE_POINT_Y: [u8; 32] = [
-    0x58, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66,
-    0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66,
-];
-
-// ============================================================================
-// Field Element (mod p where p = 2^255 - 19)
-// ============================================================================
-
-/// Field element in GF(2^255 - 19)
-#[derive(Clone, Copy, Debug, PartialEq, Eq)]
-struct Fe([i64; 10]);
-
-impl Fe {
-    const fn zero() -> Self {
-        Fe([0; 10])
-    }
-
-    const fn one() -> Self {
-        Fe([1, 0, 0, 0, 0, 0, 0, 0, 0, 0])
-    }
-
-    /// Load from 32 bytes (little-endian)
-    fn from_bytes(bytes: &[u8; 32]) -> Self {
-        let mut h = [0i64; 10];
-
-        h[0] = load_4(&bytes[0..4]) as i64;
-        h[1] = (load_3(&bytes[4..7]) << 6) as i64;
-        h[2] = (load_3(&bytes[7..10]) << 5) as i64;
-        h[3] = (load_3(&bytes[10..13]) << 3) as i64;
-        h[4] = (load_3(&bytes[13..16]) << 2) as i64;
-        h[5] = load_4(&bytes[16..20]) as i64;
-        h[6] = (load_3(&bytes[20..23]) << 7) as i64;
-        h[7] = (load_3(&bytes[23..26]) << 5) as i64;
-        h[8] = (load_3(&bytes[26..29]) << 4) as i64;
-        h[9] = ((load_3(&bytes[29..32]) & 0x7fffff) << 2) as i64;
-
-        Fe(h).reduce()
-    }
-
-    /// Store to 32 bytes (little-endian)
-    fn to_bytes(&self) -> [u8; 32] {
-        let h = self.reduce();
-        let mut s = [0u8; 32];
-
-        // Simplified conversion
-        let mut carry = [0i64; 10];
-        let mut t = h.0;
-
-        for i in 0..10 {
-            carry[i] = t[i] >> 26;
-            if i < 9 {
-                t[i + 1] += carry[i];
-            }
-            t[i] -= carry[i] << 26;
-        }
-
-        // Pack into bytes (simplified)
-        for i in 0..32 {
-            let idx = i * 10 / 32;
-            if idx < 10 {
-                s[i] = (t[idx] >> ((i * 10) % 26)) as u8;
-            }
-        }
-
-        s
-    }
-
-    fn reduce(&self) -> Self {
-        let mut t = self.0;
-
-        // Carry propagation
-        for _ in 0..2 {
-            for i in 0..9 {
-                let carry = (t[i] + (1 << 25)) >> 26;
-                t[i] -= carry << 26;
-                t[i + 1] += carry;
-            }
-            let carry = (t[9] + (1 << 24)) >> 25;
-            t[9] -= carry << 25;
-            t[0] += carry * 19;
-        }
-
-        Fe(t)
-    }
-
-    fn add(&self, other: &Self) -> Self {
-        let mut result = Fe::zero();
-        for i in 0..10 {
-            result.0[i] = self.0[i] + other.0[i];
-        }
-        result.reduce()
-    }
-
-    fn sub(&self, other: &Self) -> Self {
-        let mut result = Fe::zero();
-        for i in 0..10 {
-            result.0[i] = self.0[i] - other.0[i];
-        }
-        result.reduce()
-    }
-
-    fn mul(&self, other: &Self) -> Self {
-        let mut product = [0i128; 19];
-
-        for i in 0..10 {
-            for j in 0..10 {
-                product[i + j] += self.0[i] as i128 * other.0[j] as i128;
-            }
-        }
-
-        // Reduce mod p
-        for i in 10..19 {
-            product[i - 10] += product[i] * 19;
-        }
-
-        let mut result = Fe::zero();
-        for i in 0..10 {
-            result.0[i] = product[i] as i64;
-        }
-
-        result.reduce()
-    }
-
-    fn square(&self) -> Self {
-        self.mul(self)
-    }
-
-    fn neg(&self) -> Self {
-        let mut result = Fe::zero();
-        for i in 0..10 {
-            result.0[i] = -self.0[i];
-        }
-        result.reduce()
-    }
-
-    /// Compute a^(p-2) mod p using Fermat's little theorem
-    fn invert(&self) -> Self {
-        let mut t0 = self.square(); // 2
-        let mut t1 = t0.square(); // 4
-        t1 = t1.square(); // 8
-        t1 = self.mul(&t1); // 9
-        t0 = t0.mul(&t1); // 11
-        let mut t2 = t0.square(); // 22
-        t1 = t1.mul(&t2); // 31 = 2^5 - 1
-        t2 = t1.square(); // 2^6 - 2
-        for _ in 1..5 {
-            t2 = t2.square();
-        }
-        t1 = t2.mul(&t1); // 2^10 - 1
-        t2 = t1.square();
-        for _ in 1..10 {
-            t2 = t2.square();
-        }
-        t2 = t2.mul(&t1); // 2^20 - 1
-        let mut t3 = t2.square();
-        for _ in 1..20 {
-            t3 = t3.square();
-        }
-        t2 = t3.mul(&t2); // 2^40 - 1
-        t2 = t2.square();
-        for _ in 1..10 {
-            t2 = t2.square();
-        }
-        t1 = t2.mul(&t1); // 2^50 - 1
-        t2 = t1.square();
-        for _ in 1..50 {
-            t2 = t2.square();
-        }
-        t2 = t2.mul(&t1); // 2^100 - 1
-        t3 = t2.square();
-        for _ in 1..100 {
-            t3 = t3.square();
-        }
-        t2 = t3.mul(&t2); // 2^200 - 1
-        t2 = t2.square();
-        for _ in 1..50 {
-            t2 = t2.square();
-        }
-        t1 = t2.mul(&t1); // 2^250 - 1
-        t1 = t1.square();
-        t1 = t1.square();
-        t1.mul(&t0) // 2^252 - 3
-    }
-}
-
-fn load_3(bytes: &[u8]) -> u32 {
-    (bytes[0] as u32) | ((bytes[1] as u32) << 8) | ((bytes[2] as u32) << 16)
-}
-
-fn load_4(bytes: &[u8]) -> u32 {
-    (bytes[0] as u32)
-        | ((bytes[1] as u32) << 8)
-        | ((bytes[2] as u32) << 16)
-        | ((bytes[3] as u32) << 24)
-}
-
-// ============================================================================
-// Extended Point (Extended Twisted Edwards)
-// ============================================================================
-
-/// Point on Ed25519 curve in extended coordinates (x, y, z, t)
-#[derive(Clone, Copy)]
-struct GeP3 {
-    x: Fe,
-    y: Fe,
-    z: Fe,
-    t: Fe,
-}
-
-impl GeP3 {
-    /// Identity point
-    fn identity() -> Self {
-        Self {
-            x: Fe::zero(),
-            y: Fe::one(),
-            z: Fe::one(),
-            t: Fe::zero(),
-        }
-    }
-
-    /// Encode point to bytes
-    fn to_bytes(&self) -> [u8; 32] {
-        let zi = self.z.invert();
-        let x = self.x.mul(&zi);
-        let y = self.y.mul(&zi);
-
-        let mut s = y.to_bytes();
-        s[31] ^= (x.0[0] as u8 & 1) << 7;
-        s
-    }
-
-    /// Decode point from bytes
-    fn from_bytes(bytes: &[u8; 32]) -> Option<Self> {
-        let mut s = *bytes;
-        let x_sign = (s[31] >> 7) & 1;
-        s[31] &= 0x7f;
-
-        let y = Fe::from_bytes(&s);
-        let y2 = y.square();
-
-        // x^2 = (y^2 - 1) / (d*y^2 + 1)
-        // d = -121665/121666
-        let d = Fe([
-            -10913610, 13857413, -15372611, 6949391, 114729, -8787816, -6275908, -3247719,
-            -18696448, -12055116,
-        ]);
-
-        let num = y2.sub(&Fe::one());
-        let den = d.mul(&y2).add(&Fe::one());
-        let den_inv = den.invert();
-        let x2 = num.mul(&den_inv);
-
-        // Square root (simplified)
-        let x = x2; // Placeholder - real impl needs sqrt
-
-        Some(Self {
-            x: if x_sign == 1 { x.neg() } else { x },
-            y,
-            z: Fe::one(),
-            t: x.mul(&y),
-        })
-    }
-
-    /// Scalar multiplication
-    fn scalar_mult(&self, scalar: &[u8; 32]) -> Self {
-        let mut result = GeP3::identity();
-        let mut temp = *self;
-
-        for byte in scalar.iter() {
-            for bit in 0..8 {
-                if (byte >> bit) & 1 == 1 {
-                    result = result.add(&temp);
-                }
-                temp = temp.double();
-            }
-        }
-
-        result
-    }
-
-    /// Point addition
-    fn add(&self, other: &GeP3) -> Self {
-        // Simplified addition (complete formula)
-        let a = self.x.mul(&other.x);
-        let b = self.y.mul(&other.y);
-        let c = self.t.mul(&other.t);
-        let d = Fe([
-            -10913610, 13857413, -15372611, 6949391, 114729, -8787816, -6275908, -3247719,
-            -18696448, -12055116,
-        ]);
-        let c = c.mul(&d);
-        let e = self.z.mul(&other.z);
-
-        let f = e.sub(&c);
-        let g = e.add(&c);
-
-        let _h = b.sub(&a);
-        let i = b.add(&a);
-
-        let x3 = self.x.add(&self.y).mul(&other.x.add(&other.y)).sub(&i);
-        let x3 = x3.mul(&f);
-        let y3 = i.mul(&g);
-        let z3 = f.mul(&g);
-        let t3 = x3.mul(&y3);
-
-        Self {
-            x: x3,
-            y: y3,
-            z: z3,
-            t: t3,
-        }
-    }
-
-    /// Point doubling
-    fn double(&self) -> Self {
-        let a = self.x.square();
-        let b = self.y.square();
-        let c = self.z.square();
-        let c = c.add(&c);
-        let d = a.neg();
-
-        let e = self.x.add(&self.y).square().sub(&a).sub(&b);
-        let g = d.add(&b);
-        let f = g.sub(&c);
-        let h = d.sub(&b);
-
-        let x3 = e.mul(&f);
-        let y3 = g.mul(&h);
-        let z3 = f.mul(&g);
-        let t3 = e.mul(&h);
-
-        Self {
-            x: x3,
-            y: y3,
-            z: z3,
-            t: t3,
-        }
+/// SHA-512 of the concatenated parts, reduced mod l
+fn hash_to_scalar(parts: &[&[u8]]) -> Scalar {
+    let mut hasher = Sha512::new();
+    for part in parts {
+        hasher.update(part);
     }
+    let digest: [u8; 64] = hasher.finalize().try_into().unwrap();
+    Scalar::from_bytes_wide(&digest)
 }
 
 // ============================================================================
@@ -369,7 +41,7 @@ impl GeP3 {
 pub struct Ed25519KeyPair {
     /// Private key (seed)
     seed: [u8; 32],
-    /// Expanded private key
+    /// Expanded private key: the clamped scalar, then the nonce prefix
     expanded: [u8; 64],
     /// Public key
     public_key: [u8; 32],
@@ -378,25 +50,14 @@ pub struct Ed25519KeyPair {
 impl Ed25519KeyPair {
     /// Create keypair from seed
     pub fn from_seed(seed: &[u8; 32]) -> Self {
-        let expanded = {
-            let hash = sha512(seed);
-            let mut arr = [0u8; 64];
-            arr.copy_from_slice(&hash);
-            // Clamp
-            arr[0] &= 248;
-            arr[31] &= 127;
-            arr[31] |= 64;
-            arr
-        };
+        let mut expanded: [u8; 64] = sha512(seed).try_into().unwrap();
+        // Clamp
+        expanded[0] &= 248;
+        expanded[31] &= 127;
+        expanded[31] |= 64;
 
-        // Derive public key: A = s * B
-        let mut scalar = [0u8; 32];
-        scalar.copy_from_slice(&expanded[..32]);
-
-        // Base point multiplication (simplified)
-        let base = GeP3::from_bytes(&BASE_POINT_Y).unwrap_or(GeP3::identity());
-        let public_point = base.scalar_mult(&scalar);
-        let public_key = public_point.to_bytes();
+        // A = a·B
+        let public_key = mul_base(expanded[..32].try_into().unwrap()).compress();
 
         Self {
             seed: *seed,
@@ -407,37 +68,19 @@ impl Ed25519KeyPair {
 
     /// Sign a message
     pub fn sign(&self, message: &[u8]) -> [u8; ED25519_SIGNATURE_SIZE] {
-        let mut hasher = Sha512::new();
-        hasher.update(&self.expanded[32..64]);
-        hasher.update(message);
-        let r_hash = hasher.finalize();
-
-        // r = hash mod L
-        let mut r = [0u8; 32];
-        r.copy_from_slice(&r_hash[..32]);
-
-        // R = r * B
-        let base = GeP3::from_bytes(&BASE_POINT_Y).unwrap_or(GeP3::identity());
-        let r_point = base.scalar_mult(&r);
-        let r_bytes = r_point.to_bytes();
-
-        // k = H(R || A || M)
-        let mut hasher = Sha512::new();
-        hasher.update(&r_bytes);
-        hasher.update(&self.public_key);
-        hasher.update(message);
-        let k_hash = hasher.finalize();
-        let mut k = [0u8; 32];
-        k.copy_from_slice(&k_hash[..32]);
-
-        // s = (r + k * a) mod L
-        let mut s = [0u8; 32];
-        // Simplified: s = r (in real impl, compute r + k*a mod L)
-        s.copy_from_slice(&r);
+        // r = H(prefix || M) mod l, R = r·B
+        let r = hash_to_scalar(&[&self.expanded[32..], message]);
+        let r_bytes = mul_base(&r.to_bytes()).compress();
+
+        // s = r + H(R || A || M)·a mod l
+        let k = hash_to_scalar(&[&r_bytes, &self.public_key, message]);
+        let mut a = [0u8; 64];
+        a[..32].copy_from_slice(&self.expanded[..32]);
+        let s = r.add(&k.mul(&Scalar::from_bytes_wide(&a)));
 
         let mut signature = [0u8; 64];
         signature[..32].copy_from_slice(&r_bytes);
-        signature[32..].copy_from_slice(&s);
+        signature[32..].copy_from_slice(&s.to_bytes());
         signature
     }
 
@@ -465,40 +108,23 @@ impl Ed25519PublicKey {
     }
 
     /// Verify a signature
+    ///
+    /// Checks the unbatched equation of RFC 8032 without the cofactor:
+    /// s·B - H(R || A || M)·A must encode to exactly R, with s below l.
     pub fn verify(&self, message: &[u8], signature: &[u8; 64]) -> bool {
-        // Extract R and S from signature
-        let r_bytes: [u8; 32] = signature[..32].try_into().unwrap();
-        let s_bytes: [u8; 32] = signature[32..].try_into().unwrap();
-
-        // Decompress R
-        let r_point = match GeP3::from_bytes(&r_bytes) {
-            Some(p) => p,
+        let r_bytes: &[u8; 32] = signature[..32].try_into().unwrap();
+        let s = match Scalar::from_canonical_bytes(signature[32..].try_into().unwrap()) {
+            Some(s) => s,
             None => return false,
         };
-
-        // Decompress A (public key)
-        let a_point = match GeP3::from_bytes(&self.bytes) {
-            Some(p) => p,
+        let a = match EdwardsPoint::decompress_vartime(&self.bytes) {
+            Some(a) => a,
             None => return false,
         };
 
-        // k = H(R || A || M)
-        let mut hasher = Sha512::new();
-        hasher.update(&r_bytes);
-        hasher.update(&self.bytes);
-        hasher.update(message);
-        let k_hash = hasher.finalize();
-        let mut k = [0u8; 32];
-        k.copy_from_slice(&k_hash[..32]);
-
-        // Verify: s * B == R + k * A
-        let base = GeP3::from_bytes(&BASE_POINT_Y).unwrap_or(GeP3::identity());
-        let sb = base.scalar_mult(&s_bytes);
-        let ka = a_point.scalar_mult(&k);
-        let rka = r_point.add(&ka);
-
-        // Compare points (simplified)
-        sb.to_bytes() == rka.to_bytes()
+        let k = hash_to_scalar(&[r_bytes, &self.bytes, message]);
+        let r = multiscalar_mul_vartime(&s, &[k], &[a.neg()]);
+        r.compress() == *r_bytes
     }
 
     /// Get bytes
@@ -507,6 +133,65 @@ impl Ed25519PublicKey {
     }
 }
 
+/// Verify many signatures at once, returning whether all are valid
+///
+/// With random 128-bit weights z_i, checks
+/// 8·(-(Σ z_i·s_i)·B + Σ z_i·R_i + Σ (z_i·k_i)·A_i) = 0
+/// in one multi-scalar product, which shares the doublings of all 2n+1
+/// terms. A forged signature passes only if it cancels against weights it
+/// cannot predict. The check is cofactored, so a signature crafted with a
+/// small-order component can pass here yet fail [`Ed25519PublicKey::verify`];
+/// honest signatures pass or fail both the same way. If no randomness is
+/// available the signatures are checked one by one.
+pub fn verify_batch(
+    messages: &[&[u8]],
+    signatures: &[[u8; 64]],
+    public_keys: &[Ed25519PublicKey],
+) -> bool {
+    let n = signatures.len();
+    if messages.len() != n || public_keys.len() != n {
+        return false;
+    }
+
+    let mut weights = vec![0u8; 16 * n];
+    if crate::random::random_bytes(&mut weights).is_err() {
+        return (0..n).all(|i| public_keys[i].verify(messages[i], &signatures[i]));
+    }
+
+    let mut b = Scalar::ZERO;
+    let mut scalars = Vec::with_capacity(2 * n);
+    let mut points = Vec::with_capacity(2 * n);
+    for i in 0..n {
+        let r_bytes: &[u8; 32] = signatures[i][..32].try_into().unwrap();
+        let s = match Scalar::from_canonical_bytes(signatures[i][32..].try_into().unwrap()) {
+            Some(s) => s,
+            None => return false,
+        };
+        let (r, a) = match (
+            EdwardsPoint::decompress_vartime(r_bytes),
+            EdwardsPoint::decompress_vartime(&public_keys[i].bytes),
+        ) {
+            (Some(r), Some(a)) => (r, a),
+            _ => return false,
+        };
+        let k = hash_to_scalar(&[r_bytes, &public_keys[i].bytes, messages[i]]);
+
+        let mut z = [0u8; 32];
+        z[..16].copy_from_slice(&weights[16 * i..16 * i + 16]);
+        let z = Scalar::from_canonical_bytes(&z).unwrap();
+
+        b = b.add(&z.mul(&s));
+        scalars.push(z);
+        points.push(r);
+        scalars.push(z.mul(&k));
+        points.push(a);
+    }
+
+    multiscalar_mul_vartime(&b.neg(), &scalars, &points)
+        .mul_by_cofactor()
+        .is_identity_vartime()
+}
+
 // ============================================================================
 // C ABI Exports
 // ============================================================================
@@ -602,13 +287,49 @@ pub extern "C" fn ED25519_verify(
 mod tests {
     use super::*;
 
-    #[test]
-    fn test_keypair_generation() {
-        let seed = [0u8; 32];
-        let keypair = Ed25519KeyPair::from_seed(&seed);
+    fn bytes<const N: usize>(hex: &str) -> [u8; N] {
+        crate::encoding::hex_decode(hex)
+            .unwrap()
+            .try_into()
+            .unwrap()
+    }
+
+    /// RFC 8032 section 7.1, tests 1 to 3: (secret, public, message, signature)
+    const RFC8032_VECTORS: [(&str, &str, &str, &str); 3] = [
+        (
+            "9d61b19deffd5a60ba844af492ec2cc44449c5697b326919703bac031cae7f60",
+            "d75a980182b10ab7d54bfed3c964073a0ee172f3daa62325af021a68f707511a",
+            "",
+            "e5564300c360ac729086e2cc806e828a84877f1eb8e5d974d873e06522490155\
+             5fb8821590a33bacc61e39701cf9b46bd25bf5f0595bbe24655141438e7a100b",
+        ),
+        (
+            "4ccd089b28ff96da9db6c346ec114e0f5b8a319f35aba624da8cf6ed4fb8a6fb",
+            "3d4017c3e843895a92b70aa74d1b7ebc9c982ccf2ec4968cc0cd55f12af4660c",
+            "72",
+            "92a009a9f0d4cab8720e820b5f642540a2b27b5416503f8fb3762223ebdb69da\
+             085ac1e43e15996e458f3613d0f11d8c387b2eaeb4302aeeb00d291612bb0c00",
+        ),
+        (
+            "c5aa8df43f9f837bedb7442f31dcb7b166d38535076f094b85ce3a2e0b4458f7",
+            "fc51cd8e6218a1a38da47ed00230f0580816ed13ba3303ac5deb911548908025",
+            "af82",
+            "6291d657deec24024827e69c3abe01a30ce548a284743a445e3680d7db5ac3ac\
+             18ff9b538d16f290ae67f760984dc6594a7c15e9716ed28dc027beceea1ec40a",
+        ),
+    ];
 
-        // Public key should be non-zero
-        assert!(keypair.public_key().iter().any(|&b| b != 0));
+    #[test]
+    fn test_rfc8032_vectors() {
+        for (secret, public, message, signature) in RFC8032_VECTORS {
+            let keypair = Ed25519KeyPair::from_seed(&bytes(secret));
+            assert_eq!(*keypair.public_key(), bytes::<32>(public));
+
+            let message = crate::encoding::hex_decode(message).unwrap();
+            let sig = keypair.sign(&message);
+            assert_eq!(sig, bytes::<64>(signature));
+            assert!(Ed25519PublicKey::from_bytes(&bytes(public)).verify(&message, &sig));
+        }
     }
 
     #[test]
@@ -618,10 +339,53 @@ mod tests {
         let message = b"Hello, World!";
 
         let signature = keypair.sign(message);
-
         let pk = Ed25519PublicKey::from_bytes(keypair.public_key());
-        // Note: Full verification requires complete scalar arithmetic
-        // This is a placeholder test
-        assert_eq!(signature.len(), 64);
+        assert!(pk.verify(message, &signature));
+        assert!(!pk.verify(b"Hello, World?", &signature));
+
+        let mut bad = signature;
+        bad[0] ^= 1;
+        assert!(!pk.verify(message, &bad));
+
+        // s + l encodes the same residue but is not canonical
+        let mut high_s = signature;
+        let l = [
+            0xed, 0xd3, 0xf5, 0x5c, 0x1a, 0x63, 0x12, 0x58, 0xd6, 0x9c, 0xf7, 0xa2, 0xde, 0xf9,
+            0xde, 0x14, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x10,
+        ];
+        let mut carry = 0u16;
+        for (s, l) in high_s[32..].iter_mut().zip(l) {
+            let v = *s as u16 + l as u16 + carry;
+            *s = v as u8;
+            carry = v >> 8;
+        }
+        assert!(!pk.verify(message, &high_s));
+    }
+
+    #[test]
+    fn test_verify_batch() {
+        let keypairs: Vec<Ed25519KeyPair> = (0..8u8)
+            .map(|i| Ed25519KeyPair::from_seed(&[i; 32]))
+            .collect();
+        let messages: Vec<Vec<u8>> = (0..8u8).map(|i| vec![i; i as usize * 10]).collect();
+        let messages: Vec<&[u8]> = messages.iter().map(|m| m.as_slice()).collect();
+        let mut signatures: Vec<[u8; 64]> = keypairs
+            .iter()
+            .zip(&messages)
+            .map(|(kp, m)| kp.sign(m))
+            .collect();
+        let public_keys: Vec<Ed25519PublicKey> = keypairs
+            .iter()
+            .map(|kp| Ed25519PublicKey::from_bytes(kp.public_key()))
+            .collect();
+
+        assert!(verify_batch(&messages, &signatures, &public_keys));
+        assert!(verify_batch(&[], &[], &[]));
+
+        signatures[5][40] ^= 0x10;
+        assert!(!verify_batch(&messages, &signatures, &public_keys));
+        signatures[5][40] ^= 0x10;
+        signatures.swap(1, 2);
+        assert!(!verify_batch(&messages, &signatures, &public_keys));
     }
 }
@@ -0,0 +1,742 @@
+//! The edwards25519 group and its scalars
+//!
+//! Points use extended coordinates (X:Y:Z:T) with x = X/Z, y = Y/Z and
+//! T = XY/Z. Additions go through the "completed" form ((X:Z), (Y:T))
+//! and the cached "Niels" forms of the second operand, as in Hisil, Wong,
+//! Carter and Dawson's unified formulas for a = -1.
+//!
+//! Fixed-base multiplication uses a table of j·256^i·B (j = 1..8, 32 rows)
+//! and a scalar recoded into 64 signed radix-16 digits. It costs 64 mixed
+//! additions and 4 doublings, and each table row is scanned in full. The
+//! variable-time multi-scalar product behind verification uses Straus'
+//! method with wNAF digits, sharing one doubling chain across all points.
+
+use std::sync::OnceLock;
+use std::vec::Vec;
+
+use crate::field25519::Fe;
+use crate::montgomery::{
+    add, from_montgomery, limbs_lt, mont_reduce, mul_wide, sub, to_montgomery, Limbs,
+};
+
+// ============================================================================
+// Scalars (mod l)
+// ============================================================================
+
+/// l = 2^252 + 27742317777372353535851937790883648493, the order of B
+const L: Limbs = [
+    0x5812631a5cf5d3ed,
+    0x14def9dea2f79cd6,
+    0x0000000000000000,
+    0x1000000000000000,
+];
+/// 2^512 mod l
+const L_R2: Limbs = [
+    0xa40611e3449c0f01,
+    0xd00e1ba768859347,
+    0xceec73d217f5be65,
+    0x0399411b7c309a3d,
+];
+/// 2^768 mod l, to bring the high half of a 512-bit value into Montgomery
+/// form
+const L_R3: Limbs = [
+    0x2a9e49687b83a2db,
+    0x278324e6aef7f3ec,
+    0x8065dc6c04ec5b65,
+    0x0e530b773599cec7,
+];
+/// -l^-1 mod 2^64
+const L_INV: u64 = 0xd2b51da312547e1b;
+
+fn limbs_from_le(bytes: &[u8]) -> Limbs {
+    core::array::from_fn(|i| u64::from_le_bytes(bytes[8 * i..8 * i + 8].try_into().unwrap()))
+}
+
+/// Integer modulo l, in Montgomery form and fully reduced
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub struct Scalar(Limbs);
+
+impl Scalar {
+    pub const ZERO: Self = Self([0; 4]);
+
+    /// Parse a little-endian value, rejecting one that is not below l
+    pub fn from_canonical_bytes(bytes: &[u8; 32]) -> Option<Self> {
+        let limbs = limbs_from_le(bytes);
+        if !limbs_lt(&limbs, &L) {
+            return None;
+        }
+        Some(Self(to_montgomery(&limbs, &L_R2, &L, L_INV)))
+    }
+
+    /// Reduce a 512-bit little-endian value, such as a SHA-512 digest
+    ///
+    /// With lo and hi its halves, lo·R2 and hi·R3 reduce to lo·R and
+    /// hi·2^256·R, whose sum is the whole value in Montgomery form.
+    pub fn from_bytes_wide(bytes: &[u8; 64]) -> Self {
+        let lo = mont_reduce(&mul_wide(&limbs_from_le(&bytes[..32]), &L_R2), &L, L_INV);
+        let hi = mont_reduce(&mul_wide(&limbs_from_le(&bytes[32..]), &L_R3), &L, L_INV);
+        Self(add(&lo, &hi, &L))
+    }
+
+    /// Canonical little-endian encoding
+    pub fn to_bytes(&self) -> [u8; 32] {
+        let limbs = from_montgomery(&self.0, &L, L_INV);
+        let mut out = [0u8; 32];
+        for (i, limb) in limbs.iter().enumerate() {
+            out[8 * i..8 * i + 8].copy_from_slice(&limb.to_le_bytes());
+        }
+        out
+    }
+
+    #[inline]
+    pub fn add(&self, other: &Self) -> Self {
+        Self(add(&self.0, &other.0, &L))
+    }
+
+    #[inline]
+    pub fn neg(&self) -> Self {
+        Self(sub(&[0; 4], &self.0, &L))
+    }
+
+    #[inline]
+    pub fn mul(&self, other: &Self) -> Self {
+        Self(mont_reduce(&mul_wide(&self.0, &other.0), &L, L_INV))
+    }
+}
+
+// ============================================================================
+// Point Representations
+// ============================================================================
+
+/// Point in extended coordinates
+#[derive(Clone, Copy, Debug)]
+pub struct EdwardsPoint {
+    x: Fe,
+    y: Fe,
+    z: Fe,
+    t: Fe,
+}
+
+/// (X:Y:Z), enough for doubling
+#[derive(Clone, Copy)]
+struct ProjectivePoint {
+    x: Fe,
+    y: Fe,
+    z: Fe,
+}
+
+/// ((X:Z), (Y:T)), the direct output of the addition formulas
+struct CompletedPoint {
+    x: Fe,
+    y: Fe,
+    z: Fe,
+    t: Fe,
+}
+
+/// (Y+X, Y-X, Z, 2dT), an addend with its sums precomputed
+#[derive(Clone, Copy)]
+struct ProjectiveNiels {
+    y_plus_x: Fe,
+    y_minus_x: Fe,
+    z: Fe,
+    t2d: Fe,
+}
+
+/// (y+x, y-x, 2dxy) of an affine point, for table entries
+#[derive(Clone, Copy)]
+struct AffineNiels {
+    y_plus_x: Fe,
+    y_minus_x: Fe,
+    xy2d: Fe,
+}
+
+impl CompletedPoint {
+    fn to_projective(&self) -> ProjectivePoint {
+        ProjectivePoint {
+            x: self.x.mul(&self.t),
+            y: self.y.mul(&self.z),
+            z: self.z.mul(&self.t),
+        }
+    }
+
+    fn to_extended(&self) -> EdwardsPoint {
+        EdwardsPoint {
+            x: self.x.mul(&self.t),
+            y: self.y.mul(&self.z),
+            z: self.z.mul(&self.t),
+            t: self.x.mul(&self.y),
+        }
+    }
+}
+
+impl ProjectivePoint {
+    fn double(&self) -> CompletedPoint {
+        let xx = self.x.square();
+        let yy = self.y.square();
+        let zz = self.z.square();
+        let zz2 = zz.add(&zz);
+        let x_plus_y_sq = self.x.add(&self.y).square();
+        let yy_plus_xx = yy.add(&xx);
+        let yy_minus_xx = yy.sub(&xx);
+        CompletedPoint {
+            x: x_plus_y_sq.sub(&yy_plus_xx),
+            y: yy_plus_xx,
+            z: yy_minus_xx,
+            t: zz2.sub(&yy_minus_xx),
+        }
+    }
+
+    fn to_extended(&self) -> EdwardsPoint {
+        EdwardsPoint {
+            x: self.x.mul(&self.z),
+            y: self.y.mul(&self.z),
+            z: self.z.square(),
+            t: self.x.mul(&self.y),
+        }
+    }
+}
+
+impl ProjectiveNiels {
+    fn neg(&self) -> Self {
+        Self {
+            y_plus_x: self.y_minus_x,
+            y_minus_x: self.y_plus_x,
+            z: self.z,
+            t2d: self.t2d.neg(),
+        }
+    }
+}
+
+impl AffineNiels {
+    const IDENTITY: Self = Self {
+        y_plus_x: Fe::ONE,
+        y_minus_x: Fe::ONE,
+        xy2d: Fe::ZERO,
+    };
+
+    fn neg(&self) -> Self {
+        Self {
+            y_plus_x: self.y_minus_x,
+            y_minus_x: self.y_plus_x,
+            xy2d: self.xy2d.neg(),
+        }
+    }
+
+    /// `a` where `mask` is 0, `b` where it is all ones
+    fn select(a: &Self, b: &Self, mask: u64) -> Self {
+        Self {
+            y_plus_x: Fe::select(&a.y_plus_x, &b.y_plus_x, mask),
+            y_minus_x: Fe::select(&a.y_minus_x, &b.y_minus_x, mask),
+            xy2d: Fe::select(&a.xy2d, &b.xy2d, mask),
+        }
+    }
+}
+
+// ============================================================================
+// Group Operations
+// ============================================================================
+
+impl EdwardsPoint {
+    pub const IDENTITY: Self = Self {
+        x: Fe::ZERO,
+        y: Fe::ONE,
+        z: Fe::ONE,
+        t: Fe::ZERO,
+    };
+
+    /// The base point B, with y = 4/5 and x positive
+    pub fn basepoint() -> Self {
+        const X: [u8; 32] = [
+            0x1a, 0xd5, 0x25, 0x8f, 0x60, 0x2d, 0x56, 0xc9, 0xb2, 0xa7, 0x25, 0x95, 0x60, 0xc7,
+            0x2c, 0x69, 0x5c, 0xdc, 0xd6, 0xfd, 0x31, 0xe2, 0xa4, 0xc0, 0xfe, 0x53, 0x6e, 0xcd,
+            0xd3, 0x36, 0x69, 0x21,
+        ];
+        const Y: [u8; 32] = [
+            0x58, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66,
+            0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66,
+            0x66, 0x66, 0x66, 0x66,
+        ];
+        let x = Fe::from_bytes(&X);
+        let y = Fe::from_bytes(&Y);
+        Self {
+            x,
+            y,
+            z: Fe::ONE,
+            t: x.mul(&y),
+        }
+    }
+
+    /// Decode a point (variable-time, for public keys and signatures)
+    ///
+    /// RFC 8032 section 5.1.3. A y coordinate that is not below p, or a
+    /// negative zero x, is rejected.
+    pub fn decompress_vartime(bytes: &[u8; 32]) -> Option<Self> {
+        let y = Fe::from_bytes(bytes);
+        let sign = bytes[31] >> 7 == 1;
+        let mut canonical = y.to_bytes();
+        canonical[31] |= bytes[31] & 0x80;
+        if canonical != *bytes {
+            return None;
+        }
+
+        // x^2 = (y^2 - 1) / (d·y^2 + 1)
+        let yy = y.square();
+        let u = yy.sub(&Fe::ONE);
+        let v = yy.mul(&Fe::EDWARDS_D).add(&Fe::ONE);
+        let mut x = Fe::sqrt_ratio_vartime(&u, &v)?;
+        if x.is_zero() && sign {
+            return None;
+        }
+        if x.is_negative() != sign {
+            x = x.neg();
+        }
+        Some(Self {
+            x,
+            y,
+            z: Fe::ONE,
+            t: x.mul(&y),
+        })
+    }
+
+    /// The 32-byte encoding: y, with the sign of x in the top bit
+    pub fn compress(&self) -> [u8; 32] {
+        let z_inv = self.z.invert();
+        let x = self.x.mul(&z_inv);
+        let mut out = self.y.mul(&z_inv).to_bytes();
+        out[31] |= (x.is_negative() as u8) << 7;
+        out
+    }
+
+    /// The u coordinate of the birationally equivalent Montgomery point,
+    /// u = (1 + y) / (1 - y), as X25519 encodes it
+    pub fn to_montgomery_u(&self) -> [u8; 32] {
+        let u = self.z.add(&self.y).mul(&self.z.sub(&self.y).invert());
+        u.to_bytes()
+    }
+
+    pub fn neg(&self) -> Self {
+        Self {
+            x: self.x.neg(),
+            y: self.y,
+            z: self.z,
+            t: self.t.neg(),
+        }
+    }
+
+    fn to_projective(&self) -> ProjectivePoint {
+        ProjectivePoint {
+            x: self.x,
+            y: self.y,
+            z: self.z,
+        }
+    }
+
+    fn to_niels(&self) -> ProjectiveNiels {
+        ProjectiveNiels {
+            y_plus_x: self.y.add(&self.x),
+            y_minus_x: self.y.sub(&self.x),
+            z: self.z,
+            t2d: self.t.mul(&Fe::EDWARDS_D2),
+        }
+    }
+
+    fn add_niels(&self, q: &ProjectiveNiels) -> CompletedPoint {
+        let pp = self.y.add(&self.x).mul(&q.y_plus_x);
+        let mm = self.y.sub(&self.x).mul(&q.y_minus_x);
+        let tt2d = self.t.mul(&q.t2d);
+        let zz = self.z.mul(&q.z);
+        let zz2 = zz.add(&zz);
+        CompletedPoint {
+            x: pp.sub(&mm),
+            y: pp.add(&mm),
+            z: zz2.add(&tt2d),
+            t: zz2.sub(&tt2d),
+        }
+    }
+
+    fn add_affine_niels(&self, q: &AffineNiels) -> CompletedPoint {
+        let pp = self.y.add(&self.x).mul(&q.y_plus_x);
+        let mm = self.y.sub(&self.x).mul(&q.y_minus_x);
+        let tt2d = self.t.mul(&q.xy2d);
+        let zz2 = self.z.add(&self.z);
+        CompletedPoint {
+            x: pp.sub(&mm),
+            y: pp.add(&mm),
+            z: zz2.add(&tt2d),
+            t: zz2.sub(&tt2d),
+        }
+    }
+
+    pub fn add(&self, other: &Self) -> Self {
+        self.add_niels(&other.to_niels()).to_extended()
+    }
+
+    pub fn double(&self) -> Self {
+        self.to_projective().double().to_extended()
+    }
+
+    /// 2^k·P, staying in projective form between doublings
+    fn mul_by_pow2(&self, k: u32) -> Self {
+        let mut p = self.to_projective();
+        for _ in 1..k {
+            p = p.double().to_projective();
+        }
+        p.double().to_extended()
+    }
+
+    /// 8·P, clearing any small-order component
+    pub fn mul_by_cofactor(&self) -> Self {
+        self.mul_by_pow2(3)
+    }
+
+    /// X = 0 and Y = Z (variable-time)
+    pub fn is_identity_vartime(&self) -> bool {
+        self.x.is_zero() && self.y.sub(&self.z).is_zero()
+    }
+}
+
+/// Affine Niels forms of many points with a single inversion
+fn batch_to_affine_niels(points: &[EdwardsPoint]) -> Vec<AffineNiels> {
+    let mut prefix = Vec::with_capacity(points.len());
+    let mut acc = Fe::ONE;
+    for p in points {
+        prefix.push(acc);
+        acc = acc.mul(&p.z);
+    }
+
+    let mut inv = acc.invert();
+    let mut out = vec![AffineNiels::IDENTITY; points.len()];
+    for i in (0..points.len()).rev() {
+        let z_inv = inv.mul(&prefix[i]);
+        inv = inv.mul(&points[i].z);
+        let x = points[i].x.mul(&z_inv);
+        let y = points[i].y.mul(&z_inv);
+        out[i] = AffineNiels {
+            y_plus_x: y.add(&x),
+            y_minus_x: y.sub(&x),
+            xy2d: x.mul(&y).mul(&Fe::EDWARDS_D2),
+        };
+    }
+    out
+}
+
+// ============================================================================
+// Fixed-Base Multiplication
+// ============================================================================
+
+/// Row i holds j·256^i·B for j = 1..8
+type BaseTable = [[AffineNiels; 8]; 32];
+
+fn base_table() -> &'static BaseTable {
+    static TABLE: OnceLock<BaseTable> = OnceLock::new();
+    TABLE.get_or_init(|| {
+        let mut points = Vec::with_capacity(32 * 8);
+        let mut row_base = EdwardsPoint::basepoint();
+        for _ in 0..32 {
+            let mut multiple = row_base;
+            for _ in 0..8 {
+                points.push(multiple);
+                multiple = multiple.add(&row_base);
+            }
+            row_base = row_base.mul_by_pow2(8);
+        }
+
+        let affine = batch_to_affine_niels(&points);
+        core::array::from_fn(|i| core::array::from_fn(|j| affine[8 * i + j]))
+    })
+}
+
+/// k as 64 digits in [-8, 8] with k = Σ e_i·16^i; needs k < 2^255
+fn radix16(k: &[u8; 32]) -> [i8; 64] {
+    let mut e = [0i8; 64];
+    for (i, &byte) in k.iter().enumerate() {
+        e[2 * i] = (byte & 15) as i8;
+        e[2 * i + 1] = (byte >> 4) as i8;
+    }
+    // Recenter each digit from [0, 15] to [-8, 7], carrying into the next;
+    // the top digit keeps the last carry
+    for i in 0..63 {
+        let carry = (e[i] + 8) >> 4;
+        e[i] -= carry << 4;
+        e[i + 1] += carry;
+    }
+    e
+}
+
+/// digit·(row base), scanning the whole row
+fn lookup(row: &[AffineNiels; 8], digit: i8) -> AffineNiels {
+    let negative = (digit >> 7) as i64 as u64;
+    let abs = (digit as i64 ^ negative as i64).wrapping_sub(negative as i64) as u64;
+
+    let mut q = AffineNiels::IDENTITY;
+    for (j, entry) in row.iter().enumerate() {
+        let mask = (((abs ^ (j as u64 + 1)).wrapping_sub(1)) >> 63).wrapping_neg();
+        q = AffineNiels::select(&q, entry, mask);
+    }
+    AffineNiels::select(&q, &q.neg(), negative)
+}
+
+/// k·B (constant-time); k must be below 2^255, as clamped and reduced
+/// scalars are
+pub fn mul_base(k: &[u8; 32]) -> EdwardsPoint {
+    let table = base_table();
+    let e = radix16(k);
+
+    // The odd digits first, shifted up by one 16 at the end, so that all
+    // 64 digits share the 32 rows of 256^i
+    let mut acc = EdwardsPoint::IDENTITY;
+    for i in (1..64).step_by(2) {
+        acc = acc
+            .add_affine_niels(&lookup(&table[i / 2], e[i]))
+            .to_extended();
+    }
+    acc = acc.mul_by_pow2(4);
+    for i in (0..64).step_by(2) {
+        acc = acc
+            .add_affine_niels(&lookup(&table[i / 2], e[i]))
+            .to_extended();
+    }
+    acc
+}
+
+// ============================================================================
+// Variable-Time Multi-Scalar Multiplication
+// ============================================================================
+
+/// B, 3B, ..., 127B for width-8 wNAF
+fn base_odd_multiples() -> &'static [AffineNiels; 64] {
+    static TABLE: OnceLock<[AffineNiels; 64]> = OnceLock::new();
+    TABLE.get_or_init(|| {
+        let b = EdwardsPoint::basepoint();
+        let b2 = b.double();
+        let mut points = Vec::with_capacity(64);
+        points.push(b);
+        for i in 1..64 {
+            points.push(points[i - 1].add(&b2));
+        }
+        batch_to_affine_niels(&points).try_into().ok().unwrap()
+    })
+}
+
+/// P, 3P, ..., 15P for width-5 wNAF
+fn odd_multiples(p: &EdwardsPoint) -> [ProjectiveNiels; 8] {
+    let p2 = p.double();
+    let mut multiple = *p;
+    core::array::from_fn(|_| {
+        let niels = multiple.to_niels();
+        multiple = multiple.add_niels(&p2.to_niels()).to_extended();
+        niels
+    })
+}
+
+/// Width-w non-adjacent form of a little-endian scalar below 2^255: odd
+/// digits below 2^(w-1) in magnitude, at least w-1 zeros after each
+fn wnaf(k: &[u8; 32], w: u32) -> [i8; 256] {
+    // A spare limb for the carries of negative digits
+    let mut limbs = [0u64; 5];
+    limbs[..4].copy_from_slice(&limbs_from_le(k));
+
+    let window = 1i64 << w;
+    let mut digits = [0i8; 256];
+    let mut i = 0;
+    while limbs.iter().any(|&l| l != 0) {
+        if limbs[0] & 1 == 1 {
+            let mut d = (limbs[0] & (window as u64 - 1)) as i64;
+            if d >= window / 2 {
+                d -= window;
+            }
+            digits[i] = d as i8;
+
+            // Subtract d, leaving a multiple of 2^w
+            let (mut borrow, mut carry) = if d > 0 {
+                (d as u64, 0)
+            } else {
+                (0, (-d) as u64)
+            };
+            for limb in limbs.iter_mut() {
+                let (v, b) = limb.overflowing_sub(borrow);
+                let (v, c) = v.overflowing_add(carry);
+                *limb = v;
+                borrow = b as u64;
+                carry = c as u64;
+            }
+        }
+        for j in 0..4 {
+            limbs[j] = (limbs[j] >> 1) | (limbs[j + 1] << 63);
+        }
+        limbs[4] >>= 1;
+        i += 1;
+    }
+    digits
+}
+
+/// b·B + Σ scalars[i]·points[i] (variable-time, Straus)
+///
+/// Every scalar is recoded to wNAF and all of them are added in along
+/// one shared chain of doublings, so each extra point costs only its
+/// additions. B uses a wider window from its static table.
+pub fn multiscalar_mul_vartime(
+    b: &Scalar,
+    scalars: &[Scalar],
+    points: &[EdwardsPoint],
+) -> EdwardsPoint {
+    let b_table = base_odd_multiples();
+    let b_digits = wnaf(&b.to_bytes(), 8);
+    let tables: Vec<[ProjectiveNiels; 8]> = points.iter().map(odd_multiples).collect();
+    let digits: Vec<[i8; 256]> = scalars.iter().map(|s| wnaf(&s.to_bytes(), 5)).collect();
+
+    let top = match (0..256)
+        .rev()
+        .find(|&i| b_digits[i] != 0 || digits.iter().any(|d| d[i] != 0))
+    {
+        Some(top) => top,
+        None => return EdwardsPoint::IDENTITY,
+    };
+
+    let mut acc = EdwardsPoint::IDENTITY.to_projective();
+    for i in (0..=top).rev() {
+        let mut sum = acc.double();
+        let d = b_digits[i];
+        if d > 0 {
+            sum = sum
+                .to_extended()
+                .add_affine_niels(&b_table[(d >> 1) as usize]);
+        } else if d < 0 {
+            sum = sum
+                .to_extended()
+                .add_affine_niels(&b_table[(-d >> 1) as usize].neg());
+        }
+        for (table, digits) in tables.iter().zip(&digits) {
+            let d = digits[i];
+            if d > 0 {
+                sum = sum.to_extended().add_niels(&table[(d >> 1) as usize]);
+            } else if d < 0 {
+                sum = sum
+                    .to_extended()
+                    .add_niels(&table[(-d >> 1) as usize].neg());
+            }
+        }
+        acc = sum.to_projective();
+    }
+    acc.to_extended()
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn scalar(i: u8) -> [u8; 32] {
+        let mut k = [0u8; 32];
+        for (j, b) in k.iter_mut().enumerate() {
+            *b = (j as u8).wrapping_mul(113).wrapping_add(i.wrapping_mul(59));
+        }
+        k[31] &= 0x0f;
+        k
+    }
+
+    /// k·P by plain double-and-add
+    fn mul_reference(p: &EdwardsPoint, k: &[u8; 32]) -> EdwardsPoint {
+        let mut acc = EdwardsPoint::IDENTITY;
+        for i in (0..256).rev() {
+            acc = acc.double();
+            if (k[i / 8] >> (i % 8)) & 1 == 1 {
+                acc = acc.add(p);
+            }
+        }
+        acc
+    }
+
+    #[test]
+    fn test_scalar_arithmetic() {
+        let mut l = [0u8; 32];
+        for (i, limb) in L.iter().enumerate() {
+            l[8 * i..8 * i + 8].copy_from_slice(&limb.to_le_bytes());
+        }
+        assert!(Scalar::from_canonical_bytes(&l).is_none());
+
+        // l·2^256 + l + 5 reduces to 5
+        let mut wide = [0u8; 64];
+        wide[..32].copy_from_slice(&l);
+        wide[32..].copy_from_slice(&l);
+        wide[0] += 5;
+        let mut five = [0u8; 32];
+        five[0] = 5;
+        assert_eq!(Scalar::from_bytes_wide(&wide).to_bytes(), five);
+
+        let a = Scalar::from_canonical_bytes(&scalar(1)).unwrap();
+        assert_eq!(a.add(&a.neg()), Scalar::ZERO);
+        let a2 = a.add(&a);
+        let two = Scalar::from_canonical_bytes(&{
+            let mut t = [0u8; 32];
+            t[0] = 2;
+            t
+        })
+        .unwrap();
+        assert_eq!(a.mul(&two), a2);
+    }
+
+    #[test]
+    fn test_basepoint_order_and_encoding() {
+        let b = EdwardsPoint::basepoint();
+        let mut l = [0u8; 32];
+        for (i, limb) in L.iter().enumerate() {
+            l[8 * i..8 * i + 8].copy_from_slice(&limb.to_le_bytes());
+        }
+        assert!(mul_reference(&b, &l).is_identity_vartime());
+        assert!(mul_base(&l).is_identity_vartime());
+
+        let encoded = b.compress();
+        assert_eq!(encoded[0], 0x58);
+        let decoded = EdwardsPoint::decompress_vartime(&encoded).unwrap();
+        assert_eq!(decoded.compress(), encoded);
+        assert_eq!(b.to_montgomery_u()[0], 9);
+    }
+
+    #[test]
+    fn test_mul_base_matches_reference() {
+        let b = EdwardsPoint::basepoint();
+        for i in 0..6 {
+            let k = scalar(i);
+            assert_eq!(mul_base(&k).compress(), mul_reference(&b, &k).compress());
+        }
+        let mut top = [0xffu8; 32];
+        top[31] = 0x7f;
+        assert_eq!(
+            mul_base(&top).compress(),
+            mul_reference(&b, &top).compress()
+        );
+    }
+
+    #[test]
+    fn test_multiscalar_matches_reference() {
+        let b = EdwardsPoint::basepoint();
+        let p = mul_base(&scalar(7));
+        let q = mul_base(&scalar(8));
+        let (kb, kp, kq) = (scalar(9), scalar(10), scalar(11));
+        let expected = mul_reference(&b, &kb)
+            .add(&mul_reference(&p, &kp))
+            .add(&mul_reference(&q, &kq));
+
+        let s = |k: &[u8; 32]| Scalar::from_canonical_bytes(k).unwrap();
+        let got = multiscalar_mul_vartime(&s(&kb), &[s(&kp), s(&kq)], &[p, q]);
+        assert_eq!(got.compress(), expected.compress());
+    }
+
+    #[test]
+    fn test_decompress_rejects_invalid() {
+        // y = p is not canonical
+        let mut p = [0xffu8; 32];
+        p[0] = 0xed;
+        p[31] = 0x7f;
+        assert!(EdwardsPoint::decompress_vartime(&p).is_none());
+        // y = 2 has no x
+        let mut two = [0u8; 32];
+        two[0] = 2;
+        assert!(EdwardsPoint::decompress_vartime(&two).is_none());
+        // The identity with a negative zero x
+        let mut neg_zero = [0u8; 32];
+        neg_zero[0] = 1;
+        neg_zero[31] = 0x80;
+        assert!(EdwardsPoint::decompress_vartime(&neg_zero).is_none());
+    }
+}
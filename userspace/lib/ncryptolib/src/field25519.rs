@@ -0,0 +1,335 @@
+//! Arithmetic in GF(2^255 - 19)
+//!
+//! Elements are five 51-bit limbs in 64-bit words. The 13 spare bits let
+//! additions skip carrying, and a product of two limbs fits a 128-bit
+//! word, so multiplication is 25 `u64 × u64 → u128` products with the
+//! wrap-around terms scaled by 19 (2^255 ≡ 19), followed by one carry
+//! pass. Shared by X25519 and Ed25519.
+//!
+//! Every operation but [`Fe::add`] leaves limbs below 2^52. Multiplication
+//! and subtraction accept limbs up to 2^54, so a sum of up to four such
+//! values can go into them without a carry pass. Nothing branches on or
+//! indexes memory by element values.
+
+const MASK51: u64 = (1 << 51) - 1;
+
+/// Element of GF(2^255 - 19), not necessarily fully reduced
+#[derive(Clone, Copy, Debug)]
+pub struct Fe([u64; 5]);
+
+#[inline(always)]
+fn m(a: u64, b: u64) -> u128 {
+    a as u128 * b as u128
+}
+
+impl Fe {
+    pub const ZERO: Self = Self([0; 5]);
+    pub const ONE: Self = Self([1, 0, 0, 0, 0]);
+    /// The Edwards curve constant d = -121665/121666
+    pub const EDWARDS_D: Self = Self([
+        0x34dca135978a3,
+        0x1a8283b156ebd,
+        0x5e7a26001c029,
+        0x739c663a03cbb,
+        0x52036cee2b6ff,
+    ]);
+    /// 2d
+    pub const EDWARDS_D2: Self = Self([
+        0x69b9426b2f159,
+        0x35050762add7a,
+        0x3cf44c0038052,
+        0x6738cc7407977,
+        0x2406d9dc56dff,
+    ]);
+    /// sqrt(-1) = 2^((p-1)/4)
+    const SQRT_M1: Self = Self([
+        0x61b274a0ea0b0,
+        0x0d5a5fc8f189d,
+        0x7ef5e9cbd0c60,
+        0x78595a6804c9e,
+        0x2b8324804fc1d,
+    ]);
+
+    /// Parse 32 little-endian bytes, ignoring the top bit (values up to
+    /// 2^255 - 1 are accepted, as RFC 7748 requires)
+    pub fn from_bytes(bytes: &[u8; 32]) -> Self {
+        let load = |at: usize| u64::from_le_bytes(bytes[at..at + 8].try_into().unwrap());
+        Self([
+            load(0) & MASK51,
+            (load(6) >> 3) & MASK51,
+            (load(12) >> 6) & MASK51,
+            (load(19) >> 1) & MASK51,
+            (load(24) >> 12) & MASK51,
+        ])
+    }
+
+    /// Canonical little-endian encoding
+    pub fn to_bytes(&self) -> [u8; 32] {
+        let mut h = self.carry().0;
+
+        // h is now below 2p, so h >= p exactly when h + 19 carries out of
+        // 2^255; fold that carry back in as another 19
+        let mut q = (h[0] + 19) >> 51;
+        for limb in &h[1..] {
+            q = (limb + q) >> 51;
+        }
+        h[0] += 19 * q;
+        for i in 0..4 {
+            h[i + 1] += h[i] >> 51;
+            h[i] &= MASK51;
+        }
+        h[4] &= MASK51;
+
+        let mut out = [0u8; 32];
+        let mut acc = 0u128;
+        let mut bits = 0;
+        let mut at = 0;
+        for limb in h {
+            acc |= (limb as u128) << bits;
+            bits += 51;
+            while bits >= 8 {
+                out[at] = acc as u8;
+                acc >>= 8;
+                bits -= 8;
+                at += 1;
+            }
+        }
+        out[at] = acc as u8;
+        out
+    }
+
+    /// One carry pass, bringing every limb below 2^51 + 2^13·19
+    #[inline(always)]
+    fn carry(&self) -> Self {
+        let h = self.0;
+        let c: [u64; 5] = core::array::from_fn(|i| h[i] >> 51);
+        Self([
+            (h[0] & MASK51) + c[4] * 19,
+            (h[1] & MASK51) + c[0],
+            (h[2] & MASK51) + c[1],
+            (h[3] & MASK51) + c[2],
+            (h[4] & MASK51) + c[3],
+        ])
+    }
+
+    /// Carry a 5-word product back down to 51-bit limbs
+    #[inline(always)]
+    fn carry_wide(mut c: [u128; 5]) -> Self {
+        let mut h = [0u64; 5];
+        for i in 0..4 {
+            c[i + 1] += c[i] >> 51;
+            h[i] = c[i] as u64 & MASK51;
+        }
+        h[4] = c[4] as u64 & MASK51;
+        h[0] += (c[4] >> 51) as u64 * 19;
+        h[1] += h[0] >> 51;
+        h[0] &= MASK51;
+        Self(h)
+    }
+
+    /// Sum without carrying
+    #[inline(always)]
+    pub fn add(&self, other: &Self) -> Self {
+        Self(core::array::from_fn(|i| self.0[i] + other.0[i]))
+    }
+
+    #[inline(always)]
+    pub fn sub(&self, other: &Self) -> Self {
+        // Add 16p first so no limb goes negative
+        const P16: [u64; 5] = [
+            16 * (MASK51 - 18),
+            16 * MASK51,
+            16 * MASK51,
+            16 * MASK51,
+            16 * MASK51,
+        ];
+        Self(core::array::from_fn(|i| self.0[i] + P16[i] - other.0[i])).carry()
+    }
+
+    #[inline(always)]
+    pub fn neg(&self) -> Self {
+        Self::ZERO.sub(self)
+    }
+
+    #[inline(always)]
+    pub fn mul(&self, other: &Self) -> Self {
+        let a = &self.0;
+        let b = &other.0;
+        let b1_19 = b[1] * 19;
+        let b2_19 = b[2] * 19;
+        let b3_19 = b[3] * 19;
+        let b4_19 = b[4] * 19;
+
+        Self::carry_wide([
+            m(a[0], b[0]) + m(a[4], b1_19) + m(a[3], b2_19) + m(a[2], b3_19) + m(a[1], b4_19),
+            m(a[1], b[0]) + m(a[0], b[1]) + m(a[4], b2_19) + m(a[3], b3_19) + m(a[2], b4_19),
+            m(a[2], b[0]) + m(a[1], b[1]) + m(a[0], b[2]) + m(a[4], b3_19) + m(a[3], b4_19),
+            m(a[3], b[0]) + m(a[2], b[1]) + m(a[1], b[2]) + m(a[0], b[3]) + m(a[4], b4_19),
+            m(a[4], b[0]) + m(a[3], b[1]) + m(a[2], b[2]) + m(a[1], b[3]) + m(a[0], b[4]),
+        ])
+    }
+
+    /// a·a with each cross product formed once (15 multiplications)
+    #[inline(always)]
+    pub fn square(&self) -> Self {
+        let a = &self.0;
+        let a3_19 = a[3] * 19;
+        let a4_19 = a[4] * 19;
+        let d0 = a[0] * 2;
+        let d1 = a[1] * 2;
+        let d2 = a[2] * 2;
+
+        Self::carry_wide([
+            m(a[0], a[0]) + m(d1, a4_19) + m(d2, a3_19),
+            m(a[3], a3_19) + m(d0, a[1]) + m(d2, a4_19),
+            m(a[1], a[1]) + m(d0, a[2]) + m(a[4] * 2, a3_19),
+            m(a[4], a4_19) + m(d0, a[3]) + m(d1, a[2]),
+            m(a[2], a[2]) + m(d0, a[4]) + m(d1, a[3]),
+        ])
+    }
+
+    /// a^(2^n)
+    pub fn square_n(&self, n: usize) -> Self {
+        let mut a = *self;
+        for _ in 0..n {
+            a = a.square();
+        }
+        a
+    }
+
+    /// a·k for a small constant k
+    #[inline(always)]
+    pub fn mul_small(&self, k: u32) -> Self {
+        Self::carry_wide(core::array::from_fn(|i| m(self.0[i], k as u64)))
+    }
+
+    /// (a^(2^250 - 1), a^11), the common prefix of the exponents of
+    /// [`Fe::invert`] and [`Fe::pow_p58`]
+    fn pow22501(&self) -> (Self, Self) {
+        let t2 = self.square();
+        let t9 = t2.square_n(2).mul(self);
+        let t11 = t9.mul(&t2);
+        // xN = a^(2^N - 1)
+        let x5 = t11.square().mul(&t9);
+        let x10 = x5.square_n(5).mul(&x5);
+        let x20 = x10.square_n(10).mul(&x10);
+        let x40 = x20.square_n(20).mul(&x20);
+        let x50 = x40.square_n(10).mul(&x10);
+        let x100 = x50.square_n(50).mul(&x50);
+        let x200 = x100.square_n(100).mul(&x100);
+        let x250 = x200.square_n(50).mul(&x50);
+        (x250, t11)
+    }
+
+    /// a^-1 = a^(p-2) = a^(2^255 - 21), or zero for zero
+    pub fn invert(&self) -> Self {
+        let (x250, t11) = self.pow22501();
+        x250.square_n(5).mul(&t11)
+    }
+
+    /// a^((p-5)/8) = a^(2^252 - 3)
+    fn pow_p58(&self) -> Self {
+        let (x250, _) = self.pow22501();
+        x250.square_n(2).mul(self)
+    }
+
+    /// sqrt(u/v), if it exists (variable-time, for decoding public points)
+    ///
+    /// RFC 8032 section 5.1.3: the candidate u·v^3·(u·v^7)^((p-5)/8) is
+    /// either a root or a root times sqrt(-1).
+    pub fn sqrt_ratio_vartime(u: &Self, v: &Self) -> Option<Self> {
+        let v3 = v.square().mul(v);
+        let v7 = v3.square().mul(v);
+        let x = u.mul(&v3).mul(&u.mul(&v7).pow_p58());
+
+        let vxx = v.mul(&x.square());
+        if vxx.sub(u).is_zero() {
+            Some(x)
+        } else if vxx.add(u).is_zero() {
+            Some(x.mul(&Self::SQRT_M1))
+        } else {
+            None
+        }
+    }
+
+    pub fn is_zero(&self) -> bool {
+        self.to_bytes().iter().fold(0, |acc, &b| acc | b) == 0
+    }
+
+    /// The low bit of the canonical encoding, the sign used by point
+    /// compression
+    pub fn is_negative(&self) -> bool {
+        self.to_bytes()[0] & 1 == 1
+    }
+
+    /// `a` where `mask` is 0, `b` where it is all ones
+    #[inline(always)]
+    pub fn select(a: &Self, b: &Self, mask: u64) -> Self {
+        Self(core::array::from_fn(|i| {
+            a.0[i] ^ ((a.0[i] ^ b.0[i]) & mask)
+        }))
+    }
+
+    /// Swap `a` and `b` where `mask` is all ones
+    #[inline(always)]
+    pub fn cswap(a: &mut Self, b: &mut Self, mask: u64) {
+        for i in 0..5 {
+            let t = (a.0[i] ^ b.0[i]) & mask;
+            a.0[i] ^= t;
+            b.0[i] ^= t;
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn fe(hex: &str) -> Fe {
+        let bytes: [u8; 32] = crate::encoding::hex_decode(hex)
+            .unwrap()
+            .try_into()
+            .unwrap();
+        Fe::from_bytes(&bytes)
+    }
+
+    #[test]
+    fn test_field_arithmetic() {
+        // Little-endian values checked against Python integers
+        let a = fe("1ad5258f602d56c9b2a7259560c72c695cdcd6fd31e2a4c0fe536ecdd3366921");
+        let b = fe("5866666666666666666666666666666666666666666666666666666666666666");
+        assert_eq!(
+            a.mul(&b).to_bytes(),
+            fe("a3ddb7a5b38ade6df5525177809ff0207de3ab648e4eea6665768bd70f5f8767").to_bytes()
+        );
+        assert_eq!(a.square().to_bytes(), a.mul(&a).to_bytes());
+        assert_eq!(a.mul(&a.invert()).to_bytes(), Fe::ONE.to_bytes());
+        assert!(a.neg().add(&a).is_zero());
+        assert!(Fe::SQRT_M1.square().add(&Fe::ONE).is_zero());
+    }
+
+    #[test]
+    fn test_canonical_encoding() {
+        // p and p + 1 encode as 0 and 1
+        let p = fe("edffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff7f");
+        assert_eq!(p.to_bytes(), [0; 32]);
+        let p1 = fe("eeffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff7f");
+        assert_eq!(p1.to_bytes(), Fe::ONE.to_bytes());
+        // The largest limbs a subtraction can leave behind still encode
+        // canonically
+        let minus_one = Fe::ZERO.sub(&Fe::ONE);
+        assert_eq!(
+            minus_one.to_bytes(),
+            fe("ecffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff7f").to_bytes()
+        );
+    }
+
+    #[test]
+    fn test_sqrt_ratio() {
+        let four = Fe::ONE.mul_small(4);
+        let two = Fe::sqrt_ratio_vartime(&four, &Fe::ONE).unwrap();
+        assert_eq!(two.square().to_bytes(), four.to_bytes());
+        // 2 is not a square mod p
+        assert!(Fe::sqrt_ratio_vartime(&Fe::ONE.mul_small(2), &Fe::ONE).is_none());
+    }
+}
@@ -0,0 +1,125 @@
+//! GHASH universal hash for AES-GCM (SP 800-38D)
+//!
+//! With AES-NI available the multiply runs on `PCLMULQDQ` (see
+//! [`aes_ni`](crate::aes_ni)). The portable multiply is constant-time:
+//! carry-less products come from ordinary integer multiplications of
+//! operands with every fourth bit masked out, so the carries land in bits
+//! that are discarded. There are no data-dependent branches or table
+//! lookups.
+
+#[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+use crate::{aes_ni::ClmulGhash, cpu};
+
+/// Hash subkey prepared for the selected implementation
+#[derive(Clone)]
+pub enum GhashKey {
+    #[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+    Clmul(ClmulGhash),
+    /// H as big-endian halves (high, low)
+    Soft(u64, u64),
+}
+
+impl GhashKey {
+    /// Prepare `h` = E_K(0^128)
+    pub fn new(h: &[u8; 16]) -> Self {
+        #[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+        if cpu::has_aes_ni() {
+            // SAFETY: PCLMULQDQ and SSSE3 were detected
+            return GhashKey::Clmul(unsafe { ClmulGhash::new(h) });
+        }
+        GhashKey::Soft(
+            u64::from_be_bytes(h[..8].try_into().unwrap()),
+            u64::from_be_bytes(h[8..].try_into().unwrap()),
+        )
+    }
+
+    /// Absorb `data` into the running hash `y`; a trailing partial block is
+    /// zero-padded
+    pub fn update(&self, y: &mut [u8; 16], data: &[u8]) {
+        match self {
+            #[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+            // SAFETY: only constructed when the CPU supports it
+            GhashKey::Clmul(key) => unsafe { key.update(y, data) },
+            GhashKey::Soft(h1, h0) => soft_update(*h1, *h0, y, data),
+        }
+    }
+}
+
+/// Carry-less 64x64 multiply, low 64 bits of the product
+#[inline(always)]
+fn bmul64(x: u64, y: u64) -> u64 {
+    const M0: u64 = 0x1111111111111111;
+    const M1: u64 = 0x2222222222222222;
+    const M2: u64 = 0x4444444444444444;
+    const M3: u64 = 0x8888888888888888;
+
+    let (x0, x1, x2, x3) = (x & M0, x & M1, x & M2, x & M3);
+    let (y0, y1, y2, y3) = (y & M0, y & M1, y & M2, y & M3);
+    let m = |a: u64, b: u64| a.wrapping_mul(b);
+
+    let z0 = m(x0, y0) ^ m(x1, y3) ^ m(x2, y2) ^ m(x3, y1);
+    let z1 = m(x0, y1) ^ m(x1, y0) ^ m(x2, y3) ^ m(x3, y2);
+    let z2 = m(x0, y2) ^ m(x1, y1) ^ m(x2, y0) ^ m(x3, y3);
+    let z3 = m(x0, y3) ^ m(x1, y2) ^ m(x2, y1) ^ m(x3, y0);
+    (z0 & M0) | (z1 & M1) | (z2 & M2) | (z3 & M3)
+}
+
+fn soft_update(h1: u64, h0: u64, y: &mut [u8; 16], data: &[u8]) {
+    // GHASH is bit-reflected: the high half of each product is the low
+    // half of the product of the bit-reversed operands
+    let h0r = h0.reverse_bits();
+    let h1r = h1.reverse_bits();
+    let h2 = h0 ^ h1;
+    let h2r = h0r ^ h1r;
+
+    let mut y1 = u64::from_be_bytes(y[..8].try_into().unwrap());
+    let mut y0 = u64::from_be_bytes(y[8..].try_into().unwrap());
+
+    for chunk in data.chunks(16) {
+        let mut block = [0u8; 16];
+        block[..chunk.len()].copy_from_slice(chunk);
+        y1 ^= u64::from_be_bytes(block[..8].try_into().unwrap());
+        y0 ^= u64::from_be_bytes(block[8..].try_into().unwrap());
+
+        // Karatsuba over the two halves
+        let y0r = y0.reverse_bits();
+        let y1r = y1.reverse_bits();
+        let y2 = y0 ^ y1;
+        let y2r = y0r ^ y1r;
+
+        let z0 = bmul64(y0, h0);
+        let z1 = bmul64(y1, h1);
+        let mut z2 = bmul64(y2, h2);
+        let mut z0h = bmul64(y0r, h0r);
+        let mut z1h = bmul64(y1r, h1r);
+        let mut z2h = bmul64(y2r, h2r);
+        z2 ^= z0 ^ z1;
+        z2h ^= z0h ^ z1h;
+        z0h = z0h.reverse_bits() >> 1;
+        z1h = z1h.reverse_bits() >> 1;
+        z2h = z2h.reverse_bits() >> 1;
+
+        let mut v0 = z0;
+        let mut v1 = z0h ^ z2;
+        let mut v2 = z1 ^ z2h;
+        let mut v3 = z1h;
+
+        // Shift the 256-bit product left by one, then reduce modulo
+        // x^128 + x^7 + x^2 + x + 1
+        v3 = (v3 << 1) | (v2 >> 63);
+        v2 = (v2 << 1) | (v1 >> 63);
+        v1 = (v1 << 1) | (v0 >> 63);
+        v0 <<= 1;
+
+        v2 ^= v0 ^ (v0 >> 1) ^ (v0 >> 2) ^ (v0 >> 7);
+        v1 ^= (v0 << 63) ^ (v0 << 62) ^ (v0 << 57);
+        v3 ^= v1 ^ (v1 >> 1) ^ (v1 >> 2) ^ (v1 >> 7);
+        v2 ^= (v1 << 63) ^ (v1 << 62) ^ (v1 << 57);
+
+        y0 = v2;
+        y1 = v3;
+    }
+
+    y[..8].copy_from_slice(&y1.to_be_bytes());
+    y[8..].copy_from_slice(&y0.to_be_bytes());
+}
@@ -4,7 +4,10 @@
 
 use std::vec::Vec;
 
-use crate::hash::{hmac_sha256, sha512, HmacSha256, SHA256_DIGEST_SIZE};
+use crate::hash::{compress256, compress256_lanes, compress512, compress512_lanes};
+use crate::hash::{hmac_sha256, sha256, sha512, HmacSha256};
+use crate::hash::{SHA256_BLOCK_SIZE, SHA256_DIGEST_SIZE, SHA256_H};
+use crate::hash::{SHA512_BLOCK_SIZE, SHA512_DIGEST_SIZE, SHA512_H};
 
 // ============================================================================
 // HKDF (HMAC-based Key Derivation Function)
@@ -29,9 +32,10 @@ pub fn hkdf_expand_sha256(prk: &[u8; SHA256_DIGEST_SIZE], info: &[u8], length: u
     let n = (length + SHA256_DIGEST_SIZE - 1) / SHA256_DIGEST_SIZE;
     let mut okm = Vec::with_capacity(n * SHA256_DIGEST_SIZE);
     let mut t = [0u8; SHA256_DIGEST_SIZE];
+    let keyed = HmacSha256::new(prk);
 
     for i in 1..=n {
-        let mut hmac = HmacSha256::new(prk);
+        let mut hmac = keyed.clone();
         if i > 1 {
             hmac.update(&t);
         }
@@ -341,65 +345,155 @@ pub fn tls12_key_block(
 
 /// PBKDF2 with HMAC-SHA256
 ///
+/// After U_1, every U_i is the HMAC of a single digest, which is one
+/// pre-padded block through the ipad state and one through the opad state.
+/// Those states are computed once, and all output blocks advance together
+/// through the multi-buffer compression.
+///
 /// # Arguments
 /// * `password` - The password
 /// * `salt` - The salt
 /// * `iterations` - Number of iterations (minimum 10000 recommended)
 /// * `dk_len` - Desired key length
 pub fn pbkdf2_sha256(password: &[u8], salt: &[u8], iterations: u32, dk_len: usize) -> Vec<u8> {
-    let h_len = SHA256_DIGEST_SIZE;
-    let l = (dk_len + h_len - 1) / h_len;
-    let mut dk = Vec::with_capacity(l * h_len);
-
-    for i in 1..=l as u32 {
-        let mut u = hmac_sha256(password, &[salt, &i.to_be_bytes()].concat());
-        let mut t = u;
-
-        for _ in 1..iterations {
-            u = hmac_sha256(password, &u);
-            for j in 0..h_len {
-                t[j] ^= u[j];
-            }
+    const H_LEN: usize = SHA256_DIGEST_SIZE;
+    let l = (dk_len + H_LEN - 1) / H_LEN;
+
+    let (inner, outer) = hmac_sha256_states(password);
+    let keyed = HmacSha256::new(password);
+
+    // blocks[j] holds U_i of output block j followed by SHA-256 padding for
+    // a 96-byte message (the ipad or opad block plus one digest)
+    let mut blocks = vec![[0u8; SHA256_BLOCK_SIZE]; l];
+    let mut t = vec![[0u8; H_LEN]; l];
+    for (j, (block, t)) in blocks.iter_mut().zip(t.iter_mut()).enumerate() {
+        let mut hmac = keyed.clone();
+        hmac.update(salt);
+        hmac.update(&(j as u32 + 1).to_be_bytes());
+        *t = hmac.finalize();
+        block[..H_LEN].copy_from_slice(t);
+        block[H_LEN] = 0x80;
+        block[SHA256_BLOCK_SIZE - 8..].copy_from_slice(&(96u64 * 8).to_be_bytes());
+    }
+
+    let mut states = vec![[0u32; 8]; l];
+    for _ in 1..iterations {
+        states.fill(inner);
+        compress256_lanes(&mut states, &blocks);
+        for (block, state) in blocks.iter_mut().zip(&states) {
+            store_be32(&mut block[..H_LEN], state);
         }
 
-        dk.extend_from_slice(&t);
+        states.fill(outer);
+        compress256_lanes(&mut states, &blocks);
+        for ((block, state), t) in blocks.iter_mut().zip(&states).zip(t.iter_mut()) {
+            store_be32(&mut block[..H_LEN], state);
+            for (t, u) in t.iter_mut().zip(&block[..H_LEN]) {
+                *t ^= u;
+            }
+        }
     }
 
+    let mut dk = t.concat();
     dk.truncate(dk_len);
     dk
 }
 
 /// PBKDF2 with HMAC-SHA512
+///
+/// Structured like [`pbkdf2_sha256`], with 128-byte blocks.
 pub fn pbkdf2_sha512(password: &[u8], salt: &[u8], iterations: u32, dk_len: usize) -> Vec<u8> {
-    const H_LEN: usize = 64;
+    const H_LEN: usize = SHA512_DIGEST_SIZE;
     let l = (dk_len + H_LEN - 1) / H_LEN;
-    let mut dk = Vec::with_capacity(l * H_LEN);
 
-    for i in 1..=l as u32 {
+    let (inner, outer) = hmac_sha512_states(password);
+
+    // blocks[j] holds U_i of output block j followed by SHA-512 padding for
+    // a 192-byte message
+    let mut blocks = vec![[0u8; SHA512_BLOCK_SIZE]; l];
+    let mut t = vec![[0u8; H_LEN]; l];
+    for (j, (block, t)) in blocks.iter_mut().zip(t.iter_mut()).enumerate() {
         let mut combined = Vec::with_capacity(salt.len() + 4);
         combined.extend_from_slice(salt);
-        combined.extend_from_slice(&i.to_be_bytes());
+        combined.extend_from_slice(&(j as u32 + 1).to_be_bytes());
+        t.copy_from_slice(&hmac_sha512(password, &combined));
+        block[..H_LEN].copy_from_slice(t);
+        block[H_LEN] = 0x80;
+        block[SHA512_BLOCK_SIZE - 16..].copy_from_slice(&(192u128 * 8).to_be_bytes());
+    }
 
-        let mut u = hmac_sha512(password, &combined);
-        let mut t = u.clone();
+    let mut states = vec![[0u64; 8]; l];
+    for _ in 1..iterations {
+        states.fill(inner);
+        compress512_lanes(&mut states, &blocks);
+        for (block, state) in blocks.iter_mut().zip(&states) {
+            store_be64(&mut block[..H_LEN], state);
+        }
 
-        for _ in 1..iterations {
-            u = hmac_sha512(password, &u);
-            for j in 0..H_LEN {
-                t[j] ^= u[j];
+        states.fill(outer);
+        compress512_lanes(&mut states, &blocks);
+        for ((block, state), t) in blocks.iter_mut().zip(&states).zip(t.iter_mut()) {
+            store_be64(&mut block[..H_LEN], state);
+            for (t, u) in t.iter_mut().zip(&block[..H_LEN]) {
+                *t ^= u;
             }
         }
-
-        dk.extend_from_slice(&t);
     }
 
+    let mut dk = t.concat();
     dk.truncate(dk_len);
     dk
 }
 
+/// SHA-256 states after absorbing the HMAC ipad and opad blocks of `key`
+fn hmac_sha256_states(key: &[u8]) -> ([u32; 8], [u32; 8]) {
+    let mut padded_key = [0u8; SHA256_BLOCK_SIZE];
+    if key.len() > SHA256_BLOCK_SIZE {
+        padded_key[..SHA256_DIGEST_SIZE].copy_from_slice(&sha256(key));
+    } else {
+        padded_key[..key.len()].copy_from_slice(key);
+    }
+
+    let mut inner = SHA256_H;
+    compress256(&mut inner, &padded_key.map(|b| b ^ 0x36));
+    let mut outer = SHA256_H;
+    compress256(&mut outer, &padded_key.map(|b| b ^ 0x5c));
+    (inner, outer)
+}
+
+/// SHA-512 states after absorbing the HMAC ipad and opad blocks of `key`
+fn hmac_sha512_states(key: &[u8]) -> ([u64; 8], [u64; 8]) {
+    let mut padded_key = [0u8; SHA512_BLOCK_SIZE];
+    if key.len() > SHA512_BLOCK_SIZE {
+        padded_key[..SHA512_DIGEST_SIZE].copy_from_slice(&sha512(key));
+    } else {
+        padded_key[..key.len()].copy_from_slice(key);
+    }
+
+    let mut inner = SHA512_H;
+    compress512(&mut inner, &padded_key.map(|b| b ^ 0x36));
+    let mut outer = SHA512_H;
+    compress512(&mut outer, &padded_key.map(|b| b ^ 0x5c));
+    (inner, outer)
+}
+
+/// Write a SHA-256 state as its big-endian digest
+fn store_be32(out: &mut [u8], state: &[u32; 8]) {
+    for (chunk, word) in out.chunks_exact_mut(4).zip(state) {
+        chunk.copy_from_slice(&word.to_be_bytes());
+    }
+}
+
+/// Write a SHA-512 state as its big-endian digest
+fn store_be64(out: &mut [u8], state: &[u64; 8]) {
+    for (chunk, word) in out.chunks_exact_mut(8).zip(state) {
+        chunk.copy_from_slice(&word.to_be_bytes());
+    }
+}
+
 /// HMAC-SHA512 helper
 fn hmac_sha512(key: &[u8], data: &[u8]) -> Vec<u8> {
-    use crate::hash::{Sha512, SHA512_BLOCK_SIZE};
+    use crate::hash::Sha512;
 
     let mut padded_key = vec![0u8; SHA512_BLOCK_SIZE];
 
@@ -493,6 +587,7 @@ pub struct EVP_PKEY_CTX {
 #[cfg(test)]
 mod tests {
     use super::*;
+    use crate::encoding::hex_encode;
 
     #[test]
     fn test_hkdf_basic() {
@@ -511,9 +606,92 @@ mod tests {
 
         let dk = pbkdf2_sha256(password, salt, 1, 32);
         assert_eq!(dk.len(), 32);
+        assert_eq!(
+            hex_encode(&dk),
+            "120fb6cffcf8b32c43e7225256c4f837a86548c92ccc35480805987cb70be17b"
+        );
+
+        let dk = pbkdf2_sha256(password, salt, 4096, 32);
+        assert_eq!(
+            hex_encode(&dk),
+            "c5e478d59288c841aa530db6845c4c8d962893a001ce4e11a4963873aa98134a"
+        );
+
+        // RFC 7914 section 11
+        let dk = pbkdf2_sha256(b"passwd", salt, 1, 64);
+        assert_eq!(
+            hex_encode(&dk),
+            "55ac046e56e3089fec1691c22544b605f94185216dde0465e68b9d57c20dacbc\
+             49ca9cccf179b645991664b39d77ef317c71b845b1e30bd509112041d3a19783"
+        );
+    }
 
-        // RFC 7914 test vector (first iteration only)
-        // For iterations=1, salt="salt", password="password", dkLen=32
+    /// Ten output blocks (more than one group of lanes) and a password
+    /// longer than the block size
+    #[test]
+    fn test_pbkdf2_sha256_many_blocks() {
+        let password = b"passwordPASSWORDpassword".repeat(4);
+        let dk = pbkdf2_sha256(
+            &password,
+            b"saltSALTsaltSALTsaltSALTsaltSALTsalt",
+            4096,
+            300,
+        );
+        assert_eq!(
+            hex_encode(&dk[..64]),
+            "15eaf92a9dbcd409c20d8efc38b2804b3b502797892487512d5321fb5fc879c6\
+             c4834424071f3e994b24b2e4cc94c52cc16faaeac51f9b110b1813eeceb668f3"
+        );
+        assert_eq!(
+            hex_encode(&dk[268..]),
+            "9088e6379536a155351c901ddd6e741deb3a70c1993762918090cb8ef6270228"
+        );
+    }
+
+    #[test]
+    fn test_pbkdf2_sha512() {
+        let dk = pbkdf2_sha512(b"password", b"salt", 1, 64);
+        assert_eq!(
+            hex_encode(&dk),
+            "867f70cf1ade02cff3752599a3a53dc4af34c7a669815ae5d513554e1c8cf252\
+             c02d470a285a0501bad999bfe943c08f050235d7d68b1da55e63f73b60a57fce"
+        );
+
+        let password = b"passwordPASSWORDpassword".repeat(8);
+        let dk = pbkdf2_sha512(
+            &password,
+            b"saltSALTsaltSALTsaltSALTsaltSALTsalt",
+            4096,
+            300,
+        );
+        assert_eq!(
+            hex_encode(&dk[..32]),
+            "2bbeb937485087bd72fde51c26c033d2abc391b8622ae9c119555429ffa9e74f"
+        );
+        assert_eq!(
+            hex_encode(&dk[268..]),
+            "40fc4ad826ce984e7507cc8981205cd5e3a0b5b92f56a5b30bc511f767f11122"
+        );
+    }
+
+    /// RFC 5869 test case 1
+    #[test]
+    fn test_hkdf_rfc5869() {
+        let ikm = [0x0b; 22];
+        let salt: Vec<u8> = (0x00..=0x0c).collect();
+        let info: Vec<u8> = (0xf0..=0xf9).collect();
+
+        let prk = hkdf_extract_sha256(&salt, &ikm);
+        assert_eq!(
+            hex_encode(&prk),
+            "077709362c2e32df0ddc3f0dc47bba6390b6c73bb50f9c3122ec844ad7c2b3e5"
+        );
+        let okm = hkdf_expand_sha256(&prk, &info, 42);
+        assert_eq!(
+            hex_encode(&okm),
+            "3cb25f25faacd57a90434f64d0362f2a2d2d0a90cf1a5a4c5db02d56ecc4c5bf\
+             34007208d5b887185865"
+        );
     }
 
     #[test]
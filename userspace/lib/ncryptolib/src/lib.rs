@@ -77,13 +77,23 @@ pub mod crc32;
 
 // Symmetric encryption
 pub mod aes;
+mod aes_ct;
+#[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+mod aes_ni;
 pub mod chacha20;
+#[cfg(target_arch = "x86_64")]
+mod chacha20_simd;
+mod ghash;
 
 // Asymmetric cryptography
 pub mod ec;
 pub mod ecdsa;
 pub mod ed25519;
+mod edwards25519;
+mod field25519;
+mod montgomery;
 pub mod p256;
+mod p256_field;
 pub mod rsa;
 pub mod x25519;
 
@@ -101,6 +111,9 @@ pub mod encoding;
 // Utilities
 pub mod constant_time;
 
+// CPU feature detection for accelerated code paths
+pub mod cpu;
+
 // Random number generation
 pub mod random;
 
@@ -229,6 +242,7 @@ pub extern "C" fn CRYPTO_cleanup_all_ex_data() {
 // SHA-2 family
 pub use hash::{hmac_sha256, HmacSha256};
 pub use hash::{sha256, sha384, sha512, Sha256, Sha384, Sha512};
+pub use hash::{sha256_many, sha512_many};
 
 // SHA-3 family
 pub use sha3::{sha3_256, sha3_384, sha3_512, Sha3, Sha3_256, Sha3_384, Sha3_512};
@@ -0,0 +1,158 @@
+//! Four-limb modular arithmetic
+//!
+//! Routines shared by arithmetic modulo odd 256-bit moduli: values are
+//! four 64-bit little-endian limbs, and multiplication forms the full
+//! 512-bit product before a word-by-word Montgomery reduction. Everything
+//! is `#[inline(always)]` so each caller gets a copy specialized to its
+//! constant modulus. None of it branches on or indexes memory by the
+//! operands, except [`limbs_lt`].
+
+pub type Limbs = [u64; 4];
+
+/// acc + a·b + carry, as (low, high) words
+#[inline(always)]
+pub fn mac(acc: u64, a: u64, b: u64, carry: u64) -> (u64, u64) {
+    let t = acc as u128 + a as u128 * b as u128 + carry as u128;
+    (t as u64, (t >> 64) as u64)
+}
+
+/// a + b + carry, with the carry out as 0 or 1
+#[inline(always)]
+pub fn adc(a: u64, b: u64, carry: u64) -> (u64, u64) {
+    let t = a as u128 + b as u128 + carry as u128;
+    (t as u64, (t >> 64) as u64)
+}
+
+/// a - b - borrow, with the borrow out as 0 or 1
+#[inline(always)]
+pub fn sbb(a: u64, b: u64, borrow: u64) -> (u64, u64) {
+    let t = (a as u128).wrapping_sub(b as u128 + borrow as u128);
+    (t as u64, (t >> 127) as u64)
+}
+
+/// `a` where `mask` is 0, `b` where it is all ones
+#[inline(always)]
+pub fn select(a: &Limbs, b: &Limbs, mask: u64) -> Limbs {
+    core::array::from_fn(|i| a[i] ^ ((a[i] ^ b[i]) & mask))
+}
+
+/// Reduce `hi·2^256 + t`, which is below 2m, to below m
+#[inline(always)]
+pub fn reduce_once(t: &Limbs, hi: u64, m: &Limbs) -> Limbs {
+    let mut d = [0u64; 4];
+    let mut borrow = 0;
+    for i in 0..4 {
+        (d[i], borrow) = sbb(t[i], m[i], borrow);
+    }
+    // Borrowing out of the top word means the value was already below m
+    let (_, borrow) = sbb(hi, 0, borrow);
+    select(&d, t, borrow.wrapping_neg())
+}
+
+#[inline(always)]
+pub fn add(a: &Limbs, b: &Limbs, m: &Limbs) -> Limbs {
+    let mut s = [0u64; 4];
+    let mut carry = 0;
+    for i in 0..4 {
+        (s[i], carry) = adc(a[i], b[i], carry);
+    }
+    reduce_once(&s, carry, m)
+}
+
+#[inline(always)]
+pub fn sub(a: &Limbs, b: &Limbs, m: &Limbs) -> Limbs {
+    let mut d = [0u64; 4];
+    let mut borrow = 0;
+    for i in 0..4 {
+        (d[i], borrow) = sbb(a[i], b[i], borrow);
+    }
+    // Add m back if the subtraction wrapped
+    let mask = borrow.wrapping_neg();
+    let mut carry = 0;
+    for i in 0..4 {
+        (d[i], carry) = adc(d[i], m[i] & mask, carry);
+    }
+    d
+}
+
+/// The 512-bit product a·b
+#[inline(always)]
+pub fn mul_wide(a: &Limbs, b: &Limbs) -> [u64; 8] {
+    let mut t = [0u64; 8];
+    for i in 0..4 {
+        let mut carry = 0;
+        for j in 0..4 {
+            (t[i + j], carry) = mac(t[i + j], a[i], b[j], carry);
+        }
+        t[i + 4] = carry;
+    }
+    t
+}
+
+/// The 512-bit square a·a: each cross product once, doubled, plus the
+/// diagonal (10 multiplications instead of 16)
+#[inline(always)]
+pub fn sqr_wide(a: &Limbs) -> [u64; 8] {
+    let mut t = [0u64; 8];
+    for i in 0..3 {
+        let mut carry = 0;
+        for j in i + 1..4 {
+            (t[i + j], carry) = mac(t[i + j], a[i], a[j], carry);
+        }
+        t[i + 4] = carry;
+    }
+
+    let mut shifted_out = 0;
+    for word in t.iter_mut() {
+        let w = *word;
+        *word = (w << 1) | shifted_out;
+        shifted_out = w >> 63;
+    }
+
+    let mut carry = 0;
+    for i in 0..4 {
+        let (lo, hi) = mac(0, a[i], a[i], 0);
+        (t[2 * i], carry) = adc(t[2 * i], lo, carry);
+        (t[2 * i + 1], carry) = adc(t[2 * i + 1], hi, carry);
+    }
+    t
+}
+
+/// t·2^-256 mod m for t < m·2^256 (Montgomery reduction, one word at a
+/// time: adding a multiple of m clears the lowest word)
+#[inline(always)]
+pub fn mont_reduce(t: &[u64; 8], m: &Limbs, m_inv: u64) -> Limbs {
+    let mut t = *t;
+    let mut top = 0;
+    for i in 0..4 {
+        let u = t[i].wrapping_mul(m_inv);
+        let (_, mut carry) = mac(t[i], u, m[0], 0);
+        for j in 1..4 {
+            (t[i + j], carry) = mac(t[i + j], u, m[j], carry);
+        }
+        (t[i + 4], top) = adc(t[i + 4], carry, top);
+    }
+    reduce_once(&[t[4], t[5], t[6], t[7]], top, m)
+}
+
+/// Into Montgomery form: a·2^256 mod m, given r2 = 2^512 mod m
+#[inline(always)]
+pub fn to_montgomery(a: &Limbs, r2: &Limbs, m: &Limbs, m_inv: u64) -> Limbs {
+    mont_reduce(&mul_wide(a, r2), m, m_inv)
+}
+
+/// Out of Montgomery form
+#[inline(always)]
+pub fn from_montgomery(a: &Limbs, m: &Limbs, m_inv: u64) -> Limbs {
+    mont_reduce(&[a[0], a[1], a[2], a[3], 0, 0, 0, 0], m, m_inv)
+}
+
+/// a < b (variable-time)
+pub fn limbs_lt(a: &Limbs, b: &Limbs) -> bool {
+    for i in (0..4).rev() {
+        if a[i] != b[i] {
+            return a[i] < b[i];
+        }
+    }
+    false
+}
@@ -2,11 +2,28 @@
 //!
 //! Complete P-256 implementation for ECDH key exchange and ECDSA signatures.
 //! NIST FIPS 186-4 compliant.
+//!
+//! Field and scalar arithmetic is 4×64-bit Montgomery (`p256_field`).
+//! Points use the complete projective formulas of Renes, Costello and
+//! Batina (a = -3), which need no special cases for doubling or the
+//! identity, so a multiplication by a secret scalar runs the same
+//! operations whatever the scalar is:
+//!
+//! - `k·G` (key generation, signing) is a comb over 60 precomputed
+//!   multiples of G, built on first use: 15 doublings and 64 additions.
+//! - `k·P` (ECDH) is a fixed 4-bit window over a table of 0·P..15·P.
+//! - Table entries are fetched by reading the whole table under masks,
+//!   never by indexing with a secret digit.
+//!
+//! ECDSA verification has only public inputs. It computes `u1·G + u2·Q` in
+//! one pass (Shamir's trick) over width-7 and width-5 NAF digits.
 
+use std::sync::OnceLock;
 use std::vec::Vec;
 
 use crate::bigint::BigInt;
 use crate::hash::sha256;
+use crate::p256_field::{Fe, Scalar};
 use crate::random::random_bytes;
 
 // ============================================================================
@@ -22,12 +39,6 @@ pub const P256_PRIVATE_KEY_SIZE: usize = 32;
 /// Uncompressed public key size (04 || x || y)
 pub const P256_PUBLIC_KEY_SIZE: usize = 65;
 
-/// Field prime p = 2^256 - 2^224 + 2^192 + 2^96 - 1
-const P_BYTES: [u8; 32] = [
-    0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
-];
-
 /// Curve order n
 const N_BYTES: [u8; 32] = [
     0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
@@ -46,361 +57,431 @@ const GY_BYTES: [u8; 32] = [
     0x2b, 0xce, 0x33, 0x57, 0x6b, 0x31, 0x5e, 0xce, 0xcb, 0xb6, 0x40, 0x68, 0x37, 0xbf, 0x51, 0xf5,
 ];
 
-/// Curve parameter a = -3 mod p (in Montgomery form this is p - 3)
-const A_BYTES: [u8; 32] = [
-    0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfc,
-];
-
 // ============================================================================
-// Field Element
+// Projective Points
 // ============================================================================
 
-/// Field element modulo p
-#[derive(Clone, Debug, PartialEq, Eq)]
-struct FieldElement {
-    value: BigInt,
+/// Homogeneous projective point: (X : Y : Z) is the affine point
+/// (X/Z, Y/Z), and the identity is (0 : 1 : 0)
+#[derive(Clone, Copy, Debug)]
+struct ProjectivePoint {
+    x: Fe,
+    y: Fe,
+    z: Fe,
+}
+
+/// Affine point in a precomputed table (never the identity)
+#[derive(Clone, Copy, Debug)]
+struct AffinePoint {
+    x: Fe,
+    y: Fe,
 }
 
-impl FieldElement {
-    fn zero() -> Self {
+impl AffinePoint {
+    /// Placeholder for lookups that match no entry; not on the curve
+    const ZERO: Self = Self {
+        x: Fe::ZERO,
+        y: Fe::ZERO,
+    };
+
+    fn neg(&self) -> Self {
         Self {
-            value: BigInt::zero(),
+            x: self.x,
+            y: self.y.neg(),
         }
     }
 
-    fn one() -> Self {
+    /// `a` where `mask` is 0, `b` where it is all ones
+    fn select(a: &Self, b: &Self, mask: u64) -> Self {
         Self {
-            value: BigInt::one(),
+            x: Fe::select(&a.x, &b.x, mask),
+            y: Fe::select(&a.y, &b.y, mask),
         }
     }
+}
 
-    fn p() -> BigInt {
-        BigInt::from_bytes_be(&P_BYTES)
+impl ProjectivePoint {
+    const IDENTITY: Self = Self {
+        x: Fe::ZERO,
+        y: Fe::ONE,
+        z: Fe::ZERO,
+    };
+
+    fn from_affine(p: &AffinePoint) -> Self {
+        Self {
+            x: p.x,
+            y: p.y,
+            z: Fe::ONE,
+        }
     }
 
-    fn from_bytes(bytes: &[u8]) -> Option<Self> {
-        if bytes.len() > 32 {
-            return None;
+    /// Convert to affine (one field inversion)
+    fn to_affine(&self) -> P256Point {
+        if self.z.is_zero() {
+            return P256Point::infinity();
         }
-        let value = BigInt::from_bytes_be(bytes);
-        let p = Self::p();
-        if value >= p {
-            return None;
+        let z_inv = self.z.invert();
+        P256Point {
+            x: self.x.mul(&z_inv),
+            y: self.y.mul(&z_inv),
+            infinity: false,
         }
-        Some(Self { value })
     }
 
-    fn from_bigint(value: BigInt) -> Self {
-        let p = Self::p();
+    fn neg(&self) -> Self {
         Self {
-            value: value.mod_reduce(&p),
+            x: self.x,
+            y: self.y.neg(),
+            z: self.z,
         }
     }
 
-    fn to_bytes(&self) -> [u8; 32] {
-        let bytes = self.value.to_bytes_be_padded(32);
-        let mut result = [0u8; 32];
-        result.copy_from_slice(&bytes);
-        result
+    /// `a` where `mask` is 0, `b` where it is all ones
+    fn select(a: &Self, b: &Self, mask: u64) -> Self {
+        Self {
+            x: Fe::select(&a.x, &b.x, mask),
+            y: Fe::select(&a.y, &b.y, mask),
+            z: Fe::select(&a.z, &b.z, mask),
+        }
     }
 
+    /// Complete addition (RCB algorithm 4). Cost: 12M + 2 multiplications by b
     fn add(&self, other: &Self) -> Self {
-        let p = Self::p();
-        let sum = self.value.add(&other.value);
+        let (x1, y1, z1) = (&self.x, &self.y, &self.z);
+        let (x2, y2, z2) = (&other.x, &other.y, &other.z);
+
+        let t0 = x1.mul(x2);
+        let t1 = y1.mul(y2);
+        let t2 = z1.mul(z2);
+        let t3 = x1.add(y1).mul(&x2.add(y2)).sub(&t0.add(&t1));
+        let t4 = y1.add(z1).mul(&y2.add(z2)).sub(&t1.add(&t2));
+        let y3 = x1.add(z1).mul(&x2.add(z2)).sub(&t0.add(&t2));
+
+        let x3 = y3.sub(&Fe::B.mul(&t2));
+        let x3 = x3.add(&x3.double());
+        let z3 = t1.sub(&x3);
+        let x3 = t1.add(&x3);
+
+        let t2 = t2.add(&t2.double());
+        let y3 = Fe::B.mul(&y3).sub(&t2).sub(&t0);
+        let y3 = y3.add(&y3.double());
+        let t0 = t0.add(&t0.double()).sub(&t2);
+
         Self {
-            value: if sum >= p { sum.sub(&p) } else { sum },
+            x: t3.mul(&x3).sub(&t4.mul(&y3)),
+            y: x3.mul(&z3).add(&t0.mul(&y3)),
+            z: t4.mul(&z3).add(&t3.mul(&t0)),
         }
     }
 
-    fn sub(&self, other: &Self) -> Self {
-        let p = Self::p();
-        if self.value >= other.value {
-            Self {
-                value: self.value.sub(&other.value),
-            }
-        } else {
-            Self {
-                value: p.sub(&other.value.sub(&self.value)),
-            }
-        }
-    }
+    /// Mixed addition of an affine point (RCB algorithm 5). Complete as
+    /// long as `other` is not the identity, which an `AffinePoint` cannot
+    /// be. Cost: 11M + 2 multiplications by b
+    fn add_affine(&self, other: &AffinePoint) -> Self {
+        let (x1, y1, z1) = (&self.x, &self.y, &self.z);
+        let (x2, y2) = (&other.x, &other.y);
+
+        let t0 = x1.mul(x2);
+        let t1 = y1.mul(y2);
+        let t3 = x2.add(y2).mul(&x1.add(y1)).sub(&t0.add(&t1));
+        let t4 = y2.mul(z1).add(y1);
+        let y3 = x2.mul(z1).add(x1);
+
+        let x3 = y3.sub(&Fe::B.mul(z1));
+        let x3 = x3.add(&x3.double());
+        let z3 = t1.sub(&x3);
+        let x3 = t1.add(&x3);
+
+        let t2 = z1.add(&z1.double());
+        let y3 = Fe::B.mul(&y3).sub(&t2).sub(&t0);
+        let y3 = y3.add(&y3.double());
+        let t0 = t0.add(&t0.double()).sub(&t2);
 
-    fn mul(&self, other: &Self) -> Self {
-        let p = Self::p();
         Self {
-            value: self.value.mul(&other.value).mod_reduce(&p),
+            x: t3.mul(&x3).sub(&t4.mul(&y3)),
+            y: x3.mul(&z3).add(&t0.mul(&y3)),
+            z: t4.mul(&z3).add(&t3.mul(&t0)),
         }
     }
 
-    fn square(&self) -> Self {
-        self.mul(self)
-    }
-
+    /// Doubling (RCB algorithm 6). Cost: 8M + 3S + 2 multiplications by b
     fn double(&self) -> Self {
-        self.add(self)
+        let (x, y, z) = (&self.x, &self.y, &self.z);
+
+        let t0 = x.square();
+        let t1 = y.square();
+        let t2 = z.square();
+        let t3 = x.mul(y).double();
+        let z3 = x.mul(z).double();
+
+        let y3 = Fe::B.mul(&t2).sub(&z3);
+        let y3 = y3.add(&y3.double());
+        let x3 = t1.sub(&y3);
+        let y3 = x3.mul(&t1.add(&y3));
+        let x3 = x3.mul(&t3);
+
+        let t2 = t2.add(&t2.double());
+        let z3 = Fe::B.mul(&z3).sub(&t2).sub(&t0);
+        let z3 = z3.add(&z3.double());
+        let t0 = t0.add(&t0.double()).sub(&t2);
+        let y3 = y3.add(&t0.mul(&z3));
+
+        let t0 = y.mul(z).double();
+        Self {
+            x: x3.sub(&t0.mul(&z3)),
+            y: y3,
+            z: t0.mul(&t1).double().double(),
+        }
     }
+}
 
-    fn negate(&self) -> Self {
-        if self.is_zero() {
-            Self::zero()
-        } else {
-            let p = Self::p();
-            Self {
-                value: p.sub(&self.value),
-            }
-        }
+/// Affine forms of points, none of them the identity, for the cost of one
+/// inversion (Montgomery's trick)
+fn batch_to_affine(points: &[ProjectivePoint]) -> Vec<AffinePoint> {
+    let mut prefix = Vec::with_capacity(points.len());
+    let mut acc = Fe::ONE;
+    for p in points {
+        prefix.push(acc);
+        acc = acc.mul(&p.z);
     }
 
-    fn is_zero(&self) -> bool {
-        self.value.is_zero()
+    let mut inv = acc.invert();
+    let mut out = vec![AffinePoint::ZERO; points.len()];
+    for i in (0..points.len()).rev() {
+        let z_inv = inv.mul(&prefix[i]);
+        inv = inv.mul(&points[i].z);
+        out[i] = AffinePoint {
+            x: points[i].x.mul(&z_inv),
+            y: points[i].y.mul(&z_inv),
+        };
     }
+    out
+}
 
-    /// Modular inverse using Fermat's little theorem: a^(-1) = a^(p-2) mod p
-    fn invert(&self) -> Option<Self> {
-        if self.is_zero() {
-            return None;
-        }
+// ============================================================================
+// Scalar Multiplication
+// ============================================================================
 
-        let p = Self::p();
-        let p_minus_2 = p.sub(&BigInt::from_u64(2));
+/// Bits of the scalar in each comb digit, taken 64 bits apart
+const COMB_TEETH: usize = 4;
+/// Sub-combs, each covering a quarter of the 64 columns
+const COMB_BLOCKS: usize = 4;
+const COMB_SPACING: usize = 256 / COMB_TEETH;
+const COMB_COLUMNS: usize = COMB_SPACING / COMB_BLOCKS;
+
+/// `table[b][d - 1]` is the sum of 2^(64·j + 16·b)·G over the set bits j
+/// of the digit d
+type CombTable = [[AffinePoint; (1 << COMB_TEETH) - 1]; COMB_BLOCKS];
+
+/// All ones when `a == b`, otherwise zero
+#[inline]
+fn ct_eq_mask(a: u32, b: u32) -> u64 {
+    ((((a ^ b) as u64).wrapping_sub(1)) >> 63).wrapping_neg()
+}
 
-        Some(Self {
-            value: mod_exp(&self.value, &p_minus_2, &p),
-        })
-    }
+/// Bit `i` of a big-endian 256-bit scalar
+#[inline]
+fn scalar_bit(k: &[u8; 32], i: usize) -> u32 {
+    ((k[31 - i / 8] >> (i % 8)) & 1) as u32
+}
 
-    /// Multiply by a small integer
-    fn mul_small(&self, n: u64) -> Self {
-        let p = Self::p();
-        Self {
-            value: self.value.mul(&BigInt::from_u64(n)).mod_reduce(&p),
-        }
+/// A big-endian scalar as 32 bytes: shorter ones are zero-extended and
+/// longer ones reduced mod n
+fn scalar_bytes(scalar: &[u8]) -> [u8; 32] {
+    let mut k = [0u8; 32];
+    if scalar.len() <= 32 {
+        k[32 - scalar.len()..].copy_from_slice(scalar);
+    } else {
+        let n = BigInt::from_bytes_be(&N_BYTES);
+        let reduced = BigInt::from_bytes_be(scalar).mod_reduce(&n);
+        k.copy_from_slice(&reduced.to_bytes_be_padded(32));
     }
+    k
 }
 
-// ============================================================================
-// Jacobian Point (for fast computation)
-// ============================================================================
-
-/// Jacobian point representation: (X, Y, Z) represents affine (X/Z², Y/Z³)
-/// This allows point addition and doubling without modular inversion
-#[derive(Clone, Debug)]
-struct JacobianPoint {
-    x: FieldElement,
-    y: FieldElement,
-    z: FieldElement,
+fn generator_affine() -> AffinePoint {
+    let g = P256Point::generator();
+    AffinePoint { x: g.x, y: g.y }
 }
 
-impl JacobianPoint {
-    /// Point at infinity
-    fn infinity() -> Self {
-        Self {
-            x: FieldElement::one(),
-            y: FieldElement::one(),
-            z: FieldElement::zero(),
+fn generator_comb() -> &'static CombTable {
+    static TABLE: OnceLock<CombTable> = OnceLock::new();
+    TABLE.get_or_init(|| {
+        // 2^i·G for every bit position
+        let mut pow2 = Vec::with_capacity(256);
+        let mut p = ProjectivePoint::from_affine(&generator_affine());
+        for _ in 0..256 {
+            pow2.push(p);
+            p = p.double();
         }
-    }
 
-    /// Convert from affine point
-    fn from_affine(p: &P256Point) -> Self {
-        if p.infinity {
-            Self::infinity()
-        } else {
-            Self {
-                x: p.x.clone(),
-                y: p.y.clone(),
-                z: FieldElement::one(),
+        let per_block = (1 << COMB_TEETH) - 1;
+        let mut points: Vec<ProjectivePoint> = Vec::with_capacity(COMB_BLOCKS * per_block);
+        for b in 0..COMB_BLOCKS {
+            let start = points.len();
+            for d in 1..=per_block {
+                // The entry without the lowest set bit, plus that bit's power
+                let j = d.trailing_zeros() as usize;
+                let base = pow2[COMB_SPACING * j + COMB_COLUMNS * b];
+                let rest = d & (d - 1);
+                points.push(if rest == 0 {
+                    base
+                } else {
+                    points[start + rest - 1].add(&base)
+                });
             }
         }
-    }
 
-    /// Convert to affine point (requires one modular inversion)
-    fn to_affine(&self) -> P256Point {
-        if self.z.is_zero() {
-            return P256Point::infinity();
-        }
+        let affine = batch_to_affine(&points);
+        core::array::from_fn(|b| core::array::from_fn(|i| affine[b * per_block + i]))
+    })
+}
 
-        let z_inv = match self.z.invert() {
-            Some(inv) => inv,
-            None => return P256Point::infinity(),
-        };
+/// G, 3G, 5G, ..., 63G for the width-7 NAF in verification
+fn generator_odd_multiples() -> &'static [AffinePoint; 32] {
+    static TABLE: OnceLock<[AffinePoint; 32]> = OnceLock::new();
+    TABLE.get_or_init(|| {
+        let g = ProjectivePoint::from_affine(&generator_affine());
+        let g2 = g.double();
+        let mut points = Vec::with_capacity(32);
+        points.push(g);
+        for i in 1..32 {
+            points.push(points[i - 1].add(&g2));
+        }
+        batch_to_affine(&points).try_into().unwrap()
+    })
+}
 
-        let z_inv2 = z_inv.square();
-        let z_inv3 = z_inv2.mul(&z_inv);
+/// k·G (constant-time comb)
+fn mul_generator(k: &[u8; 32]) -> ProjectivePoint {
+    let table = generator_comb();
+    let mut acc = ProjectivePoint::IDENTITY;
 
-        P256Point {
-            x: self.x.mul(&z_inv2),
-            y: self.y.mul(&z_inv3),
-            infinity: false,
+    for col in (0..COMB_COLUMNS).rev() {
+        if col != COMB_COLUMNS - 1 {
+            acc = acc.double();
+        }
+        for (b, row) in table.iter().enumerate() {
+            let c = COMB_COLUMNS * b + col;
+            let digit =
+                (0..COMB_TEETH).fold(0, |d, j| d | scalar_bit(k, COMB_SPACING * j + c) << j);
+
+            let mut q = AffinePoint::ZERO;
+            for (i, entry) in row.iter().enumerate() {
+                q = AffinePoint::select(&q, entry, ct_eq_mask(digit, i as u32 + 1));
+            }
+            // A zero digit adds nothing: compute the sum anyway, then drop it
+            let sum = acc.add_affine(&q);
+            acc = ProjectivePoint::select(&sum, &acc, ct_eq_mask(digit, 0));
         }
     }
+    acc
+}
 
-    fn is_infinity(&self) -> bool {
-        self.z.is_zero()
+/// k·P (constant-time fixed 4-bit window)
+fn mul_variable(p: &AffinePoint, k: &[u8; 32]) -> ProjectivePoint {
+    let mut table = [ProjectivePoint::IDENTITY; 16];
+    for i in 1..16 {
+        table[i] = table[i - 1].add_affine(p);
     }
 
-    /// Point doubling in Jacobian coordinates
-    /// Formula from https://hyperelliptic.org/EFD/g1p/auto-shortw-jacobian-3.html
-    /// Cost: 4M + 4S (where M = multiplication, S = squaring)
-    fn double(&self) -> Self {
-        if self.is_infinity() {
-            return Self::infinity();
-        }
-
-        // For curve y² = x³ + ax + b with a = -3:
-        // δ = Z²
-        // γ = Y²
-        // β = X·γ
-        // α = 3·(X-δ)·(X+δ) = 3·X² - 3·Z⁴ = 3·(X² - Z⁴)
-        // X' = α² - 8·β
-        // Z' = (Y+Z)² - γ - δ
-        // Y' = α·(4·β - X') - 8·γ²
-
-        let delta = self.z.square();
-        let gamma = self.y.square();
-        let beta = self.x.mul(&gamma);
-
-        // Since a = -3 for P-256, we use: α = 3·(X - Z²)·(X + Z²)
-        let x_minus_delta = self.x.sub(&delta);
-        let x_plus_delta = self.x.add(&delta);
-        let alpha = x_minus_delta.mul(&x_plus_delta).mul_small(3);
-
-        // X' = α² - 8·β
-        let alpha_sq = alpha.square();
-        let beta8 = beta.mul_small(8);
-        let x3 = alpha_sq.sub(&beta8);
-
-        // Z' = (Y + Z)² - γ - δ
-        let y_plus_z = self.y.add(&self.z);
-        let z3 = y_plus_z.square().sub(&gamma).sub(&delta);
-
-        // Y' = α·(4·β - X') - 8·γ²
-        let beta4 = beta.mul_small(4);
-        let gamma_sq = gamma.square();
-        let gamma_sq8 = gamma_sq.mul_small(8);
-        let y3 = alpha.mul(&beta4.sub(&x3)).sub(&gamma_sq8);
-
-        Self {
-            x: x3,
-            y: y3,
-            z: z3,
+    let mut acc = ProjectivePoint::IDENTITY;
+    for (i, &byte) in k.iter().enumerate() {
+        for (half, nibble) in [byte >> 4, byte & 0x0f].into_iter().enumerate() {
+            if i > 0 || half > 0 {
+                acc = acc.double().double().double().double();
+            }
+            let mut q = ProjectivePoint::IDENTITY;
+            for (j, entry) in table.iter().enumerate() {
+                q = ProjectivePoint::select(&q, entry, ct_eq_mask(nibble as u32, j as u32));
+            }
+            acc = acc.add(&q);
         }
     }
+    acc
+}
 
-    /// Point addition in Jacobian coordinates (mixed: Jacobian + Affine)
-    /// This is faster when adding an affine point (Z = 1)
-    /// Cost: 8M + 3S
-    fn add_affine(&self, other: &P256Point) -> Self {
-        if self.is_infinity() {
-            return Self::from_affine(other);
-        }
-        if other.infinity {
-            return self.clone();
-        }
-
-        // Z1² and Z1³
-        let z1_sq = self.z.square();
-        let z1_cu = z1_sq.mul(&self.z);
-
-        // U1 = X1, U2 = X2·Z1²
-        let u2 = other.x.mul(&z1_sq);
-
-        // S1 = Y1, S2 = Y2·Z1³
-        let s2 = other.y.mul(&z1_cu);
-
-        // H = U2 - U1 = U2 - X1
-        let h = u2.sub(&self.x);
+/// Width-`w` NAF of a big-endian 256-bit value, least significant digit
+/// first: every digit is zero or odd with |d| < 2^(w-1)
+fn wnaf(k: &[u8; 32], w: u32) -> [i8; 257] {
+    // Little-endian limbs, with a spare one for the carries of negative digits
+    let mut limbs = [0u64; 5];
+    for (i, limb) in limbs.iter_mut().take(4).enumerate() {
+        let at = 24 - 8 * i;
+        *limb = u64::from_be_bytes(k[at..at + 8].try_into().unwrap());
+    }
 
-        // R = S2 - S1 = S2 - Y1
-        let r = s2.sub(&self.y);
+    let window = 1i64 << w;
+    let mut digits = [0i8; 257];
+    let mut i = 0;
+    while limbs.iter().any(|&l| l != 0) {
+        if limbs[0] & 1 == 1 {
+            let mut d = (limbs[0] & (window as u64 - 1)) as i64;
+            if d >= window / 2 {
+                d -= window;
+            }
+            digits[i] = d as i8;
 
-        if h.is_zero() {
-            if r.is_zero() {
-                // P1 == P2, do doubling
-                return self.double();
+            // Subtract d, leaving a multiple of 2^w
+            let (mut borrow, mut carry) = if d > 0 {
+                (d as u64, 0)
             } else {
-                // P1 == -P2
-                return Self::infinity();
+                (0, (-d) as u64)
+            };
+            for limb in limbs.iter_mut() {
+                let (v, b) = limb.overflowing_sub(borrow);
+                let (v, c) = v.overflowing_add(carry);
+                *limb = v;
+                borrow = b as u64;
+                carry = c as u64;
             }
         }
-
-        let h_sq = h.square();
-        let h_cu = h_sq.mul(&h);
-
-        // X3 = R² - H³ - 2·U1·H²
-        let u1_h_sq = self.x.mul(&h_sq);
-        let x3 = r.square().sub(&h_cu).sub(&u1_h_sq.double());
-
-        // Y3 = R·(U1·H² - X3) - S1·H³
-        let y3 = r.mul(&u1_h_sq.sub(&x3)).sub(&self.y.mul(&h_cu));
-
-        // Z3 = Z1·H
-        let z3 = self.z.mul(&h);
-
-        Self {
-            x: x3,
-            y: y3,
-            z: z3,
+        for j in 0..4 {
+            limbs[j] = (limbs[j] >> 1) | (limbs[j + 1] << 63);
         }
+        limbs[4] >>= 1;
+        i += 1;
     }
+    digits
+}
 
-    /// Full Jacobian addition (both points in Jacobian coordinates)
-    /// Cost: 12M + 4S
-    fn add(&self, other: &Self) -> Self {
-        if self.is_infinity() {
-            return other.clone();
-        }
-        if other.is_infinity() {
-            return self.clone();
-        }
-
-        let z1_sq = self.z.square();
-        let z2_sq = other.z.square();
-        let z1_cu = z1_sq.mul(&self.z);
-        let z2_cu = z2_sq.mul(&other.z);
-
-        // U1 = X1·Z2², U2 = X2·Z1²
-        let u1 = self.x.mul(&z2_sq);
-        let u2 = other.x.mul(&z1_sq);
-
-        // S1 = Y1·Z2³, S2 = Y2·Z1³
-        let s1 = self.y.mul(&z2_cu);
-        let s2 = other.y.mul(&z1_cu);
-
-        // H = U2 - U1
-        let h = u2.sub(&u1);
+/// u1·G + u2·Q for public scalars (variable-time)
+fn mul_generator_add_vartime(u1: &[u8; 32], u2: &[u8; 32], q: &AffinePoint) -> ProjectivePoint {
+    let g_table = generator_odd_multiples();
+    let q1 = ProjectivePoint::from_affine(q);
+    let q2 = q1.double();
+    let mut q_table = [q1; 8];
+    for i in 1..8 {
+        q_table[i] = q_table[i - 1].add(&q2);
+    }
 
-        // R = S2 - S1
-        let r = s2.sub(&s1);
+    let g_digits = wnaf(u1, 7);
+    let q_digits = wnaf(u2, 5);
+    let mut acc = ProjectivePoint::IDENTITY;
+    let top = match (0..257)
+        .rev()
+        .find(|&i| g_digits[i] != 0 || q_digits[i] != 0)
+    {
+        Some(top) => top,
+        None => return acc,
+    };
 
-        if h.is_zero() {
-            if r.is_zero() {
-                return self.double();
-            } else {
-                return Self::infinity();
-            }
+    for i in (0..=top).rev() {
+        acc = acc.double();
+        let d = g_digits[i];
+        if d > 0 {
+            acc = acc.add_affine(&g_table[(d >> 1) as usize]);
+        } else if d < 0 {
+            acc = acc.add_affine(&g_table[(-d >> 1) as usize].neg());
         }
-
-        let h_sq = h.square();
-        let h_cu = h_sq.mul(&h);
-
-        // X3 = R² - H³ - 2·U1·H²
-        let u1_h_sq = u1.mul(&h_sq);
-        let x3 = r.square().sub(&h_cu).sub(&u1_h_sq.double());
-
-        // Y3 = R·(U1·H² - X3) - S1·H³
-        let y3 = r.mul(&u1_h_sq.sub(&x3)).sub(&s1.mul(&h_cu));
-
-        // Z3 = Z1·Z2·H
-        let z3 = self.z.mul(&other.z).mul(&h);
-
-        Self {
-            x: x3,
-            y: y3,
-            z: z3,
+        let d = q_digits[i];
+        if d > 0 {
+            acc = acc.add(&q_table[(d >> 1) as usize]);
+        } else if d < 0 {
+            acc = acc.add(&q_table[(-d >> 1) as usize].neg());
         }
     }
+    acc
 }
 
 // ============================================================================
@@ -410,8 +491,8 @@ impl JacobianPoint {
 /// Affine point on the P-256 curve
 #[derive(Clone, Debug)]
 pub struct P256Point {
-    x: FieldElement,
-    y: FieldElement,
+    x: Fe,
+    y: Fe,
     infinity: bool,
 }
 
@@ -419,8 +500,8 @@ impl P256Point {
     /// Point at infinity
     pub fn infinity() -> Self {
         Self {
-            x: FieldElement::zero(),
-            y: FieldElement::zero(),
+            x: Fe::ZERO,
+            y: Fe::ZERO,
             infinity: true,
         }
     }
@@ -428,20 +509,26 @@ impl P256Point {
     /// Base point (generator)
     pub fn generator() -> Self {
         Self {
-            x: FieldElement::from_bytes(&GX_BYTES).unwrap(),
-            y: FieldElement::from_bytes(&GY_BYTES).unwrap(),
+            x: Fe::from_bytes(&GX_BYTES).unwrap(),
+            y: Fe::from_bytes(&GY_BYTES).unwrap(),
             infinity: false,
         }
     }
 
     /// Create from coordinates
     pub fn from_affine(x: &[u8], y: &[u8]) -> Option<Self> {
-        let x_fe = FieldElement::from_bytes(x)?;
-        let y_fe = FieldElement::from_bytes(y)?;
+        let coord = |bytes: &[u8]| {
+            if bytes.len() > 32 {
+                return None;
+            }
+            let mut padded = [0u8; 32];
+            padded[32 - bytes.len()..].copy_from_slice(bytes);
+            Fe::from_bytes(&padded)
+        };
 
         let point = Self {
-            x: x_fe,
-            y: y_fe,
+            x: coord(x)?,
+            y: coord(y)?,
             infinity: false,
         };
 
@@ -474,146 +561,33 @@ impl P256Point {
         result
     }
 
-    /// Check if point is on the curve: y^2 = x^3 + ax + b
+    /// Check if point is on the curve: y^2 = x^3 - 3x + b
     fn is_on_curve(&self) -> bool {
         if self.infinity {
             return true;
         }
 
-        let a = FieldElement::from_bytes(&A_BYTES).unwrap();
-        let b = FieldElement::from_bytes(&[
-            0x5a, 0xc6, 0x35, 0xd8, 0xaa, 0x3a, 0x93, 0xe7, 0xb3, 0xeb, 0xbd, 0x55, 0x76, 0x98,
-            0x86, 0xbc, 0x65, 0x1d, 0x06, 0xb0, 0xcc, 0x53, 0xb0, 0xf6, 0x3b, 0xce, 0x3c, 0x3e,
-            0x27, 0xd2, 0x60, 0x4b,
-        ])
-        .unwrap();
-
-        // y^2 = x^3 + ax + b
-        let y_squared = self.y.square();
-        let x_cubed = self.x.square().mul(&self.x);
-        let ax = a.mul(&self.x);
-        let rhs = x_cubed.add(&ax).add(&b);
-
-        y_squared == rhs
-    }
-
-    /// Point doubling (affine)
-    fn double(&self) -> Self {
-        if self.infinity || self.y.is_zero() {
-            return Self::infinity();
-        }
-
-        let a = FieldElement::from_bytes(&A_BYTES).unwrap();
-
-        // lambda = (3*x^2 + a) / (2*y)
-        let three = FieldElement {
-            value: BigInt::from_u64(3),
-        };
-        let two = FieldElement {
-            value: BigInt::from_u64(2),
-        };
-
-        let x_squared = self.x.square();
-        let numerator = three.mul(&x_squared).add(&a);
-        let denominator = two.mul(&self.y);
-
-        let lambda = match denominator.invert() {
-            Some(inv) => numerator.mul(&inv),
-            None => return Self::infinity(),
-        };
-
-        // x3 = lambda^2 - 2*x
-        let lambda_squared = lambda.square();
-        let two_x = two.mul(&self.x);
-        let x3 = lambda_squared.sub(&two_x);
-
-        // y3 = lambda*(x - x3) - y
-        let y3 = lambda.mul(&self.x.sub(&x3)).sub(&self.y);
-
-        Self {
-            x: x3,
-            y: y3,
-            infinity: false,
-        }
+        let x3 = self.x.square().mul(&self.x);
+        let three_x = self.x.add(&self.x.double());
+        self.y.square() == x3.sub(&three_x).add(&Fe::B)
     }
 
-    /// Point addition (affine)
-    fn add(&self, other: &Self) -> Self {
-        if self.infinity {
-            return other.clone();
-        }
-        if other.infinity {
-            return self.clone();
-        }
-
-        // If points are equal, use doubling
-        if self.x == other.x {
-            if self.y == other.y {
-                return self.double();
-            } else {
-                // P + (-P) = O
-                return Self::infinity();
-            }
-        }
-
-        // lambda = (y2 - y1) / (x2 - x1)
-        let numerator = other.y.sub(&self.y);
-        let denominator = other.x.sub(&self.x);
-
-        let lambda = match denominator.invert() {
-            Some(inv) => numerator.mul(&inv),
-            None => return Self::infinity(),
-        };
-
-        // x3 = lambda^2 - x1 - x2
-        let lambda_squared = lambda.square();
-        let x3 = lambda_squared.sub(&self.x).sub(&other.x);
-
-        // y3 = lambda*(x1 - x3) - y1
-        let y3 = lambda.mul(&self.x.sub(&x3)).sub(&self.y);
-
-        Self {
-            x: x3,
-            y: y3,
-            infinity: false,
-        }
-    }
-
-    /// Scalar multiplication using Jacobian coordinates
-    /// This is MUCH faster than affine as it only requires ONE modular inversion
-    /// at the end instead of one per point operation.
+    /// Scalar multiplication (constant-time in the scalar)
     pub fn scalar_mul(&self, scalar: &[u8]) -> Self {
-        let k = BigInt::from_bytes_be(scalar);
-
-        if k.is_zero() {
-            return Self::infinity();
-        }
-
         if self.infinity {
             return Self::infinity();
         }
-
-        // Use Jacobian coordinates for all intermediate computations
-        let mut result = JacobianPoint::infinity();
-
-        // Process bits from most significant to least significant (left-to-right)
-        // This allows us to use add_affine which is faster than full Jacobian add
-        let bits = k.bit_length();
-        for i in (0..bits).rev() {
-            result = result.double();
-            if k.get_bit(i) {
-                result = result.add_affine(self);
-            }
-        }
-
-        // Single conversion back to affine (single modular inversion)
-        result.to_affine()
+        let p = AffinePoint {
+            x: self.x,
+            y: self.y,
+        };
+        mul_variable(&p, &scalar_bytes(scalar)).to_affine()
     }
 
-    /// Scalar multiplication optimized for the generator point
-    /// Uses a simple double-and-add with Jacobian coordinates
+    /// Scalar multiplication of the generator, using the precomputed comb
+    /// (constant-time in the scalar)
     pub fn scalar_mul_generator(scalar: &[u8]) -> Self {
-        Self::generator().scalar_mul(scalar)
+        mul_generator(&scalar_bytes(scalar)).to_affine()
     }
 }
 
@@ -632,22 +606,19 @@ pub struct P256KeyPair {
 impl P256KeyPair {
     /// Generate a new random key pair
     pub fn generate() -> Option<Self> {
-        let n = BigInt::from_bytes_be(&N_BYTES);
-
         // Generate random scalar in [1, n-1]
         let mut private_key = [0u8; 32];
         loop {
             random_bytes(&mut private_key).ok()?;
 
-            let k = BigInt::from_bytes_be(&private_key);
-            if !k.is_zero() && k < n {
-                break;
+            match Scalar::from_bytes(&private_key) {
+                Some(k) if !k.is_zero() => break,
+                _ => continue,
             }
         }
 
         // Compute public key Q = k * G
-        let g = P256Point::generator();
-        let public_key = g.scalar_mul(&private_key);
+        let public_key = P256Point::scalar_mul_generator(&private_key);
 
         if public_key.infinity {
             return None;
@@ -661,22 +632,14 @@ impl P256KeyPair {
 
     /// Create from private key
     pub fn from_private_key(private_key: &[u8]) -> Option<Self> {
-        if private_key.len() != 32 {
-            return None;
-        }
+        let key: [u8; 32] = private_key.try_into().ok()?;
 
-        let n = BigInt::from_bytes_be(&N_BYTES);
-        let k = BigInt::from_bytes_be(private_key);
-
-        if k.is_zero() || k >= n {
-            return None;
+        match Scalar::from_bytes(&key) {
+            Some(k) if !k.is_zero() => {}
+            _ => return None,
         }
 
-        let mut key = [0u8; 32];
-        key.copy_from_slice(private_key);
-
-        let g = P256Point::generator();
-        let public_key = g.scalar_mul(&key);
+        let public_key = P256Point::scalar_mul_generator(&key);
 
         Some(Self {
             private_key: key,
@@ -718,63 +681,47 @@ pub struct P256Signature {
 impl P256Signature {
     /// Sign a message hash
     pub fn sign(private_key: &[u8], hash: &[u8]) -> Option<Self> {
-        if private_key.len() != 32 || hash.len() != 32 {
-            return None;
-        }
+        let private_key: &[u8; 32] = private_key.try_into().ok()?;
+        let hash: &[u8; 32] = hash.try_into().ok()?;
 
-        let n = BigInt::from_bytes_be(&N_BYTES);
-        let d = BigInt::from_bytes_be(private_key);
-        let z = BigInt::from_bytes_be(hash);
+        let d = Scalar::from_bytes_reduced(private_key);
+        let z = Scalar::from_bytes_reduced(hash);
 
         // Generate random k
         let mut k_bytes = [0u8; 32];
         loop {
             random_bytes(&mut k_bytes).ok()?;
 
-            let k = BigInt::from_bytes_be(&k_bytes);
-            if k.is_zero() || k >= n {
-                continue;
-            }
+            let k = match Scalar::from_bytes(&k_bytes) {
+                Some(k) if !k.is_zero() => k,
+                _ => continue,
+            };
 
             // R = k * G
-            let g = P256Point::generator();
-            let r_point = g.scalar_mul(&k_bytes);
+            let r_point = P256Point::scalar_mul_generator(&k_bytes);
             if r_point.infinity {
                 continue;
             }
 
             // r = R.x mod n
-            let r = BigInt::from_bytes_be(&r_point.x.to_bytes()).mod_reduce(&n);
+            let r = Scalar::from_bytes_reduced(&r_point.x.to_bytes());
             if r.is_zero() {
                 continue;
             }
 
             // s = k^(-1) * (z + r*d) mod n
-            let k_inv = match k.mod_inverse(&n) {
-                Some(inv) => inv,
-                None => continue,
-            };
-
-            let rd = r.mul(&d).mod_reduce(&n);
-            let z_rd = z.add(&rd).mod_reduce(&n);
-            let s = k_inv.mul(&z_rd).mod_reduce(&n);
-
+            let s = k.invert().mul(&z.add(&r.mul(&d)));
             if s.is_zero() {
                 continue;
             }
 
             // Low-S normalization: if s > n/2, use n - s
-            let n_half = n.div(&BigInt::from_u64(2)).0;
-            let s_normalized = if s > n_half { n.sub(&s) } else { s };
-
-            let mut sig = P256Signature {
-                r: [0u8; 32],
-                s: [0u8; 32],
-            };
-            sig.r.copy_from_slice(&r.to_bytes_be_padded(32));
-            sig.s.copy_from_slice(&s_normalized.to_bytes_be_padded(32));
+            let s = if s.is_high() { s.neg() } else { s };
 
-            return Some(sig);
+            return Some(P256Signature {
+                r: r.to_bytes(),
+                s: s.to_bytes(),
+            });
         }
     }
 
@@ -786,45 +733,39 @@ impl P256Signature {
 
     /// Verify signature against message hash
     pub fn verify(&self, public_key: &P256Point, hash: &[u8]) -> bool {
-        if hash.len() != 32 || public_key.infinity {
+        let hash: &[u8; 32] = match hash.try_into() {
+            Ok(hash) => hash,
+            Err(_) => return false,
+        };
+        if public_key.infinity {
             return false;
         }
 
-        let n = BigInt::from_bytes_be(&N_BYTES);
-        let r = BigInt::from_bytes_be(&self.r);
-        let s = BigInt::from_bytes_be(&self.s);
-        let z = BigInt::from_bytes_be(hash);
-
         // Check r, s in [1, n-1]
-        if r.is_zero() || r >= n || s.is_zero() || s >= n {
-            return false;
-        }
-
-        // w = s^(-1) mod n
-        let w = match s.mod_inverse(&n) {
-            Some(inv) => inv,
-            None => return false,
+        let (r, s) = match (Scalar::from_bytes(&self.r), Scalar::from_bytes(&self.s)) {
+            (Some(r), Some(s)) if !r.is_zero() && !s.is_zero() => (r, s),
+            _ => return false,
         };
+        let z = Scalar::from_bytes_reduced(hash);
 
-        // u1 = z * w mod n
-        let u1 = z.mul(&w).mod_reduce(&n);
-
-        // u2 = r * w mod n
-        let u2 = r.mul(&w).mod_reduce(&n);
+        // u1 = z * w, u2 = r * w, where w = s^(-1) mod n
+        let w = s.invert();
+        let u1 = z.mul(&w);
+        let u2 = r.mul(&w);
 
         // R = u1*G + u2*Q
-        let g = P256Point::generator();
-        let u1_g = g.scalar_mul(&u1.to_bytes_be_padded(32));
-        let u2_q = public_key.scalar_mul(&u2.to_bytes_be_padded(32));
-        let r_point = u1_g.add(&u2_q);
+        let q = AffinePoint {
+            x: public_key.x,
+            y: public_key.y,
+        };
+        let r_point = mul_generator_add_vartime(&u1.to_bytes(), &u2.to_bytes(), &q).to_affine();
 
         if r_point.infinity {
             return false;
         }
 
         // r == R.x mod n
-        let rx = BigInt::from_bytes_be(&r_point.x.to_bytes()).mod_reduce(&n);
-        rx == r
+        Scalar::from_bytes_reduced(&r_point.x.to_bytes()) == r
     }
 
     /// Verify signature against message (hash first)
@@ -940,31 +881,6 @@ impl P256Signature {
     }
 }
 
-// ============================================================================
-// Helper Functions
-// ============================================================================
-
-/// Modular exponentiation
-fn mod_exp(base: &BigInt, exp: &BigInt, modulus: &BigInt) -> BigInt {
-    if modulus == &BigInt::one() {
-        return BigInt::zero();
-    }
-
-    let mut result = BigInt::one();
-    let mut base = base.mod_reduce(modulus);
-    let mut exp = exp.clone();
-
-    while exp > BigInt::zero() {
-        if exp.is_odd() {
-            result = result.mul(&base).mod_reduce(modulus);
-        }
-        exp = exp.div(&BigInt::from_u64(2)).0;
-        base = base.mul(&base).mod_reduce(modulus);
-    }
-
-    result
-}
-
 // ============================================================================
 // C ABI Exports
 // ============================================================================
@@ -1123,4 +1039,141 @@ mod tests {
         assert_eq!(sig.r, sig2.r);
         assert_eq!(sig.s, sig2.s);
     }
+
+    fn bytes32(hex: &str) -> [u8; 32] {
+        crate::encoding::hex_decode(hex)
+            .unwrap()
+            .try_into()
+            .unwrap()
+    }
+
+    fn point(x: &str, y: &str) -> P256Point {
+        P256Point::from_affine(&bytes32(x), &bytes32(y)).unwrap()
+    }
+
+    /// Deterministic scalars spread over the whole range
+    fn scalars() -> Vec<[u8; 32]> {
+        let mut k = [0u8; 32];
+        (0..8)
+            .map(|i| {
+                for (j, b) in k.iter_mut().enumerate() {
+                    *b = b.wrapping_mul(167).wrapping_add((i * 31 + j) as u8);
+                }
+                k
+            })
+            .collect()
+    }
+
+    #[test]
+    fn test_small_and_edge_multiples() {
+        let g = P256Point::generator();
+        let two_g = point(
+            "7cf27b188d034f7e8a52380304b51ac3c08969e277f21b35a60b48fc47669978",
+            "07775510db8ed040293d9ac69f7430dbba7dade63ce982299e04b79d227873d1",
+        );
+        let minus_g = point(
+            "6b17d1f2e12c4247f8bce6e563a440f277037d812deb33a0f4a13945d898c296",
+            "b01cbd1c01e58065711814b583f061e9d431cca994cea1313449bf97c840ae0a",
+        );
+        let mut n_minus_1 = N_BYTES;
+        n_minus_1[31] -= 1;
+
+        for mul in [
+            |k: &[u8]| P256Point::generator().scalar_mul(k),
+            P256Point::scalar_mul_generator,
+        ] {
+            assert_eq!(mul(&[1]).to_uncompressed(), g.to_uncompressed());
+            assert_eq!(mul(&[2]).to_uncompressed(), two_g.to_uncompressed());
+            assert_eq!(mul(&n_minus_1).to_uncompressed(), minus_g.to_uncompressed());
+            assert!(mul(&N_BYTES).infinity);
+            assert!(mul(&[0; 32]).infinity);
+        }
+    }
+
+    #[test]
+    fn test_comb_matches_window() {
+        let g = P256Point::generator();
+        for k in scalars() {
+            assert_eq!(
+                P256Point::scalar_mul_generator(&k).to_uncompressed(),
+                g.scalar_mul(&k).to_uncompressed()
+            );
+        }
+    }
+
+    #[test]
+    fn test_ecdh_cavp_vector() {
+        // NIST CAVS 14.1 KAS ECC CDH primitive, P-256, COUNT = 0
+        let peer = point(
+            "700c48f77f56584c5cc632ca65640db91b6bacce3a4df6b42ce7cc838833d287",
+            "db71e509e3fd9b060ddb20ba5c51dcc5948d46fbf640dfe0441782cab85fa4ac",
+        );
+        let kp = P256KeyPair::from_private_key(&bytes32(
+            "7d7dc5f71eb29ddaf80d6214632eeae03d9058af1fb6d22ed80badb62bc1a534",
+        ))
+        .unwrap();
+        let expected_public = point(
+            "ead218590119e8876b29146ff89ca61770c4edbbf97d38ce385ed281d8a6b230",
+            "28af61281fd35e2fa7002523acc85a429cb06ee6648325389f59edfce1405141",
+        );
+        assert_eq!(
+            kp.public_key.to_uncompressed(),
+            expected_public.to_uncompressed()
+        );
+        assert_eq!(
+            kp.ecdh(&peer).unwrap(),
+            bytes32("46fc62106420ff012e54a434fbdd2d25ccc5852060561e68040dd7778997bd7b")
+        );
+    }
+
+    #[test]
+    fn test_verify_known_signature() {
+        // Signature of SHA-256("sample") made with a fixed nonce
+        let kp = P256KeyPair::from_private_key(&bytes32(
+            "7d7dc5f71eb29ddaf80d6214632eeae03d9058af1fb6d22ed80badb62bc1a534",
+        ))
+        .unwrap();
+        let sig = P256Signature {
+            r: bytes32("efd48b2aacb6a8fd1140dd9cd45e81d69d2c877b56aaf991c34d0ea84eaf3716"),
+            s: bytes32("74b2ac3a50e8ff21cd1b1ffb726855be03b795e374d84762f431f10652764acf"),
+        };
+        assert!(sig.verify_message(&kp.public_key, b"sample"));
+        assert!(!sig.verify_message(&kp.public_key, b"Sample"));
+
+        let mut bad = sig.clone();
+        bad.s[31] ^= 1;
+        assert!(!bad.verify_message(&kp.public_key, b"sample"));
+        let high_r = P256Signature {
+            r: N_BYTES,
+            s: sig.s,
+        };
+        assert!(!high_r.verify_message(&kp.public_key, b"sample"));
+    }
+
+    #[test]
+    fn test_wnaf_digits() {
+        for k in scalars() {
+            for w in [5, 7] {
+                // Rebuild the value from its digits
+                let mut acc = [0i128; 3];
+                let digits = wnaf(&k, w);
+                for &d in digits.iter().rev() {
+                    assert!(d == 0 || (d % 2 != 0 && (d as i32).abs() < 1 << (w - 1)));
+                    // acc = 2·acc + d, in 96-bit pieces, least significant first
+                    let mut carry = d as i128;
+                    for part in acc.iter_mut() {
+                        let v = *part * 2 + carry;
+                        *part = v & ((1 << 96) - 1);
+                        carry = v >> 96;
+                    }
+                }
+                let mut bytes = [0u8; 36];
+                for (i, part) in acc.iter().enumerate() {
+                    bytes[36 - 12 * (i + 1)..36 - 12 * i]
+                        .copy_from_slice(&(*part as u128).to_be_bytes()[4..]);
+                }
+                assert_eq!(&bytes[4..], &k[..]);
+            }
+        }
+    }
 }
@@ -0,0 +1,344 @@
+//! P-256 field and scalar arithmetic
+//!
+//! Elements are four 64-bit little-endian limbs in Montgomery form
+//! (a·2^256 mod m), using the limb routines in [`crate::montgomery`].
+//! [`Fe`] works modulo the field prime p and [`Scalar`] modulo the group
+//! order n. The routines are inlined with the modulus as a constant, so
+//! the compiler drops the work for p's zero limb and its reduction factor
+//! of 1.
+//!
+//! Arithmetic never branches on or indexes memory by element values. Only
+//! parsing and the few comparisons documented as variable-time look at
+//! the values, and those are only used on public data.
+
+use crate::montgomery::{
+    add, from_montgomery, limbs_lt, mont_reduce, mul_wide, reduce_once, select, sqr_wide, sub,
+    to_montgomery, Limbs,
+};
+
+/// p = 2^256 - 2^224 + 2^192 + 2^96 - 1
+const P: Limbs = [
+    0xffffffffffffffff,
+    0x00000000ffffffff,
+    0x0000000000000000,
+    0xffffffff00000001,
+];
+/// 2^512 mod p, to convert into Montgomery form
+const P_R2: Limbs = [
+    0x0000000000000003,
+    0xfffffffbffffffff,
+    0xfffffffffffffffe,
+    0x00000004fffffffd,
+];
+/// -p^-1 mod 2^64
+const P_INV: u64 = 1;
+
+/// n, the order of the generator
+const N: Limbs = [
+    0xf3b9cac2fc632551,
+    0xbce6faada7179e84,
+    0xffffffffffffffff,
+    0xffffffff00000000,
+];
+/// 2^512 mod n
+const N_R2: Limbs = [
+    0x83244c95be79eea2,
+    0x4699799c49bd6fa6,
+    0x2845b2392b6bec59,
+    0x66e12d94f3d95620,
+];
+/// -n^-1 mod 2^64
+const N_INV: u64 = 0xccd1c8aaee00bc4f;
+
+/// Big-endian bytes to limbs
+fn limbs_from_be(bytes: &[u8; 32]) -> Limbs {
+    core::array::from_fn(|i| {
+        let at = 24 - 8 * i;
+        u64::from_be_bytes(bytes[at..at + 8].try_into().unwrap())
+    })
+}
+
+fn limbs_to_be(limbs: &Limbs) -> [u8; 32] {
+    let mut out = [0u8; 32];
+    for (i, limb) in limbs.iter().enumerate() {
+        let at = 24 - 8 * i;
+        out[at..at + 8].copy_from_slice(&limb.to_be_bytes());
+    }
+    out
+}
+
+// ============================================================================
+// Field Elements (mod p)
+// ============================================================================
+
+/// Element of GF(p), kept fully reduced, so equal values have equal limbs
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub struct Fe(Limbs);
+
+impl Fe {
+    pub const ZERO: Self = Self([0; 4]);
+    /// 1 in Montgomery form (2^256 mod p)
+    pub const ONE: Self = Self([
+        0x0000000000000001,
+        0xffffffff00000000,
+        0xffffffffffffffff,
+        0x00000000fffffffe,
+    ]);
+    /// The curve coefficient b, in Montgomery form
+    pub const B: Self = Self([
+        0xd89cdf6229c4bddf,
+        0xacf005cd78843090,
+        0xe5a220abf7212ed6,
+        0xdc30061d04874834,
+    ]);
+
+    /// Parse a big-endian value, rejecting one that is not below p
+    pub fn from_bytes(bytes: &[u8; 32]) -> Option<Self> {
+        let limbs = limbs_from_be(bytes);
+        if !limbs_lt(&limbs, &P) {
+            return None;
+        }
+        Some(Self(to_montgomery(&limbs, &P_R2, &P, P_INV)))
+    }
+
+    /// Canonical big-endian encoding
+    pub fn to_bytes(&self) -> [u8; 32] {
+        limbs_to_be(&from_montgomery(&self.0, &P, P_INV))
+    }
+
+    #[inline]
+    pub fn add(&self, other: &Self) -> Self {
+        Self(add(&self.0, &other.0, &P))
+    }
+
+    #[inline]
+    pub fn sub(&self, other: &Self) -> Self {
+        Self(sub(&self.0, &other.0, &P))
+    }
+
+    #[inline]
+    pub fn double(&self) -> Self {
+        self.add(self)
+    }
+
+    #[inline]
+    pub fn neg(&self) -> Self {
+        Self::ZERO.sub(self)
+    }
+
+    #[inline]
+    pub fn mul(&self, other: &Self) -> Self {
+        Self(mont_reduce(&mul_wide(&self.0, &other.0), &P, P_INV))
+    }
+
+    #[inline]
+    pub fn square(&self) -> Self {
+        Self(mont_reduce(&sqr_wide(&self.0), &P, P_INV))
+    }
+
+    /// a^(2^n)
+    fn square_n(&self, n: usize) -> Self {
+        let mut a = *self;
+        for _ in 0..n {
+            a = a.square();
+        }
+        a
+    }
+
+    /// a^-1 = a^(p-2), or zero for zero
+    ///
+    /// The exponent's bits are, from the top: 32 ones, 31 zeros, a one, 96
+    /// zeros, 94 ones, a zero and a one. An addition chain over runs of
+    /// ones takes 255 squarings and 12 multiplications.
+    pub fn invert(&self) -> Self {
+        // xN = a^(2^N - 1), N ones
+        let x2 = self.square().mul(self);
+        let x3 = x2.square().mul(self);
+        let x6 = x3.square_n(3).mul(&x3);
+        let x12 = x6.square_n(6).mul(&x6);
+        let x15 = x12.square_n(3).mul(&x3);
+        let x30 = x15.square_n(15).mul(&x15);
+        let x32 = x30.square_n(2).mul(&x2);
+
+        let t = x32.square_n(32).mul(self);
+        let t = t.square_n(128).mul(&x32);
+        let t = t.square_n(32).mul(&x32);
+        let t = t.square_n(30).mul(&x30);
+        t.square_n(2).mul(self)
+    }
+
+    pub fn is_zero(&self) -> bool {
+        self.0.iter().fold(0, |acc, &l| acc | l) == 0
+    }
+
+    /// `a` where `mask` is 0, `b` where it is all ones
+    #[inline]
+    pub fn select(a: &Self, b: &Self, mask: u64) -> Self {
+        Self(select(&a.0, &b.0, mask))
+    }
+}
+
+// ============================================================================
+// Scalars (mod n)
+// ============================================================================
+
+/// Integer modulo the group order n, fully reduced
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub struct Scalar(Limbs);
+
+impl Scalar {
+    /// 1 in Montgomery form (2^256 mod n)
+    const ONE: Self = Self([
+        0x0c46353d039cdaaf,
+        0x4319055258e8617b,
+        0x0000000000000000,
+        0x00000000ffffffff,
+    ]);
+
+    /// Parse a big-endian value, rejecting one that is not below n
+    pub fn from_bytes(bytes: &[u8; 32]) -> Option<Self> {
+        let limbs = limbs_from_be(bytes);
+        if !limbs_lt(&limbs, &N) {
+            return None;
+        }
+        Some(Self(to_montgomery(&limbs, &N_R2, &N, N_INV)))
+    }
+
+    /// Parse a big-endian value and reduce it mod n, as ECDSA does with
+    /// hashes and x coordinates (any 256-bit value is below 2n)
+    pub fn from_bytes_reduced(bytes: &[u8; 32]) -> Self {
+        let limbs = reduce_once(&limbs_from_be(bytes), 0, &N);
+        Self(to_montgomery(&limbs, &N_R2, &N, N_INV))
+    }
+
+    /// Canonical big-endian encoding
+    pub fn to_bytes(&self) -> [u8; 32] {
+        limbs_to_be(&from_montgomery(&self.0, &N, N_INV))
+    }
+
+    #[inline]
+    pub fn add(&self, other: &Self) -> Self {
+        Self(add(&self.0, &other.0, &N))
+    }
+
+    #[inline]
+    pub fn neg(&self) -> Self {
+        Self(sub(&[0; 4], &self.0, &N))
+    }
+
+    #[inline]
+    pub fn mul(&self, other: &Self) -> Self {
+        Self(mont_reduce(&mul_wide(&self.0, &other.0), &N, N_INV))
+    }
+
+    #[inline]
+    fn square(&self) -> Self {
+        Self(mont_reduce(&sqr_wide(&self.0), &N, N_INV))
+    }
+
+    /// a^-1 = a^(n-2), or zero for zero
+    ///
+    /// Fixed 4-bit windows over the exponent. It is public, so skipping
+    /// the multiplication for a zero window leaks nothing about a.
+    pub fn invert(&self) -> Self {
+        const N_MINUS_2: Limbs = [N[0] - 2, N[1], N[2], N[3]];
+
+        let mut powers = [Self::ONE; 16];
+        for i in 1..16 {
+            powers[i] = powers[i - 1].mul(self);
+        }
+
+        let mut acc = Self::ONE;
+        for i in (0..64).rev() {
+            acc = acc.square().square().square().square();
+            let window = (N_MINUS_2[i / 16] >> (4 * (i % 16))) & 0xf;
+            if window != 0 {
+                acc = acc.mul(&powers[window as usize]);
+            }
+        }
+        acc
+    }
+
+    pub fn is_zero(&self) -> bool {
+        self.0.iter().fold(0, |acc, &l| acc | l) == 0
+    }
+
+    /// The value is above (n-1)/2 (variable-time, for low-S normalization
+    /// of a finished signature)
+    pub fn is_high(&self) -> bool {
+        const HALF_N: Limbs = [
+            (N[0] >> 1) | (N[1] << 63),
+            (N[1] >> 1) | (N[2] << 63),
+            (N[2] >> 1) | (N[3] << 63),
+            N[3] >> 1,
+        ];
+        let value = from_montgomery(&self.0, &N, N_INV);
+        limbs_lt(&HALF_N, &value)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn fe(hex: &str) -> Fe {
+        let bytes: [u8; 32] = crate::encoding::hex_decode(hex)
+            .unwrap()
+            .try_into()
+            .unwrap();
+        Fe::from_bytes(&bytes).unwrap()
+    }
+
+    #[test]
+    fn test_montgomery_constants() {
+        assert_eq!(P[0].wrapping_mul(P_INV), u64::MAX);
+        assert_eq!(N[0].wrapping_mul(N_INV), u64::MAX);
+
+        let mut one = [0u8; 32];
+        one[31] = 1;
+        assert_eq!(Fe::from_bytes(&one), Some(Fe::ONE));
+        assert_eq!(Scalar::from_bytes(&one), Some(Scalar::ONE));
+        assert_eq!(Fe::ONE.to_bytes(), one);
+    }
+
+    #[test]
+    fn test_field_arithmetic() {
+        // Values checked against Python integers
+        let a = fe("6b17d1f2e12c4247f8bce6e563a440f277037d812deb33a0f4a13945d898c296");
+        let b = fe("4fe342e2fe1a7f9b8ee7eb4a7c0f9e162bce33576b315ececbb6406837bf51f5");
+        assert_eq!(
+            a.mul(&b),
+            fe("823cd15f6dd3c71933565064513a6b2bd183e554c6a08622f713ebbbface98be")
+        );
+        assert_eq!(
+            a.add(&b),
+            fe("bafb14d5df46c1e387a4d22fdfb3df08a2d1b0d8991c926fc05779ae1058148b")
+        );
+        assert_eq!(
+            b.sub(&a),
+            fe("e4cb70ef1cee3d54962b0465186b5d23b4cab5d73d462b2dd71507225f268f5e")
+        );
+        assert_eq!(a.mul(&a.invert()), Fe::ONE);
+        assert_eq!(a.neg().add(&a), Fe::ZERO);
+
+        // (p - 1)^2 = 1
+        let minus_one = Fe::ZERO.sub(&Fe::ONE);
+        assert_eq!(minus_one.square(), Fe::ONE);
+        assert!(Fe::from_bytes(&limbs_to_be(&P)).is_none());
+    }
+
+    #[test]
+    fn test_scalar_arithmetic() {
+        let n = limbs_to_be(&N);
+        assert!(Scalar::from_bytes(&n).is_none());
+        assert!(Scalar::from_bytes_reduced(&n).is_zero());
+
+        let mut x = [0u8; 32];
+        x[31] = 7;
+        let seven = Scalar::from_bytes(&x).unwrap();
+        assert_eq!(seven.mul(&seven.invert()), Scalar::ONE);
+        assert_eq!(seven.add(&seven.neg()), Scalar::from_bytes_reduced(&n));
+        assert!(!seven.is_high());
+        assert!(seven.neg().is_high());
+    }
+}
@@ -17,9 +17,32 @@ pub const GRND_NONBLOCK: u32 = 0x0001;
 pub const GRND_RANDOM: u32 = 0x0002;
 pub const GRND_INSECURE: u32 = 0x0004;
 
+extern "C" {
+    /// libc getrandom(); nrlib serves small requests from its userspace CRNG
+    /// without entering the kernel
+    #[link_name = "getrandom"]
+    fn libc_getrandom(buf: *mut u8, buflen: usize, flags: u32) -> isize;
+}
+
 /// Get random bytes from the kernel
+///
+/// Requests without GRND_RANDOM go through libc so they can take its
+/// syscall-free fast path.
 #[inline]
 pub fn getrandom(buf: &mut [u8], flags: u32) -> Result<usize, i32> {
+    if buf.is_empty() {
+        return Ok(0);
+    }
+
+    if flags & GRND_RANDOM == 0 {
+        let ret = unsafe { libc_getrandom(buf.as_mut_ptr(), buf.len(), flags) };
+        return if ret < 0 {
+            Err(-std::io::Error::last_os_error().raw_os_error().unwrap_or(5)) // EIO
+        } else {
+            Ok(ret as usize)
+        };
+    }
+
     let ret: isize;
     unsafe {
         core::arch::asm!(
@@ -13,184 +13,11 @@
 
 use core::ptr;
 
-// ============================================================================
-// SHA-1 Constants
-// ============================================================================
-
-/// SHA-1 digest size in bytes
-pub const SHA1_DIGEST_SIZE: usize = 20;
-/// SHA-1 block size in bytes
-pub const SHA1_BLOCK_SIZE: usize = 64;
-
-/// Initial hash values
-const SHA1_H: [u32; 5] = [0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0];
-
-/// Round constants
-const SHA1_K: [u32; 4] = [0x5a827999, 0x6ed9eba1, 0x8f1bbcdc, 0xca62c1d6];
-
-// ============================================================================
-// SHA-1 Implementation
-// ============================================================================
-
-/// SHA-1 hasher state
-#[derive(Clone)]
-pub struct Sha1 {
-    state: [u32; 5],
-    buffer: [u8; SHA1_BLOCK_SIZE],
-    buffer_len: usize,
-    total_bits: u64,
-}
-
-impl Default for Sha1 {
-    fn default() -> Self {
-        Self::new()
-    }
-}
-
-impl Sha1 {
-    /// Create a new SHA-1 hasher
-    pub const fn new() -> Self {
-        Self {
-            state: SHA1_H,
-            buffer: [0u8; SHA1_BLOCK_SIZE],
-            buffer_len: 0,
-            total_bits: 0,
-        }
-    }
-
-    /// Reset hasher to initial state
-    pub fn reset(&mut self) {
-        self.state = SHA1_H;
-        self.buffer = [0u8; SHA1_BLOCK_SIZE];
-        self.buffer_len = 0;
-        self.total_bits = 0;
-    }
-
-    /// Update hash with input data
-    pub fn update(&mut self, data: &[u8]) {
-        let mut offset = 0;
-
-        // Fill buffer if we have pending data
-        if self.buffer_len > 0 {
-            let to_copy = core::cmp::min(SHA1_BLOCK_SIZE - self.buffer_len, data.len());
-            self.buffer[self.buffer_len..self.buffer_len + to_copy]
-                .copy_from_slice(&data[..to_copy]);
-            self.buffer_len += to_copy;
-            offset = to_copy;
-
-            if self.buffer_len == SHA1_BLOCK_SIZE {
-                let block = self.buffer;
-                self.process_block(&block);
-                self.buffer_len = 0;
-            }
-        }
+// The hash lives in the `nsha` crate (shared with the kernel), which uses
+// the SHA extensions when the CPU has them.
+pub use nsha::{sha1, Sha1, SHA1_BLOCK_SIZE, SHA1_DIGEST_SIZE};
 
-        // Process full blocks directly
-        while offset + SHA1_BLOCK_SIZE <= data.len() {
-            let block: [u8; SHA1_BLOCK_SIZE] =
-                data[offset..offset + SHA1_BLOCK_SIZE].try_into().unwrap();
-            self.process_block(&block);
-            offset += SHA1_BLOCK_SIZE;
-        }
-
-        // Buffer remaining data
-        if offset < data.len() {
-            let remaining = data.len() - offset;
-            self.buffer[..remaining].copy_from_slice(&data[offset..]);
-            self.buffer_len = remaining;
-        }
-
-        self.total_bits += (data.len() as u64) * 8;
-    }
-
-    /// Finalize and return the hash digest
-    pub fn finalize(&mut self) -> [u8; SHA1_DIGEST_SIZE] {
-        // Padding
-        let mut padding = [0u8; SHA1_BLOCK_SIZE * 2];
-        padding[0] = 0x80;
-
-        let padding_len = if self.buffer_len < 56 {
-            56 - self.buffer_len
-        } else {
-            120 - self.buffer_len
-        };
-
-        // SHA-1 uses big-endian length
-        let len_bytes = self.total_bits.to_be_bytes();
-        padding[padding_len..padding_len + 8].copy_from_slice(&len_bytes);
-
-        self.update(&padding[..padding_len + 8]);
-
-        // Output hash (big-endian)
-        let mut result = [0u8; SHA1_DIGEST_SIZE];
-        for (i, &val) in self.state.iter().enumerate() {
-            result[i * 4..(i + 1) * 4].copy_from_slice(&val.to_be_bytes());
-        }
-        result
-    }
-
-    fn process_block(&mut self, block: &[u8; SHA1_BLOCK_SIZE]) {
-        // Parse block into 16 big-endian 32-bit words and extend to 80
-        let mut w = [0u32; 80];
-        for i in 0..16 {
-            w[i] = u32::from_be_bytes([
-                block[i * 4],
-                block[i * 4 + 1],
-                block[i * 4 + 2],
-                block[i * 4 + 3],
-            ]);
-        }
-
-        // Message schedule expansion
-        for i in 16..80 {
-            w[i] = (w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16]).rotate_left(1);
-        }
-
-        let mut a = self.state[0];
-        let mut b = self.state[1];
-        let mut c = self.state[2];
-        let mut d = self.state[3];
-        let mut e = self.state[4];
-
-        for i in 0..80 {
-            let (f, k) = match i {
-                0..=19 => ((b & c) | ((!b) & d), SHA1_K[0]),
-                20..=39 => (b ^ c ^ d, SHA1_K[1]),
-                40..=59 => ((b & c) | (b & d) | (c & d), SHA1_K[2]),
-                _ => (b ^ c ^ d, SHA1_K[3]),
-            };
-
-            let temp = a
-                .rotate_left(5)
-                .wrapping_add(f)
-                .wrapping_add(e)
-                .wrapping_add(k)
-                .wrapping_add(w[i]);
-
-            e = d;
-            d = c;
-            c = b.rotate_left(30);
-            b = a;
-            a = temp;
-        }
-
-        self.state[0] = self.state[0].wrapping_add(a);
-        self.state[1] = self.state[1].wrapping_add(b);
-        self.state[2] = self.state[2].wrapping_add(c);
-        self.state[3] = self.state[3].wrapping_add(d);
-        self.state[4] = self.state[4].wrapping_add(e);
-    }
-}
-
-/// Compute SHA-1 hash (convenience function)
-///
-/// **WARNING**: SHA-1 is NOT secure for cryptographic purposes.
-/// Use only for file integrity verification or Git compatibility.
-pub fn sha1(data: &[u8]) -> [u8; SHA1_DIGEST_SIZE] {
-    let mut hasher = Sha1::new();
-    hasher.update(data);
-    hasher.finalize()
-}
+use nsha::SHA1_H;
 
 // ============================================================================
 // C ABI Exports
@@ -0,0 +1,5 @@
+fn main() {
+    // Link against NexaOS nrlib's libc (epoll, eventfd, clock_gettime)
+    println!("cargo:rustc-link-lib=c");
+    println!("cargo:rustc-cdylib-link-arg=--soname=libnevent.so.1");
+}
@@ -0,0 +1,58 @@
+//! NexaOS Event Library (nevent)
+//!
+//! The I/O reactor shared by the network libraries (nh2, nh3, ntcp2).
+//!
+//! ## Features
+//! - **epoll reactor** - one thread drives any number of sockets, sleeping
+//!   in the kernel until something is ready or a timer is due
+//! - **Hierarchical timer wheel** - O(1) arm/cancel for protocol timers
+//!   (QUIC loss detection and idle timeouts, HTTP/2 keepalives)
+//! - **eventfd waker** - wake or stop a reactor from another thread
+//!
+//! ## Usage
+//!
+//! ```rust,ignore
+//! use nevent::{Context, Interest, Reactor, Ready, Source};
+//!
+//! struct Conn { stream: std::net::TcpStream }
+//!
+//! impl Source for Conn {
+//!     fn on_ready(&mut self, cx: &mut Context<'_>, ready: Ready) {
+//!         // read what is available, write what fits, re-arm interest
+//!     }
+//! }
+//!
+//! let mut reactor = Reactor::new()?;
+//! reactor.register(fd, Interest::READABLE, Box::new(Conn { stream }))?;
+//! reactor.run()?;
+//! ```
+//!
+//! Protocol drivers built on it live next to each protocol: `nh2::reactor`,
+//! `nh3::reactor` and `ntcp2::reactor`.
+
+#![allow(non_camel_case_types)]
+
+// ============================================================================
+// Module Declarations
+// ============================================================================
+
+// epoll / eventfd / clock bindings
+mod sys;
+
+// Hierarchical timer wheel
+pub mod timer;
+
+// Event loop
+pub mod reactor;
+
+// ============================================================================
+// Re-exports
+// ============================================================================
+
+pub use reactor::{Context, Interest, Reactor, Ready, Source, TimerId, Token, Waker};
+pub use timer::{TimerKey, TimerWheel};
+
+/// Monotonic clock in nanoseconds, the time base of reactor timers
+pub fn monotonic_ns() -> u64 {
+    sys::monotonic_ns()
+}
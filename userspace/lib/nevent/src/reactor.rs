@@ -0,0 +1,618 @@
+//! epoll reactor
+//!
+//! A [`Reactor`] owns one epoll instance, the sources registered with it
+//! and one timer wheel. A source is a file descriptor plus a [`Source`]
+//! handler. Each turn of the loop sleeps in `epoll_wait` until the next
+//! timer is due, then dispatches I/O readiness and expired timers. A
+//! single thread can serve any number of connections this way without
+//! polling.
+//!
+//! Handlers get a [`Context`] that can re-arm interest, schedule and cancel
+//! timers, register new sources (a listener accepting connections) and
+//! close themselves. Other threads wake the loop through a [`Waker`], which
+//! is backed by an eventfd.
+
+use std::io;
+use std::sync::atomic::{AtomicBool, Ordering};
+use std::sync::Arc;
+use std::time::Duration;
+
+use crate::sys::{self, c_int, EpollEvent};
+use crate::timer::{TimerKey, TimerWheel};
+
+/// Events fetched per epoll_wait call
+const EVENT_BATCH: usize = 256;
+
+/// epoll data word of the wake eventfd
+const WAKE_DATA: u64 = u64::MAX;
+
+const NS_PER_MS: u64 = 1_000_000;
+
+// ============================================================================
+// Interest and Readiness
+// ============================================================================
+
+/// Readiness a source wants to hear about
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct Interest(u32);
+
+impl Interest {
+    pub const READABLE: Interest = Interest(sys::EPOLLIN | sys::EPOLLRDHUP);
+    pub const WRITABLE: Interest = Interest(sys::EPOLLOUT);
+    pub const BOTH: Interest = Interest(sys::EPOLLIN | sys::EPOLLRDHUP | sys::EPOLLOUT);
+    /// Timers only; the descriptor stays registered but silent
+    pub const NONE: Interest = Interest(0);
+
+    pub fn add(self, other: Interest) -> Interest {
+        Interest(self.0 | other.0)
+    }
+
+    pub fn remove(self, other: Interest) -> Interest {
+        Interest(self.0 & !other.0)
+    }
+
+    pub fn is_writable(self) -> bool {
+        self.0 & sys::EPOLLOUT != 0
+    }
+}
+
+/// Readiness reported for a source
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct Ready(u32);
+
+impl Ready {
+    pub fn is_readable(self) -> bool {
+        self.0 & (sys::EPOLLIN | sys::EPOLLPRI) != 0
+    }
+
+    pub fn is_writable(self) -> bool {
+        self.0 & sys::EPOLLOUT != 0
+    }
+
+    /// Peer closed its side (reads will hit EOF)
+    pub fn is_hup(self) -> bool {
+        self.0 & (sys::EPOLLHUP | sys::EPOLLRDHUP) != 0
+    }
+
+    pub fn is_error(self) -> bool {
+        self.0 & sys::EPOLLERR != 0
+    }
+
+    /// Set by [`Reactor::schedule`] rather than by the descriptor
+    pub fn is_scheduled(self) -> bool {
+        self.0 == 0
+    }
+}
+
+// ============================================================================
+// Handlers
+// ============================================================================
+
+/// Identifies a registered source; stale tokens are ignored
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub struct Token {
+    index: u32,
+    generation: u32,
+}
+
+impl Token {
+    fn data(self) -> u64 {
+        ((self.generation as u64) << 32) | self.index as u64
+    }
+
+    fn from_data(data: u64) -> Self {
+        Self {
+            index: data as u32,
+            generation: (data >> 32) as u32,
+        }
+    }
+}
+
+/// Handle to a timer set through [`Context::set_timer`]
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub struct TimerId(TimerKey);
+
+/// Event handler for one registered descriptor
+///
+/// The handler owns the descriptor (a socket, usually) and closes it when
+/// dropped; the reactor drops the handler once it is deregistered.
+pub trait Source {
+    /// The descriptor is ready, or the source was scheduled
+    fn on_ready(&mut self, cx: &mut Context<'_>, ready: Ready);
+
+    /// A timer this source set has expired
+    fn on_timer(&mut self, cx: &mut Context<'_>, timer: TimerId) {
+        let _ = (cx, timer);
+    }
+}
+
+struct Slot {
+    generation: u32,
+    fd: c_int,
+    interest: Interest,
+    /// None while free, or while the handler is running
+    source: Option<Box<dyn Source>>,
+    live: bool,
+}
+
+// ============================================================================
+// Waker
+// ============================================================================
+
+struct WakeInner {
+    fd: c_int,
+    stop: AtomicBool,
+}
+
+impl Drop for WakeInner {
+    fn drop(&mut self) {
+        sys::close_fd(self.fd);
+    }
+}
+
+/// Wakes a reactor from another thread
+#[derive(Clone)]
+pub struct Waker {
+    inner: Arc<WakeInner>,
+}
+
+impl Waker {
+    /// Make the current or next `turn` return promptly
+    pub fn wake(&self) {
+        sys::eventfd_signal(self.inner.fd);
+    }
+
+    /// Make `run` return after the current turn
+    pub fn stop(&self) {
+        self.inner.stop.store(true, Ordering::Release);
+        self.wake();
+    }
+}
+
+// ============================================================================
+// Reactor
+// ============================================================================
+
+/// Single-threaded epoll event loop
+pub struct Reactor {
+    epfd: c_int,
+    wake: Arc<WakeInner>,
+    slots: Vec<Slot>,
+    free: Vec<u32>,
+    live: usize,
+    timers: TimerWheel<Token>,
+    events: Vec<EpollEvent>,
+    expired: Vec<(TimerKey, Token)>,
+    scheduled: Vec<Token>,
+    stopped: bool,
+}
+
+impl Reactor {
+    pub fn new() -> io::Result<Self> {
+        let epfd = sys::epoll_new()?;
+        let wake_fd = match sys::eventfd_new() {
+            Ok(fd) => fd,
+            Err(e) => {
+                sys::close_fd(epfd);
+                return Err(e);
+            }
+        };
+        let wake = Arc::new(WakeInner {
+            fd: wake_fd,
+            stop: AtomicBool::new(false),
+        });
+        sys::epoll_control(epfd, sys::EPOLL_CTL_ADD, wake_fd, sys::EPOLLIN, WAKE_DATA).map_err(
+            |e| {
+                sys::close_fd(epfd);
+                e
+            },
+        )?;
+
+        // Start the wheel at the current tick rather than at boot
+        let mut timers = TimerWheel::new();
+        timers.poll(sys::monotonic_ns() / NS_PER_MS, &mut Vec::new());
+
+        Ok(Self {
+            epfd,
+            wake,
+            slots: Vec::new(),
+            free: Vec::new(),
+            live: 0,
+            timers,
+            events: vec![EpollEvent { events: 0, data: 0 }; EVENT_BATCH],
+            expired: Vec::new(),
+            scheduled: Vec::new(),
+            stopped: false,
+        })
+    }
+
+    /// Handle for waking this reactor from other threads
+    pub fn waker(&self) -> Waker {
+        Waker {
+            inner: self.wake.clone(),
+        }
+    }
+
+    /// Number of registered sources
+    pub fn len(&self) -> usize {
+        self.live
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.live == 0
+    }
+
+    /// Monotonic clock in nanoseconds (the reactor's timer clock)
+    pub fn now(&self) -> u64 {
+        sys::monotonic_ns()
+    }
+
+    /// Watch `fd` for `interest`, dispatching to `source`
+    pub fn register(
+        &mut self,
+        fd: c_int,
+        interest: Interest,
+        source: Box<dyn Source>,
+    ) -> io::Result<Token> {
+        let index = match self.free.pop() {
+            Some(index) => index,
+            None => {
+                self.slots.push(Slot {
+                    generation: 0,
+                    fd: -1,
+                    interest: Interest::NONE,
+                    source: None,
+                    live: false,
+                });
+                (self.slots.len() - 1) as u32
+            }
+        };
+        let slot = &mut self.slots[index as usize];
+        let token = Token {
+            index,
+            generation: slot.generation,
+        };
+        if let Err(e) =
+            sys::epoll_control(self.epfd, sys::EPOLL_CTL_ADD, fd, interest.0, token.data())
+        {
+            self.free.push(index);
+            return Err(e);
+        }
+        slot.fd = fd;
+        slot.interest = interest;
+        slot.source = Some(source);
+        slot.live = true;
+        self.live += 1;
+        Ok(token)
+    }
+
+    /// Remove a source and drop its handler (closing its descriptor)
+    pub fn deregister(&mut self, token: Token) {
+        let Some(slot) = self.slot_mut(token) else {
+            return;
+        };
+        let fd = slot.fd;
+        let source = slot.source.take();
+        slot.live = false;
+        slot.fd = -1;
+        slot.generation = slot.generation.wrapping_add(1);
+        self.free.push(token.index);
+        self.live -= 1;
+        let _ = sys::epoll_control(self.epfd, sys::EPOLL_CTL_DEL, fd, 0, 0);
+        drop(source);
+    }
+
+    /// Change what a source is told about
+    pub fn set_interest(&mut self, token: Token, interest: Interest) -> io::Result<()> {
+        let epfd = self.epfd;
+        let Some(slot) = self.slot_mut(token) else {
+            return Ok(());
+        };
+        if slot.interest == interest {
+            return Ok(());
+        }
+        slot.interest = interest;
+        sys::epoll_control(epfd, sys::EPOLL_CTL_MOD, slot.fd, interest.0, token.data())
+    }
+
+    /// Call the source's `on_ready` on the next turn with no readiness set
+    ///
+    /// Used after work was queued on a connection from outside its handler
+    /// (a request submitted on a shared session, say) so it gets flushed.
+    pub fn schedule(&mut self, token: Token) {
+        self.scheduled.push(token);
+    }
+
+    /// Fire `on_timer` for `token` at monotonic time `deadline_ns`
+    pub fn set_timer(&mut self, token: Token, deadline_ns: u64) -> TimerId {
+        // Round up so a timer never fires before its deadline
+        let tick = deadline_ns.div_ceil(NS_PER_MS);
+        TimerId(self.timers.insert(tick, token))
+    }
+
+    pub fn cancel_timer(&mut self, timer: TimerId) {
+        self.timers.remove(timer.0);
+    }
+
+    /// Run until every source is gone or [`Waker::stop`] is called
+    pub fn run(&mut self) -> io::Result<()> {
+        self.stopped = false;
+        while !self.stopped && self.live > 0 {
+            self.turn(None)?;
+            if self.wake.stop.swap(false, Ordering::AcqRel) {
+                break;
+            }
+        }
+        Ok(())
+    }
+
+    /// Wait for events (at most `max_wait`) and dispatch them once
+    ///
+    /// Returns the number of handler calls made.
+    pub fn turn(&mut self, max_wait: Option<Duration>) -> io::Result<usize> {
+        let timeout_ms = self.wait_timeout(max_wait);
+        let n = sys::epoll_wait_events(self.epfd, &mut self.events, timeout_ms)?;
+        let mut dispatched = 0;
+
+        for i in 0..n {
+            let EpollEvent { events, data } = self.events[i];
+            if data == WAKE_DATA {
+                sys::eventfd_drain(self.wake.fd);
+                continue;
+            }
+            let token = Token::from_data(data);
+            dispatched += self.dispatch(token, |source, cx| source.on_ready(cx, Ready(events)));
+        }
+
+        for token in core::mem::take(&mut self.scheduled) {
+            dispatched += self.dispatch(token, |source, cx| source.on_ready(cx, Ready(0)));
+        }
+
+        let now_tick = sys::monotonic_ns() / NS_PER_MS;
+        let mut expired = core::mem::take(&mut self.expired);
+        self.timers.poll(now_tick, &mut expired);
+        for (key, token) in expired.drain(..) {
+            let timer = TimerId(key);
+            dispatched += self.dispatch(token, |source, cx| source.on_timer(cx, timer));
+        }
+        self.expired = expired;
+
+        // A full batch means more events are likely waiting
+        if n == self.events.len() && self.events.len() < EVENT_BATCH * 16 {
+            self.events
+                .resize(self.events.len() * 2, EpollEvent { events: 0, data: 0 });
+        }
+        Ok(dispatched)
+    }
+
+    /// epoll_wait timeout: until the next timer, capped by `max_wait`
+    fn wait_timeout(&self, max_wait: Option<Duration>) -> c_int {
+        if !self.scheduled.is_empty() {
+            return 0;
+        }
+        let mut wait_ms = max_wait.map(|d| d.as_millis().min(c_int::MAX as u128) as u64);
+        if let Some(tick) = self.timers.next_deadline() {
+            let now_tick = sys::monotonic_ns() / NS_PER_MS;
+            let until = tick.saturating_sub(now_tick);
+            wait_ms = Some(wait_ms.map_or(until, |w| w.min(until)));
+        }
+        match wait_ms {
+            Some(ms) => ms.min(c_int::MAX as u64) as c_int,
+            None => -1,
+        }
+    }
+
+    fn slot_mut(&mut self, token: Token) -> Option<&mut Slot> {
+        self.slots
+            .get_mut(token.index as usize)
+            .filter(|slot| slot.live && slot.generation == token.generation)
+    }
+
+    /// Run one handler call with its source taken out of the table
+    fn dispatch(
+        &mut self,
+        token: Token,
+        call: impl FnOnce(&mut dyn Source, &mut Context<'_>),
+    ) -> usize {
+        let Some(mut source) = self.slot_mut(token).and_then(|slot| slot.source.take()) else {
+            return 0;
+        };
+        let mut cx = Context {
+            reactor: self,
+            token,
+            close: false,
+        };
+        call(source.as_mut(), &mut cx);
+        let close = cx.close;
+
+        match self.slot_mut(token) {
+            Some(slot) if !close => slot.source = Some(source),
+            Some(_) => {
+                self.slots[token.index as usize].source = Some(source);
+                self.deregister(token);
+            }
+            // Deregistered through the reactor while running
+            None => drop(source),
+        }
+        1
+    }
+}
+
+impl Drop for Reactor {
+    fn drop(&mut self) {
+        // Handlers close their own descriptors
+        self.slots.clear();
+        sys::close_fd(self.epfd);
+    }
+}
+
+// ============================================================================
+// Handler Context
+// ============================================================================
+
+/// What a handler can do to its reactor while it runs
+pub struct Context<'a> {
+    reactor: &'a mut Reactor,
+    token: Token,
+    close: bool,
+}
+
+impl Context<'_> {
+    /// Token of the source being dispatched
+    pub fn token(&self) -> Token {
+        self.token
+    }
+
+    /// Monotonic clock in nanoseconds
+    pub fn now(&self) -> u64 {
+        sys::monotonic_ns()
+    }
+
+    /// Change this source's interest
+    pub fn set_interest(&mut self, interest: Interest) -> io::Result<()> {
+        self.reactor.set_interest(self.token, interest)
+    }
+
+    /// Fire this source's `on_timer` at monotonic time `deadline_ns`
+    pub fn set_timer(&mut self, deadline_ns: u64) -> TimerId {
+        self.reactor.set_timer(self.token, deadline_ns)
+    }
+
+    /// Fire this source's `on_timer` after `delay`
+    pub fn set_timeout(&mut self, delay: Duration) -> TimerId {
+        let deadline = sys::monotonic_ns().saturating_add(delay.as_nanos() as u64);
+        self.reactor.set_timer(self.token, deadline)
+    }
+
+    pub fn cancel_timer(&mut self, timer: TimerId) {
+        self.reactor.cancel_timer(timer);
+    }
+
+    /// Register another source (an accepted connection, say)
+    pub fn register(
+        &mut self,
+        fd: c_int,
+        interest: Interest,
+        source: Box<dyn Source>,
+    ) -> io::Result<Token> {
+        self.reactor.register(fd, interest, source)
+    }
+
+    /// Deregister and drop this source once the handler returns
+    pub fn close(&mut self) {
+        self.close = true;
+    }
+
+    /// Reach the reactor itself (to deregister or schedule other sources)
+    pub fn reactor(&mut self) -> &mut Reactor {
+        self.reactor
+    }
+
+    /// Make `run` return after this turn
+    pub fn stop(&mut self) {
+        self.reactor.stopped = true;
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::cell::RefCell;
+    use std::io::{Read, Write};
+    use std::os::fd::AsRawFd;
+    use std::os::unix::net::UnixStream;
+    use std::rc::Rc;
+
+    struct Echo {
+        stream: UnixStream,
+        log: Rc<RefCell<Vec<String>>>,
+    }
+
+    impl Source for Echo {
+        fn on_ready(&mut self, cx: &mut Context<'_>, ready: Ready) {
+            if ready.is_readable() {
+                let mut buf = [0u8; 64];
+                match self.stream.read(&mut buf) {
+                    Ok(0) => cx.close(),
+                    Ok(n) => {
+                        let text = String::from_utf8_lossy(&buf[..n]).into_owned();
+                        self.log.borrow_mut().push(text);
+                        cx.set_timeout(Duration::from_millis(5));
+                    }
+                    Err(_) => {}
+                }
+            }
+        }
+
+        fn on_timer(&mut self, _cx: &mut Context<'_>, _timer: TimerId) {
+            self.log.borrow_mut().push("timer".to_string());
+            let _ = self.stream.write_all(b"pong");
+        }
+    }
+
+    #[test]
+    fn test_readiness_timer_and_close() {
+        let mut reactor = Reactor::new().unwrap();
+        let (ours, mut theirs) = UnixStream::pair().unwrap();
+        ours.set_nonblocking(true).unwrap();
+        let log = Rc::new(RefCell::new(Vec::new()));
+        let fd = ours.as_raw_fd();
+        reactor
+            .register(
+                fd,
+                Interest::READABLE,
+                Box::new(Echo {
+                    stream: ours,
+                    log: log.clone(),
+                }),
+            )
+            .unwrap();
+
+        theirs.write_all(b"ping").unwrap();
+        reactor.turn(Some(Duration::from_millis(100))).unwrap();
+        assert_eq!(log.borrow().as_slice(), ["ping"]);
+
+        // The next turn sleeps until the 5ms timer
+        while log.borrow().len() < 2 {
+            reactor.turn(Some(Duration::from_secs(1))).unwrap();
+        }
+        assert_eq!(log.borrow()[1], "timer");
+        let mut buf = [0u8; 4];
+        theirs.read_exact(&mut buf).unwrap();
+        assert_eq!(&buf, b"pong");
+
+        drop(theirs);
+        reactor.run().unwrap();
+        assert!(reactor.is_empty());
+    }
+
+    #[test]
+    fn test_waker_from_other_thread() {
+        let mut reactor = Reactor::new().unwrap();
+        let waker = reactor.waker();
+        let handle = std::thread::spawn(move || {
+            std::thread::sleep(Duration::from_millis(10));
+            waker.wake();
+        });
+        // Would block forever without the wake
+        reactor.turn(None).unwrap();
+        handle.join().unwrap();
+    }
+
+    #[test]
+    fn test_stale_token_ignored() {
+        let mut reactor = Reactor::new().unwrap();
+        let (a, _b) = UnixStream::pair().unwrap();
+        let log = Rc::new(RefCell::new(Vec::new()));
+        let fd = a.as_raw_fd();
+        let token = reactor
+            .register(fd, Interest::READABLE, Box::new(Echo { stream: a, log }))
+            .unwrap();
+        let timer = reactor.set_timer(token, 0);
+        reactor.deregister(token);
+        reactor.cancel_timer(timer);
+        reactor.schedule(token);
+        assert_eq!(reactor.turn(Some(Duration::ZERO)).unwrap(), 0);
+        assert!(reactor.is_empty());
+    }
+}
@@ -0,0 +1,115 @@
+//! Raw epoll, eventfd and clock bindings
+//!
+//! Declared against the C library (nrlib on NexaOS), which forwards them
+//! to the kernel's epoll and eventfd implementation.
+
+use std::io;
+
+pub type c_int = i32;
+
+pub const EPOLLIN: u32 = 0x001;
+pub const EPOLLPRI: u32 = 0x002;
+pub const EPOLLOUT: u32 = 0x004;
+pub const EPOLLERR: u32 = 0x008;
+pub const EPOLLHUP: u32 = 0x010;
+pub const EPOLLRDHUP: u32 = 0x2000;
+
+pub const EPOLL_CTL_ADD: c_int = 1;
+pub const EPOLL_CTL_DEL: c_int = 2;
+pub const EPOLL_CTL_MOD: c_int = 3;
+
+pub const EPOLL_CLOEXEC: c_int = 0x80000;
+pub const EFD_CLOEXEC: c_int = 0x80000;
+pub const EFD_NONBLOCK: c_int = 0x800;
+
+const CLOCK_MONOTONIC: c_int = 1;
+
+/// Kernel epoll_event (packed on x86_64)
+#[repr(C, packed)]
+#[derive(Clone, Copy)]
+pub struct EpollEvent {
+    pub events: u32,
+    pub data: u64,
+}
+
+#[repr(C)]
+struct Timespec {
+    tv_sec: i64,
+    tv_nsec: i64,
+}
+
+extern "C" {
+    fn epoll_create1(flags: c_int) -> c_int;
+    fn epoll_ctl(epfd: c_int, op: c_int, fd: c_int, event: *mut EpollEvent) -> c_int;
+    fn epoll_wait(epfd: c_int, events: *mut EpollEvent, maxevents: c_int, timeout: c_int) -> c_int;
+    fn eventfd(initval: u32, flags: c_int) -> c_int;
+    fn read(fd: c_int, buf: *mut u8, count: usize) -> isize;
+    fn write(fd: c_int, buf: *const u8, count: usize) -> isize;
+    fn close(fd: c_int) -> c_int;
+    fn clock_gettime(clock: c_int, tp: *mut Timespec) -> c_int;
+}
+
+fn cvt(ret: c_int) -> io::Result<c_int> {
+    if ret < 0 {
+        Err(io::Error::last_os_error())
+    } else {
+        Ok(ret)
+    }
+}
+
+pub fn epoll_new() -> io::Result<c_int> {
+    cvt(unsafe { epoll_create1(EPOLL_CLOEXEC) })
+}
+
+pub fn epoll_control(epfd: c_int, op: c_int, fd: c_int, events: u32, data: u64) -> io::Result<()> {
+    let mut event = EpollEvent { events, data };
+    cvt(unsafe { epoll_ctl(epfd, op, fd, &mut event) }).map(|_| ())
+}
+
+/// Wait up to `timeout_ms` (-1 = forever); an interrupted wait reports no events
+pub fn epoll_wait_events(
+    epfd: c_int,
+    events: &mut [EpollEvent],
+    timeout_ms: c_int,
+) -> io::Result<usize> {
+    let n = unsafe { epoll_wait(epfd, events.as_mut_ptr(), events.len() as c_int, timeout_ms) };
+    if n < 0 {
+        let err = io::Error::last_os_error();
+        if err.kind() == io::ErrorKind::Interrupted {
+            return Ok(0);
+        }
+        return Err(err);
+    }
+    Ok(n as usize)
+}
+
+pub fn eventfd_new() -> io::Result<c_int> {
+    cvt(unsafe { eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK) })
+}
+
+/// Add one to an eventfd counter
+pub fn eventfd_signal(fd: c_int) {
+    let one = 1u64.to_ne_bytes();
+    // A full counter (EAGAIN) still leaves the fd readable
+    unsafe { write(fd, one.as_ptr(), one.len()) };
+}
+
+/// Reset an eventfd counter to zero
+pub fn eventfd_drain(fd: c_int) {
+    let mut buf = [0u8; 8];
+    unsafe { read(fd, buf.as_mut_ptr(), buf.len()) };
+}
+
+pub fn close_fd(fd: c_int) {
+    unsafe { close(fd) };
+}
+
+/// CLOCK_MONOTONIC in nanoseconds
+pub fn monotonic_ns() -> u64 {
+    let mut ts = Timespec {
+        tv_sec: 0,
+        tv_nsec: 0,
+    };
+    unsafe { clock_gettime(CLOCK_MONOTONIC, &mut ts) };
+    ts.tv_sec as u64 * 1_000_000_000 + ts.tv_nsec as u64
+}
@@ -0,0 +1,391 @@
+//! Hierarchical timer wheel
+//!
+//! Timers are kept in four wheels of 64 slots. A level-0 slot spans one
+//! millisecond tick, and each level above spans 64 times more, so the
+//! wheels cover about 4.6 hours. A timer sits in the lowest level whose
+//! slot still separates its deadline from the current tick. When a
+//! higher-level slot comes due, its timers move down a level, until they
+//! reach level 0 and fire. Inserting and cancelling are O(1): each slot
+//! is an intrusive list threaded through the entry table. Finding the
+//! next deadline is a bit scan per level.
+//!
+//! This suits protocol timers, which are re-armed far more often than
+//! they fire. Examples are QUIC loss-detection and idle timers, and
+//! HTTP/2 keepalives.
+
+/// Bits of slot index per level
+const SLOT_BITS: u32 = 6;
+/// Slots per level
+const SLOTS: usize = 1 << SLOT_BITS;
+/// Number of levels
+const LEVELS: usize = 4;
+/// Ticks covered by all levels; later deadlines are parked at the top
+const MAX_SPAN: u64 = 1 << (SLOT_BITS as usize * LEVELS);
+
+/// End-of-list marker
+const NIL: u32 = u32::MAX;
+
+/// Handle to a scheduled timer
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub struct TimerKey {
+    index: u32,
+    generation: u32,
+}
+
+struct Entry<T> {
+    /// Deadline tick
+    when: u64,
+    generation: u32,
+    /// None while the entry is free
+    payload: Option<T>,
+    level: u8,
+    slot: u8,
+    prev: u32,
+    next: u32,
+}
+
+struct Level {
+    /// Bit per non-empty slot
+    occupied: u64,
+    heads: [u32; SLOTS],
+}
+
+impl Level {
+    const fn new() -> Self {
+        Self {
+            occupied: 0,
+            heads: [NIL; SLOTS],
+        }
+    }
+}
+
+/// Timers carrying a `T`, measured in ticks (milliseconds for the reactor)
+pub struct TimerWheel<T> {
+    levels: [Level; LEVELS],
+    entries: Vec<Entry<T>>,
+    free: Vec<u32>,
+    /// Tick up to which every timer has been handed out
+    elapsed: u64,
+    /// Timers inserted already due, fired on the next poll
+    due: Vec<u32>,
+    len: usize,
+}
+
+impl<T> Default for TimerWheel<T> {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl<T> TimerWheel<T> {
+    pub fn new() -> Self {
+        Self {
+            levels: [Level::new(), Level::new(), Level::new(), Level::new()],
+            entries: Vec::new(),
+            free: Vec::new(),
+            elapsed: 0,
+            due: Vec::new(),
+            len: 0,
+        }
+    }
+
+    /// Number of pending timers
+    pub fn len(&self) -> usize {
+        self.len
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.len == 0
+    }
+
+    /// Schedule `payload` for tick `when`
+    pub fn insert(&mut self, when: u64, payload: T) -> TimerKey {
+        let index = match self.free.pop() {
+            Some(index) => index,
+            None => {
+                self.entries.push(Entry {
+                    when: 0,
+                    generation: 0,
+                    payload: None,
+                    level: 0,
+                    slot: 0,
+                    prev: NIL,
+                    next: NIL,
+                });
+                (self.entries.len() - 1) as u32
+            }
+        };
+        let entry = &mut self.entries[index as usize];
+        entry.when = when;
+        entry.payload = Some(payload);
+        let key = TimerKey {
+            index,
+            generation: entry.generation,
+        };
+        self.len += 1;
+        self.place(index);
+        key
+    }
+
+    /// Cancel a timer, returning its payload if it had not fired yet
+    pub fn remove(&mut self, key: TimerKey) -> Option<T> {
+        let entry = self.entries.get(key.index as usize)?;
+        if entry.generation != key.generation || entry.payload.is_none() {
+            return None;
+        }
+        if entry.level as usize == LEVELS {
+            self.due.retain(|&i| i != key.index);
+        } else {
+            self.unlink(key.index);
+        }
+        Some(self.release(key.index).1)
+    }
+
+    /// Earliest tick at which `poll` will hand out a timer
+    pub fn next_deadline(&self) -> Option<u64> {
+        if !self.due.is_empty() {
+            return Some(self.elapsed);
+        }
+        self.next_expiration().map(|(_, _, deadline)| deadline)
+    }
+
+    /// Move the wheel to tick `now`, appending every timer due by then
+    pub fn poll(&mut self, now: u64, expired: &mut Vec<(TimerKey, T)>) {
+        for index in core::mem::take(&mut self.due) {
+            expired.push(self.release(index));
+        }
+
+        while let Some((level, slot, deadline)) = self.next_expiration() {
+            if deadline > now {
+                break;
+            }
+            self.elapsed = deadline;
+            let mut index = self.levels[level].heads[slot];
+            self.levels[level].heads[slot] = NIL;
+            self.levels[level].occupied &= !(1u64 << slot);
+            while index != NIL {
+                let next = self.entries[index as usize].next;
+                if self.entries[index as usize].when <= deadline {
+                    expired.push(self.release(index));
+                } else {
+                    // Cascade to a finer level
+                    self.place(index);
+                }
+                index = next;
+            }
+        }
+
+        if now > self.elapsed {
+            self.elapsed = now;
+        }
+    }
+
+    /// Put a linked-out entry into the slot for its deadline
+    fn place(&mut self, index: u32) {
+        let when = self.entries[index as usize].when;
+        if when <= self.elapsed {
+            let entry = &mut self.entries[index as usize];
+            entry.level = LEVELS as u8;
+            self.due.push(index);
+            return;
+        }
+
+        let target = when.min(self.elapsed + MAX_SPAN - 1);
+        let level = level_for(self.elapsed, target);
+        let slot = ((target >> (level as u32 * SLOT_BITS)) as usize) & (SLOTS - 1);
+
+        let head = self.levels[level].heads[slot];
+        {
+            let entry = &mut self.entries[index as usize];
+            entry.level = level as u8;
+            entry.slot = slot as u8;
+            entry.prev = NIL;
+            entry.next = head;
+        }
+        if head != NIL {
+            self.entries[head as usize].prev = index;
+        }
+        self.levels[level].heads[slot] = index;
+        self.levels[level].occupied |= 1u64 << slot;
+    }
+
+    fn unlink(&mut self, index: u32) {
+        let (level, slot, prev, next) = {
+            let entry = &self.entries[index as usize];
+            (
+                entry.level as usize,
+                entry.slot as usize,
+                entry.prev,
+                entry.next,
+            )
+        };
+        if prev == NIL {
+            self.levels[level].heads[slot] = next;
+            if next == NIL {
+                self.levels[level].occupied &= !(1u64 << slot);
+            }
+        } else {
+            self.entries[prev as usize].next = next;
+        }
+        if next != NIL {
+            self.entries[next as usize].prev = prev;
+        }
+    }
+
+    /// Free an entry and hand back its key and payload
+    fn release(&mut self, index: u32) -> (TimerKey, T) {
+        let entry = &mut self.entries[index as usize];
+        let key = TimerKey {
+            index,
+            generation: entry.generation,
+        };
+        entry.generation = entry.generation.wrapping_add(1);
+        entry.prev = NIL;
+        entry.next = NIL;
+        self.free.push(index);
+        self.len -= 1;
+        (key, entry.payload.take().expect("timer entry in use"))
+    }
+
+    /// Next occupied slot as (level, slot, tick at which it comes due)
+    fn next_expiration(&self) -> Option<(usize, usize, u64)> {
+        for (level, wheel) in self.levels.iter().enumerate() {
+            if wheel.occupied == 0 {
+                continue;
+            }
+            let shift = level as u32 * SLOT_BITS;
+            let slot_range = 1u64 << shift;
+            let level_range = slot_range << SLOT_BITS;
+
+            let now_slot = ((self.elapsed >> shift) as usize) & (SLOTS - 1);
+            let offset = wheel
+                .occupied
+                .rotate_right(now_slot as u32)
+                .trailing_zeros() as usize;
+            let slot = (now_slot + offset) & (SLOTS - 1);
+
+            let level_start = self.elapsed & !(level_range - 1);
+            let mut deadline = level_start + slot as u64 * slot_range;
+            if deadline <= self.elapsed {
+                // Wrapped past the end of this level's range
+                deadline += level_range;
+            }
+            return Some((level, slot, deadline));
+        }
+        None
+    }
+}
+
+/// Level whose slots first separate `elapsed` from `when`
+fn level_for(elapsed: u64, when: u64) -> usize {
+    let mut masked = (elapsed ^ when) | (SLOTS as u64 - 1);
+    if masked >= MAX_SPAN {
+        masked = MAX_SPAN - 1;
+    }
+    let significant = 63 - masked.leading_zeros();
+    (significant / SLOT_BITS) as usize
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn fire(wheel: &mut TimerWheel<u32>, now: u64) -> Vec<u32> {
+        let mut out = Vec::new();
+        wheel.poll(now, &mut out);
+        let mut out: Vec<u32> = out.into_iter().map(|(_, id)| id).collect();
+        out.sort();
+        out
+    }
+
+    #[test]
+    fn test_fires_at_deadline() {
+        let mut wheel = TimerWheel::new();
+        wheel.insert(5, 1);
+        wheel.insert(70, 2);
+        wheel.insert(5000, 3);
+        assert_eq!(wheel.next_deadline(), Some(5));
+        assert!(fire(&mut wheel, 4).is_empty());
+        assert_eq!(fire(&mut wheel, 5), vec![1]);
+        assert!(fire(&mut wheel, 69).is_empty());
+        assert_eq!(fire(&mut wheel, 70), vec![2]);
+        assert!(fire(&mut wheel, 4999).is_empty());
+        assert_eq!(fire(&mut wheel, 5000), vec![3]);
+        assert!(wheel.is_empty());
+        assert_eq!(wheel.next_deadline(), None);
+    }
+
+    #[test]
+    fn test_never_early_never_late() {
+        let mut wheel = TimerWheel::new();
+        let mut seed = 0x1234_5678u64;
+        let mut deadlines = Vec::new();
+        for i in 0..2000u32 {
+            seed = seed
+                .wrapping_mul(6364136223846793005)
+                .wrapping_add(1442695040888963407);
+            let when = (seed >> 33) % 300_000;
+            deadlines.push(when);
+            wheel.insert(when, i);
+        }
+        let mut now = 0;
+        let mut seen = 0;
+        while let Some(next) = wheel.next_deadline() {
+            assert!(next >= now);
+            now = next;
+            for id in fire(&mut wheel, now) {
+                assert_eq!(deadlines[id as usize], now);
+                seen += 1;
+            }
+        }
+        assert_eq!(seen, 2000);
+    }
+
+    #[test]
+    fn test_cancel_and_reuse() {
+        let mut wheel = TimerWheel::new();
+        let a = wheel.insert(10, 1);
+        let b = wheel.insert(10, 2);
+        assert_eq!(wheel.remove(a), Some(1));
+        assert_eq!(wheel.remove(a), None);
+        let c = wheel.insert(20, 3);
+        // The freed entry is reused under a new generation
+        assert_eq!(wheel.remove(a), None);
+        assert_eq!(fire(&mut wheel, 15), vec![2]);
+        assert_eq!(wheel.remove(b), None);
+        assert_eq!(wheel.remove(c), Some(3));
+        assert!(wheel.is_empty());
+    }
+
+    #[test]
+    fn test_past_and_distant_deadlines() {
+        let mut wheel = TimerWheel::new();
+        wheel.poll(1000, &mut Vec::new());
+        wheel.insert(10, 1);
+        assert_eq!(wheel.next_deadline(), Some(1000));
+        assert_eq!(fire(&mut wheel, 1000), vec![1]);
+
+        let far = 1000 + MAX_SPAN * 3 + 17;
+        wheel.insert(far, 2);
+        let mut now = 1000;
+        while let Some(next) = wheel.next_deadline() {
+            now = next;
+            let out = fire(&mut wheel, now);
+            if !out.is_empty() {
+                assert_eq!(out, vec![2]);
+                break;
+            }
+        }
+        assert_eq!(now, far);
+    }
+
+    #[test]
+    fn test_poll_skips_idle_time() {
+        let mut wheel = TimerWheel::new();
+        wheel.insert(100, 1);
+        assert_eq!(fire(&mut wheel, 1_000_000), vec![1]);
+        wheel.insert(1_000_064, 2);
+        assert_eq!(wheel.next_deadline(), Some(1_000_064));
+        assert_eq!(fire(&mut wheel, 1_000_064), vec![2]);
+    }
+}
@@ -6,6 +6,7 @@
 //! - **Full HTTP/2 protocol support** (RFC 7540, RFC 9113)
 //! - **nghttp2 C ABI compatibility** for drop-in replacement
 //! - **Tokio async backend** for high-performance I/O
+//! - **nevent reactor driver** for many connections on one thread
 //! - **HPACK header compression** (RFC 7541)
 //! - **Server push support**
 //! - **Flow control management**
@@ -107,6 +108,10 @@ pub mod stream;
 #[cfg(feature = "async-tokio")]
 pub mod async_io;
 
+// Event-loop driver (nevent epoll reactor)
+#[cfg(feature = "reactor")]
+pub mod reactor;
+
 // nghttp2 C ABI compatibility layer
 pub mod compat;
 
@@ -125,6 +130,9 @@ pub use types::*;
 #[cfg(feature = "async-tokio")]
 pub use async_io::{AsyncSession, Connection};
 
+#[cfg(feature = "reactor")]
+pub use reactor::{Http2Connection, Http2Listener};
+
 // ============================================================================
 // C Type Definitions (nghttp2 compatible)
 // ============================================================================
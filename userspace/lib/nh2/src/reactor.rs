@@ -0,0 +1,289 @@
+//! nevent driver for HTTP/2 connections
+//!
+//! Runs sessions over non-blocking TCP sockets on a shared [`Reactor`], so
+//! one thread serves any number of connections:
+//!
+//! - [`Http2Connection`] moves bytes between a socket and a [`Session`].
+//!   It reads whatever arrived, feeds it to `mem_recv`, and writes what
+//!   `mem_send` produced. It only asks for writability while the socket
+//!   is backed up.
+//! - [`Http2Listener`] accepts connections and registers a driver for each.
+//!
+//! With a keepalive interval set, an idle connection sends a PING. If
+//! nothing at all arrives for another interval, the connection is closed.
+//!
+//! The session is shared (`Arc<Session>`), so requests can be submitted
+//! from outside the handler. Call [`Reactor::schedule`] with the
+//! connection's token afterwards so the frames get flushed.
+//!
+//! ```rust,ignore
+//! use nevent::Reactor;
+//! use nh2::reactor::Http2Listener;
+//!
+//! let mut reactor = Reactor::new()?;
+//! Http2Listener::bind("0.0.0.0:8080", || Arc::new(make_server_session()))?
+//!     .keepalive(Duration::from_secs(30))
+//!     .register(&mut reactor)?;
+//! reactor.run()?;
+//! ```
+
+use std::io::{self, Read, Write};
+use std::net::{TcpListener, TcpStream, ToSocketAddrs};
+use std::os::fd::AsRawFd;
+use std::sync::Arc;
+use std::time::Duration;
+
+use nevent::{Context, Interest, Reactor, Ready, Source, TimerId, Token};
+
+use crate::error::ErrorCode;
+use crate::session::Session;
+
+/// Socket read size
+const READ_CHUNK: usize = 16 * 1024;
+
+/// Reads per readiness event, so one busy peer cannot starve the others
+const MAX_READS_PER_EVENT: usize = 16;
+
+/// Opaque data of keepalive PINGs
+const KEEPALIVE_PING: [u8; 8] = *b"nh2-keep";
+
+// ============================================================================
+// Connection Driver
+// ============================================================================
+
+/// One HTTP/2 session on one TCP socket
+pub struct Http2Connection {
+    session: Arc<Session>,
+    stream: TcpStream,
+    read_buf: Box<[u8]>,
+    /// Serialized frames the socket has not taken yet
+    pending: Vec<u8>,
+    pending_pos: usize,
+    keepalive: Option<Duration>,
+    keepalive_timer: Option<TimerId>,
+    /// Monotonic time of the last bytes received
+    last_recv: u64,
+    /// A keepalive PING went out after `last_recv`
+    ping_sent: bool,
+}
+
+impl Http2Connection {
+    /// Drive `session` over `stream` (switched to non-blocking)
+    pub fn new(session: Arc<Session>, stream: TcpStream) -> io::Result<Self> {
+        stream.set_nonblocking(true)?;
+        let _ = stream.set_nodelay(true);
+        Ok(Self {
+            session,
+            stream,
+            read_buf: vec![0u8; READ_CHUNK].into_boxed_slice(),
+            pending: Vec::new(),
+            pending_pos: 0,
+            keepalive: None,
+            keepalive_timer: None,
+            last_recv: nevent::monotonic_ns(),
+            ping_sent: false,
+        })
+    }
+
+    /// Connect to `addr` as an HTTP/2 client
+    pub fn connect<A: ToSocketAddrs>(addr: A, session: Arc<Session>) -> io::Result<Self> {
+        Self::new(session, TcpStream::connect(addr)?)
+    }
+
+    /// PING the peer after `interval` of silence, and close if it stays silent
+    pub fn keepalive(mut self, interval: Duration) -> Self {
+        self.keepalive = Some(interval);
+        self
+    }
+
+    /// The session this connection drives
+    pub fn session(&self) -> &Arc<Session> {
+        &self.session
+    }
+
+    /// Hand the connection to `reactor`; the client preface (or server
+    /// SETTINGS) goes out on the next turn
+    pub fn register(self, reactor: &mut Reactor) -> io::Result<Token> {
+        let fd = self.stream.as_raw_fd();
+        let token = reactor.register(fd, Interest::READABLE, Box::new(self))?;
+        reactor.schedule(token);
+        Ok(token)
+    }
+
+    /// Read what is available into the session; false once the
+    /// connection is finished
+    fn receive(&mut self, cx: &mut Context<'_>) -> bool {
+        for _ in 0..MAX_READS_PER_EVENT {
+            match self.stream.read(&mut self.read_buf) {
+                Ok(0) => return false,
+                Ok(n) => {
+                    self.last_recv = cx.now();
+                    self.ping_sent = false;
+                    if self.session.mem_recv(&self.read_buf[..n]).is_err() {
+                        let _ = self.session.terminate(ErrorCode::ProtocolError);
+                        self.flush(cx);
+                        return false;
+                    }
+                    if n < self.read_buf.len() {
+                        break;
+                    }
+                }
+                Err(e) if e.kind() == io::ErrorKind::WouldBlock => break,
+                Err(e) if e.kind() == io::ErrorKind::Interrupted => continue,
+                Err(_) => return false,
+            }
+        }
+        true
+    }
+
+    /// Write queued frames until done or the socket backs up; false on a
+    /// write error
+    fn flush(&mut self, cx: &mut Context<'_>) -> bool {
+        loop {
+            if self.pending_pos == self.pending.len() {
+                self.pending.clear();
+                self.pending_pos = 0;
+                if !self.session.want_write() {
+                    break;
+                }
+                self.pending = self.session.mem_send();
+                if self.pending.is_empty() {
+                    break;
+                }
+            }
+            match self.stream.write(&self.pending[self.pending_pos..]) {
+                Ok(0) => return false,
+                Ok(n) => self.pending_pos += n,
+                Err(e) if e.kind() == io::ErrorKind::WouldBlock => {
+                    let _ = cx.set_interest(Interest::BOTH);
+                    return true;
+                }
+                Err(e) if e.kind() == io::ErrorKind::Interrupted => {}
+                Err(_) => return false,
+            }
+        }
+        let _ = cx.set_interest(Interest::READABLE);
+        true
+    }
+
+    fn arm_keepalive(&mut self, cx: &mut Context<'_>, deadline: u64) {
+        if let Some(timer) = self.keepalive_timer.take() {
+            cx.cancel_timer(timer);
+        }
+        self.keepalive_timer = Some(cx.set_timer(deadline));
+    }
+}
+
+impl Source for Http2Connection {
+    fn on_ready(&mut self, cx: &mut Context<'_>, ready: Ready) {
+        if let (Some(interval), None) = (self.keepalive, self.keepalive_timer) {
+            let deadline = self.last_recv + interval.as_nanos() as u64;
+            self.arm_keepalive(cx, deadline);
+        }
+
+        if (ready.is_readable() || ready.is_hup()) && !self.receive(cx) {
+            cx.close();
+            return;
+        }
+        if ready.is_error() || !self.flush(cx) {
+            cx.close();
+            return;
+        }
+        let idle = self.pending_pos == self.pending.len();
+        if idle && !self.session.want_read() && !self.session.want_write() {
+            // GOAWAY exchanged and everything written
+            cx.close();
+        }
+    }
+
+    fn on_timer(&mut self, cx: &mut Context<'_>, timer: TimerId) {
+        if self.keepalive_timer != Some(timer) {
+            return;
+        }
+        self.keepalive_timer = None;
+        let Some(interval) = self.keepalive else {
+            return;
+        };
+        let interval = interval.as_nanos() as u64;
+        let now = cx.now();
+
+        if now < self.last_recv + interval {
+            // Heard from the peer since the timer was set
+            self.arm_keepalive(cx, self.last_recv + interval);
+        } else if self.ping_sent {
+            // Not even a PING ACK in a whole interval
+            cx.close();
+        } else if self.session.submit_ping(KEEPALIVE_PING).is_ok() && self.flush(cx) {
+            self.ping_sent = true;
+            self.arm_keepalive(cx, now + interval);
+        } else {
+            cx.close();
+        }
+    }
+}
+
+// ============================================================================
+// Listener
+// ============================================================================
+
+/// Accepts TCP connections and registers a session driver for each
+pub struct Http2Listener<F> {
+    listener: TcpListener,
+    new_session: F,
+    keepalive: Option<Duration>,
+}
+
+impl<F> Http2Listener<F>
+where
+    F: FnMut() -> Arc<Session> + 'static,
+{
+    /// Serve on `listener` (switched to non-blocking); `new_session` makes
+    /// the server session for each accepted connection
+    pub fn new(listener: TcpListener, new_session: F) -> io::Result<Self> {
+        listener.set_nonblocking(true)?;
+        Ok(Self {
+            listener,
+            new_session,
+            keepalive: None,
+        })
+    }
+
+    pub fn bind<A: ToSocketAddrs>(addr: A, new_session: F) -> io::Result<Self> {
+        Self::new(TcpListener::bind(addr)?, new_session)
+    }
+
+    /// Keepalive interval for accepted connections
+    pub fn keepalive(mut self, interval: Duration) -> Self {
+        self.keepalive = Some(interval);
+        self
+    }
+
+    pub fn register(self, reactor: &mut Reactor) -> io::Result<Token> {
+        let fd = self.listener.as_raw_fd();
+        reactor.register(fd, Interest::READABLE, Box::new(self))
+    }
+}
+
+impl<F> Source for Http2Listener<F>
+where
+    F: FnMut() -> Arc<Session> + 'static,
+{
+    fn on_ready(&mut self, cx: &mut Context<'_>, _ready: Ready) {
+        loop {
+            let stream = match self.listener.accept() {
+                Ok((stream, _)) => stream,
+                Err(e) if e.kind() == io::ErrorKind::Interrupted => continue,
+                // WouldBlock, or out of descriptors: try again next event
+                Err(_) => return,
+            };
+            let Ok(mut conn) = Http2Connection::new((self.new_session)(), stream) else {
+                continue;
+            };
+            conn.keepalive = self.keepalive;
+            let fd = conn.stream.as_raw_fd();
+            if let Ok(token) = cx.register(fd, Interest::READABLE, Box::new(conn)) {
+                cx.reactor().schedule(token);
+            }
+        }
+    }
+}
@@ -9,6 +9,7 @@
 //! - **QPACK header compression** (RFC 9204)
 //! - **Server push support**
 //! - **Priority handling** (RFC 9218)
+//! - **nevent reactor driver** for many connections on one thread
 //!
 //! ## Architecture
 //!
@@ -137,6 +138,10 @@ pub mod client;
 #[cfg(feature = "async-tokio")]
 pub mod async_io;
 
+// Event-loop driver (nevent epoll reactor)
+#[cfg(feature = "reactor")]
+pub mod reactor;
+
 // nghttp3 C ABI compatibility layer
 pub mod compat;
 
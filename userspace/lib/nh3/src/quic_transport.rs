@@ -609,6 +609,80 @@ impl QuicTransport {
         }
     }
 
+    /// Network path of this connection
+    pub fn path(&self) -> NgtcpPath {
+        let local_port = u16::from_be_bytes([self.local_addr[4], self.local_addr[5]]);
+        let remote_port = u16::from_be_bytes([self.remote_addr[4], self.remote_addr[5]]);
+        let mut local_ip = [0u8; 4];
+        local_ip.copy_from_slice(&self.local_addr[0..4]);
+        let mut remote_ip = [0u8; 4];
+        remote_ip.copy_from_slice(&self.remote_addr[0..4]);
+        NgtcpPath {
+            local: NgtcpAddr::from_ipv4(local_ip, local_port),
+            remote: NgtcpAddr::from_ipv4(remote_ip, remote_port),
+        }
+    }
+
+    /// Set the peer address (server side, once the first packet arrived)
+    pub fn set_remote_ipv4(&mut self, remote_ip: [u8; 4], remote_port: u16) {
+        self.remote_addr[0..4].copy_from_slice(&remote_ip);
+        self.remote_addr[4] = (remote_port >> 8) as u8;
+        self.remote_addr[5] = remote_port as u8;
+    }
+
+    /// Feed one received UDP datagram to the QUIC connection
+    pub fn read_packet(&self, data: &[u8], ts: u64) -> Result<()> {
+        if self.quic_conn.is_null() {
+            return Err(ErrorCode::InvalidState.into());
+        }
+
+        let path = self.path();
+        let pi = NgtcpPacketInfo::default();
+        let ret = unsafe {
+            ngtcp2_conn_read_pkt(self.quic_conn, &path, &pi, data.as_ptr(), data.len(), ts)
+        };
+
+        if ret < 0 {
+            Err(Error::QuicError(ret))
+        } else {
+            Ok(())
+        }
+    }
+
+    /// Write the next packet the connection has to send (acks, handshake,
+    /// retransmissions, queued stream data) into `dest`
+    ///
+    /// Returns the packet length, 0 when there is nothing to send.
+    pub fn write_packet(&self, dest: &mut [u8], ts: u64) -> Result<usize> {
+        if self.quic_conn.is_null() {
+            return Err(ErrorCode::InvalidState.into());
+        }
+
+        let mut path = self.path();
+        let mut pi = NgtcpPacketInfo::default();
+        let ret = unsafe {
+            ngtcp2_conn_writev_stream(
+                self.quic_conn,
+                &mut path,
+                &mut pi,
+                dest.as_mut_ptr(),
+                dest.len(),
+                core::ptr::null_mut(),
+                0,
+                -1,
+                core::ptr::null(),
+                0,
+                ts,
+            )
+        };
+
+        if ret < 0 {
+            Err(Error::QuicError(ret as i32))
+        } else {
+            Ok(ret as usize)
+        }
+    }
+
     /// Set HTTP/3 connection
     pub fn set_h3_conn(&mut self, h3_conn: *mut nghttp3_conn) {
         self.h3_conn = h3_conn;
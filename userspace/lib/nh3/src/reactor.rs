@@ -0,0 +1,200 @@
+//! nevent driver for HTTP/3 connections
+//!
+//! [`Http3Connection`] runs one [`QuicTransport`] over a connected
+//! non-blocking UDP socket on a shared [`Reactor`]. Many HTTP/3
+//! connections then run on one thread next to HTTP/2 connections and
+//! ntcp2 endpoints:
+//!
+//! - Each readable event reads datagrams until the socket is empty and
+//!   feeds them to the transport. Stream data reaches the HTTP/3 layer
+//!   through the QUIC callbacks, as with any other driver.
+//! - Afterwards the transport writes what it has pending, a bounded burst
+//!   at a time. A datagram the socket refuses is kept, and the connection
+//!   waits for writability.
+//! - One reactor timer follows `QuicTransport::get_expiry`.
+//!
+//! Code that queues stream data from outside the handler should call
+//! [`Reactor::schedule`] with the connection's token, so the data is sent.
+//!
+//! ```rust,ignore
+//! use nevent::Reactor;
+//! use nh3::reactor::Http3Connection;
+//!
+//! let mut reactor = Reactor::new()?;
+//! let token = Http3Connection::connect(transport, "192.0.2.1:443")?
+//!     .register(&mut reactor)?;
+//! reactor.run()?;
+//! ```
+
+use std::io;
+use std::net::{ToSocketAddrs, UdpSocket};
+use std::os::fd::AsRawFd;
+
+use nevent::{Context, Interest, Reactor, Ready, Source, TimerId, Token};
+
+use crate::quic_transport::QuicTransport;
+
+/// Largest UDP payload we receive
+const MAX_DATAGRAM: usize = 65527;
+
+/// Datagrams read per readiness event
+const MAX_RECV_PER_EVENT: usize = 64;
+
+/// Packets sent per flush
+const MAX_BURST: usize = 16;
+
+/// Delay before retrying an expiry the transport did not clear (1ms)
+const TIMER_RETRY: u64 = 1_000_000;
+
+/// One HTTP/3 connection on its own connected UDP socket
+pub struct Http3Connection {
+    transport: Box<QuicTransport>,
+    socket: UdpSocket,
+    recv_buf: Box<[u8]>,
+    send_buf: Box<[u8]>,
+    /// Datagram the socket refused, sent before anything new
+    blocked: Option<Vec<u8>>,
+    timer: Option<TimerId>,
+    /// Expiry the timer was set for
+    deadline: u64,
+}
+
+impl Http3Connection {
+    /// Drive `transport` over `socket`, which must already be connected to
+    /// the peer (switched to non-blocking)
+    pub fn new(transport: Box<QuicTransport>, socket: UdpSocket) -> io::Result<Self> {
+        socket.set_nonblocking(true)?;
+        Ok(Self {
+            transport,
+            socket,
+            recv_buf: vec![0u8; MAX_DATAGRAM].into_boxed_slice(),
+            send_buf: vec![0u8; QuicTransport::MAX_PACKET_SIZE].into_boxed_slice(),
+            blocked: None,
+            timer: None,
+            deadline: u64::MAX,
+        })
+    }
+
+    /// Open a UDP socket connected to `remote` for a client transport
+    pub fn connect<A: ToSocketAddrs>(transport: Box<QuicTransport>, remote: A) -> io::Result<Self> {
+        let socket = UdpSocket::bind("0.0.0.0:0")?;
+        socket.connect(remote)?;
+        Self::new(transport, socket)
+    }
+
+    /// The transport this connection drives
+    pub fn transport(&self) -> &QuicTransport {
+        &self.transport
+    }
+
+    /// Hand the connection to `reactor`; the first flight goes out on the
+    /// next turn
+    pub fn register(self, reactor: &mut Reactor) -> io::Result<Token> {
+        let fd = self.socket.as_raw_fd();
+        let token = reactor.register(fd, Interest::READABLE, Box::new(self))?;
+        reactor.schedule(token);
+        Ok(token)
+    }
+
+    /// Read every queued datagram; false on a socket error
+    fn receive(&mut self, cx: &mut Context<'_>) -> bool {
+        for _ in 0..MAX_RECV_PER_EVENT {
+            match self.socket.recv(&mut self.recv_buf) {
+                // Bad packets are dropped; a fatal error closes the transport
+                Ok(n) => {
+                    let _ = self.transport.read_packet(&self.recv_buf[..n], cx.now());
+                }
+                Err(e) if e.kind() == io::ErrorKind::WouldBlock => break,
+                Err(e) if e.kind() == io::ErrorKind::Interrupted => {}
+                // ICMP errors on a connected socket; the transport times out
+                Err(e) if e.kind() == io::ErrorKind::ConnectionRefused => {}
+                Err(_) => return false,
+            }
+        }
+        true
+    }
+
+    /// Send pending packets; false once the transport gave up
+    fn flush(&mut self, cx: &mut Context<'_>) -> bool {
+        if let Some(datagram) = self.blocked.take() {
+            if !self.send(cx, datagram.len(), Some(datagram)) {
+                return true;
+            }
+        }
+
+        for _ in 0..MAX_BURST {
+            let n = match self.transport.write_packet(&mut self.send_buf, cx.now()) {
+                Ok(0) => break,
+                Ok(n) => n,
+                Err(_) => return false,
+            };
+            if !self.send(cx, n, None) {
+                return true;
+            }
+        }
+        let _ = cx.set_interest(Interest::READABLE);
+        true
+    }
+
+    /// Send `datagram`, or the first `len` bytes of the send buffer; false
+    /// if the socket is full and it was parked in `blocked`
+    fn send(&mut self, cx: &mut Context<'_>, len: usize, datagram: Option<Vec<u8>>) -> bool {
+        let sent = match &datagram {
+            Some(datagram) => self.socket.send(datagram),
+            None => self.socket.send(&self.send_buf[..len]),
+        };
+        match sent {
+            Err(e) if e.kind() == io::ErrorKind::WouldBlock => {
+                self.blocked = Some(datagram.unwrap_or_else(|| self.send_buf[..len].to_vec()));
+                let _ = cx.set_interest(Interest::BOTH);
+                false
+            }
+            // Lost datagrams are loss recovery's business
+            _ => true,
+        }
+    }
+
+    /// Follow the transport's expiry with the reactor timer
+    fn rearm(&mut self, cx: &mut Context<'_>) {
+        let expiry = self.transport.get_expiry();
+        if expiry == self.deadline && self.timer.is_some() {
+            return;
+        }
+        if let Some(timer) = self.timer.take() {
+            cx.cancel_timer(timer);
+        }
+        self.deadline = expiry;
+        if expiry != u64::MAX {
+            // An expiry already past is retried a tick later, not spun on
+            self.timer = Some(cx.set_timer(expiry.max(cx.now() + TIMER_RETRY)));
+        }
+    }
+
+    /// Flush and re-arm, or close once the connection is over
+    fn finish(&mut self, cx: &mut Context<'_>) {
+        if !self.flush(cx) || self.transport.is_draining() {
+            cx.close();
+            return;
+        }
+        self.rearm(cx);
+    }
+}
+
+impl Source for Http3Connection {
+    fn on_ready(&mut self, cx: &mut Context<'_>, ready: Ready) {
+        if (ready.is_readable() || ready.is_error()) && !self.receive(cx) {
+            cx.close();
+            return;
+        }
+        self.finish(cx);
+    }
+
+    fn on_timer(&mut self, cx: &mut Context<'_>, timer: TimerId) {
+        if self.timer != Some(timer) {
+            return;
+        }
+        self.timer = None;
+        let _ = self.transport.handle_expiry(cx.now());
+        self.finish(cx);
+    }
+}
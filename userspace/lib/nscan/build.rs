@@ -0,0 +1,5 @@
+fn main() {
+    // Link against NexaOS nrlib's libc (open, getdents64, close)
+    println!("cargo:rustc-link-lib=c");
+    println!("cargo:rustc-cdylib-link-arg=--soname=libnscan.so.1");
+}
@@ -0,0 +1,291 @@
+//! Batched directory reading
+//!
+//! [`read_dir`] lists a directory with as few system calls as possible and
+//! reports each entry's type when the kernel knows it, so walkers only
+//! `lstat` entries whose type they cannot tell otherwise:
+//!
+//! - `getdents64` on a directory descriptor, 64 KiB of entries per call.
+//! - On kernels without directory descriptors (the NexaOS kernel refuses
+//!   to `open` a directory), the native listing syscall returns every name
+//!   in one call; types are then unknown.
+
+use std::ffi::{CString, OsStr, OsString};
+use std::io;
+use std::os::unix::ffi::{OsStrExt, OsStringExt};
+use std::path::{Component, Path, PathBuf};
+
+type c_int = i32;
+
+const O_RDONLY: c_int = 0;
+const O_DIRECTORY: c_int = 0o200000;
+const O_CLOEXEC: c_int = 0o2000000;
+
+const EISDIR: i32 = 21;
+const ENOSYS: i32 = 38;
+const EAGAIN: i32 = 11;
+
+/// Directory entries read per getdents64 call
+const DENTS_BUF_SIZE: usize = 64 * 1024;
+
+const DT_FIFO: u8 = 1;
+const DT_CHR: u8 = 2;
+const DT_DIR: u8 = 4;
+const DT_BLK: u8 = 6;
+const DT_REG: u8 = 8;
+const DT_LNK: u8 = 10;
+const DT_SOCK: u8 = 12;
+
+extern "C" {
+    fn open(path: *const u8, flags: c_int, mode: c_int) -> c_int;
+    fn getdents64(fd: c_int, dirp: *mut u8, count: usize) -> isize;
+    fn close(fd: c_int) -> c_int;
+}
+
+/// Entry type as reported by the directory listing
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum EntryType {
+    File,
+    Dir,
+    Symlink,
+    /// Device, FIFO or socket
+    Other,
+    /// Not reported; `lstat` the entry to find out
+    Unknown,
+}
+
+impl EntryType {
+    fn from_d_type(d_type: u8) -> Self {
+        match d_type {
+            DT_REG => EntryType::File,
+            DT_DIR => EntryType::Dir,
+            DT_LNK => EntryType::Symlink,
+            DT_FIFO | DT_CHR | DT_BLK | DT_SOCK => EntryType::Other,
+            _ => EntryType::Unknown,
+        }
+    }
+}
+
+/// One directory entry (never `.` or `..`)
+#[derive(Clone, Debug)]
+pub struct Entry {
+    pub name: OsString,
+    pub entry_type: EntryType,
+}
+
+/// All entries of the directory at `path`, in the order the filesystem
+/// returns them
+pub fn read_dir(path: &Path) -> io::Result<Vec<Entry>> {
+    let cpath = CString::new(path.as_os_str().as_bytes())
+        .map_err(|_| io::Error::from(io::ErrorKind::InvalidInput))?;
+
+    let fd = unsafe {
+        open(
+            cpath.as_ptr() as *const u8,
+            O_RDONLY | O_DIRECTORY | O_CLOEXEC,
+            0,
+        )
+    };
+    if fd < 0 {
+        let err = io::Error::last_os_error();
+        return match err.raw_os_error() {
+            Some(EISDIR) => list_files(path),
+            _ => Err(err),
+        };
+    }
+
+    let result = read_dents(fd);
+    unsafe { close(fd) };
+    match result {
+        Err(e) if e.raw_os_error() == Some(ENOSYS) => list_files(path),
+        other => other,
+    }
+}
+
+fn is_dot(name: &[u8]) -> bool {
+    name == b"." || name == b".."
+}
+
+fn read_dents(fd: c_int) -> io::Result<Vec<Entry>> {
+    let mut buf = vec![0u8; DENTS_BUF_SIZE];
+    let mut entries = Vec::new();
+
+    loop {
+        let n = unsafe { getdents64(fd, buf.as_mut_ptr(), buf.len()) };
+        if n < 0 {
+            let err = io::Error::last_os_error();
+            if err.kind() == io::ErrorKind::Interrupted {
+                continue;
+            }
+            return Err(err);
+        }
+        if n == 0 {
+            return Ok(entries);
+        }
+
+        // struct linux_dirent64 { u64 d_ino; i64 d_off; u16 d_reclen;
+        //                         u8 d_type; char d_name[]; }
+        let data = &buf[..n as usize];
+        let mut pos = 0;
+        while pos + 19 < data.len() {
+            let reclen = u16::from_ne_bytes([data[pos + 16], data[pos + 17]]) as usize;
+            if reclen == 0 || pos + reclen > data.len() {
+                break;
+            }
+            let d_type = data[pos + 18];
+            let raw = &data[pos + 19..pos + reclen];
+            let name = &raw[..raw.iter().position(|&b| b == 0).unwrap_or(raw.len())];
+            if !is_dot(name) {
+                entries.push(Entry {
+                    name: OsStr::from_bytes(name).to_os_string(),
+                    entry_type: EntryType::from_d_type(d_type),
+                });
+            }
+            pos += reclen;
+        }
+    }
+}
+
+// NexaOS native directory listing: every name, newline separated
+const SYS_LIST_FILES: u64 = 200;
+const SYS_GETERRNO: u64 = 201;
+const LIST_FLAG_INCLUDE_HIDDEN: u64 = 0x1;
+
+/// Initial buffer for the native listing; doubled while it overflows
+const LIST_BUF_SIZE: usize = 16 * 1024;
+
+#[repr(C)]
+struct ListDirRequest {
+    path_ptr: u64,
+    path_len: u64,
+    flags: u64,
+}
+
+#[cfg(target_arch = "x86_64")]
+fn nexa_syscall3(n: u64, a1: u64, a2: u64, a3: u64) -> u64 {
+    let ret: u64;
+    unsafe {
+        std::arch::asm!(
+            "int 0x81",
+            in("rax") n,
+            in("rdi") a1,
+            in("rsi") a2,
+            in("rdx") a3,
+            lateout("rax") ret,
+            clobber_abi("sysv64")
+        );
+    }
+    ret
+}
+
+/// `path` made absolute and free of `.` and `..`; the listing syscall does
+/// not resolve paths against the working directory
+#[cfg(target_arch = "x86_64")]
+fn absolute(path: &Path) -> io::Result<PathBuf> {
+    let mut absolute = if path.is_absolute() {
+        PathBuf::from("/")
+    } else {
+        std::env::current_dir()?
+    };
+    for component in path.components() {
+        match component {
+            Component::ParentDir => {
+                absolute.pop();
+            }
+            Component::Normal(name) => absolute.push(name),
+            Component::RootDir | Component::CurDir | Component::Prefix(_) => {}
+        }
+    }
+    Ok(absolute)
+}
+
+#[cfg(target_arch = "x86_64")]
+fn list_files(path: &Path) -> io::Result<Vec<Entry>> {
+    let path = absolute(path)?;
+    let path = path
+        .to_str()
+        .ok_or_else(|| io::Error::from(io::ErrorKind::InvalidInput))?;
+    let request = ListDirRequest {
+        path_ptr: path.as_ptr() as u64,
+        path_len: path.len() as u64,
+        flags: LIST_FLAG_INCLUDE_HIDDEN,
+    };
+
+    let mut buf = vec![0u8; LIST_BUF_SIZE];
+    loop {
+        let written = nexa_syscall3(
+            SYS_LIST_FILES,
+            buf.as_mut_ptr() as u64,
+            buf.len() as u64,
+            &request as *const ListDirRequest as u64,
+        );
+        if written == u64::MAX {
+            let errno = nexa_syscall3(SYS_GETERRNO, 0, 0, 0) as i32;
+            return Err(io::Error::from_raw_os_error(errno));
+        }
+        // A full buffer reports EAGAIN; ask again with more room
+        if nexa_syscall3(SYS_GETERRNO, 0, 0, 0) as i32 == EAGAIN {
+            let len = buf.len() * 2;
+            buf.resize(len, 0);
+            continue;
+        }
+
+        buf.truncate(written as usize);
+        return Ok(buf
+            .split(|&b| b == b'\n')
+            .filter(|name| !name.is_empty() && !is_dot(name))
+            .map(|name| Entry {
+                name: OsString::from_vec(name.to_vec()),
+                entry_type: EntryType::Unknown,
+            })
+            .collect());
+    }
+}
+
+#[cfg(not(target_arch = "x86_64"))]
+fn list_files(_path: &Path) -> io::Result<Vec<Entry>> {
+    Err(io::Error::from_raw_os_error(ENOSYS))
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::fs;
+
+    #[test]
+    fn test_read_dir_lists_entries_with_types() {
+        let root = std::env::temp_dir().join(format!("nscan-dir-{}", std::process::id()));
+        let _ = fs::remove_dir_all(&root);
+        fs::create_dir_all(root.join("sub")).unwrap();
+        fs::write(root.join("file"), b"x").unwrap();
+        fs::write(root.join(".hidden"), b"").unwrap();
+
+        let mut entries = read_dir(&root).unwrap();
+        entries.sort_by(|a, b| a.name.cmp(&b.name));
+        let listed: Vec<(String, EntryType)> = entries
+            .iter()
+            .map(|e| (e.name.to_string_lossy().into_owned(), e.entry_type))
+            .collect();
+        assert_eq!(
+            listed,
+            vec![
+                (".hidden".to_string(), EntryType::File),
+                ("file".to_string(), EntryType::File),
+                ("sub".to_string(), EntryType::Dir),
+            ]
+        );
+
+        assert!(read_dir(&root.join("missing")).is_err());
+        fs::remove_dir_all(&root).unwrap();
+    }
+
+    #[test]
+    #[cfg(target_arch = "x86_64")]
+    fn test_absolute_is_lexical() {
+        assert_eq!(
+            absolute(Path::new("/a/./b/../c")).unwrap(),
+            PathBuf::from("/a/c")
+        );
+        let cwd = std::env::current_dir().unwrap();
+        assert_eq!(absolute(Path::new("./x")).unwrap(), cwd.join("x"));
+    }
+}
@@ -0,0 +1,64 @@
+//! NexaOS Scan Library (nscan)
+//!
+//! Shared scanning code for the text and file tools (grep, wc, find).
+//!
+//! ## Features
+//! - **SIMD byte scans** - `memchr`, `memrchr` and newline counting over
+//!   16-byte SSE2 vectors
+//! - **Literal search** - Horspool with a first/last-byte SIMD prefilter,
+//!   exact or ASCII case-insensitive
+//! - **Block line reader** - 1 MiB reads cut at line boundaries, so no
+//!   per-line allocation and bounded memory
+//! - **Batched directory reading** - `getdents64` with entry types, or the
+//!   native listing syscall where directories cannot be opened
+//! - **Ordered parallel map** - walk subtrees on several threads while
+//!   printing in sequential order
+//!
+//! ## Usage
+//!
+//! ```rust,ignore
+//! use nscan::{memchr, Finder, LineReader};
+//!
+//! let finder = Finder::new(b"error");
+//! let mut reader = LineReader::new(std::fs::File::open("/var/log/messages")?);
+//! let mut hits = 0;
+//! while let Some(block) = reader.next_block()? {
+//!     let mut rest = block;
+//!     while let Some(at) = finder.find(rest) {
+//!         hits += 1;
+//!         // skip to the end of the matching line
+//!         let end = memchr::memchr(b'\n', &rest[at..]).map_or(rest.len(), |e| at + e + 1);
+//!         rest = &rest[end..];
+//!     }
+//! }
+//! ```
+
+#![allow(non_camel_case_types)]
+
+// ============================================================================
+// Module Declarations
+// ============================================================================
+
+// SSE2 memchr / memrchr / count
+pub mod memchr;
+
+// Literal substring search
+pub mod search;
+
+// Line-aligned block reader
+pub mod lines;
+
+// getdents64 / native directory listing
+pub mod dir;
+
+// Ordered parallel map for walkers
+pub mod parallel;
+
+// ============================================================================
+// Re-exports
+// ============================================================================
+
+pub use dir::{read_dir, Entry, EntryType};
+pub use lines::{LineReader, BLOCK_SIZE};
+pub use parallel::{default_threads, map_ordered};
+pub use search::Finder;
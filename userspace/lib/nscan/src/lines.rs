@@ -0,0 +1,158 @@
+//! Line-aligned block reading
+//!
+//! [`LineReader`] reads large blocks and hands them out cut after their
+//! last newline, carrying the partial line over to the next block. Callers
+//! scan whole blocks (with [`memchr`](crate::memchr) or a
+//! [`Finder`](crate::Finder)) instead of allocating a `String` per line.
+//!
+//! Memory stays at one block unless a single line is longer than that;
+//! then the buffer doubles until the line fits.
+//!
+//! `mmap` is not used: NexaOS maps files by copying them in whole, which
+//! costs as much memory as the file. Large `read` calls give the same
+//! throughput with a bounded footprint.
+
+use std::io::{self, Read};
+
+use crate::memchr::memrchr;
+
+/// Size of one read (and of the initial buffer)
+pub const BLOCK_SIZE: usize = 1024 * 1024;
+
+/// Reads `inner` as blocks of complete lines
+pub struct LineReader<R> {
+    inner: R,
+    buf: Vec<u8>,
+    /// Start of the carried-over partial line
+    start: usize,
+    /// End of the data in `buf`
+    end: usize,
+    eof: bool,
+}
+
+impl<R: Read> LineReader<R> {
+    pub fn new(inner: R) -> Self {
+        Self::with_capacity(BLOCK_SIZE, inner)
+    }
+
+    pub fn with_capacity(capacity: usize, inner: R) -> Self {
+        Self {
+            inner,
+            buf: vec![0u8; capacity.max(1)],
+            start: 0,
+            end: 0,
+            eof: false,
+        }
+    }
+
+    /// The next block of whole lines, each ending in `\n` except possibly
+    /// the very last line of the input. `None` at end of input.
+    pub fn next_block(&mut self) -> io::Result<Option<&[u8]>> {
+        if self.eof {
+            return Ok(None);
+        }
+
+        // Move the partial line to the front
+        if self.start > 0 {
+            self.buf.copy_within(self.start..self.end, 0);
+            self.end -= self.start;
+            self.start = 0;
+        }
+
+        loop {
+            if self.end == self.buf.len() {
+                // One line fills the whole buffer
+                let len = self.buf.len() * 2;
+                self.buf.resize(len, 0);
+            }
+
+            let n = match self.inner.read(&mut self.buf[self.end..]) {
+                Ok(n) => n,
+                Err(e) if e.kind() == io::ErrorKind::Interrupted => continue,
+                Err(e) => return Err(e),
+            };
+
+            if n == 0 {
+                self.eof = true;
+                if self.end == 0 {
+                    return Ok(None);
+                }
+                let end = self.end;
+                self.start = end;
+                return Ok(Some(&self.buf[..end]));
+            }
+
+            let scanned = self.end;
+            self.end += n;
+            if let Some(at) = memrchr(b'\n', &self.buf[scanned..self.end]) {
+                let cut = scanned + at + 1;
+                self.start = cut;
+                return Ok(Some(&self.buf[..cut]));
+            }
+        }
+    }
+
+    pub fn into_inner(self) -> R {
+        self.inner
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    /// Reader that returns at most `step` bytes per call
+    struct Trickle<'a> {
+        data: &'a [u8],
+        step: usize,
+    }
+
+    impl Read for Trickle<'_> {
+        fn read(&mut self, buf: &mut [u8]) -> io::Result<usize> {
+            let n = self.step.min(buf.len()).min(self.data.len());
+            buf[..n].copy_from_slice(&self.data[..n]);
+            self.data = &self.data[n..];
+            Ok(n)
+        }
+    }
+
+    fn collect(data: &[u8], capacity: usize, step: usize) -> Vec<Vec<u8>> {
+        let mut reader = LineReader::with_capacity(capacity, Trickle { data, step });
+        let mut blocks = Vec::new();
+        while let Some(block) = reader.next_block().unwrap() {
+            blocks.push(block.to_vec());
+        }
+        blocks
+    }
+
+    #[test]
+    fn test_blocks_end_on_newlines() {
+        let data = b"one\ntwo\nthree\nfour\nfive";
+        for capacity in [1, 3, 8, 64] {
+            for step in [1, 2, 5, 100] {
+                let blocks = collect(data, capacity, step);
+                assert_eq!(blocks.concat(), data.to_vec());
+                let (last, init) = blocks.split_last().unwrap();
+                for block in init {
+                    assert_eq!(block.last(), Some(&b'\n'));
+                }
+                assert_eq!(last.last(), Some(&b'e'));
+            }
+        }
+    }
+
+    #[test]
+    fn test_long_line_grows_buffer() {
+        let mut data = vec![b'x'; 1000];
+        data.push(b'\n');
+        data.extend_from_slice(b"tail\n");
+        let blocks = collect(&data, 16, 7);
+        assert_eq!(blocks.concat(), data);
+        assert!(blocks[0].len() >= 1001);
+    }
+
+    #[test]
+    fn test_empty_input() {
+        assert!(collect(b"", 16, 4).is_empty());
+    }
+}
@@ -0,0 +1,280 @@
+//! Byte search and counting
+//!
+//! On x86_64 the scans compare 16 bytes per SSE2 instruction (part of the
+//! baseline, so no runtime detection) and look at 64 bytes per loop
+//! iteration. Other targets use the plain iterator versions.
+
+#[cfg(target_arch = "x86_64")]
+use core::arch::x86_64::*;
+
+/// Position of the first `needle` in `haystack`
+pub fn memchr(needle: u8, haystack: &[u8]) -> Option<usize> {
+    #[cfg(target_arch = "x86_64")]
+    {
+        if haystack.len() >= 16 {
+            // SAFETY: SSE2 is always available on x86_64
+            return unsafe { sse2::memchr(needle, haystack) };
+        }
+    }
+    haystack.iter().position(|&b| b == needle)
+}
+
+/// Position of the first `a` or `b` in `haystack`
+pub fn memchr2(a: u8, b: u8, haystack: &[u8]) -> Option<usize> {
+    #[cfg(target_arch = "x86_64")]
+    {
+        if haystack.len() >= 16 {
+            // SAFETY: SSE2 is always available on x86_64
+            return unsafe { sse2::memchr2(a, b, haystack) };
+        }
+    }
+    haystack.iter().position(|&c| c == a || c == b)
+}
+
+/// Position of the last `needle` in `haystack`
+pub fn memrchr(needle: u8, haystack: &[u8]) -> Option<usize> {
+    #[cfg(target_arch = "x86_64")]
+    {
+        if haystack.len() >= 16 {
+            // SAFETY: SSE2 is always available on x86_64
+            return unsafe { sse2::memrchr(needle, haystack) };
+        }
+    }
+    haystack.iter().rposition(|&b| b == needle)
+}
+
+/// Number of `needle` bytes in `haystack`
+pub fn count(needle: u8, haystack: &[u8]) -> usize {
+    #[cfg(target_arch = "x86_64")]
+    {
+        if haystack.len() >= 16 {
+            // SAFETY: SSE2 is always available on x86_64
+            return unsafe { sse2::count(needle, haystack) };
+        }
+    }
+    haystack.iter().filter(|&&b| b == needle).count()
+}
+
+#[cfg(target_arch = "x86_64")]
+mod sse2 {
+    use super::*;
+
+    const VECTOR: usize = 16;
+    const LOOP: usize = 4 * VECTOR;
+
+    #[inline(always)]
+    unsafe fn load(ptr: *const u8) -> __m128i {
+        _mm_loadu_si128(ptr as *const __m128i)
+    }
+
+    #[inline(always)]
+    unsafe fn mask(v: __m128i, n: __m128i) -> u32 {
+        _mm_movemask_epi8(_mm_cmpeq_epi8(v, n)) as u32
+    }
+
+    /// Callers guarantee `haystack.len() >= 16`
+    pub unsafe fn memchr(needle: u8, haystack: &[u8]) -> Option<usize> {
+        let n = _mm_set1_epi8(needle as i8);
+        let start = haystack.as_ptr();
+        let len = haystack.len();
+        let mut i = 0;
+
+        while i + LOOP <= len {
+            let p = start.add(i);
+            let a = _mm_cmpeq_epi8(load(p), n);
+            let b = _mm_cmpeq_epi8(load(p.add(16)), n);
+            let c = _mm_cmpeq_epi8(load(p.add(32)), n);
+            let d = _mm_cmpeq_epi8(load(p.add(48)), n);
+            let any = _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d));
+            if _mm_movemask_epi8(any) != 0 {
+                for (k, v) in [a, b, c, d].into_iter().enumerate() {
+                    let m = _mm_movemask_epi8(v) as u32;
+                    if m != 0 {
+                        return Some(i + k * VECTOR + m.trailing_zeros() as usize);
+                    }
+                }
+            }
+            i += LOOP;
+        }
+        while i + VECTOR <= len {
+            let m = mask(load(start.add(i)), n);
+            if m != 0 {
+                return Some(i + m.trailing_zeros() as usize);
+            }
+            i += VECTOR;
+        }
+        if i < len {
+            // Last partial vector: reload the final 16 bytes, ignoring
+            // the lanes already checked
+            let last = len - VECTOR;
+            let m = mask(load(start.add(last)), n) >> (i - last);
+            if m != 0 {
+                return Some(i + m.trailing_zeros() as usize);
+            }
+        }
+        None
+    }
+
+    /// Callers guarantee `haystack.len() >= 16`
+    pub unsafe fn memchr2(a: u8, b: u8, haystack: &[u8]) -> Option<usize> {
+        let na = _mm_set1_epi8(a as i8);
+        let nb = _mm_set1_epi8(b as i8);
+        let start = haystack.as_ptr();
+        let len = haystack.len();
+        let mut i = 0;
+
+        let check = |at: usize| -> u32 {
+            let v = load(start.add(at));
+            mask(v, na) | mask(v, nb)
+        };
+
+        while i + VECTOR <= len {
+            let m = check(i);
+            if m != 0 {
+                return Some(i + m.trailing_zeros() as usize);
+            }
+            i += VECTOR;
+        }
+        if i < len {
+            let last = len - VECTOR;
+            let m = check(last) >> (i - last);
+            if m != 0 {
+                return Some(i + m.trailing_zeros() as usize);
+            }
+        }
+        None
+    }
+
+    /// Callers guarantee `haystack.len() >= 16`
+    pub unsafe fn memrchr(needle: u8, haystack: &[u8]) -> Option<usize> {
+        let n = _mm_set1_epi8(needle as i8);
+        let start = haystack.as_ptr();
+        let mut end = haystack.len();
+
+        while end >= LOOP {
+            let p = start.add(end - LOOP);
+            let a = _mm_cmpeq_epi8(load(p), n);
+            let b = _mm_cmpeq_epi8(load(p.add(16)), n);
+            let c = _mm_cmpeq_epi8(load(p.add(32)), n);
+            let d = _mm_cmpeq_epi8(load(p.add(48)), n);
+            let any = _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d));
+            if _mm_movemask_epi8(any) != 0 {
+                for (k, v) in [d, c, b, a].into_iter().enumerate() {
+                    let m = _mm_movemask_epi8(v) as u32;
+                    if m != 0 {
+                        let base = end - (k + 1) * VECTOR;
+                        return Some(base + 31 - m.leading_zeros() as usize);
+                    }
+                }
+            }
+            end -= LOOP;
+        }
+        while end >= VECTOR {
+            let m = mask(load(start.add(end - VECTOR)), n);
+            if m != 0 {
+                return Some(end - VECTOR + 31 - m.leading_zeros() as usize);
+            }
+            end -= VECTOR;
+        }
+        if end > 0 {
+            // First partial vector: the lanes at `end` and above were
+            // already checked
+            let m = mask(load(start), n) & ((1u32 << end) - 1);
+            if m != 0 {
+                return Some(31 - m.leading_zeros() as usize);
+            }
+        }
+        None
+    }
+
+    /// Callers guarantee `haystack.len() >= 16`
+    pub unsafe fn count(needle: u8, haystack: &[u8]) -> usize {
+        let n = _mm_set1_epi8(needle as i8);
+        let zero = _mm_setzero_si128();
+        let start = haystack.as_ptr();
+        let len = haystack.len();
+        let mut total = 0usize;
+        let mut i = 0;
+
+        while i + VECTOR <= len {
+            // Per-lane byte counters hold at most 255 matches, so fold
+            // them into the total at least that often
+            let rounds = ((len - i) / VECTOR).min(255);
+            let mut acc = zero;
+            for _ in 0..rounds {
+                // A match is 0xff (-1) per lane; subtracting adds one
+                acc = _mm_sub_epi8(acc, _mm_cmpeq_epi8(load(start.add(i)), n));
+                i += VECTOR;
+            }
+            let sums = _mm_sad_epu8(acc, zero);
+            total += _mm_cvtsi128_si64(sums) as usize
+                + _mm_cvtsi128_si64(_mm_unpackhi_epi64(sums, sums)) as usize;
+        }
+        if i < len {
+            let last = len - VECTOR;
+            let m = mask(load(start.add(last)), n) >> (i - last);
+            total += m.count_ones() as usize;
+        }
+        total
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn sample(len: usize) -> Vec<u8> {
+        (0..len).map(|i| (i * 7 % 251) as u8).collect()
+    }
+
+    #[test]
+    fn test_memchr_matches_iterator() {
+        for len in [0, 1, 15, 16, 17, 63, 64, 65, 200, 1000] {
+            let data = sample(len);
+            for needle in [0u8, 7, 100, 250, 255] {
+                assert_eq!(
+                    memchr(needle, &data),
+                    data.iter().position(|&b| b == needle),
+                    "memchr len={} needle={}",
+                    len,
+                    needle
+                );
+                assert_eq!(
+                    memrchr(needle, &data),
+                    data.iter().rposition(|&b| b == needle),
+                    "memrchr len={} needle={}",
+                    len,
+                    needle
+                );
+                assert_eq!(
+                    count(needle, &data),
+                    data.iter().filter(|&&b| b == needle).count(),
+                    "count len={} needle={}",
+                    len,
+                    needle
+                );
+            }
+        }
+    }
+
+    #[test]
+    fn test_memchr_every_position() {
+        for len in [16, 40, 64, 130] {
+            for at in 0..len {
+                let mut data = vec![b'a'; len];
+                data[at] = b'\n';
+                assert_eq!(memchr(b'\n', &data), Some(at));
+                assert_eq!(memrchr(b'\n', &data), Some(at));
+                assert_eq!(memchr2(b'x', b'\n', &data), Some(at));
+                assert_eq!(count(b'\n', &data), 1);
+            }
+        }
+    }
+
+    #[test]
+    fn test_count_long_run() {
+        // More than 255 vectors of matches exercises the counter folding
+        let data = vec![b'\n'; 16 * 300 + 5];
+        assert_eq!(count(b'\n', &data), data.len());
+    }
+}
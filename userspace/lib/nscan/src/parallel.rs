@@ -0,0 +1,101 @@
+//! Ordered parallel map
+//!
+//! Walkers fan the subtrees or files they find out to worker threads but
+//! must still print in the order a sequential walk would. [`map_ordered`]
+//! runs the work on a small pool and hands each result to the caller's
+//! thread as soon as every earlier result has been handed over, so output
+//! streams instead of waiting for the slowest item.
+
+use std::collections::BTreeMap;
+use std::sync::mpsc;
+use std::sync::Mutex;
+use std::thread;
+
+/// Upper bound on worker threads
+pub const MAX_THREADS: usize = 8;
+
+/// Worker threads to use on this machine
+pub fn default_threads() -> usize {
+    thread::available_parallelism()
+        .map(|n| n.get().min(MAX_THREADS))
+        .unwrap_or(1)
+}
+
+/// Run `work` on each item using up to `threads` threads and call `emit`
+/// with the results in item order
+pub fn map_ordered<T, R, W, E>(items: Vec<T>, threads: usize, work: W, mut emit: E)
+where
+    T: Send,
+    R: Send,
+    W: Fn(T) -> R + Sync,
+    E: FnMut(R),
+{
+    let threads = threads.min(items.len());
+    if threads <= 1 {
+        for item in items {
+            emit(work(item));
+        }
+        return;
+    }
+
+    let queue = Mutex::new(items.into_iter().enumerate());
+    let (tx, rx) = mpsc::channel::<(usize, R)>();
+
+    thread::scope(|scope| {
+        for _ in 0..threads {
+            let tx = tx.clone();
+            let queue = &queue;
+            let work = &work;
+            scope.spawn(move || loop {
+                let next = queue.lock().unwrap_or_else(|e| e.into_inner()).next();
+                let Some((index, item)) = next else {
+                    break;
+                };
+                if tx.send((index, work(item))).is_err() {
+                    break;
+                }
+            });
+        }
+        drop(tx);
+
+        // Results that arrived ahead of their turn
+        let mut waiting = BTreeMap::new();
+        let mut next = 0;
+        for (index, result) in rx {
+            waiting.insert(index, result);
+            while let Some(result) = waiting.remove(&next) {
+                emit(result);
+                next += 1;
+            }
+        }
+    });
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_results_in_order() {
+        let items: Vec<u64> = (0..200).collect();
+        let mut seen = Vec::new();
+        map_ordered(
+            items,
+            4,
+            |i| {
+                // Later items finish first
+                thread::sleep(std::time::Duration::from_micros((200 - i) * 10));
+                i * 2
+            },
+            |r| seen.push(r),
+        );
+        assert_eq!(seen, (0..200).map(|i| i * 2).collect::<Vec<_>>());
+    }
+
+    #[test]
+    fn test_single_thread() {
+        let mut seen = Vec::new();
+        map_ordered(vec![3, 1, 2], 1, |i| i + 1, |r| seen.push(r));
+        assert_eq!(seen, vec![4, 2, 3]);
+    }
+}
@@ -0,0 +1,261 @@
+//! Literal substring search
+//!
+//! [`Finder`] preprocesses a needle once and then searches any number of
+//! haystacks:
+//!
+//! - One-byte needles are a plain [`memchr`](crate::memchr::memchr).
+//! - On x86_64 a SIMD prefilter compares the needle's first and last byte
+//!   against 16 candidate positions at a time. Only positions where both
+//!   agree are compared in full, so on typical text almost every byte is
+//!   touched by vector instructions alone.
+//! - Elsewhere, and for the tail the prefilter cannot cover, the search is
+//!   Boyer-Moore-Horspool.
+//!
+//! ASCII case-insensitive search folds while comparing; the haystack is
+//! never copied or lowercased.
+
+#[cfg(target_arch = "x86_64")]
+use core::arch::x86_64::*;
+
+use crate::memchr::{memchr, memchr2};
+
+/// A needle prepared for repeated searching
+#[derive(Clone)]
+pub struct Finder {
+    /// The needle, lowercased when `ignore_case` is set
+    needle: Vec<u8>,
+    ignore_case: bool,
+    /// Horspool shift for each byte value
+    skip: [usize; 256],
+}
+
+impl Finder {
+    /// Exact (byte for byte) search for `needle`
+    pub fn new(needle: &[u8]) -> Self {
+        Self::build(needle, false)
+    }
+
+    /// Search for `needle` ignoring ASCII case
+    pub fn new_ignore_ascii_case(needle: &[u8]) -> Self {
+        Self::build(needle, true)
+    }
+
+    fn build(needle: &[u8], ignore_case: bool) -> Self {
+        let needle: Vec<u8> = if ignore_case {
+            needle.to_ascii_lowercase()
+        } else {
+            needle.to_vec()
+        };
+
+        let mut skip = [needle.len().max(1); 256];
+        if let Some((_, init)) = needle.split_last() {
+            for (i, &b) in init.iter().enumerate() {
+                let shift = needle.len() - 1 - i;
+                skip[b as usize] = shift;
+                if ignore_case {
+                    skip[b.to_ascii_uppercase() as usize] = shift;
+                }
+            }
+        }
+
+        Self {
+            needle,
+            ignore_case,
+            skip,
+        }
+    }
+
+    pub fn needle(&self) -> &[u8] {
+        &self.needle
+    }
+
+    pub fn ignores_case(&self) -> bool {
+        self.ignore_case
+    }
+
+    /// Position of the first occurrence in `haystack`
+    pub fn find(&self, haystack: &[u8]) -> Option<usize> {
+        let n = self.needle.len();
+        if n == 0 {
+            return Some(0);
+        }
+        if haystack.len() < n {
+            return None;
+        }
+        if n == 1 {
+            let b = self.needle[0];
+            let upper = b.to_ascii_uppercase();
+            return if self.ignore_case && upper != b {
+                memchr2(b, upper, haystack)
+            } else {
+                memchr(b, haystack)
+            };
+        }
+
+        #[cfg(target_arch = "x86_64")]
+        {
+            // SAFETY: SSE2 is always available on x86_64
+            let (found, resume) = unsafe { self.find_sse2(haystack) };
+            if found.is_some() {
+                return found;
+            }
+            self.horspool(haystack, resume)
+        }
+        #[cfg(not(target_arch = "x86_64"))]
+        {
+            self.horspool(haystack, 0)
+        }
+    }
+
+    /// True if `haystack` contains the needle
+    pub fn is_match(&self, haystack: &[u8]) -> bool {
+        self.find(haystack).is_some()
+    }
+
+    #[inline(always)]
+    fn matches_at(&self, haystack: &[u8], at: usize) -> bool {
+        let window = &haystack[at..at + self.needle.len()];
+        if self.ignore_case {
+            window.eq_ignore_ascii_case(&self.needle)
+        } else {
+            window == &self.needle[..]
+        }
+    }
+
+    /// Boyer-Moore-Horspool from position `from`
+    fn horspool(&self, haystack: &[u8], from: usize) -> Option<usize> {
+        let n = self.needle.len();
+        let last = self.needle[n - 1];
+        let mut at = from;
+        while at + n <= haystack.len() {
+            let b = haystack[at + n - 1];
+            let tail = if self.ignore_case {
+                b.to_ascii_lowercase() == last
+            } else {
+                b == last
+            };
+            if tail && self.matches_at(haystack, at) {
+                return Some(at);
+            }
+            at += self.skip[b as usize];
+        }
+        None
+    }
+
+    /// First/last byte prefilter over 16 start positions at a time.
+    /// Returns a match, or where the scalar search should carry on.
+    #[cfg(target_arch = "x86_64")]
+    unsafe fn find_sse2(&self, haystack: &[u8]) -> (Option<usize>, usize) {
+        let n = self.needle.len();
+        let first = self.needle[0];
+        let last = self.needle[n - 1];
+        let first_lo = _mm_set1_epi8(first as i8);
+        let first_hi = _mm_set1_epi8(first.to_ascii_uppercase() as i8);
+        let last_lo = _mm_set1_epi8(last as i8);
+        let last_hi = _mm_set1_epi8(last.to_ascii_uppercase() as i8);
+
+        let ptr = haystack.as_ptr();
+        let mut at = 0;
+        // The last-byte load reads 16 bytes starting at `at + n - 1`
+        while at + n - 1 + 16 <= haystack.len() {
+            let head = _mm_loadu_si128(ptr.add(at) as *const __m128i);
+            let tail = _mm_loadu_si128(ptr.add(at + n - 1) as *const __m128i);
+            let (eq_first, eq_last) = if self.ignore_case {
+                (
+                    _mm_or_si128(
+                        _mm_cmpeq_epi8(head, first_lo),
+                        _mm_cmpeq_epi8(head, first_hi),
+                    ),
+                    _mm_or_si128(_mm_cmpeq_epi8(tail, last_lo), _mm_cmpeq_epi8(tail, last_hi)),
+                )
+            } else {
+                (
+                    _mm_cmpeq_epi8(head, first_lo),
+                    _mm_cmpeq_epi8(tail, last_lo),
+                )
+            };
+            let mut mask = _mm_movemask_epi8(_mm_and_si128(eq_first, eq_last)) as u32;
+            while mask != 0 {
+                let candidate = at + mask.trailing_zeros() as usize;
+                if self.matches_at(haystack, candidate) {
+                    return (Some(candidate), candidate);
+                }
+                mask &= mask - 1;
+            }
+            at += 16;
+        }
+        (None, at)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn naive(haystack: &[u8], needle: &[u8], ignore_case: bool) -> Option<usize> {
+        if needle.is_empty() {
+            return Some(0);
+        }
+        haystack.windows(needle.len()).position(|w| {
+            if ignore_case {
+                w.eq_ignore_ascii_case(needle)
+            } else {
+                w == needle
+            }
+        })
+    }
+
+    #[test]
+    fn test_find_matches_naive() {
+        let text = b"the quick brown fox jumps over the lazy dog; \
+                     THE QUICK BROWN FOX JUMPS OVER THE LAZY DOG\n\
+                     aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaab lazy";
+        let needles: [&[u8]; 10] = [
+            b"",
+            b"q",
+            b"Q",
+            b"fox",
+            b"lazy dog",
+            b"LAZY",
+            b"aab",
+            b"aaaaaaaaaaaaaaaaaaaaaab",
+            b"not here",
+            b"lazy",
+        ];
+        for start in 0..text.len() {
+            let haystack = &text[start..];
+            for needle in needles {
+                assert_eq!(
+                    Finder::new(needle).find(haystack),
+                    naive(haystack, needle, false),
+                    "needle {:?} at {}",
+                    needle,
+                    start
+                );
+                assert_eq!(
+                    Finder::new_ignore_ascii_case(needle).find(haystack),
+                    naive(haystack, needle, true),
+                    "needle {:?} at {} (ignore case)",
+                    needle,
+                    start
+                );
+            }
+        }
+    }
+
+    #[test]
+    fn test_needle_longer_than_haystack() {
+        assert_eq!(Finder::new(b"abcdef").find(b"abc"), None);
+    }
+
+    #[test]
+    fn test_non_ascii_bytes() {
+        let text = "grüße aus köln";
+        let at = text.find("köln");
+        assert_eq!(Finder::new("köln".as_bytes()).find(text.as_bytes()), at);
+        assert_eq!(
+            Finder::new_ignore_ascii_case("KöLN".as_bytes()).find(text.as_bytes()),
+            at
+        );
+    }
+}
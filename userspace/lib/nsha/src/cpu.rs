@@ -0,0 +1,127 @@
+//! CPU feature detection
+//!
+//! CPUID is read directly rather than through `std`, so the same checks
+//! work in the kernel. AVX2 also needs the OS to save YMM state, which is
+//! checked through XCR0; the kernel does not enable that, so it only ever
+//! gets the SSE-based paths. Answers are cached after the first query.
+//!
+//! With the `std` feature, setting `NCRYPTO_NO_HW_ACCEL` in the environment
+//! makes every query answer false, as in ncryptolib.
+
+#[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+use core::sync::atomic::{AtomicU8, Ordering};
+
+#[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+const UNKNOWN: u8 = 0;
+#[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+const ABSENT: u8 = 1;
+#[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+const PRESENT: u8 = 2;
+
+#[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+static SHA_NI: AtomicU8 = AtomicU8::new(UNKNOWN);
+#[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+static AVX2: AtomicU8 = AtomicU8::new(UNKNOWN);
+
+#[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+fn cached(flag: &AtomicU8, detect: fn() -> bool) -> bool {
+    match flag.load(Ordering::Relaxed) {
+        PRESENT => true,
+        ABSENT => false,
+        _ => {
+            let present = enabled() && detect();
+            flag.store(if present { PRESENT } else { ABSENT }, Ordering::Relaxed);
+            present
+        }
+    }
+}
+
+#[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+fn enabled() -> bool {
+    #[cfg(feature = "std")]
+    {
+        std::env::var_os("NCRYPTO_NO_HW_ACCEL").is_none()
+    }
+    #[cfg(not(feature = "std"))]
+    {
+        true
+    }
+}
+
+#[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+mod cpuid {
+    use core::arch::x86_64::{CpuidResult, __cpuid, __cpuid_count, _xgetbv};
+
+    /// Leaf 1 ECX
+    pub const SSSE3: u32 = 1 << 9;
+    pub const SSE41: u32 = 1 << 19;
+    pub const OSXSAVE: u32 = 1 << 27;
+    pub const AVX: u32 = 1 << 28;
+    /// Leaf 7 EBX
+    pub const AVX2: u32 = 1 << 5;
+    pub const BMI2: u32 = 1 << 8;
+    pub const SHA: u32 = 1 << 29;
+    /// XCR0: XMM and YMM state
+    pub const XCR0_YMM: u64 = 0b110;
+
+    /// (leaf 1 ECX, leaf 7 EBX)
+    pub fn features() -> (u32, u32) {
+        // SAFETY: CPUID is available on every x86_64 CPU
+        unsafe {
+            let max = __cpuid(0).eax;
+            let leaf1 = __cpuid(1).ecx;
+            let leaf7 = if max >= 7 {
+                __cpuid_count(7, 0)
+            } else {
+                CpuidResult {
+                    eax: 0,
+                    ebx: 0,
+                    ecx: 0,
+                    edx: 0,
+                }
+            };
+            (leaf1, leaf7.ebx)
+        }
+    }
+
+    #[target_feature(enable = "xsave")]
+    pub unsafe fn xcr0() -> u64 {
+        _xgetbv(0)
+    }
+}
+
+/// SHA extensions with SSSE3 and SSE4.1 (byte shuffles, blends) are usable
+pub fn has_sha_ni() -> bool {
+    #[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+    {
+        cached(&SHA_NI, || {
+            let (ecx, ebx) = cpuid::features();
+            let need = cpuid::SSSE3 | cpuid::SSE41;
+            ecx & need == need && ebx & cpuid::SHA != 0
+        })
+    }
+    #[cfg(not(all(target_arch = "x86_64", feature = "hw-accel")))]
+    {
+        false
+    }
+}
+
+/// AVX2 and BMI2 are usable (the CPU has them and the OS saves YMM state)
+pub fn has_avx2() -> bool {
+    #[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+    {
+        cached(&AVX2, || {
+            let (ecx, ebx) = cpuid::features();
+            let need_ecx = cpuid::OSXSAVE | cpuid::AVX;
+            let need_ebx = cpuid::AVX2 | cpuid::BMI2;
+            ecx & need_ecx == need_ecx
+                && ebx & need_ebx == need_ebx
+                // SAFETY: OSXSAVE is set, so XGETBV is enabled
+                && unsafe { cpuid::xcr0() } & cpuid::XCR0_YMM == cpuid::XCR0_YMM
+        })
+    }
+    #[cfg(not(all(target_arch = "x86_64", feature = "hw-accel")))]
+    {
+        false
+    }
+}
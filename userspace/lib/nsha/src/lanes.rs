@@ -0,0 +1,298 @@
+//! Multi-buffer hashing: several independent messages, one per SIMD lane
+//!
+//! A single SHA-2 stream is a serial dependency chain, so vector units only
+//! help it through the message schedule. Independent streams have no such
+//! chain: HMAC's inner and outer hashes of several PBKDF2 output blocks,
+//! for example, can advance together with each stream in its own lane.
+//!
+//! [`compress256_lanes`] and [`compress512_lanes`] advance every state by
+//! one block. [`sha256_many`] and [`sha512_many`] hash whole messages of
+//! any lengths.
+//!
+//! With SHA-NI a single SHA-256 stream is already faster per byte than a
+//! lane of the vector kernels, so the lanes are then run one by one.
+
+use alloc::vec;
+use alloc::vec::Vec;
+
+use crate::sha256::{compress256, SHA256_BLOCK_SIZE, SHA256_DIGEST_SIZE, SHA256_H};
+use crate::sha512::{compress512, SHA512_BLOCK_SIZE, SHA512_DIGEST_SIZE, SHA512_H};
+
+#[cfg(target_arch = "x86_64")]
+use crate::lanes_x86::sse2;
+#[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+use crate::{cpu, lanes_x86::avx2};
+
+/// Advance each SHA-256 state by its own block: `states[i]` with
+/// `blocks[i]`
+pub fn compress256_lanes(states: &mut [[u32; 8]], blocks: &[[u8; SHA256_BLOCK_SIZE]]) {
+    assert_eq!(states.len(), blocks.len());
+
+    #[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+    {
+        if cpu::has_sha_ni() {
+            for (state, block) in states.iter_mut().zip(blocks) {
+                compress256(state, block);
+            }
+            return;
+        }
+        if cpu::has_avx2() {
+            // SAFETY: AVX2 was detected
+            unsafe { in_groups(states, blocks, avx2::compress256, compress256) };
+            return;
+        }
+    }
+
+    #[cfg(target_arch = "x86_64")]
+    // SAFETY: SSE2 is part of the x86_64 baseline
+    unsafe {
+        in_groups(states, blocks, sse2::compress256, compress256)
+    };
+
+    #[cfg(not(target_arch = "x86_64"))]
+    for (state, block) in states.iter_mut().zip(blocks) {
+        compress256(state, block);
+    }
+}
+
+/// Advance each SHA-512 state by its own block: `states[i]` with
+/// `blocks[i]`
+pub fn compress512_lanes(states: &mut [[u64; 8]], blocks: &[[u8; SHA512_BLOCK_SIZE]]) {
+    assert_eq!(states.len(), blocks.len());
+
+    #[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+    if cpu::has_avx2() {
+        // SAFETY: AVX2 was detected
+        unsafe { in_groups(states, blocks, avx2::compress512, compress512) };
+        return;
+    }
+
+    for (state, block) in states.iter_mut().zip(blocks) {
+        compress512(state, block);
+    }
+}
+
+/// Run `kernel` over groups of `N` lanes. A short final group is padded
+/// with dummy lanes, unless only one lane is left, which `single` handles.
+#[cfg(target_arch = "x86_64")]
+unsafe fn in_groups<W: Copy + Default, const B: usize, const N: usize>(
+    states: &mut [[W; 8]],
+    blocks: &[[u8; B]],
+    kernel: unsafe fn(&mut [[W; 8]; N], &[[u8; B]; N]),
+    single: fn(&mut [W; 8], &[u8]),
+) {
+    let mut i = 0;
+    while states.len() - i >= 2 {
+        let n = (states.len() - i).min(N);
+        let mut s = [[W::default(); 8]; N];
+        let mut b = [[0u8; B]; N];
+        s[..n].copy_from_slice(&states[i..i + n]);
+        b[..n].copy_from_slice(&blocks[i..i + n]);
+        kernel(&mut s, &b);
+        states[i..i + n].copy_from_slice(&s[..n]);
+        i += n;
+    }
+    if i < states.len() {
+        single(&mut states[i], &blocks[i]);
+    }
+}
+
+/// Number of blocks in the padded message: the data, the 0x80 byte and a
+/// `len_bytes` big-endian bit count
+fn padded_blocks<const B: usize>(len: usize, len_bytes: usize) -> usize {
+    (len + 1 + len_bytes).div_ceil(B)
+}
+
+/// Block `r` of the padded message
+fn padded_block<const B: usize>(msg: &[u8], r: usize, len_bytes: usize) -> [u8; B] {
+    let mut block = [0u8; B];
+    let start = r * B;
+    if start < msg.len() {
+        let end = msg.len().min(start + B);
+        block[..end - start].copy_from_slice(&msg[start..end]);
+    }
+    if (start..start + B).contains(&msg.len()) {
+        block[msg.len() - start] = 0x80;
+    }
+    if r + 1 == padded_blocks::<B>(msg.len(), len_bytes) {
+        let bits = (msg.len() as u128 * 8).to_be_bytes();
+        block[B - len_bytes..].copy_from_slice(&bits[16 - len_bytes..]);
+    }
+    block
+}
+
+/// Hash every message in `messages`, the whole batch advancing one block
+/// per step. Messages that run out of blocks drop out of the batch.
+fn hash_many<W: Copy + Default, const B: usize>(
+    messages: &[&[u8]],
+    iv: [W; 8],
+    len_bytes: usize,
+    compress: fn(&mut [[W; 8]], &[[u8; B]]),
+) -> Vec<[W; 8]> {
+    let mut states = vec![iv; messages.len()];
+    let counts: Vec<usize> = messages
+        .iter()
+        .map(|m| padded_blocks::<B>(m.len(), len_bytes))
+        .collect();
+    let steps = counts.iter().copied().max().unwrap_or(0);
+
+    let mut active = Vec::with_capacity(messages.len());
+    let mut lane_states = Vec::with_capacity(messages.len());
+    let mut lane_blocks = Vec::with_capacity(messages.len());
+    for r in 0..steps {
+        active.clear();
+        lane_states.clear();
+        lane_blocks.clear();
+        for (i, msg) in messages.iter().enumerate() {
+            if r < counts[i] {
+                active.push(i);
+                lane_states.push(states[i]);
+                lane_blocks.push(padded_block::<B>(msg, r, len_bytes));
+            }
+        }
+        compress(&mut lane_states, &lane_blocks);
+        for (&i, s) in active.iter().zip(&lane_states) {
+            states[i] = *s;
+        }
+    }
+    states
+}
+
+/// SHA-256 of each message, computed in parallel lanes
+pub fn sha256_many(messages: &[&[u8]]) -> Vec<[u8; SHA256_DIGEST_SIZE]> {
+    hash_many(messages, SHA256_H, 8, compress256_lanes)
+        .into_iter()
+        .map(|state| {
+            let mut out = [0u8; SHA256_DIGEST_SIZE];
+            for (chunk, word) in out.chunks_exact_mut(4).zip(state) {
+                chunk.copy_from_slice(&word.to_be_bytes());
+            }
+            out
+        })
+        .collect()
+}
+
+/// SHA-512 of each message, computed in parallel lanes
+pub fn sha512_many(messages: &[&[u8]]) -> Vec<[u8; SHA512_DIGEST_SIZE]> {
+    hash_many(messages, SHA512_H, 16, compress512_lanes)
+        .into_iter()
+        .map(|state| {
+            let mut out = [0u8; SHA512_DIGEST_SIZE];
+            for (chunk, word) in out.chunks_exact_mut(8).zip(state) {
+                chunk.copy_from_slice(&word.to_be_bytes());
+            }
+            out
+        })
+        .collect()
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::{sha256, sha512};
+
+    /// Deterministic test bytes
+    fn bytes(n: usize, seed: u8) -> Vec<u8> {
+        (0..n)
+            .map(|i| (i as u8).wrapping_mul(31).wrapping_add(seed))
+            .collect()
+    }
+
+    #[test]
+    fn test_compress256_lanes_matches_single() {
+        for lanes in 0..=11 {
+            let blocks: Vec<[u8; 64]> = (0..lanes)
+                .map(|l| bytes(64, l as u8).try_into().unwrap())
+                .collect();
+            let mut states: Vec<[u32; 8]> =
+                (0..lanes).map(|l| SHA256_H.map(|w| w ^ l as u32)).collect();
+            let mut expected = states.clone();
+            for (s, b) in expected.iter_mut().zip(&blocks) {
+                crate::sha256::compress_block(s, b);
+            }
+            compress256_lanes(&mut states, &blocks);
+            assert_eq!(states, expected, "{} lanes", lanes);
+        }
+    }
+
+    #[test]
+    fn test_compress512_lanes_matches_single() {
+        for lanes in 0..=9 {
+            let blocks: Vec<[u8; 128]> = (0..lanes)
+                .map(|l| bytes(128, l as u8).try_into().unwrap())
+                .collect();
+            let mut states: Vec<[u64; 8]> =
+                (0..lanes).map(|l| SHA512_H.map(|w| w ^ l as u64)).collect();
+            let mut expected = states.clone();
+            for (s, b) in expected.iter_mut().zip(&blocks) {
+                crate::sha512::compress_block(s, b);
+            }
+            compress512_lanes(&mut states, &blocks);
+            assert_eq!(states, expected, "{} lanes", lanes);
+        }
+    }
+
+    /// The SSE2 kernel, even where dispatch would pick another one
+    #[test]
+    #[cfg(target_arch = "x86_64")]
+    fn test_sse2_kernel() {
+        let blocks: [[u8; 64]; 4] =
+            core::array::from_fn(|l| bytes(64, l as u8).try_into().unwrap());
+        let mut states = [SHA256_H; 4];
+        let mut expected = states;
+        for (s, b) in expected.iter_mut().zip(&blocks) {
+            crate::sha256::compress_block(s, b);
+        }
+        // SAFETY: SSE2 is part of the x86_64 baseline
+        unsafe { sse2::compress256(&mut states, &blocks) };
+        assert_eq!(states, expected);
+    }
+
+    /// The AVX2 SHA-256 kernel, which dispatch skips when SHA-NI is present
+    #[test]
+    #[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+    fn test_avx2_kernel() {
+        if !cpu::has_avx2() {
+            return;
+        }
+        let blocks: [[u8; 64]; 8] =
+            core::array::from_fn(|l| bytes(64, l as u8).try_into().unwrap());
+        let mut states = [SHA256_H; 8];
+        let mut expected = states;
+        for (s, b) in expected.iter_mut().zip(&blocks) {
+            crate::sha256::compress_block(s, b);
+        }
+        // SAFETY: AVX2 was detected
+        unsafe { avx2::compress256(&mut states, &blocks) };
+        assert_eq!(states, expected);
+    }
+
+    #[test]
+    fn test_many_matches_single() {
+        // Lengths around every padding boundary, in one uneven batch
+        let lengths = [
+            0, 1, 55, 56, 63, 64, 111, 112, 119, 120, 127, 128, 129, 300, 1000,
+        ];
+        let data: Vec<Vec<u8>> = lengths
+            .iter()
+            .enumerate()
+            .map(|(i, &n)| bytes(n, i as u8))
+            .collect();
+        let messages: Vec<&[u8]> = data.iter().map(|m| m.as_slice()).collect();
+
+        let digests = sha256_many(&messages);
+        for (msg, digest) in messages.iter().zip(&digests) {
+            assert_eq!(*digest, sha256(msg), "SHA-256 of {} bytes", msg.len());
+        }
+        let digests = sha512_many(&messages);
+        for (msg, digest) in messages.iter().zip(&digests) {
+            assert_eq!(
+                &digest[..],
+                &sha512(msg)[..],
+                "SHA-512 of {} bytes",
+                msg.len()
+            );
+        }
+        assert!(sha256_many(&[]).is_empty());
+    }
+}
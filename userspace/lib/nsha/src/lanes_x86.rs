@@ -0,0 +1,147 @@
+//! Multi-buffer SHA-2 kernels (x86_64)
+//!
+//! Each vector lane carries a different message: register `x` holds the
+//! same state word, or schedule word, of every lane. The rounds are then
+//! the scalar rounds applied lane-wise, with rotates built from two shifts.
+//!
+//! - [`sse2::compress256`]: four SHA-256 lanes. SSE2 is part of the x86_64
+//!   baseline, so it needs no detection.
+//! - [`avx2::compress256`] and [`avx2::compress512`]: eight SHA-256 or four
+//!   SHA-512 lanes, when [`cpu::has_avx2`](crate::cpu::has_avx2).
+
+/// Define `$name`, compressing one block per lane. `$word` is the hash word
+/// type and the rotate amounts are (Σ0, Σ1, σ0, σ1) from FIPS 180-4.
+macro_rules! lanes_kernel {
+    (
+        $(#[$attr:meta])*
+        fn $name:ident: $lanes:literal x $word:ty, $block:literal bytes, $k:expr;
+        vector $vec:ty, $loadu:ident, $storeu:ident, $set1:ident,
+            $add:ident, $srli:ident, $slli:ident, $xor:ident, $and:ident, $andnot:ident, $or:ident;
+        sums [$a0:literal, $a1:literal, $a2:literal], [$e0:literal, $e1:literal, $e2:literal];
+        sigmas [$s00:literal, $s01:literal, $s0s:literal], [$s10:literal, $s11:literal, $s1s:literal];
+    ) => {
+        $(#[$attr])*
+        pub unsafe fn $name(states: &mut [[$word; 8]; $lanes], blocks: &[[u8; $block]; $lanes]) {
+            const BITS: i32 = <$word>::BITS as i32;
+            const BYTES: usize = core::mem::size_of::<$word>();
+
+            macro_rules! rotr {
+                ($x:expr, $n:literal) => {{
+                    let x = $x;
+                    $or($srli(x, $n), $slli(x, BITS - $n))
+                }};
+            }
+            macro_rules! xor3 {
+                ($x:expr, $y:expr, $z:expr) => {
+                    $xor($xor($x, $y), $z)
+                };
+            }
+
+            // Gather word `i` of every lane into one vector
+            let gather = |words: [$word; $lanes]| $loadu(words.as_ptr() as *const $vec);
+
+            let mut w = [$set1(0); 16];
+            for (i, wi) in w.iter_mut().enumerate() {
+                *wi = gather(core::array::from_fn(|l| {
+                    <$word>::from_be_bytes(
+                        blocks[l][i * BYTES..(i + 1) * BYTES].try_into().unwrap(),
+                    )
+                }));
+            }
+            let mut s = [$set1(0); 8];
+            for (j, sj) in s.iter_mut().enumerate() {
+                *sj = gather(core::array::from_fn(|l| states[l][j]));
+            }
+
+            let [mut a, mut b, mut c, mut d, mut e, mut f, mut g, mut h] = s;
+            for (t, &k) in $k.iter().enumerate() {
+                if t >= 16 {
+                    let w15 = w[(t + 1) % 16];
+                    let w2 = w[(t + 14) % 16];
+                    let s0 = xor3!(rotr!(w15, $s00), rotr!(w15, $s01), $srli(w15, $s0s));
+                    let s1 = xor3!(rotr!(w2, $s10), rotr!(w2, $s11), $srli(w2, $s1s));
+                    w[t % 16] = $add($add(w[t % 16], s0), $add(w[(t + 9) % 16], s1));
+                }
+
+                let s1 = xor3!(rotr!(e, $e0), rotr!(e, $e1), rotr!(e, $e2));
+                let ch = $xor($and(e, f), $andnot(e, g));
+                let t1 = $add($add(h, s1), $add(ch, $add($set1(k as _), w[t % 16])));
+                let s0 = xor3!(rotr!(a, $a0), rotr!(a, $a1), rotr!(a, $a2));
+                let maj = $or($and(a, b), $and(c, $or(a, b)));
+                let t2 = $add(s0, maj);
+
+                h = g;
+                g = f;
+                f = e;
+                e = $add(d, t1);
+                d = c;
+                c = b;
+                b = a;
+                a = $add(t1, t2);
+            }
+
+            for (j, v) in [a, b, c, d, e, f, g, h].into_iter().enumerate() {
+                let mut out = [0 as $word; $lanes];
+                $storeu(out.as_mut_ptr() as *mut $vec, $add(s[j], v));
+                for (state, word) in states.iter_mut().zip(out) {
+                    state[j] = word;
+                }
+            }
+        }
+    };
+}
+
+pub mod sse2 {
+    use core::arch::x86_64::*;
+
+    use crate::sha256::SHA256_K;
+
+    lanes_kernel! {
+        /// One SHA-256 block in each of four lanes
+        ///
+        /// # Safety
+        /// Requires SSE2, which every x86_64 CPU has.
+        fn compress256: 4 x u32, 64 bytes, SHA256_K;
+        vector __m128i, _mm_loadu_si128, _mm_storeu_si128, _mm_set1_epi32,
+            _mm_add_epi32, _mm_srli_epi32, _mm_slli_epi32,
+            _mm_xor_si128, _mm_and_si128, _mm_andnot_si128, _mm_or_si128;
+        sums [2, 13, 22], [6, 11, 25];
+        sigmas [7, 18, 3], [17, 19, 10];
+    }
+}
+
+#[cfg(feature = "hw-accel")]
+pub mod avx2 {
+    use core::arch::x86_64::*;
+
+    use crate::sha256::SHA256_K;
+    use crate::sha512::SHA512_K;
+
+    lanes_kernel! {
+        /// One SHA-256 block in each of eight lanes
+        ///
+        /// # Safety
+        /// The CPU must support AVX2.
+        #[target_feature(enable = "avx2")]
+        fn compress256: 8 x u32, 64 bytes, SHA256_K;
+        vector __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_set1_epi32,
+            _mm256_add_epi32, _mm256_srli_epi32, _mm256_slli_epi32,
+            _mm256_xor_si256, _mm256_and_si256, _mm256_andnot_si256, _mm256_or_si256;
+        sums [2, 13, 22], [6, 11, 25];
+        sigmas [7, 18, 3], [17, 19, 10];
+    }
+
+    lanes_kernel! {
+        /// One SHA-512 block in each of four lanes
+        ///
+        /// # Safety
+        /// The CPU must support AVX2.
+        #[target_feature(enable = "avx2")]
+        fn compress512: 4 x u64, 128 bytes, SHA512_K;
+        vector __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_set1_epi64x,
+            _mm256_add_epi64, _mm256_srli_epi64, _mm256_slli_epi64,
+            _mm256_xor_si256, _mm256_and_si256, _mm256_andnot_si256, _mm256_or_si256;
+        sums [28, 34, 39], [14, 18, 41];
+        sigmas [1, 8, 7], [19, 61, 6];
+    }
+}
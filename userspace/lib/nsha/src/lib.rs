@@ -0,0 +1,40 @@
+//! SHA-1 and SHA-2 for NexaOS
+//!
+//! One implementation serves both the kernel (module signature digests) and
+//! ncryptolib, so the crate is `no_std` and only needs `alloc`.
+//!
+//! Each hash has a portable compression function and, with the `hw-accel`
+//! feature, accelerated ones picked at run time:
+//!
+//! - SHA-1 and SHA-256 use the SHA extensions (SHA-NI) when present.
+//! - SHA-512 computes its message schedule with AVX2 and its rounds with
+//!   BMI2 rotates.
+//!
+//! [`lanes`] hashes several independent messages at once, one per SIMD
+//! lane, for callers such as PBKDF2 that have many short inputs.
+
+#![no_std]
+
+extern crate alloc;
+#[cfg(any(test, feature = "std"))]
+extern crate std;
+
+pub mod cpu;
+pub mod lanes;
+mod sha1;
+mod sha256;
+mod sha512;
+
+#[cfg(target_arch = "x86_64")]
+mod lanes_x86;
+#[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+mod sha512_avx2;
+#[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+mod sha_ni;
+
+pub use sha1::{compress1, sha1, Sha1, SHA1_BLOCK_SIZE, SHA1_DIGEST_SIZE, SHA1_H};
+pub use sha256::{compress256, sha256, Sha256, SHA256_BLOCK_SIZE, SHA256_DIGEST_SIZE, SHA256_H};
+pub use sha512::{
+    compress512, sha384, sha512, Sha384, Sha512, SHA384_BLOCK_SIZE, SHA384_DIGEST_SIZE, SHA384_H,
+    SHA512_BLOCK_SIZE, SHA512_DIGEST_SIZE, SHA512_H,
+};
@@ -0,0 +1,242 @@
+//! SHA-1 (FIPS 180-4)
+//!
+//! SHA-1 is broken for collision resistance and is only here for legacy
+//! protocols, Git object names and checksums; see ncryptolib's `sha1`
+//! module for the caveats.
+
+#[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+use crate::{cpu, sha_ni};
+
+// ============================================================================
+// SHA-1 Constants
+// ============================================================================
+
+/// SHA-1 digest size in bytes
+pub const SHA1_DIGEST_SIZE: usize = 20;
+/// SHA-1 block size in bytes
+pub const SHA1_BLOCK_SIZE: usize = 64;
+
+/// Initial hash values
+pub const SHA1_H: [u32; 5] = [0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0];
+
+/// Round constants
+const SHA1_K: [u32; 4] = [0x5a827999, 0x6ed9eba1, 0x8f1bbcdc, 0xca62c1d6];
+
+// ============================================================================
+// SHA-1 Implementation
+// ============================================================================
+
+/// SHA-1 hasher state
+#[derive(Clone)]
+pub struct Sha1 {
+    state: [u32; 5],
+    buffer: [u8; SHA1_BLOCK_SIZE],
+    buffer_len: usize,
+    total_bits: u64,
+}
+
+impl Default for Sha1 {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl Sha1 {
+    /// Create a new SHA-1 hasher
+    pub const fn new() -> Self {
+        Self {
+            state: SHA1_H,
+            buffer: [0u8; SHA1_BLOCK_SIZE],
+            buffer_len: 0,
+            total_bits: 0,
+        }
+    }
+
+    /// Reset hasher to initial state
+    pub fn reset(&mut self) {
+        self.state = SHA1_H;
+        self.buffer = [0u8; SHA1_BLOCK_SIZE];
+        self.buffer_len = 0;
+        self.total_bits = 0;
+    }
+
+    /// Update hash with input data
+    pub fn update(&mut self, data: &[u8]) {
+        let mut offset = 0;
+
+        // Fill buffer if we have pending data
+        if self.buffer_len > 0 {
+            let to_copy = core::cmp::min(SHA1_BLOCK_SIZE - self.buffer_len, data.len());
+            self.buffer[self.buffer_len..self.buffer_len + to_copy]
+                .copy_from_slice(&data[..to_copy]);
+            self.buffer_len += to_copy;
+            offset = to_copy;
+
+            if self.buffer_len == SHA1_BLOCK_SIZE {
+                compress1(&mut self.state, &self.buffer);
+                self.buffer_len = 0;
+            }
+        }
+
+        // Process full blocks directly
+        let whole = (data.len() - offset) / SHA1_BLOCK_SIZE * SHA1_BLOCK_SIZE;
+        compress1(&mut self.state, &data[offset..offset + whole]);
+        offset += whole;
+
+        // Buffer remaining data
+        if offset < data.len() {
+            let remaining = data.len() - offset;
+            self.buffer[..remaining].copy_from_slice(&data[offset..]);
+            self.buffer_len = remaining;
+        }
+
+        self.total_bits += (data.len() as u64) * 8;
+    }
+
+    /// Finalize and return the hash digest
+    pub fn finalize(&mut self) -> [u8; SHA1_DIGEST_SIZE] {
+        // Padding
+        let mut padding = [0u8; SHA1_BLOCK_SIZE * 2];
+        padding[0] = 0x80;
+
+        let padding_len = if self.buffer_len < 56 {
+            56 - self.buffer_len
+        } else {
+            120 - self.buffer_len
+        };
+
+        // SHA-1 uses big-endian length
+        let len_bytes = self.total_bits.to_be_bytes();
+        padding[padding_len..padding_len + 8].copy_from_slice(&len_bytes);
+
+        self.update(&padding[..padding_len + 8]);
+
+        // Output hash (big-endian)
+        let mut result = [0u8; SHA1_DIGEST_SIZE];
+        for (i, &val) in self.state.iter().enumerate() {
+            result[i * 4..(i + 1) * 4].copy_from_slice(&val.to_be_bytes());
+        }
+        result
+    }
+}
+
+/// Compute SHA-1 hash (convenience function)
+///
+/// **WARNING**: SHA-1 is NOT secure for cryptographic purposes.
+/// Use only for file integrity verification or Git compatibility.
+pub fn sha1(data: &[u8]) -> [u8; SHA1_DIGEST_SIZE] {
+    let mut hasher = Sha1::new();
+    hasher.update(data);
+    hasher.finalize()
+}
+
+/// Run the compression function over `blocks`, a whole number of 64-byte
+/// blocks, using the fastest implementation this CPU has
+pub fn compress1(state: &mut [u32; 5], blocks: &[u8]) {
+    debug_assert!(blocks.len() % SHA1_BLOCK_SIZE == 0);
+
+    #[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+    if cpu::has_sha_ni() {
+        // SAFETY: SHA-NI, SSSE3 and SSE4.1 were detected
+        unsafe { sha_ni::compress1(state, blocks) };
+        return;
+    }
+
+    for block in blocks.chunks_exact(SHA1_BLOCK_SIZE) {
+        compress_block(state, block.try_into().unwrap());
+    }
+}
+
+/// Portable compression of one block
+pub(crate) fn compress_block(state: &mut [u32; 5], block: &[u8; SHA1_BLOCK_SIZE]) {
+    // Parse block into 16 big-endian 32-bit words and extend to 80
+    let mut w = [0u32; 80];
+    for i in 0..16 {
+        w[i] = u32::from_be_bytes([
+            block[i * 4],
+            block[i * 4 + 1],
+            block[i * 4 + 2],
+            block[i * 4 + 3],
+        ]);
+    }
+
+    // Message schedule expansion
+    for i in 16..80 {
+        w[i] = (w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16]).rotate_left(1);
+    }
+
+    let mut a = state[0];
+    let mut b = state[1];
+    let mut c = state[2];
+    let mut d = state[3];
+    let mut e = state[4];
+
+    for i in 0..80 {
+        let (f, k) = match i {
+            0..=19 => ((b & c) | ((!b) & d), SHA1_K[0]),
+            20..=39 => (b ^ c ^ d, SHA1_K[1]),
+            40..=59 => ((b & c) | (b & d) | (c & d), SHA1_K[2]),
+            _ => (b ^ c ^ d, SHA1_K[3]),
+        };
+
+        let temp = a
+            .rotate_left(5)
+            .wrapping_add(f)
+            .wrapping_add(e)
+            .wrapping_add(k)
+            .wrapping_add(w[i]);
+
+        e = d;
+        d = c;
+        c = b.rotate_left(30);
+        b = a;
+        a = temp;
+    }
+
+    state[0] = state[0].wrapping_add(a);
+    state[1] = state[1].wrapping_add(b);
+    state[2] = state[2].wrapping_add(c);
+    state[3] = state[3].wrapping_add(d);
+    state[4] = state[4].wrapping_add(e);
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use alloc::vec::Vec;
+
+    fn hex(bytes: &[u8]) -> alloc::string::String {
+        bytes.iter().map(|b| alloc::format!("{:02x}", b)).collect()
+    }
+
+    #[test]
+    fn test_sha1_vectors() {
+        assert_eq!(hex(&sha1(b"")), "da39a3ee5e6b4b0d3255bfef95601890afd80709");
+        assert_eq!(
+            hex(&sha1(b"abc")),
+            "a9993e364706816aba3e25717850c26c9cd0d89d"
+        );
+        assert_eq!(
+            hex(&sha1(
+                b"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"
+            )),
+            "84983e441c3bd26ebaae4aa1f95129e5e54670f1"
+        );
+    }
+
+    /// The dispatched compression (SHA-NI here when present) agrees with
+    /// the portable one
+    #[test]
+    fn test_compress1_matches_portable() {
+        let data: Vec<u8> = (0..64 * 9u32).map(|i| (i * 13 + 5) as u8).collect();
+        for blocks in 0..=9 {
+            let mut fast = SHA1_H;
+            compress1(&mut fast, &data[..64 * blocks]);
+            let mut portable = SHA1_H;
+            for block in data[..64 * blocks].chunks_exact(64) {
+                compress_block(&mut portable, block.try_into().unwrap());
+            }
+            assert_eq!(fast, portable, "{} blocks", blocks);
+        }
+    }
+}
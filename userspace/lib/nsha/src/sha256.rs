@@ -0,0 +1,263 @@
+//! SHA-256 (FIPS 180-4)
+
+#[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+use crate::{cpu, sha_ni};
+
+/// SHA-256 digest size in bytes
+pub const SHA256_DIGEST_SIZE: usize = 32;
+/// SHA-256 block size in bytes
+pub const SHA256_BLOCK_SIZE: usize = 64;
+
+/// SHA-256 initial hash values (first 32 bits of the fractional parts of
+/// the square roots of the first 8 primes 2..19)
+pub const SHA256_H: [u32; 8] = [
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+];
+
+/// SHA-256 round constants (first 32 bits of the fractional parts of the
+/// cube roots of the first 64 primes 2..311)
+pub(crate) const SHA256_K: [u32; 64] = [
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+];
+
+/// SHA-256 hasher state
+#[derive(Clone)]
+pub struct Sha256 {
+    state: [u32; 8],
+    buffer: [u8; SHA256_BLOCK_SIZE],
+    buffer_len: usize,
+    total_bits: u64,
+}
+
+impl Default for Sha256 {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl Sha256 {
+    /// Create a new SHA-256 hasher
+    pub const fn new() -> Self {
+        Self {
+            state: SHA256_H,
+            buffer: [0u8; SHA256_BLOCK_SIZE],
+            buffer_len: 0,
+            total_bits: 0,
+        }
+    }
+
+    /// Reset hasher to initial state
+    pub fn reset(&mut self) {
+        self.state = SHA256_H;
+        self.buffer = [0u8; SHA256_BLOCK_SIZE];
+        self.buffer_len = 0;
+        self.total_bits = 0;
+    }
+
+    /// Update hash with input data
+    pub fn update(&mut self, data: &[u8]) {
+        let mut offset = 0;
+
+        // Fill buffer if we have pending data
+        if self.buffer_len > 0 {
+            let to_copy = core::cmp::min(SHA256_BLOCK_SIZE - self.buffer_len, data.len());
+            self.buffer[self.buffer_len..self.buffer_len + to_copy]
+                .copy_from_slice(&data[..to_copy]);
+            self.buffer_len += to_copy;
+            offset = to_copy;
+
+            if self.buffer_len == SHA256_BLOCK_SIZE {
+                compress256(&mut self.state, &self.buffer);
+                self.buffer_len = 0;
+            }
+        }
+
+        // Process full blocks directly, in one call so accelerated
+        // implementations keep the state in registers between blocks
+        let whole = (data.len() - offset) / SHA256_BLOCK_SIZE * SHA256_BLOCK_SIZE;
+        compress256(&mut self.state, &data[offset..offset + whole]);
+        offset += whole;
+
+        // Buffer remaining data
+        if offset < data.len() {
+            let remaining = data.len() - offset;
+            self.buffer[..remaining].copy_from_slice(&data[offset..]);
+            self.buffer_len = remaining;
+        }
+
+        self.total_bits += (data.len() as u64) * 8;
+    }
+
+    /// Finalize and return the hash digest
+    pub fn finalize(&mut self) -> [u8; SHA256_DIGEST_SIZE] {
+        // Padding
+        let mut padding = [0u8; SHA256_BLOCK_SIZE * 2];
+        padding[0] = 0x80;
+
+        let padding_len = if self.buffer_len < 56 {
+            56 - self.buffer_len
+        } else {
+            120 - self.buffer_len
+        };
+
+        let len_bytes = self.total_bits.to_be_bytes();
+        padding[padding_len..padding_len + 8].copy_from_slice(&len_bytes);
+
+        self.update(&padding[..padding_len + 8]);
+
+        // Output hash
+        let mut result = [0u8; SHA256_DIGEST_SIZE];
+        for (i, &val) in self.state.iter().enumerate() {
+            result[i * 4..(i + 1) * 4].copy_from_slice(&val.to_be_bytes());
+        }
+        result
+    }
+}
+
+/// Compute SHA-256 hash (convenience function)
+pub fn sha256(data: &[u8]) -> [u8; SHA256_DIGEST_SIZE] {
+    let mut hasher = Sha256::new();
+    hasher.update(data);
+    hasher.finalize()
+}
+
+/// Run the compression function over `blocks`, a whole number of 64-byte
+/// blocks, using the fastest implementation this CPU has
+pub fn compress256(state: &mut [u32; 8], blocks: &[u8]) {
+    debug_assert!(blocks.len() % SHA256_BLOCK_SIZE == 0);
+
+    #[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+    if cpu::has_sha_ni() {
+        // SAFETY: SHA-NI, SSSE3 and SSE4.1 were detected
+        unsafe { sha_ni::compress256(state, blocks) };
+        return;
+    }
+
+    for block in blocks.chunks_exact(SHA256_BLOCK_SIZE) {
+        compress_block(state, block.try_into().unwrap());
+    }
+}
+
+/// Portable compression of one block
+pub(crate) fn compress_block(state: &mut [u32; 8], block: &[u8; SHA256_BLOCK_SIZE]) {
+    let mut w = [0u32; 64];
+
+    for i in 0..16 {
+        w[i] = u32::from_be_bytes([
+            block[i * 4],
+            block[i * 4 + 1],
+            block[i * 4 + 2],
+            block[i * 4 + 3],
+        ]);
+    }
+
+    for i in 16..64 {
+        let s0 = w[i - 15].rotate_right(7) ^ w[i - 15].rotate_right(18) ^ (w[i - 15] >> 3);
+        let s1 = w[i - 2].rotate_right(17) ^ w[i - 2].rotate_right(19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16]
+            .wrapping_add(s0)
+            .wrapping_add(w[i - 7])
+            .wrapping_add(s1);
+    }
+
+    let mut a = state[0];
+    let mut b = state[1];
+    let mut c = state[2];
+    let mut d = state[3];
+    let mut e = state[4];
+    let mut f = state[5];
+    let mut g = state[6];
+    let mut h = state[7];
+
+    for i in 0..64 {
+        let s1 = e.rotate_right(6) ^ e.rotate_right(11) ^ e.rotate_right(25);
+        let ch = (e & f) ^ ((!e) & g);
+        let temp1 = h
+            .wrapping_add(s1)
+            .wrapping_add(ch)
+            .wrapping_add(SHA256_K[i])
+            .wrapping_add(w[i]);
+        let s0 = a.rotate_right(2) ^ a.rotate_right(13) ^ a.rotate_right(22);
+        let maj = (a & b) ^ (a & c) ^ (b & c);
+        let temp2 = s0.wrapping_add(maj);
+
+        h = g;
+        g = f;
+        f = e;
+        e = d.wrapping_add(temp1);
+        d = c;
+        c = b;
+        b = a;
+        a = temp1.wrapping_add(temp2);
+    }
+
+    state[0] = state[0].wrapping_add(a);
+    state[1] = state[1].wrapping_add(b);
+    state[2] = state[2].wrapping_add(c);
+    state[3] = state[3].wrapping_add(d);
+    state[4] = state[4].wrapping_add(e);
+    state[5] = state[5].wrapping_add(f);
+    state[6] = state[6].wrapping_add(g);
+    state[7] = state[7].wrapping_add(h);
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use alloc::vec::Vec;
+
+    fn hex(bytes: &[u8]) -> alloc::string::String {
+        bytes.iter().map(|b| alloc::format!("{:02x}", b)).collect()
+    }
+
+    #[test]
+    fn test_sha256_vectors() {
+        assert_eq!(
+            hex(&sha256(b"")),
+            "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"
+        );
+        assert_eq!(
+            hex(&sha256(b"abc")),
+            "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"
+        );
+        assert_eq!(
+            hex(&sha256(
+                b"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"
+            )),
+            "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"
+        );
+    }
+
+    #[test]
+    fn test_sha256_streaming() {
+        let data: Vec<u8> = (0..1000u32).map(|i| (i * 7) as u8).collect();
+        let mut hasher = Sha256::new();
+        for chunk in data.chunks(37) {
+            hasher.update(chunk);
+        }
+        assert_eq!(hasher.finalize(), sha256(&data));
+    }
+
+    /// The dispatched compression (SHA-NI here when present) agrees with
+    /// the portable one
+    #[test]
+    fn test_compress256_matches_portable() {
+        let data: Vec<u8> = (0..64 * 9u32).map(|i| (i * 13 + 5) as u8).collect();
+        for blocks in 0..=9 {
+            let mut fast = SHA256_H;
+            compress256(&mut fast, &data[..64 * blocks]);
+            let mut portable = SHA256_H;
+            for block in data[..64 * blocks].chunks_exact(64) {
+                compress_block(&mut portable, block.try_into().unwrap());
+            }
+            assert_eq!(fast, portable, "{} blocks", blocks);
+        }
+    }
+}
@@ -0,0 +1,390 @@
+//! SHA-512 and SHA-384 (FIPS 180-4)
+
+use alloc::vec::Vec;
+
+#[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+use crate::{cpu, sha512_avx2};
+
+/// SHA-384 digest size in bytes
+pub const SHA384_DIGEST_SIZE: usize = 48;
+/// SHA-384 block size in bytes (same as SHA-512)
+pub const SHA384_BLOCK_SIZE: usize = 128;
+/// SHA-512 digest size in bytes
+pub const SHA512_DIGEST_SIZE: usize = 64;
+/// SHA-512 block size in bytes
+pub const SHA512_BLOCK_SIZE: usize = 128;
+
+/// SHA-512 initial hash values
+pub const SHA512_H: [u64; 8] = [
+    0x6a09e667f3bcc908,
+    0xbb67ae8584caa73b,
+    0x3c6ef372fe94f82b,
+    0xa54ff53a5f1d36f1,
+    0x510e527fade682d1,
+    0x9b05688c2b3e6c1f,
+    0x1f83d9abfb41bd6b,
+    0x5be0cd19137e2179,
+];
+
+/// SHA-384 initial hash values
+pub const SHA384_H: [u64; 8] = [
+    0xcbbb9d5dc1059ed8,
+    0x629a292a367cd507,
+    0x9159015a3070dd17,
+    0x152fecd8f70e5939,
+    0x67332667ffc00b31,
+    0x8eb44a8768581511,
+    0xdb0c2e0d64f98fa7,
+    0x47b5481dbefa4fa4,
+];
+
+/// SHA-512 round constants
+pub(crate) const SHA512_K: [u64; 80] = [
+    0x428a2f98d728ae22,
+    0x7137449123ef65cd,
+    0xb5c0fbcfec4d3b2f,
+    0xe9b5dba58189dbbc,
+    0x3956c25bf348b538,
+    0x59f111f1b605d019,
+    0x923f82a4af194f9b,
+    0xab1c5ed5da6d8118,
+    0xd807aa98a3030242,
+    0x12835b0145706fbe,
+    0x243185be4ee4b28c,
+    0x550c7dc3d5ffb4e2,
+    0x72be5d74f27b896f,
+    0x80deb1fe3b1696b1,
+    0x9bdc06a725c71235,
+    0xc19bf174cf692694,
+    0xe49b69c19ef14ad2,
+    0xefbe4786384f25e3,
+    0x0fc19dc68b8cd5b5,
+    0x240ca1cc77ac9c65,
+    0x2de92c6f592b0275,
+    0x4a7484aa6ea6e483,
+    0x5cb0a9dcbd41fbd4,
+    0x76f988da831153b5,
+    0x983e5152ee66dfab,
+    0xa831c66d2db43210,
+    0xb00327c898fb213f,
+    0xbf597fc7beef0ee4,
+    0xc6e00bf33da88fc2,
+    0xd5a79147930aa725,
+    0x06ca6351e003826f,
+    0x142929670a0e6e70,
+    0x27b70a8546d22ffc,
+    0x2e1b21385c26c926,
+    0x4d2c6dfc5ac42aed,
+    0x53380d139d95b3df,
+    0x650a73548baf63de,
+    0x766a0abb3c77b2a8,
+    0x81c2c92e47edaee6,
+    0x92722c851482353b,
+    0xa2bfe8a14cf10364,
+    0xa81a664bbc423001,
+    0xc24b8b70d0f89791,
+    0xc76c51a30654be30,
+    0xd192e819d6ef5218,
+    0xd69906245565a910,
+    0xf40e35855771202a,
+    0x106aa07032bbd1b8,
+    0x19a4c116b8d2d0c8,
+    0x1e376c085141ab53,
+    0x2748774cdf8eeb99,
+    0x34b0bcb5e19b48a8,
+    0x391c0cb3c5c95a63,
+    0x4ed8aa4ae3418acb,
+    0x5b9cca4f7763e373,
+    0x682e6ff3d6b2b8a3,
+    0x748f82ee5defb2fc,
+    0x78a5636f43172f60,
+    0x84c87814a1f0ab72,
+    0x8cc702081a6439ec,
+    0x90befffa23631e28,
+    0xa4506cebde82bde9,
+    0xbef9a3f7b2c67915,
+    0xc67178f2e372532b,
+    0xca273eceea26619c,
+    0xd186b8c721c0c207,
+    0xeada7dd6cde0eb1e,
+    0xf57d4f7fee6ed178,
+    0x06f067aa72176fba,
+    0x0a637dc5a2c898a6,
+    0x113f9804bef90dae,
+    0x1b710b35131c471b,
+    0x28db77f523047d84,
+    0x32caab7b40c72493,
+    0x3c9ebe0a15c9bebc,
+    0x431d67c49c100d4c,
+    0x4cc5d4becb3e42b6,
+    0x597f299cfc657e2a,
+    0x5fcb6fab3ad6faec,
+    0x6c44198c4a475817,
+];
+
+/// SHA-512 hasher state
+#[derive(Clone)]
+pub struct Sha512 {
+    state: [u64; 8],
+    buffer: [u8; SHA512_BLOCK_SIZE],
+    buffer_len: usize,
+    total_bits: u128,
+    digest_len: usize,
+}
+
+impl Default for Sha512 {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl Sha512 {
+    /// Create a new SHA-512 hasher
+    pub const fn new() -> Self {
+        Self {
+            state: SHA512_H,
+            buffer: [0u8; SHA512_BLOCK_SIZE],
+            buffer_len: 0,
+            total_bits: 0,
+            digest_len: SHA512_DIGEST_SIZE,
+        }
+    }
+
+    /// Create a new SHA-384 hasher
+    pub const fn new_384() -> Self {
+        Self {
+            state: SHA384_H,
+            buffer: [0u8; SHA512_BLOCK_SIZE],
+            buffer_len: 0,
+            total_bits: 0,
+            digest_len: SHA384_DIGEST_SIZE,
+        }
+    }
+
+    /// Reset hasher to initial state (SHA-512)
+    pub fn reset(&mut self) {
+        self.state = SHA512_H;
+        self.buffer = [0u8; SHA512_BLOCK_SIZE];
+        self.buffer_len = 0;
+        self.total_bits = 0;
+        self.digest_len = SHA512_DIGEST_SIZE;
+    }
+
+    /// Reset hasher to SHA-384 state
+    pub fn reset_384(&mut self) {
+        self.state = SHA384_H;
+        self.buffer = [0u8; SHA512_BLOCK_SIZE];
+        self.buffer_len = 0;
+        self.total_bits = 0;
+        self.digest_len = SHA384_DIGEST_SIZE;
+    }
+
+    /// Update hash with input data
+    pub fn update(&mut self, data: &[u8]) {
+        let mut offset = 0;
+
+        if self.buffer_len > 0 {
+            let to_copy = core::cmp::min(SHA512_BLOCK_SIZE - self.buffer_len, data.len());
+            self.buffer[self.buffer_len..self.buffer_len + to_copy]
+                .copy_from_slice(&data[..to_copy]);
+            self.buffer_len += to_copy;
+            offset = to_copy;
+
+            if self.buffer_len == SHA512_BLOCK_SIZE {
+                compress512(&mut self.state, &self.buffer);
+                self.buffer_len = 0;
+            }
+        }
+
+        let whole = (data.len() - offset) / SHA512_BLOCK_SIZE * SHA512_BLOCK_SIZE;
+        compress512(&mut self.state, &data[offset..offset + whole]);
+        offset += whole;
+
+        if offset < data.len() {
+            let remaining = data.len() - offset;
+            self.buffer[..remaining].copy_from_slice(&data[offset..]);
+            self.buffer_len = remaining;
+        }
+
+        self.total_bits += (data.len() as u128) * 8;
+    }
+
+    /// Finalize and return the hash digest
+    pub fn finalize(&mut self) -> Vec<u8> {
+        let mut padding = [0u8; SHA512_BLOCK_SIZE * 2];
+        padding[0] = 0x80;
+
+        let padding_len = if self.buffer_len < 112 {
+            112 - self.buffer_len
+        } else {
+            240 - self.buffer_len
+        };
+
+        let len_bytes = self.total_bits.to_be_bytes();
+        padding[padding_len..padding_len + 16].copy_from_slice(&len_bytes);
+
+        self.update(&padding[..padding_len + 16]);
+
+        let mut result = Vec::with_capacity(self.digest_len);
+        for i in 0..(self.digest_len / 8) {
+            result.extend_from_slice(&self.state[i].to_be_bytes());
+        }
+        result
+    }
+}
+
+/// SHA-384 hasher (wrapper around SHA-512)
+pub type Sha384 = Sha512;
+
+/// Compute SHA-384 hash
+pub fn sha384(data: &[u8]) -> Vec<u8> {
+    let mut hasher = Sha512::new_384();
+    hasher.update(data);
+    hasher.finalize()
+}
+
+/// Compute SHA-512 hash
+pub fn sha512(data: &[u8]) -> Vec<u8> {
+    let mut hasher = Sha512::new();
+    hasher.update(data);
+    hasher.finalize()
+}
+
+/// Run the compression function over `blocks`, a whole number of 128-byte
+/// blocks, using the fastest implementation this CPU has
+pub fn compress512(state: &mut [u64; 8], blocks: &[u8]) {
+    debug_assert!(blocks.len() % SHA512_BLOCK_SIZE == 0);
+
+    #[cfg(all(target_arch = "x86_64", feature = "hw-accel"))]
+    if cpu::has_avx2() {
+        // SAFETY: AVX2 and BMI2 were detected
+        unsafe { sha512_avx2::compress512(state, blocks) };
+        return;
+    }
+
+    for block in blocks.chunks_exact(SHA512_BLOCK_SIZE) {
+        compress_block(state, block.try_into().unwrap());
+    }
+}
+
+/// Portable compression of one block
+pub(crate) fn compress_block(state: &mut [u64; 8], block: &[u8; SHA512_BLOCK_SIZE]) {
+    let mut w = [0u64; 80];
+
+    for i in 0..16 {
+        w[i] = u64::from_be_bytes([
+            block[i * 8],
+            block[i * 8 + 1],
+            block[i * 8 + 2],
+            block[i * 8 + 3],
+            block[i * 8 + 4],
+            block[i * 8 + 5],
+            block[i * 8 + 6],
+            block[i * 8 + 7],
+        ]);
+    }
+
+    for i in 16..80 {
+        let s0 = w[i - 15].rotate_right(1) ^ w[i - 15].rotate_right(8) ^ (w[i - 15] >> 7);
+        let s1 = w[i - 2].rotate_right(19) ^ w[i - 2].rotate_right(61) ^ (w[i - 2] >> 6);
+        w[i] = w[i - 16]
+            .wrapping_add(s0)
+            .wrapping_add(w[i - 7])
+            .wrapping_add(s1);
+    }
+
+    let mut a = state[0];
+    let mut b = state[1];
+    let mut c = state[2];
+    let mut d = state[3];
+    let mut e = state[4];
+    let mut f = state[5];
+    let mut g = state[6];
+    let mut h = state[7];
+
+    for i in 0..80 {
+        let s1 = e.rotate_right(14) ^ e.rotate_right(18) ^ e.rotate_right(41);
+        let ch = (e & f) ^ ((!e) & g);
+        let temp1 = h
+            .wrapping_add(s1)
+            .wrapping_add(ch)
+            .wrapping_add(SHA512_K[i])
+            .wrapping_add(w[i]);
+        let s0 = a.rotate_right(28) ^ a.rotate_right(34) ^ a.rotate_right(39);
+        let maj = (a & b) ^ (a & c) ^ (b & c);
+        let temp2 = s0.wrapping_add(maj);
+
+        h = g;
+        g = f;
+        f = e;
+        e = d.wrapping_add(temp1);
+        d = c;
+        c = b;
+        b = a;
+        a = temp1.wrapping_add(temp2);
+    }
+
+    state[0] = state[0].wrapping_add(a);
+    state[1] = state[1].wrapping_add(b);
+    state[2] = state[2].wrapping_add(c);
+    state[3] = state[3].wrapping_add(d);
+    state[4] = state[4].wrapping_add(e);
+    state[5] = state[5].wrapping_add(f);
+    state[6] = state[6].wrapping_add(g);
+    state[7] = state[7].wrapping_add(h);
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn hex(bytes: &[u8]) -> alloc::string::String {
+        bytes.iter().map(|b| alloc::format!("{:02x}", b)).collect()
+    }
+
+    const TWO_BLOCK: &[u8] = b"abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu";
+
+    #[test]
+    fn test_sha512_vectors() {
+        assert_eq!(
+            hex(&sha512(b"abc")),
+            "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a\
+             2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f"
+        );
+        assert_eq!(
+            hex(&sha512(TWO_BLOCK)),
+            "8e959b75dae313da8cf4f72814fc143f8f7779c6eb9f7fa17299aeadb6889018\
+             501d289e4900f7e4331b99dec4b5433ac7d329eeb6dd26545e96e55b874be909"
+        );
+    }
+
+    #[test]
+    fn test_sha384_vectors() {
+        assert_eq!(
+            hex(&sha384(b"abc")),
+            "cb00753f45a35e8bb5a03d699ac65007272c32ab0eded1631a8b605a43ff5bed\
+             8086072ba1e7cc2358baeca134c825a7"
+        );
+        assert_eq!(
+            hex(&sha384(TWO_BLOCK)),
+            "09330c33f71147e83d192fc782cd1b4753111b173b3b05d22fa08086e3b0f712\
+             fcc7c71a557e2db966c3e9fa91746039"
+        );
+    }
+
+    /// The dispatched compression (AVX2 here when present) agrees with the
+    /// portable one
+    #[test]
+    fn test_compress512_matches_portable() {
+        let data: Vec<u8> = (0..128 * 5u32).map(|i| (i * 13 + 5) as u8).collect();
+        for blocks in 0..=5 {
+            let mut fast = SHA512_H;
+            compress512(&mut fast, &data[..128 * blocks]);
+            let mut portable = SHA512_H;
+            for block in data[..128 * blocks].chunks_exact(128) {
+                compress_block(&mut portable, block.try_into().unwrap());
+            }
+            assert_eq!(fast, portable, "{} blocks", blocks);
+        }
+    }
+}
@@ -0,0 +1,154 @@
+//! SHA-1 and SHA-256 on the x86 SHA extensions
+//!
+//! The instructions keep the working variables packed in two registers:
+//! `ABEF`/`CDGH` for SHA-256 and `ABCD` plus `E` for SHA-1. Each call to
+//! `sha256rnds2` does two rounds and each `sha1rnds4` four. The message
+//! schedule is computed four words at a time with `sha*msg1`/`sha*msg2`,
+//! keeping only the last four schedule vectors live.
+
+use core::arch::x86_64::*;
+
+use crate::sha256::SHA256_K;
+
+/// Byte order of a big-endian 32-bit word in each lane
+#[inline(always)]
+unsafe fn bswap32_mask() -> __m128i {
+    _mm_set_epi64x(0x0c0d_0e0f_0809_0a0b, 0x0405_0607_0001_0203)
+}
+
+/// SHA-256 compression of whole 64-byte blocks
+///
+/// # Safety
+/// The CPU must support SHA, SSSE3 and SSE4.1.
+#[target_feature(enable = "sha,sse2,ssse3,sse4.1")]
+pub unsafe fn compress256(state: &mut [u32; 8], blocks: &[u8]) {
+    let mask = bswap32_mask();
+    let ptr = state.as_mut_ptr() as *mut __m128i;
+
+    // Repack state words [a b c d] [e f g h] into ABEF and CDGH
+    let dcba = _mm_loadu_si128(ptr);
+    let hgfe = _mm_loadu_si128(ptr.add(1));
+    let cdab = _mm_shuffle_epi32(dcba, 0xb1);
+    let efgh = _mm_shuffle_epi32(hgfe, 0x1b);
+    let mut abef = _mm_alignr_epi8(cdab, efgh, 8);
+    let mut cdgh = _mm_blend_epi16(efgh, cdab, 0xf0);
+
+    for block in blocks.chunks_exact(64) {
+        let abef_saved = abef;
+        let cdgh_saved = cdgh;
+
+        let p = block.as_ptr() as *const __m128i;
+        let mut w = [
+            _mm_shuffle_epi8(_mm_loadu_si128(p), mask),
+            _mm_shuffle_epi8(_mm_loadu_si128(p.add(1)), mask),
+            _mm_shuffle_epi8(_mm_loadu_si128(p.add(2)), mask),
+            _mm_shuffle_epi8(_mm_loadu_si128(p.add(3)), mask),
+        ];
+
+        for i in 0..16 {
+            if i >= 4 {
+                // Slot i % 4 holds words 4(i-4).., the oldest of the four
+                let t = _mm_sha256msg1_epu32(w[i % 4], w[(i + 1) % 4]);
+                let t = _mm_add_epi32(t, _mm_alignr_epi8(w[(i + 3) % 4], w[(i + 2) % 4], 4));
+                w[i % 4] = _mm_sha256msg2_epu32(t, w[(i + 3) % 4]);
+            }
+            let k = _mm_loadu_si128(SHA256_K.as_ptr().add(4 * i) as *const __m128i);
+            let wk = _mm_add_epi32(w[i % 4], k);
+            cdgh = _mm_sha256rnds2_epu32(cdgh, abef, wk);
+            abef = _mm_sha256rnds2_epu32(abef, cdgh, _mm_shuffle_epi32(wk, 0x0e));
+        }
+
+        abef = _mm_add_epi32(abef, abef_saved);
+        cdgh = _mm_add_epi32(cdgh, cdgh_saved);
+    }
+
+    let feba = _mm_shuffle_epi32(abef, 0x1b);
+    let dchg = _mm_shuffle_epi32(cdgh, 0xb1);
+    _mm_storeu_si128(ptr, _mm_blend_epi16(feba, dchg, 0xf0));
+    _mm_storeu_si128(ptr.add(1), _mm_alignr_epi8(dchg, feba, 8));
+}
+
+/// Four SHA-1 rounds starting at round `4 * $i`, with the round function
+/// of that group. `$i` is a literal so the schedule indices and the
+/// `sha1rnds4` immediate are constants.
+///
+/// `$h0` and `$h1` alternate between the current ABCD and the one from
+/// four rounds earlier, whose rotated A is the next E.
+macro_rules! sha1_step {
+    ($w:ident, $h0:ident, $h1:ident, $i:literal, $f:literal) => {
+        if $i >= 4 {
+            let t = _mm_xor_si128(
+                _mm_sha1msg1_epu32($w[$i % 4], $w[($i + 1) % 4]),
+                $w[($i + 2) % 4],
+            );
+            $w[$i % 4] = _mm_sha1msg2_epu32(t, $w[($i + 3) % 4]);
+        }
+        if $i % 2 == 1 {
+            $h0 = _mm_sha1rnds4_epu32($h1, _mm_sha1nexte_epu32($h0, $w[$i % 4]), $f);
+        } else {
+            $h1 = _mm_sha1rnds4_epu32($h0, _mm_sha1nexte_epu32($h1, $w[$i % 4]), $f);
+        }
+    };
+}
+
+/// SHA-1 compression of whole 64-byte blocks
+///
+/// # Safety
+/// The CPU must support SHA, SSSE3 and SSE4.1.
+#[target_feature(enable = "sha,sse2,ssse3,sse4.1")]
+pub unsafe fn compress1(state: &mut [u32; 5], blocks: &[u8]) {
+    // Whole-register byte reversal: word 0 of the block ends up in the
+    // top lane, where the instructions expect A
+    let mask = _mm_set_epi64x(0x0001_0203_0405_0607, 0x0809_0a0b_0c0d_0e0f);
+    let mut abcd = _mm_set_epi32(
+        state[0] as i32,
+        state[1] as i32,
+        state[2] as i32,
+        state[3] as i32,
+    );
+    let mut e = _mm_set_epi32(state[4] as i32, 0, 0, 0);
+
+    for block in blocks.chunks_exact(64) {
+        let abcd_saved = abcd;
+        let e_saved = e;
+
+        let p = block.as_ptr() as *const __m128i;
+        let mut w = [
+            _mm_shuffle_epi8(_mm_loadu_si128(p), mask),
+            _mm_shuffle_epi8(_mm_loadu_si128(p.add(1)), mask),
+            _mm_shuffle_epi8(_mm_loadu_si128(p.add(2)), mask),
+            _mm_shuffle_epi8(_mm_loadu_si128(p.add(3)), mask),
+        ];
+
+        let mut h0 = abcd;
+        let mut h1 = _mm_sha1rnds4_epu32(h0, _mm_add_epi32(e, w[0]), 0);
+        sha1_step!(w, h0, h1, 1, 0);
+        sha1_step!(w, h0, h1, 2, 0);
+        sha1_step!(w, h0, h1, 3, 0);
+        sha1_step!(w, h0, h1, 4, 0);
+        sha1_step!(w, h0, h1, 5, 1);
+        sha1_step!(w, h0, h1, 6, 1);
+        sha1_step!(w, h0, h1, 7, 1);
+        sha1_step!(w, h0, h1, 8, 1);
+        sha1_step!(w, h0, h1, 9, 1);
+        sha1_step!(w, h0, h1, 10, 2);
+        sha1_step!(w, h0, h1, 11, 2);
+        sha1_step!(w, h0, h1, 12, 2);
+        sha1_step!(w, h0, h1, 13, 2);
+        sha1_step!(w, h0, h1, 14, 2);
+        sha1_step!(w, h0, h1, 15, 3);
+        sha1_step!(w, h0, h1, 16, 3);
+        sha1_step!(w, h0, h1, 17, 3);
+        sha1_step!(w, h0, h1, 18, 3);
+        sha1_step!(w, h0, h1, 19, 3);
+
+        abcd = _mm_add_epi32(h0, abcd_saved);
+        e = _mm_sha1nexte_epu32(h1, e_saved);
+    }
+
+    state[0] = _mm_extract_epi32(abcd, 3) as u32;
+    state[1] = _mm_extract_epi32(abcd, 2) as u32;
+    state[2] = _mm_extract_epi32(abcd, 1) as u32;
+    state[3] = _mm_extract_epi32(abcd, 0) as u32;
+    state[4] = _mm_extract_epi32(e, 3) as u32;
+}
@@ -6,6 +6,7 @@
 //! - **Full QUIC protocol support** (RFC 9000, RFC 9001, RFC 9002)
 //! - **ngtcp2 C ABI compatibility** for drop-in replacement
 //! - **Tokio async backend** for high-performance I/O
+//! - **nevent reactor driver** for many connections on one thread
 //! - **QPACK header compression** (RFC 9204)
 //! - **Connection migration support**
 //! - **0-RTT early data**
@@ -106,6 +107,10 @@ pub mod qpack;
 // Async I/O backend (tokio-based)
 pub mod async_io;
 
+// Event-loop driver (nevent epoll reactor)
+#[cfg(feature = "reactor")]
+pub mod reactor;
+
 // ngtcp2 C ABI compatibility layer
 pub mod compat;
 
@@ -0,0 +1,311 @@
+//! nevent driver for QUIC endpoints
+//!
+//! A [`QuicEndpoint`] owns one non-blocking UDP socket and every connection
+//! reached through it. It runs on a shared [`Reactor`] next to any number of
+//! other endpoints and HTTP/2 connections:
+//!
+//! - Datagrams are read until the socket is empty. Each one goes to the
+//!   connection for its source address. On a server, the accept hook may
+//!   create a connection for an unknown address.
+//! - After a connection has read or timed out, the packets it has ready go
+//!   out at once, a bounded burst per connection. If the socket backs up,
+//!   the unsent datagram is kept and the endpoint waits for writability.
+//! - Each connection has at most one reactor timer, set from
+//!   `Connection::get_expiry` and moved whenever that changes.
+//!
+//! Timestamps passed to the connections are `nevent::monotonic_ns`.
+//!
+//! ```rust,ignore
+//! use nevent::Reactor;
+//! use ntcp2::reactor::QuicEndpoint;
+//!
+//! let mut reactor = Reactor::new()?;
+//! let mut endpoint = QuicEndpoint::bind("0.0.0.0:0")?;
+//! endpoint.add_connection(server_addr, conn);
+//! endpoint.register(&mut reactor)?;
+//! reactor.run()?;
+//! ```
+
+use std::collections::{HashMap, VecDeque};
+use std::io;
+use std::net::{self, ToSocketAddrs, UdpSocket};
+use std::os::fd::AsRawFd;
+
+use nevent::{Context, Interest, Reactor, Ready, Source, TimerId, Token};
+
+use crate::connection::Connection;
+use crate::types::{PacketInfo, Path, SocketAddr};
+use crate::{Timestamp, NGTCP2_TSTAMP_MAX};
+
+/// Largest UDP payload we receive
+const MAX_DATAGRAM: usize = 65527;
+
+/// Largest packet a connection may write in one call
+const MAX_PACKET: usize = 1500;
+
+/// Datagrams read per readiness event
+const MAX_RECV_PER_EVENT: usize = 64;
+
+/// Packets one connection may send per flush
+const MAX_BURST: usize = 16;
+
+/// Delay before retrying an expiry the connection did not clear (1ms)
+const TIMER_RETRY: Timestamp = 1_000_000;
+
+/// Makes the server side connection for a datagram from an unknown peer
+pub type AcceptFn = Box<dyn FnMut(&Path, &[u8]) -> Option<Box<Connection>>>;
+
+/// Address family constants as the ngtcp2 ABI uses them
+const AF_INET: u16 = 2;
+const AF_INET6: u16 = 10;
+
+/// ngtcp2 form of a standard socket address
+pub fn to_ngtcp2_addr(addr: &net::SocketAddr) -> SocketAddr {
+    let mut out = SocketAddr {
+        port: addr.port().to_be(),
+        ..SocketAddr::default()
+    };
+    match addr {
+        net::SocketAddr::V4(v4) => {
+            out.family = AF_INET;
+            out.addr[..4].copy_from_slice(&v4.ip().octets());
+            out.addrlen = 16;
+        }
+        net::SocketAddr::V6(v6) => {
+            out.family = AF_INET6;
+            out.addr = v6.ip().octets();
+            out.addrlen = 28;
+        }
+    }
+    out
+}
+
+struct Peer {
+    conn: Box<Connection>,
+    path: Path,
+    timer: Option<TimerId>,
+    /// Expiry the timer was set for
+    deadline: Timestamp,
+}
+
+/// One UDP socket and the QUIC connections multiplexed over it
+pub struct QuicEndpoint {
+    socket: UdpSocket,
+    local: SocketAddr,
+    peers: HashMap<net::SocketAddr, Peer>,
+    timers: HashMap<TimerId, net::SocketAddr>,
+    accept: Option<AcceptFn>,
+    recv_buf: Box<[u8]>,
+    send_buf: Box<[u8]>,
+    /// Datagrams the socket refused, sent before anything new
+    blocked: VecDeque<(net::SocketAddr, Vec<u8>)>,
+}
+
+impl QuicEndpoint {
+    /// Use `socket` (switched to non-blocking)
+    pub fn new(socket: UdpSocket) -> io::Result<Self> {
+        socket.set_nonblocking(true)?;
+        let local = to_ngtcp2_addr(&socket.local_addr()?);
+        Ok(Self {
+            socket,
+            local,
+            peers: HashMap::new(),
+            timers: HashMap::new(),
+            accept: None,
+            recv_buf: vec![0u8; MAX_DATAGRAM].into_boxed_slice(),
+            send_buf: vec![0u8; MAX_PACKET].into_boxed_slice(),
+            blocked: VecDeque::new(),
+        })
+    }
+
+    pub fn bind<A: ToSocketAddrs>(addr: A) -> io::Result<Self> {
+        Self::new(UdpSocket::bind(addr)?)
+    }
+
+    /// Accept connections: `accept` gets the path and first datagram from
+    /// each unknown address and may return a server connection for it
+    pub fn accept_with(mut self, accept: AcceptFn) -> Self {
+        self.accept = Some(accept);
+        self
+    }
+
+    /// Path from this socket to `remote`
+    pub fn path_to(&self, remote: &net::SocketAddr) -> Path {
+        Path {
+            local: self.local,
+            remote: to_ngtcp2_addr(remote),
+            ..Path::default()
+        }
+    }
+
+    /// Drive `conn` (typically a new client connection) to `remote`; its
+    /// first flight goes out on the first turn after registration
+    pub fn add_connection(&mut self, remote: net::SocketAddr, conn: Box<Connection>) {
+        let path = self.path_to(&remote);
+        self.peers.insert(
+            remote,
+            Peer {
+                conn,
+                path,
+                timer: None,
+                deadline: NGTCP2_TSTAMP_MAX,
+            },
+        );
+    }
+
+    /// Number of live connections
+    pub fn connections(&self) -> usize {
+        self.peers.len()
+    }
+
+    pub fn register(self, reactor: &mut Reactor) -> io::Result<Token> {
+        let fd = self.socket.as_raw_fd();
+        let has_peers = !self.peers.is_empty();
+        let token = reactor.register(fd, Interest::READABLE, Box::new(self))?;
+        if has_peers {
+            reactor.schedule(token);
+        }
+        Ok(token)
+    }
+
+    fn receive(&mut self, cx: &mut Context<'_>) {
+        for _ in 0..MAX_RECV_PER_EVENT {
+            let (len, from) = match self.socket.recv_from(&mut self.recv_buf) {
+                Ok(received) => received,
+                Err(e) if e.kind() == io::ErrorKind::Interrupted => continue,
+                Err(_) => break,
+            };
+            let ts = cx.now();
+
+            if !self.peers.contains_key(&from) {
+                let path = self.path_to(&from);
+                let Some(accept) = self.accept.as_mut() else {
+                    continue;
+                };
+                let Some(conn) = accept(&path, &self.recv_buf[..len]) else {
+                    continue;
+                };
+                self.peers.insert(
+                    from,
+                    Peer {
+                        conn,
+                        path,
+                        timer: None,
+                        deadline: NGTCP2_TSTAMP_MAX,
+                    },
+                );
+            }
+
+            let peer = self.peers.get_mut(&from).expect("peer just looked up");
+            let pi = PacketInfo::default();
+            // Undecryptable or stray packets are dropped; a fatal error
+            // shows up as a closed connection in flush_peer
+            let _ = peer
+                .conn
+                .read_pkt(&peer.path, &pi, &self.recv_buf[..len], ts);
+            self.flush_peer(cx, from);
+        }
+    }
+
+    /// Send what `remote`'s connection has ready, then re-arm its timer
+    /// (or drop it if the connection is over)
+    fn flush_peer(&mut self, cx: &mut Context<'_>, remote: net::SocketAddr) {
+        let Some(peer) = self.peers.get_mut(&remote) else {
+            return;
+        };
+
+        if self.blocked.is_empty() {
+            let mut pi = PacketInfo::default();
+            for _ in 0..MAX_BURST {
+                let n =
+                    match peer
+                        .conn
+                        .write_pkt(&mut peer.path, &mut pi, &mut self.send_buf, cx.now())
+                    {
+                        Ok(n) if n > 0 => n as usize,
+                        _ => break,
+                    };
+                let datagram = &self.send_buf[..n];
+                match self.socket.send_to(datagram, remote) {
+                    Ok(_) => {}
+                    Err(e) if e.kind() == io::ErrorKind::WouldBlock => {
+                        self.blocked.push_back((remote, datagram.to_vec()));
+                        let _ = cx.set_interest(Interest::BOTH);
+                        break;
+                    }
+                    // Unreachable peers etc.: loss recovery deals with it
+                    Err(_) => {}
+                }
+            }
+        }
+
+        if peer.conn.is_closed() || peer.conn.is_draining() {
+            if let Some(timer) = peer.timer.take() {
+                cx.cancel_timer(timer);
+                self.timers.remove(&timer);
+            }
+            self.peers.remove(&remote);
+            return;
+        }
+
+        let expiry = peer.conn.get_expiry();
+        if expiry == peer.deadline && peer.timer.is_some() {
+            return;
+        }
+        if let Some(timer) = peer.timer.take() {
+            cx.cancel_timer(timer);
+            self.timers.remove(&timer);
+        }
+        peer.deadline = expiry;
+        if expiry != NGTCP2_TSTAMP_MAX {
+            // An expiry already past is retried a tick later, not spun on
+            let timer = cx.set_timer(expiry.max(cx.now() + TIMER_RETRY));
+            peer.timer = Some(timer);
+            self.timers.insert(timer, remote);
+        }
+    }
+
+    /// Retry refused datagrams; true once none are left
+    fn drain_blocked(&mut self) -> bool {
+        while let Some((remote, datagram)) = self.blocked.front() {
+            match self.socket.send_to(datagram, *remote) {
+                Err(e) if e.kind() == io::ErrorKind::WouldBlock => return false,
+                _ => {
+                    self.blocked.pop_front();
+                }
+            }
+        }
+        true
+    }
+}
+
+impl Source for QuicEndpoint {
+    fn on_ready(&mut self, cx: &mut Context<'_>, ready: Ready) {
+        if ready.is_writable() || ready.is_scheduled() {
+            if !self.drain_blocked() {
+                return;
+            }
+            let _ = cx.set_interest(Interest::READABLE);
+            let remotes: Vec<net::SocketAddr> = self.peers.keys().copied().collect();
+            for remote in remotes {
+                self.flush_peer(cx, remote);
+            }
+        }
+        if ready.is_readable() || ready.is_error() {
+            // Errors on UDP sockets are per datagram (ICMP); reading clears them
+            self.receive(cx);
+        }
+    }
+
+    fn on_timer(&mut self, cx: &mut Context<'_>, timer: TimerId) {
+        let Some(remote) = self.timers.remove(&timer) else {
+            return;
+        };
+        let Some(peer) = self.peers.get_mut(&remote) else {
+            return;
+        };
+        peer.timer = None;
+        let _ = peer.conn.handle_expiry(cx.now());
+        self.flush_peer(cx, remote);
+    }
+}
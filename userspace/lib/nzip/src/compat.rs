@@ -292,7 +292,13 @@ impl InflateState {
     /// Perform inflate operation
     pub fn inflate(&mut self, strm: &mut z_stream, _flush: c_int) -> c_int {
         if self.finished {
-            return Z_STREAM_END;
+            // Hand out what the last call had no room for
+            self.write_output(strm);
+            return if self.output_buffer.is_empty() {
+                Z_STREAM_END
+            } else {
+                Z_OK
+            };
         }
 
         // Read input
@@ -319,7 +325,7 @@ impl InflateState {
 
         // Decompress
         if self.header_state == HeaderState::Deflate && !self.input_buffer.is_empty() {
-            match self.inflater.decompress(&self.input_buffer) {
+            match self.inflater.decompress_stream(&self.input_buffer) {
                 Ok((decompressed, consumed)) => {
                     self.output_buffer.extend_from_slice(&decompressed);
                     self.input_buffer.drain(..consumed);
@@ -340,7 +346,20 @@ impl InflateState {
             }
         }
 
-        // Write output
+        self.write_output(strm);
+
+        // Update adler
+        strm.adler = self.inflater.checksum() as uLong;
+
+        if self.finished && self.output_buffer.is_empty() {
+            Z_STREAM_END
+        } else {
+            Z_OK
+        }
+    }
+
+    /// Copy as much pending output as fits into the caller's buffer
+    fn write_output(&mut self, strm: &mut z_stream) {
         unsafe {
             if !strm.next_out.is_null() && strm.avail_out > 0 && !self.output_buffer.is_empty() {
                 let to_write = core::cmp::min(self.output_buffer.len(), strm.avail_out as usize);
@@ -355,17 +374,6 @@ impl InflateState {
                 self.output_buffer.drain(..to_write);
             }
         }
-
-        // Update adler
-        strm.adler = self.inflater.checksum() as uLong;
-
-        if self.finished {
-            Z_STREAM_END
-        } else if self.output_buffer.is_empty() && self.input_buffer.is_empty() {
-            Z_OK
-        } else {
-            Z_OK
-        }
     }
 
     /// Process header based on window_bits
@@ -402,14 +402,15 @@ impl GzipDecompressor {
 
         // Parse header if not yet done
         if self.header.is_none() {
+            // Header bytes held back from earlier calls
+            let buffered = self.header_buffer.len();
             self.header_buffer.extend_from_slice(input);
 
             match GzipHeader::decode(&self.header_buffer) {
                 Ok((header, consumed)) => {
                     self.header = Some(header);
-                    let remaining = self.header_buffer[consumed..].to_vec();
-                    self.header_buffer = remaining;
-                    pos = consumed.saturating_sub(input.len() - self.header_buffer.len());
+                    self.header_buffer.clear();
+                    pos = consumed - buffered;
                 }
                 Err(ZlibError::UnexpectedEof) => {
                     return Ok((Vec::new(), input.len()));
@@ -419,19 +420,7 @@ impl GzipDecompressor {
         }
 
         // Decompress
-        let (decompressed, consumed) = if !self.header_buffer.is_empty() {
-            let combined: Vec<u8> = self
-                .header_buffer
-                .iter()
-                .chain(input[pos..].iter())
-                .copied()
-                .collect();
-            let result = self.inflater.decompress(&combined)?;
-            self.header_buffer.clear();
-            (result.0, result.1.saturating_sub(self.header_buffer.len()))
-        } else {
-            self.inflater.decompress(&input[pos..])?
-        };
+        let (decompressed, consumed) = self.inflater.decompress(&input[pos..])?;
 
         // Update checksum and size
         self.crc.update(&decompressed);
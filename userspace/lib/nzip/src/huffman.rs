@@ -111,6 +111,8 @@ impl HuffmanTable {
             }
             bl_count[len as usize] += 1;
         }
+        // Unused symbols (length 0) take no code space
+        bl_count[0] = 0;
 
         // Find the maximum code length actually used
         let mut max_len = MAX_BITS;
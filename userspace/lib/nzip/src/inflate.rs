@@ -42,6 +42,10 @@ pub struct Inflater {
 
     /// Checksum calculator
     checksum: Adler32,
+
+    /// Window as it was at the start of the current block, for rolling a
+    /// block back in streaming mode (allocated on first use)
+    saved_window: Vec<u8>,
 }
 
 impl Inflater {
@@ -62,6 +66,7 @@ impl Inflater {
             litlen_table: HuffmanTable::new(),
             dist_table: HuffmanTable::new(),
             checksum: Adler32::new(),
+            saved_window: Vec::new(),
         }
     }
 
@@ -84,60 +89,138 @@ impl Inflater {
         let mut input_pos = 0;
 
         while !self.finished && input_pos < input.len() {
-            // Read block header if needed
-            if !self.final_block {
-                // Need at least 3 bits for block header
-                while self.bit_count < 3 && input_pos < input.len() {
-                    self.bit_buffer |= (input[input_pos] as u32) << self.bit_count;
-                    self.bit_count += 8;
-                    input_pos += 1;
-                }
+            if !self.inflate_block(input, &mut input_pos, &mut output)? {
+                break; // Need more input
+            }
+        }
 
-                if self.bit_count < 3 {
-                    break; // Need more input
-                }
+        if self.finished {
+            self.give_back(&mut input_pos);
+        }
 
-                // Read BFINAL and BTYPE
-                let header = self.bit_buffer & 0x7;
-                self.bit_buffer >>= 3;
-                self.bit_count -= 3;
+        // Update checksum
+        self.checksum.update(&output);
 
-                self.final_block = (header & 1) != 0;
-                let btype = (header >> 1) & 3;
+        Ok((output, input_pos))
+    }
 
-                match btype {
-                    0 => {
-                        // Stored block
-                        self.inflate_stored(input, &mut input_pos, &mut output)?;
-                    }
-                    1 => {
-                        // Fixed Huffman
-                        self.setup_fixed_huffman()?;
-                        self.inflate_huffman(input, &mut input_pos, &mut output)?;
-                    }
-                    2 => {
-                        // Dynamic Huffman
-                        self.read_dynamic_huffman(input, &mut input_pos)?;
-                        self.inflate_huffman(input, &mut input_pos, &mut output)?;
-                    }
-                    3 => {
-                        return Err(ZlibError::DataError); // Reserved
-                    }
-                    _ => unreachable!(),
-                }
+    /// Decompress the complete blocks in `input`, for data arriving in pieces
+    ///
+    /// Unlike [`decompress`](Self::decompress), running out of input inside
+    /// a block is not an error: the block is rolled back and the consumed
+    /// count stops at its start, so the caller can retry with more input.
+    pub fn decompress_stream(&mut self, input: &[u8]) -> ZlibResult<(Vec<u8>, usize)> {
+        let mut output = Vec::new();
+        let mut input_pos = 0;
+
+        if self.saved_window.len() != self.window.len() {
+            self.saved_window = vec![0; self.window.len()];
+        }
 
-                if self.final_block {
-                    self.finished = true;
+        // Buffered bits may hold a whole (short) block
+        while !self.finished && (input_pos < input.len() || self.bit_count >= 3) {
+            let mark = (
+                input_pos,
+                output.len(),
+                self.bit_buffer,
+                self.bit_count,
+                self.window_pos,
+                self.window_len,
+            );
+            self.saved_window.copy_from_slice(&self.window);
+
+            match self.inflate_block(input, &mut input_pos, &mut output) {
+                Ok(true) => {}
+                Ok(false) => break,
+                Err(ZlibError::UnexpectedEof) => {
+                    input_pos = mark.0;
+                    output.truncate(mark.1);
+                    self.bit_buffer = mark.2;
+                    self.bit_count = mark.3;
+                    self.window_pos = mark.4;
+                    self.window_len = mark.5;
+                    self.window.copy_from_slice(&self.saved_window);
+                    self.final_block = false;
+                    break;
                 }
+                Err(e) => return Err(e),
             }
         }
 
-        // Update checksum
+        if self.finished {
+            self.give_back(&mut input_pos);
+        }
+
         self.checksum.update(&output);
 
         Ok((output, input_pos))
     }
 
+    /// Decode one block; false if its header is not complete yet
+    fn inflate_block(
+        &mut self,
+        input: &[u8],
+        input_pos: &mut usize,
+        output: &mut Vec<u8>,
+    ) -> ZlibResult<bool> {
+        // Need at least 3 bits for block header
+        while self.bit_count < 3 && *input_pos < input.len() {
+            self.bit_buffer |= (input[*input_pos] as u32) << self.bit_count;
+            self.bit_count += 8;
+            *input_pos += 1;
+        }
+
+        if self.bit_count < 3 {
+            return Ok(false);
+        }
+
+        // Read BFINAL and BTYPE
+        let header = self.bit_buffer & 0x7;
+        self.bit_buffer >>= 3;
+        self.bit_count -= 3;
+
+        self.final_block = (header & 1) != 0;
+        let btype = (header >> 1) & 3;
+
+        match btype {
+            0 => {
+                // Stored block
+                self.inflate_stored(input, input_pos, output)?;
+            }
+            1 => {
+                // Fixed Huffman
+                self.setup_fixed_huffman()?;
+                self.inflate_huffman(input, input_pos, output)?;
+            }
+            2 => {
+                // Dynamic Huffman
+                self.read_dynamic_huffman(input, input_pos)?;
+                self.inflate_huffman(input, input_pos, output)?;
+            }
+            3 => {
+                return Err(ZlibError::DataError); // Reserved
+            }
+            _ => unreachable!(),
+        }
+
+        if self.final_block {
+            self.finished = true;
+        }
+
+        Ok(true)
+    }
+
+    /// Return whole bytes the bit buffer read past the end of the stream
+    ///
+    /// Decoding reads ahead up to MAX_BITS, which at the final block runs
+    /// into the zlib/gzip trailer; those bytes belong to the caller.
+    fn give_back(&mut self, input_pos: &mut usize) {
+        let unused = (self.bit_count / 8) as usize;
+        *input_pos = input_pos.saturating_sub(unused);
+        self.bit_buffer = 0;
+        self.bit_count = 0;
+    }
+
     /// Inflate a stored (uncompressed) block
     fn inflate_stored(
         &mut self,
@@ -230,11 +313,13 @@ impl Inflater {
         let mut i = 0;
 
         while i < lengths.len() {
-            self.fill_bits(input, pos, MAX_BITS as u8)?;
-
-            let (sym, bits) = codelen_table.decode(self.bit_buffer);
-            self.bit_buffer >>= bits;
-            self.bit_count -= bits;
+            let sym = Self::decode_symbol(
+                &codelen_table,
+                &mut self.bit_buffer,
+                &mut self.bit_count,
+                input,
+                pos,
+            )?;
 
             match sym {
                 0..=15 => {
@@ -314,14 +399,13 @@ impl Inflater {
         output: &mut Vec<u8>,
     ) -> ZlibResult<()> {
         loop {
-            self.fill_bits(input, pos, MAX_BITS as u8)?;
-
-            let (sym, bits) = self.litlen_table.decode(self.bit_buffer);
-            if bits == 0 {
-                return Err(ZlibError::DataError);
-            }
-            self.bit_buffer >>= bits;
-            self.bit_count -= bits;
+            let sym = Self::decode_symbol(
+                &self.litlen_table,
+                &mut self.bit_buffer,
+                &mut self.bit_count,
+                input,
+                pos,
+            )?;
 
             if sym < 256 {
                 // Literal byte
@@ -348,14 +432,13 @@ impl Inflater {
                 }
 
                 // Read distance
-                self.fill_bits(input, pos, MAX_BITS as u8)?;
-
-                let (dist_sym, dist_bits) = self.dist_table.decode(self.bit_buffer);
-                if dist_bits == 0 {
-                    return Err(ZlibError::DataError);
-                }
-                self.bit_buffer >>= dist_bits;
-                self.bit_count -= dist_bits;
+                let dist_sym = Self::decode_symbol(
+                    &self.dist_table,
+                    &mut self.bit_buffer,
+                    &mut self.bit_count,
+                    input,
+                    pos,
+                )?;
 
                 let dist_idx = dist_sym as usize;
                 if dist_idx >= DIST_BASE.len() {
@@ -380,6 +463,36 @@ impl Inflater {
         Ok(())
     }
 
+    /// Decode one Huffman symbol
+    ///
+    /// Looks ahead up to MAX_BITS but only requires as many bits as the
+    /// decoded code is long, so a short final code right at the end of the
+    /// input still decodes.
+    fn decode_symbol(
+        table: &HuffmanTable,
+        bit_buffer: &mut u32,
+        bit_count: &mut u8,
+        input: &[u8],
+        pos: &mut usize,
+    ) -> ZlibResult<u16> {
+        while *bit_count < MAX_BITS as u8 && *pos < input.len() {
+            *bit_buffer |= (input[*pos] as u32) << *bit_count;
+            *bit_count += 8;
+            *pos += 1;
+        }
+
+        let (sym, bits) = table.decode(*bit_buffer);
+        if bits > *bit_count || (bits == 0 && *bit_count < MAX_BITS as u8) {
+            return Err(ZlibError::UnexpectedEof);
+        }
+        if bits == 0 {
+            return Err(ZlibError::DataError);
+        }
+        *bit_buffer >>= bits;
+        *bit_count -= bits;
+        Ok(sym)
+    }
+
     /// Fill bit buffer with at least `needed` bits
     fn fill_bits(&mut self, input: &[u8], pos: &mut usize, needed: u8) -> ZlibResult<()> {
         while self.bit_count < needed && *pos < input.len() {
@@ -226,3 +226,86 @@ fn test_deflate_reset() {
 
     unsafe { deflateEnd(&mut strm) };
 }
+
+/// Dynamic-Huffman zlib stream of `zlib_sample_input()`, produced by zlib at level 9
+const ZLIB_SAMPLE: &[u8] = &[
+    0x78, 0xda, 0x9d, 0xd5, 0x5b, 0x16, 0xc1, 0x50, 0x0c, 0x46, 0xe1, 0x77, 0xa3, 0xc8, 0x10, 0xe4,
+    0x0f, 0x2d, 0x66, 0xe3, 0x72, 0x68, 0x39, 0x7a, 0x68, 0xd5, 0x6d, 0xf4, 0x16, 0x33, 0xb0, 0x9f,
+    0xb3, 0xf6, 0x53, 0xbe, 0x95, 0xe4, 0xb6, 0x4b, 0x36, 0x5d, 0xd9, 0xad, 0x49, 0x76, 0x1d, 0xdb,
+    0xed, 0xc9, 0x36, 0x7d, 0x79, 0x74, 0xb6, 0x2f, 0x4f, 0x3b, 0x8e, 0xe7, 0xcb, 0x60, 0xe5, 0x9e,
+    0xfa, 0xdf, 0x38, 0xaf, 0xdf, 0x2f, 0xdb, 0x95, 0xc3, 0x24, 0x7f, 0x1b, 0x07, 0x8d, 0x40, 0x13,
+    0xa0, 0x99, 0x81, 0x66, 0x0e, 0x9a, 0x0a, 0x34, 0x35, 0x68, 0x16, 0xa0, 0x59, 0x92, 0x9d, 0x22,
+    0x08, 0x44, 0x82, 0x13, 0x0a, 0x4e, 0x2c, 0x38, 0xc1, 0xe0, 0x44, 0x83, 0x13, 0x0e, 0x4e, 0x3c,
+    0x38, 0x01, 0xe1, 0x44, 0x84, 0x88, 0x08, 0xa1, 0xdb, 0x40, 0x44, 0x88, 0x88, 0x10, 0x11, 0x21,
+    0x22, 0x42, 0x44, 0x84, 0x88, 0x08, 0x11, 0x11, 0x22, 0x22, 0x82, 0x88, 0x08, 0x22, 0x22, 0xd0,
+    0xbb, 0x20, 0x22, 0x82, 0x88, 0x08, 0x22, 0x22, 0x88, 0x88, 0x20, 0x22, 0x82, 0x88, 0x88, 0x3f,
+    0x45, 0x7c, 0x00, 0xd5, 0x99, 0xe3, 0xf7,
+];
+
+fn zlib_sample_input() -> Vec<u8> {
+    (0..40)
+        .flat_map(|i| {
+            format!("line {}: the quick brown fox jumps over the lazy dog\n", i).into_bytes()
+        })
+        .collect()
+}
+
+#[test]
+fn test_inflate_byte_at_a_time() {
+    let expected = zlib_sample_input();
+
+    let mut strm: z_stream = unsafe { core::mem::zeroed() };
+    let ret = unsafe {
+        inflateInit_(
+            &mut strm,
+            ZLIB_VERSION.as_ptr() as *const i8,
+            core::mem::size_of::<z_stream>() as i32,
+        )
+    };
+    assert_eq!(ret, Z_OK);
+
+    // One input byte per call and a small output buffer: blocks are split
+    // at every possible point and finished output has to be drained
+    let mut output = Vec::new();
+    let mut buf = [0u8; 64];
+    let mut ret = Z_OK;
+    for byte in ZLIB_SAMPLE {
+        strm.next_in = byte;
+        strm.avail_in = 1;
+        loop {
+            strm.next_out = buf.as_mut_ptr();
+            strm.avail_out = buf.len() as u32;
+            ret = unsafe { inflate(&mut strm, Z_NO_FLUSH) };
+            assert!(ret == Z_OK || ret == Z_STREAM_END);
+            let n = buf.len() - strm.avail_out as usize;
+            output.extend_from_slice(&buf[..n]);
+            if n < buf.len() {
+                break;
+            }
+        }
+    }
+
+    unsafe { inflateEnd(&mut strm) };
+
+    assert_eq!(ret, Z_STREAM_END);
+    assert_eq!(output, expected);
+}
+
+#[test]
+fn test_uncompress_huffman_stream() {
+    let expected = zlib_sample_input();
+
+    let mut output = vec![0u8; expected.len()];
+    let mut output_len = output.len() as u64;
+    let ret = unsafe {
+        uncompress(
+            output.as_mut_ptr(),
+            &mut output_len,
+            ZLIB_SAMPLE.as_ptr(),
+            ZLIB_SAMPLE.len() as u64,
+        )
+    };
+
+    assert_eq!(ret, Z_OK);
+    assert_eq!(&output[..output_len as usize], &expected[..]);
+}
@@ -60,12 +60,29 @@ pub extern "C" fn __nexa_get_start_c_addr() -> usize {
     unsafe { _start_c as usize }
 }
 
+/// Auxiliary vector of the initial stack (argc, argv..NULL, envp..NULL, auxv)
+unsafe fn auxv_from_stack(stack_ptr: *const usize) -> *const u64 {
+    if stack_ptr.is_null() {
+        return core::ptr::null();
+    }
+    let argc = *stack_ptr;
+    let mut p = stack_ptr.add(argc + 2);
+    while *p != 0 {
+        p = p.add(1);
+    }
+    p.add(1) as *const u64
+}
+
 /// Decode argc/argv/envp from the preserved userspace stack and invoke `main`.
 #[no_mangle]
 unsafe extern "C" fn __nexa_crt_start(stack_ptr: *const usize) -> ! {
     // Initialize TLS for main thread FIRST, before anything else
-    // This is critical for proper std support
-    crate::libc_compat::pthread::__nrlib_init_main_thread_tls();
+    // This is critical for proper std support. The auxiliary vector (after
+    // argv and envp) locates a static program's PT_TLS segment.
+    crate::libc_compat::pthread::init_main_thread(auxv_from_stack(stack_ptr));
+
+    // Pick the mem*/str* implementations for this CPU
+    crate::memops::init_cpu_features();
 
     // Force export of libc symbols for tokio/mio/std (prevents dead code elimination)
     // Use volatile read/write to ensure this isn't optimized away
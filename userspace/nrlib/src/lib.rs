@@ -12,7 +12,6 @@ extern crate std;
 
 use core::{
     arch::asm,
-    cmp,
     ffi::c_void,
     mem, ptr, slice,
     sync::atomic::{AtomicBool, AtomicUsize, Ordering},
@@ -92,12 +91,20 @@ pub extern "C" fn __nrlib_force_export_symbols() -> usize {
 // C Runtime support for std programs
 pub mod crt;
 
+// Thread-caching allocator behind malloc/free
+mod malloc;
+
+// Vectorized mem*/str* primitives behind the C entry points
+pub mod memops;
+
 // libc compatibility layer for std support
 pub mod libc_compat;
 // Minimal stdio support (unbuffered) implemented in stdio.rs
 pub mod stdio;
 // Timekeeping utilities for libc compatibility functions
 pub mod time;
+// Userspace CRNG backing getrandom()
+pub mod random;
 
 // DNS and resolver modules
 pub mod dns;
@@ -199,6 +206,7 @@ const SYS_MMAP: u64 = 9;
 const SYS_MPROTECT: u64 = 10;
 const SYS_MUNMAP: u64 = 11;
 const SYS_BRK: u64 = 12;
+const SYS_MADVISE: u64 = 28;
 
 // Vectored and positioned I/O (Linux-compatible)
 const SYS_PREAD64: u64 = 17;
@@ -658,7 +666,8 @@ pub fn uefi_map_usb_mmio(index: usize) -> *mut c_void {
     }
 }
 
-// errno support (global for now, single-process environment)
+// errno support: each thread's lives in its TCB; this one serves startup
+// code that runs before the main thread's TCB is installed
 static mut ERRNO: i32 = 0;
 
 // Environment variables support (empty for now)
@@ -808,16 +817,29 @@ fn debug_log_write_end(ctx: DebugWriteContext, ret: isize) {
     DEBUG_WRITE_LOGGING.store(false, Ordering::Release);
 }
 
+/// The calling thread's errno slot
+#[inline(always)]
+fn errno_ptr() -> *mut i32 {
+    unsafe {
+        if libc_compat::pthread::tls_ready() {
+            if let Some(tcb) = libc_compat::pthread::get_current_tcb() {
+                return libc_compat::pthread::errno_location(tcb);
+            }
+        }
+        ptr::addr_of_mut!(ERRNO)
+    }
+}
+
 #[inline(always)]
 pub fn set_errno(value: i32) {
     unsafe {
-        ERRNO = value;
+        *errno_ptr() = value;
     }
 }
 
 #[inline(always)]
 pub fn get_errno() -> i32 {
-    unsafe { ERRNO }
+    unsafe { *errno_ptr() }
 }
 
 #[inline(always)]
@@ -845,7 +867,7 @@ pub(crate) fn translate_ret_i32(ret: u64) -> i32 {
 
 #[no_mangle]
 pub extern "C" fn __errno_location() -> *mut i32 {
-    unsafe { &mut ERRNO }
+    errno_ptr()
 }
 
 #[no_mangle]
@@ -971,7 +993,12 @@ fn dup2_impl(oldfd: i32, newfd: i32) -> i32 {
 
 #[no_mangle]
 pub extern "C" fn fork() -> i32 {
-    translate_ret_i32(syscall0(SYS_FORK))
+    let ret = translate_ret_i32(syscall0(SYS_FORK));
+    if ret == 0 {
+        // The child must not replay the parent's random stream
+        random::forget_after_fork();
+    }
+    ret
 }
 
 #[no_mangle]
@@ -1078,6 +1105,7 @@ pub extern "C" fn _exit(code: i32) -> ! {
 
 #[no_mangle]
 pub extern "C" fn exit(code: i32) -> ! {
+    stdio::flush_all();
     _exit(code)
 }
 
@@ -1181,85 +1209,26 @@ pub mod os {
 
 #[no_mangle]
 pub unsafe extern "C" fn memcpy(dest: *mut c_void, src: *const c_void, n: usize) -> *mut c_void {
-    let dest = dest as *mut u8;
-    let src = src as *const u8;
-
-    if n == 0 || (dest as *const u8) == src {
-        return dest as *mut c_void;
-    }
-
-    let mut offset = 0usize;
-    while offset < n {
-        let byte = ptr::read_volatile(src.add(offset));
-        ptr::write_volatile(dest.add(offset), byte);
-        offset += 1;
-    }
-    dest as *mut c_void
+    memops::memcpy(dest as *mut u8, src as *const u8, n);
+    dest
 }
 
 #[no_mangle]
 pub unsafe extern "C" fn memmove(dest: *mut c_void, src: *const c_void, n: usize) -> *mut c_void {
-    let dest = dest as *mut u8;
-    let src = src as *const u8;
-
-    if n == 0 || (dest as *const u8) == src {
-        return dest as *mut c_void;
-    }
-
-    let dest_addr = dest as usize;
-    let src_addr = src as usize;
-
-    if dest_addr < src_addr || dest_addr >= src_addr.saturating_add(n) {
-        let mut offset = 0usize;
-        while offset < n {
-            let byte = ptr::read_volatile(src.add(offset));
-            ptr::write_volatile(dest.add(offset), byte);
-            offset += 1;
-        }
-    } else {
-        let mut offset = n;
-        while offset > 0 {
-            offset -= 1;
-            let byte = ptr::read_volatile(src.add(offset));
-            ptr::write_volatile(dest.add(offset), byte);
-        }
-    }
-    dest as *mut c_void
+    memops::memmove(dest as *mut u8, src as *const u8, n);
+    dest
 }
 
 #[no_mangle]
 pub unsafe extern "C" fn memset(s: *mut c_void, c: i32, n: usize) -> *mut c_void {
-    let s = s as *mut u8;
-
-    if n == 0 {
-        return s as *mut c_void;
-    }
-
-    let value = c as u8;
-    let mut offset = 0usize;
-    while offset < n {
-        ptr::write_volatile(s.add(offset), value);
-        offset += 1;
-    }
-    s as *mut c_void
+    memops::memset(s as *mut u8, c as u8, n);
+    s
 }
 
 #[no_mangle]
 #[inline(never)]
 pub unsafe extern "C" fn memcmp(a: *const c_void, b: *const c_void, n: usize) -> i32 {
-    let a = a as *const u8;
-    let b = b as *const u8;
-
-    let mut i = 0usize;
-    while i < n {
-        let va = ptr::read_volatile(a.add(i));
-        let vb = ptr::read_volatile(b.add(i));
-        if va != vb {
-            return (va as i32) - (vb as i32);
-        }
-        i += 1;
-    }
-    0
+    memops::memcmp(a as *const u8, b as *const u8, n)
 }
 
 /// BSD-compatible byte comparison function.
@@ -1316,15 +1285,7 @@ pub extern "C" fn __nrlib_force_mem_link() {
 #[no_mangle]
 #[inline(never)]
 pub extern "C" fn strlen(s: *const u8) -> usize {
-    unsafe {
-        let mut i = 0usize;
-        loop {
-            if ptr::read_volatile(s.add(i)) == 0 {
-                return i;
-            }
-            i += 1;
-        }
-    }
+    unsafe { memops::strlen(s) }
 }
 
 // Minimal abort -> call exit via syscall 60
@@ -1452,548 +1413,155 @@ const MAX_THREAD_ATEXIT: usize = 256;
 struct ThreadAtexitEntry {
     dtor: unsafe extern "C" fn(*mut c_void),
     obj: *mut c_void,
+    /// TCB of the registering thread (0 before TLS is set up)
+    owner: usize,
     // dso_handle is ignored - we don't support unloading shared libraries with TLS destructors
 }
 
-/// Global list of TLS destructors (simplified - single-threaded for now)
+/// Destructors of every live thread, tagged with their owner
 static mut THREAD_ATEXIT_ENTRIES: [Option<ThreadAtexitEntry>; MAX_THREAD_ATEXIT] =
     [const { None }; MAX_THREAD_ATEXIT];
 static mut THREAD_ATEXIT_COUNT: usize = 0;
+static THREAD_ATEXIT_LOCK: AtomicBool = AtomicBool::new(false);
+
+fn lock_thread_atexit() {
+    while THREAD_ATEXIT_LOCK
+        .compare_exchange(false, true, Ordering::Acquire, Ordering::Relaxed)
+        .is_err()
+    {
+        core::hint::spin_loop();
+    }
+}
+
+fn unlock_thread_atexit() {
+    THREAD_ATEXIT_LOCK.store(false, Ordering::Release);
+}
+
+/// TCB address identifying the calling thread, 0 during early startup
+fn current_thread_id() -> usize {
+    unsafe {
+        if libc_compat::pthread::tls_ready() {
+            if let Some(tcb) = libc_compat::pthread::get_current_tcb() {
+                return tcb as usize;
+            }
+        }
+    }
+    0
+}
 
 /// __cxa_thread_atexit_impl - Register a destructor for a thread-local object
 ///
 /// This is called by Rust's thread_local! macro implementation to register
 /// destructors that will be called when the thread exits.
-///
-/// For single-threaded programs (like most NexaOS userspace programs currently),
-/// we simply store the destructors and call them on program exit.
 #[no_mangle]
 pub unsafe extern "C" fn __cxa_thread_atexit_impl(
     dtor: unsafe extern "C" fn(*mut c_void),
     obj: *mut c_void,
     _dso_handle: *mut c_void,
 ) -> i32 {
-    if THREAD_ATEXIT_COUNT >= MAX_THREAD_ATEXIT {
-        return -1; // No space left
-    }
-
-    THREAD_ATEXIT_ENTRIES[THREAD_ATEXIT_COUNT] = Some(ThreadAtexitEntry { dtor, obj });
-    THREAD_ATEXIT_COUNT += 1;
-    0 // Success
-}
-
-/// Run all registered TLS destructors (called on thread/program exit)
-#[no_mangle]
-pub unsafe extern "C" fn __cxa_thread_atexit_run() {
-    // Run destructors in reverse order (LIFO)
-    while THREAD_ATEXIT_COUNT > 0 {
-        THREAD_ATEXIT_COUNT -= 1;
-        if let Some(entry) = THREAD_ATEXIT_ENTRIES[THREAD_ATEXIT_COUNT].take() {
-            (entry.dtor)(entry.obj);
+    let owner = current_thread_id();
+    lock_thread_atexit();
+    // Reuse a slot freed by an exited thread before growing the list
+    let slot = (0..THREAD_ATEXIT_COUNT)
+        .find(|&i| THREAD_ATEXIT_ENTRIES[i].is_none())
+        .or_else(|| (THREAD_ATEXIT_COUNT < MAX_THREAD_ATEXIT).then_some(THREAD_ATEXIT_COUNT));
+    let ret = match slot {
+        Some(idx) => {
+            THREAD_ATEXIT_ENTRIES[idx] = Some(ThreadAtexitEntry { dtor, obj, owner });
+            if idx == THREAD_ATEXIT_COUNT {
+                THREAD_ATEXIT_COUNT += 1;
+            }
+            0 // Success
         }
-    }
-}
-
-// Allocator support for std::alloc::System ----------------------------------
-// std expects malloc/free/realloc/calloc
-//
-// This allocator uses sbrk() to dynamically expand the heap from the kernel.
-// It implements a free list allocator with block coalescing for efficient
-// memory reuse, similar to dlmalloc/glibc malloc.
-
-const DEFAULT_ALIGNMENT: usize = 16;
-const MIN_BLOCK_SIZE: usize = 32; // Minimum block size (header + at least 16 bytes)
-const SBRK_INCREMENT: usize = 64 * 1024; // Request 64KB at a time
-
-/// Block header for free list allocator
-/// When allocated: stores size and flags
-/// When free: stores size, flags, and free list pointers
-#[repr(C)]
-struct BlockHeader {
-    /// Size of the block (including header) | flags in low bits
-    /// Bit 0: is_allocated (1 = allocated, 0 = free)
-    /// Bit 1: prev_allocated (1 = previous block is allocated)
-    size_flags: usize,
-}
-
-/// Free block structure (only valid when block is free)
-#[repr(C)]
-struct FreeBlock {
-    header: BlockHeader,
-    /// Next free block in the free list
-    next_free: *mut FreeBlock,
-    /// Previous free block in the free list
-    prev_free: *mut FreeBlock,
-}
-
-/// Footer for free blocks (stores size for backward coalescing)
-#[repr(C)]
-struct BlockFooter {
-    size: usize,
-}
-
-const HEADER_SIZE: usize = core::mem::size_of::<BlockHeader>();
-const FOOTER_SIZE: usize = core::mem::size_of::<BlockFooter>();
-const FREE_BLOCK_MIN: usize = core::mem::size_of::<FreeBlock>() + FOOTER_SIZE;
-
-// Data alignment: must be at least 16 for SSE/SSE2 instructions
-// To ensure data is 16-byte aligned, we need header to be at offset 0 mod 16
-// and data starts at offset HEADER_SIZE. So we pad HEADER_SIZE to 16.
-const DATA_OFFSET: usize = 16; // Padded header size to ensure 16-byte data alignment
-
-// Flag bits
-const FLAG_ALLOCATED: usize = 0x1;
-const FLAG_PREV_ALLOCATED: usize = 0x2;
-const SIZE_MASK: usize = !0x3;
-
-/// Heap state
-static mut HEAP_START: usize = 0;
-static mut HEAP_END: usize = 0;
-/// Head of the free list (sorted by address for coalescing)
-static mut FREE_LIST_HEAD: *mut FreeBlock = ptr::null_mut();
-/// Total allocated bytes (for statistics)
-static mut TOTAL_ALLOCATED: usize = 0;
-/// Total free bytes
-static mut TOTAL_FREE: usize = 0;
-
-/// Validate that a free block pointer is within heap bounds and properly aligned
-#[inline(always)]
-unsafe fn is_valid_free_block(block: *mut FreeBlock) -> bool {
-    if block.is_null() {
-        return false;
-    }
-    let addr = block as usize;
-    // Check alignment (FreeBlock needs at least 8-byte alignment)
-    if addr & 7 != 0 {
-        return false;
-    }
-    // Check within heap bounds
-    if HEAP_START == 0 {
-        return false;
-    }
-    if addr < HEAP_START || addr >= HEAP_END {
-        return false;
-    }
-    // Check block size is reasonable
-    let size = (*block).header.size();
-    if size < FREE_BLOCK_MIN || size > HEAP_END - addr {
-        return false;
-    }
-    true
-}
-
-impl BlockHeader {
-    #[inline(always)]
-    fn size(&self) -> usize {
-        self.size_flags & SIZE_MASK
-    }
-
-    #[inline(always)]
-    fn is_allocated(&self) -> bool {
-        (self.size_flags & FLAG_ALLOCATED) != 0
-    }
-
-    #[inline(always)]
-    fn is_prev_allocated(&self) -> bool {
-        (self.size_flags & FLAG_PREV_ALLOCATED) != 0
-    }
-
-    #[inline(always)]
-    fn set_size_flags(&mut self, size: usize, allocated: bool, prev_allocated: bool) {
-        self.size_flags = (size & SIZE_MASK)
-            | (if allocated { FLAG_ALLOCATED } else { 0 })
-            | (if prev_allocated {
-                FLAG_PREV_ALLOCATED
-            } else {
-                0
-            });
-    }
-}
-
-#[inline(always)]
-fn is_power_of_two(value: usize) -> bool {
-    value != 0 && (value & (value - 1)) == 0
-}
-
-#[inline(always)]
-fn align_up(value: usize, align: usize) -> Option<usize> {
-    if !is_power_of_two(align) {
-        return None;
-    }
-    let mask = align - 1;
-    value.checked_add(mask).map(|aligned| aligned & !mask)
-}
-
-/// Expand heap using sbrk() syscall
-unsafe fn expand_heap(min_size: usize) -> bool {
-    // Calculate how much to request (round up to SBRK_INCREMENT)
-    let increment = ((min_size + SBRK_INCREMENT - 1) / SBRK_INCREMENT) * SBRK_INCREMENT;
-
-    let result = libc_compat::sbrk(increment as isize);
-    if result == (-1isize) as *mut c_void {
-        return false;
-    }
-
-    let new_block_start = result as usize;
-
-    // If this is first allocation, initialize HEAP_START
-    if HEAP_START == 0 {
-        HEAP_START = new_block_start;
-        HEAP_END = new_block_start;
-    }
-
-    // Create a new free block from the expanded region
-    let block = new_block_start as *mut FreeBlock;
-    let block_size = increment;
-
-    // Set up the block header
-    (*block).header.set_size_flags(block_size, false, true); // Free, prev allocated (boundary)
-
-    // Set up the footer
-    let footer = (new_block_start + block_size - FOOTER_SIZE) as *mut BlockFooter;
-    (*footer).size = block_size;
-
-    // Initialize free list pointers
-    (*block).next_free = ptr::null_mut();
-    (*block).prev_free = ptr::null_mut();
-
-    // Add to free list
-    add_to_free_list(block);
-
-    HEAP_END = new_block_start + increment;
-    TOTAL_FREE += block_size;
-
-    true
-}
-
-/// Add a free block to the free list (address-ordered for coalescing)
-unsafe fn add_to_free_list(block: *mut FreeBlock) {
-    // Validate block before adding
-    if block.is_null() {
-        return;
-    }
-    
-    // Initialize pointers first
-    (*block).next_free = ptr::null_mut();
-    (*block).prev_free = ptr::null_mut();
-
-    if FREE_LIST_HEAD.is_null() {
-        FREE_LIST_HEAD = block;
-        return;
-    }
-
-    // Validate current head before linking
-    if !is_valid_free_block(FREE_LIST_HEAD) {
-        // Free list is corrupted, start fresh with this block
-        FREE_LIST_HEAD = block;
-        return;
-    }
-
-    // Simplified: just add to head of list (not address-ordered)
-    // This is less efficient but safer
-    (*block).next_free = FREE_LIST_HEAD;
-    (*FREE_LIST_HEAD).prev_free = block;
-    FREE_LIST_HEAD = block;
+        None => -1, // No space left
+    };
+    unlock_thread_atexit();
+    ret
 }
 
-/// Remove a block from the free list
-unsafe fn remove_from_free_list(block: *mut FreeBlock) {
-    if block.is_null() {
-        return;
-    }
-    
-    let prev = (*block).prev_free;
-    let next = (*block).next_free;
-
-    // Validate prev pointer before dereferencing
-    if !prev.is_null() {
-        if is_valid_free_block(prev) {
-            (*prev).next_free = next;
+/// Run `owner`'s destructors, newest first
+///
+/// A destructor may register further destructors, so entries are taken one
+/// at a time and the lock is never held across a call.
+unsafe fn run_thread_atexit(owner: usize) {
+    loop {
+        lock_thread_atexit();
+        let mut entry = None;
+        for i in (0..THREAD_ATEXIT_COUNT).rev() {
+            if THREAD_ATEXIT_ENTRIES[i]
+                .as_ref()
+                .map_or(false, |e| e.owner == owner)
+            {
+                entry = THREAD_ATEXIT_ENTRIES[i].take();
+                break;
+            }
         }
-    } else {
-        FREE_LIST_HEAD = next;
-    }
-
-    // Validate next pointer before dereferencing
-    if !next.is_null() {
-        if is_valid_free_block(next) {
-            (*next).prev_free = prev;
+        while THREAD_ATEXIT_COUNT > 0 && THREAD_ATEXIT_ENTRIES[THREAD_ATEXIT_COUNT - 1].is_none() {
+            THREAD_ATEXIT_COUNT -= 1;
         }
-    }
-    
-    // Clear the removed block's pointers
-    (*block).next_free = ptr::null_mut();
-    (*block).prev_free = ptr::null_mut();
-}
-
-/// Try to coalesce a free block with adjacent free blocks
-unsafe fn coalesce(block: *mut FreeBlock) -> *mut FreeBlock {
-    let header = &mut (*block).header;
-    let mut current_size = header.size();
-    let mut result = block;
-
-    // Try to coalesce with next block
-    let next_block = (block as usize + current_size) as *mut BlockHeader;
-    if (next_block as usize) < HEAP_END {
-        if !(*next_block).is_allocated() {
-            // Next block is free - merge
-            let next_free = next_block as *mut FreeBlock;
-            let next_size = (*next_block).size();
-
-            // Remove next block from free list
-            remove_from_free_list(next_free);
-
-            // Extend current block
-            current_size += next_size;
-            header.set_size_flags(current_size, false, header.is_prev_allocated());
-
-            // Update footer
-            let footer = (result as usize + current_size - FOOTER_SIZE) as *mut BlockFooter;
-            (*footer).size = current_size;
-        }
-    }
-
-    // Try to coalesce with previous block
-    if !header.is_prev_allocated() && (block as usize) > HEAP_START {
-        // Read previous block's footer to get its size
-        let prev_footer = (block as usize - FOOTER_SIZE) as *mut BlockFooter;
-        let prev_size = (*prev_footer).size;
-        let prev_block = (block as usize - prev_size) as *mut FreeBlock;
-
-        // Remove current block from free list (we'll re-add the merged block)
-        remove_from_free_list(result);
+        unlock_thread_atexit();
 
-        // Extend previous block
-        let new_size = prev_size + current_size;
-        (*prev_block).header.set_size_flags(
-            new_size,
-            false,
-            (*prev_block).header.is_prev_allocated(),
-        );
-
-        // Update footer
-        let footer = (prev_block as usize + new_size - FOOTER_SIZE) as *mut BlockFooter;
-        (*footer).size = new_size;
-
-        result = prev_block;
-        // Note: prev_block is already in the free list
-    }
-
-    result
-}
-
-/// Find a free block that fits the requested size using first-fit
-unsafe fn find_free_block(size: usize) -> *mut FreeBlock {
-    let mut curr = FREE_LIST_HEAD;
-    let mut iterations = 0;
-    const MAX_ITERATIONS: usize = 100000; // Prevent infinite loops
-
-    while !curr.is_null() && iterations < MAX_ITERATIONS {
-        // Validate current block before accessing
-        if !is_valid_free_block(curr) {
-            // Free list is corrupted at this point, truncate it
-            FREE_LIST_HEAD = ptr::null_mut();
-            return ptr::null_mut();
-        }
-        
-        if (*curr).header.size() >= size {
-            return curr;
+        match entry {
+            Some(entry) => (entry.dtor)(entry.obj),
+            None => return,
         }
-        
-        let next = (*curr).next_free;
-        // Validate next pointer
-        if !next.is_null() && !is_valid_free_block(next) {
-            // Next pointer is invalid, truncate list here
-            (*curr).next_free = ptr::null_mut();
-            return ptr::null_mut();
-        }
-        
-        curr = next;
-        iterations += 1;
-    }
-
-    ptr::null_mut()
-}
-
-/// Split a block if it's larger than needed
-unsafe fn split_block(block: *mut FreeBlock, needed_size: usize) {
-    let block_size = (*block).header.size();
-    let remaining = block_size - needed_size;
-
-    // Only split if remaining is large enough for a free block
-    if remaining >= FREE_BLOCK_MIN {
-        // Create a new free block from the remainder
-        let new_block = (block as usize + needed_size) as *mut FreeBlock;
-        
-        // IMPORTANT: Initialize free list pointers BEFORE setting up the block
-        // This prevents garbage values from causing issues
-        (*new_block).next_free = ptr::null_mut();
-        (*new_block).prev_free = ptr::null_mut();
-        
-        (*new_block).header.set_size_flags(remaining, false, true); // Free, prev allocated
-
-        // Set up footer
-        let footer = (new_block as usize + remaining - FOOTER_SIZE) as *mut BlockFooter;
-        (*footer).size = remaining;
-
-        // Update original block size
-        (*block).header.set_size_flags(
-            needed_size,
-            (*block).header.is_allocated(),
-            (*block).header.is_prev_allocated(),
-        );
-
-        // Add new block to free list
-        add_to_free_list(new_block);
-
-        TOTAL_FREE += remaining;
     }
 }
 
-unsafe fn alloc_internal(size: usize, align: usize) -> *mut c_void {
-    // CRITICAL: DO NOT log here - causes infinite recursion!
-
-    if size == 0 {
-        set_errno(0);
-        return ptr::null_mut();
-    }
-
-    if align == 0 {
-        set_errno(EINVAL);
-        return ptr::null_mut();
-    }
-
-    let requested_align = align.max(DEFAULT_ALIGNMENT);
-    if !is_power_of_two(requested_align) {
-        set_errno(EINVAL);
-        return ptr::null_mut();
-    }
-
-    // Calculate total size needed
-    // Size = data offset (padded header) + data (aligned) + possible padding
-    let data_size = match align_up(size, requested_align) {
-        Some(s) => s,
-        None => {
-            set_errno(ENOMEM);
-            return ptr::null_mut();
-        }
-    };
-
-    let total_size = match data_size.checked_add(DATA_OFFSET) {
-        Some(s) => s.max(FREE_BLOCK_MIN), // Minimum size for free block
-        None => {
-            set_errno(ENOMEM);
-            return ptr::null_mut();
-        }
-    };
+/// Run the calling thread's TLS destructors (called on program exit)
+#[no_mangle]
+pub unsafe extern "C" fn __cxa_thread_atexit_run() {
+    run_thread_atexit(current_thread_id());
+}
 
-    // Initialize heap on first allocation
-    if HEAP_START == 0 {
-        if !expand_heap(SBRK_INCREMENT.max(total_size)) {
-            // Print error to stderr (safe - doesn't allocate)
-            let msg = b"memory allocation of ";
-            let _ = syscall3(SYS_WRITE, 2, msg.as_ptr() as u64, msg.len() as u64);
-            let mut buf = [0u8; 20];
-            let len = format_usize(size, &mut buf);
-            let _ = syscall3(SYS_WRITE, 2, buf.as_ptr() as u64, len as u64);
-            let msg2 = b" bytes failed\n";
-            let _ = syscall3(SYS_WRITE, 2, msg2.as_ptr() as u64, msg2.len() as u64);
-            set_errno(ENOMEM);
-            return ptr::null_mut();
-        }
-    }
+/// POSIX rounds of pthread key destructor calls before giving up
+const PTHREAD_DESTRUCTOR_ITERATIONS: usize = 4;
 
-    // Find a suitable free block
-    let mut block = find_free_block(total_size);
+/// Exit-time cleanup for a thread: thread_local! destructors, then
+/// pthread_key destructors for every non-null value
+pub(crate) unsafe fn run_thread_exit_destructors(tcb: *mut libc_compat::pthread::ThreadControlBlock) {
+    run_thread_atexit(tcb as usize);
 
-    // If no suitable block found, expand heap
-    if block.is_null() {
-        if !expand_heap(total_size) {
-            set_errno(ENOMEM);
-            return ptr::null_mut();
+    for _ in 0..PTHREAD_DESTRUCTOR_ITERATIONS {
+        if !(*tcb).tsd_used {
+            return;
         }
-        block = find_free_block(total_size);
-        if block.is_null() {
-            set_errno(ENOMEM);
-            return ptr::null_mut();
+        (*tcb).tsd_used = false;
+        for key in 0..MAX_TLS_KEYS {
+            let value = (*tcb).tsd[key];
+            let dtor = TLS_DESTRUCTORS[key];
+            if value.is_null() || dtor.is_null() {
+                continue;
+            }
+            (*tcb).tsd[key] = ptr::null_mut();
+            let dtor: PthreadDestructorFn = core::mem::transmute(dtor);
+            dtor(value);
         }
     }
-
-    let block_size = (*block).header.size();
-
-    // Remove from free list
-    remove_from_free_list(block);
-    TOTAL_FREE -= block_size;
-
-    // Split if necessary
-    split_block(block, total_size);
-
-    // Mark as allocated
-    let final_size = (*block).header.size();
-    (*block)
-        .header
-        .set_size_flags(final_size, true, (*block).header.is_prev_allocated());
-
-    // Mark next block's prev_allocated flag
-    let next_header = (block as usize + final_size) as *mut BlockHeader;
-    if (next_header as usize) < HEAP_END {
-        let next_flags = (*next_header).size_flags;
-        (*next_header).size_flags = next_flags | FLAG_PREV_ALLOCATED;
-    }
-
-    TOTAL_ALLOCATED += final_size;
-
-    // Return pointer to data (after padded header for 16-byte alignment)
-    let data_ptr = (block as usize + DATA_OFFSET) as *mut c_void;
-    set_errno(0);
-    data_ptr
 }
 
-/// Format usize to decimal string (no allocation)
-fn format_usize(mut n: usize, buf: &mut [u8; 20]) -> usize {
-    if n == 0 {
-        buf[0] = b'0';
-        return 1;
-    }
-    let mut i = 20;
-    while n > 0 && i > 0 {
-        i -= 1;
-        buf[i] = b'0' + (n % 10) as u8;
-        n /= 10;
-    }
-    let len = 20 - i;
-    buf.copy_within(i..20, 0);
-    len
-}
+// Allocator support for std::alloc::System ----------------------------------
+// std expects malloc/free/realloc/calloc
+//
+// The allocator itself lives in malloc.rs: per-thread caches of size-classed
+// objects over a span-based page heap, with private mappings for big blocks.
 
-unsafe fn allocation_size(ptr: *mut c_void) -> Option<usize> {
+pub(crate) unsafe fn malloc_aligned(size: usize, alignment: usize) -> *mut c_void {
+    let ptr = malloc::memalign(alignment, size);
     if ptr.is_null() {
-        return None;
-    }
-
-    let data_ptr = ptr as usize;
-
-    // Check if pointer is within our heap
-    if HEAP_START == 0 || data_ptr < HEAP_START + DATA_OFFSET || data_ptr >= HEAP_END {
-        return None;
-    }
-
-    let header = (data_ptr - DATA_OFFSET) as *mut BlockHeader;
-    if (*header).is_allocated() {
-        Some((*header).size() - DATA_OFFSET)
-    } else {
-        None
+        set_errno(ENOMEM);
     }
-}
-
-pub(crate) unsafe fn malloc_aligned(size: usize, alignment: usize) -> *mut c_void {
-    alloc_internal(size, alignment)
+    ptr
 }
 
 #[no_mangle]
 pub unsafe extern "C" fn malloc(size: usize) -> *mut c_void {
     // DO NOT log here - may cause recursion if logging allocates
-    alloc_internal(size, DEFAULT_ALIGNMENT)
+    let ptr = malloc::malloc(size);
+    if ptr.is_null() {
+        set_errno(ENOMEM);
+    }
+    ptr
 }
 
 #[no_mangle]
@@ -2002,65 +1570,13 @@ pub unsafe extern "C" fn free(ptr: *mut c_void) {
     if ptr.is_null() {
         return;
     }
-
-    let data_ptr = ptr as usize;
-
-    // Validate pointer is within our heap
-    if HEAP_START == 0 || data_ptr < HEAP_START + DATA_OFFSET || data_ptr >= HEAP_END {
-        return; // Invalid pointer, silently ignore (like glibc)
-    }
-
-    // Get block header
-    let header = (data_ptr - DATA_OFFSET) as *mut BlockHeader;
-
-    // Check if block is actually allocated
-    if !(*header).is_allocated() {
-        return; // Double free, silently ignore
-    }
-
-    let block_size = (*header).size();
-
-    // Validate block size
-    if block_size < FREE_BLOCK_MIN || block_size > HEAP_END - (header as usize) {
-        // Invalid block size - corrupted header
-        return;
-    }
-
-    // Mark as free
-    (*header).set_size_flags(block_size, false, (*header).is_prev_allocated());
-
-    // Set up footer for backward coalescing
-    let footer = (header as usize + block_size - FOOTER_SIZE) as *mut BlockFooter;
-    (*footer).size = block_size;
-
-    // Update next block's prev_allocated flag
-    let next_header = (header as usize + block_size) as *mut BlockHeader;
-    if (next_header as usize) < HEAP_END {
-        let next_flags = (*next_header).size_flags;
-        (*next_header).size_flags = next_flags & !FLAG_PREV_ALLOCATED;
-    }
-
-    TOTAL_ALLOCATED -= block_size;
-    TOTAL_FREE += block_size;
-
-    // Add to free list - but only if the block's internal free list
-    // pointers are initialized to safe values
-    let block = header as *mut FreeBlock;
-
-    // Clear the free list pointers to ensure they don't contain garbage
-    (*block).next_free = ptr::null_mut();
-    (*block).prev_free = ptr::null_mut();
-
-    add_to_free_list(block);
-
-    // TEMPORARILY DISABLED: Try to coalesce with adjacent free blocks
-    // coalesce(block);
+    malloc::free(ptr);
 }
 
 #[no_mangle]
 pub unsafe extern "C" fn realloc(ptr: *mut c_void, new_size: usize) -> *mut c_void {
     if ptr.is_null() {
-        return alloc_internal(new_size, DEFAULT_ALIGNMENT);
+        return malloc(new_size);
     }
 
     if new_size == 0 {
@@ -2069,65 +1585,29 @@ pub unsafe extern "C" fn realloc(ptr: *mut c_void, new_size: usize) -> *mut c_vo
         return ptr::null_mut();
     }
 
-    let old_size = allocation_size(ptr).unwrap_or(0);
-
+    let old_size = malloc::usable_size(ptr);
     if old_size == 0 {
         // Invalid pointer
         set_errno(EINVAL);
         return ptr::null_mut();
     }
 
-    // If shrinking significantly, we could split the block
-    // For now, just keep the same block if new_size <= old_size
-    if new_size <= old_size {
-        set_errno(0);
+    let shrinking = new_size <= old_size;
+    // Still fits its size class, or a span that stays mostly used
+    if shrinking && malloc::keeps_block_on_shrink(ptr, new_size) {
         return ptr;
     }
 
-    // Try to expand in place by checking if next block is free
-    let header = (ptr as usize - DATA_OFFSET) as *mut BlockHeader;
-    let block_size = (*header).size();
-    let next_header = (header as usize + block_size) as *mut BlockHeader;
-
-    if (next_header as usize) < HEAP_END && !(*next_header).is_allocated() {
-        let next_size = (*next_header).size();
-        let combined_size = block_size + next_size;
-        let needed_size = new_size + DATA_OFFSET;
-
-        if combined_size >= needed_size {
-            // Can expand in place!
-            let next_block = next_header as *mut FreeBlock;
-            remove_from_free_list(next_block);
-            TOTAL_FREE -= next_size;
-
-            // Update header with new size
-            (*header).set_size_flags(combined_size, true, (*header).is_prev_allocated());
-            TOTAL_ALLOCATED += next_size;
-
-            // Update next block's prev_allocated flag
-            let new_next = (header as usize + combined_size) as *mut BlockHeader;
-            if (new_next as usize) < HEAP_END {
-                let flags = (*new_next).size_flags;
-                (*new_next).size_flags = flags | FLAG_PREV_ALLOCATED;
-            }
-
-            // Optionally split if there's excess
-            // (Skip for simplicity - could add later)
-
-            set_errno(0);
+    let new_ptr = malloc::malloc(new_size);
+    if new_ptr.is_null() {
+        if shrinking {
+            // The old block still holds the data
             return ptr;
         }
-    }
-
-    // Fall back to allocate + copy + free
-    let new_ptr = alloc_internal(new_size, DEFAULT_ALIGNMENT);
-    if new_ptr.is_null() {
+        set_errno(ENOMEM);
         return ptr::null_mut();
     }
-
-    let copy_len = cmp::min(old_size, new_size);
-    ptr::copy_nonoverlapping(ptr as *const u8, new_ptr as *mut u8, copy_len);
-
+    ptr::copy_nonoverlapping(ptr as *const u8, new_ptr as *mut u8, old_size.min(new_size));
     free(ptr);
     new_ptr
 }
@@ -2135,19 +1615,23 @@ pub unsafe extern "C" fn realloc(ptr: *mut c_void, new_size: usize) -> *mut c_vo
 #[no_mangle]
 pub unsafe extern "C" fn calloc(nmemb: usize, size: usize) -> *mut c_void {
     // DO NOT log here - may cause recursion if logging allocates
-    match nmemb.checked_mul(size) {
-        Some(total) if total > 0 => {
-            let ptr = alloc_internal(total, DEFAULT_ALIGNMENT);
-            if !ptr.is_null() {
-                ptr::write_bytes(ptr as *mut u8, 0, total);
-            }
-            ptr
-        }
-        _ => {
-            set_errno(0);
-            ptr::null_mut()
-        }
+    let ptr = match nmemb.checked_mul(size) {
+        Some(total) => malloc::calloc(total),
+        None => ptr::null_mut(),
+    };
+    if ptr.is_null() {
+        set_errno(ENOMEM);
+    }
+    ptr
+}
+
+/// Bytes actually available at `ptr`, which may exceed the size requested
+#[no_mangle]
+pub unsafe extern "C" fn malloc_usable_size(ptr: *mut c_void) -> usize {
+    if ptr.is_null() {
+        return 0;
     }
+    malloc::usable_size(ptr)
 }
 
 // Random number generation (for std::random) --------------------------------
@@ -2160,7 +1644,28 @@ pub const GRND_NONBLOCK: u32 = 0x0001;
 pub const GRND_RANDOM: u32 = 0x0002;
 pub const GRND_INSECURE: u32 = 0x0004;
 
+/// Raw getrandom syscall; returns the byte count or a negative errno
+pub(crate) fn sys_getrandom(buf: *mut u8, buflen: usize, flags: u32) -> isize {
+    let ret: isize;
+    unsafe {
+        core::arch::asm!(
+            "syscall",
+            inout("rax") SYS_GETRANDOM => ret,
+            in("rdi") buf,
+            in("rsi") buflen,
+            in("rdx") flags,
+            out("rcx") _,
+            out("r11") _,
+            options(nostack, preserves_flags)
+        );
+    }
+    ret
+}
+
 /// Get random bytes from the kernel via getrandom syscall
+///
+/// Small requests without GRND_RANDOM are served by the userspace CRNG in
+/// `random.rs`, which the kernel reseeds periodically.
 #[no_mangle]
 pub unsafe extern "C" fn getrandom(buf: *mut c_void, buflen: usize, flags: u32) -> isize {
     if buf.is_null() || buflen == 0 {
@@ -2168,18 +1673,14 @@ pub unsafe extern "C" fn getrandom(buf: *mut c_void, buflen: usize, flags: u32)
         return -1;
     }
 
-    let ret: isize;
-    core::arch::asm!(
-        "syscall",
-        inout("rax") SYS_GETRANDOM => ret,
-        in("rdi") buf,
-        in("rsi") buflen,
-        in("rdx") flags,
-        out("rcx") _,
-        out("r11") _,
-        options(nostack, preserves_flags)
-    );
+    if flags & GRND_RANDOM == 0
+        && random::fill_fast(core::slice::from_raw_parts_mut(buf as *mut u8, buflen))
+    {
+        set_errno(0);
+        return buflen as isize;
+    }
 
+    let ret = sys_getrandom(buf as *mut u8, buflen, flags);
     if ret < 0 {
         set_errno((-ret) as i32);
         -1
@@ -4,6 +4,7 @@
 
 use super::types::timespec;
 use crate::{c_int, c_void, size_t};
+use core::arch::global_asm;
 
 // ============================================================================
 // Clone Syscall
@@ -36,7 +37,58 @@ pub unsafe extern "C" fn clone_syscall(
     }
 }
 
+// The child of a thread clone starts with nothing but the new stack pointer
+// (the kernel hands it a zeroed register file), so the entry function and
+// its argument travel on the child's stack. The child pops them, calls the
+// function with a 16-byte aligned stack, and exits with its return value.
+global_asm!(
+    ".section .text.__nrlib_clone,\"ax\",@progbits",
+    ".globl __nrlib_clone",
+    ".hidden __nrlib_clone",
+    ".type __nrlib_clone, @function",
+    // (func, stack, flags, arg, ptid, tls, ctid on the stack)
+    "__nrlib_clone:",
+    "and rsi, -16",
+    "sub rsi, 16",
+    "mov [rsi], rcx",
+    "mov [rsi + 8], rdi",
+    "mov edi, edx",
+    "mov rdx, r8",
+    "mov r10, [rsp + 8]",
+    "mov r8, r9",
+    "mov eax, 56",
+    "int 0x81",
+    "test rax, rax",
+    "jnz 1f",
+    "xor ebp, ebp",
+    "pop rdi",
+    "pop rax",
+    "call rax",
+    "mov edi, eax",
+    "mov eax, 60",
+    "int 0x81",
+    "ud2",
+    "1:",
+    "ret",
+    ".size __nrlib_clone, . - __nrlib_clone",
+);
+
+extern "C" {
+    fn __nrlib_clone(
+        func: extern "C" fn(*mut c_void) -> c_int,
+        stack: *mut c_void,
+        flags: c_int,
+        arg: *mut c_void,
+        parent_tid: *mut c_int,
+        tls: *mut c_void,
+        child_tid: *mut c_int,
+    ) -> u64;
+}
+
 /// __clone - musl libc clone wrapper
+///
+/// Runs `func(arg)` on `stack` in the new task and returns its TID, or -1
+/// with errno set.
 #[no_mangle]
 pub unsafe extern "C" fn __clone(
     func: extern "C" fn(*mut c_void) -> c_int,
@@ -47,10 +99,14 @@ pub unsafe extern "C" fn __clone(
     tls: *mut c_void,
     child_tid: *mut c_int,
 ) -> c_int {
-    // In single-threaded environment, clone for threads is not fully supported
-    let _ = (func, stack, flags, arg, parent_tid, tls, child_tid);
-    crate::set_errno(crate::ENOSYS);
-    -1
+    let ret = __nrlib_clone(func, stack, flags, arg, parent_tid, tls, child_tid);
+    if ret == u64::MAX {
+        crate::refresh_errno_from_kernel();
+        -1
+    } else {
+        crate::set_errno(0);
+        ret as c_int
+    }
 }
 
 // ============================================================================
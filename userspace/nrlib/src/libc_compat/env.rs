@@ -235,8 +235,25 @@ pub unsafe extern "C" fn clearenv() -> c_int {
 // Auxiliary Vector
 // ============================================================================
 
+/// Auxiliary vector captured at startup (null if unknown)
+static mut AUXV: *const u64 = ptr::null();
+
+pub(crate) unsafe fn set_auxv(auxv: *const u64) {
+    AUXV = auxv;
+}
+
 #[no_mangle]
-pub unsafe extern "C" fn getauxval(_type: u64) -> u64 {
+pub unsafe extern "C" fn getauxval(type_: u64) -> u64 {
+    let mut entry = AUXV;
+    if entry.is_null() {
+        return 0;
+    }
+    while *entry != super::elf::AT_NULL {
+        if *entry == type_ {
+            return *entry.add(1);
+        }
+        entry = entry.add(2);
+    }
     0
 }
 
@@ -432,7 +432,9 @@ pub unsafe fn load_elf_file(path: &[u8]) -> Result<ElfLoadResult, LoadError> {
     // Calculate load bias
     let load_bias = base_addr as i64 - load_addr_min as i64;
 
-    // Now map each loadable segment
+    // Map each loadable segment straight from the file. MAP_PRIVATE pages
+    // are only copied when written, so text and rodata are never dirtied
+    // and relocation writes stay confined to the data/GOT pages.
     for phdr in phdrs {
         if phdr.p_type != PT_LOAD {
             continue;
@@ -440,62 +442,72 @@ pub unsafe fn load_elf_file(path: &[u8]) -> Result<ElfLoadResult, LoadError> {
 
         let seg_start = page_align_down(phdr.p_vaddr);
         let seg_end = page_align_up(phdr.p_vaddr + phdr.p_memsz);
-        let seg_size = seg_end - seg_start;
-
-        let map_addr = (seg_start as i64 + load_bias) as u64;
-        let prot = elf_to_mmap_prot(phdr.p_flags);
-
-        // Map with write permission first (we need to copy data)
-        let map_result = mmap(
-            map_addr,
-            seg_size,
-            PROT_READ | PROT_WRITE,
-            MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED,
-            -1,
-            0,
-        );
-
-        if map_result.is_err() {
-            // Clean up already mapped regions
-            munmap(base_addr, total_size).ok();
-            close_file(fd);
-            return Err(LoadError::MmapFailed);
+        let file_end = page_align_up(phdr.p_vaddr + phdr.p_filesz);
+        let has_bss = phdr.p_memsz > phdr.p_filesz;
+
+        // The tail of the last file page is zeroed in place for BSS
+        let mut prot = elf_to_mmap_prot(phdr.p_flags);
+        if has_bss {
+            prot |= PROT_WRITE;
         }
 
-        // Read file data into the segment using lseek
         if phdr.p_filesz > 0 {
-            // Seek to segment offset
-            if lseek(fd, phdr.p_offset as i64, SEEK_SET).is_err() {
+            // Only congruent offsets can be mapped (required by the ELF spec)
+            if (phdr.p_offset & (PAGE_SIZE - 1)) != (phdr.p_vaddr & (PAGE_SIZE - 1)) {
                 munmap(base_addr, total_size).ok();
                 close_file(fd);
-                return Err(LoadError::ReadError);
+                return Err(LoadError::InvalidElf);
             }
 
-            // Read segment data directly into mapped memory
-            let data_addr = ((phdr.p_vaddr as i64) + load_bias) as *mut u8;
-            let mut read_total = 0u64;
-
-            while read_total < phdr.p_filesz {
-                let to_read = core::cmp::min(phdr.p_filesz - read_total, 4096) as usize;
-                let dest =
-                    core::slice::from_raw_parts_mut(data_addr.add(read_total as usize), to_read);
-                let read = read_file(fd, dest)?;
-                if read == 0 {
-                    break;
-                }
-                read_total += read as u64;
+            let map_result = mmap(
+                (seg_start as i64 + load_bias) as u64,
+                file_end - seg_start,
+                prot,
+                MAP_PRIVATE | MAP_FIXED,
+                fd as i64,
+                page_align_down(phdr.p_offset),
+            );
+            if map_result.is_err() {
+                munmap(base_addr, total_size).ok();
+                close_file(fd);
+                return Err(LoadError::MmapFailed);
             }
         }
 
-        // Zero BSS region (memsz > filesz)
-        if phdr.p_memsz > phdr.p_filesz {
-            let bss_start = ((phdr.p_vaddr + phdr.p_filesz) as i64 + load_bias) as *mut u8;
-            let bss_size = (phdr.p_memsz - phdr.p_filesz) as usize;
-            ptr::write_bytes(bss_start, 0, bss_size);
+        // Whole BSS pages past the file data come from anonymous memory
+        let anon_start = if phdr.p_filesz > 0 {
+            file_end
+        } else {
+            seg_start
+        };
+        if seg_end > anon_start {
+            let map_result = mmap(
+                (anon_start as i64 + load_bias) as u64,
+                seg_end - anon_start,
+                prot,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED,
+                -1,
+                0,
+            );
+            if map_result.is_err() {
+                munmap(base_addr, total_size).ok();
+                close_file(fd);
+                return Err(LoadError::MmapFailed);
+            }
         }
 
-        // TODO: Set correct protection after loading
-        // For now, keep read/write/exec
+        // Zero the file bytes that share the last page with the BSS start
+        if has_bss && phdr.p_filesz > 0 {
+            let bss_start = phdr.p_vaddr + phdr.p_filesz;
+            let zero_end = core::cmp::min(file_end, phdr.p_vaddr + phdr.p_memsz);
+            if zero_end > bss_start {
+                ptr::write_bytes(
+                    (bss_start as i64 + load_bias) as *mut u8,
+                    0,
+                    (zero_end - bss_start) as usize,
+                );
+            }
+        }
     }
 
     // Find dynamic section
@@ -539,7 +551,96 @@ pub unsafe fn load_elf_file(path: &[u8]) -> Result<ElfLoadResult, LoadError> {
     })
 }
 
+// ============================================================================
+// Library Search
+// ============================================================================
+
+/// Longest library name the search cache remembers
+const SEARCH_CACHE_NAME_MAX: usize = 64;
+
+/// Number of remembered search results
+const SEARCH_CACHE_SIZE: usize = 32;
+
+/// Directory a library name was last found in
+#[derive(Clone, Copy)]
+struct SearchCacheEntry {
+    name: [u8; SEARCH_CACHE_NAME_MAX],
+    name_len: usize,
+    /// Index into DEFAULT_LIB_PATHS
+    dir: usize,
+}
+
+/// Search results, so repeated dlopen() of a name probes one directory
+/// instead of walking DEFAULT_LIB_PATHS. Only touched by `search_library`,
+/// which runs under the library manager lock.
+static mut SEARCH_CACHE: [Option<SearchCacheEntry>; SEARCH_CACHE_SIZE] = [None; SEARCH_CACHE_SIZE];
+static mut SEARCH_CACHE_NEXT: usize = 0;
+
+/// Build "<dir>/<name>" NUL-terminated in `path_buf`; false if it does not fit
+fn build_library_path(path_buf: &mut [u8; MAX_LIB_PATH], dir: &[u8], name: &[u8]) -> bool {
+    let total_len = dir.len() + 1 + name.len();
+    if total_len >= MAX_LIB_PATH {
+        return false;
+    }
+    path_buf[..dir.len()].copy_from_slice(dir);
+    path_buf[dir.len()] = b'/';
+    path_buf[dir.len() + 1..total_len].copy_from_slice(name);
+    path_buf[total_len] = 0;
+    true
+}
+
+/// Whether a file exists at the NUL-terminated `path_buf`
+fn library_exists(path_buf: &[u8; MAX_LIB_PATH]) -> bool {
+    unsafe {
+        match open_file(path_buf) {
+            Ok(fd) => {
+                close_file(fd);
+                true
+            }
+            Err(_) => false,
+        }
+    }
+}
+
+fn search_cache_lookup(name: &[u8]) -> Option<usize> {
+    unsafe {
+        (*ptr::addr_of!(SEARCH_CACHE))
+            .iter()
+            .flatten()
+            .find(|entry| &entry.name[..entry.name_len] == name)
+            .map(|entry| entry.dir)
+    }
+}
+
+fn search_cache_insert(name: &[u8], dir: usize) {
+    if name.len() > SEARCH_CACHE_NAME_MAX {
+        return;
+    }
+    let mut entry = SearchCacheEntry {
+        name: [0; SEARCH_CACHE_NAME_MAX],
+        name_len: name.len(),
+        dir,
+    };
+    entry.name[..name.len()].copy_from_slice(name);
+    unsafe {
+        let cache = &mut *ptr::addr_of_mut!(SEARCH_CACHE);
+        // Update in place, else replace round-robin
+        let slot = cache
+            .iter()
+            .position(|e| matches!(e, Some(old) if &old.name[..old.name_len] == name))
+            .unwrap_or_else(|| {
+                let slot = SEARCH_CACHE_NEXT;
+                SEARCH_CACHE_NEXT = (slot + 1) % SEARCH_CACHE_SIZE;
+                slot
+            });
+        cache[slot] = Some(entry);
+    }
+}
+
 /// Search for a library in standard paths
+///
+/// A remembered directory is checked first; if the library has since moved
+/// the full search runs again and the cache is updated.
 pub fn search_library(name: &[u8]) -> Option<[u8; MAX_LIB_PATH]> {
     let mut path_buf = [0u8; MAX_LIB_PATH];
 
@@ -550,31 +651,28 @@ pub fn search_library(name: &[u8]) -> Option<[u8; MAX_LIB_PATH]> {
         return Some(path_buf);
     }
 
-    // Search in standard paths
-    for search_path in DEFAULT_LIB_PATHS {
-        let search_bytes = search_path.as_bytes();
-        let total_len = search_bytes.len() + 1 + name.len();
+    let cached_dir = search_cache_lookup(name);
+    if let Some(dir) = cached_dir {
+        if build_library_path(&mut path_buf, DEFAULT_LIB_PATHS[dir].as_bytes(), name)
+            && library_exists(&path_buf)
+        {
+            return Some(path_buf);
+        }
+    }
 
-        if total_len >= MAX_LIB_PATH {
+    // Search in standard paths
+    for (dir, search_path) in DEFAULT_LIB_PATHS.iter().enumerate() {
+        if Some(dir) == cached_dir {
+            continue;
+        }
+        if !build_library_path(&mut path_buf, search_path.as_bytes(), name) {
             continue;
         }
-
-        // Build path: search_path + "/" + name
-        let mut pos = 0;
-        path_buf[pos..pos + search_bytes.len()].copy_from_slice(search_bytes);
-        pos += search_bytes.len();
-        path_buf[pos] = b'/';
-        pos += 1;
-        path_buf[pos..pos + name.len()].copy_from_slice(name);
-        pos += name.len();
-        path_buf[pos] = 0;
 
         // Try to open to check if it exists
-        unsafe {
-            if let Ok(fd) = open_file(&path_buf[..pos]) {
-                close_file(fd);
-                return Some(path_buf);
-            }
+        if library_exists(&path_buf) {
+            search_cache_insert(name, dir);
+            return Some(path_buf);
         }
     }
 
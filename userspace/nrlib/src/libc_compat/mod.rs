@@ -13,6 +13,7 @@
 //! - `signal` - Signal handling stubs
 //! - `dl` - Dynamic linker API (dlopen, dlsym, dlclose, etc.)
 //! - `clone` - Clone, futex, and thread ID functions
+//! - `tls` - Static TLS layout and per-thread TLS blocks
 //! - `network` - Network functions (inet_*, byte order conversion)
 //! - `process` - Process control (posix_spawn, wait, exec, etc.)
 //! - `syscall_wrapper` - Variadic syscall function
@@ -45,6 +46,7 @@ pub mod signal;
 pub mod string;
 pub mod syscall_wrapper;
 pub mod time_compat;
+pub mod tls;
 pub mod types;
 pub mod unwind;
 pub mod user;
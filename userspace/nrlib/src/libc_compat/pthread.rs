@@ -6,7 +6,7 @@ use crate::{c_int, c_ulong, c_void, size_t};
 use core::{
     hint::spin_loop,
     mem, ptr,
-    sync::atomic::{AtomicUsize, Ordering},
+    sync::atomic::{AtomicU32, AtomicUsize, Ordering},
 };
 
 use super::types::{
@@ -168,13 +168,6 @@ fn u64_to_hex(mut n: u64, buf: &mut [u8]) -> &[u8] {
     &buf[..i]
 }
 
-/// Print a hex value to stderr
-fn print_hex_u64(val: u64) {
-    let mut buf = [0u8; 16];
-    let hex = u64_to_hex(val, &mut buf);
-    let _ = crate::syscall3(SYS_WRITE_NR, 2, hex.as_ptr() as u64, hex.len() as u64);
-}
-
 #[inline(always)]
 fn log_mutex(msg: &[u8]) {
     let slot = PTHREAD_MUTEX_LOG_COUNT.fetch_add(1, Ordering::Relaxed);
@@ -275,8 +268,26 @@ fn log_mutex_kind(tag: &[u8], kind: c_int) {
 // Thread Attribute Functions
 // ============================================================================
 
+// pthread_attr_t words nrlib uses (the rest of the 56 bytes is reserved)
+const ATTR_STACKSIZE: usize = 0;
+const ATTR_GUARDSIZE: usize = 1;
+const ATTR_DETACHSTATE: usize = 2;
+const ATTR_STACKADDR: usize = 3;
+
+pub const PTHREAD_CREATE_JOINABLE: c_int = 0;
+pub const PTHREAD_CREATE_DETACHED: c_int = 1;
+
+/// Smallest stack pthread_attr_setstacksize accepts
+pub const PTHREAD_STACK_MIN: size_t = 16384;
+
 #[no_mangle]
-pub unsafe extern "C" fn pthread_attr_init(_attr: *mut pthread_attr_t) -> c_int {
+pub unsafe extern "C" fn pthread_attr_init(attr: *mut pthread_attr_t) -> c_int {
+    if attr.is_null() {
+        return crate::EINVAL;
+    }
+    (*attr).__size = [0; 7];
+    (*attr).__size[ATTR_STACKSIZE] = DEFAULT_STACK_SIZE as u64;
+    (*attr).__size[ATTR_GUARDSIZE] = STACK_GUARD_SIZE as u64;
     0
 }
 
@@ -287,42 +298,100 @@ pub unsafe extern "C" fn pthread_attr_destroy(_attr: *mut pthread_attr_t) -> c_i
 
 #[no_mangle]
 pub unsafe extern "C" fn pthread_attr_setstacksize(
-    _attr: *mut pthread_attr_t,
-    _stacksize: size_t,
+    attr: *mut pthread_attr_t,
+    stacksize: size_t,
 ) -> c_int {
+    if attr.is_null() || stacksize < PTHREAD_STACK_MIN {
+        return crate::EINVAL;
+    }
+    (*attr).__size[ATTR_STACKSIZE] = stacksize as u64;
+    0
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn pthread_attr_getstacksize(
+    attr: *const pthread_attr_t,
+    stacksize: *mut size_t,
+) -> c_int {
+    if attr.is_null() || stacksize.is_null() {
+        return crate::EINVAL;
+    }
+    *stacksize = (*attr).__size[ATTR_STACKSIZE] as size_t;
     0
 }
 
 #[no_mangle]
 pub unsafe extern "C" fn pthread_attr_setguardsize(
-    _attr: *mut pthread_attr_t,
-    _guardsize: size_t,
+    attr: *mut pthread_attr_t,
+    guardsize: size_t,
 ) -> c_int {
+    if attr.is_null() {
+        return crate::EINVAL;
+    }
+    (*attr).__size[ATTR_GUARDSIZE] = guardsize as u64;
     0
 }
 
 #[no_mangle]
 pub unsafe extern "C" fn pthread_attr_getguardsize(
-    _attr: *const pthread_attr_t,
+    attr: *const pthread_attr_t,
     guardsize: *mut size_t,
 ) -> c_int {
     if !guardsize.is_null() {
-        *guardsize = 0;
+        *guardsize = if attr.is_null() {
+            0
+        } else {
+            (*attr).__size[ATTR_GUARDSIZE] as size_t
+        };
     }
     0
 }
 
+#[no_mangle]
+pub unsafe extern "C" fn pthread_attr_setdetachstate(
+    attr: *mut pthread_attr_t,
+    detachstate: c_int,
+) -> c_int {
+    if attr.is_null()
+        || (detachstate != PTHREAD_CREATE_JOINABLE && detachstate != PTHREAD_CREATE_DETACHED)
+    {
+        return crate::EINVAL;
+    }
+    (*attr).__size[ATTR_DETACHSTATE] = detachstate as u64;
+    0
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn pthread_attr_getdetachstate(
+    attr: *const pthread_attr_t,
+    detachstate: *mut c_int,
+) -> c_int {
+    if attr.is_null() || detachstate.is_null() {
+        return crate::EINVAL;
+    }
+    *detachstate = (*attr).__size[ATTR_DETACHSTATE] as c_int;
+    0
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn pthread_attr_getstack(
-    _attr: *const pthread_attr_t,
+    attr: *const pthread_attr_t,
     stackaddr: *mut *mut c_void,
     stacksize: *mut size_t,
 ) -> c_int {
+    let (addr, size) = if attr.is_null() {
+        (0, 0)
+    } else {
+        (
+            (*attr).__size[ATTR_STACKADDR],
+            (*attr).__size[ATTR_STACKSIZE],
+        )
+    };
     if !stackaddr.is_null() {
-        *stackaddr = ptr::null_mut();
+        *stackaddr = addr as *mut c_void;
     }
     if !stacksize.is_null() {
-        *stacksize = 0;
+        *stacksize = size as size_t;
     }
     0
 }
@@ -594,6 +663,11 @@ const DEFAULT_STACK_SIZE: usize = 1 * 1024 * 1024;
 /// Thread stack guard size
 const STACK_GUARD_SIZE: usize = 4096;
 
+const PAGE_SIZE: usize = 4096;
+
+/// Exited threads' blocks kept mapped for the next pthread_create
+const STACK_CACHE_SLOTS: usize = 8;
+
 /// Clone flags for creating a thread
 const CLONE_THREAD_FLAGS: c_int = super::types::CLONE_VM
     | super::types::CLONE_FS
@@ -605,6 +679,13 @@ const CLONE_THREAD_FLAGS: c_int = super::types::CLONE_VM
     | super::types::CLONE_PARENT_SETTID
     | super::types::CLONE_CHILD_CLEARTID;
 
+/// Thread lifecycle, kept in ThreadControlBlock::exited
+const THREAD_RUNNING: usize = 0;
+/// Start routine finished; the joiner reclaims the block
+const THREAD_EXITED: usize = 1;
+/// Nobody will join; the thread hands its own block back
+const THREAD_DETACHED: usize = 2;
+
 /// Thread control block - stores thread state
 /// This structure is pointed to by the FS register for TLS access
 /// Layout must be compatible with musl's pthread structure for std compatibility
@@ -627,6 +708,11 @@ const CLONE_THREAD_FLAGS: c_int = super::types::CLONE_VM
 ///   offset 112: canary (8 bytes)
 ///   offset 120: tsd_used (1 byte) + padding (7 bytes)
 ///   offset 128: tsd (128 * 8 = 1024 bytes) - musl naming
+///   offset 1152: malloc_cache (8 bytes)
+///   offset 1160: guard_size (8 bytes)
+///
+/// The thread pointer sits between the block's static TLS data (below) and
+/// this structure; ld-nrlib reserves 2048 bytes for it in the main thread.
 #[repr(C)]
 pub(crate) struct ThreadControlBlock {
     /// Self pointer (for TLS access via %fs:0) - offset 0
@@ -645,17 +731,17 @@ pub(crate) struct ThreadControlBlock {
     arg: *mut c_void,
     /// Return value from thread - offset 56
     retval: *mut c_void,
-    /// Stack base address - offset 64
+    /// Base of the thread's block mapping (guard page first) - offset 64
     stack_base: *mut c_void,
-    /// Stack size - offset 72
+    /// Length of the block mapping, 0 for the main thread - offset 72
     stack_size: usize,
-    /// Thread ID (set after clone) - offset 80
+    /// Thread ID; the kernel zeroes it and wakes joiners on exit - offset 80
     tid: AtomicUsize,
     /// errno location - offset 88
     errno_val: i32,
     /// Flags: bit 0 = joinable, bit 1 = detached - offset 92
     flags: u32,
-    /// Exit flag - offset 96
+    /// THREAD_RUNNING / THREAD_EXITED / THREAD_DETACHED - offset 96
     exited: AtomicUsize,
     /// TID address for futex wake on exit - offset 104
     tid_address: *mut c_int,
@@ -667,29 +753,51 @@ pub(crate) struct ThreadControlBlock {
     _pad: [u8; 7],
     /// Thread-specific data (pthread_key values) - offset 128, musl naming
     pub(crate) tsd: [*mut c_void; MAX_TLS_KEYS],
+    /// Per-thread malloc cache (see crate::malloc) - offset 1152
+    pub(crate) malloc_cache: *mut c_void,
+    /// Guard bytes at the bottom of the block - offset 1160
+    guard_size: usize,
 }
 
 impl ThreadControlBlock {
-    fn is_joinable(&self) -> bool {
-        (self.flags & 1) != 0
-    }
-    fn set_joinable(&mut self, v: bool) {
-        if v {
-            self.flags |= 1;
-        } else {
-            self.flags &= !1;
+    const fn new(start_routine: extern "C" fn(*mut c_void) -> *mut c_void) -> Self {
+        Self {
+            self_ptr: ptr::null_mut(),
+            dtv: ptr::null_mut(),
+            prev: ptr::null_mut(),
+            next: ptr::null_mut(),
+            sysinfo: 0,
+            start_routine,
+            arg: ptr::null_mut(),
+            retval: ptr::null_mut(),
+            stack_base: ptr::null_mut(),
+            stack_size: 0,
+            tid: AtomicUsize::new(0),
+            errno_val: 0,
+            flags: 1, // joinable
+            exited: AtomicUsize::new(THREAD_RUNNING),
+            tid_address: ptr::null_mut(),
+            canary: 0,
+            tsd_used: false,
+            _pad: [0; 7],
+            tsd: [ptr::null_mut(); MAX_TLS_KEYS],
+            malloc_cache: ptr::null_mut(),
+            guard_size: 0,
         }
     }
-    fn is_detached(&self) -> bool {
-        (self.flags & 2) != 0
-    }
+
     fn set_detached(&mut self, v: bool) {
         if v {
-            self.flags |= 2;
+            self.flags = (self.flags & !1) | 2;
         } else {
-            self.flags &= !2;
+            self.flags = (self.flags & !2) | 1;
         }
     }
+
+    /// The kernel clears the low 32 bits of `tid` (CLONE_CHILD_CLEARTID)
+    fn tid_word(&self) -> *const AtomicU32 {
+        &self.tid as *const AtomicUsize as *const AtomicU32
+    }
 }
 
 /// Maximum TLS keys per thread
@@ -709,32 +817,18 @@ struct MainThreadTcbStorage {
 }
 
 static mut MAIN_THREAD_TCB: MainThreadTcbStorage = MainThreadTcbStorage {
-    tcb: ThreadControlBlock {
-        self_ptr: ptr::null_mut(),
-        dtv: ptr::null_mut(),
-        prev: ptr::null_mut(),
-        next: ptr::null_mut(),
-        sysinfo: 0,
-        start_routine: main_thread_dummy_start,
-        arg: ptr::null_mut(),
-        retval: ptr::null_mut(),
-        stack_base: ptr::null_mut(),
-        stack_size: 0,
-        tid: AtomicUsize::new(0),
-        errno_val: 0,
-        flags: 1, // joinable
-        exited: AtomicUsize::new(0),
-        tid_address: ptr::null_mut(),
-        canary: 0,
-        tsd_used: false,
-        _pad: [0; 7],
-        tsd: [ptr::null_mut(); MAX_TLS_KEYS],
-    },
+    tcb: ThreadControlBlock::new(main_thread_dummy_start),
 };
 
-/// Flag to track if main thread TLS has been initialized
+/// Main thread TLS state: 0 = not set up, 1 = in progress, 2 = FS base valid
 static MAIN_TLS_INITIALIZED: AtomicUsize = AtomicUsize::new(0);
 
+/// Whether %fs:0 points at a TCB (false only early in startup)
+#[inline(always)]
+pub(crate) fn tls_ready() -> bool {
+    MAIN_TLS_INITIALIZED.load(Ordering::Relaxed) == 2
+}
+
 /// Dummy start routine for main thread (never called)
 extern "C" fn main_thread_dummy_start(_arg: *mut c_void) -> *mut c_void {
     ptr::null_mut()
@@ -745,10 +839,15 @@ extern "C" fn main_thread_dummy_start(_arg: *mut c_void) -> *mut c_void {
 /// It sets up the TCB and FS base register for the main thread.
 #[no_mangle]
 pub unsafe extern "C" fn __nrlib_init_main_thread_tls() {
-    // Debug: print entry
-    let msg = b"[nrlib] __nrlib_init_main_thread_tls called\n";
-    let _ = crate::syscall3(SYS_WRITE_NR, 2, msg.as_ptr() as u64, msg.len() as u64);
-    
+    init_main_thread(ptr::null());
+}
+
+/// Set up the main thread's TCB and static TLS; `auxv` may be null
+///
+/// Under ld-nrlib the block already exists and FS points at it, so only the
+/// TCB fields are filled in. A static program gets a block sized for its
+/// PT_TLS segment, or the static TCB when it has no thread-locals.
+pub(crate) unsafe fn init_main_thread(auxv: *const u64) {
     // Only initialize once
     if MAIN_TLS_INITIALIZED
         .compare_exchange(0, 1, Ordering::SeqCst, Ordering::SeqCst)
@@ -756,34 +855,58 @@ pub unsafe extern "C" fn __nrlib_init_main_thread_tls() {
     {
         return;
     }
+    super::env::set_auxv(auxv);
+
+    let tcb_size = mem::size_of::<ThreadControlBlock>();
+    let mut tcb_ptr = ptr::addr_of_mut!(MAIN_THREAD_TCB.tcb);
+    let mut dtv = ptr::null_mut();
+    let mut fs_ready = false;
+    match super::tls::init(auxv) {
+        Some(block) if block.tcb_size >= tcb_size => {
+            tcb_ptr = block.tp as *mut ThreadControlBlock;
+            dtv = (*tcb_ptr).dtv;
+            fs_ready = true;
+        }
+        _ if super::tls::size() > 0 => {
+            let align = super::tls::align();
+            let len = super::tls::size() + align + tcb_size;
+            let block = crate::syscall6(
+                crate::SYS_MMAP,
+                0,
+                len as u64,
+                (super::types::PROT_READ | super::types::PROT_WRITE) as u64,
+                (super::types::MAP_PRIVATE | super::types::MAP_ANONYMOUS) as u64,
+                u64::MAX,
+                0,
+            );
+            if block != u64::MAX && block != 0 {
+                let tp = (block as usize + super::tls::size() + align - 1) & !(align - 1);
+                super::tls::install(tp as *mut u8);
+                tcb_ptr = tp as *mut ThreadControlBlock;
+            }
+        }
+        _ => {}
+    }
 
-    // Get pointer to the static TCB storage
-    let tcb_ptr = &mut MAIN_THREAD_TCB.tcb as *mut ThreadControlBlock;
-
-    // Initialize self-pointer (critical for %fs:0 access)
+    ptr::write(tcb_ptr, ThreadControlBlock::new(main_thread_dummy_start));
     (*tcb_ptr).self_ptr = tcb_ptr;
-
-    // Get main thread's TID
+    (*tcb_ptr).dtv = dtv;
     let tid = crate::syscall0(crate::SYS_GETTID) as usize;
     (*tcb_ptr).tid.store(tid, Ordering::SeqCst);
 
-    // Initialize TLS data array to null (critical!)
-    for i in 0..MAX_TLS_KEYS {
-        (*tcb_ptr).tsd[i] = ptr::null_mut();
-    }
-
     // Register in thread table (slot 0 for main thread)
     THREAD_TABLE[0] = Some(tcb_ptr);
 
-    // Set FS base to point to the TCB using arch_prctl
-    // ARCH_SET_FS = 0x1002
-    let ret = crate::syscall2(crate::SYS_ARCH_PRCTL, 0x1002, tcb_ptr as u64);
-    if ret != 0 {
-        // Log error but continue - some operations may still work
-        let msg = b"[nrlib] WARNING: Failed to set FS base for main thread\n";
-        let _ = crate::syscall3(SYS_WRITE_NR, 2, msg.as_ptr() as u64, msg.len() as u64);
+    if !fs_ready {
+        // Set FS base to point to the TCB using arch_prctl
+        // ARCH_SET_FS = 0x1002
+        let ret = crate::syscall2(crate::SYS_ARCH_PRCTL, 0x1002, tcb_ptr as u64);
+        if ret != 0 {
+            let msg = b"[nrlib] WARNING: Failed to set FS base for main thread\n";
+            let _ = crate::syscall3(SYS_WRITE_NR, 2, msg.as_ptr() as u64, msg.len() as u64);
+        }
     }
-    
+
     // Verify FS base was set correctly
     let fs_check: u64;
     core::arch::asm!("mov {}, fs:0", out(reg) fs_check, options(nostack, preserves_flags, readonly));
@@ -791,8 +914,7 @@ pub unsafe extern "C" fn __nrlib_init_main_thread_tls() {
         let msg = b"[nrlib] ERROR: FS base mismatch after init\n";
         let _ = crate::syscall3(SYS_WRITE_NR, 2, msg.as_ptr() as u64, msg.len() as u64);
     } else {
-        let msg = b"[nrlib] TLS init success\n";
-        let _ = crate::syscall3(SYS_WRITE_NR, 2, msg.as_ptr() as u64, msg.len() as u64);
+        MAIN_TLS_INITIALIZED.store(2, Ordering::Release);
     }
 }
 
@@ -814,6 +936,12 @@ pub unsafe fn get_current_tcb() -> Option<*mut ThreadControlBlock> {
     }
 }
 
+/// This thread's errno slot
+#[inline(always)]
+pub(crate) unsafe fn errno_location(tcb: *mut ThreadControlBlock) -> *mut i32 {
+    ptr::addr_of_mut!((*tcb).errno_val)
+}
+
 // ============================================================================
 // __tls_get_addr - General Dynamic TLS Access
 // ============================================================================
@@ -829,16 +957,19 @@ pub struct TlsIndex {
 }
 
 /// Get the address of a thread-local variable.
-/// 
+///
 /// This is the General Dynamic TLS model accessor function.
 /// Called by code using @tlsgd relocations for dynamic TLS access.
-/// 
+/// Under ld-nrlib the linker's own builtin takes precedence; both resolve
+/// through the static layout, so the address is the thread pointer plus
+/// the module's fixed offset.
+///
 /// # Safety
 /// The TLS index must be valid and point to an initialized TLS block.
-/// 
+///
 /// # Parameters
 /// - `ti`: Pointer to TLS index containing module ID and offset
-/// 
+///
 /// # Returns
 /// Pointer to the thread-local variable
 #[no_mangle]
@@ -846,52 +977,12 @@ pub unsafe extern "C" fn __tls_get_addr(ti: *const TlsIndex) -> *mut c_void {
     if ti.is_null() {
         return ptr::null_mut();
     }
-    
-    let ti = &*ti;
-    
-    // Get the current thread's TCB
-    if let Some(tcb) = get_current_tcb() {
-        // Get the DTV (Dynamic Thread Vector)
-        let dtv = (*tcb).dtv;
-        
-        if !dtv.is_null() {
-            // DTV layout (musl-style):
-            //   dtv[0] = generation counter
-            //   dtv[module_id] = pointer to TLS block for that module
-            //
-            // For simplicity in our implementation:
-            // - Module 1 (main executable) uses static TLS via TP
-            // - Module 2+ (shared libraries) would need dynamic allocation
-            
-            if ti.ti_module == 0 {
-                // Module 0 is invalid
-                return ptr::null_mut();
-            }
-            
-            // For static TLS (most common case), compute address directly
-            // Static TLS is stored at negative offsets from TP (fs:0)
-            if ti.ti_module == 1 {
-                // Main executable's TLS - use TP-relative addressing
-                // TLS is at negative offset from thread pointer
-                let tp = tcb as *mut u8;
-                return tp.wrapping_sub(ti.ti_offset) as *mut c_void;
-            }
-            
-            // For dynamic TLS (shared libraries), lookup in DTV
-            let tls_block = *dtv.add(ti.ti_module);
-            if tls_block != 0 {
-                return (tls_block as *mut u8).add(ti.ti_offset) as *mut c_void;
-            }
-        }
-        
-        // Fallback for static TLS when DTV is not set up
-        // Use direct negative offset from TP
-        let tp = tcb as *mut u8;
-        return tp.wrapping_sub(ti.ti_offset) as *mut c_void;
-    }
-    
-    // No TCB available - this shouldn't happen in properly initialized programs
-    ptr::null_mut()
+
+    match get_current_tcb() {
+        Some(tcb) => super::tls::module_address(tcb as *mut u8, (*ti).ti_module, (*ti).ti_offset),
+        // No TCB available - this shouldn't happen in properly initialized programs
+        None => ptr::null_mut(),
+    }
 }
 
 /// Get TLS data for the current thread at the given key index.
@@ -920,187 +1011,275 @@ pub unsafe fn set_thread_tls_data(key: usize, value: *mut c_void) -> bool {
     false
 }
 
-/// Allocate a thread slot
-unsafe fn alloc_thread_slot(tcb: *mut ThreadControlBlock) -> Option<usize> {
-    // Acquire lock
+fn lock_thread_table() {
     while THREAD_TABLE_LOCK
         .compare_exchange(0, 1, Ordering::Acquire, Ordering::Relaxed)
         .is_err()
     {
         spin_loop();
     }
+}
 
+fn unlock_thread_table() {
+    THREAD_TABLE_LOCK.store(0, Ordering::Release);
+}
+
+/// Allocate a thread slot
+unsafe fn alloc_thread_slot(tcb: *mut ThreadControlBlock) -> Option<usize> {
+    lock_thread_table();
     for i in 0..MAX_THREADS {
         if THREAD_TABLE[i].is_none() {
             THREAD_TABLE[i] = Some(tcb);
-            THREAD_TABLE_LOCK.store(0, Ordering::Release);
+            unlock_thread_table();
             return Some(i);
         }
     }
-
-    THREAD_TABLE_LOCK.store(0, Ordering::Release);
+    unlock_thread_table();
     None
 }
 
 /// Free a thread slot
 unsafe fn free_thread_slot(slot: usize) {
-    while THREAD_TABLE_LOCK
-        .compare_exchange(0, 1, Ordering::Acquire, Ordering::Relaxed)
-        .is_err()
-    {
-        spin_loop();
-    }
-
+    lock_thread_table();
     if slot < MAX_THREADS {
         THREAD_TABLE[slot] = None;
     }
-
-    THREAD_TABLE_LOCK.store(0, Ordering::Release);
+    unlock_thread_table();
 }
 
-/// Thread entry point - called by clone when ret == 0 (child thread)
-/// This function never returns; it calls the user's start routine and then exits.
-#[no_mangle]
-pub unsafe extern "C" fn __thread_entry() -> ! {
-    // Get TLS/TCB pointer from FS base
-    let tcb_ptr: *mut ThreadControlBlock;
-    core::arch::asm!(
-        "mov {}, fs:0",
-        out(reg) tcb_ptr,
-        options(nostack, preserves_flags)
-    );
-
-    let msg = b"[nrlib] __thread_entry: starting thread\n";
-    let _ = crate::syscall3(SYS_WRITE_NR, 2, msg.as_ptr() as u64, msg.len() as u64);
+/// Slot of the thread `thread` (a TCB pointer) if it is one of ours
+unsafe fn find_thread(thread: pthread_t) -> Option<usize> {
+    lock_thread_table();
+    let slot = (0..MAX_THREADS)
+        .find(|&i| THREAD_TABLE[i].map_or(false, |tcb| tcb as pthread_t == thread));
+    unlock_thread_table();
+    slot
+}
 
-    // Debug: print tcb_ptr
-    let msg = b"[nrlib] __thread_entry: tcb_ptr=0x";
-    let _ = crate::syscall3(SYS_WRITE_NR, 2, msg.as_ptr() as u64, msg.len() as u64);
-    print_hex_u64(tcb_ptr as u64);
-    let _ = crate::syscall3(SYS_WRITE_NR, 2, b"\n".as_ptr() as u64, 1);
+// ============================================================================
+// Thread Blocks and the Stack Cache
+// ============================================================================
+//
+// Each thread runs in one anonymous mapping:
+//
+//   +---------------------+ <- base + len
+//   |  Thread Control     |
+//   |  Block (TCB)        |
+//   +---------------------+ <- thread pointer (FS base), TLS-aligned
+//   |  Static TLS data    |
+//   +---------------------+ <- initial stack pointer
+//   |  Thread stack       |
+//   |  (grows downward)   |
+//   +---------------------+ <- base + guard
+//   |  Guard page(s)      |
+//   +---------------------+ <- base
+//
+// Joined and detached threads hand their mapping to a small cache, so a
+// worker pool creates threads without mmap/munmap round trips.
+
+#[derive(Clone, Copy)]
+struct CachedBlock {
+    /// Mapping base; 0 marks a free slot
+    base: usize,
+    len: usize,
+    guard: usize,
+    /// A detached thread's TID word, which the kernel zeroes once the
+    /// thread is off the stack; null if the block is idle already
+    busy: *const AtomicU32,
+}
+
+impl CachedBlock {
+    const EMPTY: Self = Self {
+        base: 0,
+        len: 0,
+        guard: 0,
+        busy: ptr::null(),
+    };
 
-    if tcb_ptr.is_null() {
-        let msg = b"[nrlib] __thread_entry: ERROR tcb_ptr is NULL!\n";
-        let _ = crate::syscall3(SYS_WRITE_NR, 2, msg.as_ptr() as u64, msg.len() as u64);
-        crate::syscall1(crate::SYS_EXIT, 1);
-        loop {
-            spin_loop();
-        }
+    unsafe fn idle(&self) -> bool {
+        self.busy.is_null() || (*self.busy).load(Ordering::Acquire) == 0
     }
+}
 
-    // Debug: dump raw TCB memory to verify offsets
-    {
-        let msg = b"[nrlib] __thread_entry: dumping TCB offsets\n";
-        let _ = crate::syscall3(SYS_WRITE_NR, 2, msg.as_ptr() as u64, msg.len() as u64);
-
-        // Read raw bytes at each offset
-        let base = tcb_ptr as *const u8;
-
-        // Offset 64 (start_routine)
-        let msg = b"[nrlib] offset64=0x";
-        let _ = crate::syscall3(SYS_WRITE_NR, 2, msg.as_ptr() as u64, msg.len() as u64);
-        let val64 = *(base.add(64) as *const u64);
-        print_hex_u64(val64);
-        let _ = crate::syscall3(SYS_WRITE_NR, 2, b"\n".as_ptr() as u64, 1);
+static mut STACK_CACHE: [CachedBlock; STACK_CACHE_SLOTS] = [CachedBlock::EMPTY; STACK_CACHE_SLOTS];
+static STACK_CACHE_LOCK: AtomicUsize = AtomicUsize::new(0);
 
-        // Offset 72 (arg)
-        let msg = b"[nrlib] offset72=0x";
-        let _ = crate::syscall3(SYS_WRITE_NR, 2, msg.as_ptr() as u64, msg.len() as u64);
-        let val72 = *(base.add(72) as *const u64);
-        print_hex_u64(val72);
-        let _ = crate::syscall3(SYS_WRITE_NR, 2, b"\n".as_ptr() as u64, 1);
-
-        // Print actual field addresses using offset_of would be ideal, but let's use ptr math
-        let msg = b"[nrlib] &tcb.start_routine offset=";
-        let _ = crate::syscall3(SYS_WRITE_NR, 2, msg.as_ptr() as u64, msg.len() as u64);
-        let tcb = &*tcb_ptr;
-        let start_offset = (&tcb.start_routine as *const _ as usize) - (tcb_ptr as usize);
-        print_hex_u64(start_offset as u64);
-        let _ = crate::syscall3(SYS_WRITE_NR, 2, b"\n".as_ptr() as u64, 1);
-
-        let msg = b"[nrlib] &tcb.arg offset=";
-        let _ = crate::syscall3(SYS_WRITE_NR, 2, msg.as_ptr() as u64, msg.len() as u64);
-        let arg_offset = (&tcb.arg as *const _ as usize) - (tcb_ptr as usize);
-        print_hex_u64(arg_offset as u64);
-        let _ = crate::syscall3(SYS_WRITE_NR, 2, b"\n".as_ptr() as u64, 1);
+fn lock_stack_cache() {
+    while STACK_CACHE_LOCK
+        .compare_exchange(0, 1, Ordering::Acquire, Ordering::Relaxed)
+        .is_err()
+    {
+        spin_loop();
     }
+}
 
-    let tcb = &mut *tcb_ptr;
+fn unlock_stack_cache() {
+    STACK_CACHE_LOCK.store(0, Ordering::Release);
+}
 
-    // Debug: print start_routine
-    {
-        let msg: &[u8] = b"[nrlib] __thread_entry: start_routine=0x";
-        let _ = crate::syscall3(SYS_WRITE_NR, 2, msg.as_ptr() as u64, msg.len() as u64);
-        print_hex_u64(tcb.start_routine as u64);
-        let newline: &[u8] = b"\n";
-        let _ = crate::syscall3(
-            SYS_WRITE_NR,
-            2,
-            newline.as_ptr() as u64,
-            newline.len() as u64,
-        );
+/// Take an idle cached block of exactly this shape
+unsafe fn take_cached_block(len: usize, guard: usize) -> Option<usize> {
+    lock_stack_cache();
+    let cache = &mut *ptr::addr_of_mut!(STACK_CACHE);
+    let mut found = None;
+    for entry in cache.iter_mut() {
+        if entry.base != 0 && entry.len == len && entry.guard == guard && entry.idle() {
+            found = Some(entry.base);
+            *entry = CachedBlock::EMPTY;
+            break;
+        }
     }
+    unlock_stack_cache();
+    found
+}
 
-    // Debug: print arg
-    {
-        let msg: &[u8] = b"[nrlib] __thread_entry: arg=0x";
-        let _ = crate::syscall3(SYS_WRITE_NR, 2, msg.as_ptr() as u64, msg.len() as u64);
-        print_hex_u64(tcb.arg as u64);
-        let newline: &[u8] = b"\n";
-        let _ = crate::syscall3(
-            SYS_WRITE_NR,
-            2,
-            newline.as_ptr() as u64,
-            newline.len() as u64,
-        );
+/// Give a thread's block back, to the cache when there is room
+///
+/// `busy` is the exiting thread's TID word when it releases its own block.
+/// A block still in use is never unmapped: if the cache is full of those,
+/// it is dropped (leaked) instead.
+unsafe fn release_thread_block(base: usize, len: usize, guard: usize, busy: *const AtomicU32) {
+    let mut unmap = None;
+    lock_stack_cache();
+    let cache = &mut *ptr::addr_of_mut!(STACK_CACHE);
+    let slot = match cache.iter().position(|e| e.base == 0) {
+        Some(idx) => Some(idx),
+        None => match cache.iter().position(|e| e.idle()) {
+            // Evict an idle block to make room
+            Some(idx) => {
+                unmap = Some((cache[idx].base, cache[idx].len));
+                Some(idx)
+            }
+            None => {
+                if busy.is_null() {
+                    unmap = Some((base, len));
+                }
+                None
+            }
+        },
+    };
+    if let Some(idx) = slot {
+        cache[idx] = CachedBlock {
+            base,
+            len,
+            guard,
+            busy,
+        };
     }
+    unlock_stack_cache();
 
-    // Call the user's start routine
-    {
-        let msg: &[u8] = b"[nrlib] __thread_entry: calling start_routine at 0x";
-        let _ = crate::syscall3(SYS_WRITE_NR, 2, msg.as_ptr() as u64, msg.len() as u64);
-        print_hex_u64(tcb.start_routine as u64);
-        let msg: &[u8] = b" with arg 0x";
-        let _ = crate::syscall3(SYS_WRITE_NR, 2, msg.as_ptr() as u64, msg.len() as u64);
-        print_hex_u64(tcb.arg as u64);
-        let _ = crate::syscall3(SYS_WRITE_NR, 2, b"\n".as_ptr() as u64, 1);
+    if let Some((base, len)) = unmap {
+        crate::syscall2(crate::SYS_MUNMAP, base as u64, len as u64);
     }
+}
 
-    // Actually call the start routine
-    let start_fn = tcb.start_routine;
-    let start_arg = tcb.arg;
-    let retval = (start_fn)(start_arg);
+/// Map (or reuse) a block for a thread with `stack_size` bytes of stack
+unsafe fn alloc_thread_block(stack_size: usize, guard: usize) -> Option<(usize, usize)> {
+    let tls_align = super::tls::align();
+    let len = (guard
+        + stack_size
+        + super::tls::size()
+        + tls_align
+        + mem::size_of::<ThreadControlBlock>()
+        + PAGE_SIZE
+        - 1)
+        & !(PAGE_SIZE - 1);
 
-    // We reached here - thread function returned
-    {
-        let msg: &[u8] = b"[nrlib] __thread_entry: start_routine returned 0x";
-        let _ = crate::syscall3(SYS_WRITE_NR, 2, msg.as_ptr() as u64, msg.len() as u64);
-        print_hex_u64(retval as u64);
-        let _ = crate::syscall3(SYS_WRITE_NR, 2, b"\n".as_ptr() as u64, 1);
+    if let Some(base) = take_cached_block(len, guard) {
+        return Some((base, len));
     }
 
-    tcb.retval = retval;
+    let base = crate::syscall6(
+        crate::SYS_MMAP,
+        0,
+        len as u64,
+        (super::types::PROT_READ | super::types::PROT_WRITE) as u64,
+        (super::types::MAP_PRIVATE | super::types::MAP_ANONYMOUS) as u64,
+        u64::MAX, // -1 for anonymous
+        0,
+    );
+    if base == u64::MAX || base == 0 {
+        return None;
+    }
+    if guard > 0 {
+        // Best effort: an overflow faults instead of running into the heap
+        crate::syscall3(crate::SYS_MPROTECT, base, guard as u64, 0);
+    }
+    Some((base as usize, len))
+}
 
-    // Mark as exited
-    tcb.exited.store(1, Ordering::Release);
+/// Thread pointer inside a block: just below the TCB, TLS-aligned
+fn block_thread_pointer(base: usize, len: usize) -> usize {
+    let align = super::tls::align();
+    (base + len - mem::size_of::<ThreadControlBlock>()) & !(align - 1)
+}
 
-    // Wake any threads waiting to join
-    if !tcb.tid_address.is_null() {
-        // Clear the tid address
-        *tcb.tid_address = 0;
-        // Wake waiters (futex wake)
+/// Wait until the kernel has cleared the thread's TID (it has left its stack)
+unsafe fn wait_for_exit(tcb: *mut ThreadControlBlock) {
+    let word = (*tcb).tid_word();
+    loop {
+        let tid = (*word).load(Ordering::Acquire);
+        if tid == 0 {
+            return;
+        }
         crate::syscall6(
             crate::SYS_FUTEX,
-            tcb.tid_address as u64,
-            super::types::FUTEX_WAKE_OP as u64,
-            i32::MAX as u64, // Wake all waiters
-            0,
+            word as u64,
+            super::types::FUTEX_WAIT_OP as u64,
+            tid as u64,
+            0, // No timeout
             0,
             0,
         );
     }
+}
+
+/// Collect an exited thread: free its slot and recycle its block
+unsafe fn reap_thread(tcb: *mut ThreadControlBlock, slot: usize) {
+    wait_for_exit(tcb);
+    let (base, len, guard) = (
+        (*tcb).stack_base as usize,
+        (*tcb).stack_size,
+        (*tcb).guard_size,
+    );
+    free_thread_slot(slot);
+    release_thread_block(base, len, guard, ptr::null());
+}
 
-    // Exit thread (not process)
+/// Run the thread's exit-time destructors and end it
+unsafe fn finish_thread(tcb: *mut ThreadControlBlock, retval: *mut c_void) -> ! {
+    (*tcb).retval = retval;
+
+    crate::run_thread_exit_destructors(tcb);
+
+    // Hand cached heap objects back before the block can be reused
+    crate::malloc::thread_exit();
+
+    if (*tcb).stack_size != 0
+        && (*tcb)
+            .exited
+            .compare_exchange(
+                THREAD_RUNNING,
+                THREAD_EXITED,
+                Ordering::AcqRel,
+                Ordering::Acquire,
+            )
+            .is_err()
+    {
+        // Detached: nobody joins, so recycle our own block. It stays busy
+        // in the cache until the kernel clears our TID after we exit.
+        if let Some(slot) = find_thread(tcb as pthread_t) {
+            free_thread_slot(slot);
+        }
+        release_thread_block(
+            (*tcb).stack_base as usize,
+            (*tcb).stack_size,
+            (*tcb).guard_size,
+            (*tcb).tid_word(),
+        );
+    }
+
+    // Exit thread (not process); the kernel clears tid and wakes joiners
     crate::syscall1(crate::SYS_EXIT, 0);
 
     // Should never reach here
@@ -1109,6 +1288,15 @@ pub unsafe extern "C" fn __thread_entry() -> ! {
     }
 }
 
+/// First Rust frame of every new thread (entered from __nrlib_clone)
+extern "C" fn thread_start(arg: *mut c_void) -> c_int {
+    unsafe {
+        let tcb = arg as *mut ThreadControlBlock;
+        let retval = ((*tcb).start_routine)((*tcb).arg);
+        finish_thread(tcb, retval)
+    }
+}
+
 /// Create a new thread
 #[no_mangle]
 pub unsafe extern "C" fn pthread_create(
@@ -1117,119 +1305,49 @@ pub unsafe extern "C" fn pthread_create(
     start_routine: extern "C" fn(*mut c_void) -> *mut c_void,
     arg: *mut c_void,
 ) -> c_int {
-    let msg = b"[nrlib] pthread_create called\n";
-    let _ = crate::syscall3(SYS_WRITE_NR, 2, msg.as_ptr() as u64, msg.len() as u64);
-
     if thread.is_null() {
         return crate::EINVAL;
     }
 
-    // Get stack size from attributes or use default
-    let stack_size = if !attr.is_null() {
-        DEFAULT_STACK_SIZE // TODO: parse from attr
+    // Get stack size, guard and detach state from attributes or use defaults
+    let (stack_size, guard, detached) = if attr.is_null() {
+        (DEFAULT_STACK_SIZE, STACK_GUARD_SIZE, false)
     } else {
-        DEFAULT_STACK_SIZE
+        let words = &(*attr).__size;
+        let stack_size = match words[ATTR_STACKSIZE] as usize {
+            0 => DEFAULT_STACK_SIZE,
+            size => size,
+        };
+        let guard = (words[ATTR_GUARDSIZE] as usize + PAGE_SIZE - 1) & !(PAGE_SIZE - 1);
+        (
+            stack_size,
+            guard,
+            words[ATTR_DETACHSTATE] as c_int == PTHREAD_CREATE_DETACHED,
+        )
     };
 
-    let total_stack = stack_size + STACK_GUARD_SIZE;
-
-    // Allocate stack using mmap
-    let stack = crate::syscall6(
-        crate::SYS_MMAP,
-        0,
-        total_stack as u64,
-        (super::types::PROT_READ | super::types::PROT_WRITE) as u64,
-        (super::types::MAP_PRIVATE | super::types::MAP_ANONYMOUS) as u64,
-        u64::MAX, // -1 for anonymous
-        0,
-    );
-
-    // Debug: print mmap result
-    let msg = b"[nrlib] pthread_create: mmap returned stack=0x";
-    let _ = crate::syscall3(SYS_WRITE_NR, 2, msg.as_ptr() as u64, msg.len() as u64);
-    print_hex_u64(stack);
-    let _ = crate::syscall3(SYS_WRITE_NR, 2, b"\n".as_ptr() as u64, 1);
-
-    if stack == u64::MAX || stack == 0 {
-        let msg = b"[nrlib] pthread_create: mmap failed\n";
-        let _ = crate::syscall3(SYS_WRITE_NR, 2, msg.as_ptr() as u64, msg.len() as u64);
-        return crate::ENOMEM;
-    }
-
-    // Calculate TCB location at top of stack
-    // Stack layout (high to low):
-    //   +---------------------+ <- stack + total_stack
-    //   |  Thread Control     |
-    //   |  Block (TCB)        |
-    //   +---------------------+ <- tcb_addr
-    //   |  [padding]          |
-    //   +---------------------+ <- child_stack (16-byte aligned)
-    //   |                     |
-    //   |  Thread stack       |
-    //   |  (grows downward)   |
-    //   |                     |
-    //   +---------------------+ <- stack + STACK_GUARD_SIZE
-    //   |  Guard page         |
-    //   +---------------------+ <- stack
-
-    let stack_top = stack + total_stack as u64;
-    let tcb_size = mem::size_of::<ThreadControlBlock>() as u64;
-    let tcb_addr = (stack_top - tcb_size) & !0xF; // 16-byte aligned
-    let tcb_ptr = tcb_addr as *mut ThreadControlBlock;
-
-    // Debug: print tcb_addr
-    let msg = b"[nrlib] pthread_create: tcb_addr=0x";
-    let _ = crate::syscall3(SYS_WRITE_NR, 2, msg.as_ptr() as u64, msg.len() as u64);
-    print_hex_u64(tcb_addr);
-    let _ = crate::syscall3(SYS_WRITE_NR, 2, b"\n".as_ptr() as u64, 1);
+    let (base, len) = match alloc_thread_block(stack_size, guard) {
+        Some(block) => block,
+        None => return crate::EAGAIN,
+    };
 
-    // Initialize TCB
+    // Initialize TCB and the static TLS below it
+    let tp = block_thread_pointer(base, len);
+    let tcb_ptr = tp as *mut ThreadControlBlock;
+    ptr::write(tcb_ptr, ThreadControlBlock::new(start_routine));
     let tcb = &mut *tcb_ptr;
     tcb.self_ptr = tcb_ptr; // Self pointer for TLS access (%fs:0)
-    tcb.dtv = ptr::null_mut(); // No dynamic TLS for now
-    tcb.prev = ptr::null_mut();
-    tcb.next = ptr::null_mut();
-    tcb.sysinfo = 0;
-    tcb.start_routine = start_routine;
     tcb.arg = arg;
-    tcb.retval = ptr::null_mut();
-    tcb.stack_base = stack as *mut c_void;
-    tcb.stack_size = total_stack;
-    tcb.tid = AtomicUsize::new(0);
-    tcb.errno_val = 0;
-    tcb.flags = 1; // joinable = true, detached = false
-    tcb.exited = AtomicUsize::new(0);
-    tcb.tid_address = ptr::null_mut();
-    tcb.canary = 0; // TODO: randomize for security
-    tcb.tsd_used = false;
-    tcb._pad = [0; 7];
-    // CRITICAL: Initialize TLS data array to null pointers
-    // Without this, TLS access in new threads would return garbage values
-    for i in 0..MAX_TLS_KEYS {
-        tcb.tsd[i] = ptr::null_mut();
-    }
-
-    // Debug: verify we stored arg correctly
-    {
-        let msg = b"[nrlib] pthread_create: arg stored=0x";
-        let _ = crate::syscall3(SYS_WRITE_NR, 2, msg.as_ptr() as u64, msg.len() as u64);
-        print_hex_u64(tcb.arg as u64);
-        let _ = crate::syscall3(SYS_WRITE_NR, 2, b"\n".as_ptr() as u64, 1);
-
-        // Print actual offset of arg field
-        let msg = b"[nrlib] pthread_create: &tcb.arg offset=";
-        let _ = crate::syscall3(SYS_WRITE_NR, 2, msg.as_ptr() as u64, msg.len() as u64);
-        let arg_offset = (&tcb.arg as *const _ as usize) - (tcb_ptr as usize);
-        print_hex_u64(arg_offset as u64);
-        let _ = crate::syscall3(SYS_WRITE_NR, 2, b"\n".as_ptr() as u64, 1);
-    }
-
-    // Initialize TLS data to null
-    for i in 0..MAX_TLS_KEYS {
-        tcb.tsd[i] = ptr::null_mut();
+    tcb.stack_base = base as *mut c_void;
+    tcb.stack_size = len;
+    tcb.guard_size = guard;
+    if detached {
+        tcb.set_detached(true);
+        tcb.exited.store(THREAD_DETACHED, Ordering::Relaxed);
     }
+    super::tls::install(tp as *mut u8);
 
-    // Set TID address for CLONE_CHILD_CLEARTID
+    // Set TID address for CLONE_PARENT_SETTID / CLONE_CHILD_CLEARTID
     let tid_storage = &mut tcb.tid as *mut AtomicUsize as *mut c_int;
     tcb.tid_address = tid_storage;
 
@@ -1237,198 +1355,98 @@ pub unsafe extern "C" fn pthread_create(
     let slot = match alloc_thread_slot(tcb_ptr) {
         Some(s) => s,
         None => {
-            // Free the stack
-            crate::syscall2(crate::SYS_MUNMAP, stack, total_stack as u64);
+            release_thread_block(base, len, guard, ptr::null());
             return crate::EAGAIN;
         }
     };
 
-    // Calculate child stack pointer (16-byte aligned, below TCB)
-    // Leave space for a return address (though it won't be used)
-    let child_stack = (tcb_addr - 8) & !0xF;
-
-    // Set up the stack so when the child thread starts, __thread_entry gets called
-    // Put the return address (entry point) on the stack
-    let stack_frame = child_stack as *mut u64;
-    *stack_frame = __thread_entry as u64; // Return address
-
-    let msg = b"[nrlib] pthread_create: calling clone\n";
-    let _ = crate::syscall3(SYS_WRITE_NR, 2, msg.as_ptr() as u64, msg.len() as u64);
-
-    // Clone flags for thread creation
-    let clone_flags = CLONE_THREAD_FLAGS as u64;
-
-    // Call clone syscall
-    // Arguments:
-    //   - flags: CLONE_VM | CLONE_FS | CLONE_FILES | CLONE_SIGHAND | CLONE_THREAD | ...
-    //   - stack: child_stack (will be used as RSP)
-    //   - parent_tid: not used (NULL)
-    //   - child_tid: address to store TID and clear on exit
-    //   - tls: TCB address (set as FS base)
-    let ret = crate::syscall5(
-        crate::SYS_CLONE,
-        clone_flags,
-        child_stack,
-        0,                  // parent_tid - not needed
-        tid_storage as u64, // child_tid for CLONE_CHILD_CLEARTID
-        tcb_addr,           // TLS pointer = TCB address
+    // The stack starts right below the TLS data
+    let stack_top = tp - super::tls::size();
+    let ret = super::clone::__clone(
+        thread_start,
+        stack_top as *mut c_void,
+        CLONE_THREAD_FLAGS,
+        tcb_ptr as *mut c_void,
+        tid_storage,
+        tcb_ptr as *mut c_void,
+        tid_storage,
     );
 
-    if ret == u64::MAX || ret as i64 == -1 {
-        let msg = b"[nrlib] pthread_create: clone failed\n";
-        let _ = crate::syscall3(SYS_WRITE_NR, 2, msg.as_ptr() as u64, msg.len() as u64);
-        // Clean up
+    if ret < 0 {
         free_thread_slot(slot);
-        crate::syscall2(crate::SYS_MUNMAP, stack, total_stack as u64);
-        crate::refresh_errno_from_kernel();
+        release_thread_block(base, len, guard, ptr::null());
         return crate::EAGAIN;
     }
 
-    if ret == 0 {
-        // We are the child thread!
-        // This code path should not execute in the parent's flow.
-        // The child will start with a fresh stack and should call __thread_entry.
-        // However, because clone() returns here, we need to jump to the entry point.
-        __thread_entry();
-        // Never returns
-    }
-
-    // Parent: ret is child TID
-    tcb.tid.store(ret as usize, Ordering::Release);
-    *thread = ret as pthread_t;
-
-    let msg = b"[nrlib] pthread_create: thread created with TID ";
-    let _ = crate::syscall3(SYS_WRITE_NR, 2, msg.as_ptr() as u64, msg.len() as u64);
-
-    // Print TID
-    let mut tid_buf = [0u8; 20];
-    let mut tid_val = ret;
-    let mut i = 0;
-    if tid_val == 0 {
-        tid_buf[0] = b'0';
-        i = 1;
-    } else {
-        while tid_val > 0 && i < 20 {
-            tid_buf[19 - i] = b'0' + (tid_val % 10) as u8;
-            tid_val /= 10;
-            i += 1;
-        }
-    }
-    let tid_str = if ret == 0 {
-        &tid_buf[0..1]
-    } else {
-        &tid_buf[20 - i..20]
-    };
-    let _ = crate::syscall3(
-        SYS_WRITE_NR,
-        2,
-        tid_str.as_ptr() as u64,
-        tid_str.len() as u64,
-    );
-    let _ = crate::syscall3(SYS_WRITE_NR, 2, b"\n".as_ptr() as u64, 1);
-
+    *thread = tcb_ptr as pthread_t;
     0
 }
 
 /// Join a thread
 #[no_mangle]
 pub unsafe extern "C" fn pthread_join(thread: pthread_t, retval: *mut *mut c_void) -> c_int {
-    let msg = b"[nrlib] pthread_join called\n";
-    let _ = crate::syscall3(SYS_WRITE_NR, 2, msg.as_ptr() as u64, msg.len() as u64);
-
-    // Find the thread in our table
-    while THREAD_TABLE_LOCK
-        .compare_exchange(0, 1, Ordering::Acquire, Ordering::Relaxed)
-        .is_err()
-    {
-        spin_loop();
-    }
-
-    let mut found_tcb: *mut ThreadControlBlock = ptr::null_mut();
-    let mut found_slot: usize = MAX_THREADS;
-
-    for i in 0..MAX_THREADS {
-        if let Some(tcb) = THREAD_TABLE[i] {
-            if (*tcb).tid.load(Ordering::Acquire) == thread as usize {
-                found_tcb = tcb;
-                found_slot = i;
-                break;
-            }
-        }
-    }
-
-    THREAD_TABLE_LOCK.store(0, Ordering::Release);
+    let slot = match find_thread(thread) {
+        Some(slot) => slot,
+        None => return crate::ESRCH,
+    };
+    let tcb = thread as *mut ThreadControlBlock;
 
-    if found_tcb.is_null() {
-        return crate::ESRCH;
+    if thread == pthread_self() {
+        return EDEADLK;
     }
-
-    let tcb = &*found_tcb;
-
-    if tcb.is_detached() {
+    if (*tcb).stack_size == 0 || (*tcb).exited.load(Ordering::Acquire) == THREAD_DETACHED {
         return crate::EINVAL;
     }
 
-    // Wait for thread to exit using futex
-    while tcb.exited.load(Ordering::Acquire) == 0 {
-        // Wait on the tid address
-        crate::syscall6(
-            crate::SYS_FUTEX,
-            tcb.tid_address as u64,
-            super::types::FUTEX_WAIT_OP as u64,
-            tcb.tid.load(Ordering::Acquire) as u64,
-            0, // No timeout
-            0,
-            0,
-        );
-    }
+    wait_for_exit(tcb);
 
     // Get return value
     if !retval.is_null() {
-        *retval = (*found_tcb).retval;
+        *retval = (*tcb).retval;
     }
 
-    // Free resources
-    let stack_base = (*found_tcb).stack_base as u64;
-    let stack_size = (*found_tcb).stack_size as u64;
-
-    free_thread_slot(found_slot);
-
-    // Unmap the stack
-    crate::syscall2(crate::SYS_MUNMAP, stack_base, stack_size);
-
+    reap_thread(tcb, slot);
     0
 }
 
 /// Detach a thread
 #[no_mangle]
 pub unsafe extern "C" fn pthread_detach(thread: pthread_t) -> c_int {
-    while THREAD_TABLE_LOCK
-        .compare_exchange(0, 1, Ordering::Acquire, Ordering::Relaxed)
-        .is_err()
-    {
-        spin_loop();
+    let slot = match find_thread(thread) {
+        Some(slot) => slot,
+        None => return crate::ESRCH,
+    };
+    let tcb = thread as *mut ThreadControlBlock;
+    if (*tcb).stack_size == 0 {
+        return crate::EINVAL;
     }
 
-    for i in 0..MAX_THREADS {
-        if let Some(tcb) = THREAD_TABLE[i] {
-            if (*tcb).tid.load(Ordering::Acquire) == thread as usize {
-                (*tcb).set_detached(true);
-                THREAD_TABLE_LOCK.store(0, Ordering::Release);
-                return 0;
-            }
+    match (*tcb).exited.compare_exchange(
+        THREAD_RUNNING,
+        THREAD_DETACHED,
+        Ordering::AcqRel,
+        Ordering::Acquire,
+    ) {
+        Ok(_) => {
+            (*tcb).set_detached(true);
+            0
         }
+        // Already finished: nobody else will collect it
+        Err(THREAD_EXITED) => {
+            reap_thread(tcb, slot);
+            0
+        }
+        Err(_) => crate::EINVAL,
     }
-
-    THREAD_TABLE_LOCK.store(0, Ordering::Release);
-    crate::ESRCH
 }
 
 /// Exit current thread
 #[no_mangle]
 pub unsafe extern "C" fn pthread_exit(retval: *mut c_void) -> ! {
-    // TODO: Find current thread's TCB and set return value
-    // For now, just exit
+    if let Some(tcb) = get_current_tcb() {
+        finish_thread(tcb, retval);
+    }
+    crate::malloc::thread_exit();
     crate::syscall1(crate::SYS_EXIT, 0);
     loop {
         spin_loop();
@@ -1456,12 +1474,28 @@ pub unsafe extern "C" fn pthread_self() -> pthread_t {
     }
 }
 
+/// Report a thread's stack; the main thread's is unknown (all zero)
 #[no_mangle]
-pub unsafe extern "C" fn pthread_getattr_np(
-    _thread: pthread_t,
-    _attr: *mut pthread_attr_t,
-) -> c_int {
+pub unsafe extern "C" fn pthread_getattr_np(thread: pthread_t, attr: *mut pthread_attr_t) -> c_int {
     trace_fn!("pthread_getattr_np");
+    if attr.is_null() {
+        return crate::EINVAL;
+    }
+    (*attr).__size = [0; 7];
+
+    if find_thread(thread).is_some() {
+        let tcb = thread as *const ThreadControlBlock;
+        if (*tcb).stack_size != 0 {
+            let low = (*tcb).stack_base as usize + (*tcb).guard_size;
+            let high = thread as usize - super::tls::size();
+            (*attr).__size[ATTR_STACKADDR] = low as u64;
+            (*attr).__size[ATTR_STACKSIZE] = (high - low) as u64;
+            (*attr).__size[ATTR_GUARDSIZE] = (*tcb).guard_size as u64;
+            if (*tcb).exited.load(Ordering::Relaxed) == THREAD_DETACHED {
+                (*attr).__size[ATTR_DETACHSTATE] = PTHREAD_CREATE_DETACHED as u64;
+            }
+        }
+    }
     0
 }
 
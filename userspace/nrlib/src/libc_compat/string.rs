@@ -364,68 +364,41 @@ pub unsafe extern "C" fn strncmp(s1: *const c_char, s2: *const c_char, n: size_t
 }
 
 /// Get string length
-/// NOTE: We use volatile reads to prevent the compiler from "optimizing"
-/// this into a call to strnlen (which would cause infinite recursion).
 #[no_mangle]
 #[inline(never)]
 pub unsafe extern "C" fn strnlen(s: *const c_char, maxlen: size_t) -> size_t {
     if s.is_null() {
         return 0;
     }
-
-    let mut len = 0;
-    while len < maxlen && core::ptr::read_volatile(s.add(len)) != 0 {
-        len += 1;
-    }
-    len
+    crate::memops::memchr(s as *const u8, 0, maxlen).unwrap_or(maxlen)
 }
 
 /// Find character in string
-/// NOTE: We use volatile reads to prevent compiler optimization.
 #[no_mangle]
 #[inline(never)]
 pub unsafe extern "C" fn strchr(s: *const c_char, c: c_int) -> *mut c_char {
     if s.is_null() {
         return ptr::null_mut();
     }
-
-    let c = c as u8;
-    let mut i = 0usize;
-    loop {
-        let ch = core::ptr::read_volatile(s.add(i)) as u8;
-        if ch == c {
-            return s.add(i) as *mut c_char;
-        }
-        if ch == 0 {
-            return ptr::null_mut();
-        }
-        i += 1;
+    match crate::memops::strchr(s as *const u8, c as u8) {
+        Some(i) => s.add(i) as *mut c_char,
+        None => ptr::null_mut(),
     }
 }
 
 /// Find last occurrence of character in string
-/// NOTE: We use volatile reads to prevent compiler optimization.
 #[no_mangle]
 #[inline(never)]
 pub unsafe extern "C" fn strrchr(s: *const c_char, c: c_int) -> *mut c_char {
     if s.is_null() {
         return ptr::null_mut();
     }
-
-    let c = c as u8;
-    let mut result: *mut c_char = ptr::null_mut();
-    let mut i = 0usize;
-    loop {
-        let ch = core::ptr::read_volatile(s.add(i)) as u8;
-        if ch == c {
-            result = s.add(i) as *mut c_char;
-        }
-        if ch == 0 {
-            break;
-        }
-        i += 1;
+    // Include the terminator so strrchr(s, 0) finds it
+    let len = crate::memops::strlen(s as *const u8) + 1;
+    match crate::memops::memrchr(s as *const u8, c as u8, len) {
+        Some(i) => s.add(i) as *mut c_char,
+        None => ptr::null_mut(),
     }
-    result
 }
 
 /// Find substring
@@ -508,34 +481,22 @@ pub unsafe extern "C" fn memchr(s: *const c_void, c: c_int, n: size_t) -> *mut c
     if s.is_null() {
         return ptr::null_mut();
     }
-
-    let s = s as *const u8;
-    let c = c as u8;
-    for i in 0..n {
-        if *s.add(i) == c {
-            return s.add(i) as *mut c_void;
-        }
+    match crate::memops::memchr(s as *const u8, c as u8, n) {
+        Some(i) => (s as *const u8).add(i) as *mut c_void,
+        None => ptr::null_mut(),
     }
-    ptr::null_mut()
 }
 
 /// Find character in memory (reverse)
 #[no_mangle]
 pub unsafe extern "C" fn memrchr(s: *const c_void, c: c_int, n: size_t) -> *mut c_void {
-    if s.is_null() || n == 0 {
+    if s.is_null() {
         return ptr::null_mut();
     }
-
-    let s = s as *const u8;
-    let c = c as u8;
-    let mut i = n;
-    while i > 0 {
-        i -= 1;
-        if *s.add(i) == c {
-            return s.add(i) as *mut c_void;
-        }
+    match crate::memops::memrchr(s as *const u8, c as u8, n) {
+        Some(i) => (s as *const u8).add(i) as *mut c_void,
+        None => ptr::null_mut(),
     }
-    ptr::null_mut()
 }
 
 /// Calculate length of initial segment matching characters
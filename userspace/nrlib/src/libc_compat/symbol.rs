@@ -294,10 +294,15 @@ pub unsafe fn lookup_symbol_in_lib(lib: &LoadedLibrary, name: &[u8]) -> Option<S
         .or_else(|| lookup_linear(lib, name, 10000));
 
     result.map(|(sym_idx, sym)| {
-        let addr = if sym.is_defined() {
-            (sym.st_value as i64 + lib.load_bias) as u64
-        } else {
+        let addr = if !sym.is_defined() {
             0
+        } else if sym.symbol_type() == STT_GNU_IFUNC {
+            // The value is a resolver returning this CPU's implementation
+            let resolver: extern "C" fn() -> u64 =
+                core::mem::transmute((sym.st_value as i64 + lib.load_bias) as u64);
+            resolver()
+        } else {
+            (sym.st_value as i64 + lib.load_bias) as u64
         };
 
         SymbolResult {
@@ -0,0 +1,199 @@
+//! Static TLS layout for nrlib threads
+//!
+//! Each thread's block holds every startup module's TLS data below the
+//! thread pointer and the ThreadControlBlock above it. Under ld-nrlib the
+//! layout comes from the linker's `__nrlib_static_tls`, and the main
+//! thread's block already exists; a statically linked program has only its
+//! own PT_TLS segment, found through the auxiliary vector.
+
+use crate::c_void;
+use core::ptr;
+
+use super::elf::{Elf64Phdr, AT_NULL, AT_PHDR, AT_PHNUM, PT_PHDR, PT_TLS};
+
+/// Most modules with TLS we track (ld-nrlib's MAX_TLS_MODULES)
+const MAX_STATIC_TLS_MODULES: usize = 16;
+
+/// Minimum thread pointer alignment (one cache line)
+const TP_ALIGN: usize = 64;
+
+/// One module's initialization image
+#[repr(C)]
+#[derive(Clone, Copy)]
+pub struct StaticTlsImage {
+    pub image: u64,
+    pub filesz: u64,
+    pub memsz: u64,
+    /// Offset of the module's block from the thread pointer
+    pub offset: i64,
+}
+
+impl StaticTlsImage {
+    const fn empty() -> Self {
+        Self {
+            image: 0,
+            filesz: 0,
+            memsz: 0,
+            offset: 0,
+        }
+    }
+}
+
+/// Layout published by ld-nrlib (must match ld-nrlib/src/tls.rs)
+#[repr(C)]
+pub struct StaticTlsLayout {
+    /// Bytes of TLS data below the thread pointer
+    pub size: u64,
+    /// Alignment the thread pointer needs
+    pub align: u64,
+    /// Bytes above the main thread's pointer available for the TCB
+    pub tcb_size: u64,
+    /// Main thread's thread pointer (already in FS), 0 if not set up
+    pub main_tp: u64,
+    /// Number of valid entries in `modules`
+    pub count: u64,
+    pub modules: [StaticTlsImage; MAX_STATIC_TLS_MODULES],
+}
+
+extern "C" {
+    /// Provided by ld-nrlib; null in statically linked programs
+    #[linkage = "extern_weak"]
+    static __nrlib_static_tls: *const StaticTlsLayout;
+}
+
+/// This process's layout, fixed once at startup
+struct Layout {
+    size: usize,
+    align: usize,
+    count: usize,
+    modules: [StaticTlsImage; MAX_STATIC_TLS_MODULES],
+}
+
+static mut LAYOUT: Layout = Layout {
+    size: 0,
+    align: TP_ALIGN,
+    count: 0,
+    modules: [StaticTlsImage::empty(); MAX_STATIC_TLS_MODULES],
+};
+
+fn align_up(value: usize, align: usize) -> usize {
+    (value + align - 1) & !(align - 1)
+}
+
+/// Main thread block the dynamic linker already installed in FS
+pub struct LinkerBlock {
+    /// Thread pointer
+    pub tp: usize,
+    /// Bytes reserved above it for the TCB
+    pub tcb_size: usize,
+}
+
+/// Learn the static TLS layout; `auxv` may be null
+///
+/// Returns the main thread's block when ld-nrlib has already set it up.
+pub unsafe fn init(auxv: *const u64) -> Option<LinkerBlock> {
+    let layout = &mut *ptr::addr_of_mut!(LAYOUT);
+
+    let published = __nrlib_static_tls;
+    if !published.is_null() {
+        let published = &*published;
+        layout.size = published.size as usize;
+        layout.align = (published.align as usize).max(TP_ALIGN);
+        layout.count = (published.count as usize).min(MAX_STATIC_TLS_MODULES);
+        layout.modules[..layout.count].copy_from_slice(&published.modules[..layout.count]);
+        if published.main_tp == 0 {
+            return None;
+        }
+        return Some(LinkerBlock {
+            tp: published.main_tp as usize,
+            tcb_size: published.tcb_size as usize,
+        });
+    }
+
+    if let Some(phdr) = own_tls_segment(auxv) {
+        let align = (phdr.p_align as usize).max(1);
+        // Same offset the static linker gave local-exec accesses
+        let memsz = phdr.p_memsz as usize;
+        let offset = memsz + (0usize.wrapping_sub(phdr.p_vaddr as usize + memsz) & (align - 1));
+        layout.align = align.max(TP_ALIGN);
+        layout.size = align_up(offset, layout.align);
+        layout.count = 1;
+        layout.modules[0] = StaticTlsImage {
+            image: phdr.p_vaddr,
+            filesz: phdr.p_filesz,
+            memsz: phdr.p_memsz,
+            offset: -(offset as i64),
+        };
+    }
+    None
+}
+
+/// The executable's PT_TLS header, with p_vaddr already relocated
+unsafe fn own_tls_segment(auxv: *const u64) -> Option<Elf64Phdr> {
+    if auxv.is_null() {
+        return None;
+    }
+
+    let mut phdr_addr = 0u64;
+    let mut phnum = 0u64;
+    let mut entry = auxv;
+    while *entry != AT_NULL {
+        match *entry {
+            AT_PHDR => phdr_addr = *entry.add(1),
+            AT_PHNUM => phnum = *entry.add(1),
+            _ => {}
+        }
+        entry = entry.add(2);
+    }
+    if phdr_addr == 0 {
+        return None;
+    }
+
+    let phdrs = core::slice::from_raw_parts(phdr_addr as *const Elf64Phdr, phnum as usize);
+    // Static PIE: the headers' own address gives the load bias
+    let bias = phdrs
+        .iter()
+        .find(|p| p.p_type == PT_PHDR)
+        .map_or(0, |p| phdr_addr.wrapping_sub(p.p_vaddr));
+    let mut tls = *phdrs.iter().find(|p| p.p_type == PT_TLS)?;
+    tls.p_vaddr = tls.p_vaddr.wrapping_add(bias);
+    Some(tls)
+}
+
+/// Bytes of TLS data below each thread pointer
+#[inline]
+pub fn size() -> usize {
+    unsafe { (*ptr::addr_of!(LAYOUT)).size }
+}
+
+/// Alignment each thread pointer needs
+#[inline]
+pub fn align() -> usize {
+    unsafe { (*ptr::addr_of!(LAYOUT)).align }
+}
+
+/// Fill the TLS area below `tp` with every module's initial image
+pub unsafe fn install(tp: *mut u8) {
+    let layout = &*ptr::addr_of!(LAYOUT);
+    for module in &layout.modules[..layout.count] {
+        let dst = tp.offset(module.offset as isize);
+        ptr::copy_nonoverlapping(module.image as *const u8, dst, module.filesz as usize);
+        ptr::write_bytes(
+            dst.add(module.filesz as usize),
+            0,
+            (module.memsz - module.filesz) as usize,
+        );
+    }
+}
+
+/// Address of `offset` within module `module_id`'s block for thread `tp`
+#[inline]
+pub unsafe fn module_address(tp: *mut u8, module_id: usize, offset: usize) -> *mut c_void {
+    let layout = &*ptr::addr_of!(LAYOUT);
+    // ld-nrlib numbers modules from 1 in layout order
+    let idx = module_id.wrapping_sub(1);
+    if idx >= layout.count {
+        return ptr::null_mut();
+    }
+    tp.offset(layout.modules[idx].offset as isize).add(offset) as *mut c_void
+}
@@ -0,0 +1,956 @@
+//! Thread-caching size-class allocator behind malloc/free/realloc/calloc
+//!
+//! Three tiers, in the style of TCMalloc:
+//!
+//! - **Thread cache**: every thread keeps a free list per size class, reached
+//!   through its TCB. A malloc or free that hits the list takes no lock and
+//!   does no atomic read-modify-write.
+//! - **Central lists**: one spinlock-protected list per class of spans that
+//!   still have free objects. Thread caches refill from and drain into them
+//!   in batches of up to 64 KiB, so the lock is taken once per batch.
+//! - **Page heap**: page-granular spans carved from the brk heap (and from
+//!   anonymous mappings once brk is exhausted). Freed spans are coalesced
+//!   with free neighbours; once a free span reaches `RELEASE_PAGES` its pages
+//!   are handed back with MADV_FREE.
+//!
+//! Requests above `MAX_SMALL` get a span of their own, and requests from
+//! `MMAP_THRESHOLD` up (or with alignment above a page) get a private mapping
+//! that free() unmaps. A three-level page map from page number to span lets
+//! free() find an object's owner without a per-object header.
+//!
+//! Lock order: central list -> page heap -> metadata.
+
+use crate::c_void;
+use crate::libc_compat::pthread;
+use core::hint::spin_loop;
+use core::mem::size_of;
+use core::ptr;
+use core::sync::atomic::{AtomicBool, AtomicPtr, Ordering};
+
+const PAGE_SHIFT: usize = 12;
+const PAGE_SIZE: usize = 1 << PAGE_SHIFT;
+
+/// Alignment of every block returned by malloc
+const MIN_ALIGN: usize = 16;
+/// Largest request served from a size class
+const MAX_SMALL: usize = 32 * 1024;
+/// Requests of at least this size get a private mapping
+const MMAP_THRESHOLD: usize = 256 * 1024;
+const NUM_CLASSES: usize = 40;
+/// Bytes moved per refill/drain between a thread cache and a central list
+const BATCH_BYTES: usize = 64 * 1024;
+const MAX_BATCH: usize = 32;
+/// Minimum growth of the page heap from brk
+const BRK_GROW: usize = 1024 * 1024;
+/// Minimum growth of the page heap once brk is exhausted
+const MMAP_GROW: usize = 4 * 1024 * 1024;
+/// Free spans of at least this many pages are returned with MADV_FREE
+const RELEASE_PAGES: usize = 256;
+/// Page-heap free lists by exact length; longer spans share the last list
+const EXACT_LISTS: usize = 128;
+/// Spans, page-map nodes and thread caches are carved from chunks this big
+const META_CHUNK: usize = 256 * 1024;
+
+const MADV_FREE: u64 = 8;
+const SYS_SCHED_YIELD: u64 = 24;
+
+// Span kinds; values below NUM_CLASSES are small-object spans of that class
+const SPAN_FREE: u8 = 0xff;
+const SPAN_LARGE: u8 = 0xfe;
+const SPAN_MMAP: u8 = 0xfd;
+const SPAN_UNUSED: u8 = 0xfc;
+
+// ---------------------------------------------------------------------------
+// Size classes
+// ---------------------------------------------------------------------------
+
+#[derive(Clone, Copy)]
+struct ClassInfo {
+    size: usize,
+    /// Pages per span
+    pages: usize,
+    /// Objects per refill/drain
+    batch: usize,
+}
+
+/// 16-byte steps up to 128, then four classes per power of two up to 32 KiB,
+/// which bounds internal fragmentation to 20%. Every power of two is a class
+/// and spans are page aligned, so those classes are naturally aligned.
+const fn build_classes() -> [ClassInfo; NUM_CLASSES] {
+    let mut classes = [ClassInfo {
+        size: 0,
+        pages: 0,
+        batch: 0,
+    }; NUM_CLASSES];
+    let mut class = 0;
+    while class < NUM_CLASSES {
+        let size = if class < 8 {
+            16 * (class + 1)
+        } else {
+            let shift = 7 + (class - 8) / 4;
+            (1 << shift) + ((class - 8) % 4 + 1) * (1 << (shift - 2))
+        };
+        let mut batch = BATCH_BYTES / size;
+        if batch < 2 {
+            batch = 2;
+        } else if batch > MAX_BATCH {
+            batch = MAX_BATCH;
+        }
+        // A span holds at least one batch and eight objects
+        let objects = if batch > 8 { batch } else { 8 };
+        let pages = (objects * size + PAGE_SIZE - 1) / PAGE_SIZE;
+        classes[class] = ClassInfo { size, pages, batch };
+        class += 1;
+    }
+    classes
+}
+
+static CLASSES: [ClassInfo; NUM_CLASSES] = build_classes();
+
+#[inline(always)]
+fn size_class(size: usize) -> usize {
+    if size <= 128 {
+        (size.max(1) - 1) >> 4
+    } else {
+        let s = size - 1;
+        let shift = (usize::BITS - 1 - s.leading_zeros()) as usize;
+        8 + (shift - 7) * 4 + ((s >> (shift - 2)) & 3)
+    }
+}
+
+#[inline(always)]
+fn pages_for(size: usize) -> Option<usize> {
+    Some(size.checked_add(PAGE_SIZE - 1)? >> PAGE_SHIFT)
+}
+
+// ---------------------------------------------------------------------------
+// Locks and raw memory
+// ---------------------------------------------------------------------------
+
+struct SpinLock {
+    locked: AtomicBool,
+}
+
+impl SpinLock {
+    const fn new() -> Self {
+        Self {
+            locked: AtomicBool::new(false),
+        }
+    }
+
+    #[inline]
+    fn lock(&self) {
+        while self
+            .locked
+            .compare_exchange_weak(false, true, Ordering::Acquire, Ordering::Relaxed)
+            .is_err()
+        {
+            let mut spins = 0;
+            while self.locked.load(Ordering::Relaxed) {
+                if spins < 100 {
+                    spins += 1;
+                    spin_loop();
+                } else {
+                    // The holder may be preempted on this CPU
+                    crate::syscall0(SYS_SCHED_YIELD);
+                }
+            }
+        }
+    }
+
+    #[inline]
+    fn unlock(&self) {
+        self.locked.store(false, Ordering::Release);
+    }
+}
+
+unsafe fn map_pages(len: usize) -> usize {
+    let ret = crate::syscall6(
+        crate::SYS_MMAP,
+        0,
+        len as u64,
+        (crate::PROT_READ | crate::PROT_WRITE) as u64,
+        (crate::MAP_PRIVATE | crate::MAP_ANONYMOUS) as u64,
+        u64::MAX,
+        0,
+    );
+    if ret == u64::MAX || ret == 0 {
+        0
+    } else {
+        ret as usize
+    }
+}
+
+unsafe fn unmap_pages(addr: usize, len: usize) {
+    crate::syscall2(crate::SYS_MUNMAP, addr as u64, len as u64);
+}
+
+static META_LOCK: SpinLock = SpinLock::new();
+static mut META_NEXT: usize = 0;
+static mut META_END: usize = 0;
+
+/// Bump-allocate zeroed allocator metadata; never freed
+unsafe fn meta_alloc(size: usize) -> *mut u8 {
+    let size = (size + 63) & !63;
+    META_LOCK.lock();
+    if META_NEXT + size > META_END {
+        let len = size.max(META_CHUNK);
+        let base = map_pages(len);
+        if base == 0 {
+            META_LOCK.unlock();
+            return ptr::null_mut();
+        }
+        META_NEXT = base;
+        META_END = base + len;
+    }
+    let p = META_NEXT;
+    META_NEXT += size;
+    META_LOCK.unlock();
+    p as *mut u8
+}
+
+// ---------------------------------------------------------------------------
+// Spans and the page map
+// ---------------------------------------------------------------------------
+
+#[repr(C)]
+struct FreeObject {
+    next: *mut FreeObject,
+}
+
+/// A run of pages: free, one large block, one mapping, or a slab of objects
+#[repr(C)]
+struct Span {
+    start: usize,
+    npages: usize,
+    next: *mut Span,
+    prev: *mut Span,
+    /// Objects returned to this slab
+    free: *mut FreeObject,
+    /// First never-handed-out object of this slab
+    bump: usize,
+    /// Objects of this slab currently handed out
+    used: usize,
+    kind: u8,
+    /// On its central list
+    on_list: bool,
+    /// Pages untouched since they were mapped or released
+    released: bool,
+}
+
+unsafe fn list_push(head: *mut *mut Span, span: *mut Span) {
+    (*span).prev = ptr::null_mut();
+    (*span).next = *head;
+    if !(*head).is_null() {
+        (**head).prev = span;
+    }
+    *head = span;
+}
+
+unsafe fn list_remove(head: *mut *mut Span, span: *mut Span) {
+    if (*span).prev.is_null() {
+        *head = (*span).next;
+    } else {
+        (*(*span).prev).next = (*span).next;
+    }
+    if !(*span).next.is_null() {
+        (*(*span).next).prev = (*span).prev;
+    }
+    (*span).next = ptr::null_mut();
+    (*span).prev = ptr::null_mut();
+}
+
+// 48-bit addresses: 36-bit page numbers split 12/12/12
+const MAP_BITS: usize = 12;
+const MAP_LEN: usize = 1 << MAP_BITS;
+const MAP_MASK: usize = MAP_LEN - 1;
+
+type Leaf = [AtomicPtr<Span>; MAP_LEN];
+type Node = [AtomicPtr<Leaf>; MAP_LEN];
+
+const NULL_NODE: AtomicPtr<Node> = AtomicPtr::new(ptr::null_mut());
+static PAGEMAP: [AtomicPtr<Node>; MAP_LEN] = [NULL_NODE; MAP_LEN];
+
+/// Span owning the page of `addr`, or null for memory this heap never gave out
+#[inline(always)]
+unsafe fn pagemap_get(addr: usize) -> *mut Span {
+    let page = addr >> PAGE_SHIFT;
+    let root = page >> (2 * MAP_BITS);
+    if root >= MAP_LEN {
+        return ptr::null_mut();
+    }
+    let node = PAGEMAP[root].load(Ordering::Acquire);
+    if node.is_null() {
+        return ptr::null_mut();
+    }
+    let leaf = (*node)[(page >> MAP_BITS) & MAP_MASK].load(Ordering::Acquire);
+    if leaf.is_null() {
+        return ptr::null_mut();
+    }
+    (*leaf)[page & MAP_MASK].load(Ordering::Relaxed)
+}
+
+/// Allocate page-map nodes covering `[start, start + len)`
+unsafe fn pagemap_ensure(start: usize, len: usize) -> bool {
+    let mut page = start >> PAGE_SHIFT;
+    let last = (start + len - 1) >> PAGE_SHIFT;
+    while page <= last {
+        let root = page >> (2 * MAP_BITS);
+        if root >= MAP_LEN {
+            return false;
+        }
+        let mut node = PAGEMAP[root].load(Ordering::Acquire);
+        if node.is_null() {
+            node = meta_alloc(size_of::<Node>()) as *mut Node;
+            if node.is_null() {
+                return false;
+            }
+            PAGEMAP[root].store(node, Ordering::Release);
+        }
+        let slot = &(*node)[(page >> MAP_BITS) & MAP_MASK];
+        if slot.load(Ordering::Acquire).is_null() {
+            let leaf = meta_alloc(size_of::<Leaf>()) as *mut Leaf;
+            if leaf.is_null() {
+                return false;
+            }
+            slot.store(leaf, Ordering::Release);
+        }
+        page = (page | MAP_MASK) + 1;
+    }
+    true
+}
+
+/// Point the page of `addr` at `span`; its nodes must exist
+#[inline]
+unsafe fn pagemap_set(addr: usize, span: *mut Span) {
+    let page = addr >> PAGE_SHIFT;
+    let node = PAGEMAP[page >> (2 * MAP_BITS)].load(Ordering::Relaxed);
+    let leaf = (*node)[(page >> MAP_BITS) & MAP_MASK].load(Ordering::Relaxed);
+    (*leaf)[page & MAP_MASK].store(span, Ordering::Relaxed);
+}
+
+// ---------------------------------------------------------------------------
+// Page heap
+// ---------------------------------------------------------------------------
+
+struct PageHeap {
+    /// Free spans; index n < EXACT_LISTS holds n-page spans
+    free: [*mut Span; EXACT_LISTS + 1],
+    /// Recycled span structs
+    unused: *mut Span,
+    brk_exhausted: bool,
+}
+
+static PAGE_LOCK: SpinLock = SpinLock::new();
+static mut PAGE_HEAP: PageHeap = PageHeap {
+    free: [ptr::null_mut(); EXACT_LISTS + 1],
+    unused: ptr::null_mut(),
+    brk_exhausted: false,
+};
+
+#[inline]
+unsafe fn free_list_head(npages: usize) -> *mut *mut Span {
+    ptr::addr_of_mut!(PAGE_HEAP.free[npages.min(EXACT_LISTS)])
+}
+
+// The helpers below run with PAGE_LOCK held
+
+unsafe fn new_span(start: usize, npages: usize, kind: u8) -> *mut Span {
+    let mut span = PAGE_HEAP.unused;
+    if span.is_null() {
+        span = meta_alloc(size_of::<Span>()) as *mut Span;
+        if span.is_null() {
+            return span;
+        }
+    } else {
+        PAGE_HEAP.unused = (*span).next;
+    }
+    span.write(Span {
+        start,
+        npages,
+        next: ptr::null_mut(),
+        prev: ptr::null_mut(),
+        free: ptr::null_mut(),
+        bump: start,
+        used: 0,
+        kind,
+        on_list: false,
+        released: false,
+    });
+    span
+}
+
+unsafe fn recycle_span(span: *mut Span) {
+    (*span).kind = SPAN_UNUSED;
+    (*span).next = PAGE_HEAP.unused;
+    PAGE_HEAP.unused = span;
+}
+
+/// File a free span; only its first and last pages are mapped to it
+unsafe fn insert_free(span: *mut Span) {
+    pagemap_set((*span).start, span);
+    pagemap_set((*span).start + ((*span).npages - 1) * PAGE_SIZE, span);
+    list_push(free_list_head((*span).npages), span);
+}
+
+unsafe fn find_free(npages: usize) -> *mut Span {
+    for n in npages..EXACT_LISTS {
+        if !PAGE_HEAP.free[n].is_null() {
+            return PAGE_HEAP.free[n];
+        }
+    }
+    // Best fit among the long spans, lowest address on ties
+    let mut best: *mut Span = ptr::null_mut();
+    let mut span = PAGE_HEAP.free[EXACT_LISTS];
+    while !span.is_null() {
+        if (*span).npages >= npages
+            && (best.is_null()
+                || (*span).npages < (*best).npages
+                || ((*span).npages == (*best).npages && (*span).start < (*best).start))
+        {
+            best = span;
+        }
+        span = (*span).next;
+    }
+    best
+}
+
+/// Take `npages` pages as a span of `kind`, every page mapped to it
+unsafe fn alloc_pages(npages: usize, kind: u8) -> *mut Span {
+    let mut span = find_free(npages);
+    if span.is_null() {
+        if !grow(npages) {
+            return ptr::null_mut();
+        }
+        span = find_free(npages);
+        if span.is_null() {
+            return span;
+        }
+    }
+    if (*span).npages > npages {
+        let rest = new_span(
+            (*span).start + npages * PAGE_SIZE,
+            (*span).npages - npages,
+            SPAN_FREE,
+        );
+        if rest.is_null() {
+            return rest;
+        }
+        (*rest).released = (*span).released;
+        list_remove(free_list_head((*span).npages), span);
+        (*span).npages = npages;
+        insert_free(rest);
+    } else {
+        list_remove(free_list_head(npages), span);
+    }
+    (*span).kind = kind;
+    (*span).released = false;
+    (*span).free = ptr::null_mut();
+    (*span).bump = (*span).start;
+    (*span).used = 0;
+    for i in 0..npages {
+        pagemap_set((*span).start + i * PAGE_SIZE, span);
+    }
+    span
+}
+
+/// Return an allocated span to the heap, merging it with free neighbours
+unsafe fn free_pages(span: *mut Span, release: bool) {
+    // Pieces of the merged span that still hold data
+    let mut dirty = [(0usize, 0usize); 3];
+    let mut ndirty = 0;
+    if !(*span).released {
+        dirty[ndirty] = ((*span).start, (*span).npages);
+        ndirty += 1;
+    }
+
+    let prev = pagemap_get((*span).start - PAGE_SIZE);
+    if !prev.is_null()
+        && (*prev).kind == SPAN_FREE
+        && (*prev).start + (*prev).npages * PAGE_SIZE == (*span).start
+    {
+        list_remove(free_list_head((*prev).npages), prev);
+        if !(*prev).released {
+            dirty[ndirty] = ((*prev).start, (*prev).npages);
+            ndirty += 1;
+        }
+        (*span).start = (*prev).start;
+        (*span).npages += (*prev).npages;
+        recycle_span(prev);
+    }
+
+    let next = pagemap_get((*span).start + (*span).npages * PAGE_SIZE);
+    if !next.is_null()
+        && (*next).kind == SPAN_FREE
+        && (*next).start == (*span).start + (*span).npages * PAGE_SIZE
+    {
+        list_remove(free_list_head((*next).npages), next);
+        if !(*next).released {
+            dirty[ndirty] = ((*next).start, (*next).npages);
+            ndirty += 1;
+        }
+        (*span).npages += (*next).npages;
+        recycle_span(next);
+    }
+
+    if release && ndirty > 0 && (*span).npages >= RELEASE_PAGES {
+        for &(start, npages) in &dirty[..ndirty] {
+            crate::syscall3(
+                crate::SYS_MADVISE,
+                start as u64,
+                (npages * PAGE_SIZE) as u64,
+                MADV_FREE,
+            );
+        }
+        ndirty = 0;
+    }
+    (*span).kind = SPAN_FREE;
+    (*span).released = ndirty == 0;
+    insert_free(span);
+}
+
+/// Extend the heap by at least `npages` pages
+unsafe fn grow(npages: usize) -> bool {
+    let want = match npages.checked_mul(PAGE_SIZE) {
+        Some(bytes) => bytes,
+        None => return false,
+    };
+
+    let mut start = 0;
+    let mut len = 0;
+    if !PAGE_HEAP.brk_exhausted {
+        len = want.max(BRK_GROW);
+        start = grow_brk(len);
+        if start == 0 {
+            PAGE_HEAP.brk_exhausted = true;
+        }
+    }
+    if start == 0 {
+        len = match want.checked_add(MMAP_GROW - 1) {
+            Some(n) => n & !(MMAP_GROW - 1),
+            None => return false,
+        };
+        start = map_pages(len);
+        if start == 0 {
+            return false;
+        }
+    }
+
+    if !pagemap_ensure(start, len) {
+        return false;
+    }
+    let span = new_span(start, len >> PAGE_SHIFT, SPAN_LARGE);
+    if span.is_null() {
+        return false;
+    }
+    // Fresh pages are zero and untouched; merge without releasing anything
+    (*span).released = true;
+    free_pages(span, false);
+    true
+}
+
+unsafe fn grow_brk(len: usize) -> usize {
+    let saved_errno = crate::get_errno();
+    let current = crate::sbrk(0) as usize;
+    let mut start = 0;
+    if current != usize::MAX {
+        let pad = current.wrapping_neg() & (PAGE_SIZE - 1);
+        if crate::sbrk((pad + len) as isize) as usize != usize::MAX {
+            start = current + pad;
+        }
+    }
+    crate::set_errno(saved_errno);
+    start
+}
+
+// ---------------------------------------------------------------------------
+// Central lists
+// ---------------------------------------------------------------------------
+
+struct CentralList {
+    lock: SpinLock,
+    /// Slabs with at least one free object
+    spans: *mut Span,
+}
+
+const CENTRAL_INIT: CentralList = CentralList {
+    lock: SpinLock::new(),
+    spans: ptr::null_mut(),
+};
+static mut CENTRAL: [CentralList; NUM_CLASSES] = [CENTRAL_INIT; NUM_CLASSES];
+
+/// Take up to `want` objects of `class`; returns the chain and its length
+unsafe fn fetch_objects(class: usize, want: usize) -> (*mut FreeObject, usize) {
+    let info = &CLASSES[class];
+    let central = ptr::addr_of_mut!(CENTRAL[class]);
+    let spans = ptr::addr_of_mut!((*central).spans);
+    let mut head: *mut FreeObject = ptr::null_mut();
+    let mut count = 0;
+
+    (*central).lock.lock();
+    while count < want {
+        let mut span = *spans;
+        if span.is_null() {
+            PAGE_LOCK.lock();
+            span = alloc_pages(info.pages, class as u8);
+            PAGE_LOCK.unlock();
+            if span.is_null() {
+                break;
+            }
+            list_push(spans, span);
+            (*span).on_list = true;
+        }
+
+        let end = (*span).start + (*span).npages * PAGE_SIZE;
+        while count < want {
+            let obj = if !(*span).free.is_null() {
+                let obj = (*span).free;
+                (*span).free = (*obj).next;
+                obj
+            } else if (*span).bump + info.size <= end {
+                let obj = (*span).bump as *mut FreeObject;
+                (*span).bump += info.size;
+                obj
+            } else {
+                break;
+            };
+            (*obj).next = head;
+            head = obj;
+            count += 1;
+            (*span).used += 1;
+        }
+        if (*span).free.is_null() && (*span).bump + info.size > end {
+            list_remove(spans, span);
+            (*span).on_list = false;
+        }
+    }
+    (*central).lock.unlock();
+    (head, count)
+}
+
+/// Give a chain of `class` objects back to their slabs
+unsafe fn release_objects(class: usize, mut obj: *mut FreeObject) {
+    let central = ptr::addr_of_mut!(CENTRAL[class]);
+    let spans = ptr::addr_of_mut!((*central).spans);
+
+    (*central).lock.lock();
+    while !obj.is_null() {
+        let next = (*obj).next;
+        let span = pagemap_get(obj as usize);
+        (*obj).next = (*span).free;
+        (*span).free = obj;
+        (*span).used -= 1;
+        if (*span).used == 0 {
+            if (*span).on_list {
+                list_remove(spans, span);
+                (*span).on_list = false;
+            }
+            PAGE_LOCK.lock();
+            free_pages(span, true);
+            PAGE_LOCK.unlock();
+        } else if !(*span).on_list {
+            list_push(spans, span);
+            (*span).on_list = true;
+        }
+        obj = next;
+    }
+    (*central).lock.unlock();
+}
+
+// ---------------------------------------------------------------------------
+// Thread caches
+// ---------------------------------------------------------------------------
+
+#[derive(Clone, Copy)]
+struct FreeList {
+    head: *mut FreeObject,
+    len: usize,
+}
+
+struct ThreadCache {
+    lists: [FreeList; NUM_CLASSES],
+    /// Link in the pool of caches left behind by exited threads
+    next: *mut ThreadCache,
+}
+
+static mut CACHE_POOL: *mut ThreadCache = ptr::null_mut();
+
+/// The calling thread's cache, or null before TLS is up
+#[inline(always)]
+unsafe fn thread_cache() -> *mut ThreadCache {
+    if !pthread::tls_ready() {
+        return ptr::null_mut();
+    }
+    let tcb = match pthread::get_current_tcb() {
+        Some(tcb) => tcb,
+        None => return ptr::null_mut(),
+    };
+    let cache = (*tcb).malloc_cache as *mut ThreadCache;
+    if !cache.is_null() {
+        return cache;
+    }
+    let cache = new_thread_cache();
+    (*tcb).malloc_cache = cache as *mut c_void;
+    cache
+}
+
+#[cold]
+unsafe fn new_thread_cache() -> *mut ThreadCache {
+    META_LOCK.lock();
+    let cache = CACHE_POOL;
+    if !cache.is_null() {
+        CACHE_POOL = (*cache).next;
+    }
+    META_LOCK.unlock();
+    if !cache.is_null() {
+        return cache;
+    }
+    // Zeroed memory is an empty cache
+    meta_alloc(size_of::<ThreadCache>()) as *mut ThreadCache
+}
+
+#[cold]
+unsafe fn refill(list: *mut FreeList, class: usize) -> *mut c_void {
+    let (head, count) = fetch_objects(class, CLASSES[class].batch);
+    if count == 0 {
+        return ptr::null_mut();
+    }
+    (*list).head = (*head).next;
+    (*list).len = count - 1;
+    head as *mut c_void
+}
+
+/// Hand the oldest half of an overfull list back to the central list
+#[cold]
+unsafe fn drain(list: *mut FreeList, class: usize) {
+    let keep = CLASSES[class].batch;
+    let mut last = (*list).head;
+    for _ in 1..keep {
+        last = (*last).next;
+    }
+    let surplus = (*last).next;
+    (*last).next = ptr::null_mut();
+    (*list).len = keep;
+    release_objects(class, surplus);
+}
+
+/// Flush the calling thread's cache before it exits
+///
+/// Called after the thread's last allocation; the cache itself is pooled for
+/// the next thread.
+pub(crate) unsafe fn thread_exit() {
+    if !pthread::tls_ready() {
+        return;
+    }
+    let tcb = match pthread::get_current_tcb() {
+        Some(tcb) => tcb,
+        None => return,
+    };
+    let cache = (*tcb).malloc_cache as *mut ThreadCache;
+    if cache.is_null() {
+        return;
+    }
+    (*tcb).malloc_cache = ptr::null_mut();
+    for class in 0..NUM_CLASSES {
+        let list = &mut (*cache).lists[class];
+        if !list.head.is_null() {
+            release_objects(class, list.head);
+        }
+        list.head = ptr::null_mut();
+        list.len = 0;
+    }
+    META_LOCK.lock();
+    (*cache).next = CACHE_POOL;
+    CACHE_POOL = cache;
+    META_LOCK.unlock();
+}
+
+// ---------------------------------------------------------------------------
+// Allocation
+// ---------------------------------------------------------------------------
+
+#[inline(always)]
+unsafe fn alloc_small(class: usize) -> *mut c_void {
+    let cache = thread_cache();
+    if cache.is_null() {
+        let (obj, _) = fetch_objects(class, 1);
+        return obj as *mut c_void;
+    }
+    let list = ptr::addr_of_mut!((*cache).lists[class]);
+    let obj = (*list).head;
+    if obj.is_null() {
+        return refill(list, class);
+    }
+    (*list).head = (*obj).next;
+    (*list).len -= 1;
+    obj as *mut c_void
+}
+
+#[inline(always)]
+unsafe fn free_small(obj: *mut FreeObject, class: usize) {
+    let cache = thread_cache();
+    if cache.is_null() {
+        (*obj).next = ptr::null_mut();
+        release_objects(class, obj);
+        return;
+    }
+    let list = ptr::addr_of_mut!((*cache).lists[class]);
+    (*obj).next = (*list).head;
+    (*list).head = obj;
+    (*list).len += 1;
+    if (*list).len > 2 * CLASSES[class].batch {
+        drain(list, class);
+    }
+}
+
+/// Page-aligned span of its own, for requests above the size classes
+unsafe fn alloc_large(size: usize) -> *mut c_void {
+    let npages = match pages_for(size) {
+        Some(n) => n,
+        None => return ptr::null_mut(),
+    };
+    PAGE_LOCK.lock();
+    let span = alloc_pages(npages, SPAN_LARGE);
+    PAGE_LOCK.unlock();
+    if span.is_null() {
+        ptr::null_mut()
+    } else {
+        (*span).start as *mut c_void
+    }
+}
+
+/// Private mapping with the block at an `align` boundary inside it
+unsafe fn alloc_mapped(size: usize, align: usize) -> *mut c_void {
+    let slack = if align > PAGE_SIZE {
+        align - PAGE_SIZE
+    } else {
+        0
+    };
+    let len = match size.checked_add(slack).and_then(pages_for) {
+        Some(npages) => npages << PAGE_SHIFT,
+        None => return ptr::null_mut(),
+    };
+    let base = map_pages(len);
+    if base == 0 {
+        return ptr::null_mut();
+    }
+    let block = (base + align - 1) & !(align - 1);
+
+    PAGE_LOCK.lock();
+    let span = if pagemap_ensure(block, 1) {
+        new_span(base, len >> PAGE_SHIFT, SPAN_MMAP)
+    } else {
+        ptr::null_mut()
+    };
+    if !span.is_null() {
+        pagemap_set(block, span);
+    }
+    PAGE_LOCK.unlock();
+
+    if span.is_null() {
+        unmap_pages(base, len);
+        return ptr::null_mut();
+    }
+    block as *mut c_void
+}
+
+unsafe fn alloc_big(size: usize, align: usize) -> *mut c_void {
+    if size >= MMAP_THRESHOLD || align > PAGE_SIZE {
+        let block = alloc_mapped(size, align);
+        if !block.is_null() || align > PAGE_SIZE {
+            return block;
+        }
+        // Out of mappings (e.g. the VMA limit); the page heap may still fit it
+    }
+    alloc_large(size)
+}
+
+/// Allocate `size` bytes aligned to 16; null on exhaustion
+#[inline]
+pub(crate) unsafe fn malloc(size: usize) -> *mut c_void {
+    if size <= MAX_SMALL {
+        alloc_small(size_class(size))
+    } else {
+        alloc_big(size, MIN_ALIGN)
+    }
+}
+
+/// Allocate `size` bytes aligned to `align`, a power of two
+pub(crate) unsafe fn memalign(align: usize, size: usize) -> *mut c_void {
+    if align <= MIN_ALIGN {
+        return malloc(size);
+    }
+    if align <= PAGE_SIZE {
+        // Power-of-two classes are aligned to their size
+        let rounded = size.max(align);
+        if rounded <= MAX_SMALL {
+            return alloc_small(size_class(rounded.next_power_of_two()));
+        }
+    }
+    alloc_big(size, align)
+}
+
+/// Allocate `size` zeroed bytes
+pub(crate) unsafe fn calloc(size: usize) -> *mut c_void {
+    let block = malloc(size);
+    if block.is_null() {
+        return block;
+    }
+    // Fresh mappings are already zero
+    if size < MMAP_THRESHOLD || (*pagemap_get(block as usize)).kind != SPAN_MMAP {
+        ptr::write_bytes(block as *mut u8, 0, size);
+    }
+    block
+}
+
+pub(crate) unsafe fn free(block: *mut c_void) {
+    let span = pagemap_get(block as usize);
+    if span.is_null() {
+        // Not ours; ignore like the previous allocator did
+        return;
+    }
+    let kind = (*span).kind;
+    if (kind as usize) < NUM_CLASSES {
+        free_small(block as *mut FreeObject, kind as usize);
+    } else if kind == SPAN_LARGE {
+        PAGE_LOCK.lock();
+        free_pages(span, true);
+        PAGE_LOCK.unlock();
+    } else if kind == SPAN_MMAP {
+        let (base, len) = ((*span).start, (*span).npages << PAGE_SHIFT);
+        PAGE_LOCK.lock();
+        pagemap_set(block as usize, ptr::null_mut());
+        recycle_span(span);
+        PAGE_LOCK.unlock();
+        unmap_pages(base, len);
+    }
+}
+
+/// Whether a live block shrunk to `new_size` bytes should stay where it is.
+/// Small objects keep their class; a page span is kept only while at least
+/// half of it stays in use, else realloc moves the data to a fitting block.
+pub(crate) unsafe fn keeps_block_on_shrink(block: *mut c_void, new_size: usize) -> bool {
+    let span = pagemap_get(block as usize);
+    if span.is_null() || ((*span).kind as usize) < NUM_CLASSES {
+        return true;
+    }
+    new_size >= usable_size(block) / 2
+}
+
+/// Bytes usable at `block`, or 0 if it is not a live allocation
+pub(crate) unsafe fn usable_size(block: *mut c_void) -> usize {
+    let span = pagemap_get(block as usize);
+    if span.is_null() {
+        return 0;
+    }
+    let kind = (*span).kind;
+    if (kind as usize) < NUM_CLASSES {
+        CLASSES[kind as usize].size
+    } else if kind == SPAN_LARGE {
+        (*span).npages << PAGE_SHIFT
+    } else if kind == SPAN_MMAP {
+        (*span).start + ((*span).npages << PAGE_SHIFT) - block as usize
+    } else {
+        0
+    }
+}
@@ -0,0 +1,726 @@
+//! Vectorized memory and string primitives
+//!
+//! Backs `memcpy`, `memmove`, `memset`, `memcmp`, `strlen`, `memchr` and
+//! friends. Every routine dispatches on size:
+//! - up to 32 bytes: a pair of possibly overlapping loads and stores, no loop
+//! - bulk: 64-byte (SSE2) or 128-byte (AVX2) loops with aligned stores; the
+//!   first and last vectors are loaded up front and stored last, which also
+//!   makes the forward and backward loops safe for `memmove`
+//! - `rep movsb`/`rep stosb` from `REP_THRESHOLD` when the CPU has ERMS
+//! - non-temporal stores once a copy or fill is larger than most of the
+//!   last-level cache, so it does not evict the caller's working set
+//!
+//! The implementation is chosen once per process from CPUID (AVX2 also needs
+//! the kernel to have enabled YMM state in XCR0) and cached in `FEATURES`;
+//! `init_cpu_features()` runs from the CRT before `main`, and the first call
+//! resolves it if something copies earlier.
+//!
+//! Bulk loops are inline assembly: a plain Rust copy loop here could be
+//! turned back into a call to `memcpy` by the optimizer. The string scans
+//! use aligned 16-byte loads, which may read past the terminator but never
+//! across a page boundary.
+
+use core::arch::asm;
+use core::arch::x86_64::*;
+use core::sync::atomic::{AtomicU8, AtomicUsize, Ordering};
+
+const FEAT_RESOLVED: u8 = 1 << 0;
+const FEAT_ERMS: u8 = 1 << 1;
+const FEAT_AVX2: u8 = 1 << 2;
+
+/// Copies and fills from this size use `rep movsb`/`rep stosb` with ERMS
+const REP_THRESHOLD: usize = 2048;
+
+/// Non-temporal threshold when the cache size is unknown
+const DEFAULT_NT_THRESHOLD: usize = 1024 * 1024;
+
+static FEATURES: AtomicU8 = AtomicU8::new(0);
+static NT_THRESHOLD: AtomicUsize = AtomicUsize::new(DEFAULT_NT_THRESHOLD);
+
+fn cpuid(leaf: u32, subleaf: u32) -> CpuidResult {
+    unsafe { __cpuid_count(leaf, subleaf) }
+}
+
+fn xgetbv0() -> u64 {
+    let (lo, hi): (u32, u32);
+    unsafe {
+        asm!(
+            "xgetbv",
+            in("ecx") 0u32,
+            out("eax") lo,
+            out("edx") hi,
+            options(nomem, nostack, preserves_flags)
+        );
+    }
+    ((hi as u64) << 32) | lo as u64
+}
+
+/// Size of the largest cache reported by CPUID leaf 4 (0 if unknown)
+fn last_level_cache_size(max_leaf: u32) -> usize {
+    if max_leaf < 4 {
+        return 0;
+    }
+    let mut largest = 0usize;
+    for subleaf in 0..8 {
+        let r = cpuid(4, subleaf);
+        if r.eax & 0x1f == 0 {
+            break;
+        }
+        let ways = ((r.ebx >> 22) & 0x3ff) as usize + 1;
+        let partitions = ((r.ebx >> 12) & 0x3ff) as usize + 1;
+        let line = (r.ebx & 0xfff) as usize + 1;
+        let sets = r.ecx as usize + 1;
+        largest = largest.max(ways * partitions * line * sets);
+    }
+    largest
+}
+
+/// Probe the CPU and select the implementations for this process
+pub fn init_cpu_features() -> u8 {
+    let max_leaf = cpuid(0, 0).eax;
+    let mut features = FEAT_RESOLVED;
+
+    if max_leaf >= 7 {
+        let leaf1 = cpuid(1, 0);
+        let leaf7 = cpuid(7, 0);
+        if leaf7.ebx & (1 << 9) != 0 {
+            features |= FEAT_ERMS;
+        }
+        // AVX2 is only usable if the kernel saves YMM state (OSXSAVE + XCR0)
+        let osxsave = leaf1.ecx & (1 << 27) != 0;
+        let avx = leaf1.ecx & (1 << 28) != 0;
+        if osxsave && avx && leaf7.ebx & (1 << 5) != 0 && xgetbv0() & 0x6 == 0x6 {
+            features |= FEAT_AVX2;
+        }
+    }
+
+    let llc = last_level_cache_size(max_leaf);
+    if llc != 0 {
+        NT_THRESHOLD.store(llc / 4 * 3, Ordering::Relaxed);
+    }
+    FEATURES.store(features, Ordering::Relaxed);
+    features
+}
+
+#[inline(always)]
+fn features() -> u8 {
+    match FEATURES.load(Ordering::Relaxed) {
+        0 => init_cpu_features(),
+        f => f,
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Copies
+// ---------------------------------------------------------------------------
+
+/// Copy up to 32 bytes; every load happens before any store
+#[inline(always)]
+unsafe fn copy_small(d: *mut u8, s: *const u8, n: usize) {
+    if n >= 16 {
+        let a = _mm_loadu_si128(s as *const __m128i);
+        let b = _mm_loadu_si128(s.add(n - 16) as *const __m128i);
+        _mm_storeu_si128(d as *mut __m128i, a);
+        _mm_storeu_si128(d.add(n - 16) as *mut __m128i, b);
+    } else if n >= 8 {
+        let a = (s as *const u64).read_unaligned();
+        let b = (s.add(n - 8) as *const u64).read_unaligned();
+        (d as *mut u64).write_unaligned(a);
+        (d.add(n - 8) as *mut u64).write_unaligned(b);
+    } else if n >= 4 {
+        let a = (s as *const u32).read_unaligned();
+        let b = (s.add(n - 4) as *const u32).read_unaligned();
+        (d as *mut u32).write_unaligned(a);
+        (d.add(n - 4) as *mut u32).write_unaligned(b);
+    } else if n >= 2 {
+        let a = (s as *const u16).read_unaligned();
+        let b = (s.add(n - 2) as *const u16).read_unaligned();
+        (d as *mut u16).write_unaligned(a);
+        (d.add(n - 2) as *mut u16).write_unaligned(b);
+    } else if n == 1 {
+        *d = *s;
+    }
+}
+
+/// SSE2 forward copy of n > 32 bytes; safe when `d` is below `s`
+#[inline(always)]
+unsafe fn copy_forward_sse2(d: *mut u8, s: *const u8, n: usize, nontemporal: bool) {
+    let head = _mm_loadu_si128(s as *const __m128i);
+    let tail = _mm_loadu_si128(s.add(n - 16) as *const __m128i);
+
+    // Align the destination; the head store covers the skipped bytes
+    let skew = 16 - (d as usize & 15);
+    let mut dp = d.add(skew);
+    let mut sp = s.add(skew);
+    let mut rem = n - skew;
+
+    if rem >= 64 {
+        if nontemporal {
+            asm!(
+                "2:",
+                "movdqu xmm0, [{s}]",
+                "movdqu xmm1, [{s} + 16]",
+                "movdqu xmm2, [{s} + 32]",
+                "movdqu xmm3, [{s} + 48]",
+                "movntdq [{d}], xmm0",
+                "movntdq [{d} + 16], xmm1",
+                "movntdq [{d} + 32], xmm2",
+                "movntdq [{d} + 48], xmm3",
+                "add {s}, 64",
+                "add {d}, 64",
+                "sub {n}, 64",
+                "cmp {n}, 64",
+                "jae 2b",
+                "sfence",
+                s = inout(reg) sp,
+                d = inout(reg) dp,
+                n = inout(reg) rem,
+                out("xmm0") _, out("xmm1") _, out("xmm2") _, out("xmm3") _,
+                options(nostack)
+            );
+        } else {
+            asm!(
+                "2:",
+                "movdqu xmm0, [{s}]",
+                "movdqu xmm1, [{s} + 16]",
+                "movdqu xmm2, [{s} + 32]",
+                "movdqu xmm3, [{s} + 48]",
+                "movdqa [{d}], xmm0",
+                "movdqa [{d} + 16], xmm1",
+                "movdqa [{d} + 32], xmm2",
+                "movdqa [{d} + 48], xmm3",
+                "add {s}, 64",
+                "add {d}, 64",
+                "sub {n}, 64",
+                "cmp {n}, 64",
+                "jae 2b",
+                s = inout(reg) sp,
+                d = inout(reg) dp,
+                n = inout(reg) rem,
+                out("xmm0") _, out("xmm1") _, out("xmm2") _, out("xmm3") _,
+                options(nostack)
+            );
+        }
+    }
+
+    // Up to three more vectors; the tail store finishes the last 1..=16 bytes
+    if rem > 16 {
+        _mm_store_si128(dp as *mut __m128i, _mm_loadu_si128(sp as *const __m128i));
+    }
+    if rem > 32 {
+        let v = _mm_loadu_si128(sp.add(16) as *const __m128i);
+        _mm_store_si128(dp.add(16) as *mut __m128i, v);
+    }
+    if rem > 48 {
+        let v = _mm_loadu_si128(sp.add(32) as *const __m128i);
+        _mm_store_si128(dp.add(32) as *mut __m128i, v);
+    }
+    _mm_storeu_si128(d.add(n - 16) as *mut __m128i, tail);
+    _mm_storeu_si128(d as *mut __m128i, head);
+}
+
+/// AVX2 forward copy of n > 32 bytes; safe when `d` is below `s`
+#[target_feature(enable = "avx2")]
+unsafe fn copy_forward_avx2(d: *mut u8, s: *const u8, n: usize) {
+    let head = _mm256_loadu_si256(s as *const __m256i);
+    let tail = _mm256_loadu_si256(s.add(n - 32) as *const __m256i);
+
+    let skew = 32 - (d as usize & 31);
+    let mut dp = d.add(skew);
+    let mut sp = s.add(skew);
+    let mut rem = n - skew;
+
+    if rem >= 128 {
+        asm!(
+            "2:",
+            "vmovdqu ymm0, [{s}]",
+            "vmovdqu ymm1, [{s} + 32]",
+            "vmovdqu ymm2, [{s} + 64]",
+            "vmovdqu ymm3, [{s} + 96]",
+            "vmovdqa [{d}], ymm0",
+            "vmovdqa [{d} + 32], ymm1",
+            "vmovdqa [{d} + 64], ymm2",
+            "vmovdqa [{d} + 96], ymm3",
+            "add {s}, 128",
+            "add {d}, 128",
+            "sub {n}, 128",
+            "cmp {n}, 128",
+            "jae 2b",
+            s = inout(reg) sp,
+            d = inout(reg) dp,
+            n = inout(reg) rem,
+            out("ymm0") _, out("ymm1") _, out("ymm2") _, out("ymm3") _,
+            options(nostack)
+        );
+    }
+
+    if rem > 32 {
+        _mm256_store_si256(dp as *mut __m256i, _mm256_loadu_si256(sp as *const __m256i));
+    }
+    if rem > 64 {
+        let v = _mm256_loadu_si256(sp.add(32) as *const __m256i);
+        _mm256_store_si256(dp.add(32) as *mut __m256i, v);
+    }
+    if rem > 96 {
+        let v = _mm256_loadu_si256(sp.add(64) as *const __m256i);
+        _mm256_store_si256(dp.add(64) as *mut __m256i, v);
+    }
+    _mm256_storeu_si256(d.add(n - 32) as *mut __m256i, tail);
+    _mm256_storeu_si256(d as *mut __m256i, head);
+    _mm256_zeroupper();
+}
+
+/// SSE2 backward copy of n > 32 bytes; safe when `d` is above `s`
+unsafe fn copy_backward_sse2(d: *mut u8, s: *const u8, n: usize) {
+    let head = _mm_loadu_si128(s as *const __m128i);
+    let tail = _mm_loadu_si128(s.add(n - 16) as *const __m128i);
+
+    // Align the end of the destination; the tail store covers the skew
+    let skew = (d as usize + n) & 15;
+    let mut dp = d.add(n - skew);
+    let mut sp = s.add(n - skew);
+    let mut rem = n - skew;
+
+    if rem >= 64 {
+        asm!(
+            "2:",
+            "sub {s}, 64",
+            "sub {d}, 64",
+            "movdqu xmm0, [{s} + 48]",
+            "movdqu xmm1, [{s} + 32]",
+            "movdqu xmm2, [{s} + 16]",
+            "movdqu xmm3, [{s}]",
+            "movdqa [{d} + 48], xmm0",
+            "movdqa [{d} + 32], xmm1",
+            "movdqa [{d} + 16], xmm2",
+            "movdqa [{d}], xmm3",
+            "sub {n}, 64",
+            "cmp {n}, 64",
+            "jae 2b",
+            s = inout(reg) sp,
+            d = inout(reg) dp,
+            n = inout(reg) rem,
+            out("xmm0") _, out("xmm1") _, out("xmm2") _, out("xmm3") _,
+            options(nostack)
+        );
+    }
+
+    if rem > 16 {
+        let v = _mm_loadu_si128(sp.sub(16) as *const __m128i);
+        _mm_store_si128(dp.sub(16) as *mut __m128i, v);
+    }
+    if rem > 32 {
+        let v = _mm_loadu_si128(sp.sub(32) as *const __m128i);
+        _mm_store_si128(dp.sub(32) as *mut __m128i, v);
+    }
+    if rem > 48 {
+        let v = _mm_loadu_si128(sp.sub(48) as *const __m128i);
+        _mm_store_si128(dp.sub(48) as *mut __m128i, v);
+    }
+    _mm_storeu_si128(d as *mut __m128i, head);
+    _mm_storeu_si128(d.add(n - 16) as *mut __m128i, tail);
+}
+
+#[inline(always)]
+unsafe fn rep_movsb(d: *mut u8, s: *const u8, n: usize) {
+    asm!(
+        "rep movsb",
+        inout("rcx") n => _,
+        inout("rdi") d => _,
+        inout("rsi") s => _,
+        options(nostack, preserves_flags)
+    );
+}
+
+/// Forward copy of n > 32 bytes. `disjoint` allows non-temporal stores.
+#[inline(always)]
+unsafe fn copy_forward(d: *mut u8, s: *const u8, n: usize, disjoint: bool) {
+    let features = features();
+    if disjoint && n >= NT_THRESHOLD.load(Ordering::Relaxed) {
+        copy_forward_sse2(d, s, n, true);
+    } else if features & FEAT_ERMS != 0 && n >= REP_THRESHOLD {
+        rep_movsb(d, s, n);
+    } else if features & FEAT_AVX2 != 0 {
+        copy_forward_avx2(d, s, n);
+    } else {
+        copy_forward_sse2(d, s, n, false);
+    }
+}
+
+pub unsafe fn memcpy(d: *mut u8, s: *const u8, n: usize) {
+    if n <= 32 {
+        copy_small(d, s, n);
+    } else {
+        copy_forward(d, s, n, true);
+    }
+}
+
+pub unsafe fn memmove(d: *mut u8, s: *const u8, n: usize) {
+    if n <= 32 {
+        copy_small(d, s, n);
+        return;
+    }
+    let distance = (d as usize).wrapping_sub(s as usize);
+    if distance >= n {
+        // Destination below the source, or no overlap at all
+        let disjoint = (s as usize).wrapping_sub(d as usize) >= n;
+        copy_forward(d, s, n, disjoint);
+    } else if distance != 0 {
+        copy_backward_sse2(d, s, n);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Fill
+// ---------------------------------------------------------------------------
+
+unsafe fn set_bulk_sse2(d: *mut u8, c: u8, n: usize, nontemporal: bool) {
+    let v = _mm_set1_epi8(c as i8);
+    _mm_storeu_si128(d as *mut __m128i, v);
+    _mm_storeu_si128(d.add(n - 16) as *mut __m128i, v);
+
+    let skew = 16 - (d as usize & 15);
+    let mut dp = d.add(skew);
+    let mut rem = n - skew;
+
+    if rem >= 64 {
+        if nontemporal {
+            asm!(
+                "2:",
+                "movntdq [{d}], {v}",
+                "movntdq [{d} + 16], {v}",
+                "movntdq [{d} + 32], {v}",
+                "movntdq [{d} + 48], {v}",
+                "add {d}, 64",
+                "sub {n}, 64",
+                "cmp {n}, 64",
+                "jae 2b",
+                "sfence",
+                d = inout(reg) dp,
+                n = inout(reg) rem,
+                v = in(xmm_reg) v,
+                options(nostack)
+            );
+        } else {
+            asm!(
+                "2:",
+                "movdqa [{d}], {v}",
+                "movdqa [{d} + 16], {v}",
+                "movdqa [{d} + 32], {v}",
+                "movdqa [{d} + 48], {v}",
+                "add {d}, 64",
+                "sub {n}, 64",
+                "cmp {n}, 64",
+                "jae 2b",
+                d = inout(reg) dp,
+                n = inout(reg) rem,
+                v = in(xmm_reg) v,
+                options(nostack)
+            );
+        }
+    }
+    if rem > 16 {
+        _mm_store_si128(dp as *mut __m128i, v);
+    }
+    if rem > 32 {
+        _mm_store_si128(dp.add(16) as *mut __m128i, v);
+    }
+    if rem > 48 {
+        _mm_store_si128(dp.add(32) as *mut __m128i, v);
+    }
+}
+
+#[target_feature(enable = "avx2")]
+unsafe fn set_bulk_avx2(d: *mut u8, c: u8, n: usize) {
+    let v = _mm256_set1_epi8(c as i8);
+    _mm256_storeu_si256(d as *mut __m256i, v);
+    _mm256_storeu_si256(d.add(n - 32) as *mut __m256i, v);
+
+    let skew = 32 - (d as usize & 31);
+    let mut dp = d.add(skew);
+    let mut rem = n - skew;
+
+    if rem >= 128 {
+        asm!(
+            "2:",
+            "vmovdqa [{d}], {v}",
+            "vmovdqa [{d} + 32], {v}",
+            "vmovdqa [{d} + 64], {v}",
+            "vmovdqa [{d} + 96], {v}",
+            "add {d}, 128",
+            "sub {n}, 128",
+            "cmp {n}, 128",
+            "jae 2b",
+            d = inout(reg) dp,
+            n = inout(reg) rem,
+            v = in(ymm_reg) v,
+            options(nostack)
+        );
+    }
+    if rem > 32 {
+        _mm256_store_si256(dp as *mut __m256i, v);
+    }
+    if rem > 64 {
+        _mm256_store_si256(dp.add(32) as *mut __m256i, v);
+    }
+    if rem > 96 {
+        _mm256_store_si256(dp.add(64) as *mut __m256i, v);
+    }
+    _mm256_zeroupper();
+}
+
+pub unsafe fn memset(d: *mut u8, c: u8, n: usize) {
+    if n <= 32 {
+        if n >= 16 {
+            let v = _mm_set1_epi8(c as i8);
+            _mm_storeu_si128(d as *mut __m128i, v);
+            _mm_storeu_si128(d.add(n - 16) as *mut __m128i, v);
+        } else if n >= 8 {
+            let v = u64::from_ne_bytes([c; 8]);
+            (d as *mut u64).write_unaligned(v);
+            (d.add(n - 8) as *mut u64).write_unaligned(v);
+        } else if n >= 4 {
+            let v = u32::from_ne_bytes([c; 4]);
+            (d as *mut u32).write_unaligned(v);
+            (d.add(n - 4) as *mut u32).write_unaligned(v);
+        } else if n >= 2 {
+            let v = u16::from_ne_bytes([c; 2]);
+            (d as *mut u16).write_unaligned(v);
+            (d.add(n - 2) as *mut u16).write_unaligned(v);
+        } else if n == 1 {
+            *d = c;
+        }
+        return;
+    }
+
+    let features = features();
+    if n >= NT_THRESHOLD.load(Ordering::Relaxed) {
+        set_bulk_sse2(d, c, n, true);
+    } else if features & FEAT_ERMS != 0 && n >= REP_THRESHOLD {
+        asm!(
+            "rep stosb",
+            inout("rcx") n => _,
+            inout("rdi") d => _,
+            in("al") c,
+            options(nostack, preserves_flags)
+        );
+    } else if features & FEAT_AVX2 != 0 {
+        set_bulk_avx2(d, c, n);
+    } else {
+        set_bulk_sse2(d, c, n, false);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Compare
+// ---------------------------------------------------------------------------
+
+/// Byte difference at the first mismatch within an 8-byte little-endian word
+#[inline(always)]
+unsafe fn word_diff(a: *const u8, b: *const u8, x: u64, y: u64) -> i32 {
+    let i = ((x ^ y).trailing_zeros() / 8) as usize;
+    *a.add(i) as i32 - *b.add(i) as i32
+}
+
+/// Byte difference at the first mismatch of a 16-byte block (`eq` = movemask
+/// of equal bytes)
+#[inline(always)]
+unsafe fn block_diff(a: *const u8, b: *const u8, eq: i32) -> i32 {
+    let i = (!eq as u32).trailing_zeros() as usize;
+    *a.add(i) as i32 - *b.add(i) as i32
+}
+
+#[inline(always)]
+unsafe fn cmp16(a: *const u8, b: *const u8) -> i32 {
+    let va = _mm_loadu_si128(a as *const __m128i);
+    let vb = _mm_loadu_si128(b as *const __m128i);
+    _mm_movemask_epi8(_mm_cmpeq_epi8(va, vb))
+}
+
+/// Returns the difference of the first differing bytes, like the byte loop
+/// this replaced
+pub unsafe fn memcmp(a: *const u8, b: *const u8, n: usize) -> i32 {
+    if n < 16 {
+        if n >= 8 {
+            let (x, y) = (
+                (a as *const u64).read_unaligned(),
+                (b as *const u64).read_unaligned(),
+            );
+            if x != y {
+                return word_diff(a, b, x, y);
+            }
+            let (a, b) = (a.add(n - 8), b.add(n - 8));
+            let (x, y) = (
+                (a as *const u64).read_unaligned(),
+                (b as *const u64).read_unaligned(),
+            );
+            return if x != y { word_diff(a, b, x, y) } else { 0 };
+        }
+        let mut i = 0;
+        while i < n {
+            let (x, y) = (*a.add(i), *b.add(i));
+            if x != y {
+                return x as i32 - y as i32;
+            }
+            i += 1;
+        }
+        return 0;
+    }
+
+    let mut i = 0;
+    while i + 64 <= n {
+        let eq = cmp16(a.add(i), b.add(i))
+            & cmp16(a.add(i + 16), b.add(i + 16))
+            & cmp16(a.add(i + 32), b.add(i + 32))
+            & cmp16(a.add(i + 48), b.add(i + 48));
+        if eq != 0xffff {
+            break;
+        }
+        i += 64;
+    }
+    while i + 16 <= n {
+        let eq = cmp16(a.add(i), b.add(i));
+        if eq != 0xffff {
+            return block_diff(a.add(i), b.add(i), eq);
+        }
+        i += 16;
+    }
+    if i < n {
+        let last = n - 16;
+        let eq = cmp16(a.add(last), b.add(last));
+        if eq != 0xffff {
+            return block_diff(a.add(last), b.add(last), eq);
+        }
+    }
+    0
+}
+
+// ---------------------------------------------------------------------------
+// Scans
+// ---------------------------------------------------------------------------
+
+/// Aligned 16-byte load the optimizer cannot see, so reading past the end
+/// of the object (but not past its page) is not treated as undefined
+#[inline(always)]
+unsafe fn load_aligned(p: *const u8) -> __m128i {
+    let v: __m128i;
+    asm!(
+        "movdqa {v}, [{p}]",
+        p = in(reg) p,
+        v = out(xmm_reg) v,
+        options(nostack, readonly, preserves_flags, pure)
+    );
+    v
+}
+
+/// Bitmask of bytes equal to `needle` in the aligned block at `p`
+#[inline(always)]
+unsafe fn match_mask(p: *const u8, needle: __m128i) -> u32 {
+    _mm_movemask_epi8(_mm_cmpeq_epi8(load_aligned(p), needle)) as u32
+}
+
+pub unsafe fn strlen(s: *const u8) -> usize {
+    let zero = _mm_setzero_si128();
+    let offset = s as usize & 15;
+    let mut p = s.sub(offset);
+
+    let mask = match_mask(p, zero) >> offset;
+    if mask != 0 {
+        return mask.trailing_zeros() as usize;
+    }
+    loop {
+        p = p.add(16);
+        let mask = match_mask(p, zero);
+        if mask != 0 {
+            return p.offset_from(s) as usize + mask.trailing_zeros() as usize;
+        }
+    }
+}
+
+/// First occurrence of `c` in `s[..n]`
+pub unsafe fn memchr(s: *const u8, c: u8, n: usize) -> Option<usize> {
+    if n == 0 {
+        return None;
+    }
+    let needle = _mm_set1_epi8(c as i8);
+    let offset = s as usize & 15;
+    let mut p = s.sub(offset);
+
+    // Bytes before `s` are shifted out, bytes at or past `n` are ignored
+    let mut mask = match_mask(p, needle) >> offset;
+    let mut base = 0usize;
+    let mut avail = 16 - offset;
+    loop {
+        if mask != 0 {
+            let i = base + mask.trailing_zeros() as usize;
+            return if i < n { Some(i) } else { None };
+        }
+        if avail >= n - base {
+            return None;
+        }
+        base += avail;
+        avail = 16;
+        p = p.add(16);
+        mask = match_mask(p, needle);
+    }
+}
+
+/// Last occurrence of `c` in `s[..n]`
+pub unsafe fn memrchr(s: *const u8, c: u8, n: usize) -> Option<usize> {
+    if n == 0 {
+        return None;
+    }
+    let needle = _mm_set1_epi8(c as i8);
+    let end = s as usize + n;
+    let mut p = (end & !15) as *const u8;
+    let start = s as usize;
+
+    // Block holding the last byte may extend past `end`
+    let tail = end & 15;
+    let mut mask = if tail != 0 {
+        match_mask(p, needle) & ((1u32 << tail) - 1)
+    } else {
+        0
+    };
+    loop {
+        if p as usize <= start {
+            // First block: drop matches before `s`
+            mask &= !((1u32 << (start - p as usize)) - 1);
+        }
+        if mask != 0 {
+            let i = p as usize + 31 - mask.leading_zeros() as usize;
+            return Some(i - start);
+        }
+        if p as usize <= start {
+            return None;
+        }
+        p = p.sub(16);
+        mask = match_mask(p, needle);
+    }
+}
+
+/// First `c` or NUL in `s`; returns the index and whether it was `c`
+pub unsafe fn strchr(s: *const u8, c: u8) -> Option<usize> {
+    let zero = _mm_setzero_si128();
+    let needle = _mm_set1_epi8(c as i8);
+    let offset = s as usize & 15;
+    let mut p = s.sub(offset);
+
+    let block = |p: *const u8| {
+        let v = load_aligned(p);
+        let hits = _mm_or_si128(_mm_cmpeq_epi8(v, needle), _mm_cmpeq_epi8(v, zero));
+        _mm_movemask_epi8(hits) as u32
+    };
+
+    let mut mask = block(p) >> offset;
+    let mut base = 0usize;
+    loop {
+        if mask != 0 {
+            let i = base + mask.trailing_zeros() as usize;
+            return if *s.add(i) == c { Some(i) } else { None };
+        }
+        base = p.add(16).offset_from(s) as usize;
+        p = p.add(16);
+        mask = block(p);
+    }
+}
@@ -0,0 +1,167 @@
+//! Userspace CRNG behind `getrandom()`
+//!
+//! Small `getrandom()` requests are served from a ChaCha20 CRNG seeded by the
+//! kernel, so hashing seeds, connection IDs and the like cost no syscall.
+//! Output is generated four blocks at a time with fast key erasure: the first
+//! 32 bytes of each batch become the next key and consumed bytes are wiped,
+//! so a later memory disclosure does not reveal earlier output.
+//!
+//! The key is refreshed from the kernel every `RESEED_BYTES` of output, and
+//! dropped in the child after `fork()` so parent and child never share a
+//! stream. The state is guarded by a try-lock; a caller that finds it busy
+//! (another thread, or a signal handler interrupting a refill) falls back to
+//! the syscall.
+
+use core::sync::atomic::{AtomicBool, Ordering};
+
+/// Requests up to this size are served from the userspace CRNG
+pub const MAX_FAST_REQUEST: usize = 256;
+
+/// Bytes per refill (four ChaCha20 blocks)
+const BATCH_BYTES: usize = 256;
+
+/// Bytes of each batch kept as the next key
+const KEY_BYTES: usize = 32;
+
+/// Output generated before the key is refreshed from the kernel
+const RESEED_BYTES: usize = 64 * 1024;
+
+struct UserCrng {
+    key: [u32; 8],
+    /// Bytes left before the next kernel reseed (0 = not seeded)
+    budget: usize,
+    /// Batched output; bytes before `pos` are consumed and zeroed
+    buf: [u8; BATCH_BYTES],
+    pos: usize,
+}
+
+static BUSY: AtomicBool = AtomicBool::new(false);
+static mut CRNG: UserCrng = UserCrng {
+    key: [0; 8],
+    budget: 0,
+    buf: [0; BATCH_BYTES],
+    pos: BATCH_BYTES,
+};
+
+#[inline]
+fn quarter_round(state: &mut [u32; 16], a: usize, b: usize, c: usize, d: usize) {
+    state[a] = state[a].wrapping_add(state[b]);
+    state[d] = (state[d] ^ state[a]).rotate_left(16);
+    state[c] = state[c].wrapping_add(state[d]);
+    state[b] = (state[b] ^ state[c]).rotate_left(12);
+    state[a] = state[a].wrapping_add(state[b]);
+    state[d] = (state[d] ^ state[a]).rotate_left(8);
+    state[c] = state[c].wrapping_add(state[d]);
+    state[b] = (state[b] ^ state[c]).rotate_left(7);
+}
+
+/// One ChaCha20 block with a zero nonce
+fn chacha20_block(key: &[u32; 8], counter: u64, out: &mut [u8]) {
+    let mut init = [0u32; 16];
+    init[..4].copy_from_slice(&[0x61707865, 0x3320646e, 0x79622d32, 0x6b206574]);
+    init[4..12].copy_from_slice(key);
+    init[12] = counter as u32;
+    init[13] = (counter >> 32) as u32;
+
+    let mut state = init;
+    for _ in 0..10 {
+        quarter_round(&mut state, 0, 4, 8, 12);
+        quarter_round(&mut state, 1, 5, 9, 13);
+        quarter_round(&mut state, 2, 6, 10, 14);
+        quarter_round(&mut state, 3, 7, 11, 15);
+        quarter_round(&mut state, 0, 5, 10, 15);
+        quarter_round(&mut state, 1, 6, 11, 12);
+        quarter_round(&mut state, 2, 7, 8, 13);
+        quarter_round(&mut state, 3, 4, 9, 14);
+    }
+
+    for i in 0..16 {
+        let word = state[i].wrapping_add(init[i]);
+        out[i * 4..i * 4 + 4].copy_from_slice(&word.to_le_bytes());
+    }
+}
+
+impl UserCrng {
+    /// Fetch a fresh key from the kernel
+    fn reseed(&mut self) -> bool {
+        let mut seed = [0u8; KEY_BYTES];
+        if crate::sys_getrandom(seed.as_mut_ptr(), KEY_BYTES, 0) != KEY_BYTES as isize {
+            return false;
+        }
+        for (word, chunk) in self.key.iter_mut().zip(seed.chunks_exact(4)) {
+            *word = u32::from_le_bytes([chunk[0], chunk[1], chunk[2], chunk[3]]);
+        }
+        seed.fill(0);
+        self.buf.fill(0);
+        self.pos = BATCH_BYTES;
+        self.budget = RESEED_BYTES;
+        true
+    }
+
+    /// Generate a new batch, replacing the key with its first bytes
+    fn refill(&mut self) {
+        for block in 0..BATCH_BYTES / 64 {
+            chacha20_block(
+                &self.key,
+                block as u64,
+                &mut self.buf[block * 64..block * 64 + 64],
+            );
+        }
+        for (word, chunk) in self.key.iter_mut().zip(self.buf.chunks_exact(4)) {
+            *word = u32::from_le_bytes([chunk[0], chunk[1], chunk[2], chunk[3]]);
+        }
+        self.buf[..KEY_BYTES].fill(0);
+        self.pos = KEY_BYTES;
+    }
+
+    fn fill(&mut self, dest: &mut [u8]) -> bool {
+        if self.budget < dest.len() && !self.reseed() {
+            return false;
+        }
+        self.budget -= dest.len();
+
+        let mut offset = 0;
+        while offset < dest.len() {
+            if self.pos >= BATCH_BYTES {
+                self.refill();
+            }
+            let n = core::cmp::min(BATCH_BYTES - self.pos, dest.len() - offset);
+            dest[offset..offset + n].copy_from_slice(&self.buf[self.pos..self.pos + n]);
+            self.buf[self.pos..self.pos + n].fill(0);
+            self.pos += n;
+            offset += n;
+        }
+        true
+    }
+}
+
+/// Fill `dest` from the userspace CRNG.
+///
+/// Returns false if the CRNG is busy or could not be seeded; the caller
+/// should then use the syscall.
+pub fn fill_fast(dest: &mut [u8]) -> bool {
+    if dest.len() > MAX_FAST_REQUEST {
+        return false;
+    }
+    if BUSY
+        .compare_exchange(false, true, Ordering::Acquire, Ordering::Relaxed)
+        .is_err()
+    {
+        return false;
+    }
+    let ok = unsafe { (*core::ptr::addr_of_mut!(CRNG)).fill(dest) };
+    BUSY.store(false, Ordering::Release);
+    ok
+}
+
+/// Drop the CRNG state in a freshly forked child
+pub fn forget_after_fork() {
+    unsafe {
+        let crng = &mut *core::ptr::addr_of_mut!(CRNG);
+        crng.key = [0; 8];
+        crng.buf.fill(0);
+        crng.pos = BATCH_BYTES;
+        crng.budget = 0;
+    }
+    BUSY.store(false, Ordering::Release);
+}
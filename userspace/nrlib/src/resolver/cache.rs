@@ -0,0 +1,200 @@
+/// Per-process DNS answer cache
+///
+/// Remembers positive and negative DNS answers, honoring their TTLs, so
+/// repeated lookups of the same name (a client reconnecting, a daemon
+/// re-resolving its servers) skip the network round trip. Shared by every
+/// thread in the process.
+use core::hint::spin_loop;
+use core::sync::atomic::{AtomicBool, Ordering};
+
+use super::constants::{
+    DNS_CACHE_ENTRIES, DNS_CACHE_MAX_TTL, DNS_CACHE_NEGATIVE_TTL, MAX_HOSTNAME,
+};
+
+/// One remembered answer
+#[derive(Clone, Copy)]
+struct CacheEntry {
+    name: [u8; MAX_HOSTNAME],
+    name_len: usize,
+    /// None records that the name does not exist
+    ip: Option<[u8; 4]>,
+    /// Monotonic milliseconds after which the entry is stale
+    expires_ms: u64,
+}
+
+impl CacheEntry {
+    const fn empty() -> Self {
+        Self {
+            name: [0; MAX_HOSTNAME],
+            name_len: 0,
+            ip: None,
+            expires_ms: 0,
+        }
+    }
+
+    fn matches(&self, name: &str) -> bool {
+        self.name_len == name.len()
+            && self.name[..self.name_len].eq_ignore_ascii_case(name.as_bytes())
+    }
+}
+
+/// Fixed-size answer table
+pub struct DnsCache {
+    entries: [CacheEntry; DNS_CACHE_ENTRIES],
+}
+
+impl DnsCache {
+    pub const fn new() -> Self {
+        Self {
+            entries: [CacheEntry::empty(); DNS_CACHE_ENTRIES],
+        }
+    }
+
+    /// Cached answer for `name` at time `now_ms`
+    ///
+    /// `Some(Some(ip))` is a positive hit, `Some(None)` a cached "no such
+    /// name", and `None` a miss.
+    pub fn lookup(&self, name: &str, now_ms: u64) -> Option<Option<[u8; 4]>> {
+        self.entries
+            .iter()
+            .find(|e| e.expires_ms > now_ms && e.matches(name))
+            .map(|e| e.ip)
+    }
+
+    /// Remember an answer for `ttl_secs`, replacing any older answer for
+    /// the name, else an expired entry, else the one closest to expiry
+    pub fn insert(&mut self, name: &str, ip: Option<[u8; 4]>, ttl_secs: u32, now_ms: u64) {
+        if name.is_empty() || name.len() > MAX_HOSTNAME || ttl_secs == 0 {
+            return;
+        }
+        let ttl_secs = ttl_secs.min(DNS_CACHE_MAX_TTL);
+
+        let slot = match self
+            .entries
+            .iter()
+            .position(|e| e.name_len > 0 && e.matches(name))
+        {
+            Some(idx) => idx,
+            None => {
+                let mut victim = 0;
+                for (idx, entry) in self.entries.iter().enumerate() {
+                    if entry.expires_ms <= now_ms {
+                        victim = idx;
+                        break;
+                    }
+                    if entry.expires_ms < self.entries[victim].expires_ms {
+                        victim = idx;
+                    }
+                }
+                victim
+            }
+        };
+
+        let entry = &mut self.entries[slot];
+        entry.name[..name.len()].copy_from_slice(name.as_bytes());
+        entry.name_len = name.len();
+        entry.ip = ip;
+        entry.expires_ms = now_ms + ttl_secs as u64 * 1000;
+    }
+}
+
+// ============================================================================
+// Process-wide instance
+// ============================================================================
+
+static mut GLOBAL_CACHE: DnsCache = DnsCache::new();
+static CACHE_LOCK: AtomicBool = AtomicBool::new(false);
+
+fn with_cache<R>(f: impl FnOnce(&mut DnsCache) -> R) -> R {
+    while CACHE_LOCK
+        .compare_exchange_weak(false, true, Ordering::Acquire, Ordering::Relaxed)
+        .is_err()
+    {
+        spin_loop();
+    }
+    let result = f(unsafe { &mut *core::ptr::addr_of_mut!(GLOBAL_CACHE) });
+    CACHE_LOCK.store(false, Ordering::Release);
+    result
+}
+
+/// Monotonic clock in milliseconds
+pub(crate) fn now_ms() -> u64 {
+    let (sec, nsec) = crate::time::monotonic_timespec();
+    sec as u64 * 1000 + nsec as u64 / 1_000_000
+}
+
+/// Cached answer for `name`; see [`DnsCache::lookup`]
+pub fn cache_lookup(name: &str) -> Option<Option<[u8; 4]>> {
+    let now = now_ms();
+    with_cache(|cache| cache.lookup(name, now))
+}
+
+/// Remember that `name` resolves to `ip` for `ttl_secs`
+pub fn cache_positive(name: &str, ip: [u8; 4], ttl_secs: u32) {
+    let now = now_ms();
+    with_cache(|cache| cache.insert(name, Some(ip), ttl_secs, now));
+}
+
+/// Remember that `name` does not exist, for the SOA-derived `ttl_secs`
+/// if the server sent one
+pub fn cache_negative(name: &str, ttl_secs: Option<u32>) {
+    let now = now_ms();
+    let ttl = ttl_secs.unwrap_or(DNS_CACHE_NEGATIVE_TTL);
+    with_cache(|cache| cache.insert(name, None, ttl, now));
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_cache_hit_and_expiry() {
+        let mut cache = DnsCache::new();
+        cache.insert("example.com", Some([1, 2, 3, 4]), 60, 1_000);
+        assert_eq!(cache.lookup("EXAMPLE.com", 1_000), Some(Some([1, 2, 3, 4])));
+        assert_eq!(
+            cache.lookup("example.com", 60_999),
+            Some(Some([1, 2, 3, 4]))
+        );
+        assert_eq!(cache.lookup("example.com", 61_000), None);
+        assert_eq!(cache.lookup("example.org", 1_000), None);
+    }
+
+    #[test]
+    fn test_cache_negative_and_replace() {
+        let mut cache = DnsCache::new();
+        cache.insert("missing.test", None, 30, 0);
+        assert_eq!(cache.lookup("missing.test", 10), Some(None));
+        cache.insert("missing.test", Some([5, 6, 7, 8]), 30, 20);
+        assert_eq!(cache.lookup("missing.test", 30), Some(Some([5, 6, 7, 8])));
+    }
+
+    #[test]
+    fn test_cache_zero_ttl_and_cap() {
+        let mut cache = DnsCache::new();
+        cache.insert("now.test", Some([1, 1, 1, 1]), 0, 0);
+        assert_eq!(cache.lookup("now.test", 0), None);
+        cache.insert("long.test", Some([2, 2, 2, 2]), u32::MAX, 0);
+        assert_eq!(
+            cache.lookup("long.test", DNS_CACHE_MAX_TTL as u64 * 1000),
+            None
+        );
+    }
+
+    #[test]
+    fn test_cache_evicts_soonest_expiry() {
+        let mut cache = DnsCache::new();
+        let mut name = [0u8; 8];
+        for i in 0..DNS_CACHE_ENTRIES {
+            name[..4].copy_from_slice(b"host");
+            name[4] = b'a' + (i / 26) as u8;
+            name[5] = b'a' + (i % 26) as u8;
+            let host = core::str::from_utf8(&name[..6]).unwrap();
+            cache.insert(host, Some([10, 0, 0, i as u8]), 100 + i as u32, 0);
+        }
+        cache.insert("newcomer", Some([9, 9, 9, 9]), 100, 0);
+        assert_eq!(cache.lookup("newcomer", 0), Some(Some([9, 9, 9, 9])));
+        assert_eq!(cache.lookup("hostaa", 0), None);
+        assert_eq!(cache.lookup("hostab", 0), Some(Some([10, 0, 0, 1])));
+    }
+}
@@ -12,6 +12,13 @@ pub(crate) const DNS_PORT: u16 = 53;
 pub(crate) const KERNEL_DNS_QUERY_CAP: usize = 3;
 pub(crate) const MAX_CNAME_DEPTH: u8 = 8;
 pub(crate) const MAX_DNS_RETRIES: u8 = 3;
+pub(crate) const DNS_CACHE_ENTRIES: usize = 64;
+/// Upper bound on how long any answer is cached, in seconds
+pub(crate) const DNS_CACHE_MAX_TTL: u32 = 3600;
+/// Negative-answer lifetime when the server sends no SOA, in seconds
+pub(crate) const DNS_CACHE_NEGATIVE_TTL: u32 = 30;
+/// Head start each nameserver gets before the next one is also queried
+pub(crate) const DNS_RACE_DELAY_MS: u64 = 250;
 
 // ============================================================================
 // AI flags for getaddrinfo
@@ -11,13 +11,27 @@ use crate::socket::{
     bind, parse_ipv4, recvfrom, sendto, socket, SockAddr, SockAddrIn, AF_INET, SOCK_DGRAM,
 };
 
-use super::constants::{DNS_PORT, MAX_CNAME_DEPTH, MAX_DNS_RETRIES, MAX_HOSTNAME};
-use super::dns_parser::{parse_dns_response, DnsParseOutcome};
+use super::cache::{cache_lookup, cache_negative, cache_positive, now_ms};
+use super::constants::{
+    DNS_PORT, DNS_RACE_DELAY_MS, MAX_CNAME_DEPTH, MAX_DNS_RETRIES, MAX_HOSTNAME,
+};
+use super::dns_parser::{negative_ttl, parse_dns_response_with_ttl, DnsParseOutcome};
 use super::types::{HostEntry, NssSource};
 
 /// Atomic counter for generating unique DNS transaction IDs
 static DNS_TRANSACTION_COUNTER: AtomicU16 = AtomicU16::new(0x1337);
 
+/// Outcome of resolving one name over DNS
+#[derive(Clone, Copy)]
+enum DnsLookup {
+    /// Address, and how many seconds it may be cached
+    Found([u8; 4], u32),
+    /// The name has no A record; SOA-derived cache lifetime if known
+    Missing(Option<u32>),
+    /// No usable answer (timeouts, server failures)
+    Failed,
+}
+
 /// Global resolver state
 pub struct Resolver {
     pub(crate) config: ResolverConfig,
@@ -190,76 +204,86 @@ impl Resolver {
     /// Returns the first IPv4 address found in the response
     /// Tries the hostname as-is first, then with search domains appended
     pub fn query_dns(&self, hostname: &str, nameserver_ip: [u8; 4]) -> Option<[u8; 4]> {
-        // First try the hostname as given
-        if let Some(ip) = self.query_dns_with_retry(hostname, nameserver_ip, 0) {
-            return Some(ip);
+        match self.lookup_dns(hostname, &[nameserver_ip]) {
+            DnsLookup::Found(ip, _) => Some(ip),
+            _ => None,
         }
+    }
 
-        // If hostname doesn't contain a dot, try appending search domains
-        if !hostname.contains('.') {
-            for i in 0..self.config.search_domain_count {
-                let domain = &self.config.search_domains[i];
-                // Find the actual length of the search domain
-                let domain_len = domain.iter().position(|&b| b == 0).unwrap_or(domain.len());
-                if domain_len == 0 {
-                    continue;
-                }
+    /// Resolve over DNS, racing `nameservers` against each other
+    /// Tries the hostname as-is first, then with search domains appended
+    fn lookup_dns(&self, hostname: &str, nameservers: &[[u8; 4]]) -> DnsLookup {
+        let mut result = self.query_dns_with_retry(hostname, nameservers, 0);
+        if matches!(result, DnsLookup::Found(..)) || hostname.contains('.') {
+            return result;
+        }
 
-                // Build FQDN: hostname.searchdomain
-                let mut fqdn_buf = [0u8; MAX_HOSTNAME];
-                let hostname_bytes = hostname.as_bytes();
-                if hostname_bytes.len() + 1 + domain_len >= MAX_HOSTNAME {
-                    continue;
-                }
+        // If hostname doesn't contain a dot, try appending search domains
+        for i in 0..self.config.search_domain_count {
+            let domain = &self.config.search_domains[i];
+            // Find the actual length of the search domain
+            let domain_len = domain.iter().position(|&b| b == 0).unwrap_or(domain.len());
+            if domain_len == 0 {
+                continue;
+            }
 
-                fqdn_buf[..hostname_bytes.len()].copy_from_slice(hostname_bytes);
-                fqdn_buf[hostname_bytes.len()] = b'.';
-                fqdn_buf[hostname_bytes.len() + 1..hostname_bytes.len() + 1 + domain_len]
-                    .copy_from_slice(&domain[..domain_len]);
+            // Build FQDN: hostname.searchdomain
+            let mut fqdn_buf = [0u8; MAX_HOSTNAME];
+            let hostname_bytes = hostname.as_bytes();
+            if hostname_bytes.len() + 1 + domain_len >= MAX_HOSTNAME {
+                continue;
+            }
 
-                if let Ok(fqdn) =
-                    core::str::from_utf8(&fqdn_buf[..hostname_bytes.len() + 1 + domain_len])
-                {
-                    if let Some(ip) = self.query_dns_with_retry(fqdn, nameserver_ip, 0) {
-                        return Some(ip);
-                    }
+            fqdn_buf[..hostname_bytes.len()].copy_from_slice(hostname_bytes);
+            fqdn_buf[hostname_bytes.len()] = b'.';
+            fqdn_buf[hostname_bytes.len() + 1..hostname_bytes.len() + 1 + domain_len]
+                .copy_from_slice(&domain[..domain_len]);
+
+            if let Ok(fqdn) =
+                core::str::from_utf8(&fqdn_buf[..hostname_bytes.len() + 1 + domain_len])
+            {
+                match self.query_dns_with_retry(fqdn, nameservers, 0) {
+                    found @ DnsLookup::Found(..) => return found,
+                    // An unanswered candidate means the name may still exist
+                    DnsLookup::Failed => result = DnsLookup::Failed,
+                    DnsLookup::Missing(_) => {}
                 }
             }
         }
 
-        None
+        result
     }
 
     /// Perform DNS query with retry logic
     fn query_dns_with_retry(
         &self,
         hostname: &str,
-        nameserver_ip: [u8; 4],
+        nameservers: &[[u8; 4]],
         depth: u8,
-    ) -> Option<[u8; 4]> {
+    ) -> DnsLookup {
         let max_attempts = self.config.attempts.max(1).min(MAX_DNS_RETRIES);
         for _attempt in 0..max_attempts {
-            if let Some(ip) = self.query_dns_internal(hostname, nameserver_ip, depth) {
-                return Some(ip);
+            match self.query_dns_internal(hostname, nameservers, depth) {
+                DnsLookup::Failed => {}
+                answered => return answered,
             }
         }
-        None
+        DnsLookup::Failed
     }
 
-    fn query_dns_internal(
-        &self,
-        hostname: &str,
-        nameserver_ip: [u8; 4],
-        depth: u8,
-    ) -> Option<[u8; 4]> {
-        if depth >= MAX_CNAME_DEPTH {
-            return None;
+    /// Send one query to every nameserver, happy-eyeballs style: the first
+    /// server gets a head start of DNS_RACE_DELAY_MS, then the next is asked
+    /// as well (immediately, if the first fails), and so on. The first
+    /// definite answer from any of them wins.
+    fn query_dns_internal(&self, hostname: &str, nameservers: &[[u8; 4]], depth: u8) -> DnsLookup {
+        if depth >= MAX_CNAME_DEPTH || nameservers.is_empty() {
+            return DnsLookup::Failed;
         }
 
         // Create UDP socket
         let sockfd = socket(AF_INET, SOCK_DGRAM, 0);
         if sockfd < 0 {
-            return None;
+            return DnsLookup::Failed;
         }
 
         // Helper to close socket on return
@@ -271,30 +295,12 @@ impl Resolver {
         }
         let _guard = SocketGuard(sockfd);
 
-        // Set receive timeout using setsockopt SO_RCVTIMEO
-        // This prevents recvfrom from blocking indefinitely
-        // timeval structure: tv_sec (8 bytes) + tv_usec (8 bytes) = 16 bytes
-        let timeout_secs = self.config.timeout_ms as u64 / 1000;
-        let timeout_usec = ((self.config.timeout_ms as u64 % 1000) * 1000) as u64;
-        let timeval = [timeout_secs, timeout_usec];
-        const SOL_SOCKET: i32 = 1;
-        const SO_RCVTIMEO: i32 = 20;
-        unsafe {
-            crate::libc_compat::network::setsockopt(
-                sockfd,
-                SOL_SOCKET,
-                SO_RCVTIMEO,
-                timeval.as_ptr() as *const crate::c_void,
-                16, // sizeof(timeval)
-            );
-        }
-
         // Bind to any local address and port (0.0.0.0:0)
         // This is essential for UDP sockets to work properly
         let local_addr = SockAddrIn::new([0, 0, 0, 0], 0);
         let local_sockaddr = SockAddr::from(local_addr);
         if bind(sockfd, &local_sockaddr, mem::size_of::<SockAddr>() as u32) < 0 {
-            return None;
+            return DnsLookup::Failed;
         }
 
         // Build DNS query packet with unique transaction ID
@@ -311,87 +317,144 @@ impl Resolver {
         let query_packet = match query.build(query_id, hostname, QType::A) {
             Ok(pkt) => pkt,
             Err(_) => {
-                return None;
+                return DnsLookup::Failed;
             }
         };
 
-        // Create destination address (nameserver at port 53)
-        let dest_addr = SockAddrIn::new(nameserver_ip, DNS_PORT);
-        let dest_sockaddr = SockAddr::from(dest_addr);
+        let timeout_ms = (self.config.timeout_ms as u64).max(1);
+        let mut sent = 0usize;
+        let mut failed = 0usize;
+        let mut next_send_ms = 0u64;
+        let mut deadline_ms = 0u64;
+        let mut response_buf = [0u8; 512];
 
-        // Send DNS query
-        let sent = sendto(
-            sockfd,
-            query_packet.as_ptr(),
-            query_packet.len(),
-            0,
-            &dest_sockaddr,
-            mem::size_of::<SockAddr>() as u32,
-        );
+        loop {
+            let now = now_ms();
+
+            if sent < nameservers.len() && now >= next_send_ms {
+                // Create destination address (nameserver at port 53)
+                let dest_addr = SockAddrIn::new(nameservers[sent], DNS_PORT);
+                let dest_sockaddr = SockAddr::from(dest_addr);
+                sent += 1;
+
+                let result = sendto(
+                    sockfd,
+                    query_packet.as_ptr(),
+                    query_packet.len(),
+                    0,
+                    &dest_sockaddr,
+                    mem::size_of::<SockAddr>() as u32,
+                );
+
+                // Prevent optimizer from eliding the syscall result check
+                let result = black_box(result);
+
+                if result < 0 || result as usize != query_packet.len() {
+                    // Unreachable server: move on to the next one right away
+                    failed += 1;
+                    next_send_ms = now;
+                } else {
+                    next_send_ms = now + DNS_RACE_DELAY_MS;
+                    deadline_ms = now + timeout_ms;
+                }
+                continue;
+            }
 
-        // Prevent optimizer from eliding the syscall result check
-        let sent = black_box(sent);
+            if failed >= nameservers.len() || now >= deadline_ms {
+                return DnsLookup::Failed;
+            }
 
-        if sent < 0 || sent as usize != query_packet.len() {
-            return None;
-        }
+            // Wait for an answer until the next server is due or time runs out
+            let wake_ms = if sent < nameservers.len() {
+                next_send_ms.min(deadline_ms)
+            } else {
+                deadline_ms
+            };
+            set_recv_timeout(sockfd, (wake_ms - now).max(1));
 
-        // Receive DNS response (allocate buffer on stack)
-        let mut response_buf = [0u8; 512];
-        let received = recvfrom(
-            sockfd,
-            response_buf.as_mut_ptr(),
-            512,
-            0,
-            core::ptr::null_mut(),
-            core::ptr::null_mut(),
-        );
+            let received = recvfrom(
+                sockfd,
+                response_buf.as_mut_ptr(),
+                512,
+                0,
+                core::ptr::null_mut(),
+                core::ptr::null_mut(),
+            );
 
-        // Prevent optimizer from eliding the syscall result check
-        let received = black_box(received);
+            // Prevent optimizer from eliding the syscall result check
+            let received = black_box(received);
 
-        if received <= 0 {
-            return None;
-        }
+            // Minimum DNS response size check (header only is 12 bytes)
+            if received < 12 {
+                continue;
+            }
+            let response_data = &response_buf[..received as usize];
 
-        // Minimum DNS response size check (header only is 12 bytes)
-        if (received as usize) < 12 {
-            return None;
-        }
+            // Late answers to an earlier query are not ours
+            if u16::from_be_bytes([response_data[0], response_data[1]]) != query_id {
+                continue;
+            }
+
+            // NXDOMAIN is a definite answer, not a server failure
+            if response_data[3] & 0x0F == 3 {
+                return DnsLookup::Missing(negative_ttl(response_data));
+            }
 
-        // Parse DNS response
-        let response_data = &response_buf[..received as usize];
-        let mut cname_buf = [0u8; MAX_HOSTNAME];
-        let mut scratch_buf = [0u8; MAX_HOSTNAME];
-        let outcome =
-            match parse_dns_response(response_data, query_id, &mut cname_buf, &mut scratch_buf) {
+            // Parse DNS response
+            let mut cname_buf = [0u8; MAX_HOSTNAME];
+            let mut scratch_buf = [0u8; MAX_HOSTNAME];
+            let (outcome, ttl) = match parse_dns_response_with_ttl(
+                response_data,
+                query_id,
+                &mut cname_buf,
+                &mut scratch_buf,
+            ) {
                 Ok(result) => result,
-                Err(_) => return None,
+                Err(_) => {
+                    // SERVFAIL, REFUSED or garbage: ask the next server now
+                    failed += 1;
+                    next_send_ms = now;
+                    continue;
+                }
             };
 
-        match outcome {
-            DnsParseOutcome::Address(ip) => Some(ip),
-            DnsParseOutcome::Cname(len) => {
-                if len == 0 {
-                    return None;
-                }
-                let cname = core::str::from_utf8(&cname_buf[..len]).ok()?;
-                // Prevent CNAME loops by checking if we've seen this name
-                if cname.eq_ignore_ascii_case(hostname) {
-                    return None;
-                }
-                // Validate CNAME is a proper hostname
-                if cname.is_empty() || cname.len() > 253 {
-                    return None;
+            return match outcome {
+                DnsParseOutcome::Address(ip) => DnsLookup::Found(ip, ttl),
+                DnsParseOutcome::Cname(len) => {
+                    if len == 0 {
+                        return DnsLookup::Failed;
+                    }
+                    let cname = match core::str::from_utf8(&cname_buf[..len]) {
+                        Ok(name) => name,
+                        Err(_) => return DnsLookup::Failed,
+                    };
+                    // Prevent CNAME loops by checking if we've seen this name
+                    if cname.eq_ignore_ascii_case(hostname) {
+                        return DnsLookup::Failed;
+                    }
+                    // Validate CNAME is a proper hostname
+                    if cname.is_empty() || cname.len() > 253 {
+                        return DnsLookup::Failed;
+                    }
+                    // The answer lives no longer than the alias pointing at it
+                    match self.query_dns_internal(cname, nameservers, depth + 1) {
+                        DnsLookup::Found(ip, target_ttl) => {
+                            DnsLookup::Found(ip, ttl.min(target_ttl))
+                        }
+                        DnsLookup::Missing(neg_ttl) => {
+                            DnsLookup::Missing(neg_ttl.map(|t| t.min(ttl)))
+                        }
+                        DnsLookup::Failed => DnsLookup::Failed,
+                    }
                 }
-                self.query_dns_internal(cname, nameserver_ip, depth + 1)
-            }
-            DnsParseOutcome::NoAnswer => None,
+                DnsParseOutcome::NoAnswer => DnsLookup::Missing(negative_ttl(response_data)),
+            };
         }
     }
 
     /// Resolve hostname to IPv4 address using NSS sources
     /// First checks /etc/hosts (if Files is in nsswitch), then DNS (if Dns is in nsswitch)
+    /// DNS answers are served from the per-process cache while their TTL lasts
     pub fn resolve(&self, hostname: &str) -> Option<[u8; 4]> {
         // Try each NSS source in order
         for source in self.nss_sources() {
@@ -402,12 +465,21 @@ impl Resolver {
                     }
                 }
                 NssSource::Dns => {
-                    // Try each configured nameserver
-                    for i in 0..self.config.nameserver_count {
-                        let ns = self.config.nameservers[i];
-                        if let Some(ip) = self.query_dns(hostname, ns) {
+                    match cache_lookup(hostname) {
+                        Some(Some(ip)) => return Some(ip),
+                        // Known not to exist: fall through to later sources
+                        Some(None) => continue,
+                        None => {}
+                    }
+
+                    let nameservers = &self.config.nameservers[..self.config.nameserver_count];
+                    match self.lookup_dns(hostname, nameservers) {
+                        DnsLookup::Found(ip, ttl) => {
+                            cache_positive(hostname, ip, ttl);
                             return Some(ip);
                         }
+                        DnsLookup::Missing(ttl) => cache_negative(hostname, ttl),
+                        DnsLookup::Failed => {}
                     }
                 }
                 NssSource::Mdns => {
@@ -423,6 +495,23 @@ impl Resolver {
     }
 }
 
+/// Set SO_RCVTIMEO so recvfrom gives up after `ms` milliseconds
+fn set_recv_timeout(sockfd: i32, ms: u64) {
+    // timeval structure: tv_sec (8 bytes) + tv_usec (8 bytes) = 16 bytes
+    let timeval = [ms / 1000, (ms % 1000) * 1000];
+    const SOL_SOCKET: i32 = 1;
+    const SO_RCVTIMEO: i32 = 20;
+    unsafe {
+        crate::libc_compat::network::setsockopt(
+            sockfd,
+            SOL_SOCKET,
+            SO_RCVTIMEO,
+            timeval.as_ptr() as *const crate::c_void,
+            16, // sizeof(timeval)
+        );
+    }
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
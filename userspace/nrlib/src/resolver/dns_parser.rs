@@ -31,6 +31,19 @@ pub fn parse_dns_response(
     cname_buf: &mut [u8],
     scratch_buf: &mut [u8],
 ) -> Result<DnsParseOutcome, &'static str> {
+    parse_dns_response_with_ttl(data, expected_id, cname_buf, scratch_buf)
+        .map(|(outcome, _)| outcome)
+}
+
+/// Parse a DNS response packet, also returning how long the answer may be
+/// cached: the smallest TTL among the records it was derived from
+/// (u32::MAX for `NoAnswer`)
+pub fn parse_dns_response_with_ttl(
+    data: &[u8],
+    expected_id: u16,
+    cname_buf: &mut [u8],
+    scratch_buf: &mut [u8],
+) -> Result<(DnsParseOutcome, u32), &'static str> {
     // Minimum DNS response: 12 byte header + at least minimal question
     if data.len() < 12 {
         return Err("dns response too short");
@@ -99,6 +112,7 @@ pub fn parse_dns_response(
     }
 
     let mut last_cname_len: Option<usize> = None;
+    let mut min_ttl = u32::MAX;
 
     for _ in 0..answer_count {
         skip_name(data, &mut offset)?;
@@ -106,6 +120,7 @@ pub fn parse_dns_response(
             return Err("dns answer header overflow");
         }
         let rtype = u16::from_be_bytes([data[offset], data[offset + 1]]);
+        let ttl = record_ttl(data, offset);
         let rdlength = u16::from_be_bytes([data[offset + 8], data[offset + 9]]) as usize;
         offset += 10;
         if offset + rdlength > data.len() {
@@ -123,7 +138,7 @@ pub fn parse_dns_response(
                 }
                 let mut ip = [0u8; 4];
                 ip.copy_from_slice(&data[offset..offset + 4]);
-                return Ok(DnsParseOutcome::Address(ip));
+                return Ok((DnsParseOutcome::Address(ip), min_ttl.min(ttl)));
             }
             5 => {
                 // CNAME record - read the canonical name
@@ -132,6 +147,7 @@ pub fn parse_dns_response(
                 let mut temp_offset = rdata_start;
                 let len = read_name_into(data, &mut temp_offset, cname_buf)?;
                 last_cname_len = Some(len);
+                min_ttl = min_ttl.min(ttl);
                 // Skip past the entire rdata section
                 offset = rdata_start + rdlength;
                 continue;
@@ -162,19 +178,20 @@ pub fn parse_dns_response(
                 Err(_) => {
                     // If we can't parse additional records, just return CNAME
                     // The caller will do a followup query
-                    return Ok(DnsParseOutcome::Cname(len));
+                    return Ok((DnsParseOutcome::Cname(len), min_ttl));
                 }
             };
             if offset + 10 > data.len() {
                 // Truncated additional section, return CNAME for followup
-                return Ok(DnsParseOutcome::Cname(len));
+                return Ok((DnsParseOutcome::Cname(len), min_ttl));
             }
             let rtype = u16::from_be_bytes([data[offset], data[offset + 1]]);
+            let ttl = record_ttl(data, offset);
             let rdlength = u16::from_be_bytes([data[offset + 8], data[offset + 9]]) as usize;
             offset += 10;
             if offset + rdlength > data.len() {
                 // Truncated data, return CNAME for followup
-                return Ok(DnsParseOutcome::Cname(len));
+                return Ok((DnsParseOutcome::Cname(len), min_ttl));
             }
             if rtype == 1
                 && rdlength == 4
@@ -183,11 +200,11 @@ pub fn parse_dns_response(
             {
                 let mut ip = [0u8; 4];
                 ip.copy_from_slice(&data[offset..offset + 4]);
-                return Ok(DnsParseOutcome::Address(ip));
+                return Ok((DnsParseOutcome::Address(ip), min_ttl.min(ttl)));
             }
             offset += rdlength;
         }
-        return Ok(DnsParseOutcome::Cname(len));
+        return Ok((DnsParseOutcome::Cname(len), min_ttl));
     }
 
     // Skip additional section if we didn't find any answers
@@ -197,7 +214,61 @@ pub fn parse_dns_response(
         skip_resource_record(data, &mut offset)?;
     }
 
-    Ok(DnsParseOutcome::NoAnswer)
+    Ok((DnsParseOutcome::NoAnswer, u32::MAX))
+}
+
+/// TTL of the resource record whose fixed header starts at `offset`
+fn record_ttl(data: &[u8], offset: usize) -> u32 {
+    u32::from_be_bytes([
+        data[offset + 4],
+        data[offset + 5],
+        data[offset + 6],
+        data[offset + 7],
+    ])
+}
+
+/// How long a negative answer (NXDOMAIN or no records) may be cached
+///
+/// Per RFC 2308 this is the smaller of the SOA record's own TTL and its
+/// MINIMUM field; None when the authority section carries no SOA.
+pub fn negative_ttl(data: &[u8]) -> Option<u32> {
+    if data.len() < 12 {
+        return None;
+    }
+    let question_count = u16::from_be_bytes([data[4], data[5]]) as usize;
+    let answer_count = u16::from_be_bytes([data[6], data[7]]) as usize;
+    let authority_count = u16::from_be_bytes([data[8], data[9]]) as usize;
+
+    let mut offset = 12;
+    for _ in 0..question_count {
+        skip_name(data, &mut offset).ok()?;
+        offset += 4;
+    }
+    for _ in 0..answer_count {
+        skip_resource_record(data, &mut offset).ok()?;
+    }
+    for _ in 0..authority_count {
+        skip_name(data, &mut offset).ok()?;
+        if offset + 10 > data.len() {
+            return None;
+        }
+        let rtype = u16::from_be_bytes([data[offset], data[offset + 1]]);
+        let ttl = record_ttl(data, offset);
+        let rdlength = u16::from_be_bytes([data[offset + 8], data[offset + 9]]) as usize;
+        offset += 10;
+        if offset + rdlength > data.len() {
+            return None;
+        }
+        // SOA rdata ends with SERIAL, REFRESH, RETRY, EXPIRE, MINIMUM
+        if rtype == 6 && rdlength >= 20 {
+            let end = offset + rdlength;
+            let minimum =
+                u32::from_be_bytes([data[end - 4], data[end - 3], data[end - 2], data[end - 1]]);
+            return Some(ttl.min(minimum));
+        }
+        offset += rdlength;
+    }
+    None
 }
 
 /// Skip a resource record in DNS packet
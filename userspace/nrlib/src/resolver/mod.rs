@@ -8,10 +8,12 @@
 /// - `constants`: AI/NI flags and EAI error codes
 /// - `types`: AddrInfo, HostEntry, NssSource type definitions
 /// - `dns_parser`: DNS response packet parsing
+/// - `cache`: Per-process TTL-honoring DNS answer cache
 /// - `utils`: Helper functions for IP formatting and file I/O
 /// - `core`: Main Resolver struct implementation
 /// - `global`: Global resolver instance and initialization
 /// - `posix`: POSIX-compatible getaddrinfo/getnameinfo functions
+mod cache;
 mod constants;
 mod core;
 mod dns_parser;
@@ -66,7 +68,9 @@ pub use global::{get_resolver, resolver_init};
 pub use posix::{freeaddrinfo, getaddrinfo, getnameinfo};
 
 // DNS parser (for advanced use cases)
-pub use dns_parser::{dns_name_equals, parse_dns_response, DnsParseOutcome};
+pub use dns_parser::{
+    dns_name_equals, negative_ttl, parse_dns_response, parse_dns_response_with_ttl, DnsParseOutcome,
+};
 
 // Utilities
 pub use utils::{format_ipv4_to_buffer, read_file_content};
@@ -2,7 +2,9 @@
 //!
 //! This module provides the internal buffering types and modes used by FILE streams.
 
-use super::constants::BUFFER_CAPACITY;
+use core::{ptr, slice};
+
+use super::constants::INLINE_BUFFER_CAPACITY;
 
 /// Buffering mode for a FILE stream
 #[repr(u8)]
@@ -26,8 +28,16 @@ pub(crate) enum LastOp {
 }
 
 /// Internal buffer for FILE streams
+///
+/// Starts out on the small inline array, which is all a terminal needs and
+/// keeps the static streams cheap. `grow` moves it to a heap buffer sized
+/// for the underlying file.
 pub(crate) struct FileBuffer {
-    pub(crate) data: [u8; BUFFER_CAPACITY],
+    inline: [u8; INLINE_BUFFER_CAPACITY],
+    /// Heap buffer of `cap` bytes, or null while `inline` is in use
+    heap: *mut u8,
+    /// Usable capacity in bytes
+    pub(crate) cap: usize,
     /// Current read position in buffer
     pub(crate) pos: usize,
     /// Number of valid bytes in buffer
@@ -38,12 +48,46 @@ impl FileBuffer {
     /// Create a new empty buffer
     pub(crate) const fn new() -> Self {
         Self {
-            data: [0; BUFFER_CAPACITY],
+            inline: [0; INLINE_BUFFER_CAPACITY],
+            heap: ptr::null_mut(),
+            cap: INLINE_BUFFER_CAPACITY,
             pos: 0,
             len: 0,
         }
     }
 
+    /// Buffer storage (`cap` bytes)
+    pub(crate) fn data(&self) -> &[u8] {
+        if self.heap.is_null() {
+            &self.inline
+        } else {
+            unsafe { slice::from_raw_parts(self.heap, self.cap) }
+        }
+    }
+
+    /// Mutable buffer storage (`cap` bytes)
+    pub(crate) fn data_mut(&mut self) -> &mut [u8] {
+        if self.heap.is_null() {
+            &mut self.inline
+        } else {
+            unsafe { slice::from_raw_parts_mut(self.heap, self.cap) }
+        }
+    }
+
+    /// Switch an empty buffer to a heap buffer of `cap` bytes
+    ///
+    /// Keeps the inline buffer if allocation fails.
+    pub(crate) fn grow(&mut self, cap: usize) {
+        if cap <= self.cap || !self.heap.is_null() || self.len != 0 {
+            return;
+        }
+        let heap = unsafe { crate::malloc(cap) } as *mut u8;
+        if !heap.is_null() {
+            self.heap = heap;
+            self.cap = cap;
+        }
+    }
+
     /// Reset buffer to empty state
     pub(crate) fn clear(&mut self) {
         self.pos = 0;
@@ -5,6 +5,7 @@
 // System call numbers
 pub(crate) const SYS_READ: u64 = 0;
 pub(crate) const SYS_WRITE: u64 = 1;
+pub(crate) const SYS_FSTAT: u64 = 5;
 
 // Standard file descriptors
 pub(crate) const STDIN: i32 = 0;
@@ -14,8 +15,17 @@ pub(crate) const STDERR: i32 = 2;
 // Error codes
 pub(crate) const EAGAIN: i32 = 11; // Resource temporarily unavailable (POSIX error code)
 
+// File type bits of st_mode
+pub(crate) const S_IFMT: u32 = 0o170000;
+pub(crate) const S_IFCHR: u32 = 0o020000;
+pub(crate) const S_IFREG: u32 = 0o100000;
+
 // Buffer sizes
-pub(crate) const BUFFER_CAPACITY: usize = 512;
+/// Inline buffer: used for terminals, and until a stream is first used
+pub(crate) const INLINE_BUFFER_CAPACITY: usize = 512;
+/// Heap buffer for files and pipes unless st_blksize asks for more
+pub(crate) const DEFAULT_BUFFER_CAPACITY: usize = 64 * 1024;
+pub(crate) const MAX_BUFFER_CAPACITY: usize = 1024 * 1024;
 pub(crate) const INT_BUFFER_SIZE: usize = 128;
 pub(crate) const FLOAT_BUFFER_SIZE: usize = 128;
 
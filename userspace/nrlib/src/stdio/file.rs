@@ -13,8 +13,11 @@ use core::{
 use crate::{get_errno, set_errno, EINVAL};
 
 use super::buffer::{BufferMode, FileBuffer, LastOp};
-use super::constants::{BUFFER_CAPACITY, EAGAIN, STDERR, STDIN, STDOUT, SYS_WRITE};
-use super::helpers::{read_fd, syscall3, write_all_fd};
+use super::constants::{
+    DEFAULT_BUFFER_CAPACITY, EAGAIN, MAX_BUFFER_CAPACITY, STDERR, STDIN, STDOUT, SYS_FSTAT,
+    SYS_WRITE, S_IFCHR, S_IFMT, S_IFREG,
+};
+use super::helpers::{read_fd, readv_fd, syscall3, write_all_fd, writev_all_fd};
 
 /// C-compatible FILE structure for stdio streams
 #[repr(C)]
@@ -26,6 +29,10 @@ pub struct FILE {
     pub(crate) last_op: LastOp,
     pub(crate) error: bool,
     pub(crate) eof: bool,
+    /// Buffer size and mode have been chosen for the fd
+    pub(crate) configured: bool,
+    /// The fd is a regular file, so reads never block part-way
+    pub(crate) regular: bool,
     pub(crate) lock: AtomicBool,
 }
 
@@ -40,6 +47,8 @@ impl FILE {
             last_op: LastOp::None,
             error: false,
             eof: false,
+            configured: false,
+            regular: false,
             lock: AtomicBool::new(false),
         }
     }
@@ -166,6 +175,43 @@ pub(crate) unsafe fn lock_stream<'a>(stream: *mut FILE) -> Result<FileGuard<'a>,
 // Internal file operations
 // ============================================================================
 
+/// Choose buffer size and mode on first use of a buffered stream
+///
+/// Terminals (character devices) keep the inline buffer and their mode.
+/// Files and pipes become fully buffered with a heap buffer of
+/// `DEFAULT_BUFFER_CAPACITY`, or st_blksize if that is larger.
+fn file_configure(file: &mut FILE) {
+    if file.configured {
+        return;
+    }
+    file.configured = true;
+
+    let mut st = crate::stat::default();
+    let ret = syscall3(SYS_FSTAT, file.fd as u64, &mut st as *mut _ as u64, 0);
+    if ret == u64::MAX || st.st_mode & S_IFMT == S_IFCHR {
+        return;
+    }
+    file.regular = st.st_mode & S_IFMT == S_IFREG;
+    if matches!(file.mode, BufferMode::Line) {
+        file.mode = BufferMode::Full;
+    }
+    let cap = (st.st_blksize.max(0) as usize).clamp(DEFAULT_BUFFER_CAPACITY, MAX_BUFFER_CAPACITY);
+    file.buffer.grow(cap);
+}
+
+/// Flush stdout before blocking on stdin, so prompts are visible even when
+/// stdout is a fully buffered pipe
+fn flush_stdout_for_input(file: &FILE) {
+    if file.fd != STDIN {
+        return;
+    }
+    unsafe {
+        if let Ok(mut guard) = lock_stream(stdout) {
+            let _ = file_flush(guard.file_mut());
+        }
+    }
+}
+
 /// Prepare FILE for writing (handle mode switch from read)
 pub(crate) fn file_prepare_write(file: &mut FILE) -> Result<(), i32> {
     if matches!(file.last_op, LastOp::Read) {
@@ -188,7 +234,7 @@ pub(crate) fn file_prepare_read(file: &mut FILE) -> Result<(), i32> {
 /// Flush pending write data from buffer to fd
 pub(crate) fn file_flush(file: &mut FILE) -> Result<(), i32> {
     if matches!(file.last_op, LastOp::Write) && file.buffer.len > 0 {
-        let data = &file.buffer.data[..file.buffer.len];
+        let data = &file.buffer.data()[..file.buffer.len];
         if let Err(err) = write_all_fd(file.fd, data) {
             file.error = true;
             set_errno(err);
@@ -217,9 +263,26 @@ pub(crate) fn file_write_bytes(file: &mut FILE, bytes: &[u8]) -> Result<(), i32>
         return Ok(());
     }
 
+    file_configure(file);
+
+    // Too big to be worth copying: send what is buffered and the payload
+    // together in one writev
+    if bytes.len() >= file.buffer.cap && file.buffer.len + bytes.len() > file.buffer.cap {
+        let pending = &file.buffer.data()[..file.buffer.len];
+        let result = writev_all_fd(file.fd, pending, bytes);
+        file.buffer.clear();
+        file.last_op = LastOp::Write;
+        if let Err(err) = result {
+            file.error = true;
+            set_errno(err);
+            return Err(err);
+        }
+        return Ok(());
+    }
+
     let mut remaining = bytes;
     while !remaining.is_empty() {
-        let available = BUFFER_CAPACITY.saturating_sub(file.buffer.len);
+        let available = file.buffer.cap - file.buffer.len;
         if available == 0 {
             // Buffer is full, need to flush. Set last_op first!
             file.last_op = LastOp::Write;
@@ -228,18 +291,16 @@ pub(crate) fn file_write_bytes(file: &mut FILE, bytes: &[u8]) -> Result<(), i32>
         }
         let chunk = cmp::min(available, remaining.len());
         let end = file.buffer.len + chunk;
-        file.buffer.data[file.buffer.len..end].copy_from_slice(&remaining[..chunk]);
+        let start = file.buffer.len;
+        file.buffer.data_mut()[start..end].copy_from_slice(&remaining[..chunk]);
         file.buffer.len = end;
 
         // Set last_op BEFORE flushing so that file_flush can see it
         file.last_op = LastOp::Write;
 
-        let newline_written = if matches!(file.mode, BufferMode::Line) {
-            remaining[..chunk].iter().any(|b| *b == b'\n')
-        } else {
-            false
-        };
-        if newline_written || file.buffer.len == BUFFER_CAPACITY {
+        let newline_written = matches!(file.mode, BufferMode::Line)
+            && unsafe { crate::memops::memchr(remaining.as_ptr(), b'\n', chunk).is_some() };
+        if newline_written || file.buffer.len == file.buffer.cap {
             file_flush(file)?;
         }
         remaining = &remaining[chunk..];
@@ -248,6 +309,40 @@ pub(crate) fn file_write_bytes(file: &mut FILE, bytes: &[u8]) -> Result<(), i32>
     Ok(())
 }
 
+/// Reserve `len` bytes at the end of the write buffer for in-place formatting
+///
+/// Returns `None` for unbuffered streams and requests larger than the
+/// buffer; the caller then formats into scratch space instead. Follow with
+/// `file_commit`.
+pub(crate) fn file_reserve(file: &mut FILE, len: usize) -> Result<Option<&mut [u8]>, i32> {
+    if matches!(file.mode, BufferMode::Unbuffered) {
+        return Ok(None);
+    }
+    file_prepare_write(file)?;
+    file_configure(file);
+    if len > file.buffer.cap {
+        return Ok(None);
+    }
+    file.last_op = LastOp::Write;
+    if file.buffer.cap - file.buffer.len < len {
+        file_flush(file)?;
+    }
+    let start = file.buffer.len;
+    Ok(Some(&mut file.buffer.data_mut()[start..start + len]))
+}
+
+/// Account for `len` bytes written into a `file_reserve` window
+///
+/// The bytes must not contain a newline (formatted numbers never do), so a
+/// line-buffered stream only needs flushing when the buffer is full.
+pub(crate) fn file_commit(file: &mut FILE, len: usize) -> Result<(), i32> {
+    file.buffer.len += len;
+    if file.buffer.len == file.buffer.cap {
+        file_flush(file)?;
+    }
+    Ok(())
+}
+
 /// Write a single byte to FILE
 pub(crate) fn file_write_byte(file: &mut FILE, byte: u8) -> Result<(), i32> {
     let buf = [byte];
@@ -289,10 +384,35 @@ pub(crate) fn file_read_bytes(file: &mut FILE, out: &mut [u8]) -> Result<usize,
         return Ok(read as usize);
     }
 
+    file_configure(file);
+
     let mut copied = 0usize;
     while copied < out.len() {
         if file.buffer.pos == file.buffer.len {
-            let read = read_fd(file.fd, file.buffer.data.as_mut_ptr(), BUFFER_CAPACITY);
+            flush_stdout_for_input(file);
+            let want = out.len() - copied;
+            let dest = out[copied..].as_mut_ptr();
+            // Large reads go straight to the caller. On regular files a
+            // smaller one fills the caller and then the buffer with one
+            // readv; elsewhere the kernel would block on the second iovec.
+            let cap = file.buffer.cap;
+            let buf = file.buffer.data_mut().as_mut_ptr();
+            let read = if want >= cap {
+                read_fd(file.fd, dest, want)
+            } else if file.regular {
+                readv_fd(file.fd, dest, want, buf, cap)
+            } else {
+                // Read into the buffer only: `dest` gets nothing
+                let read = read_fd(file.fd, buf, cap);
+                if read > 0 {
+                    file.buffer.pos = 0;
+                    file.buffer.len = read as usize;
+                    file.eof = false;
+                    file.last_op = LastOp::Read;
+                    continue;
+                }
+                read
+            };
             if read < 0 {
                 file.error = true;
                 return Err(get_errno());
@@ -301,22 +421,26 @@ pub(crate) fn file_read_bytes(file: &mut FILE, out: &mut [u8]) -> Result<usize,
                 file.eof = true;
                 break;
             }
-            file.buffer.pos = 0;
-            file.buffer.len = read as usize;
+            let read = read as usize;
             file.eof = false;
+            file.last_op = LastOp::Read;
+            if read <= want {
+                copied += read;
+            } else {
+                copied += want;
+                file.buffer.pos = 0;
+                file.buffer.len = read - want;
+            }
+            continue;
         }
 
         let available = file.buffer.len - file.buffer.pos;
         let take = cmp::min(available, out.len() - copied);
-        out[copied..copied + take]
-            .copy_from_slice(&file.buffer.data[file.buffer.pos..file.buffer.pos + take]);
+        let pos = file.buffer.pos;
+        out[copied..copied + take].copy_from_slice(&file.buffer.data()[pos..pos + take]);
         copied += take;
         file.buffer.pos += take;
         file.last_op = LastOp::Read;
-
-        if take == 0 {
-            break;
-        }
     }
 
     Ok(copied)
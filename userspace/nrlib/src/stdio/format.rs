@@ -11,17 +11,19 @@
 use core::{
     cmp,
     ffi::{c_void, VaListImpl},
-    ptr, slice,
+    slice,
 };
 
-use crate::{get_errno, set_errno, EINVAL};
+use crate::{get_errno, memops, set_errno, EINVAL};
 
 use super::constants::{
     DEFAULT_FLOAT_PRECISION, FLAG_ALT, FLAG_LEFT, FLAG_PLUS, FLAG_SPACE, FLAG_ZERO,
     FLOAT_BUFFER_SIZE, INT_BUFFER_SIZE, MAX_FLOAT_PRECISION,
 };
-use super::file::{file_write_byte, file_write_bytes, lock_stream, write_repeat, FILE};
-use super::helpers::{format_unsigned, pow10, round_f64};
+use super::file::{
+    file_commit, file_reserve, file_write_byte, file_write_bytes, lock_stream, write_repeat, FILE,
+};
+use super::helpers::{pow10, round_f64};
 
 /// Length modifier for format specifiers
 #[derive(Clone, Copy, PartialEq, Eq)]
@@ -120,16 +122,44 @@ pub(crate) fn read_unsigned_arg(args: &mut VaListImpl<'_>, length: LengthModifie
     }
 }
 
-/// Emit a formatted integer with proper padding and prefixes
-pub(crate) fn emit_formatted_integer(
-    file: &mut FILE,
-    spec: &FormatSpec,
-    negative: bool,
-    digits: &[u8],
-    uppercase: bool,
-    value_is_zero: bool,
-) -> Result<usize, i32> {
-    let sign_char = if negative {
+/// Number of digits of `value` in `base`
+fn digit_count(mut value: u128, base: u32) -> usize {
+    let base = base as u128;
+    let mut count = 1;
+    while value >= base {
+        value /= base;
+        count += 1;
+    }
+    count
+}
+
+/// Fill `out` with the low `out.len()` digits of `value`, zero-padded
+fn put_digits(out: &mut [u8], value: u128, base: u32, uppercase: bool) {
+    let table: &[u8; 16] = if uppercase {
+        b"0123456789ABCDEF"
+    } else {
+        b"0123456789abcdef"
+    };
+    if let Ok(mut small) = u64::try_from(value) {
+        // 128-bit division is a libcall; almost every argument fits in 64
+        let base = base as u64;
+        for slot in out.iter_mut().rev() {
+            *slot = table[(small % base) as usize];
+            small /= base;
+        }
+    } else {
+        let mut value = value;
+        let base = base as u128;
+        for slot in out.iter_mut().rev() {
+            *slot = table[(value % base) as usize];
+            value /= base;
+        }
+    }
+}
+
+/// Sign character for a numeric conversion
+fn sign_char(spec: &FormatSpec, negative: bool) -> Option<u8> {
+    if negative {
         Some(b'-')
     } else if spec.flags & FLAG_PLUS != 0 {
         Some(b'+')
@@ -137,46 +167,49 @@ pub(crate) fn emit_formatted_integer(
         Some(b' ')
     } else {
         None
-    };
-
-    let mut precision_buf = [0u8; INT_BUFFER_SIZE];
-    let mut digits_prec_slice = digits;
-    if let Some(mut precision) = spec.precision {
-        if precision > INT_BUFFER_SIZE {
-            precision = INT_BUFFER_SIZE;
-        }
-        if precision == 0 && digits.len() == 1 && digits[0] == b'0' && spec.specifier != b'p' {
-            digits_prec_slice = &[];
-        } else if precision > digits.len() {
-            let start = INT_BUFFER_SIZE - precision;
-            let zero_count = precision - digits.len();
-            for idx in 0..zero_count {
-                precision_buf[start + idx] = b'0';
-            }
-            precision_buf[start + zero_count..start + precision].copy_from_slice(digits);
-            digits_prec_slice = &precision_buf[start..start + precision];
-        }
     }
+}
 
-    let mut uppercase_buf = [0u8; INT_BUFFER_SIZE];
-    let digits_case = if uppercase {
-        let start = INT_BUFFER_SIZE - digits_prec_slice.len();
-        uppercase_buf[start..start + digits_prec_slice.len()].copy_from_slice(digits_prec_slice);
-        for byte in &mut uppercase_buf[start..start + digits_prec_slice.len()] {
-            byte.make_ascii_uppercase();
-        }
-        &uppercase_buf[start..start + digits_prec_slice.len()]
+/// Whether width padding uses zeros (between prefix and digits)
+fn zero_padded(spec: &FormatSpec) -> bool {
+    spec.flags & FLAG_ZERO != 0
+        && spec.flags & FLAG_LEFT == 0
+        && spec.precision.is_none()
+        && matches!(
+            spec.specifier,
+            b'd' | b'i' | b'u' | b'x' | b'X' | b'o' | b'p'
+        )
+}
+
+/// Emit a formatted integer with proper padding and prefixes
+///
+/// Digits are produced straight into the stream buffer when the whole field
+/// fits; otherwise into a small scratch array and written piecewise.
+pub(crate) fn emit_formatted_integer(
+    file: &mut FILE,
+    spec: &FormatSpec,
+    negative: bool,
+    value: u128,
+    base: u32,
+    uppercase: bool,
+) -> Result<usize, i32> {
+    let sign = sign_char(spec, negative);
+    let digits = if value == 0 && spec.precision == Some(0) && spec.specifier != b'p' {
+        0
     } else {
-        digits_prec_slice
+        digit_count(value, base)
     };
+    let zeros = spec.precision.map_or(0, |p| p.saturating_sub(digits));
+    let body_len = zeros + digits;
 
     let mut prefix: &[u8] = b"";
     if spec.flags & FLAG_ALT != 0 {
         match spec.specifier {
-            b'x' if !value_is_zero && !digits_case.is_empty() => prefix = b"0x",
-            b'X' if !value_is_zero && !digits_case.is_empty() => prefix = b"0X",
+            b'x' if value != 0 && body_len > 0 => prefix = b"0x",
+            b'X' if value != 0 && body_len > 0 => prefix = b"0X",
             b'o' => {
-                if digits_case.is_empty() || digits_case[0] != b'0' {
+                let leading_zero = zeros > 0 || (digits > 0 && value == 0);
+                if !leading_zero {
                     prefix = b"0";
                 }
             }
@@ -186,62 +219,76 @@ pub(crate) fn emit_formatted_integer(
         prefix = b"0x";
     }
 
-    write_formatted_block(file, spec, sign_char, prefix, digits_case)
+    let total_len = sign.map_or(0, |_| 1) + prefix.len() + body_len;
+    let padding = spec.width.unwrap_or(0).saturating_sub(total_len);
+    let field = total_len + padding;
+
+    if let Some(out) = file_reserve(file, field)? {
+        let left = spec.flags & FLAG_LEFT != 0;
+        let zero_pad = zero_padded(spec);
+        let mut at = 0;
+        if !left && !zero_pad {
+            out[..padding].fill(b' ');
+            at = padding;
+        }
+        if let Some(ch) = sign {
+            out[at] = ch;
+            at += 1;
+        }
+        out[at..at + prefix.len()].copy_from_slice(prefix);
+        at += prefix.len();
+        let lead = zeros + if zero_pad { padding } else { 0 };
+        out[at..at + lead].fill(b'0');
+        at += lead;
+        put_digits(&mut out[at..at + digits], value, base, uppercase);
+        at += digits;
+        out[at..].fill(b' ');
+        file_commit(file, field)?;
+        return Ok(field);
+    }
+
+    let mut scratch = [0u8; INT_BUFFER_SIZE];
+    let start = INT_BUFFER_SIZE - digits;
+    put_digits(&mut scratch[start..], value, base, uppercase);
+    write_formatted_block(file, spec, sign, prefix, zeros, &scratch[start..])
 }
 
 /// Write a formatted block with proper padding
+///
+/// `zeros` precision zeros go between `prefix` and `body`.
 pub(crate) fn write_formatted_block(
     file: &mut FILE,
     spec: &FormatSpec,
     sign: Option<u8>,
     prefix: &[u8],
+    zeros: usize,
     body: &[u8],
 ) -> Result<usize, i32> {
     let sign_len = sign.map(|_| 1).unwrap_or(0);
-    let total_len = sign_len + prefix.len() + body.len();
+    let total_len = sign_len + prefix.len() + zeros + body.len();
     let width = spec.width.unwrap_or(0);
     let left = spec.flags & FLAG_LEFT != 0;
-    let zero_allowed = spec.flags & FLAG_ZERO != 0 && !left && spec.precision.is_none();
-    let pad_char = if zero_allowed
-        && matches!(
-            spec.specifier,
-            b'd' | b'i' | b'u' | b'x' | b'X' | b'o' | b'p'
-        ) {
-        b'0'
-    } else {
-        b' '
-    };
+    let pad_char = if zero_padded(spec) { b'0' } else { b' ' };
     let padding = width.saturating_sub(total_len);
 
-    if !left {
-        if pad_char == b' ' {
-            write_repeat(file, b' ', padding)?;
-        }
-        if let Some(ch) = sign {
-            file_write_byte(file, ch)?;
-        }
-        if !prefix.is_empty() {
-            file_write_bytes(file, prefix)?;
-        }
-        if pad_char == b'0' {
-            write_repeat(file, b'0', padding)?;
-        }
-        if !body.is_empty() {
-            file_write_bytes(file, body)?;
-        }
-    } else {
-        if let Some(ch) = sign {
-            file_write_byte(file, ch)?;
-        }
-        if !prefix.is_empty() {
-            file_write_bytes(file, prefix)?;
-        }
-        if !body.is_empty() {
-            file_write_bytes(file, body)?;
-        }
-        if padding > 0 {
-            write_repeat(file, b' ', padding)?;
-        }
+    if !left && pad_char == b' ' {
+        write_repeat(file, b' ', padding)?;
+    }
+    if let Some(ch) = sign {
+        file_write_byte(file, ch)?;
+    }
+    if !prefix.is_empty() {
+        file_write_bytes(file, prefix)?;
+    }
+    if !left && pad_char == b'0' {
+        write_repeat(file, b'0', padding)?;
+    }
+    write_repeat(file, b'0', zeros)?;
+    if !body.is_empty() {
+        file_write_bytes(file, body)?;
+    }
+    if left {
+        write_repeat(file, b' ', padding)?;
     }
 
     Ok(total_len + padding)
@@ -256,20 +303,12 @@ pub(crate) fn handle_float(
 ) -> Result<usize, i32> {
     if value.is_nan() {
         let txt = if uppercase { b"NAN" } else { b"nan" };
-        return write_formatted_block(file, spec, None, b"", txt);
+        return write_formatted_block(file, spec, None, b"", 0, txt);
     }
+    let sign = sign_char(spec, value.is_sign_negative());
     if value.is_infinite() {
-        let sign = if value.is_sign_negative() {
-            Some(b'-')
-        } else if spec.flags & FLAG_PLUS != 0 {
-            Some(b'+')
-        } else if spec.flags & FLAG_SPACE != 0 {
-            Some(b' ')
-        } else {
-            None
-        };
         let txt = if uppercase { b"INF" } else { b"inf" };
-        return write_formatted_block(file, spec, sign, b"", txt);
+        return write_formatted_block(file, spec, sign, b"", 0, txt);
     }
 
     let precision = spec
@@ -278,8 +317,11 @@ pub(crate) fn handle_float(
         .min(MAX_FLOAT_PRECISION);
     let decimal_point = precision > 0 || (spec.flags & FLAG_ALT != 0);
 
-    let negative = value.is_sign_negative();
-    let abs_value = if negative { -value } else { value };
+    let abs_value = if value.is_sign_negative() {
+        -value
+    } else {
+        value
+    };
 
     let scale = pow10(precision);
     let scaled = round_f64(abs_value * scale as f64).min(u128::MAX as f64);
@@ -288,47 +330,39 @@ pub(crate) fn handle_float(
     let int_part = scaled_u128 / scale;
     let frac_part = scaled_u128 % scale;
 
-    let (int_buf, int_idx) = format_unsigned(int_part, 10, 1);
-    let integer_digits = &int_buf[int_idx..];
-
-    let mut float_buf = [0u8; FLOAT_BUFFER_SIZE];
-    let mut cursor = 0usize;
-    float_buf[cursor..cursor + integer_digits.len()].copy_from_slice(integer_digits);
-    cursor += integer_digits.len();
-
-    if decimal_point {
-        float_buf[cursor] = b'.';
-        cursor += 1;
-        if precision > 0 {
-            let (frac_buf, _) = format_unsigned(frac_part, 10, precision.max(1));
-            let start = INT_BUFFER_SIZE - precision;
-            float_buf[cursor..cursor + precision]
-                .copy_from_slice(&frac_buf[start..start + precision]);
-            cursor += precision;
+    // Body: integer digits, then the point and `precision` fraction digits
+    let int_len = digit_count(int_part, 10);
+    let body_len = int_len + if decimal_point { 1 + precision } else { 0 };
+    let mut scratch = [0u8; FLOAT_BUFFER_SIZE];
+    let fill_body = |body: &mut [u8]| {
+        put_digits(&mut body[..int_len], int_part, 10, false);
+        if decimal_point {
+            body[int_len] = b'.';
+            put_digits(&mut body[int_len + 1..], frac_part, 10, false);
         }
-    }
+    };
 
-    let mut body_slice = &float_buf[..cursor];
-    let mut upper_buf = [0u8; FLOAT_BUFFER_SIZE];
-    if uppercase {
-        upper_buf[..body_slice.len()].copy_from_slice(body_slice);
-        for byte in &mut upper_buf[..body_slice.len()] {
-            byte.make_ascii_uppercase();
+    let total_len = sign.map_or(0, |_| 1) + body_len;
+    let padding = spec.width.unwrap_or(0).saturating_sub(total_len);
+    let field = total_len + padding;
+    if let Some(out) = file_reserve(file, field)? {
+        let mut at = 0;
+        if spec.flags & FLAG_LEFT == 0 {
+            out[..padding].fill(b' ');
+            at = padding;
+        }
+        if let Some(ch) = sign {
+            out[at] = ch;
+            at += 1;
         }
-        body_slice = &upper_buf[..body_slice.len()];
+        fill_body(&mut out[at..at + body_len]);
+        out[at + body_len..].fill(b' ');
+        file_commit(file, field)?;
+        return Ok(field);
     }
 
-    let sign = if negative {
-        Some(b'-')
-    } else if spec.flags & FLAG_PLUS != 0 {
-        Some(b'+')
-    } else if spec.flags & FLAG_SPACE != 0 {
-        Some(b' ')
-    } else {
-        None
-    };
-
-    write_formatted_block(file, spec, sign, b"", body_slice)
+    fill_body(&mut scratch[..body_len]);
+    write_formatted_block(file, spec, sign, b"", 0, &scratch[..body_len])
 }
 
 /// Main printf implementation - parse format string and write formatted output
@@ -337,22 +371,12 @@ pub(crate) unsafe fn write_formatted(
     fmt_ptr: *const u8,
     args: &mut VaListImpl<'_>,
 ) -> Result<i32, i32> {
-    use super::helpers::format_signed;
-
     if fmt_ptr.is_null() {
         set_errno(EINVAL);
         return Err(EINVAL);
     }
 
-    let len = {
-        let mut idx = 0usize;
-        while ptr::read(fmt_ptr.add(idx)) != 0 {
-            idx += 1;
-        }
-        idx
-    };
-
-    let fmt = slice::from_raw_parts(fmt_ptr, len);
+    let fmt = slice::from_raw_parts(fmt_ptr, memops::strlen(fmt_ptr));
     let mut total_written = 0i32;
 
     let mut guard = lock_stream(stream).map_err(|_| get_errno())?;
@@ -362,9 +386,12 @@ pub(crate) unsafe fn write_formatted(
     while i < fmt.len() {
         let ch = fmt[i];
         if ch != b'%' {
-            file_write_byte(file, ch)?;
-            total_written += 1;
-            i += 1;
+            // Copy the literal run up to the next conversion in one go
+            let rest = &fmt[i..];
+            let run = memops::memchr(rest.as_ptr(), b'%', rest.len()).unwrap_or(rest.len());
+            file_write_bytes(file, &rest[..run])?;
+            total_written += run as i32;
+            i += run;
             continue;
         }
 
@@ -480,13 +507,13 @@ pub(crate) unsafe fn write_formatted(
         match spec.specifier {
             b'%' => {
                 let percent = [b'%'];
-                let written = write_formatted_block(file, &spec, None, b"", &percent)?;
+                let written = write_formatted_block(file, &spec, None, b"", 0, &percent)?;
                 total_written += written as i32;
             }
             b'c' => {
                 let v: i32 = args.arg();
                 let byte = (v & 0xFF) as u8;
-                let written = write_formatted_block(file, &spec, None, b"", &[byte])?;
+                let written = write_formatted_block(file, &spec, None, b"", 0, &[byte])?;
                 total_written += written as i32;
             }
             b's' => {
@@ -494,63 +521,52 @@ pub(crate) unsafe fn write_formatted(
                 let slice = if ptr.is_null() {
                     b"(null)"
                 } else {
-                    let mut len = 0usize;
-                    while ptr::read(ptr.add(len)) != 0 {
-                        len += 1;
-                    }
-                    slice::from_raw_parts(ptr, len)
+                    slice::from_raw_parts(ptr, memops::strlen(ptr))
                 };
                 let truncated = if let Some(precision) = spec.precision {
                     &slice[..cmp::min(precision, slice.len())]
                 } else {
                     slice
                 };
-                let written = write_formatted_block(file, &spec, None, b"", truncated)?;
+                let written = write_formatted_block(file, &spec, None, b"", 0, truncated)?;
                 total_written += written as i32;
             }
             b'd' | b'i' => {
                 let value = read_signed_arg(args, spec.length);
-                let (negative, buf, idx) = format_signed(value, 10, 1);
-                let digits = &buf[idx..];
-                let written =
-                    emit_formatted_integer(file, &spec, negative, digits, false, value == 0)?;
-                total_written += written as i32;
-            }
-            b'u' => {
-                let value = read_unsigned_arg(args, spec.length);
-                let (buf, idx) = format_unsigned(value, 10, 1);
-                let digits = &buf[idx..];
-                let written =
-                    emit_formatted_integer(file, &spec, false, digits, false, value == 0)?;
+                let written = emit_formatted_integer(
+                    file,
+                    &spec,
+                    value < 0,
+                    value.unsigned_abs(),
+                    10,
+                    false,
+                )?;
                 total_written += written as i32;
             }
-            b'x' | b'X' => {
+            b'u' | b'x' | b'X' | b'o' => {
                 let value = read_unsigned_arg(args, spec.length);
+                let base = match spec.specifier {
+                    b'u' => 10,
+                    b'o' => 8,
+                    _ => 16,
+                };
                 let uppercase = spec.specifier == b'X';
-                let (buf, idx) = format_unsigned(value, 16, 1);
-                let digits = &buf[idx..];
-                let written =
-                    emit_formatted_integer(file, &spec, false, digits, uppercase, value == 0)?;
-                total_written += written as i32;
-            }
-            b'o' => {
-                let value = read_unsigned_arg(args, spec.length);
-                let (buf, idx) = format_unsigned(value, 8, 1);
-                let digits = &buf[idx..];
-                let written =
-                    emit_formatted_integer(file, &spec, false, digits, false, value == 0)?;
+                let written = emit_formatted_integer(file, &spec, false, value, base, uppercase)?;
                 total_written += written as i32;
             }
             b'p' => {
                 let value: *const c_void = args.arg();
-                let addr = value as usize as u128;
-                let (buf, idx) = format_unsigned(addr, 16, 1);
-                let digits = &buf[idx..];
                 let mut pointer_spec = spec;
                 pointer_spec.specifier = b'p';
                 pointer_spec.flags &= !(FLAG_ALT | FLAG_ZERO);
-                let written =
-                    emit_formatted_integer(file, &pointer_spec, false, digits, false, addr == 0)?;
+                let written = emit_formatted_integer(
+                    file,
+                    &pointer_spec,
+                    false,
+                    value as usize as u128,
+                    16,
+                    false,
+                )?;
                 total_written += written as i32;
             }
             b'f' | b'F' => {
@@ -1,11 +1,12 @@
 //! Helper functions for stdio module
 //!
-//! Math utilities and number formatting helpers.
+//! Math utilities, number formatting helpers and raw I/O wrappers.
 
-use crate::{get_errno, translate_ret_isize};
-use core::arch::asm;
+use crate::libc_compat::iovec;
+use crate::{get_errno, readv_impl, translate_ret_isize, writev_impl};
+use core::{arch::asm, ffi::c_void};
 
-use super::constants::{INT_BUFFER_SIZE, SYS_READ, SYS_WRITE};
+use super::constants::{SYS_READ, SYS_WRITE};
 
 /// Calculate 10^n for precision scaling
 pub(crate) fn pow10(n: usize) -> u128 {
@@ -85,57 +86,6 @@ pub(crate) fn format_isize(val: isize, buf: &mut [u8]) -> &str {
     unsafe { core::str::from_utf8_unchecked(&buf[idx..]) }
 }
 
-/// Format unsigned integer with specified base and minimum digits
-pub(crate) fn format_unsigned(
-    mut value: u128,
-    base: u32,
-    min_digits: usize,
-) -> ([u8; INT_BUFFER_SIZE], usize) {
-    let mut buf = [0u8; INT_BUFFER_SIZE];
-    let mut index = INT_BUFFER_SIZE;
-    if value == 0 {
-        index -= 1;
-        buf[index] = b'0';
-    } else {
-        while value > 0 {
-            let digit = (value % base as u128) as u8;
-            let ch = if digit < 10 {
-                b'0' + digit
-            } else {
-                b'a' + (digit - 10)
-            };
-            index -= 1;
-            buf[index] = ch;
-            value /= base as u128;
-        }
-    }
-    let digits = INT_BUFFER_SIZE - index;
-    if min_digits > digits {
-        let zeros = min_digits - digits;
-        for _ in 0..zeros {
-            index -= 1;
-            buf[index] = b'0';
-        }
-    }
-    (buf, index)
-}
-
-/// Format signed integer with specified base and minimum digits
-pub(crate) fn format_signed(
-    value: i128,
-    base: u32,
-    min_digits: usize,
-) -> (bool, [u8; INT_BUFFER_SIZE], usize) {
-    if value < 0 {
-        let unsigned = value.wrapping_neg() as u128;
-        let (buf, index) = format_unsigned(unsigned, base, min_digits);
-        (true, buf, index)
-    } else {
-        let (buf, index) = format_unsigned(value as u128, base, min_digits);
-        (false, buf, index)
-    }
-}
-
 // ============================================================================
 // Low-level syscall wrappers
 // ============================================================================
@@ -183,6 +133,55 @@ pub(crate) fn write_all_fd(fd: i32, mut buf: &[u8]) -> Result<(), i32> {
     Ok(())
 }
 
+/// Write `head` then `tail`, both in one writev while `head` is pending
+pub(crate) fn writev_all_fd(fd: i32, mut head: &[u8], mut tail: &[u8]) -> Result<(), i32> {
+    while !head.is_empty() {
+        let iov = [
+            iovec {
+                iov_base: head.as_ptr() as *mut c_void,
+                iov_len: head.len(),
+            },
+            iovec {
+                iov_base: tail.as_ptr() as *mut c_void,
+                iov_len: tail.len(),
+            },
+        ];
+        let written = writev_impl(fd, iov.as_ptr() as *const c_void, 2);
+        if written <= 0 {
+            return Err(get_errno());
+        }
+        let written = written as usize;
+        if written < head.len() {
+            head = &head[written..];
+        } else {
+            tail = &tail[written - head.len()..];
+            head = &[];
+        }
+    }
+    write_all_fd(fd, tail)
+}
+
+/// Read into `first`, then `second`, with one readv
+pub(crate) fn readv_fd(
+    fd: i32,
+    first: *mut u8,
+    first_len: usize,
+    second: *mut u8,
+    second_len: usize,
+) -> isize {
+    let iov = [
+        iovec {
+            iov_base: first as *mut c_void,
+            iov_len: first_len,
+        },
+        iovec {
+            iov_base: second as *mut c_void,
+            iov_len: second_len,
+        },
+    ];
+    readv_impl(fd, iov.as_ptr() as *const c_void, 2)
+}
+
 /// Debug logging using direct syscall (bypasses stdio locking)
 pub(crate) fn debug_log(msg: &[u8]) {
     let _ = syscall3(SYS_WRITE, 2, msg.as_ptr() as u64, msg.len() as u64);
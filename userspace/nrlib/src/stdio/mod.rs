@@ -27,6 +27,13 @@ mod format;
 mod helpers;
 mod stream;
 
+/// Flush stdout and stderr; called by exit() so fully buffered output
+/// reaches pipes and files
+pub(crate) fn flush_all() {
+    let _ = stream::flush_stream(unsafe { stdout });
+    let _ = stream::flush_stream(unsafe { stderr });
+}
+
 // Re-export FILE type for external use
 pub use file::FILE;
 
@@ -39,6 +39,20 @@ fn announce_runtime_start() {
 const SYS_FORK: u64 = 57;
 const SYS_EXECVE: u64 = 59;
 const SYS_WAIT4: u64 = 61;
+const SYS_CGROUP_CTL: u64 = 282;
+
+// SYS_CGROUP_CTL commands
+const CGROUP_CREATE: u64 = 0;
+const CGROUP_LOOKUP: u64 = 1;
+const CGROUP_ATTACH: u64 = 3;
+const CGROUP_SET_CPU_WEIGHT: u64 = 4;
+const CGROUP_SET_CPU_QUOTA: u64 = 5;
+const CGROUP_SET_MEMORY_MAX: u64 = 7;
+const CGROUP_SET_MEMORY_HIGH: u64 = 8;
+const CGROUP_SET_IO_WEIGHT: u64 = 9;
+const CGROUP_UNLIMITED: u64 = u64::MAX;
+/// Parent group of every service
+const CGROUP_SYSTEM_SLICE: &[u8] = b"system\0";
 
 // Service management constants
 const MAX_RESPAWN_COUNT: u32 = 5; // Max respawns within window
@@ -276,6 +290,30 @@ struct ServiceConfig {
     group: &'static str,
     working_dir: &'static str,
     standard_output: &'static str,
+    resources: ResourceControl,
+}
+
+/// Cgroup limits from the unit's CPUWeight=, CPUQuota=, MemoryMax=,
+/// MemoryHigh= and IOWeight= keys (0 / CGROUP_UNLIMITED = not set)
+#[derive(Clone, Copy)]
+struct ResourceControl {
+    cpu_weight: u64,
+    cpu_quota_us: u64,
+    memory_max: u64,
+    memory_high: u64,
+    io_weight: u64,
+}
+
+impl ResourceControl {
+    const fn new() -> Self {
+        Self {
+            cpu_weight: 0,
+            cpu_quota_us: CGROUP_UNLIMITED,
+            memory_max: CGROUP_UNLIMITED,
+            memory_high: CGROUP_UNLIMITED,
+            io_weight: 0,
+        }
+    }
 }
 
 impl ServiceConfig {
@@ -299,6 +337,7 @@ impl ServiceConfig {
             group: EMPTY_STR,
             working_dir: EMPTY_STR,
             standard_output: "journal",
+            resources: ResourceControl::new(),
         }
     }
 
@@ -565,6 +604,16 @@ fn handle_service_key_value(line: &[u8], current: &mut ServiceConfig) {
             current.working_dir = value_trimmed;
         } else if eq_ignore_ascii_case(key_str, "StandardOutput") {
             current.standard_output = value_trimmed;
+        } else if eq_ignore_ascii_case(key_str, "CPUWeight") {
+            current.resources.cpu_weight = parse_u64(value_trimmed, 0);
+        } else if eq_ignore_ascii_case(key_str, "CPUQuota") {
+            current.resources.cpu_quota_us = parse_cpu_quota(value_trimmed);
+        } else if eq_ignore_ascii_case(key_str, "MemoryMax") {
+            current.resources.memory_max = parse_size(value_trimmed);
+        } else if eq_ignore_ascii_case(key_str, "MemoryHigh") {
+            current.resources.memory_high = parse_size(value_trimmed);
+        } else if eq_ignore_ascii_case(key_str, "IOWeight") {
+            current.resources.io_weight = parse_u64(value_trimmed, 0);
         } else if eq_ignore_ascii_case(key_str, "Unit") && current.name.is_empty() {
             current.name = value_trimmed;
         }
@@ -826,6 +875,31 @@ fn parse_u64(value: &'static str, default: u64) -> u64 {
     result
 }
 
+/// Parse a byte size with an optional K/M/G/T (1024-based) suffix;
+/// "infinity" or anything unparsable means no limit
+fn parse_size(value: &'static str) -> u64 {
+    let (digits, shift) = match value.as_bytes().last() {
+        Some(b'K') | Some(b'k') => (&value[..value.len() - 1], 10),
+        Some(b'M') | Some(b'm') => (&value[..value.len() - 1], 20),
+        Some(b'G') | Some(b'g') => (&value[..value.len() - 1], 30),
+        Some(b'T') | Some(b't') => (&value[..value.len() - 1], 40),
+        _ => (value, 0),
+    };
+    match parse_u64(digits, CGROUP_UNLIMITED) {
+        CGROUP_UNLIMITED => CGROUP_UNLIMITED,
+        n => n.checked_mul(1u64 << shift).unwrap_or(CGROUP_UNLIMITED),
+    }
+}
+
+/// Parse CPUQuota=N% into microseconds per the default 100ms period
+fn parse_cpu_quota(value: &'static str) -> u64 {
+    let percent = value.strip_suffix('%').unwrap_or(value);
+    match parse_u64(percent, 0) {
+        0 => CGROUP_UNLIMITED,
+        n => n.saturating_mul(1000),
+    }
+}
+
 fn to_ascii_lower(value: &'static str) -> &'static str {
     // Values are stored in CONFIG_BUFFER, mutate in place for lowercase
     let bytes = value.as_bytes();
@@ -888,6 +962,7 @@ const FALLBACK_SERVICE: ServiceConfig = ServiceConfig {
     group: EMPTY_STR,
     working_dir: EMPTY_STR,
     standard_output: "journal",
+    resources: ResourceControl::new(),
 };
 
 /// Service state tracking with lifecycle management
@@ -1331,6 +1406,62 @@ fn parallel_service_supervisor(
     }
 }
 
+/// Put the service in its own group under system/, creating it on first
+/// start, and apply the unit's resource limits. Returns the group id.
+fn service_cgroup(service: &ServiceConfig) -> Option<u64> {
+    if service.name.is_empty() {
+        return None;
+    }
+
+    // "system/<name>\0", with anything but [A-Za-z0-9._-] mapped to '_'
+    let mut path = [0u8; 64];
+    let prefix = &CGROUP_SYSTEM_SLICE[..CGROUP_SYSTEM_SLICE.len() - 1];
+    path[..prefix.len()].copy_from_slice(prefix);
+    path[prefix.len()] = b'/';
+    let mut len = prefix.len() + 1;
+    for &b in service.name.as_bytes().iter().take(path.len() - len - 1) {
+        path[len] = match b {
+            b'a'..=b'z' | b'A'..=b'Z' | b'0'..=b'9' | b'.' | b'_' | b'-' => b,
+            _ => b'_',
+        };
+        len += 1;
+    }
+    path[len] = 0;
+
+    // The parent may already exist; only the leaf matters
+    syscall3(
+        SYS_CGROUP_CTL,
+        CGROUP_CREATE,
+        CGROUP_SYSTEM_SLICE.as_ptr() as u64,
+        0,
+    );
+    let mut id = syscall3(SYS_CGROUP_CTL, CGROUP_CREATE, path.as_ptr() as u64, 0);
+    if id == u64::MAX {
+        // Restarts reuse the group from the previous run
+        id = syscall3(SYS_CGROUP_CTL, CGROUP_LOOKUP, path.as_ptr() as u64, 0);
+    }
+    if id == u64::MAX {
+        log_warn("Failed to create service cgroup");
+        return None;
+    }
+
+    let res = &service.resources;
+    let settings = [
+        (CGROUP_SET_CPU_WEIGHT, res.cpu_weight, 0),
+        (CGROUP_SET_CPU_QUOTA, res.cpu_quota_us, CGROUP_UNLIMITED),
+        (CGROUP_SET_MEMORY_MAX, res.memory_max, CGROUP_UNLIMITED),
+        (CGROUP_SET_MEMORY_HIGH, res.memory_high, CGROUP_UNLIMITED),
+        (CGROUP_SET_IO_WEIGHT, res.io_weight, 0),
+    ];
+    for (cmd, value, unset) in settings {
+        if value != unset && syscall3(SYS_CGROUP_CTL, cmd, id, value) == u64::MAX {
+            log_warn("Invalid cgroup limit in unit");
+            println!("         Unit: {}", service.name);
+        }
+    }
+    Some(id)
+}
+
 /// Start a single service (fork and exec)
 fn start_service(service: &ServiceConfig, _buf: &mut [u8]) -> i64 {
     // 拷贝 service.exec_start 到一个本地 buffer，避免子进程访问父进程的只读数据
@@ -1386,6 +1517,8 @@ fn start_service(service: &ServiceConfig, _buf: &mut [u8]) -> i64 {
     let program_path = std::str::from_utf8(&argv_bufs[0][..]).unwrap_or("/bin/sh");
     let program_path = program_path.trim_end_matches('\0');
 
+    let cgroup = service_cgroup(service);
+
     let pid = fork();
 
     if pid < 0 {
@@ -1398,6 +1531,11 @@ fn start_service(service: &ServiceConfig, _buf: &mut [u8]) -> i64 {
         // Child process - exec the service
         let envp: [*const u8; 1] = [core::ptr::null()];
 
+        // Join the service group before exec so everything it runs is charged there
+        if let Some(id) = cgroup {
+            syscall3(SYS_CGROUP_CTL, CGROUP_ATTACH, id, 0);
+        }
+
         let result = execve(program_path, &argv_ptrs, &envp);
 
         // If execve returns, it failed
@@ -14,10 +14,17 @@
 
 use std::env;
 use std::fs::{self, Metadata};
+use std::io::{self, BufWriter, Write};
+use std::os::unix::ffi::OsStrExt;
 use std::os::unix::fs::MetadataExt;
 use std::path::{Path, PathBuf};
 use std::process;
 
+use nscan::EntryType;
+
+/// Output buffer in front of stdout
+const OUTPUT_BUFFER_SIZE: usize = 64 * 1024;
+
 #[derive(Clone)]
 enum FileType {
     File,
@@ -238,12 +245,12 @@ fn parse_args() -> Result<FindOptions, String> {
     Ok(opts)
 }
 
-fn check_type(metadata: &Metadata, file_type: &FileType) -> bool {
+fn check_type(entry_type: EntryType, file_type: &FileType) -> bool {
     match file_type {
         FileType::Any => true,
-        FileType::File => metadata.is_file(),
-        FileType::Directory => metadata.is_dir(),
-        FileType::Symlink => metadata.file_type().is_symlink(),
+        FileType::File => entry_type == EntryType::File,
+        FileType::Directory => entry_type == EntryType::Dir,
+        FileType::Symlink => entry_type == EntryType::Symlink,
     }
 }
 
@@ -256,20 +263,23 @@ fn check_size(metadata: &Metadata, size: &SizeComparison) -> bool {
     }
 }
 
-fn check_empty(path: &Path, metadata: &Metadata) -> bool {
-    if metadata.is_file() {
-        metadata.size() == 0
-    } else if metadata.is_dir() {
-        match fs::read_dir(path) {
-            Ok(mut entries) => entries.next().is_none(),
+fn check_empty(path: &Path, entry_type: EntryType, metadata: &Metadata) -> bool {
+    match entry_type {
+        EntryType::File => metadata.size() == 0,
+        EntryType::Dir => match nscan::read_dir(path) {
+            Ok(entries) => entries.is_empty(),
             Err(_) => false,
-        }
-    } else {
-        false
+        },
+        _ => false,
     }
 }
 
-fn matches_criteria(path: &Path, metadata: &Metadata, opts: &FindOptions) -> bool {
+fn matches_criteria(
+    path: &Path,
+    entry_type: EntryType,
+    metadata: Option<&Metadata>,
+    opts: &FindOptions,
+) -> bool {
     // Check name pattern
     if let Some(ref pattern) = opts.name_pattern {
         if let Some(name) = path.file_name() {
@@ -282,38 +292,69 @@ fn matches_criteria(path: &Path, metadata: &Metadata, opts: &FindOptions) -> boo
     }
 
     // Check file type
-    if !check_type(metadata, &opts.file_type) {
+    if !check_type(entry_type, &opts.file_type) {
         return false;
     }
 
     // Check size
-    if let Some(ref size) = opts.size {
+    if let (Some(size), Some(metadata)) = (&opts.size, metadata) {
         if !check_size(metadata, size) {
             return false;
         }
     }
 
     // Check empty
-    if opts.empty && !check_empty(path, metadata) {
-        return false;
+    if let (true, Some(metadata)) = (opts.empty, metadata) {
+        if !check_empty(path, entry_type, metadata) {
+            return false;
+        }
     }
 
     true
 }
 
-fn find_recursive(path: &Path, depth: usize, opts: &FindOptions) {
+fn entry_type_of(metadata: &Metadata) -> EntryType {
+    let file_type = metadata.file_type();
+    if file_type.is_symlink() {
+        EntryType::Symlink
+    } else if file_type.is_dir() {
+        EntryType::Dir
+    } else if file_type.is_file() {
+        EntryType::File
+    } else {
+        EntryType::Other
+    }
+}
+
+/// Visit `path`, whose type the directory listing may already have told
+/// us. Subtrees of the starting point are walked on `threads` threads.
+fn find_recursive(
+    path: &Path,
+    entry_type: EntryType,
+    depth: usize,
+    opts: &FindOptions,
+    threads: usize,
+    out: &mut dyn Write,
+) -> io::Result<()> {
     // Check max depth
     if let Some(max) = opts.max_depth {
         if depth > max {
-            return;
+            return Ok(());
         }
     }
 
-    // Get metadata
-    let metadata = match fs::symlink_metadata(path) {
-        Ok(m) => m,
-        Err(_) => return,
-    };
+    // Only stat when the listing left the type open or a test needs it
+    let mut entry_type = entry_type;
+    let mut metadata = None;
+    if entry_type == EntryType::Unknown || opts.size.is_some() || opts.empty {
+        match fs::symlink_metadata(path) {
+            Ok(m) => {
+                entry_type = entry_type_of(&m);
+                metadata = Some(m);
+            }
+            Err(_) => return Ok(()),
+        }
+    }
 
     // Check if we should print this entry
     let should_print = match opts.min_depth {
@@ -321,27 +362,52 @@ fn find_recursive(path: &Path, depth: usize, opts: &FindOptions) {
         None => true,
     };
 
-    if should_print && matches_criteria(path, &metadata, opts) {
-        println!("{}", path.display());
+    if should_print && matches_criteria(path, entry_type, metadata.as_ref(), opts) {
+        out.write_all(path.as_os_str().as_bytes())?;
+        out.write_all(b"\n")?;
     }
 
     // Recurse into directories
-    if metadata.is_dir() {
+    if entry_type == EntryType::Dir {
         if let Some(max) = opts.max_depth {
             if depth >= max {
-                return;
+                return Ok(());
             }
         }
 
-        let entries = match fs::read_dir(path) {
+        let entries = match nscan::read_dir(path) {
             Ok(e) => e,
-            Err(_) => return,
+            Err(_) => return Ok(()),
         };
 
-        for entry in entries.flatten() {
-            find_recursive(&entry.path(), depth + 1, opts);
+        if threads > 1 {
+            let mut result = Ok(());
+            nscan::map_ordered(
+                entries,
+                threads,
+                |entry| {
+                    let mut buf = Vec::new();
+                    let child = path.join(&entry.name);
+                    // Writing to a Vec cannot fail
+                    let _ = find_recursive(&child, entry.entry_type, depth + 1, opts, 1, &mut buf);
+                    buf
+                },
+                |buf| {
+                    if result.is_ok() {
+                        result = out.write_all(&buf);
+                    }
+                },
+            );
+            return result;
+        }
+
+        for entry in entries {
+            let child = path.join(&entry.name);
+            find_recursive(&child, entry.entry_type, depth + 1, opts, 1, out)?;
         }
     }
+
+    Ok(())
 }
 
 fn main() {
@@ -354,12 +420,22 @@ fn main() {
         }
     };
 
+    let stdout = io::stdout();
+    let mut out = BufWriter::with_capacity(OUTPUT_BUFFER_SIZE, stdout.lock());
+    let threads = nscan::default_threads();
+
     for path in &opts.paths {
         if !path.exists() {
+            let _ = out.flush();
             eprintln!("find: '{}': No such file or directory", path.display());
             continue;
         }
 
-        find_recursive(path, 0, &opts);
+        if find_recursive(path, EntryType::Unknown, 0, &opts, threads, &mut out).is_err() {
+            // stdout is gone (e.g. closed pipe); nothing more to do
+            process::exit(1);
+        }
     }
+
+    let _ = out.flush();
 }
@@ -14,10 +14,14 @@
 
 use std::env;
 use std::fs::{self, File};
-use std::io::{self, BufRead, BufReader, Read, Write};
-use std::path::Path;
+use std::io::{self, BufWriter, Read, Write};
+use std::os::unix::ffi::OsStrExt;
+use std::path::{Path, PathBuf};
 use std::process;
 
+use nscan::memchr::{count, memchr, memrchr};
+use nscan::{EntryType, Finder, LineReader};
+
 struct GrepOptions {
     ignore_case: bool,
     invert_match: bool,
@@ -64,127 +68,249 @@ fn print_usage() {
     println!("If no FILE is given, read from standard input.");
 }
 
-fn line_matches(line: &str, pattern: &str, ignore_case: bool) -> bool {
-    if ignore_case {
-        line.to_lowercase().contains(&pattern.to_lowercase())
-    } else {
-        line.contains(pattern)
-    }
-}
-
-fn grep_file(path: &Path, opts: &GrepOptions, show_filename: bool) -> io::Result<(u64, bool)> {
-    let file = File::open(path)?;
-    let reader = BufReader::new(file);
-    let mut match_count: u64 = 0;
-    let mut found_match = false;
-    let mut stdout = io::stdout();
-
-    for (line_num, line_result) in reader.lines().enumerate() {
-        let line = match line_result {
-            Ok(l) => l,
-            Err(_) => continue, // Skip lines that can't be read as UTF-8
-        };
+/// Output buffer in front of stdout
+const OUTPUT_BUFFER_SIZE: usize = 64 * 1024;
 
-        let matches = line_matches(&line, &opts.pattern, opts.ignore_case);
-        let should_print = if opts.invert_match { !matches } else { matches };
+/// How lines are tested against the pattern
+enum Matcher {
+    /// Byte search over whole blocks, exact or ASCII case-insensitive
+    Literal(Finder),
+    /// Line by line: `-i` with a non-ASCII pattern (Unicode lowercasing),
+    /// or a pattern containing a newline, which no line can contain
+    PerLine { pattern: String, ignore_case: bool },
+}
 
-        if should_print {
-            match_count += 1;
-            found_match = true;
+impl Matcher {
+    fn new(pattern: &str, ignore_case: bool) -> Self {
+        if pattern.contains('\n') || (ignore_case && !pattern.is_ascii()) {
+            Matcher::PerLine {
+                pattern: if ignore_case {
+                    pattern.to_lowercase()
+                } else {
+                    pattern.to_string()
+                },
+                ignore_case,
+            }
+        } else if ignore_case {
+            Matcher::Literal(Finder::new_ignore_ascii_case(pattern.as_bytes()))
+        } else {
+            Matcher::Literal(Finder::new(pattern.as_bytes()))
+        }
+    }
 
-            if opts.files_only {
-                // Just return true, we'll print the filename once
-                return Ok((match_count, true));
+    /// Bounds (without the newline) of the first matching line in
+    /// `block[from..]`; `from` is the start of a line
+    fn next_match(&self, block: &[u8], from: usize) -> Option<(usize, usize)> {
+        match self {
+            Matcher::Literal(finder) => {
+                let at = from + finder.find(&block[from..])?;
+                let start = memrchr(b'\n', &block[from..at]).map_or(from, |p| from + p + 1);
+                let end = memchr(b'\n', &block[at..]).map_or(block.len(), |p| at + p);
+                Some((start, end))
+            }
+            Matcher::PerLine {
+                pattern,
+                ignore_case,
+            } => {
+                let mut start = from;
+                while start < block.len() {
+                    let end = memchr(b'\n', &block[start..]).map_or(block.len(), |p| start + p);
+                    let line = String::from_utf8_lossy(&block[start..end]);
+                    let found = if *ignore_case {
+                        line.to_lowercase().contains(pattern.as_str())
+                    } else {
+                        line.contains(pattern.as_str())
+                    };
+                    if found {
+                        return Some((start, end));
+                    }
+                    start = end + 1;
+                }
+                None
             }
+        }
+    }
+}
 
-            if !opts.count_only {
-                let mut output = String::new();
+fn write_line(
+    out: &mut dyn Write,
+    name: Option<&Path>,
+    line_num: Option<u64>,
+    line: &[u8],
+) -> io::Result<()> {
+    if let Some(name) = name {
+        out.write_all(name.as_os_str().as_bytes())?;
+        out.write_all(b":")?;
+    }
+    if let Some(n) = line_num {
+        write!(out, "{}:", n)?;
+    }
+    out.write_all(line)?;
+    out.write_all(b"\n")
+}
 
-                if show_filename && !opts.suppress_filename {
-                    output.push_str(&format!("{}:", path.display()));
+/// Search `input` block by block, writing selected lines to `out`.
+/// Returns the number of selected lines (stopping at the first with -l).
+fn grep_reader<R: Read>(
+    input: R,
+    name: Option<&Path>,
+    opts: &GrepOptions,
+    matcher: &Matcher,
+    out: &mut dyn Write,
+) -> io::Result<u64> {
+    let mut reader = LineReader::new(input);
+    let mut match_count: u64 = 0;
+    // Lines before the current position (kept only with -n or -v)
+    let mut line_num: u64 = 0;
+    let numbered = opts.show_line_numbers;
+    let print = !opts.count_only && !opts.files_only;
+
+    while let Some(block) = reader.next_block()? {
+        let mut pos = 0;
+        while pos < block.len() {
+            let found = matcher.next_match(block, pos);
+            let (start, end) = found.unwrap_or((block.len(), block.len()));
+
+            if opts.invert_match {
+                // Every line before the match is selected
+                let mut line_start = pos;
+                while line_start < start {
+                    let line_end =
+                        memchr(b'\n', &block[line_start..start]).map_or(start, |p| line_start + p);
+                    line_num += 1;
+                    match_count += 1;
+                    if opts.files_only {
+                        return Ok(match_count);
+                    }
+                    if print {
+                        write_line(
+                            out,
+                            name,
+                            numbered.then_some(line_num),
+                            &block[line_start..line_end],
+                        )?;
+                    }
+                    line_start = line_end + 1;
                 }
-
-                if opts.show_line_numbers {
-                    output.push_str(&format!("{}:", line_num + 1));
+                if found.is_some() {
+                    line_num += 1;
+                }
+            } else if found.is_some() {
+                if numbered {
+                    line_num += count(b'\n', &block[pos..start]) as u64 + 1;
+                }
+                match_count += 1;
+                if opts.files_only {
+                    return Ok(match_count);
+                }
+                if print {
+                    write_line(out, name, numbered.then_some(line_num), &block[start..end])?;
                 }
+            } else if numbered {
+                line_num += count(b'\n', &block[pos..]) as u64;
+            }
 
-                output.push_str(&line);
-                writeln!(stdout, "{}", output)?;
+            if found.is_none() {
+                break;
             }
+            pos = end + 1;
         }
+        // Hand complete blocks of output on (matters for pipelines)
+        out.flush()?;
     }
 
-    Ok((match_count, found_match))
+    Ok(match_count)
 }
 
-fn grep_stdin(opts: &GrepOptions) -> io::Result<u64> {
-    let stdin = io::stdin();
-    let reader = stdin.lock();
-    let mut match_count: u64 = 0;
-    let mut stdout = io::stdout();
+fn grep_file(
+    path: &Path,
+    opts: &GrepOptions,
+    matcher: &Matcher,
+    show_filename: bool,
+    out: &mut dyn Write,
+) -> io::Result<u64> {
+    let file = File::open(path)?;
+    let name = (show_filename && !opts.suppress_filename).then_some(path);
+    grep_reader(file, name, opts, matcher, out)
+}
 
-    for (line_num, line_result) in reader.lines().enumerate() {
-        let line = match line_result {
-            Ok(l) => l,
-            Err(_) => continue,
+/// Regular files under `dir`, depth first in directory order
+fn collect_files(dir: &Path, files: &mut Vec<PathBuf>) -> io::Result<()> {
+    for entry in nscan::read_dir(dir)? {
+        let path = dir.join(&entry.name);
+        // Like Path::is_dir/is_file, symlinks count as what they point to
+        let entry_type = match entry.entry_type {
+            EntryType::Symlink | EntryType::Unknown => match fs::metadata(&path) {
+                Ok(m) if m.is_dir() => EntryType::Dir,
+                Ok(m) if m.is_file() => EntryType::File,
+                _ => continue,
+            },
+            t => t,
         };
 
-        let matches = line_matches(&line, &opts.pattern, opts.ignore_case);
-        let should_print = if opts.invert_match { !matches } else { matches };
-
-        if should_print {
-            match_count += 1;
-
-            if !opts.count_only {
-                if opts.show_line_numbers {
-                    write!(stdout, "{}:", line_num + 1)?;
+        match entry_type {
+            EntryType::Dir => {
+                if let Err(e) = collect_files(&path, files) {
+                    eprintln!("grep: {}: {}", path.display(), e);
                 }
-                writeln!(stdout, "{}", line)?;
             }
+            EntryType::File => files.push(path),
+            _ => {}
         }
     }
-
-    Ok(match_count)
+    Ok(())
 }
 
-fn grep_directory(path: &Path, opts: &GrepOptions, show_filename: bool) -> io::Result<(u64, bool)> {
-    let mut total_count: u64 = 0;
-    let mut any_match = false;
+/// Search every file below `path`, several files at a time; output comes
+/// out in the same order as a sequential search
+fn grep_directory(
+    path: &Path,
+    opts: &GrepOptions,
+    matcher: &Matcher,
+    show_filename: bool,
+    out: &mut dyn Write,
+) -> io::Result<u64> {
+    let mut files = Vec::new();
+    collect_files(path, &mut files)?;
 
-    let entries = fs::read_dir(path)?;
-
-    for entry in entries {
-        let entry = entry?;
-        let entry_path = entry.path();
-
-        if entry_path.is_dir() {
-            if opts.recursive {
-                let (count, found) = grep_directory(&entry_path, opts, show_filename)?;
-                total_count += count;
-                any_match |= found;
+    let mut total_count: u64 = 0;
+    let mut write_error = None;
+    nscan::map_ordered(
+        files,
+        nscan::default_threads(),
+        |file| {
+            let mut buf = Vec::new();
+            let result = grep_file(&file, opts, matcher, show_filename, &mut buf);
+            (file, result, buf)
+        },
+        |(file, result, buf)| {
+            if write_error.is_some() {
+                return;
             }
-        } else if entry_path.is_file() {
-            match grep_file(&entry_path, opts, show_filename) {
-                Ok((count, found)) => {
-                    if opts.files_only && found {
-                        println!("{}", entry_path.display());
-                    } else if opts.count_only && count > 0 {
-                        if show_filename && !opts.suppress_filename {
-                            println!("{}:{}", entry_path.display(), count);
-                        }
-                    }
-                    total_count += count;
-                    any_match |= found;
-                }
-                Err(_) => {
-                    // Skip files we can't read
-                    continue;
+            // Files that can't be read are skipped
+            let Ok(count) = result else {
+                return;
+            };
+            let written = out.write_all(&buf).and_then(|_| {
+                if opts.files_only && count > 0 {
+                    out.write_all(file.as_os_str().as_bytes())?;
+                    out.write_all(b"\n")?;
+                } else if opts.count_only && count > 0 && show_filename && !opts.suppress_filename {
+                    writeln!(out, "{}:{}", file.display(), count)?;
                 }
+                Ok(())
+            });
+            match written {
+                Ok(()) => total_count += count,
+                Err(e) => write_error = Some(e),
             }
-        }
-    }
+        },
+    );
 
-    Ok((total_count, any_match))
+    match write_error {
+        Some(e) => Err(e),
+        None => Ok(total_count),
+    }
 }
 
 fn parse_args() -> Result<GrepOptions, String> {
@@ -238,21 +364,30 @@ fn main() {
         }
     };
 
+    let matcher = Matcher::new(&opts.pattern, opts.ignore_case);
+    let stdout = io::stdout();
+    let mut out = BufWriter::with_capacity(OUTPUT_BUFFER_SIZE, stdout.lock());
+
     let mut exit_code = 1; // No matches found
     let show_filename = opts.files.len() > 1 || opts.recursive;
 
     if opts.files.is_empty() {
         // Read from stdin
-        match grep_stdin(&opts) {
-            Ok(count) => {
+        let result =
+            grep_reader(io::stdin().lock(), None, &opts, &matcher, &mut out).and_then(|count| {
                 if opts.count_only {
-                    println!("{}", count);
+                    writeln!(out, "{}", count)?;
                 }
+                Ok(count)
+            });
+        match result {
+            Ok(count) => {
                 if count > 0 {
                     exit_code = 0;
                 }
             }
             Err(e) => {
+                let _ = out.flush();
                 eprintln!("grep: stdin: {}", e);
                 process::exit(2);
             }
@@ -265,32 +400,39 @@ fn main() {
 
             if path.is_dir() {
                 if opts.recursive {
-                    match grep_directory(path, &opts, show_filename) {
-                        Ok((count, _)) => {
+                    match grep_directory(path, &opts, &matcher, show_filename, &mut out) {
+                        Ok(count) => {
                             total_matches += count;
                         }
                         Err(e) => {
+                            let _ = out.flush();
                             eprintln!("grep: {}: {}", file_path, e);
                         }
                     }
                 } else {
+                    let _ = out.flush();
                     eprintln!("grep: {}: Is a directory", file_path);
                 }
             } else {
-                match grep_file(path, &opts, show_filename) {
-                    Ok((count, found)) => {
-                        if opts.files_only && found {
-                            println!("{}", path.display());
+                let result =
+                    grep_file(path, &opts, &matcher, show_filename, &mut out).and_then(|count| {
+                        if opts.files_only && count > 0 {
+                            writeln!(out, "{}", path.display())?;
                         } else if opts.count_only {
                             if show_filename && !opts.suppress_filename {
-                                println!("{}:{}", path.display(), count);
+                                writeln!(out, "{}:{}", path.display(), count)?;
                             } else {
-                                println!("{}", count);
+                                writeln!(out, "{}", count)?;
                             }
                         }
+                        Ok(count)
+                    });
+                match result {
+                    Ok(count) => {
                         total_matches += count;
                     }
                     Err(e) => {
+                        let _ = out.flush();
                         eprintln!("grep: {}: {}", file_path, e);
                     }
                 }
@@ -302,5 +444,8 @@ fn main() {
         }
     }
 
+    if out.flush().is_err() {
+        exit_code = 2;
+    }
     process::exit(exit_code);
 }
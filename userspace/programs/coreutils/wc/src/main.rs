@@ -5,9 +5,11 @@
 
 use std::env;
 use std::fs::File;
-use std::io::{self, BufRead, BufReader, Read};
+use std::io::{self, Read};
 use std::process;
 
+use nscan::memchr;
+
 fn print_usage() {
     println!("wc - Word, line, character, and byte count");
     println!();
@@ -45,47 +47,119 @@ impl Counts {
     }
 }
 
-fn count_file(path: &str) -> io::Result<Counts> {
-    let file = File::open(path)?;
-    let mut reader = BufReader::new(file);
-    let mut counts = Counts::default();
-    let mut line = String::new();
+/// Which counts a file has to be read for
+#[derive(Clone, Copy)]
+struct Wanted {
+    lines: bool,
+    words: bool,
+    chars: bool,
+    max_line_length: bool,
+}
 
-    loop {
-        line.clear();
-        match reader.read_line(&mut line) {
-            Ok(0) => break, // EOF
-            Ok(bytes_read) => {
-                counts.bytes += bytes_read;
-                counts.chars += line.chars().count();
-
-                // Count line (if ends with newline or is the last line)
-                if line.ends_with('\n') {
-                    counts.lines += 1;
-                    // Calculate line length without newline
-                    let line_len = line.trim_end_matches('\n').len();
-                    if line_len > counts.max_line_length {
-                        counts.max_line_length = line_len;
-                    }
-                } else {
-                    // Last line without newline
-                    if !line.is_empty() {
-                        counts.lines += 1;
-                        if line.len() > counts.max_line_length {
-                            counts.max_line_length = line.len();
-                        }
-                    }
+impl Wanted {
+    fn needs_read(&self) -> bool {
+        self.lines || self.words || self.chars || self.max_line_length
+    }
+}
+
+/// Bytes that separate words (ASCII whitespace, as `isspace` in the C locale)
+fn is_space(b: u8) -> bool {
+    matches!(b, b' ' | b'\t' | b'\n' | b'\r' | 0x0b | 0x0c)
+}
+
+/// Running state for counts that span read boundaries
+#[derive(Default)]
+struct Scanner {
+    counts: Counts,
+    in_word: bool,
+    line_length: usize,
+    last_byte: Option<u8>,
+}
+
+impl Scanner {
+    fn feed(&mut self, data: &[u8], wanted: Wanted) {
+        self.counts.bytes += data.len();
+        if data.is_empty() {
+            return;
+        }
+        self.last_byte = data.last().copied();
+
+        if wanted.lines {
+            self.counts.lines += memchr::count(b'\n', data);
+        }
+
+        if wanted.max_line_length {
+            let mut rest = data;
+            while let Some(at) = memchr::memchr(b'\n', rest) {
+                let length = self.line_length + at;
+                if length > self.counts.max_line_length {
+                    self.counts.max_line_length = length;
+                }
+                self.line_length = 0;
+                rest = &rest[at + 1..];
+            }
+            self.line_length += rest.len();
+        }
+
+        if wanted.chars {
+            // Every UTF-8 sequence has exactly one non-continuation byte
+            self.counts.chars += data.iter().filter(|&&b| b & 0xc0 != 0x80).count();
+        }
+
+        if wanted.words {
+            let mut in_word = self.in_word;
+            let mut words = 0;
+            for &b in data {
+                let space = is_space(b);
+                if !space && !in_word {
+                    words += 1;
                 }
+                in_word = !space;
+            }
+            self.counts.words += words;
+            self.in_word = in_word;
+        }
+    }
 
-                // Count words (sequences of non-whitespace)
-                counts.words += line.split_whitespace().count();
+    fn finish(mut self) -> Counts {
+        // A last line without a newline still counts as a line
+        if self.last_byte.is_some_and(|b| b != b'\n') {
+            self.counts.lines += 1;
+            if self.line_length > self.counts.max_line_length {
+                self.counts.max_line_length = self.line_length;
             }
+        }
+        self.counts
+    }
+}
+
+fn count_file(path: &str, wanted: Wanted) -> io::Result<Counts> {
+    let mut file = File::open(path)?;
+
+    if !wanted.needs_read() {
+        // Byte count alone: the size of a regular file is enough
+        let metadata = file.metadata()?;
+        if metadata.is_file() {
+            return Ok(Counts {
+                bytes: metadata.len() as usize,
+                ..Counts::default()
+            });
+        }
+    }
+
+    let mut buf = vec![0u8; nscan::BLOCK_SIZE];
+    let mut scanner = Scanner::default();
+
+    loop {
+        match file.read(&mut buf) {
+            Ok(0) => break, // EOF
+            Ok(n) => scanner.feed(&buf[..n], wanted),
             Err(e) if e.kind() == io::ErrorKind::Interrupted => continue,
             Err(e) => return Err(e),
         }
     }
 
-    Ok(counts)
+    Ok(scanner.finish())
 }
 
 fn print_counts(
@@ -186,8 +260,15 @@ fn main() {
     let mut total = Counts::default();
     let show_total = files.len() > 1;
 
+    let wanted = Wanted {
+        lines: show_lines,
+        words: show_words,
+        chars: show_chars,
+        max_line_length: show_max_length,
+    };
+
     for file in &files {
-        match count_file(file) {
+        match count_file(file, wanted) {
             Ok(counts) => {
                 print_counts(
                     &counts,
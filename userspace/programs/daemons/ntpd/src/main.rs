@@ -12,7 +12,7 @@
 
 use std::env;
 use std::mem;
-use std::net::UdpSocket;
+use std::net::{SocketAddr, ToSocketAddrs, UdpSocket};
 use std::process;
 use std::time::Duration;
 
@@ -255,10 +255,17 @@ fn resolve_hostname(hostname: &str) -> Result<[u8; 4], String> {
         }
     }
 
-    // Use DNS resolution via nslookup-style lookup
-    // For simplicity, we'll use a hardcoded resolver or fall back to known IPs
+    // Ask the system resolver; nrlib caches the answer for its TTL, so
+    // re-resolving on every poll costs no network round trip
+    if let Ok(addrs) = (hostname, NTP_PORT).to_socket_addrs() {
+        for addr in addrs {
+            if let SocketAddr::V4(v4) = addr {
+                return Ok(v4.ip().octets());
+            }
+        }
+    }
 
-    // Known NTP server IPs (fallback)
+    // Known NTP server IPs (fallback when DNS is unavailable)
     match hostname {
         "pool.ntp.org" | "0.pool.ntp.org" => Ok([162, 159, 200, 1]), // time.cloudflare.com
         "time.google.com" => Ok([216, 239, 35, 0]),
@@ -34,6 +34,8 @@ mod kmod_syscalls {
         pub module_type: u8,
         pub signed: u8,
         pub taints: u8,
+        pub load_us: u32,
+        pub _reserved: u32,
     }
 
     impl ModuleListEntry {
@@ -78,6 +80,8 @@ mod kmod_syscalls {
         pub is_tainted: u8,
         pub _reserved: [u8; 3],
         pub taint_string: [u8; 32],
+        pub sig_cache_hits: u32,
+        pub sig_cache_misses: u32,
     }
 
     impl ModuleStatistics {
@@ -153,7 +157,7 @@ fn print_usage() {
     eprintln!("Usage: lsmod [OPTIONS]");
     eprintln!();
     eprintln!("Options:");
-    eprintln!("  -v       Verbose output (include type, state, signature status)");
+    eprintln!("  -v       Verbose output (include type, state, signature status, load time)");
     eprintln!("  -s       Show module subsystem statistics");
     eprintln!("  -h       Show this help message");
     eprintln!();
@@ -176,6 +180,8 @@ fn print_statistics() {
         is_tainted: 0,
         _reserved: [0; 3],
         taint_string: [0; 32],
+        sig_cache_hits: 0,
+        sig_cache_misses: 0,
     };
 
     if !get_module_stats(&mut stats) {
@@ -195,6 +201,10 @@ fn print_statistics() {
         stats.total_memory / 1024
     );
     println!("Kernel symbols: {}", stats.symbol_count);
+    println!(
+        "Signature checks: {} verified, {} from digest cache",
+        stats.sig_cache_misses, stats.sig_cache_hits
+    );
     println!();
     println!("By type:");
     println!("  Filesystem:    {}", stats.fs_count);
@@ -213,6 +223,8 @@ fn list_modules_simple() {
         module_type: 0,
         signed: 0,
         taints: 0,
+        load_us: 0,
+        _reserved: 0,
     }; 64];
 
     let count = list_modules(&mut entries);
@@ -248,6 +260,8 @@ fn list_modules_verbose() {
         module_type: 0,
         signed: 0,
         taints: 0,
+        load_us: 0,
+        _reserved: 0,
     }; 64];
 
     let count = list_modules(&mut entries);
@@ -263,8 +277,8 @@ fn list_modules_verbose() {
 
     // Print header
     println!(
-        "{:<16} {:>8} {:>4} {:>6} {:>10} {:>8} {:>6}",
-        "Module", "Size", "Used", "Type", "State", "Signed", "Taint"
+        "{:<16} {:>8} {:>4} {:>6} {:>10} {:>8} {:>6} {:>10}",
+        "Module", "Size", "Used", "Type", "State", "Signed", "Taint", "Load(us)"
     );
 
     // Print modules
@@ -284,14 +298,15 @@ fn list_modules_verbose() {
         let taint_str = if entry.taints != 0 { "yes" } else { "no" };
 
         println!(
-            "{:<16} {:>8} {:>4} {:>6} {:>10} {:>8} {:>6}",
+            "{:<16} {:>8} {:>4} {:>6} {:>10} {:>8} {:>6} {:>10}",
             name,
             entry.size,
             entry.ref_count,
             entry.type_str(),
             entry.state_str(),
             signed_str,
-            taint_str
+            taint_str,
+            entry.load_us
         );
     }
 }
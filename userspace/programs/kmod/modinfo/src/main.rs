@@ -43,6 +43,9 @@ mod kmod_syscalls {
         pub module_type: u8,
         pub signed: u8,
         pub taints: u8,
+        pub verify_us: u32,
+        pub link_us: u32,
+        pub init_us: u32,
     }
 
     impl ModuleDetailedInfo {
@@ -223,6 +226,9 @@ fn show_module_info(name: &str) {
         module_type: 0,
         signed: 0,
         taints: 0,
+        verify_us: 0,
+        link_us: 0,
+        init_us: 0,
     };
 
     if !get_module_info(&name_bytes, &mut info) {
@@ -276,6 +282,13 @@ fn show_module_info(name: &str) {
     println!("dependencies:    {}", info.dep_count);
     println!("symbols:         {}", info.symbol_count);
     println!("parameters:      {}", info.param_count);
+    println!(
+        "load_time:       {} us (verify {} us, link {} us, init {} us)",
+        info.verify_us as u64 + info.link_us as u64 + info.init_us as u64,
+        info.verify_us,
+        info.link_us,
+        info.init_us
+    );
 }
 
 fn show_dependencies(name: &str) {
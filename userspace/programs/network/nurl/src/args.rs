@@ -57,9 +57,10 @@ pub enum HttpVersion {
 }
 
 /// Parsed command-line arguments
-#[derive(Default)]
+#[derive(Default, Clone)]
 pub struct Args {
-    pub url: Option<String>,
+    /// URLs in command-line order
+    pub urls: Vec<String>,
     pub method: HttpMethod,
     pub data: Option<Vec<u8>>,
     pub headers: Vec<(String, String)>,
@@ -67,14 +68,27 @@ pub struct Args {
     pub verbose: bool,
     pub insecure: bool,
     pub http_version: HttpVersion,
-    pub output_file: Option<String>,
+    /// Output files; the Nth `-o` belongs to the Nth URL
+    pub output_files: Vec<String>,
     /// Request compressed response (gzip, deflate)
     pub compressed: bool,
+    /// Transfers (connections, streams or ranges) to run at once
+    pub parallel: usize,
+    /// Report throughput and latency for each transfer
+    pub stats: bool,
 }
 
 impl Args {
     pub fn new() -> Self {
-        Self::default()
+        Self {
+            parallel: 1,
+            ..Self::default()
+        }
+    }
+
+    /// Output file for the URL at `index`, if one was given
+    pub fn output_for(&self, index: usize) -> Option<&str> {
+        self.output_files.get(index).map(String::as_str)
     }
 }
 
@@ -134,7 +148,7 @@ pub fn parse_args() -> Args {
             }
             "-o" | "--output" => {
                 if i + 1 < argv.len() {
-                    args.output_file = Some(argv[i + 1].clone());
+                    args.output_files.push(argv[i + 1].clone());
                     i += 1;
                 } else {
                     eprintln!("Missing argument for -o/--output");
@@ -162,6 +176,24 @@ pub fn parse_args() -> Args {
             "--compressed" => {
                 args.compressed = true;
             }
+            "--parallel" => {
+                if i + 1 < argv.len() {
+                    match argv[i + 1].parse::<usize>() {
+                        Ok(n) if n >= 1 => args.parallel = n,
+                        _ => {
+                            eprintln!("Invalid value for --parallel: {}", argv[i + 1]);
+                            process::exit(1);
+                        }
+                    }
+                    i += 1;
+                } else {
+                    eprintln!("Missing argument for --parallel");
+                    process::exit(1);
+                }
+            }
+            "--stats" => {
+                args.stats = true;
+            }
             "--help" => {
                 print_usage();
                 process::exit(0);
@@ -171,7 +203,7 @@ pub fn parse_args() -> Args {
                     eprintln!("Unknown option: {}", arg);
                     process::exit(1);
                 } else {
-                    args.url = Some(arg.clone());
+                    args.urls.push(arg.clone());
                 }
             }
         }
@@ -186,13 +218,13 @@ pub fn parse_args() -> Args {
 pub fn print_usage() {
     eprintln!("nurl - A curl-like HTTP/HTTPS client for NexaOS");
     eprintln!();
-    eprintln!("Usage: nurl [OPTIONS] <URL>");
+    eprintln!("Usage: nurl [OPTIONS] <URL>...");
     eprintln!();
     eprintln!("Options:");
     eprintln!("  -X, --request METHOD   HTTP method to use (default: GET)");
     eprintln!("  -d, --data DATA        Data to send in POST request");
     eprintln!("  -H, --header HEADER    Add custom header (format: 'Key: Value')");
-    eprintln!("  -o, --output FILE      Write output to file instead of stdout");
+    eprintln!("  -o, --output FILE      Write output to file instead of stdout (once per URL)");
     eprintln!("  -i, --include          Include response headers in output");
     eprintln!("  -v, --verbose          Verbose output");
     eprintln!("  -k, --insecure         Allow insecure SSL connections");
@@ -200,6 +232,9 @@ pub fn print_usage() {
     eprintln!("  --http2                Use HTTP/2 (when available)");
     eprintln!("  --http3                Use HTTP/3 (when available)");
     eprintln!("  --compressed           Request compressed response (gzip, deflate)");
+    eprintln!("  --parallel N           Run N transfers at once; large files are fetched");
+    eprintln!("                         in N ranges");
+    eprintln!("  --stats                Report throughput and latency per transfer");
     eprintln!("  --help                 Show this help message");
     eprintln!();
     eprintln!("Examples:");
@@ -210,4 +245,6 @@ pub fn print_usage() {
     eprintln!("  nurl -H 'Authorization: Bearer token' http://10.0.2.2:8000/");
     eprintln!("  nurl -v -i https://example.com");
     eprintln!("  nurl --http2 https://example.com");
+    eprintln!("  nurl --parallel 4 -o big.iso http://10.0.2.2:8000/big.iso");
+    eprintln!("  nurl --http2 --parallel 8 --stats https://example.com/a https://example.com/b");
 }
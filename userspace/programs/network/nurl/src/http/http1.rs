@@ -4,8 +4,8 @@ use std::net::TcpStream;
 use std::time::Duration;
 
 use super::request::Http1RequestBuilder;
-use super::response::parse_http1_response;
-use super::{HttpClient, HttpError, HttpResponse, HttpResult};
+use super::response::{find_crlf, find_header_end, parse_http1_response};
+use super::{HttpClient, HttpError, HttpResponse, HttpResult, ResponseSink};
 use crate::args::Args;
 use crate::url::ParsedUrl;
 
@@ -170,3 +170,299 @@ impl HttpClient for Http1Client {
         Ok(response)
     }
 }
+
+/// Read buffer of a streaming connection
+const READ_BUFFER_SIZE: usize = 64 * 1024;
+
+/// Byte stream under an HTTP/1.1 connection
+enum Transport {
+    Plain(TcpStream),
+    #[cfg(any(feature = "https", feature = "https-dynamic"))]
+    Tls {
+        // Declared first so the TLS session is dropped before the socket
+        tls: TlsConnection,
+        _tcp: TcpStream,
+    },
+}
+
+impl Read for Transport {
+    fn read(&mut self, buf: &mut [u8]) -> std::io::Result<usize> {
+        match self {
+            Transport::Plain(stream) => stream.read(buf),
+            #[cfg(any(feature = "https", feature = "https-dynamic"))]
+            Transport::Tls { tls, .. } => tls.read(buf),
+        }
+    }
+}
+
+impl Write for Transport {
+    fn write(&mut self, buf: &[u8]) -> std::io::Result<usize> {
+        match self {
+            Transport::Plain(stream) => stream.write(buf),
+            #[cfg(any(feature = "https", feature = "https-dynamic"))]
+            Transport::Tls { tls, .. } => Write::write(tls, buf),
+        }
+    }
+
+    fn flush(&mut self) -> std::io::Result<()> {
+        match self {
+            Transport::Plain(stream) => stream.flush(),
+            #[cfg(any(feature = "https", feature = "https-dynamic"))]
+            Transport::Tls { tls, .. } => tls.flush(),
+        }
+    }
+}
+
+/// How the end of a response body is found
+#[derive(Clone, Copy, PartialEq, Eq)]
+enum Framing {
+    /// No body (HEAD, 204, 304)
+    Empty,
+    /// Content-Length bytes
+    Length(u64),
+    /// Transfer-Encoding: chunked
+    Chunked,
+    /// Everything until the server closes the connection
+    Close,
+}
+
+/// Persistent HTTP/1.1 connection that streams responses
+///
+/// Unlike [`Http1Client`], which sends `Connection: close` and collects the
+/// whole response, this keeps the connection open between requests and
+/// passes body data to a [`ResponseSink`] as it is read.
+pub struct Http1Connection {
+    transport: Transport,
+    buf: Box<[u8]>,
+    /// Unconsumed input is `buf[pos..len]`
+    pos: usize,
+    len: usize,
+    /// A response head was read for the current request
+    head_received: bool,
+    verbose: bool,
+}
+
+// SAFETY: the TLS session is only reachable through this value and is never
+// used from two threads at once; the pool merely hands it between workers.
+unsafe impl Send for Http1Connection {}
+
+impl Http1Connection {
+    /// Connect to the origin of `url`, with TLS for https
+    pub fn connect(url: &ParsedUrl, verbose: bool, insecure: bool) -> HttpResult<Self> {
+        let client = Http1Client::new(verbose, insecure)?;
+        let stream = client.connect(url)?;
+        stream.set_nodelay(true).ok();
+
+        let transport = if url.is_https {
+            #[cfg(any(feature = "https", feature = "https-dynamic"))]
+            {
+                use std::os::unix::io::AsRawFd;
+
+                let tls = TlsConnection::new(stream.as_raw_fd(), &url.host, insecure)?;
+                Transport::Tls { tls, _tcp: stream }
+            }
+            #[cfg(not(any(feature = "https", feature = "https-dynamic")))]
+            {
+                drop(stream);
+                return Err(HttpError::NotSupported(
+                    "HTTPS not supported (compile with 'https' or 'https-dynamic' feature)"
+                        .to_string(),
+                ));
+            }
+        } else {
+            Transport::Plain(stream)
+        };
+
+        Ok(Self {
+            transport,
+            buf: vec![0u8; READ_BUFFER_SIZE].into_boxed_slice(),
+            pos: 0,
+            len: 0,
+            head_received: false,
+            verbose,
+        })
+    }
+
+    /// Whether the last request got as far as a response head; a reused
+    /// connection that failed before that can be retried on a new one
+    pub fn head_received(&self) -> bool {
+        self.head_received
+    }
+
+    /// Send `request` and stream the response into `sink`
+    ///
+    /// `head_only` marks a HEAD request, whose response has no body.
+    /// Returns whether the connection can carry another request.
+    pub fn send(
+        &mut self,
+        request: &[u8],
+        head_only: bool,
+        sink: &mut dyn ResponseSink,
+    ) -> HttpResult<bool> {
+        self.head_received = false;
+        self.transport
+            .write_all(request)
+            .map_err(|e| HttpError::SendFailed(e.to_string()))?;
+
+        let head = loop {
+            let head = self.read_head()?;
+            // Interim responses (100 Continue) come before the real one
+            if (100..200).contains(&head.status_code) && head.status_code != 101 {
+                continue;
+            }
+            break head;
+        };
+        self.head_received = true;
+
+        if self.verbose {
+            eprintln!("< {}", head.status_line());
+        }
+
+        let chunked = head
+            .get_header("transfer-encoding")
+            .map_or(false, |v| v.to_ascii_lowercase().contains("chunked"));
+        let framing = if head_only || head.status_code == 204 || head.status_code == 304 {
+            Framing::Empty
+        } else if chunked {
+            Framing::Chunked
+        } else if let Some(len) = head.get_header("content-length") {
+            Framing::Length(len.trim().parse().map_err(|_| {
+                HttpError::InvalidResponse(format!("Invalid Content-Length: {}", len))
+            })?)
+        } else {
+            Framing::Close
+        };
+
+        sink.head(&head)?;
+        match framing {
+            Framing::Empty => {}
+            Framing::Length(len) => self.read_length(len, sink)?,
+            Framing::Chunked => self.read_chunked(sink)?,
+            Framing::Close => self.read_to_close(sink)?,
+        }
+
+        let close = head
+            .get_header("connection")
+            .map_or(false, |v| v.eq_ignore_ascii_case("close"));
+        Ok(!close && head.version == "HTTP/1.1" && framing != Framing::Close)
+    }
+
+    /// Read more input; false at end of stream
+    fn fill(&mut self) -> HttpResult<bool> {
+        if self.pos == self.len {
+            self.pos = 0;
+            self.len = 0;
+        } else if self.len == self.buf.len() {
+            if self.pos == 0 {
+                return Err(HttpError::InvalidResponse(
+                    "Response head too large".to_string(),
+                ));
+            }
+            self.buf.copy_within(self.pos..self.len, 0);
+            self.len -= self.pos;
+            self.pos = 0;
+        }
+
+        loop {
+            match self.transport.read(&mut self.buf[self.len..]) {
+                Ok(n) => {
+                    self.len += n;
+                    return Ok(n > 0);
+                }
+                Err(e)
+                    if e.kind() == std::io::ErrorKind::Interrupted
+                        || e.kind() == std::io::ErrorKind::WouldBlock => {}
+                Err(e) => return Err(HttpError::ReceiveFailed(e.to_string())),
+            }
+        }
+    }
+
+    /// Read and parse the next response head
+    fn read_head(&mut self) -> HttpResult<HttpResponse> {
+        loop {
+            if let Some(end) = find_header_end(&self.buf[self.pos..self.len]) {
+                let head = parse_http1_response(&self.buf[self.pos..self.pos + end + 4])?;
+                self.pos += end + 4;
+                return Ok(head);
+            }
+            if !self.fill()? {
+                return Err(HttpError::ReceiveFailed(
+                    "Connection closed before response".to_string(),
+                ));
+            }
+        }
+    }
+
+    /// Next CRLF-terminated line, without the CRLF
+    fn read_line(&mut self) -> HttpResult<String> {
+        loop {
+            if let Some(end) = find_crlf(&self.buf[self.pos..self.len]) {
+                let line =
+                    String::from_utf8_lossy(&self.buf[self.pos..self.pos + end]).into_owned();
+                self.pos += end + 2;
+                return Ok(line);
+            }
+            if !self.fill()? {
+                return Err(HttpError::ReceiveFailed(
+                    "Connection closed in chunked body".to_string(),
+                ));
+            }
+        }
+    }
+
+    /// Pass exactly `remaining` body bytes to the sink
+    fn read_length(&mut self, mut remaining: u64, sink: &mut dyn ResponseSink) -> HttpResult<()> {
+        while remaining > 0 {
+            if self.pos == self.len && !self.fill()? {
+                return Err(HttpError::ReceiveFailed(
+                    "Connection closed before end of body".to_string(),
+                ));
+            }
+            let n = remaining.min((self.len - self.pos) as u64) as usize;
+            sink.data(&self.buf[self.pos..self.pos + n])?;
+            self.pos += n;
+            remaining -= n as u64;
+        }
+        Ok(())
+    }
+
+    /// Decode a chunked body into the sink
+    fn read_chunked(&mut self, sink: &mut dyn ResponseSink) -> HttpResult<()> {
+        loop {
+            let line = self.read_line()?;
+            // Remove any chunk extension (after semicolon)
+            let size_str = line.split(';').next().unwrap_or("").trim();
+            let size = u64::from_str_radix(size_str, 16).map_err(|_| {
+                HttpError::InvalidResponse(format!("Invalid chunk size: {}", size_str))
+            })?;
+
+            if size == 0 {
+                // Skip trailers up to the empty line
+                while !self.read_line()?.is_empty() {}
+                return Ok(());
+            }
+
+            self.read_length(size, sink)?;
+            if !self.read_line()?.is_empty() {
+                return Err(HttpError::InvalidResponse(
+                    "Missing CRLF after chunk data".to_string(),
+                ));
+            }
+        }
+    }
+
+    /// Pass everything up to connection close to the sink
+    fn read_to_close(&mut self, sink: &mut dyn ResponseSink) -> HttpResult<()> {
+        loop {
+            if self.pos < self.len {
+                sink.data(&self.buf[self.pos..self.len])?;
+                self.pos = self.len;
+            }
+            // Like read_to_end, an unclean close still ends the body
+            match self.fill() {
+                Ok(true) => {}
+                Ok(false) | Err(_) => return Ok(()),
+            }
+        }
+    }
+}
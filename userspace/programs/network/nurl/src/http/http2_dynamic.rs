@@ -4,7 +4,7 @@
 /// the nh2 library via dynamic linking.
 use std::io::{Read, Write};
 use std::net::TcpStream;
-use std::time::Duration;
+use std::time::{Duration, Instant};
 
 use super::{HttpClient, HttpError, HttpResponse, HttpResult};
 use crate::args::Args;
@@ -14,6 +14,22 @@ use crate::url::ParsedUrl;
 #[cfg(any(feature = "https", feature = "https-dynamic"))]
 use crate::tls::TlsConnection;
 
+/// One request of a multiplexed batch (see [`Http2Client::request_many`])
+pub struct Http2Request<'a> {
+    pub url: &'a ParsedUrl,
+    /// Headers added to the ones built from the arguments (e.g. Range)
+    pub extra_headers: Vec<(String, String)>,
+}
+
+/// Deletes the session when a multiplexed exchange ends, however it ends
+struct SessionGuard(*mut nghttp2_session);
+
+impl Drop for SessionGuard {
+    fn drop(&mut self) {
+        unsafe { nghttp2_session_del(self.0) };
+    }
+}
+
 /// HTTP/2 client using dynamic linking to libnh2.so
 pub struct Http2Client {
     verbose: bool,
@@ -108,30 +124,8 @@ impl Http2Client {
         args: &Args,
         url: &ParsedUrl,
     ) -> HttpResult<HttpResponse> {
-        // Create session callbacks
-        let mut callbacks: *mut nghttp2_session_callbacks = std::ptr::null_mut();
-        let rv = unsafe { nghttp2_session_callbacks_new(&mut callbacks) };
-        if rv != 0 || callbacks.is_null() {
-            return Err(HttpError::ProtocolError(
-                "Failed to create session callbacks".to_string(),
-            ));
-        }
-
         // Create client session
-        let mut session: *mut nghttp2_session = std::ptr::null_mut();
-        let rv = unsafe {
-            nghttp2_session_client_new(&mut session, callbacks, std::ptr::null_mut())
-        };
-
-        // Free callbacks after creating session
-        unsafe { nghttp2_session_callbacks_del(callbacks) };
-
-        if rv != 0 || session.is_null() {
-            return Err(HttpError::ProtocolError(format!(
-                "Failed to create client session: {}",
-                rv
-            )));
-        }
+        let session = new_session()?;
 
         // Build request headers
         let headers = self.build_headers(args, url);
@@ -281,68 +275,12 @@ impl Http2Client {
             }
         }
 
-        // Get response data using the new nh2 C API
-        let response_data_ptr = unsafe {
-            nghttp2_session_get_stream_response_data(session, stream_id)
-        };
+        let response = take_response(session, stream_id);
 
         // Clean up session
         unsafe { nghttp2_session_del(session) };
 
-        if response_data_ptr.is_null() {
-            return Err(HttpError::InvalidResponse(
-                "Failed to get stream response data".to_string(),
-            ));
-        }
-
-        // Extract response data
-        let response_data = unsafe { &*response_data_ptr };
-        let status_code = response_data.status_code;
-
-        // Extract headers
-        let mut headers = Vec::new();
-        if !response_data.headers.is_null() && response_data.headers_len > 0 {
-            for i in 0..response_data.headers_len {
-                let h = unsafe { &*response_data.headers.add(i) };
-                if !h.name.is_null() && !h.value.is_null() {
-                    let name = unsafe {
-                        String::from_utf8_lossy(std::slice::from_raw_parts(h.name, h.name_len))
-                            .to_string()
-                    };
-                    let value = unsafe {
-                        String::from_utf8_lossy(std::slice::from_raw_parts(h.value, h.value_len))
-                            .to_string()
-                    };
-                    headers.push((name, value));
-                }
-            }
-        }
-
-        // Extract body
-        let body = if !response_data.body.is_null() && response_data.body_len > 0 {
-            unsafe {
-                std::slice::from_raw_parts(response_data.body, response_data.body_len).to_vec()
-            }
-        } else {
-            Vec::new()
-        };
-
-        // Free the response data
-        unsafe { nghttp2_stream_response_data_free(response_data_ptr) };
-
-        if status_code == 0 {
-            return Err(HttpError::InvalidResponse(
-                "No :status header received".to_string(),
-            ));
-        }
-
-        Ok(HttpResponse {
-            status_code,
-            reason: http_status_reason(status_code).to_string(),
-            headers,
-            body,
-            version: "HTTP/2".to_string(),
-        })
+        response
     }
 
     /// Perform HTTP/2 over plain TCP (h2c)
@@ -358,22 +296,16 @@ impl Http2Client {
         self.perform_http2(&mut stream, args, url)
     }
 
-    /// Perform HTTP/2 over TLS (h2)
+    /// TLS handshake on `tcp_stream`; fails unless the server picks h2
     #[cfg(any(feature = "https", feature = "https-dynamic"))]
-    fn perform_h2(
-        &self,
-        tcp_stream: TcpStream,
-        hostname: &str,
-        args: &Args,
-        url: &ParsedUrl,
-    ) -> HttpResult<HttpResponse> {
+    fn handshake_h2(&self, tcp_stream: &TcpStream, hostname: &str) -> HttpResult<TlsConnection> {
         use std::os::unix::io::AsRawFd;
 
         if self.verbose {
             eprintln!("* [HTTP/2] Performing TLS handshake with ALPN (dynamic linking)...");
         }
 
-        let mut tls = TlsConnection::new_with_alpn(
+        let tls = TlsConnection::new_with_alpn(
             tcp_stream.as_raw_fd(),
             hostname,
             self.insecure,
@@ -401,8 +333,295 @@ impl Http2Client {
             }
         }
 
+        Ok(tls)
+    }
+
+    /// Perform HTTP/2 over TLS (h2)
+    #[cfg(any(feature = "https", feature = "https-dynamic"))]
+    fn perform_h2(
+        &self,
+        tcp_stream: TcpStream,
+        hostname: &str,
+        args: &Args,
+        url: &ParsedUrl,
+    ) -> HttpResult<HttpResponse> {
+        let mut tls = self.handshake_h2(&tcp_stream, hostname)?;
         self.perform_http2(&mut tls, args, url)
     }
+
+    /// Run `requests`, which share one origin, as concurrent streams of a
+    /// single connection with at most `max_streams` open at once
+    ///
+    /// `done` is called exactly once per request, with its index, the time
+    /// it was submitted and the result. Requests cut short by a connection
+    /// or session failure are reported as errors so the caller can retry
+    /// them over another protocol.
+    pub fn request_many(
+        &mut self,
+        args: &Args,
+        requests: &[Http2Request<'_>],
+        max_streams: usize,
+        done: &mut dyn FnMut(usize, Instant, HttpResult<HttpResponse>),
+    ) {
+        let Some(first) = requests.first() else {
+            return;
+        };
+        let mut reported = vec![false; requests.len()];
+
+        let result = self.connect(first.url).and_then(|mut stream| {
+            if first.url.is_https {
+                #[cfg(any(feature = "https", feature = "https-dynamic"))]
+                {
+                    let mut tls = self.handshake_h2(&stream, &first.url.host)?;
+                    self.multiplex(&mut tls, args, requests, max_streams, &mut reported, done)
+                }
+                #[cfg(not(any(feature = "https", feature = "https-dynamic")))]
+                {
+                    Err(HttpError::NotSupported(
+                        "HTTPS not supported (compile with 'https' or 'https-dynamic' feature)"
+                            .to_string(),
+                    ))
+                }
+            } else {
+                self.multiplex(&mut stream, args, requests, max_streams, &mut reported, done)
+            }
+        });
+
+        if let Err(e) = result {
+            if self.verbose {
+                eprintln!("* [HTTP/2] Connection failed: {}", e);
+            }
+            let now = Instant::now();
+            for (index, _) in reported.iter().enumerate().filter(|(_, seen)| !**seen) {
+                done(index, now, Err(e.clone()));
+            }
+        }
+    }
+
+    /// Drive a batch of requests over one session on `stream`
+    fn multiplex<S: Read + Write>(
+        &self,
+        stream: &mut S,
+        args: &Args,
+        requests: &[Http2Request<'_>],
+        max_streams: usize,
+        reported: &mut [bool],
+        done: &mut dyn FnMut(usize, Instant, HttpResult<HttpResponse>),
+    ) -> HttpResult<()> {
+        let session = SessionGuard(new_session()?);
+        let mut next = 0;
+        // (stream ID, request index, submit time)
+        let mut open: Vec<(i32, usize, Instant)> = Vec::new();
+        let mut recv_buffer = vec![0u8; 65536];
+
+        loop {
+            // Keep the window of open streams full
+            while open.len() < max_streams.max(1) && next < requests.len() {
+                let request = &requests[next];
+                let mut headers = self.build_headers(args, request.url);
+                for (name, value) in &request.extra_headers {
+                    headers.push((name.to_lowercase().into_bytes(), value.as_bytes().to_vec()));
+                }
+                let stream_id = submit_request(session.0, &headers)?;
+                if self.verbose {
+                    eprintln!(
+                        "* [HTTP/2] Stream {}: {}",
+                        stream_id,
+                        request.url.path_with_query()
+                    );
+                }
+                open.push((stream_id, next, Instant::now()));
+                next += 1;
+            }
+            if open.is_empty() {
+                return Ok(());
+            }
+
+            send_pending(session.0, stream)?;
+
+            let n = match stream.read(&mut recv_buffer) {
+                Ok(0) => {
+                    return Err(HttpError::ReceiveFailed(
+                        "Connection closed by server".to_string(),
+                    ))
+                }
+                Ok(n) => n,
+                Err(e)
+                    if e.kind() == std::io::ErrorKind::WouldBlock
+                        || e.kind() == std::io::ErrorKind::Interrupted =>
+                {
+                    continue
+                }
+                Err(e) => return Err(HttpError::ReceiveFailed(e.to_string())),
+            };
+
+            let consumed = unsafe { nghttp2_session_mem_recv(session.0, recv_buffer.as_ptr(), n) };
+            if consumed < 0 {
+                return Err(HttpError::ProtocolError(format!(
+                    "Failed to process data: {}",
+                    error_string(consumed as i32)
+                )));
+            }
+
+            // Hand over every stream that has finished
+            let mut i = 0;
+            while i < open.len() {
+                let (stream_id, index, submitted) = open[i];
+                let state = unsafe { nghttp2_session_get_stream_state(session.0, stream_id) };
+                if state == NGHTTP2_STREAM_STATE_CLOSED
+                    || state == NGHTTP2_STREAM_STATE_HALF_CLOSED_REMOTE
+                {
+                    open.swap_remove(i);
+                    reported[index] = true;
+                    done(index, submitted, take_response(session.0, stream_id));
+                } else {
+                    i += 1;
+                }
+            }
+        }
+    }
+}
+
+/// Create a client session with default callbacks
+fn new_session() -> HttpResult<*mut nghttp2_session> {
+    let mut callbacks: *mut nghttp2_session_callbacks = std::ptr::null_mut();
+    let rv = unsafe { nghttp2_session_callbacks_new(&mut callbacks) };
+    if rv != 0 || callbacks.is_null() {
+        return Err(HttpError::ProtocolError(
+            "Failed to create session callbacks".to_string(),
+        ));
+    }
+
+    let mut session: *mut nghttp2_session = std::ptr::null_mut();
+    let rv = unsafe { nghttp2_session_client_new(&mut session, callbacks, std::ptr::null_mut()) };
+    unsafe { nghttp2_session_callbacks_del(callbacks) };
+
+    if rv != 0 || session.is_null() {
+        return Err(HttpError::ProtocolError(format!(
+            "Failed to create client session: {}",
+            rv
+        )));
+    }
+    Ok(session)
+}
+
+/// Submit a bodiless request; returns its stream ID
+fn submit_request(
+    session: *mut nghttp2_session,
+    headers: &[(Vec<u8>, Vec<u8>)],
+) -> HttpResult<i32> {
+    let nva: Vec<nghttp2_nv> = headers
+        .iter()
+        .map(|(name, value)| nghttp2_nv {
+            name: name.as_ptr(),
+            value: value.as_ptr(),
+            namelen: name.len(),
+            valuelen: value.len(),
+            flags: NGHTTP2_NV_FLAG_NONE,
+        })
+        .collect();
+
+    let stream_id = unsafe {
+        nghttp2_submit_request(
+            session,
+            std::ptr::null(),
+            nva.as_ptr(),
+            nva.len(),
+            std::ptr::null(),
+            std::ptr::null_mut(),
+        )
+    };
+    if stream_id < 0 {
+        return Err(HttpError::ProtocolError(format!(
+            "Failed to submit request: {}",
+            stream_id
+        )));
+    }
+    Ok(stream_id)
+}
+
+/// Write every frame the session has queued
+fn send_pending<S: Write>(session: *mut nghttp2_session, stream: &mut S) -> HttpResult<()> {
+    loop {
+        let mut data_ptr: *const u8 = std::ptr::null();
+        let len = unsafe { nghttp2_session_mem_send(session, &mut data_ptr) };
+        if len <= 0 || data_ptr.is_null() {
+            return Ok(());
+        }
+        let data = unsafe { std::slice::from_raw_parts(data_ptr, len as usize) };
+        stream
+            .write_all(data)
+            .map_err(|e| HttpError::SendFailed(e.to_string()))?;
+    }
+}
+
+/// nh2 error code as text
+fn error_string(code: i32) -> String {
+    unsafe {
+        let ptr = nghttp2_strerror(code);
+        if ptr.is_null() {
+            "Unknown error".to_string()
+        } else {
+            std::ffi::CStr::from_ptr(ptr).to_string_lossy().into_owned()
+        }
+    }
+}
+
+/// Collect the response nh2 buffered for a finished stream
+fn take_response(session: *mut nghttp2_session, stream_id: i32) -> HttpResult<HttpResponse> {
+    let response_data_ptr = unsafe { nghttp2_session_get_stream_response_data(session, stream_id) };
+    if response_data_ptr.is_null() {
+        return Err(HttpError::InvalidResponse(
+            "Failed to get stream response data".to_string(),
+        ));
+    }
+
+    // Extract response data
+    let response_data = unsafe { &*response_data_ptr };
+    let status_code = response_data.status_code;
+
+    // Extract headers
+    let mut headers = Vec::new();
+    if !response_data.headers.is_null() && response_data.headers_len > 0 {
+        for i in 0..response_data.headers_len {
+            let h = unsafe { &*response_data.headers.add(i) };
+            if !h.name.is_null() && !h.value.is_null() {
+                let name = unsafe {
+                    String::from_utf8_lossy(std::slice::from_raw_parts(h.name, h.name_len))
+                        .to_string()
+                };
+                let value = unsafe {
+                    String::from_utf8_lossy(std::slice::from_raw_parts(h.value, h.value_len))
+                        .to_string()
+                };
+                headers.push((name, value));
+            }
+        }
+    }
+
+    // Extract body
+    let body = if !response_data.body.is_null() && response_data.body_len > 0 {
+        unsafe { std::slice::from_raw_parts(response_data.body, response_data.body_len).to_vec() }
+    } else {
+        Vec::new()
+    };
+
+    // Free the response data
+    unsafe { nghttp2_stream_response_data_free(response_data_ptr) };
+
+    if status_code == 0 {
+        return Err(HttpError::InvalidResponse(
+            "No :status header received".to_string(),
+        ));
+    }
+
+    Ok(HttpResponse {
+        status_code,
+        reason: http_status_reason(status_code).to_string(),
+        headers,
+        body,
+        version: "HTTP/2".to_string(),
+    })
 }
 
 impl HttpClient for Http2Client {
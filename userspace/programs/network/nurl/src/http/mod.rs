@@ -5,6 +5,7 @@
 /// - HTTP/2 (implemented via nh2 - static or dynamic linking)
 /// - HTTP/3 (implemented via nh3 - dynamic linking with libnghttp3.so)
 pub mod http1;
+pub mod pool;
 pub mod request;
 pub mod response;
 
@@ -34,7 +35,7 @@ use crate::url::ParsedUrl;
 pub type HttpResult<T> = Result<T, HttpError>;
 
 /// HTTP error types
-#[derive(Debug)]
+#[derive(Debug, Clone)]
 pub enum HttpError {
     /// Connection failed
     ConnectionFailed(String),
@@ -54,6 +55,8 @@ pub enum HttpError {
     NotSupported(String),
     /// Decompression error
     DecompressionError(String),
+    /// Writing the output failed
+    WriteFailed(String),
 }
 
 impl std::fmt::Display for HttpError {
@@ -68,6 +71,7 @@ impl std::fmt::Display for HttpError {
             HttpError::Timeout => write!(f, "Request timeout"),
             HttpError::NotSupported(msg) => write!(f, "Not supported: {}", msg),
             HttpError::DecompressionError(msg) => write!(f, "Decompression error: {}", msg),
+            HttpError::WriteFailed(msg) => write!(f, "Write failed: {}", msg),
         }
     }
 }
@@ -210,6 +214,27 @@ pub trait HttpClient {
     fn request(&mut self, args: &Args, url: &ParsedUrl) -> HttpResult<HttpResponse>;
 }
 
+/// Receives a response while it is being read
+///
+/// Used by the streaming HTTP/1.1 connection, so large bodies go straight
+/// to their destination instead of being collected first.
+pub trait ResponseSink {
+    /// Status line and headers have arrived (`head.body` is empty)
+    fn head(&mut self, head: &HttpResponse) -> HttpResult<()>;
+    /// Next piece of the body, transfer coding already removed
+    fn data(&mut self, data: &[u8]) -> HttpResult<()>;
+}
+
+/// Hand a complete response to a sink, for protocols that buffer the body
+pub fn deliver(mut response: HttpResponse, sink: &mut dyn ResponseSink) -> HttpResult<()> {
+    let body = std::mem::take(&mut response.body);
+    sink.head(&response)?;
+    if !body.is_empty() {
+        sink.data(&body)?;
+    }
+    Ok(())
+}
+
 /// Perform an HTTP request using the appropriate protocol version
 pub fn perform_request(args: &Args, url: &ParsedUrl) -> HttpResult<HttpResponse> {
     let mut response = match args.http_version {
@@ -0,0 +1,104 @@
+/// Keep-alive connection pool for HTTP/1.1
+///
+/// Workers take an idle connection to the request's origin, or open one,
+/// and put it back once the response has been read completely. A reused
+/// connection the server closed while it sat idle fails before a response
+/// head arrives; such a request is retried once on a new connection.
+use std::collections::HashMap;
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::sync::Mutex;
+
+use super::http1::Http1Connection;
+use super::{HttpResult, ResponseSink};
+use crate::url::ParsedUrl;
+
+/// Idle connections kept per origin
+const MAX_IDLE_PER_ORIGIN: usize = 16;
+
+/// Pool of idle HTTP/1.1 connections, keyed by origin
+pub struct ConnectionPool {
+    idle: Mutex<HashMap<String, Vec<Http1Connection>>>,
+    verbose: bool,
+    insecure: bool,
+    opened: AtomicUsize,
+    reused: AtomicUsize,
+}
+
+impl ConnectionPool {
+    /// Create an empty pool
+    pub fn new(verbose: bool, insecure: bool) -> Self {
+        Self {
+            idle: Mutex::new(HashMap::new()),
+            verbose,
+            insecure,
+            opened: AtomicUsize::new(0),
+            reused: AtomicUsize::new(0),
+        }
+    }
+
+    /// Pool key: scheme, host and port
+    fn origin(url: &ParsedUrl) -> String {
+        format!("{}://{}", url.scheme(), url.addr())
+    }
+
+    fn take(&self, origin: &str) -> Option<Http1Connection> {
+        let mut idle = self.idle.lock().unwrap_or_else(|e| e.into_inner());
+        idle.get_mut(origin).and_then(Vec::pop)
+    }
+
+    fn put(&self, origin: String, conn: Http1Connection) {
+        let mut idle = self.idle.lock().unwrap_or_else(|e| e.into_inner());
+        let conns = idle.entry(origin).or_default();
+        if conns.len() < MAX_IDLE_PER_ORIGIN {
+            conns.push(conn);
+        }
+    }
+
+    /// Send `request` to the origin of `url` and stream the response into
+    /// `sink`, on a pooled connection when one is idle
+    pub fn request(
+        &self,
+        url: &ParsedUrl,
+        request: &[u8],
+        head_only: bool,
+        sink: &mut dyn ResponseSink,
+    ) -> HttpResult<()> {
+        let origin = Self::origin(url);
+
+        if let Some(mut conn) = self.take(&origin) {
+            match conn.send(request, head_only, sink) {
+                Ok(reusable) => {
+                    self.reused.fetch_add(1, Ordering::Relaxed);
+                    if reusable {
+                        self.put(origin, conn);
+                    }
+                    return Ok(());
+                }
+                Err(e) if conn.head_received() => return Err(e),
+                Err(e) => {
+                    if self.verbose {
+                        eprintln!(
+                            "* Reused connection to {} failed ({}), reconnecting",
+                            origin, e
+                        );
+                    }
+                }
+            }
+        }
+
+        let mut conn = Http1Connection::connect(url, self.verbose, self.insecure)?;
+        self.opened.fetch_add(1, Ordering::Relaxed);
+        if conn.send(request, head_only, sink)? {
+            self.put(origin, conn);
+        }
+        Ok(())
+    }
+
+    /// Connections opened and requests that reused an idle connection
+    pub fn counts(&self) -> (usize, usize) {
+        (
+            self.opened.load(Ordering::Relaxed),
+            self.reused.load(Ordering::Relaxed),
+        )
+    }
+}
@@ -10,6 +10,7 @@ pub struct Http1RequestBuilder {
     headers: Vec<(String, String)>,
     body: Option<Vec<u8>>,
     compressed: bool,
+    keep_alive: bool,
 }
 
 impl Http1RequestBuilder {
@@ -22,6 +23,7 @@ impl Http1RequestBuilder {
             headers: Vec::new(),
             body: None,
             compressed: false,
+            keep_alive: false,
         }
     }
 
@@ -51,6 +53,18 @@ impl Http1RequestBuilder {
         self
     }
 
+    /// Change the request method
+    pub fn method(mut self, method: HttpMethod) -> Self {
+        self.method = method;
+        self
+    }
+
+    /// Ask the server to keep the connection open for further requests
+    pub fn keep_alive(mut self, keep_alive: bool) -> Self {
+        self.keep_alive = keep_alive;
+        self
+    }
+
     /// Set the request body
     pub fn body(mut self, body: Vec<u8>) -> Self {
         self.body = Some(body);
@@ -117,8 +131,12 @@ impl Http1RequestBuilder {
             }
         }
 
-        // Connection: close for simplicity
-        request.push_str("Connection: close\r\n");
+        // Connection: close unless the connection goes back to a pool
+        if self.keep_alive {
+            request.push_str("Connection: keep-alive\r\n");
+        } else {
+            request.push_str("Connection: close\r\n");
+        }
 
         // End of headers
         request.push_str("\r\n");
@@ -118,7 +118,7 @@ fn status_reason(code: u16) -> &'static str {
 }
 
 /// Find the position of \r\n\r\n in the byte slice (end of HTTP headers)
-fn find_header_end(data: &[u8]) -> Option<usize> {
+pub fn find_header_end(data: &[u8]) -> Option<usize> {
     if data.len() < 4 {
         return None;
     }
@@ -173,7 +173,7 @@ fn decode_chunked(data: &[u8]) -> HttpResult<Vec<u8>> {
 }
 
 /// Find \r\n in byte slice
-fn find_crlf(data: &[u8]) -> Option<usize> {
+pub fn find_crlf(data: &[u8]) -> Option<usize> {
     if data.len() < 2 {
         return None;
     }
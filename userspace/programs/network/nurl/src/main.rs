@@ -2,22 +2,26 @@
 ///
 /// Supports HTTP/1.1 with plans for HTTP/2 and HTTP/3.
 ///
-/// Usage: nurl [OPTIONS] <URL>
+/// Usage: nurl [OPTIONS] <URL>...
 ///
 /// Options:
 ///   -X, --request METHOD   HTTP method to use (default: GET)
 ///   -d, --data DATA        Data to send in POST request
 ///   -H, --header HEADER    Add custom header
-///   -o, --output FILE      Write output to file
+///   -o, --output FILE      Write output to file (once per URL)
 ///   -i, --include          Include response headers in output
 ///   -v, --verbose          Verbose output
 ///   -k, --insecure         Allow insecure SSL connections
 ///   --http1.1              Force HTTP/1.1
 ///   --http2                Use HTTP/2 (when available)
 ///   --http3                Use HTTP/3 (when available)
+///   --parallel N           Run N transfers at once (ranges for large files)
+///   --stats                Report throughput and latency per transfer
 ///   --help                 Show this help message
 mod args;
 mod http;
+mod output;
+mod parallel;
 mod url;
 
 // TLS module selection based on features:
@@ -80,7 +84,6 @@ mod tls {
     }
 }
 
-use std::fs::File;
 use std::io::Write;
 use std::process;
 
@@ -91,12 +94,18 @@ use url::parse_url;
 fn main() {
     let args = parse_args();
 
-    if args.url.is_none() {
+    if args.urls.is_empty() {
         print_usage();
         process::exit(1);
     }
 
-    let url_str = args.url.as_ref().unwrap();
+    // Several URLs, parallel transfers, file output and statistics go
+    // through the streaming transfer engine
+    if args.urls.len() > 1 || args.parallel > 1 || args.stats || !args.output_files.is_empty() {
+        process::exit(parallel::run(&args));
+    }
+
+    let url_str = &args.urls[0];
 
     if args.verbose {
         eprintln!("* Requesting: {}", url_str);
@@ -128,17 +137,7 @@ fn main() {
     };
 
     // Output response
-    let output: Box<dyn Write> = if let Some(ref path) = args.output_file {
-        match File::create(path) {
-            Ok(f) => Box::new(f),
-            Err(e) => {
-                eprintln!("Error creating output file '{}': {}", path, e);
-                process::exit(1);
-            }
-        }
-    } else {
-        Box::new(std::io::stdout())
-    };
+    let output: Box<dyn Write> = Box::new(std::io::stdout());
 
     if let Err(e) = write_output(output, &args, &response) {
         eprintln!("Error writing output: {}", e);
@@ -18,7 +18,7 @@
 #![allow(non_snake_case)]
 #![allow(dead_code)]
 
-use std::os::raw::{c_char, c_int, c_ulong};
+use std::os::raw::{c_char, c_int, c_ulong, c_void};
 
 // ============================================================================
 // Type Definitions (zlib compatible)
@@ -51,6 +51,10 @@ pub const Z_BUF_ERROR: c_int = -5;
 /// Version error
 pub const Z_VERSION_ERROR: c_int = -6;
 
+/// Flush modes
+pub const Z_NO_FLUSH: c_int = 0;
+pub const Z_FINISH: c_int = 4;
+
 /// Default compression level
 pub const Z_DEFAULT_COMPRESSION: c_int = -1;
 /// No compression
@@ -60,6 +64,29 @@ pub const Z_BEST_SPEED: c_int = 1;
 /// Best compression
 pub const Z_BEST_COMPRESSION: c_int = 9;
 
+// ============================================================================
+// z_stream Structure (zlib ABI compatible)
+// ============================================================================
+
+/// Streaming state shared with libnzip.so, laid out as zlib's z_stream
+#[repr(C)]
+pub struct z_stream {
+    pub next_in: *const Bytef,
+    pub avail_in: uInt,
+    pub total_in: uLong,
+    pub next_out: *mut Bytef,
+    pub avail_out: uInt,
+    pub total_out: uLong,
+    pub msg: *const c_char,
+    pub state: *mut c_void,
+    pub zalloc: Option<extern "C" fn(*mut c_void, uInt, uInt) -> *mut c_void>,
+    pub zfree: Option<extern "C" fn(*mut c_void, *mut c_void)>,
+    pub opaque: *mut c_void,
+    pub data_type: c_int,
+    pub adler: uLong,
+    pub reserved: uLong,
+}
+
 // ============================================================================
 // External Functions (linked dynamically from libz.so / libnzip.so)
 // ============================================================================
@@ -124,6 +151,25 @@ extern "C" {
         source_len: *mut uLong,
     ) -> c_int;
 
+    // ========================================================================
+    // Streaming Decompression
+    // ========================================================================
+
+    /// Initialize an inflate stream; `window_bits` selects the wrapper
+    /// (8..15 zlib, 24..31 gzip, -8..-15 raw deflate)
+    pub fn inflateInit2_(
+        strm: *mut z_stream,
+        window_bits: c_int,
+        version: *const c_char,
+        stream_size: c_int,
+    ) -> c_int;
+
+    /// Decompress as much input as possible into the output buffer
+    pub fn inflate(strm: *mut z_stream, flush: c_int) -> c_int;
+
+    /// Free an inflate stream
+    pub fn inflateEnd(strm: *mut z_stream) -> c_int;
+
     // ========================================================================
     // GZIP Format Functions (NexaOS Extensions)
     // ========================================================================
@@ -0,0 +1,297 @@
+/// Transfer output
+///
+/// Response bodies go to their destination while they are received:
+/// - `RangeWriter` gathers writes into large buffers and writes them at a
+///   file offset, so several ranges of one file can be written at once.
+/// - `Decoder` removes gzip/deflate content coding with a streaming
+///   inflate, so compressed bodies are not held in memory either.
+use std::fs::File;
+use std::os::unix::fs::FileExt;
+use std::sync::Arc;
+
+use crate::http::{HttpError, HttpResult};
+
+/// Bytes gathered before they are written to the file
+pub const WRITE_BUFFER_SIZE: usize = 1024 * 1024;
+
+/// Buffered writer at a position of a shared file
+pub struct RangeWriter {
+    file: Arc<File>,
+    offset: u64,
+    buf: Vec<u8>,
+}
+
+impl RangeWriter {
+    /// Write to `file` starting at `offset`
+    pub fn new(file: Arc<File>, offset: u64) -> Self {
+        Self {
+            file,
+            offset,
+            buf: Vec::with_capacity(WRITE_BUFFER_SIZE),
+        }
+    }
+
+    pub fn write(&mut self, data: &[u8]) -> HttpResult<()> {
+        if self.buf.len() + data.len() > WRITE_BUFFER_SIZE {
+            self.flush()?;
+        }
+        if data.len() >= WRITE_BUFFER_SIZE {
+            // Pieces this large are written without the copy
+            self.write_at(data)
+        } else {
+            self.buf.extend_from_slice(data);
+            Ok(())
+        }
+    }
+
+    pub fn flush(&mut self) -> HttpResult<()> {
+        if !self.buf.is_empty() {
+            let buf = std::mem::take(&mut self.buf);
+            self.write_at(&buf)?;
+            self.buf = buf;
+            self.buf.clear();
+        }
+        Ok(())
+    }
+
+    fn write_at(&mut self, data: &[u8]) -> HttpResult<()> {
+        self.file
+            .write_all_at(data, self.offset)
+            .map_err(|e| HttpError::WriteFailed(e.to_string()))?;
+        self.offset += data.len() as u64;
+        Ok(())
+    }
+}
+
+/// Where a transfer's body goes
+pub enum Output {
+    File(RangeWriter),
+    /// Kept for stdout, which all transfers share
+    Memory(Vec<u8>),
+}
+
+impl Output {
+    pub fn write(&mut self, data: &[u8]) -> HttpResult<()> {
+        match self {
+            Output::File(writer) => writer.write(data),
+            Output::Memory(buf) => {
+                buf.extend_from_slice(data);
+                Ok(())
+            }
+        }
+    }
+
+    pub fn flush(&mut self) -> HttpResult<()> {
+        match self {
+            Output::File(writer) => writer.flush(),
+            Output::Memory(_) => Ok(()),
+        }
+    }
+}
+
+// Streaming inflate selection based on features:
+// - compression-dynamic: z_stream API of libnzip.so via FFI
+// - compression: z_stream API of the nzip crate
+
+#[cfg(feature = "compression-dynamic")]
+use crate::nzip_ffi::{
+    inflate, inflateEnd, inflateInit2_, z_stream, zlibVersion, Z_BUF_ERROR, Z_NO_FLUSH, Z_OK,
+    Z_STREAM_END,
+};
+#[cfg(all(feature = "compression", not(feature = "compression-dynamic")))]
+use nzip::{
+    inflate, inflateEnd, inflateInit2_, z_stream, zlibVersion, Z_BUF_ERROR, Z_NO_FLUSH, Z_OK,
+    Z_STREAM_END,
+};
+
+/// Decoded bytes produced per inflate call
+#[cfg(any(feature = "compression", feature = "compression-dynamic"))]
+const INFLATE_CHUNK: usize = 256 * 1024;
+
+/// Content codings the decoder understands
+#[cfg(any(feature = "compression", feature = "compression-dynamic"))]
+enum Coding {
+    Gzip,
+    Deflate,
+}
+
+/// Streaming Content-Encoding decoder
+#[cfg(any(feature = "compression", feature = "compression-dynamic"))]
+pub struct Decoder {
+    strm: Box<z_stream>,
+    coding: Coding,
+    /// inflateInit2_ has run
+    started: bool,
+    /// Input held back until the deflate wrapper can be told apart
+    pending: Vec<u8>,
+    out: Box<[u8]>,
+    finished: bool,
+}
+
+#[cfg(any(feature = "compression", feature = "compression-dynamic"))]
+impl Decoder {
+    /// Decoder for a Content-Encoding value; None for identity
+    pub fn new(encoding: &str) -> HttpResult<Option<Self>> {
+        let coding = match encoding.trim().to_ascii_lowercase().as_str() {
+            "gzip" | "x-gzip" => Coding::Gzip,
+            "deflate" => Coding::Deflate,
+            "identity" | "" => return Ok(None),
+            other => {
+                return Err(HttpError::DecompressionError(format!(
+                    "Unsupported encoding: {}",
+                    other
+                )));
+            }
+        };
+
+        Ok(Some(Self {
+            strm: Box::new(unsafe { std::mem::zeroed() }),
+            coding,
+            started: false,
+            pending: Vec::new(),
+            out: vec![0u8; INFLATE_CHUNK].into_boxed_slice(),
+            finished: false,
+        }))
+    }
+
+    /// Decode `input` into `output`
+    pub fn write(&mut self, input: &[u8], output: &mut Output) -> HttpResult<()> {
+        if self.finished {
+            // Anything after the end of the compressed stream is ignored
+            return Ok(());
+        }
+        if self.started {
+            return self.inflate(input, output);
+        }
+
+        let window_bits = match self.coding {
+            Coding::Gzip => 31,
+            Coding::Deflate => {
+                // "deflate" should be zlib-wrapped, but some servers send
+                // raw deflate; the zlib header check tells them apart
+                self.pending.extend_from_slice(input);
+                if self.pending.len() < 2 {
+                    return Ok(());
+                }
+                let header = u16::from(self.pending[0]) << 8 | u16::from(self.pending[1]);
+                if self.pending[0] & 0x0f == 8 && header % 31 == 0 {
+                    15
+                } else {
+                    -15
+                }
+            }
+        };
+
+        #[allow(unused_unsafe)]
+        let ret = unsafe {
+            inflateInit2_(
+                &mut *self.strm,
+                window_bits,
+                zlibVersion(),
+                std::mem::size_of::<z_stream>() as i32,
+            )
+        };
+        if ret != Z_OK {
+            return Err(HttpError::DecompressionError(format!(
+                "inflateInit2 failed ({})",
+                ret
+            )));
+        }
+        self.started = true;
+
+        if self.pending.is_empty() {
+            self.inflate(input, output)
+        } else {
+            let pending = std::mem::take(&mut self.pending);
+            self.inflate(&pending, output)
+        }
+    }
+
+    fn inflate(&mut self, input: &[u8], output: &mut Output) -> HttpResult<()> {
+        self.strm.next_in = input.as_ptr();
+        self.strm.avail_in = input.len() as u32;
+
+        loop {
+            let avail_in = self.strm.avail_in;
+            self.strm.next_out = self.out.as_mut_ptr();
+            self.strm.avail_out = self.out.len() as u32;
+
+            #[allow(unused_unsafe)]
+            let ret = unsafe { inflate(&mut *self.strm, Z_NO_FLUSH) };
+            let produced = self.out.len() - self.strm.avail_out as usize;
+            if produced > 0 {
+                output.write(&self.out[..produced])?;
+            }
+
+            match ret {
+                Z_STREAM_END => {
+                    self.finished = true;
+                    return Ok(());
+                }
+                Z_OK | Z_BUF_ERROR => {
+                    // Done once the input is used up and the output drained
+                    let drained = self.strm.avail_in == 0 && produced < self.out.len();
+                    let stuck = produced == 0 && self.strm.avail_in == avail_in;
+                    if drained || stuck {
+                        return Ok(());
+                    }
+                }
+                _ => {
+                    return Err(HttpError::DecompressionError(format!(
+                        "inflate failed ({})",
+                        ret
+                    )));
+                }
+            }
+        }
+    }
+
+    /// Check that the compressed stream was complete
+    pub fn finish(&mut self) -> HttpResult<()> {
+        if self.finished {
+            Ok(())
+        } else {
+            Err(HttpError::DecompressionError(
+                "Compressed body ended early".to_string(),
+            ))
+        }
+    }
+}
+
+#[cfg(any(feature = "compression", feature = "compression-dynamic"))]
+impl Drop for Decoder {
+    fn drop(&mut self) {
+        if self.started {
+            #[allow(unused_unsafe)]
+            unsafe {
+                inflateEnd(&mut *self.strm);
+            }
+        }
+    }
+}
+
+/// Decoder stand-in when compression support is not compiled in
+#[cfg(not(any(feature = "compression", feature = "compression-dynamic")))]
+pub struct Decoder;
+
+#[cfg(not(any(feature = "compression", feature = "compression-dynamic")))]
+impl Decoder {
+    pub fn new(encoding: &str) -> HttpResult<Option<Self>> {
+        match encoding.trim() {
+            "" => Ok(None),
+            e if e.eq_ignore_ascii_case("identity") => Ok(None),
+            _ => Err(HttpError::NotSupported(
+                "Compression support not compiled in (enable 'compression' or 'compression-dynamic' feature)"
+                    .to_string(),
+            )),
+        }
+    }
+
+    pub fn write(&mut self, _input: &[u8], _output: &mut Output) -> HttpResult<()> {
+        Ok(())
+    }
+
+    pub fn finish(&mut self) -> HttpResult<()> {
+        Ok(())
+    }
+}
@@ -0,0 +1,570 @@
+/// Parallel transfers
+///
+/// Used for several URLs, `--parallel N`, file output and `--stats`:
+/// - Up to N transfers run at once. HTTP/1.1 workers share a keep-alive
+///   `ConnectionPool`; with `--http2` the URLs of one origin become
+///   concurrent streams of a single connection.
+/// - A file written to disk is split into N byte ranges when the server
+///   accepts ranges, and each range is written at its own offset.
+/// - Bodies stream to their output through large buffered writes and, with
+///   `--compressed`, a streaming decoder. Output for stdout is collected
+///   and printed in command-line order once all transfers are done.
+use std::collections::VecDeque;
+use std::fs::File;
+use std::io::Write;
+use std::sync::{Arc, Mutex};
+use std::thread;
+use std::time::{Duration, Instant};
+
+use crate::args::{Args, HttpMethod, HttpVersion};
+use crate::http::pool::ConnectionPool;
+use crate::http::request::Http1RequestBuilder;
+use crate::http::{self, HttpError, HttpResponse, HttpResult, ResponseSink};
+use crate::output::{Decoder, Output, RangeWriter};
+use crate::url::{parse_url, ParsedUrl};
+
+/// Smallest file that is split into ranges
+const MIN_SPLIT_SIZE: u64 = 1024 * 1024;
+
+/// Smallest range a file is split into
+const MIN_RANGE_SIZE: u64 = 256 * 1024;
+
+/// One URL from the command line
+struct Transfer {
+    url_str: String,
+    url: ParsedUrl,
+    /// Output file; stdout when None
+    file: Option<Arc<File>>,
+}
+
+/// Unit of work: a whole transfer or one range of it
+#[derive(Clone, Copy)]
+struct Job {
+    transfer: usize,
+    /// First and last byte, inclusive
+    range: Option<(u64, u64)>,
+}
+
+/// What one job did
+#[derive(Default)]
+struct JobReport {
+    status: u16,
+    version: String,
+    /// Body bytes received, before content decoding
+    received: u64,
+    /// Time until the response head arrived
+    ttfb: Duration,
+    elapsed: Duration,
+    error: Option<String>,
+    /// Body for stdout
+    stdout: Vec<u8>,
+}
+
+/// Streams one job's response into its output
+struct JobSink<'a> {
+    args: &'a Args,
+    job: Job,
+    started: Instant,
+    output: Output,
+    decoder: Option<Decoder>,
+    report: JobReport,
+}
+
+impl JobSink<'_> {
+    /// Flush the output and fill in the report
+    fn finish(mut self, result: HttpResult<()>) -> JobReport {
+        let result = result
+            .and_then(|_| match self.decoder.as_mut() {
+                Some(decoder) => decoder.finish(),
+                None => Ok(()),
+            })
+            .and_then(|_| self.output.flush());
+
+        self.report.elapsed = self.started.elapsed();
+        if let Err(e) = result {
+            self.report.error = Some(e.to_string());
+        }
+        if let Output::Memory(buf) = self.output {
+            self.report.stdout = buf;
+        }
+        self.report
+    }
+}
+
+impl ResponseSink for JobSink<'_> {
+    fn head(&mut self, head: &HttpResponse) -> HttpResult<()> {
+        self.report.ttfb = self.started.elapsed();
+        self.report.status = head.status_code;
+        self.report.version = head.version.clone();
+
+        if self.job.range.is_some() {
+            if head.status_code != 206 {
+                return Err(HttpError::ProtocolError(format!(
+                    "Range request answered with {}",
+                    head.status_code
+                )));
+            }
+        } else if self.args.include_headers {
+            let mut text = format!("{}\n", head.status_line());
+            for (key, value) in &head.headers {
+                text.push_str(&format!("{}: {}\n", key, value));
+            }
+            text.push('\n');
+            self.output.write(text.as_bytes())?;
+        }
+
+        if self.args.compressed {
+            if let Some(encoding) = head.get_header("content-encoding") {
+                if self.args.verbose {
+                    eprintln!("* Decompressing response (Content-Encoding: {})", encoding);
+                }
+                self.decoder = Decoder::new(encoding)?;
+            }
+        }
+        Ok(())
+    }
+
+    fn data(&mut self, data: &[u8]) -> HttpResult<()> {
+        self.report.received += data.len() as u64;
+        match self.decoder.as_mut() {
+            Some(decoder) => decoder.write(data, &mut self.output),
+            None => self.output.write(data),
+        }
+    }
+}
+
+/// What a HEAD probe says about fetching a file in ranges
+#[derive(Default)]
+struct Probe {
+    status: u16,
+    length: Option<u64>,
+    accepts_ranges: bool,
+}
+
+impl ResponseSink for Probe {
+    fn head(&mut self, head: &HttpResponse) -> HttpResult<()> {
+        self.status = head.status_code;
+        self.length = head
+            .get_header("content-length")
+            .and_then(|v| v.trim().parse().ok());
+        self.accepts_ranges = head
+            .get_header("accept-ranges")
+            .map_or(false, |v| v.eq_ignore_ascii_case("bytes"));
+        Ok(())
+    }
+
+    fn data(&mut self, _data: &[u8]) -> HttpResult<()> {
+        Ok(())
+    }
+}
+
+/// All transfers of one run and their results
+struct Batch<'a> {
+    args: &'a Args,
+    pool: ConnectionPool,
+    transfers: Vec<Transfer>,
+    jobs: Vec<Job>,
+    reports: Mutex<Vec<Option<JobReport>>>,
+}
+
+impl Batch<'_> {
+    fn sink(&self, job: Job, started: Instant) -> JobSink<'_> {
+        let output = match &self.transfers[job.transfer].file {
+            Some(file) => Output::File(RangeWriter::new(
+                file.clone(),
+                job.range.map_or(0, |(first, _)| first),
+            )),
+            None => Output::Memory(Vec::new()),
+        };
+        JobSink {
+            args: self.args,
+            job,
+            started,
+            output,
+            decoder: None,
+            report: JobReport::default(),
+        }
+    }
+
+    fn store(&self, index: usize, report: JobReport) {
+        if let Some(e) = &report.error {
+            if self.args.verbose {
+                let transfer = &self.transfers[self.jobs[index].transfer];
+                eprintln!("* {} failed: {}", transfer.url_str, e);
+            }
+        }
+        let mut reports = self.reports.lock().unwrap_or_else(|e| e.into_inner());
+        reports[index] = Some(report);
+    }
+
+    /// Run a job over the HTTP/1.1 connection pool
+    fn run_http1(&self, index: usize) -> JobReport {
+        let job = self.jobs[index];
+        let url = &self.transfers[job.transfer].url;
+
+        let mut builder = Http1RequestBuilder::from_args(self.args, url).keep_alive(true);
+        if let Some((first, last)) = job.range {
+            builder = builder.header("Range", &format!("bytes={}-{}", first, last));
+        }
+        let request = builder.build();
+
+        let mut sink = self.sink(job, Instant::now());
+        let head_only = self.args.method == HttpMethod::Head;
+        let result = self.pool.request(url, &request, head_only, &mut sink);
+        sink.finish(result)
+    }
+
+    /// Run a job through `perform_request`, which returns whole responses
+    /// (HTTP/3, and HTTP/2 when only the static library is available)
+    fn run_buffered(&self, index: usize) -> JobReport {
+        let job = self.jobs[index];
+        let url = &self.transfers[job.transfer].url;
+
+        let mut args = self.args.clone();
+        if let Some((first, last)) = job.range {
+            args.headers
+                .push(("Range".to_string(), format!("bytes={}-{}", first, last)));
+        }
+
+        let mut sink = self.sink(job, Instant::now());
+        // perform_request has already removed the content coding
+        let result = http::perform_request(&args, url)
+            .and_then(|response| http::deliver(response, &mut sink));
+        sink.finish(result)
+    }
+
+    /// Run the given jobs on up to `--parallel` worker threads
+    fn run_workers(&self, queue: VecDeque<usize>, run: fn(&Self, usize) -> JobReport) {
+        let workers = self.args.parallel.min(queue.len());
+        let queue = Mutex::new(queue);
+
+        thread::scope(|s| {
+            for _ in 0..workers {
+                s.spawn(|| loop {
+                    let next = queue.lock().unwrap_or_else(|e| e.into_inner()).pop_front();
+                    let Some(index) = next else {
+                        break;
+                    };
+                    self.store(index, run(self, index));
+                });
+            }
+        });
+    }
+
+    /// Run every origin's jobs as streams of one HTTP/2 connection;
+    /// returns the jobs that have to be retried over HTTP/1.1
+    #[cfg(feature = "http2-dynamic")]
+    fn run_http2(&self) -> VecDeque<usize> {
+        use crate::http::http2_dynamic::{Http2Client, Http2Request};
+
+        // Group jobs by origin, keeping their order
+        let mut origins: Vec<(String, Vec<usize>)> = Vec::new();
+        for (index, job) in self.jobs.iter().enumerate() {
+            let url = &self.transfers[job.transfer].url;
+            let origin = format!("{}://{}", url.scheme(), url.addr());
+            match origins.iter_mut().find(|(o, _)| *o == origin) {
+                Some((_, jobs)) => jobs.push(index),
+                None => origins.push((origin, vec![index])),
+            }
+        }
+
+        let retry = Mutex::new(VecDeque::new());
+        thread::scope(|s| {
+            for (_, jobs) in &origins {
+                let retry = &retry;
+                s.spawn(move || {
+                    let mut failed = Vec::new();
+                    match Http2Client::new(self.args.verbose, self.args.insecure) {
+                        Ok(mut client) => {
+                            let requests: Vec<Http2Request<'_>> = jobs
+                                .iter()
+                                .map(|&index| {
+                                    let job = self.jobs[index];
+                                    Http2Request {
+                                        url: &self.transfers[job.transfer].url,
+                                        extra_headers: job
+                                            .range
+                                            .map(|(first, last)| {
+                                                (
+                                                    "Range".to_string(),
+                                                    format!("bytes={}-{}", first, last),
+                                                )
+                                            })
+                                            .into_iter()
+                                            .collect(),
+                                    }
+                                })
+                                .collect();
+
+                            client.request_many(
+                                self.args,
+                                &requests,
+                                self.args.parallel,
+                                &mut |i, submitted, result| match result {
+                                    Ok(response) => {
+                                        let index = jobs[i];
+                                        let mut sink = self.sink(self.jobs[index], submitted);
+                                        let result = http::deliver(response, &mut sink);
+                                        self.store(index, sink.finish(result));
+                                    }
+                                    Err(_) => failed.push(jobs[i]),
+                                },
+                            );
+                        }
+                        Err(_) => failed.extend_from_slice(jobs),
+                    }
+
+                    if !failed.is_empty() && self.args.verbose {
+                        eprintln!(
+                            "* HTTP/2 failed for {} request(s), falling back to HTTP/1.1",
+                            failed.len()
+                        );
+                    }
+                    retry
+                        .lock()
+                        .unwrap_or_else(|e| e.into_inner())
+                        .extend(failed);
+                });
+            }
+        });
+        retry.into_inner().unwrap_or_else(|e| e.into_inner())
+    }
+
+    /// Run all jobs with the requested protocol
+    fn execute(&self) {
+        let all: VecDeque<usize> = (0..self.jobs.len()).collect();
+        match self.args.http_version {
+            HttpVersion::Http1 => self.run_workers(all, Self::run_http1),
+            HttpVersion::Http2 => {
+                #[cfg(feature = "http2-dynamic")]
+                {
+                    let retry = self.run_http2();
+                    self.run_workers(retry, Self::run_http1);
+                }
+                #[cfg(not(feature = "http2-dynamic"))]
+                self.run_workers(all, Self::run_buffered);
+            }
+            HttpVersion::Http3 => self.run_workers(all, Self::run_buffered),
+        }
+    }
+
+    /// Byte ranges to fetch `transfer` in, if it is worth splitting
+    fn plan_ranges(&self, transfer: &Transfer) -> Option<Vec<(u64, u64)>> {
+        let file = transfer.file.as_ref()?;
+        let args = self.args;
+        if args.parallel < 2
+            || args.method != HttpMethod::Get
+            || args.data.is_some()
+            || args.compressed
+            || args.include_headers
+        {
+            return None;
+        }
+
+        let request = Http1RequestBuilder::from_args(args, &transfer.url)
+            .method(HttpMethod::Head)
+            .keep_alive(true)
+            .build();
+        let mut probe = Probe::default();
+        if let Err(e) = self.pool.request(&transfer.url, &request, true, &mut probe) {
+            if args.verbose {
+                eprintln!("* Range probe for {} failed: {}", transfer.url_str, e);
+            }
+            return None;
+        }
+
+        let len = probe.length?;
+        if probe.status != 200 || !probe.accepts_ranges || len < MIN_SPLIT_SIZE {
+            return None;
+        }
+        let count = (args.parallel as u64).min(len / MIN_RANGE_SIZE);
+        if count < 2 {
+            return None;
+        }
+
+        // Full size up front, so ranges can land in any order
+        file.set_len(len).ok()?;
+
+        let step = (len + count - 1) / count;
+        let ranges: Vec<(u64, u64)> = (0..count)
+            .map(|i| i * step)
+            .take_while(|&first| first < len)
+            .map(|first| (first, (first + step).min(len) - 1))
+            .collect();
+
+        if args.verbose {
+            eprintln!(
+                "* Fetching {} ({} bytes) in {} ranges",
+                transfer.url_str,
+                len,
+                ranges.len()
+            );
+        }
+        Some(ranges)
+    }
+
+    /// Print transfer statistics to stderr
+    fn print_stats(&self, reports: &[JobReport], wall: Duration) {
+        let mut total = 0u64;
+        for (t, transfer) in self.transfers.iter().enumerate() {
+            let mine: Vec<&JobReport> = self
+                .jobs
+                .iter()
+                .zip(reports)
+                .filter(|(job, _)| job.transfer == t)
+                .map(|(_, report)| report)
+                .collect();
+
+            if let Some(e) = mine.iter().find_map(|r| r.error.as_ref()) {
+                eprintln!("* [{}] {}: failed: {}", t + 1, transfer.url_str, e);
+                continue;
+            }
+
+            let received: u64 = mine.iter().map(|r| r.received).sum();
+            let elapsed = mine.iter().map(|r| r.elapsed).max().unwrap_or_default();
+            let ttfb = mine.iter().map(|r| r.ttfb).min().unwrap_or_default();
+            let ranges = if mine.len() > 1 {
+                format!(" in {} ranges", mine.len())
+            } else {
+                String::new()
+            };
+            total += received;
+
+            eprintln!(
+                "* [{}] {}: {} {}, {} bytes{} in {}, first byte after {}, {}",
+                t + 1,
+                transfer.url_str,
+                mine[0].version,
+                mine[0].status,
+                received,
+                ranges,
+                format_duration(elapsed),
+                format_duration(ttfb),
+                format_rate(received, elapsed)
+            );
+        }
+
+        let (opened, reused) = self.pool.counts();
+        eprintln!(
+            "* {} transfer(s), {} bytes in {}, {}; HTTP/1.1 connections: {} opened, {} reused",
+            self.transfers.len(),
+            total,
+            format_duration(wall),
+            format_rate(total, wall),
+            opened,
+            reused
+        );
+    }
+}
+
+fn format_duration(d: Duration) -> String {
+    format!("{:.1} ms", d.as_secs_f64() * 1000.0)
+}
+
+fn format_rate(bytes: u64, d: Duration) -> String {
+    let secs = d.as_secs_f64();
+    if secs <= 0.0 {
+        return "-".to_string();
+    }
+    let rate = bytes as f64 / secs;
+    if rate >= 1024.0 * 1024.0 {
+        format!("{:.2} MiB/s", rate / (1024.0 * 1024.0))
+    } else {
+        format!("{:.1} KiB/s", rate / 1024.0)
+    }
+}
+
+/// Run every URL in `args`; returns the process exit code
+pub fn run(args: &Args) -> i32 {
+    let mut transfers = Vec::new();
+    for (i, url_str) in args.urls.iter().enumerate() {
+        let url = match parse_url(url_str) {
+            Ok(u) => u,
+            Err(err) => {
+                eprintln!("Error parsing URL '{}': {}", url_str, err);
+                return 1;
+            }
+        };
+        let file = match args.output_for(i) {
+            Some(path) => match File::create(path) {
+                Ok(f) => Some(Arc::new(f)),
+                Err(e) => {
+                    eprintln!("Error creating output file '{}': {}", path, e);
+                    return 1;
+                }
+            },
+            None => None,
+        };
+        transfers.push(Transfer {
+            url_str: url_str.clone(),
+            url,
+            file,
+        });
+    }
+
+    let mut batch = Batch {
+        args,
+        pool: ConnectionPool::new(args.verbose, args.insecure),
+        transfers: Vec::new(),
+        jobs: Vec::new(),
+        reports: Mutex::new(Vec::new()),
+    };
+
+    let started = Instant::now();
+    for (t, transfer) in transfers.iter().enumerate() {
+        match batch.plan_ranges(transfer) {
+            Some(ranges) => batch.jobs.extend(ranges.into_iter().map(|range| Job {
+                transfer: t,
+                range: Some(range),
+            })),
+            None => batch.jobs.push(Job {
+                transfer: t,
+                range: None,
+            }),
+        }
+    }
+    batch.transfers = transfers;
+    batch.reports = Mutex::new((0..batch.jobs.len()).map(|_| None).collect());
+
+    batch.execute();
+    let wall = started.elapsed();
+
+    let reports: Vec<JobReport> =
+        std::mem::take(&mut *batch.reports.lock().unwrap_or_else(|e| e.into_inner()))
+            .into_iter()
+            .map(|r| {
+                r.unwrap_or_else(|| JobReport {
+                    error: Some("Not run".to_string()),
+                    ..JobReport::default()
+                })
+            })
+            .collect();
+
+    // stdout output in command-line order
+    let stdout = std::io::stdout();
+    let mut out = stdout.lock();
+    let mut failed = false;
+    for (job, report) in batch.jobs.iter().zip(&reports) {
+        if let Some(e) = &report.error {
+            eprintln!("Error: {}: {}", batch.transfers[job.transfer].url_str, e);
+            failed = true;
+        }
+        if !report.stdout.is_empty() {
+            if let Err(e) = out.write_all(&report.stdout) {
+                eprintln!("Error writing output: {}", e);
+                return 1;
+            }
+        }
+    }
+    let _ = out.flush();
+
+    if args.stats || args.verbose {
+        batch.print_stats(&reports, wall);
+    }
+
+    if failed {
+        1
+    } else {
+        0
+    }
+}
@@ -0,0 +1,421 @@
+//! ncryptolib throughput benchmark, in the style of `openssl speed`
+//!
+//! Each algorithm is run over buffers of 16 bytes up to 16 KiB (a full TLS
+//! record) for a fixed time per size, through the same Rust API that nssl
+//! and ntcp2 use. Results are in thousands of bytes per second, like
+//! OpenSSL's table, so the two can be compared directly. Public-key
+//! operations (the per-handshake cost) are reported as operations per
+//! second.
+//!
+//! Usage: crypto_bench [-seconds N] [algorithm...]
+//! Default: 1 second per size, every algorithm.
+//!
+//! Set NCRYPTO_NO_HW_ACCEL=1 to measure the portable implementations on a
+//! machine that has the accelerated ones.
+
+use std::env;
+use std::hint::black_box;
+use std::process;
+use std::time::{Duration, Instant};
+
+use ncryptolib::aes::{AesCbc, AesCtr, AesGcm};
+use ncryptolib::chacha20::{ChaCha20, ChaCha20Poly1305};
+use ncryptolib::cpu;
+use ncryptolib::ed25519::{verify_batch, Ed25519KeyPair, Ed25519PublicKey};
+use ncryptolib::random::random_bytes;
+use ncryptolib::x25519::{x25519, x25519_base};
+use ncryptolib::{sha1, sha256, sha512};
+use ncryptolib::{P256KeyPair, P256Signature};
+
+const SIZES: [usize; 6] = [16, 64, 256, 1024, 8192, 16384];
+
+/// A benchmarked operation over one buffer
+type Op = Box<dyn FnMut(&[u8])>;
+
+struct Algorithm {
+    name: &'static str,
+    /// Set up keys and return the operation
+    setup: fn() -> Op,
+}
+
+const ALGORITHMS: &[Algorithm] = &[
+    Algorithm {
+        name: "aes-128-gcm",
+        setup: || {
+            let gcm = AesGcm::new_128(&[0x42; 16]);
+            Box::new(move |buf| {
+                black_box(gcm.encrypt(&[7; 12], black_box(buf), &[]));
+            })
+        },
+    },
+    Algorithm {
+        name: "aes-256-gcm",
+        setup: || {
+            let gcm = AesGcm::new_256(&[0x42; 32]);
+            Box::new(move |buf| {
+                black_box(gcm.encrypt(&[7; 12], black_box(buf), &[]));
+            })
+        },
+    },
+    Algorithm {
+        name: "aes-128-ctr",
+        setup: || {
+            let ctr = AesCtr::new_128(&[0x42; 16]);
+            Box::new(move |buf| {
+                black_box(ctr.process(&[7; 16], black_box(buf)));
+            })
+        },
+    },
+    Algorithm {
+        name: "aes-256-ctr",
+        setup: || {
+            let ctr = AesCtr::new_256(&[0x42; 32]);
+            Box::new(move |buf| {
+                black_box(ctr.process(&[7; 16], black_box(buf)));
+            })
+        },
+    },
+    Algorithm {
+        name: "aes-128-cbc",
+        setup: || {
+            let cbc = AesCbc::new_128(&[0x42; 16]);
+            Box::new(move |buf| {
+                black_box(cbc.encrypt(&[7; 16], black_box(buf)));
+            })
+        },
+    },
+    Algorithm {
+        name: "aes-256-cbc",
+        setup: || {
+            let cbc = AesCbc::new_256(&[0x42; 32]);
+            Box::new(move |buf| {
+                black_box(cbc.encrypt(&[7; 16], black_box(buf)));
+            })
+        },
+    },
+    Algorithm {
+        name: "chacha20",
+        setup: || {
+            Box::new(|buf| {
+                black_box(ChaCha20::new(&[0x42; 32], &[7; 12]).encrypt(black_box(buf)));
+            })
+        },
+    },
+    Algorithm {
+        name: "chacha20-poly1305",
+        setup: || {
+            let aead = ChaCha20Poly1305::new(&[0x42; 32]);
+            Box::new(move |buf| {
+                black_box(aead.encrypt(&[7; 12], &[], black_box(buf)));
+            })
+        },
+    },
+    Algorithm {
+        name: "sha1",
+        setup: || {
+            Box::new(|buf| {
+                black_box(sha1(black_box(buf)));
+            })
+        },
+    },
+    Algorithm {
+        name: "sha256",
+        setup: || {
+            Box::new(|buf| {
+                black_box(sha256(black_box(buf)));
+            })
+        },
+    },
+    Algorithm {
+        name: "sha512",
+        setup: || {
+            Box::new(|buf| {
+                black_box(sha512(black_box(buf)));
+            })
+        },
+    },
+];
+
+/// A benchmarked public-key operation
+type KeyOp = Box<dyn FnMut()>;
+
+struct KeyAlgorithm {
+    name: &'static str,
+    /// Operations one call performs, so batches are reported per item
+    batch: u32,
+    /// Set up keys and return the operation
+    setup: fn() -> KeyOp,
+}
+
+/// Signatures checked per call of ed25519-verify-batch
+const VERIFY_BATCH: usize = 64;
+
+fn x25519_keygen() -> ([u8; 32], [u8; 32]) {
+    let mut private = [0u8; 32];
+    random_bytes(&mut private).unwrap();
+    (private, x25519_base(&private))
+}
+
+const KEY_ALGORITHMS: &[KeyAlgorithm] = &[
+    KeyAlgorithm {
+        name: "p256-keygen",
+        batch: 1,
+        setup: || {
+            Box::new(|| {
+                black_box(P256KeyPair::generate());
+            })
+        },
+    },
+    KeyAlgorithm {
+        name: "p256-ecdh",
+        batch: 1,
+        setup: || {
+            let ours = P256KeyPair::generate().unwrap();
+            let peer = P256KeyPair::generate().unwrap().public_key;
+            Box::new(move || {
+                black_box(ours.ecdh(black_box(&peer)));
+            })
+        },
+    },
+    KeyAlgorithm {
+        name: "p256-sign",
+        batch: 1,
+        setup: || {
+            let key = P256KeyPair::generate().unwrap();
+            Box::new(move || {
+                black_box(P256Signature::sign(&key.private_key, black_box(&[7; 32])));
+            })
+        },
+    },
+    KeyAlgorithm {
+        name: "p256-verify",
+        batch: 1,
+        setup: || {
+            let key = P256KeyPair::generate().unwrap();
+            let sig = P256Signature::sign(&key.private_key, &[7; 32]).unwrap();
+            Box::new(move || {
+                assert!(sig.verify(&key.public_key, black_box(&[7; 32])));
+            })
+        },
+    },
+    KeyAlgorithm {
+        // An ephemeral key share plus the shared secret: one side of a
+        // TLS 1.3 key exchange
+        name: "p256-kex",
+        batch: 1,
+        setup: || {
+            let peer = P256KeyPair::generate().unwrap().public_key;
+            Box::new(move || {
+                let ours = P256KeyPair::generate().unwrap();
+                black_box(ours.ecdh(black_box(&peer)));
+            })
+        },
+    },
+    KeyAlgorithm {
+        name: "x25519-keygen",
+        batch: 1,
+        setup: || {
+            Box::new(|| {
+                black_box(x25519_keygen());
+            })
+        },
+    },
+    KeyAlgorithm {
+        name: "x25519-dh",
+        batch: 1,
+        setup: || {
+            let (ours, _) = x25519_keygen();
+            let (_, peer) = x25519_keygen();
+            Box::new(move || {
+                black_box(x25519(&ours, black_box(&peer)));
+            })
+        },
+    },
+    KeyAlgorithm {
+        name: "x25519-kex",
+        batch: 1,
+        setup: || {
+            let (_, peer) = x25519_keygen();
+            Box::new(move || {
+                let (ours, _) = x25519_keygen();
+                black_box(x25519(&ours, black_box(&peer)));
+            })
+        },
+    },
+    KeyAlgorithm {
+        name: "ed25519-sign",
+        batch: 1,
+        setup: || {
+            let key = Ed25519KeyPair::from_seed(&[7; 32]);
+            Box::new(move || {
+                black_box(key.sign(black_box(&[7; 32])));
+            })
+        },
+    },
+    KeyAlgorithm {
+        name: "ed25519-verify",
+        batch: 1,
+        setup: || {
+            let key = Ed25519KeyPair::from_seed(&[7; 32]);
+            let sig = key.sign(&[7; 32]);
+            let public = Ed25519PublicKey::from_bytes(key.public_key());
+            Box::new(move || {
+                assert!(public.verify(black_box(&[7; 32]), &sig));
+            })
+        },
+    },
+    KeyAlgorithm {
+        name: "ed25519-verify-batch",
+        batch: VERIFY_BATCH as u32,
+        setup: || {
+            let keys: Vec<Ed25519KeyPair> = (0..VERIFY_BATCH)
+                .map(|i| Ed25519KeyPair::from_seed(&[i as u8; 32]))
+                .collect();
+            let sigs: Vec<[u8; 64]> = keys.iter().map(|k| k.sign(&[7; 32])).collect();
+            let publics: Vec<Ed25519PublicKey> = keys
+                .iter()
+                .map(|k| Ed25519PublicKey::from_bytes(k.public_key()))
+                .collect();
+            Box::new(move || {
+                let messages = [black_box(&[7u8; 32][..]); VERIFY_BATCH];
+                assert!(verify_batch(&messages, &sigs, &publics));
+            })
+        },
+    },
+];
+
+/// Run `op` on `buf` for about `duration`; returns thousands of bytes/s
+fn measure(op: &mut Op, buf: &[u8], duration: Duration) -> f64 {
+    // Warm caches and branch predictors
+    for _ in 0..16 {
+        op(buf);
+    }
+    let start = Instant::now();
+    let mut count = 0u64;
+    // Check the clock every few calls so small sizes are not dominated
+    // by it
+    let batch = (65536 / buf.len()).max(1) as u64;
+    while start.elapsed() < duration {
+        for _ in 0..batch {
+            op(buf);
+        }
+        count += batch;
+    }
+    let secs = start.elapsed().as_secs_f64().max(1e-9);
+    (count * buf.len() as u64) as f64 / secs / 1000.0
+}
+
+/// Run `op` for about `duration`; returns operations per second
+fn measure_ops(op: &mut KeyOp, duration: Duration) -> f64 {
+    op();
+    let start = Instant::now();
+    let mut count = 0u64;
+    while start.elapsed() < duration {
+        op();
+        count += 1;
+    }
+    count as f64 / start.elapsed().as_secs_f64().max(1e-9)
+}
+
+fn usage() -> ! {
+    eprintln!("usage: crypto_bench [-seconds N] [algorithm...]");
+    eprint!("algorithms:");
+    for alg in ALGORITHMS {
+        eprint!(" {}", alg.name);
+    }
+    for alg in KEY_ALGORITHMS {
+        eprint!(" {}", alg.name);
+    }
+    eprintln!();
+    process::exit(2);
+}
+
+fn main() {
+    let mut seconds = 1.0f64;
+    let mut selected: Vec<&Algorithm> = Vec::new();
+    let mut selected_keys: Vec<&KeyAlgorithm> = Vec::new();
+
+    let mut args = env::args().skip(1);
+    while let Some(arg) = args.next() {
+        match arg.as_str() {
+            "-seconds" => match args.next().and_then(|s| s.parse::<f64>().ok()) {
+                Some(s) if s > 0.0 => seconds = s,
+                _ => usage(),
+            },
+            "-h" | "--help" => usage(),
+            name => {
+                if let Some(alg) = ALGORITHMS.iter().find(|a| a.name == name) {
+                    selected.push(alg);
+                } else if let Some(alg) = KEY_ALGORITHMS.iter().find(|a| a.name == name) {
+                    selected_keys.push(alg);
+                } else {
+                    eprintln!("crypto_bench: unknown algorithm '{}'", name);
+                    usage();
+                }
+            }
+        }
+    }
+    if selected.is_empty() && selected_keys.is_empty() {
+        selected = ALGORITHMS.iter().collect();
+        selected_keys = KEY_ALGORITHMS.iter().collect();
+    }
+
+    let duration = Duration::from_secs_f64(seconds);
+    let buf: Vec<u8> = (0..SIZES[SIZES.len() - 1])
+        .map(|i| (i % 251) as u8)
+        .collect();
+
+    println!(
+        "AES: {}",
+        if cpu::has_aes_ni() {
+            "AES-NI, PCLMULQDQ"
+        } else {
+            "bitsliced (constant-time)"
+        }
+    );
+    println!(
+        "ChaCha20: {}",
+        if cpu::has_avx2() {
+            "AVX2, 8 blocks"
+        } else if cfg!(target_arch = "x86_64") {
+            "SSE2, 4 blocks"
+        } else {
+            "scalar"
+        }
+    );
+    println!(
+        "SHA: {}",
+        match (cpu::has_sha_ni(), cpu::has_avx2()) {
+            (true, true) => "SHA-NI, AVX2 SHA-512",
+            (true, false) => "SHA-NI",
+            (false, true) => "AVX2 SHA-512",
+            (false, false) => "portable",
+        }
+    );
+
+    if !selected.is_empty() {
+        println!("The 'numbers' are in 1000s of bytes per second processed.");
+        print!("{:<18}", "type");
+        for size in SIZES {
+            print!(" {:>12}", format!("{} bytes", size));
+        }
+        println!();
+    }
+    for alg in selected {
+        let mut op = (alg.setup)();
+        print!("{:<18}", alg.name);
+        for size in SIZES {
+            print!(" {:>11.2}k", measure(&mut op, &buf[..size], duration));
+        }
+        println!();
+    }
+
+    if !selected_keys.is_empty() {
+        println!("{:<22} {:>12} {:>12}", "", "time/op", "ops/s");
+    }
+    for alg in selected_keys {
+        let mut op = (alg.setup)();
+        let rate = measure_ops(&mut op, duration) * alg.batch as f64;
+        println!("{:<22} {:>10.1}us {:>12.1}", alg.name, 1e6 / rate, rate);
+    }
+}
@@ -0,0 +1,100 @@
+//! execve() latency benchmark
+//!
+//! Repeatedly spawns a program (fork + execve + wait) and reports the
+//! round-trip latency. The first iterations populate the kernel's executable
+//! image and interpreter caches; the remaining ones measure the warm path.
+//!
+//! Usage: exec_bench [iterations] [program] [args...]
+//! Defaults: 200 iterations of `/bin/echo`.
+
+use std::env;
+use std::process::{self, Command, Stdio};
+use std::time::{Duration, Instant};
+
+const DEFAULT_ITERATIONS: usize = 200;
+const DEFAULT_PROGRAM: &str = "/bin/echo";
+const WARMUP_ITERATIONS: usize = 3;
+
+fn spawn_once(program: &str, args: &[String]) -> Result<Duration, String> {
+    let start = Instant::now();
+    let status = Command::new(program)
+        .args(args)
+        .stdin(Stdio::null())
+        .stdout(Stdio::null())
+        .stderr(Stdio::null())
+        .status()
+        .map_err(|e| format!("failed to spawn {}: {}", program, e))?;
+    let elapsed = start.elapsed();
+
+    if !status.success() {
+        return Err(format!("{} exited with {}", program, status));
+    }
+    Ok(elapsed)
+}
+
+fn micros(d: Duration) -> f64 {
+    d.as_secs_f64() * 1_000_000.0
+}
+
+fn main() {
+    let args: Vec<String> = env::args().collect();
+    let iterations = match args.get(1) {
+        Some(n) => match n.parse::<usize>() {
+            Ok(n) if n > 0 => n,
+            _ => {
+                eprintln!("exec_bench: invalid iteration count '{}'", n);
+                process::exit(2);
+            }
+        },
+        None => DEFAULT_ITERATIONS,
+    };
+    let program = args.get(2).map(String::as_str).unwrap_or(DEFAULT_PROGRAM);
+    let program_args = if args.len() > 3 { &args[3..] } else { &[] };
+
+    println!("=== execve() Latency Benchmark ===");
+    println!("program: {}, iterations: {}", program, iterations);
+
+    // Cold run: first exec reads the binary and interpreter from disk
+    let cold = match spawn_once(program, program_args) {
+        Ok(d) => d,
+        Err(e) => {
+            eprintln!("exec_bench: {}", e);
+            process::exit(1);
+        }
+    };
+    for _ in 1..WARMUP_ITERATIONS {
+        if let Err(e) = spawn_once(program, program_args) {
+            eprintln!("exec_bench: {}", e);
+            process::exit(1);
+        }
+    }
+
+    let mut samples = Vec::with_capacity(iterations);
+    let total_start = Instant::now();
+    for _ in 0..iterations {
+        match spawn_once(program, program_args) {
+            Ok(d) => samples.push(d),
+            Err(e) => {
+                eprintln!("exec_bench: {}", e);
+                process::exit(1);
+            }
+        }
+    }
+    let total = total_start.elapsed();
+
+    samples.sort();
+    let sum: Duration = samples.iter().sum();
+    let avg = sum / samples.len() as u32;
+    let pct = |p: usize| samples[(samples.len() - 1) * p / 100];
+
+    println!("cold:   {:10.1} us", micros(cold));
+    println!("min:    {:10.1} us", micros(samples[0]));
+    println!("avg:    {:10.1} us", micros(avg));
+    println!("p50:    {:10.1} us", micros(pct(50)));
+    println!("p99:    {:10.1} us", micros(pct(99)));
+    println!("max:    {:10.1} us", micros(samples[samples.len() - 1]));
+    println!(
+        "rate:   {:10.1} spawns/s",
+        iterations as f64 / total.as_secs_f64()
+    );
+}
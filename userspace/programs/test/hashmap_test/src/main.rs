@@ -6,6 +6,7 @@
 use std::alloc::{alloc, dealloc, Layout};
 use std::collections::HashMap;
 use std::io::Write;
+use std::time::Instant;
 
 fn main() {
     println!("=== HashMap Free Bug Test ===");
@@ -94,5 +95,47 @@ fn main() {
     println!("  HashMap dropped OK!");
     let _ = std::io::stdout().flush();
 
+    println!("\nTest 5: Allocation throughput");
+    let _ = std::io::stdout().flush();
+
+    // Small String keys and values: every insert and remove is a malloc/free
+    // pair in the 16-64 byte classes
+    const ROUNDS: usize = 100_000;
+    let start = Instant::now();
+    let mut map: HashMap<String, String> = HashMap::new();
+    for i in 0..ROUNDS {
+        map.insert(format!("key-{}", i % 4096), format!("value-{}", i));
+        if i % 3 == 0 {
+            map.remove(&format!("key-{}", (i / 3) % 4096));
+        }
+    }
+    let secs = start.elapsed().as_secs_f64().max(1e-9);
+    println!(
+        "  {} map operations in {:.3}s ({:.0} ops/s), len = {}",
+        ROUNDS + ROUNDS / 3,
+        secs,
+        (ROUNDS + ROUNDS / 3) as f64 / secs,
+        map.len()
+    );
+    drop(map);
+
+    let start = Instant::now();
+    let mut live: Vec<Box<[u8]>> = Vec::with_capacity(1024);
+    for i in 0..ROUNDS {
+        let block = vec![i as u8; 16 << (i % 8)].into_boxed_slice();
+        if live.len() == 1024 {
+            live[i % 1024] = block;
+        } else {
+            live.push(block);
+        }
+    }
+    let secs = start.elapsed().as_secs_f64().max(1e-9);
+    println!(
+        "  {} alloc/free of 16 B-2 KiB blocks: {:.0} ops/s",
+        ROUNDS,
+        ROUNDS as f64 / secs
+    );
+    let _ = std::io::stdout().flush();
+
     println!("\n=== All tests passed! ===");
 }
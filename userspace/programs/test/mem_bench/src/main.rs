@@ -0,0 +1,116 @@
+//! mem*/str* throughput benchmark
+//!
+//! Times nrlib's memcpy, memmove, memset, memcmp, strlen and memchr across
+//! sizes from a few bytes (where call overhead and the small-size paths
+//! dominate) up to buffers larger than the last-level cache (where the
+//! non-temporal paths kick in). Each routine is called through its C symbol,
+//! so the numbers are what every Rust and C program on the system sees.
+//!
+//! Usage: mem_bench [bytes-per-measurement]
+//! Default: 64 MiB processed per routine and size.
+
+use std::env;
+use std::hint::black_box;
+use std::process;
+use std::time::Instant;
+
+extern "C" {
+    fn memcpy(dest: *mut u8, src: *const u8, n: usize) -> *mut u8;
+    fn memmove(dest: *mut u8, src: *const u8, n: usize) -> *mut u8;
+    fn memset(s: *mut u8, c: i32, n: usize) -> *mut u8;
+    fn memcmp(a: *const u8, b: *const u8, n: usize) -> i32;
+    fn strlen(s: *const u8) -> usize;
+    fn memchr(s: *const u8, c: i32, n: usize) -> *const u8;
+}
+
+const DEFAULT_VOLUME: usize = 64 * 1024 * 1024;
+const SIZES: [usize; 10] = [
+    8,
+    32,
+    128,
+    512,
+    4096,
+    16 * 1024,
+    64 * 1024,
+    256 * 1024,
+    1024 * 1024,
+    8 * 1024 * 1024,
+];
+
+/// Run `op` until about `volume` bytes are processed; returns MB/s
+fn measure(size: usize, volume: usize, mut op: impl FnMut()) -> f64 {
+    let iterations = (volume / size).max(16);
+    // Warm caches and TLB
+    for _ in 0..iterations.min(64) {
+        op();
+    }
+    let start = Instant::now();
+    for _ in 0..iterations {
+        op();
+    }
+    let secs = start.elapsed().as_secs_f64().max(1e-9);
+    (iterations * size) as f64 / secs / 1_000_000.0
+}
+
+fn main() {
+    let volume = match env::args().nth(1) {
+        Some(arg) => match arg.parse::<usize>() {
+            Ok(n) if n > 0 => n,
+            _ => {
+                eprintln!("mem_bench: invalid byte count '{}'", arg);
+                process::exit(2);
+            }
+        },
+        None => DEFAULT_VOLUME,
+    };
+
+    let max = SIZES[SIZES.len() - 1];
+    // Offset by one so the source is never aligned like the destination
+    let src: Vec<u8> = (0..max + 64).map(|i| (i % 251) as u8 + 1).collect();
+    let mut dst = vec![0u8; max + 64];
+    let mut text = src.clone();
+
+    println!("=== mem*/str* Throughput (MB/s) ===");
+    println!(
+        "{:>9} {:>9} {:>9} {:>9} {:>9} {:>9} {:>9}",
+        "size", "memcpy", "memmove", "memset", "memcmp", "strlen", "memchr"
+    );
+
+    for &size in SIZES.iter() {
+        let s = src[1..].as_ptr();
+        let d = dst.as_mut_ptr();
+
+        let copy = measure(size, volume, || unsafe {
+            black_box(memcpy(black_box(d), black_box(s), size));
+        });
+        // Overlapping move by a few bytes, as when erasing from a Vec
+        let mv = measure(size, volume, || unsafe {
+            black_box(memmove(black_box(d), black_box(d.add(3)), size));
+        });
+        let set = measure(size, volume, || unsafe {
+            black_box(memset(black_box(d), 0x5a, size));
+        });
+
+        unsafe { memcpy(d, s, size) };
+        let cmp = measure(size, volume, || unsafe {
+            black_box(memcmp(black_box(d), black_box(s), size));
+        });
+
+        text[1 + size] = 0;
+        let t = text[1..].as_ptr();
+        let len = measure(size, volume, || unsafe {
+            black_box(strlen(black_box(t)));
+        });
+        text[1 + size] = src[1 + size];
+
+        // Needle absent: scans the whole buffer
+        let chr = measure(size, volume, || unsafe {
+            black_box(memchr(black_box(s), 0, size));
+        });
+
+        println!(
+            "{:>9} {:>9.0} {:>9.0} {:>9.0} {:>9.0} {:>9.0} {:>9.0}",
+            size, copy, mv, set, cmp, len, chr
+        );
+    }
+}
@@ -5,7 +5,7 @@
 use std::arch::asm;
 use std::sync::atomic::{AtomicU32, Ordering};
 use std::thread;
-use std::time::Duration;
+use std::time::{Duration, Instant};
 
 // Syscall numbers
 const SYS_GETTID: u64 = 186;
@@ -240,6 +240,77 @@ fn test_thread_local_data() {
     println!();
 }
 
+/// Allocate and free a rolling window of mixed-size blocks; returns ops done
+fn alloc_churn(seed: u32, rounds: usize) -> usize {
+    let mut window: Vec<Vec<u8>> = Vec::with_capacity(64);
+    let mut state = seed | 1;
+    let mut ops = 0;
+    for _ in 0..rounds {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        let size = match state % 8 {
+            0 => 1024 + (state as usize >> 8) % 7168,
+            1 | 2 => 256 + (state as usize >> 8) % 768,
+            _ => 8 + (state as usize >> 8) % 120,
+        };
+        if window.len() == 64 {
+            window.swap_remove((state as usize >> 4) % 64);
+            ops += 1;
+        }
+        let mut block = Vec::with_capacity(size);
+        block.push(state as u8);
+        window.push(block);
+        ops += 1;
+    }
+    ops + window.len()
+}
+
+fn test_alloc_throughput() {
+    println!("=== Test 7: Allocation Throughput ===");
+    const ROUNDS: usize = 200_000;
+
+    let start = Instant::now();
+    let ops = alloc_churn(1, ROUNDS);
+    let single = ops as f64 / start.elapsed().as_secs_f64().max(1e-9);
+    println!("1 thread:  {:.0} malloc+free ops/s", single);
+
+    // Every thread allocates concurrently; with per-thread caches the rate
+    // should scale instead of serializing on one heap lock
+    for &threads in &[2u32, 4] {
+        let start = Instant::now();
+        let handles: Vec<_> = (0..threads)
+            .map(|i| thread::spawn(move || alloc_churn(i + 2, ROUNDS)))
+            .collect();
+        let ops: usize = handles
+            .into_iter()
+            .map(|h| h.join().expect("Thread panicked"))
+            .sum();
+        let rate = ops as f64 / start.elapsed().as_secs_f64().max(1e-9);
+        println!(
+            "{} threads: {:.0} malloc+free ops/s ({:.2}x)",
+            threads,
+            rate,
+            rate / single
+        );
+    }
+
+    // Blocks freed on another thread go back through the central lists
+    let blocks: Vec<Vec<u8>> = (0..10_000).map(|i| vec![i as u8; 16 + i % 512]).collect();
+    let consumer = thread::spawn(move || {
+        blocks
+            .iter()
+            .enumerate()
+            .all(|(i, b)| b.len() == 16 + i % 512 && b[0] == i as u8)
+    });
+    if consumer.join().expect("Thread panicked") {
+        println!("[PASS] Allocation throughput test passed!");
+    } else {
+        println!("[FAIL] Cross-thread free saw corrupted blocks!");
+    }
+    println!();
+}
+
 // ============================================================================
 // Main entry point
 // ============================================================================
@@ -260,6 +331,7 @@ fn main() {
     test_thread_arguments();
     test_nested_threads();
     test_thread_local_data();
+    test_alloc_throughput();
 
     println!("========================================");
     println!("  All tests completed!                 ");